@@ -30,10 +30,14 @@ THE SOFTWARE.
 #include "2d/AutoPolygon.h"
 #include "poly2tri/poly2tri.h"
 #include "base/Director.h"
+#include "base/JobSystem.h"
 #include "base/axstd.h"
+#include "platform/FileUtils.h"
 #include "renderer/TextureCache.h"
 #include "clipper2/clipper.h"
+#include "xxhash.h"
 #include <algorithm>
+#include <thread>
 #include <math.h>
 
 static unsigned short quadIndices9[] = {
@@ -49,6 +53,30 @@ const static float PRECISION = 10.0f;
 
 NS_AX_BEGIN
 
+namespace
+{
+constexpr uint32_t POLYGON_CACHE_MAGIC   = 0x4c505841;  // 'AXPL'
+constexpr uint32_t POLYGON_CACHE_VERSION = 1;
+
+struct PolygonCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint64_t checksum;  // of the vertices and indices
+    float rect[4];
+    uint32_t vertCount;
+    uint32_t indexCount;
+};
+
+bool s_polygonCacheEnabled = false;
+
+std::string getPolygonCachePath(uint64_t key)
+{
+    return fmt::format("{}polygon-cache/{:016x}.bin", FileUtils::getInstance()->getWritablePath(), key);
+}
+}  // namespace
+
 PolygonInfo::PolygonInfo() : _isVertsOwner(true), _rect(Rect::ZERO), _filename("")
 {
     triangles.verts      = nullptr;
@@ -171,11 +199,29 @@ float PolygonInfo::getArea() const
 }
 
 AutoPolygon::AutoPolygon(std::string_view filename)
-    : _image(nullptr), _data(nullptr), _filename(""), _width(0), _height(0), _scaleFactor(0)
+    : AutoPolygon(filename, FileUtils::getInstance()->getDataFromFile(filename), 0)
+{}
+
+AutoPolygon::AutoPolygon(std::string_view filename, Data&& data, uint64_t contentHash)
+    : _image(nullptr)
+    , _data(nullptr)
+    , _filename("")
+    , _width(0)
+    , _height(0)
+    , _scaleFactor(0)
+    , _contentHash(contentHash)
 {
     _filename = filename;
-    _image    = new Image();
-    _image->initWithImageFile(filename);
+    if (!_contentHash)
+    {
+        _contentHash = XXH3_64bits(data.getBytes(), data.getSize());
+    }
+
+    // decoded from the data read for the hash, the file is read once
+    _image       = new Image();
+    ssize_t size = 0;
+    auto* bytes  = data.takeBuffer(&size);
+    _image->initWithImageData(bytes, size, true);
     AXASSERT(_image->getPixelFormat() == backend::PixelFormat::RGBA8,
              "unsupported format, currently only supports rgba8888");
     _data        = _image->getData();
@@ -709,6 +755,18 @@ Rect AutoPolygon::getRealRect(const Rect& rect)
 
 PolygonInfo AutoPolygon::generateTriangles(const Rect& rect, float epsilon, float threshold)
 {
+    const bool cached = s_polygonCacheEnabled;
+    const auto key    = cached ? computeCacheKey(_contentHash, rect, epsilon, threshold) : 0;
+    if (cached)
+    {
+        PolygonInfo info;
+        if (loadCachedPolygon(key, info))
+        {
+            info.setFilename(_filename);
+            return info;
+        }
+    }
+
     Rect realRect = getRealRect(rect);
     auto p        = trace(realRect, threshold);
     p             = reduce(p, realRect, epsilon);
@@ -719,13 +777,175 @@ PolygonInfo AutoPolygon::generateTriangles(const Rect& rect, float epsilon, floa
     ret.triangles = tri;
     ret.setFilename(_filename);
     ret.setRect(realRect);
+    if (cached)
+    {
+        saveCachedPolygon(key, ret);
+    }
     return ret;
 }
 
 PolygonInfo AutoPolygon::generatePolygon(std::string_view filename, const Rect& rect, float epsilon, float threshold)
 {
-    AutoPolygon ap(filename);
+    auto data              = FileUtils::getInstance()->getDataFromFile(filename);
+    const auto contentHash = XXH3_64bits(data.getBytes(), data.getSize());
+
+    // a cached polygon doesn't need the image decoded
+    PolygonInfo info;
+    if (s_polygonCacheEnabled && loadCachedPolygon(computeCacheKey(contentHash, rect, epsilon, threshold), info))
+    {
+        info.setFilename(filename);
+        return info;
+    }
+
+    AutoPolygon ap(filename, std::move(data), contentHash);
     return ap.generateTriangles(rect, epsilon, threshold);
 }
 
+std::vector<PolygonInfo> AutoPolygon::generateTriangles(const std::vector<Rect>& rects, float epsilon, float threshold)
+{
+    // the tracing only reads the image, so the rects are independent
+    std::vector<PolygonInfo> infos(rects.size());
+    Director::getInstance()->getJobSystem()->parallelFor(rects.size(), 1, [&](size_t first, size_t last) {
+        for (auto i = first; i < last; ++i)
+            infos[i] = generateTriangles(rects[i], epsilon, threshold);
+    });
+    return infos;
+}
+
+std::vector<PolygonInfo> AutoPolygon::generatePolygons(std::string_view filename,
+                                                       const std::vector<Rect>& rects,
+                                                       float epsilon,
+                                                       float threshold)
+{
+    auto data              = FileUtils::getInstance()->getDataFromFile(filename);
+    const auto contentHash = XXH3_64bits(data.getBytes(), data.getSize());
+    auto jobSystem         = Director::getInstance()->getJobSystem();
+
+    std::vector<PolygonInfo> infos(rects.size());
+    std::vector<uint8_t> hits(rects.size(), 0);
+    if (s_polygonCacheEnabled)
+    {
+        jobSystem->parallelFor(rects.size(), 16, [&](size_t first, size_t last) {
+            for (auto i = first; i < last; ++i)
+                hits[i] = loadCachedPolygon(computeCacheKey(contentHash, rects[i], epsilon, threshold), infos[i]);
+        });
+    }
+
+    std::vector<size_t> misses;
+    for (size_t i = 0; i < rects.size(); ++i)
+    {
+        if (hits[i])
+            infos[i].setFilename(filename);
+        else
+            misses.emplace_back(i);
+    }
+    if (misses.empty())
+    {
+        return infos;
+    }
+
+    AutoPolygon ap(filename, std::move(data), contentHash);
+    jobSystem->parallelFor(misses.size(), 1, [&](size_t first, size_t last) {
+        for (auto i = first; i < last; ++i)
+            infos[misses[i]] = ap.generateTriangles(rects[misses[i]], epsilon, threshold);
+    });
+    return infos;
+}
+
+void AutoPolygon::setCacheEnabled(bool enabled)
+{
+    s_polygonCacheEnabled = enabled;
+}
+
+bool AutoPolygon::isCacheEnabled()
+{
+    return s_polygonCacheEnabled;
+}
+
+uint64_t AutoPolygon::computeCacheKey(uint64_t contentHash, const Rect& rect, float epsilon, float threshold)
+{
+    // the traced points are scaled by the content scale factor
+    const float params[] = {rect.origin.x, rect.origin.y, rect.size.width, rect.size.height,
+                            epsilon,       threshold,     Director::getInstance()->getContentScaleFactor()};
+    return XXH3_64bits_withSeed(params, sizeof(params), contentHash);
+}
+
+bool AutoPolygon::loadCachedPolygon(uint64_t key, PolygonInfo& info)
+{
+    auto fileUtils = FileUtils::getInstance();
+    auto path      = getPolygonCachePath(key);
+
+    std::vector<uint8_t> data;
+    if (fileUtils->getContents(path, &data) != FileUtils::Status::OK)
+    {
+        return false;
+    }
+
+    PolygonCacheHeader header;
+    bool valid = data.size() >= sizeof(header);
+    if (valid)
+    {
+        memcpy(&header, data.data(), sizeof(header));
+        const size_t vertsSize   = header.vertCount * sizeof(V3F_C4B_T2F);
+        const size_t indicesSize = header.indexCount * sizeof(unsigned short);
+        valid = header.magic == POLYGON_CACHE_MAGIC && header.version == POLYGON_CACHE_VERSION && header.key == key &&
+                data.size() == sizeof(header) + vertsSize + indicesSize &&
+                header.checksum == XXH3_64bits(data.data() + sizeof(header), vertsSize + indicesSize);
+    }
+    if (!valid)
+    {
+        AXLOGD("AutoPolygon: removing the invalid cache entry {}", path);
+        fileUtils->removeFile(path);
+        return false;
+    }
+
+    auto* verts   = new V3F_C4B_T2F[header.vertCount];
+    auto* indices = new unsigned short[header.indexCount];
+    memcpy(verts, data.data() + sizeof(header), header.vertCount * sizeof(V3F_C4B_T2F));
+    memcpy(indices, data.data() + sizeof(header) + header.vertCount * sizeof(V3F_C4B_T2F),
+           header.indexCount * sizeof(unsigned short));
+
+    info.triangles = TrianglesCommand::Triangles(verts, indices, header.vertCount, header.indexCount);
+    info.setRect(Rect(header.rect[0], header.rect[1], header.rect[2], header.rect[3]));
+    return true;
+}
+
+void AutoPolygon::saveCachedPolygon(uint64_t key, const PolygonInfo& info)
+{
+    auto& triangles          = info.triangles;
+    const size_t vertsSize   = triangles.vertCount * sizeof(V3F_C4B_T2F);
+    const size_t indicesSize = triangles.indexCount * sizeof(unsigned short);
+    auto& rect               = info.getRect();
+
+    std::vector<uint8_t> data(sizeof(PolygonCacheHeader) + vertsSize + indicesSize);
+    auto* body = data.data() + sizeof(PolygonCacheHeader);
+    if (vertsSize)
+        memcpy(body, triangles.verts, vertsSize);
+    if (indicesSize)
+        memcpy(body + vertsSize, triangles.indices, indicesSize);
+
+    PolygonCacheHeader header{POLYGON_CACHE_MAGIC,
+                              POLYGON_CACHE_VERSION,
+                              key,
+                              XXH3_64bits(body, vertsSize + indicesSize),
+                              {rect.origin.x, rect.origin.y, rect.size.width, rect.size.height},
+                              triangles.vertCount,
+                              triangles.indexCount};
+    memcpy(data.data(), &header, sizeof(header));
+
+    auto fileUtils = FileUtils::getInstance();
+    auto path      = getPolygonCachePath(key);
+    auto dir       = path.substr(0, path.find_last_of('/') + 1);
+    if (!fileUtils->isDirectoryExist(dir))
+        fileUtils->createDirectories(dir);
+
+    // write aside then rename, the batch may write entries from several threads
+    auto tmpPath = fmt::format("{}.{:x}.tmp", path, std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    if (!FileUtils::writeBinaryToFile(data.data(), data.size(), tmpPath) || !fileUtils->renameFile(tmpPath, path))
+    {
+        fileUtils->removeFile(tmpPath);
+        AXLOGW("AutoPolygon: failed to write the cache entry {}", path);
+    }
+}
+
 NS_AX_END
@@ -261,7 +261,44 @@ public:
                                        float epsilon = 2.0f,  
                                        float threshold = 0.05f);
 
+    /**
+     * generate the polygons of many rects of the image, e.g. all frames of an atlas, in parallel on the job threads
+     * @param   rects   texture rects, each result is the same as generateTriangles with the rect
+     * @param   epsilon the value used to reduce and expand, default to 2.0
+     * @param   threshold   the value where bigger than the threshold will be counted as opaque, used in trace
+     * @return  the PolygonInfo of each rect, in the order of rects
+     */
+    std::vector<PolygonInfo> generateTriangles(const std::vector<Rect>& rects,
+                                               float epsilon   = 2.0f,
+                                               float threshold = 0.05f);
+
+    /**
+     * the batch version of generatePolygon, the image is only decoded if some polygons are not cached
+     * @code
+     * auto infos = AutoPolygon::generatePolygons("atlas.png", frameRects);
+     * @endcode
+     */
+    static std::vector<PolygonInfo> generatePolygons(std::string_view filename,
+                                                     const std::vector<Rect>& rects,
+                                                     float epsilon   = 2.0f,
+                                                     float threshold = 0.05f);
+
+    /**
+     * enable the cache of the generated polygons in the writable path, disabled by default
+     * the entries are keyed by the hash of the image file content and the parameters, so an edited image or
+     * different parameters never hit a stale entry
+     */
+    static void setCacheEnabled(bool enabled);
+    static bool isCacheEnabled();
+
 protected:
+    AutoPolygon(std::string_view filename, Data&& data, uint64_t contentHash);
+
+    static uint64_t computeCacheKey(uint64_t contentHash, const Rect& rect, float epsilon, float threshold);
+    static bool loadCachedPolygon(uint64_t key, PolygonInfo& info);
+    static void saveCachedPolygon(uint64_t key, const PolygonInfo& info);
+
+
     Vec2 findFirstNoneTransparentPixel(const Rect& rect, float threshold);
     std::vector<ax::Vec2> marchSquare(const Rect& rect, const Vec2& first, float threshold);
     unsigned int getSquareValue(unsigned int x, unsigned int y, const Rect& rect, float threshold);
@@ -288,6 +325,7 @@ protected:
     unsigned int _height;
     float _scaleFactor;
     unsigned int _threshold;
+    uint64_t _contentHash;
 };
 
 NS_AX_END
@@ -0,0 +1,530 @@
+/****************************************************************************
+ Copyright (c) 2019-present Axmol Engine contributors (see AUTHORS.md).
+
+ https://axmol.dev/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#include "2d/BinarySpriteSheetLoader.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#include "2d/AutoPolygon.h"
+#include "2d/SpriteFrameCache.h"
+#include "base/Director.h"
+#include "platform/FileUtils.h"
+#include "renderer/Texture2D.h"
+#include "renderer/TextureCache.h"
+#include "mio/mio.hpp"
+
+NS_AX_BEGIN
+
+namespace
+{
+constexpr char SHEET_MAGIC[4]     = {'A', 'X', 'S', 'S'};
+constexpr uint32_t SHEET_VERSION  = 1;
+constexpr uint32_t FRAME_ROTATED  = 1;
+constexpr uint32_t FRAME_ANCHORED = 2;
+
+// file layout: header, frames, names, vertices, indices padded to 4 bytes, strings
+struct SheetHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t frameCount;
+    uint32_t nameCount;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t stringsSize;
+    uint32_t textureName;  // offset and length in the strings
+    uint32_t textureNameLength;
+    uint32_t pixelFormatName;
+    uint32_t pixelFormatNameLength;
+};
+
+struct SheetFrame
+{
+    float rect[4];
+    float offset[2];
+    float originalSize[2];
+    float anchor[2];
+    float polygonRect[4];
+    uint32_t flags;
+    uint32_t firstVertex;
+    uint32_t vertexCount;
+    uint32_t firstIndex;
+    uint32_t indexCount;
+};
+
+struct SheetName
+{
+    uint32_t name;  // offset and length in the strings
+    uint32_t nameLength;
+    uint32_t frame;
+};
+
+size_t alignedIndicesSize(uint32_t indexCount)
+{
+    return (indexCount * sizeof(uint16_t) + 3) & ~size_t(3);
+}
+
+// The sheet file mapped when it's a plain file on disk, or read into memory, e.g. in the android apk
+class SheetFile
+{
+public:
+    bool open(std::string_view filePath)
+    {
+        auto fileUtils = FileUtils::getInstance();
+        auto fullPath  = fileUtils->fullPathForFilename(filePath);
+        if (fullPath.empty())
+        {
+            AXLOGW("SpriteFrameCache: can not find {}", filePath);
+            return false;
+        }
+
+        auto fs = fileUtils->openFileStream(fullPath, IFileStream::Mode::READ);
+        if (fs && fs->nativeHandle() != (osfhnd_t)-1)
+        {
+            const int64_t size = fs->size();
+            std::error_code error;
+            if (size > 0)
+                _mapping.map(fs->nativeHandle(), 0, static_cast<size_t>(size), error);
+            if (!error && _mapping.is_mapped())
+                return true;
+            _mapping.unmap();
+        }
+
+        _buffer = fileUtils->getDataFromFile(fullPath);
+        return !_buffer.isNull();
+    }
+
+    const uint8_t* data() const
+    {
+        return _mapping.is_mapped() ? reinterpret_cast<const uint8_t*>(_mapping.data()) : _buffer.getBytes();
+    }
+    size_t size() const { return _mapping.is_mapped() ? _mapping.size() : static_cast<size_t>(_buffer.getSize()); }
+
+private:
+    mio::mmap_source _mapping;
+    Data _buffer;
+};
+
+std::string_view getPixelFormatName(backend::PixelFormat format)
+{
+    switch (format)
+    {
+    case backend::PixelFormat::RGBA8:
+        return "RGBA8888"sv;
+    case backend::PixelFormat::RGBA4:
+        return "RGBA4444"sv;
+    case backend::PixelFormat::RGB5A1:
+        return "RGB5A1"sv;
+    case backend::PixelFormat::RGB565:
+        return "RGB565"sv;
+    case backend::PixelFormat::R8:
+        return "R8"sv;
+    case backend::PixelFormat::RG8:
+        return "RG8"sv;
+    case backend::PixelFormat::RGB8:
+        return "RGB888"sv;
+    default:
+        return ""sv;
+    }
+}
+}  // namespace
+
+struct BinarySpriteSheetLoader::SheetView
+{
+    const SheetHeader* header = nullptr;
+    const SheetFrame* frames  = nullptr;
+    const SheetName* names    = nullptr;
+    const float* vertices     = nullptr;  // x, y, u, v
+    const uint16_t* indices   = nullptr;
+    const char* strings       = nullptr;
+
+    std::string_view getString(uint32_t offset, uint32_t length) const { return {strings + offset, length}; }
+
+    std::string_view getTextureFileName() const
+    {
+        return getString(header->textureName, header->textureNameLength);
+    }
+
+    std::string_view getPixelFormatName() const
+    {
+        return getString(header->pixelFormatName, header->pixelFormatNameLength);
+    }
+
+    bool parse(const uint8_t* data, size_t size, std::string_view filePath)
+    {
+        if (!data || size < sizeof(SheetHeader) || memcmp(data, SHEET_MAGIC, sizeof(SHEET_MAGIC)) != 0)
+        {
+            AXLOGW("SpriteFrameCache: {} is not a binary sprite sheet", filePath);
+            return false;
+        }
+
+        header = reinterpret_cast<const SheetHeader*>(data);
+        if (header->version != SHEET_VERSION)
+        {
+            AXLOGW("SpriteFrameCache: unsupported binary sprite sheet version {} of {}", header->version, filePath);
+            return false;
+        }
+
+        // 64 bits, so a corrupted count can't wrap around
+        const uint64_t framesOffset   = sizeof(SheetHeader);
+        const uint64_t namesOffset    = framesOffset + uint64_t{header->frameCount} * sizeof(SheetFrame);
+        const uint64_t verticesOffset = namesOffset + uint64_t{header->nameCount} * sizeof(SheetName);
+        const uint64_t indicesOffset  = verticesOffset + uint64_t{header->vertexCount} * 4 * sizeof(float);
+        const uint64_t stringsOffset  = indicesOffset + alignedIndicesSize(header->indexCount);
+        if (stringsOffset + header->stringsSize > size ||
+            uint64_t{header->textureName} + header->textureNameLength > header->stringsSize ||
+            uint64_t{header->pixelFormatName} + header->pixelFormatNameLength > header->stringsSize)
+        {
+            AXLOGW("SpriteFrameCache: binary sprite sheet {} is truncated", filePath);
+            return false;
+        }
+
+        frames   = reinterpret_cast<const SheetFrame*>(data + framesOffset);
+        names    = reinterpret_cast<const SheetName*>(data + namesOffset);
+        vertices = reinterpret_cast<const float*>(data + verticesOffset);
+        indices  = reinterpret_cast<const uint16_t*>(data + indicesOffset);
+        strings  = reinterpret_cast<const char*>(data + stringsOffset);
+
+        for (uint32_t i = 0; i < header->frameCount; ++i)
+        {
+            auto& frame = frames[i];
+            if (uint64_t{frame.firstVertex} + frame.vertexCount > header->vertexCount ||
+                uint64_t{frame.firstIndex} + frame.indexCount > header->indexCount ||
+                std::any_of(indices + frame.firstIndex, indices + frame.firstIndex + frame.indexCount,
+                            [&frame](uint16_t index) { return index >= frame.vertexCount; }))
+            {
+                AXLOGW("SpriteFrameCache: invalid polygon of frame {} in {}", i, filePath);
+                return false;
+            }
+        }
+        for (uint32_t i = 0; i < header->nameCount; ++i)
+        {
+            auto& name = names[i];
+            if (name.frame >= header->frameCount || uint64_t{name.name} + name.nameLength > header->stringsSize)
+            {
+                AXLOGW("SpriteFrameCache: invalid frame name {} in {}", i, filePath);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    SpriteFrame* createFrame(const SheetFrame& record, Texture2D* texture) const
+    {
+        auto* spriteFrame = SpriteFrame::createWithTexture(
+            texture, Rect(record.rect[0], record.rect[1], record.rect[2], record.rect[3]),
+            (record.flags & FRAME_ROTATED) != 0, Vec2(record.offset[0], record.offset[1]),
+            Vec2(record.originalSize[0], record.originalSize[1]));
+
+        if (record.vertexCount > 0)
+        {
+            auto* verts = new V3F_C4B_T2F[record.vertexCount];
+            auto* src   = vertices + record.firstVertex * 4;
+            for (uint32_t i = 0; i < record.vertexCount; ++i, src += 4)
+            {
+                verts[i].vertices  = Vec3(src[0], src[1], 0);
+                verts[i].colors    = Color4B::WHITE;
+                verts[i].texCoords = Tex2F(src[2], src[3]);
+            }
+            auto* polygonIndices = new unsigned short[record.indexCount];
+            memcpy(polygonIndices, indices + record.firstIndex, record.indexCount * sizeof(uint16_t));
+
+            PolygonInfo info;
+            info.triangles.verts      = verts;
+            info.triangles.vertCount  = record.vertexCount;
+            info.triangles.indices    = polygonIndices;
+            info.triangles.indexCount = record.indexCount;
+            info.setRect(
+                Rect(record.polygonRect[0], record.polygonRect[1], record.polygonRect[2], record.polygonRect[3]));
+            spriteFrame->setPolygonInfo(info);
+        }
+
+        if (record.flags & FRAME_ANCHORED)
+        {
+            spriteFrame->setAnchorPoint(Vec2(record.anchor[0], record.anchor[1]));
+        }
+        return spriteFrame;
+    }
+};
+
+bool BinarySpriteSheetLoader::save(std::string_view spriteSheetFileName,
+                                   std::string_view outputPath,
+                                   SpriteFrameCache& cache)
+{
+    auto spriteSheet = cache.findSpriteSheet(spriteSheetFileName);
+    if (!spriteSheet || spriteSheet->frames.empty())
+    {
+        AXLOGW("BinarySpriteSheetLoader: sprite sheet {} isn't loaded", spriteSheetFileName);
+        return false;
+    }
+
+    // sorted, so the same sheet always produces the same file
+    std::vector<std::string_view> frameNames(spriteSheet->frames.begin(), spriteSheet->frames.end());
+    std::sort(frameNames.begin(), frameNames.end());
+
+    std::vector<SheetFrame> frames;
+    std::vector<SheetName> names;
+    std::vector<float> vertices;
+    std::vector<uint16_t> indices;
+    std::string strings;
+    std::unordered_map<SpriteFrame*, uint32_t> frameIndices;
+    Texture2D* texture = nullptr;
+
+    auto addString = [&strings](std::string_view str) {
+        auto offset = static_cast<uint32_t>(strings.size());
+        strings.append(str);
+        return offset;
+    };
+
+    for (auto name : frameNames)
+    {
+        auto* spriteFrame = cache.findFrame(name);
+        if (!spriteFrame)
+            continue;
+
+        if (texture && spriteFrame->getTexture() != texture)
+        {
+            AXLOGW("BinarySpriteSheetLoader: frame {} of {} uses another texture, skipped", name, spriteSheetFileName);
+            continue;
+        }
+        texture = spriteFrame->getTexture();
+
+        auto [it, inserted] = frameIndices.emplace(spriteFrame, static_cast<uint32_t>(frames.size()));
+        if (inserted)
+        {
+            auto& rect         = spriteFrame->getRect();
+            auto& offset       = spriteFrame->getOffset();
+            auto& originalSize = spriteFrame->getOriginalSize();
+            auto& anchor       = spriteFrame->getAnchorPoint();
+
+            SheetFrame record{};
+            record.rect[0]         = rect.origin.x;
+            record.rect[1]         = rect.origin.y;
+            record.rect[2]         = rect.size.width;
+            record.rect[3]         = rect.size.height;
+            record.offset[0]       = offset.x;
+            record.offset[1]       = offset.y;
+            record.originalSize[0] = originalSize.x;
+            record.originalSize[1] = originalSize.y;
+            record.anchor[0]       = anchor.x;
+            record.anchor[1]       = anchor.y;
+            record.flags = (spriteFrame->isRotated() ? FRAME_ROTATED : 0) |
+                           (spriteFrame->hasAnchorPoint() ? FRAME_ANCHORED : 0);
+
+            if (spriteFrame->hasPolygonInfo())
+            {
+                auto& info      = spriteFrame->getPolygonInfo();
+                auto& triangles = info.triangles;
+                auto& polyRect  = info.getRect();
+
+                record.polygonRect[0] = polyRect.origin.x;
+                record.polygonRect[1] = polyRect.origin.y;
+                record.polygonRect[2] = polyRect.size.width;
+                record.polygonRect[3] = polyRect.size.height;
+                record.firstVertex    = static_cast<uint32_t>(vertices.size() / 4);
+                record.vertexCount    = triangles.vertCount;
+                record.firstIndex     = static_cast<uint32_t>(indices.size());
+                record.indexCount     = triangles.indexCount;
+                for (unsigned int i = 0; i < triangles.vertCount; ++i)
+                {
+                    auto& vert = triangles.verts[i];
+                    vertices.insert(vertices.end(),
+                                    {vert.vertices.x, vert.vertices.y, vert.texCoords.u, vert.texCoords.v});
+                }
+                indices.insert(indices.end(), triangles.indices, triangles.indices + triangles.indexCount);
+            }
+            frames.emplace_back(record);
+        }
+
+        names.emplace_back(SheetName{addString(name), static_cast<uint32_t>(name.size()), it->second});
+    }
+
+    if (frames.empty())
+    {
+        AXLOGW("BinarySpriteSheetLoader: sprite sheet {} has no frames", spriteSheetFileName);
+        return false;
+    }
+
+    // the texture is expected beside the output file
+    auto texturePath = Director::getInstance()->getTextureCache()->getTextureFilePath(texture);
+    auto slash       = texturePath.find_last_of("/\\");
+    std::string_view textureFileName{texturePath};
+    if (slash != std::string::npos)
+        textureFileName.remove_prefix(slash + 1);
+    auto pixelFormatName = getPixelFormatName(texture->getPixelFormat());
+
+    SheetHeader header{};
+    memcpy(header.magic, SHEET_MAGIC, sizeof(SHEET_MAGIC));
+    header.version               = SHEET_VERSION;
+    header.frameCount            = static_cast<uint32_t>(frames.size());
+    header.nameCount             = static_cast<uint32_t>(names.size());
+    header.vertexCount           = static_cast<uint32_t>(vertices.size() / 4);
+    header.indexCount            = static_cast<uint32_t>(indices.size());
+    header.textureNameLength     = static_cast<uint32_t>(textureFileName.size());
+    header.textureName           = addString(textureFileName);
+    header.pixelFormatNameLength = static_cast<uint32_t>(pixelFormatName.size());
+    header.pixelFormatName       = addString(pixelFormatName);
+    header.stringsSize           = static_cast<uint32_t>(strings.size());
+
+    std::string data;
+    data.reserve(sizeof(header) + frames.size() * sizeof(SheetFrame) + names.size() * sizeof(SheetName) +
+                 vertices.size() * sizeof(float) + alignedIndicesSize(header.indexCount) + strings.size());
+    data.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    data.append(reinterpret_cast<const char*>(frames.data()), frames.size() * sizeof(SheetFrame));
+    data.append(reinterpret_cast<const char*>(names.data()), names.size() * sizeof(SheetName));
+    data.append(reinterpret_cast<const char*>(vertices.data()), vertices.size() * sizeof(float));
+    data.append(reinterpret_cast<const char*>(indices.data()), indices.size() * sizeof(uint16_t));
+    data.resize(data.size() + alignedIndicesSize(header.indexCount) - indices.size() * sizeof(uint16_t));
+    data.append(strings);
+
+    return FileUtils::writeBinaryToFile(data.data(), data.size(), outputPath);
+}
+
+void BinarySpriteSheetLoader::load(std::string_view filePath, SpriteFrameCache& cache)
+{
+    AXASSERT(!filePath.empty(), "sprite sheet filename should not be empty");
+
+    SheetFile file;
+    SheetView view;
+    if (!file.open(filePath) || !view.parse(file.data(), file.size(), filePath))
+        return;
+
+    auto texture = addTexture(getTexturePath(view.getTextureFileName(), filePath), view.getPixelFormatName());
+    if (texture)
+    {
+        addSpriteFrames(view, texture, filePath, cache, false);
+    }
+    else
+    {
+        AXLOGD("SpriteFrameCache: Couldn't load texture");
+    }
+}
+
+void BinarySpriteSheetLoader::load(std::string_view filePath, Texture2D* texture, SpriteFrameCache& cache)
+{
+    SheetFile file;
+    SheetView view;
+    if (file.open(filePath) && view.parse(file.data(), file.size(), filePath))
+        addSpriteFrames(view, texture, filePath, cache, false);
+}
+
+void BinarySpriteSheetLoader::load(std::string_view filePath, std::string_view textureFileName, SpriteFrameCache& cache)
+{
+    AXASSERT(!textureFileName.empty(), "texture name should not be null");
+
+    SheetFile file;
+    SheetView view;
+    if (!file.open(filePath) || !view.parse(file.data(), file.size(), filePath))
+        return;
+
+    auto texture = addTexture(textureFileName, view.getPixelFormatName());
+    if (texture)
+    {
+        addSpriteFrames(view, texture, filePath, cache, false);
+    }
+    else
+    {
+        AXLOGD("SpriteFrameCache: Couldn't load texture");
+    }
+}
+
+void BinarySpriteSheetLoader::load(const Data& content, Texture2D* texture, SpriteFrameCache& cache)
+{
+    constexpr auto path = "by#addSpriteFramesWithFileContent()"sv;
+
+    SheetView view;
+    if (!content.isNull() && view.parse(content.getBytes(), static_cast<size_t>(content.getSize()), path))
+        addSpriteFrames(view, texture, path, cache, false);
+}
+
+void BinarySpriteSheetLoader::reload(std::string_view filePath, SpriteFrameCache& cache)
+{
+    SheetFile file;
+    SheetView view;
+    if (!file.open(filePath) || !view.parse(file.data(), file.size(), filePath))
+        return;
+
+    auto texturePath   = getTexturePath(view.getTextureFileName(), filePath);
+    auto textureCache  = Director::getInstance()->getTextureCache();
+    Texture2D* texture = nullptr;
+    if (textureCache->reloadTexture(texturePath))
+    {
+        texture = textureCache->getTextureForKey(texturePath);
+    }
+
+    if (texture)
+    {
+        addSpriteFrames(view, texture, filePath, cache, true);
+    }
+    else
+    {
+        AXLOGD("SpriteFrameCache: Couldn't load texture");
+    }
+}
+
+void BinarySpriteSheetLoader::addSpriteFrames(const SheetView& view,
+                                              Texture2D* texture,
+                                              std::string_view filePath,
+                                              SpriteFrameCache& cache,
+                                              bool reload)
+{
+    auto spriteSheet    = std::make_shared<SpriteSheet>();
+    spriteSheet->format = getFormat();
+    spriteSheet->path   = filePath;
+
+    // a frame is created once and shared by its aliases
+    std::vector<SpriteFrame*> frames(view.header->frameCount, nullptr);
+    Image* image = nullptr;
+
+    for (uint32_t i = 0; i < view.header->nameCount; ++i)
+    {
+        auto& record = view.names[i];
+        auto name    = view.getString(record.name, record.nameLength);
+        if (reload)
+        {
+            cache.eraseFrame(name);
+        }
+        else if (cache.findFrame(name))
+        {
+            continue;
+        }
+
+        auto& spriteFrame = frames[record.frame];
+        if (!spriteFrame)
+        {
+            spriteFrame = view.createFrame(view.frames[record.frame], texture);
+            if (!reload)
+                addNinePatchCapInset(name, spriteFrame, texture, image, cache);
+        }
+
+        cache.insertFrame(spriteSheet, name, spriteFrame);
+    }
+
+    spriteSheet->full = true;
+
+    AX_SAFE_DELETE(image);
+}
+
+NS_AX_END
@@ -0,0 +1,76 @@
+/****************************************************************************
+ Copyright (c) 2019-present Axmol Engine contributors (see AUTHORS.md).
+
+ https://axmol.dev/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#pragma once
+
+#include <string>
+
+#include "2d/SpriteSheetLoader.h"
+#include "base/Data.h"
+
+NS_AX_BEGIN
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/**
+ * @brief Loads sprite sheets in the compact binary format, usually with .axss extension.
+ *
+ * The file holds fixed size frame records, the frame names and the polygon meshes in flat arrays, so it's read
+ * without parsing or temporary values, from a memory mapping when the file is a plain file on disk.
+ * Sheets are converted from any loaded format with save(). The values are stored little endian.
+ */
+class AX_DLL BinarySpriteSheetLoader : public SpriteSheetLoader
+{
+public:
+    static constexpr uint32_t FORMAT = SpriteSheetFormat::BINARY;
+
+    /**
+     * Writes the frames of a loaded sprite sheet in the binary format, aliases are kept.
+     * The texture is referenced by its file name, relative to the output file.
+     */
+    static bool save(std::string_view spriteSheetFileName, std::string_view outputPath, SpriteFrameCache& cache);
+
+    uint32_t getFormat() override { return FORMAT; }
+    void load(std::string_view filePath, SpriteFrameCache& cache) override;
+    void load(std::string_view filePath, Texture2D* texture, SpriteFrameCache& cache) override;
+    void load(std::string_view filePath, std::string_view textureFileName, SpriteFrameCache& cache) override;
+    void load(const Data& content, Texture2D* texture, SpriteFrameCache& cache) override;
+    void reload(std::string_view filePath, SpriteFrameCache& cache) override;
+
+protected:
+    struct SheetView;
+
+    void addSpriteFrames(const SheetView& view,
+                         Texture2D* texture,
+                         std::string_view filePath,
+                         SpriteFrameCache& cache,
+                         bool reload);
+};
+
+// end of _2d group
+/// @}
+
+NS_AX_END
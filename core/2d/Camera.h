@@ -198,6 +198,11 @@ public:
      * Is this aabb visible in frustum
      */
     bool isVisibleInFrustum(const AABB* aabb) const;
+
+    /**
+     * Get the frustum of camera, updated with the view projection matrix
+     */
+    const Frustum& getFrustum() const;
 #endif
 
     /**
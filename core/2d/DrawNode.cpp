@@ -25,6 +25,7 @@
 
 #include "2d/DrawNode.h"
 #include <stddef.h>  // offsetof
+#include <algorithm>
 #include "base/Types.h"
 #include "base/EventType.h"
 #include "base/Configuration.h"
@@ -36,6 +37,7 @@
 #include "base/Utils.h"
 #include "renderer/Shaders.h"
 #include "renderer/backend/ProgramState.h"
+#include "math/MathUtil.h"
 #include "poly2tri/poly2tri.h"
 
 NS_AX_BEGIN
@@ -76,6 +78,164 @@ inline bool isConvex(const Vec2* verts, int count)
     return true;  // Polygon is convex
 }
 
+// Tessellators shared by the draw methods and the retained primitives, they return the end of the output written
+
+static inline unsigned int polygonVertexCount(int count, bool outline)
+{
+    return (count > 2 ? 3 * (count - 2) : 0) + (outline && count > 1 ? 6 * count : 0);
+}
+
+static V2F_C4B_T2F_Triangle* tessellateFan(V2F_C4B_T2F_Triangle* cursor,
+                                           const Vec2* verts,
+                                           int count,
+                                           const Color4B& color)
+{
+    for (int i = 0; i < count - 2; i++)
+    {
+        *cursor++ = {
+            {verts[0], color, v2ToTex2F(Vec2::ZERO)},
+            {verts[i + 1], color, v2ToTex2F(Vec2::ZERO)},
+            {verts[i + 2], color, v2ToTex2F(Vec2::ZERO)},
+        };
+    }
+    return cursor;
+}
+
+static V2F_C4B_T2F_Triangle* tessellateOutline(V2F_C4B_T2F_Triangle* cursor,
+                                               const Vec2* verts,
+                                               int count,
+                                               float borderWidth,
+                                               const Color4B& borderColor)
+{
+    auto edgeNormal = [verts, count](int i) {
+        return ((verts[i + 1 < count ? i + 1 : 0] - verts[i]).getPerp()).getNormalized();
+    };
+    auto extrudeOffset = [](const Vec2& n1, const Vec2& n2) {
+        return (n1 + n2) * (1.0f / (Vec2::dot(n1, n2) + 1.0f));
+    };
+
+    // The normals and offsets are computed on the way, the ones of the first vertex are kept to close the loop
+    Vec2 firstNormal = edgeNormal(0);
+    Vec2 firstOffset = extrudeOffset(edgeNormal(count - 1), firstNormal);
+    Vec2 n0          = firstNormal;
+    Vec2 offset0     = firstOffset;
+
+    for (int i = 0; i < count; i++)
+    {
+        int j   = i + 1 < count ? i + 1 : 0;
+        Vec2 v0 = verts[i];
+        Vec2 v1 = verts[j];
+
+        Vec2 n1      = j ? edgeNormal(j) : firstNormal;
+        Vec2 offset1 = j ? extrudeOffset(n0, n1) : firstOffset;
+
+        Vec2 inner0 = v0 - offset0 * borderWidth;
+        Vec2 inner1 = v1 - offset1 * borderWidth;
+        Vec2 outer0 = v0 + offset0 * borderWidth;
+        Vec2 outer1 = v1 + offset1 * borderWidth;
+
+        *cursor++ = {{inner0, borderColor, v2ToTex2F(-n0)},
+                     {inner1, borderColor, v2ToTex2F(-n0)},
+                     {outer1, borderColor, v2ToTex2F(n0)}};
+        *cursor++ = {{inner0, borderColor, v2ToTex2F(-n0)},
+                     {outer0, borderColor, v2ToTex2F(n0)},
+                     {outer1, borderColor, v2ToTex2F(n0)}};
+
+        n0      = n1;
+        offset0 = offset1;
+    }
+    return cursor;
+}
+
+static V2F_C4B_T2F_Triangle* tessellateSegment(V2F_C4B_T2F_Triangle* triangles,
+                                               const Vec2& from,
+                                               const Vec2& to,
+                                               float radius,
+                                               const Color4B& color)
+{
+    Vec2 a = from;
+    Vec2 b = to;
+
+    Vec2 n = ((b - a).getPerp()).getNormalized();
+    Vec2 t = n.getPerp();
+
+    Vec2 nw = n * radius;
+    Vec2 tw = t * radius;
+    Vec2 v0 = b - (nw + tw);
+    Vec2 v1 = b + (nw - tw);
+    Vec2 v2 = b - nw;
+    Vec2 v3 = b + nw;
+    Vec2 v4 = a - nw;
+    Vec2 v5 = a + nw;
+    Vec2 v6 = a - (nw - tw);
+    Vec2 v7 = a + (nw + tw);
+
+    triangles[0] = {
+        {v0, color, v2ToTex2F(-(n + t))},
+        {v1, color, v2ToTex2F(n - t)},
+        {v2, color, v2ToTex2F(-n)},
+    };
+
+    triangles[1] = {
+        {v3, color, v2ToTex2F(n)},
+        {v1, color, v2ToTex2F(n - t)},
+        {v2, color, v2ToTex2F(-n)},
+    };
+
+    triangles[2] = {
+        {v3, color, v2ToTex2F(n)},
+        {v4, color, v2ToTex2F(-n)},
+        {v2, color, v2ToTex2F(-n)},
+    };
+
+    triangles[3] = {
+        {v3, color, v2ToTex2F(n)},
+        {v4, color, v2ToTex2F(-n)},
+        {v5, color, v2ToTex2F(n)},
+    };
+
+    triangles[4] = {
+        {v6, color, v2ToTex2F(t - n)},
+        {v4, color, v2ToTex2F(-n)},
+        {v5, color, v2ToTex2F(n)},
+    };
+
+    triangles[5] = {
+        {v6, color, v2ToTex2F(t - n)},
+        {v7, color, v2ToTex2F(t + n)},
+        {v5, color, v2ToTex2F(n)},
+    };
+
+    return triangles + 6;
+}
+
+static inline unsigned int linesVertexCount(unsigned int numberOfPoints, bool closePolygon)
+{
+    return numberOfPoints < 2 ? 0 : (closePolygon ? 2 * numberOfPoints : 2 * (numberOfPoints - 1));
+}
+
+static V2F_C4B_T2F* tessellateLines(V2F_C4B_T2F* point,
+                                    const Vec2* poli,
+                                    unsigned int numberOfPoints,
+                                    bool closePolygon,
+                                    const Color4B& color)
+{
+    unsigned int i = 0;
+    for (; i < numberOfPoints - 1; i++)
+    {
+        *point       = {poli[i], color, Tex2F(0.0, 0.0)};
+        *(point + 1) = {poli[i + 1], color, Tex2F(0.0, 0.0)};
+        point += 2;
+    }
+    if (closePolygon)
+    {
+        *point       = {poli[i], color, Tex2F(0.0, 0.0)};
+        *(point + 1) = {poli[0], color, Tex2F(0.0, 0.0)};
+        point += 2;
+    }
+    return point;
+}
+
 // implementation of DrawNode
 
 DrawNode::DrawNode(float lineWidth) : _lineWidth(lineWidth), _defaultLineWidth(lineWidth), _isConvex(false)
@@ -103,6 +263,8 @@ DrawNode::~DrawNode()
     freeShaderInternal(_customCommandTriangle);
     freeShaderInternal(_customCommandPoint);
     freeShaderInternal(_customCommandLine);
+    for (auto& rb : _retained)
+        freeShaderInternal(rb.command);
 }
 
 DrawNode* DrawNode::create(float defaultLineWidth)
@@ -131,7 +293,8 @@ void DrawNode::ensureCapacity(int count)
 
         _customCommandTriangle.createVertexBuffer(sizeof(V2F_C4B_T2F), _bufferCapacityTriangle,
                                                   CustomCommand::BufferUsage::STATIC);
-        _customCommandTriangle.updateVertexBuffer(_bufferTriangle, _bufferCapacityTriangle * sizeof(V2F_C4B_T2F));
+        _uploadedCountTriangle = 0;
+        _dirtyTriangle         = true;
     }
 }
 
@@ -146,7 +309,8 @@ void DrawNode::ensureCapacityGLPoint(int count)
 
         _customCommandPoint.createVertexBuffer(sizeof(V2F_C4B_T2F), _bufferCapacityPoint,
                                                CustomCommand::BufferUsage::STATIC);
-        _customCommandPoint.updateVertexBuffer(_bufferPoint, _bufferCapacityPoint * sizeof(V2F_C4B_T2F));
+        _uploadedCountPoint = 0;
+        _dirtyPoint         = true;
     }
 }
 
@@ -161,7 +325,8 @@ void DrawNode::ensureCapacityGLLine(int count)
 
         _customCommandLine.createVertexBuffer(sizeof(V2F_C4B_T2F), _bufferCapacityLine,
                                               CustomCommand::BufferUsage::STATIC);
-        _customCommandLine.updateVertexBuffer(_bufferLine, _bufferCapacityLine * sizeof(V2F_C4B_T2F));
+        _uploadedCountLine = 0;
+        _dirtyLine         = true;
     }
 }
 
@@ -190,6 +355,12 @@ void DrawNode::updateShader()
 
     updateShaderInternal(_customCommandLine, backend::ProgramType::POSITION_COLOR_LENGTH_TEXTURE,
                          CustomCommand::DrawType::ARRAY, CustomCommand::PrimitiveType::LINE);
+
+    updateShaderInternal(_retained[RETAINED_TRIANGLE].command, backend::ProgramType::POSITION_COLOR_LENGTH_TEXTURE,
+                         CustomCommand::DrawType::ARRAY, CustomCommand::PrimitiveType::TRIANGLE);
+
+    updateShaderInternal(_retained[RETAINED_LINE].command, backend::ProgramType::POSITION_COLOR_LENGTH_TEXTURE,
+                         CustomCommand::DrawType::ARRAY, CustomCommand::PrimitiveType::LINE);
 }
 
 void DrawNode::updateShaderInternal(CustomCommand& cmd,
@@ -254,30 +425,61 @@ void DrawNode::updateUniforms(const Mat4& transform, CustomCommand& cmd)
     pipelineDescriptor.programState->setUniform(alphaUniformLocation, &alpha, sizeof(alpha));
 }
 
+void DrawNode::updateVertexBuffer(CustomCommand& cmd, V2F_C4B_T2F* buffer, int count, int& uploadedCount)
+{
+    // The geometry is appended since the last clear, only the new vertices are uploaded, once per frame
+    if (count > uploadedCount)
+        cmd.updateVertexBuffer(buffer + uploadedCount, uploadedCount * sizeof(V2F_C4B_T2F),
+                               (count - uploadedCount) * sizeof(V2F_C4B_T2F));
+    uploadedCount = count;
+    cmd.setVertexDrawInfo(0, count);
+}
+
+void DrawNode::addDrawCommand(Renderer* renderer, const Mat4& transform, CustomCommand& cmd)
+{
+    updateBlendState(cmd);
+    updateUniforms(transform, cmd);
+    cmd.init(_globalZOrder);
+    renderer->addCommand(&cmd);
+}
+
 void DrawNode::draw(Renderer* renderer, const Mat4& transform, uint32_t flags)
 {
     if (_bufferCountTriangle)
     {
-        updateBlendState(_customCommandTriangle);
-        updateUniforms(transform, _customCommandTriangle);
-        _customCommandTriangle.init(_globalZOrder);
-        renderer->addCommand(&_customCommandTriangle);
+        if (_dirtyTriangle)
+        {
+            updateVertexBuffer(_customCommandTriangle, _bufferTriangle, _bufferCountTriangle, _uploadedCountTriangle);
+            _dirtyTriangle = false;
+        }
+        addDrawCommand(renderer, transform, _customCommandTriangle);
     }
 
     if (_bufferCountPoint)
     {
-        updateBlendState(_customCommandPoint);
-        updateUniforms(transform, _customCommandPoint);
-        _customCommandPoint.init(_globalZOrder);
-        renderer->addCommand(&_customCommandPoint);
+        if (_dirtyPoint)
+        {
+            updateVertexBuffer(_customCommandPoint, _bufferPoint, _bufferCountPoint, _uploadedCountPoint);
+            _dirtyPoint = false;
+        }
+        addDrawCommand(renderer, transform, _customCommandPoint);
     }
 
     if (_bufferCountLine)
     {
-        updateBlendState(_customCommandLine);
-        updateUniforms(transform, _customCommandLine);
-        _customCommandLine.init(_globalZOrder);
-        renderer->addCommand(&_customCommandLine);
+        if (_dirtyLine)
+        {
+            updateVertexBuffer(_customCommandLine, _bufferLine, _bufferCountLine, _uploadedCountLine);
+            _dirtyLine = false;
+        }
+        addDrawCommand(renderer, transform, _customCommandLine);
+    }
+
+    for (int type = 0; type < RETAINED_COUNT; ++type)
+    {
+        updateRetained(static_cast<RetainedBufferType>(type));
+        if (!_retained[type].vertices.empty())
+            addDrawCommand(renderer, transform, _retained[type].command);
     }
 }
 
@@ -288,10 +490,8 @@ void DrawNode::drawPoint(const Vec2& position, const float pointSize, const Colo
     V2F_C4B_T2F* point = _bufferPoint + _bufferCountPoint;
     *point             = {position, color, Tex2F(pointSize, 0)};
 
-    _customCommandPoint.updateVertexBuffer(point, _bufferCountPoint * sizeof(V2F_C4B_T2F), sizeof(V2F_C4B_T2F));
     _bufferCountPoint += 1;
     _dirtyPoint = true;
-    _customCommandPoint.setVertexDrawInfo(0, _bufferCountPoint);
 }
 
 void DrawNode::drawPoints(const Vec2* position, unsigned int numberOfPoints, const Color4B& color)
@@ -312,11 +512,8 @@ void DrawNode::drawPoints(const Vec2* position,
         *(point + i) = {position[i], color, Tex2F(pointSize, 0)};
     }
 
-    _customCommandPoint.updateVertexBuffer(point, _bufferCountPoint * sizeof(V2F_C4B_T2F),
-                                           numberOfPoints * sizeof(V2F_C4B_T2F));
     _bufferCountPoint += numberOfPoints;
     _dirtyPoint = true;
-    _customCommandPoint.setVertexDrawInfo(0, _bufferCountPoint);
 }
 
 void DrawNode::drawLine(const Vec2& origin, const Vec2& destination, const Color4B& color)
@@ -328,10 +525,8 @@ void DrawNode::drawLine(const Vec2& origin, const Vec2& destination, const Color
     *point       = {origin, color, Tex2F(0.0, 0.0)};
     *(point + 1) = {destination, color, Tex2F(0.0, 0.0)};
 
-    _customCommandLine.updateVertexBuffer(point, _bufferCountLine * sizeof(V2F_C4B_T2F), 2 * sizeof(V2F_C4B_T2F));
     _bufferCountLine += 2;
     _dirtyLine = true;
-    _customCommandLine.setVertexDrawInfo(0, _bufferCountLine);
 }
 
 void DrawNode::drawRect(const Vec2& origin, const Vec2& destination, const Color4B& color)
@@ -344,38 +539,15 @@ void DrawNode::drawRect(const Vec2& origin, const Vec2& destination, const Color
 
 void DrawNode::drawPoly(const Vec2* poli, unsigned int numberOfPoints, bool closePolygon, const Color4B& color)
 {
-    unsigned int vertex_count;
-    if (closePolygon)
-    {
-        vertex_count = 2 * numberOfPoints;
-        ensureCapacityGLLine(vertex_count);
-    }
-    else
-    {
-        vertex_count = 2 * (numberOfPoints - 1);
-        ensureCapacityGLLine(vertex_count);
-    }
+    unsigned int vertex_count = linesVertexCount(numberOfPoints, closePolygon);
+    if (!vertex_count)
+        return;
 
-    V2F_C4B_T2F* point  = _bufferLine + _bufferCountLine;
-    V2F_C4B_T2F* cursor = point;
+    ensureCapacityGLLine(vertex_count);
+    tessellateLines(_bufferLine + _bufferCountLine, poli, numberOfPoints, closePolygon, color);
 
-    unsigned int i = 0;
-    for (; i < numberOfPoints - 1; i++)
-    {
-        *point       = {poli[i], color, Tex2F(0.0, 0.0)};
-        *(point + 1) = {poli[i + 1], color, Tex2F(0.0, 0.0)};
-        point += 2;
-    }
-    if (closePolygon)
-    {
-        *point       = {poli[i], color, Tex2F(0.0, 0.0)};
-        *(point + 1) = {poli[0], color, Tex2F(0.0, 0.0)};
-    }
-
-    _customCommandLine.updateVertexBuffer(cursor, _bufferCountLine * sizeof(V2F_C4B_T2F),
-                                          vertex_count * sizeof(V2F_C4B_T2F));
     _bufferCountLine += vertex_count;
-    _customCommandLine.setVertexDrawInfo(0, _bufferCountLine);
+    _dirtyLine = true;
 }
 
 void DrawNode::drawCircle(const Vec2& center,
@@ -388,16 +560,9 @@ void DrawNode::drawCircle(const Vec2& center,
                           const Color4B& color,
                           float threshold)
 {
-    const float coef = 2.0f * (float)M_PI / segments;
-
     auto vertices = _abuf.get<Vec2>(segments + 2);
+    tessellateCircle(vertices, segments, center, radius, angle, scaleX, scaleY);
 
-    for (unsigned int i = 0; i <= segments; i++)
-    {
-        float rads    = i * coef;
-        vertices[i].x = radius * cosf(rads + angle) * scaleX + center.x;
-        vertices[i].y = radius * sinf(rads + angle) * scaleY + center.y;
-    }
     if (_lineWidth > threshold)
     {
         _isConvex = true;
@@ -532,11 +697,8 @@ void DrawNode::drawDot(const Vec2& pos, float radius, const Color4B& color)
     triangles[0]                    = triangle0;
     triangles[1]                    = triangle1;
 
-    _customCommandTriangle.updateVertexBuffer(triangles, _bufferCountTriangle * sizeof(V2F_C4B_T2F),
-                                              vertex_count * sizeof(V2F_C4B_T2F));
     _bufferCountTriangle += vertex_count;
     _dirtyTriangle = true;
-    _customCommandTriangle.setVertexDrawInfo(0, _bufferCountTriangle);
 }
 
 void DrawNode::drawRect(const Vec2& p1, const Vec2& p2, const Vec2& p3, const Vec2& p4, const Color4B& color)
@@ -552,72 +714,10 @@ void DrawNode::drawSegment(const Vec2& from, const Vec2& to, float radius, const
     unsigned int vertex_count = 6 * 3;
     ensureCapacity(vertex_count);
 
-    Vec2 a = from;
-    Vec2 b = to;
-
-    Vec2 n = ((b - a).getPerp()).getNormalized();
-    Vec2 t = n.getPerp();
-
-    Vec2 nw = n * radius;
-    Vec2 tw = t * radius;
-    Vec2 v0 = b - (nw + tw);
-    Vec2 v1 = b + (nw - tw);
-    Vec2 v2 = b - nw;
-    Vec2 v3 = b + nw;
-    Vec2 v4 = a - nw;
-    Vec2 v5 = a + nw;
-    Vec2 v6 = a - (nw - tw);
-    Vec2 v7 = a + (nw + tw);
-
-    V2F_C4B_T2F_Triangle* triangles = (V2F_C4B_T2F_Triangle*)(_bufferTriangle + _bufferCountTriangle);
-
-    V2F_C4B_T2F_Triangle triangles0 = {
-        {v0, color, v2ToTex2F(-(n + t))},
-        {v1, color, v2ToTex2F(n - t)},
-        {v2, color, v2ToTex2F(-n)},
-    };
-    triangles[0] = triangles0;
+    tessellateSegment((V2F_C4B_T2F_Triangle*)(_bufferTriangle + _bufferCountTriangle), from, to, radius, color);
 
-    V2F_C4B_T2F_Triangle triangles1 = {
-        {v3, color, v2ToTex2F(n)},
-        {v1, color, v2ToTex2F(n - t)},
-        {v2, color, v2ToTex2F(-n)},
-    };
-    triangles[1] = triangles1;
-
-    V2F_C4B_T2F_Triangle triangles2 = {
-        {v3, color, v2ToTex2F(n)},
-        {v4, color, v2ToTex2F(-n)},
-        {v2, color, v2ToTex2F(-n)},
-    };
-    triangles[2] = triangles2;
-
-    V2F_C4B_T2F_Triangle triangles3 = {
-        {v3, color, v2ToTex2F(n)},
-        {v4, color, v2ToTex2F(-n)},
-        {v5, color, v2ToTex2F(n)},
-    };
-    triangles[3] = triangles3;
-
-    V2F_C4B_T2F_Triangle triangles4 = {
-        {v6, color, v2ToTex2F(t - n)},
-        {v4, color, v2ToTex2F(-n)},
-        {v5, color, v2ToTex2F(n)},
-    };
-    triangles[4] = triangles4;
-
-    V2F_C4B_T2F_Triangle triangles5 = {
-        {v6, color, v2ToTex2F(t - n)},
-        {v7, color, v2ToTex2F(t + n)},
-        {v5, color, v2ToTex2F(n)},
-    };
-    triangles[5] = triangles5;
-
-    _customCommandTriangle.updateVertexBuffer(triangles, _bufferCountTriangle * sizeof(V2F_C4B_T2F),
-                                              vertex_count * sizeof(V2F_C4B_T2F));
     _bufferCountTriangle += vertex_count;
     _dirtyTriangle = true;
-    _customCommandTriangle.setVertexDrawInfo(0, _bufferCountTriangle);
 }
 
 void DrawNode::drawPolygon(const Vec2* verts,
@@ -630,8 +730,9 @@ void DrawNode::drawPolygon(const Vec2* verts,
 
     bool outline = (borderColor.a > 0.0f && borderWidth > 0.0f);
 
-    auto triangle_count = outline ? (3 * count - 2) : (count - 2);
-    auto vertex_count   = 3 * triangle_count;
+    auto vertex_count = polygonVertexCount(count, outline);
+    if (!vertex_count)
+        return;
     ensureCapacity(vertex_count);
 
     V2F_C4B_T2F_Triangle* triangles = (V2F_C4B_T2F_Triangle*)(_bufferTriangle + _bufferCountTriangle);
@@ -652,9 +753,11 @@ void DrawNode::drawPolygon(const Vec2* verts,
         cdt.Triangulate();
         std::vector<p2t::Triangle*> tris = cdt.GetTriangles();
 
-        if ((tris.size() * 3) > vertex_count)
+        auto fill_count = static_cast<unsigned int>(tris.size() * 3);
+        if (fill_count > 3u * (count - 2))
         {
-            ensureCapacity(static_cast<int>(tris.size() * 3));
+            vertex_count += fill_count - 3 * (count - 2);
+            ensureCapacity(vertex_count);
             triangles = (V2F_C4B_T2F_Triangle*)(_bufferTriangle + _bufferCountTriangle);
             cursor    = triangles;
         }
@@ -675,72 +778,14 @@ void DrawNode::drawPolygon(const Vec2* verts,
     }
     else
     {
-        for (int i = 0; i < count - 2; i++)
-        {
-            V2F_C4B_T2F_Triangle tmp = {
-                {verts[0], fillColor, v2ToTex2F(Vec2::ZERO)},
-                {verts[i + 1], fillColor, v2ToTex2F(Vec2::ZERO)},
-                {verts[i + 2], fillColor, v2ToTex2F(Vec2::ZERO)},
-            };
-
-            *cursor++ = tmp;
-        }
+        cursor = tessellateFan(cursor, verts, count, fillColor);
     }
     if (outline)
     {
-        struct ExtrudeVerts
-        {
-            Vec2 offset, n;
-        };
-        struct ExtrudeVerts* extrude = (struct ExtrudeVerts*)malloc(sizeof(struct ExtrudeVerts) * count);
-
-        for (int i = 0; i < count; i++)
-        {
-            Vec2 v0 = verts[(i - 1 + count) % count];
-            Vec2 v1 = verts[i];
-            Vec2 v2 = verts[(i + 1) % count];
-
-            Vec2 n1 = ((v1 - v0).getPerp()).getNormalized();
-            Vec2 n2 = ((v2 - v1).getPerp()).getNormalized();
-
-            Vec2 offset = (n1 + n2) * (1.0f / (Vec2::dot(n1, n2) + 1.0f));
-            extrude[i]  = {offset, n2};
-        }
-
-        for (int i = 0; i < count; i++)
-        {
-            int j   = (i + 1) % count;
-            Vec2 v0 = verts[i];
-            Vec2 v1 = verts[j];
-
-            Vec2 n0 = extrude[i].n;
-
-            Vec2 offset0 = extrude[i].offset;
-            Vec2 offset1 = extrude[j].offset;
-
-            Vec2 inner0 = v0 - offset0 * borderWidth;
-            Vec2 inner1 = v1 - offset1 * borderWidth;
-            Vec2 outer0 = v0 + offset0 * borderWidth;
-            Vec2 outer1 = v1 + offset1 * borderWidth;
-
-            V2F_C4B_T2F_Triangle tmp1 = {{inner0, borderColor, v2ToTex2F(-n0)},
-                                         {inner1, borderColor, v2ToTex2F(-n0)},
-                                         {outer1, borderColor, v2ToTex2F(n0)}};
-            *cursor++                 = tmp1;
-
-            V2F_C4B_T2F_Triangle tmp2 = {{inner0, borderColor, v2ToTex2F(-n0)},
-                                         {outer0, borderColor, v2ToTex2F(n0)},
-                                         {outer1, borderColor, v2ToTex2F(n0)}};
-            *cursor++                 = tmp2;
-        }
-
-        free(extrude);
+        cursor = tessellateOutline(cursor, verts, count, borderWidth, borderColor);
     }
 
-    _customCommandTriangle.updateVertexBuffer(triangles, _bufferCountTriangle * sizeof(V2F_C4B_T2F),
-                                              vertex_count * sizeof(V2F_C4B_T2F));
-    _bufferCountTriangle += vertex_count;
-    _customCommandTriangle.setVertexDrawInfo(0, _bufferCountTriangle);
+    _bufferCountTriangle += static_cast<int>(cursor - triangles) * 3;
     _dirtyTriangle = true;
 }
 
@@ -833,19 +878,9 @@ void DrawNode::drawSolidCircle(const Vec2& center,
                                float borderWidth,
                                const Color4B& borderColor)
 {
-    const float coef = 2.0f * (float)M_PI / segments;
-
-    Vec2* vertices = _abuf.get<Vec2>(segments);
-
-    for (unsigned int i = 0; i < segments; i++)
-    {
-        float rads = i * coef;
-        float j    = radius * cosf(rads + angle) * scaleX + center.x;
-        float k    = radius * sinf(rads + angle) * scaleY + center.y;
+    Vec2* vertices = _abuf.get<Vec2>(segments + 1);
+    tessellateCircle(vertices, segments, center, radius, angle, scaleX, scaleY);
 
-        vertices[i].x = j;
-        vertices[i].y = k;
-    }
     _isConvex = true;
     drawPolygon(vertices, segments, fillColor, borderWidth, borderColor);
     _isConvex = false;
@@ -859,19 +894,8 @@ void DrawNode::drawSolidCircle(const Vec2& center,
                                float scaleY,
                                const Color4B& color)
 {
-    const float coef = 2.0f * (float)M_PI / segments;
-
-    Vec2* vertices = _abuf.get<Vec2>(segments);
-
-    for (unsigned int i = 0; i < segments; i++)
-    {
-        float rads = i * coef;
-        float j    = radius * cosf(rads + angle) * scaleX + center.x;
-        float k    = radius * sinf(rads + angle) * scaleY + center.y;
-
-        vertices[i].x = j;
-        vertices[i].y = k;
-    }
+    Vec2* vertices = _abuf.get<Vec2>(segments + 1);
+    tessellateCircle(vertices, segments, center, radius, angle, scaleX, scaleY);
 
     drawSolidPoly(vertices, segments, color);
 }
@@ -898,22 +922,363 @@ void DrawNode::drawTriangle(const Vec2& p1, const Vec2& p2, const Vec2& p3, cons
     V2F_C4B_T2F_Triangle triangle   = {a, b, c};
     triangles[0]                    = triangle;
 
-    _customCommandTriangle.updateVertexBuffer(triangles, _bufferCountTriangle * sizeof(V2F_C4B_T2F),
-                                              vertex_count * sizeof(V2F_C4B_T2F));
     _bufferCountTriangle += vertex_count;
     _dirtyTriangle = true;
-    _customCommandTriangle.setVertexDrawInfo(0, _bufferCountTriangle);
+}
+
+void DrawNode::tessellateCircle(Vec2* dst,
+                                unsigned int segments,
+                                const Vec2& center,
+                                float radius,
+                                float angle,
+                                float scaleX,
+                                float scaleY)
+{
+    // The sines and cosines are computed once per segment count, the points are the unit circle scaled, rotated and
+    // translated, which MathUtil does a few points per SIMD instruction
+    if (_unitCircleSegments != segments || _unitCircle.empty())
+    {
+        const double coef = 2.0 * M_PI / segments;
+        _unitCircle.resize(segments + 1);
+        for (unsigned int i = 0; i < segments; i++)
+            _unitCircle[i] = Vec2((float)cos(i * coef), (float)sin(i * coef));
+        _unitCircle[segments] = _unitCircle[0];
+        _unitCircleSegments   = segments;
+    }
+
+    float c = cosf(angle);
+    float s = sinf(angle);
+    AffineTransform t{radius * scaleX * c, radius * scaleY * s, -radius * scaleX * s, radius * scaleY * c,
+                      center.x,            center.y};
+    MathUtil::transformPoints(dst, _unitCircle.data(), segments + 1, t);
 }
 
 void DrawNode::clear()
 {
-    _bufferCountTriangle = 0;
-    _dirtyTriangle       = true;
-    _bufferCountLine     = 0;
-    _dirtyLine           = true;
-    _bufferCountPoint    = 0;
-    _dirtyPoint          = true;
-    _lineWidth           = _defaultLineWidth;
+    _bufferCountTriangle   = 0;
+    _uploadedCountTriangle = 0;
+    _dirtyTriangle         = true;
+    _bufferCountLine       = 0;
+    _uploadedCountLine     = 0;
+    _dirtyLine             = true;
+    _bufferCountPoint      = 0;
+    _uploadedCountPoint    = 0;
+    _dirtyPoint            = true;
+    _lineWidth             = _defaultLineWidth;
+}
+
+int DrawNode::newPrimitive(RetainedBufferType type)
+{
+    int id;
+    if (!_freePrimitives.empty())
+    {
+        id = _freePrimitives.back();
+        _freePrimitives.pop_back();
+    }
+    else
+    {
+        id = static_cast<int>(_primitives.size());
+        _primitives.emplace_back();
+    }
+
+    auto& primitive    = _primitives[id];
+    primitive.buffer   = type;
+    primitive.first    = static_cast<unsigned int>(_retained[type].vertices.size());
+    primitive.size     = 0;
+    primitive.capacity = 0;
+    return id;
+}
+
+V2F_C4B_T2F* DrawNode::retainVertices(int id, RetainedBufferType type, unsigned int count)
+{
+    AXASSERT(id >= 0 && id < static_cast<int>(_primitives.size()) && _primitives[id].buffer >= 0,
+             "invalid primitive id");
+
+    auto& primitive = _primitives[id];
+    if (primitive.buffer != type || count > primitive.capacity || !primitive.capacity)
+    {
+        // Move to a new slot at the end
+        releaseSlot(primitive);
+        auto& rb           = _retained[type];
+        primitive.buffer   = type;
+        primitive.first    = static_cast<unsigned int>(rb.vertices.size());
+        primitive.size     = 0;
+        primitive.capacity = count;
+        rb.vertices.resize(rb.vertices.size() + count);
+    }
+
+    // The vertices left by a larger geometry become degenerate triangles or lines, with transparent color
+    auto& rb        = _retained[type];
+    auto vertices   = rb.vertices.data() + primitive.first;
+    auto dirtyCount = std::max(count, primitive.size);
+    if (count < primitive.size)
+        std::fill(vertices + count, vertices + primitive.size, V2F_C4B_T2F{});
+    primitive.size = count;
+
+    if (dirtyCount)
+        rb.dirtyRanges.emplace_back(primitive.first, primitive.first + dirtyCount);
+    return vertices;
+}
+
+void DrawNode::releaseSlot(Primitive& primitive)
+{
+    if (primitive.buffer < 0 || !primitive.capacity)
+        return;
+
+    auto& rb = _retained[primitive.buffer];
+    if (primitive.first + primitive.capacity == rb.vertices.size())
+    {
+        // The last slot is just dropped, the vertices drawn shrink
+        rb.vertices.resize(primitive.first);
+    }
+    else
+    {
+        auto vertices = rb.vertices.data() + primitive.first;
+        std::fill(vertices, vertices + primitive.size, V2F_C4B_T2F{});
+        if (primitive.size)
+            rb.dirtyRanges.emplace_back(primitive.first, primitive.first + primitive.size);
+        rb.freeCount += primitive.capacity;
+    }
+    primitive.size     = 0;
+    primitive.capacity = 0;
+}
+
+void DrawNode::compactRetained(RetainedBufferType type)
+{
+    auto& rb = _retained[type];
+
+    auto ids = _abuf.get<int>(_primitives.size());
+    int n    = 0;
+    for (int id = 0; id < static_cast<int>(_primitives.size()); ++id)
+    {
+        if (_primitives[id].buffer == type)
+            ids[n++] = id;
+    }
+    std::sort(ids, ids + n, [this](int a, int b) { return _primitives[a].first < _primitives[b].first; });
+
+    // Keep the order of the slots, so the primitives are drawn in the same order
+    unsigned int cursor = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        auto& primitive = _primitives[ids[i]];
+        if (primitive.first != cursor && primitive.size)
+            memmove(rb.vertices.data() + cursor, rb.vertices.data() + primitive.first,
+                    primitive.size * sizeof(V2F_C4B_T2F));
+        primitive.first    = cursor;
+        primitive.capacity = primitive.size;
+        cursor += primitive.size;
+    }
+
+    rb.vertices.resize(cursor);
+    rb.freeCount = 0;
+    rb.dirtyRanges.clear();
+    rb.dirtyRanges.emplace_back(0, cursor);
+}
+
+void DrawNode::updateRetained(RetainedBufferType type)
+{
+    auto& rb = _retained[type];
+    if (rb.freeCount > 1024 && rb.freeCount * 2 > rb.vertices.size())
+        compactRetained(type);
+
+    if (!rb.vertices.empty())
+        uploadRetained(rb);
+}
+
+void DrawNode::mergeDirtyRanges(std::vector<std::pair<unsigned int, unsigned int>>& ranges)
+{
+    // Merge the ranges overlapping or close to each other
+    constexpr unsigned int MERGE_GAP = 256;
+
+    if (ranges.empty())
+        return;
+
+    std::sort(ranges.begin(), ranges.end());
+    size_t merged = 0;
+    for (size_t i = 1; i < ranges.size(); ++i)
+    {
+        if (ranges[i].first <= ranges[merged].second + MERGE_GAP)
+            ranges[merged].second = std::max(ranges[merged].second, ranges[i].second);
+        else
+            ranges[++merged] = ranges[i];
+    }
+    ranges.resize(merged + 1);
+}
+
+void DrawNode::uploadRetained(RetainedBuffer& rb)
+{
+    auto& cmd  = rb.command;
+    auto count = rb.vertices.size();
+
+    if (count > rb.gpuCapacity)
+    {
+        rb.gpuCapacity = rb.vertices.capacity();
+        cmd.createVertexBuffer(sizeof(V2F_C4B_T2F), rb.gpuCapacity, CustomCommand::BufferUsage::DYNAMIC);
+        cmd.updateVertexBuffer(rb.vertices.data(), 0, count * sizeof(V2F_C4B_T2F));
+        rb.dirtyRanges.clear();
+    }
+    else if (!rb.dirtyRanges.empty())
+    {
+        auto& ranges = rb.dirtyRanges;
+        mergeDirtyRanges(ranges);
+        for (auto& range : ranges)
+        {
+            // The ranges of the slots dropped from the end may be out of the vertices
+            size_t last = std::min<size_t>(range.second, count);
+            if (range.first < last)
+                cmd.updateVertexBuffer(rb.vertices.data() + range.first, range.first * sizeof(V2F_C4B_T2F),
+                                       (last - range.first) * sizeof(V2F_C4B_T2F));
+        }
+        ranges.clear();
+    }
+
+    cmd.setVertexDrawInfo(0, count);
+}
+
+void DrawNode::retainPolygon(int id,
+                             const Vec2* verts,
+                             int count,
+                             const Color4B& fillColor,
+                             float borderWidth,
+                             const Color4B& borderColor)
+{
+    bool outline = (borderColor.a > 0 && borderWidth > 0.0f);
+
+    auto vertex_count = polygonVertexCount(count, outline);
+    auto triangles    = (V2F_C4B_T2F_Triangle*)retainVertices(id, RETAINED_TRIANGLE, vertex_count);
+    if (!vertex_count)
+        return;
+
+    auto cursor = tessellateFan(triangles, verts, count, fillColor);
+    if (outline)
+        tessellateOutline(cursor, verts, count, borderWidth, borderColor);
+}
+
+int DrawNode::addSolidCircle(const Vec2& center,
+                             float radius,
+                             unsigned int segments,
+                             const Color4B& fillColor,
+                             float borderWidth,
+                             const Color4B& borderColor)
+{
+    int id = newPrimitive(RETAINED_TRIANGLE);
+    updateSolidCircle(id, center, radius, segments, fillColor, borderWidth, borderColor);
+    return id;
+}
+
+void DrawNode::updateSolidCircle(int id,
+                                 const Vec2& center,
+                                 float radius,
+                                 unsigned int segments,
+                                 const Color4B& fillColor,
+                                 float borderWidth,
+                                 const Color4B& borderColor)
+{
+    if (segments < 3)
+    {
+        retainVertices(id, RETAINED_TRIANGLE, 0);
+        return;
+    }
+
+    Vec2* vertices = _abuf.get<Vec2>(segments + 1);
+    tessellateCircle(vertices, segments, center, radius, 0.0f);
+    retainPolygon(id, vertices, segments, fillColor, borderWidth, borderColor);
+}
+
+int DrawNode::addCircle(const Vec2& center, float radius, unsigned int segments, const Color4B& color)
+{
+    int id = newPrimitive(RETAINED_LINE);
+    updateCircle(id, center, radius, segments, color);
+    return id;
+}
+
+void DrawNode::updateCircle(int id, const Vec2& center, float radius, unsigned int segments, const Color4B& color)
+{
+    if (segments < 2)
+    {
+        retainVertices(id, RETAINED_LINE, 0);
+        return;
+    }
+
+    Vec2* vertices = _abuf.get<Vec2>(segments + 1);
+    tessellateCircle(vertices, segments, center, radius, 0.0f);
+    tessellateLines(retainVertices(id, RETAINED_LINE, linesVertexCount(segments, true)), vertices, segments, true,
+                    color);
+}
+
+int DrawNode::addPolygon(const Vec2* verts,
+                         int count,
+                         const Color4B& fillColor,
+                         float borderWidth,
+                         const Color4B& borderColor)
+{
+    int id = newPrimitive(RETAINED_TRIANGLE);
+    retainPolygon(id, verts, count, fillColor, borderWidth, borderColor);
+    return id;
+}
+
+void DrawNode::updatePolygon(int id,
+                             const Vec2* verts,
+                             int count,
+                             const Color4B& fillColor,
+                             float borderWidth,
+                             const Color4B& borderColor)
+{
+    retainPolygon(id, verts, count, fillColor, borderWidth, borderColor);
+}
+
+int DrawNode::addSegment(const Vec2& from, const Vec2& to, float radius, const Color4B& color)
+{
+    int id = newPrimitive(RETAINED_TRIANGLE);
+    updateSegment(id, from, to, radius, color);
+    return id;
+}
+
+void DrawNode::updateSegment(int id, const Vec2& from, const Vec2& to, float radius, const Color4B& color)
+{
+    tessellateSegment((V2F_C4B_T2F_Triangle*)retainVertices(id, RETAINED_TRIANGLE, 6 * 3), from, to, radius, color);
+}
+
+int DrawNode::addPoly(const Vec2* poli, unsigned int numberOfPoints, bool closePolygon, const Color4B& color)
+{
+    int id = newPrimitive(RETAINED_LINE);
+    updatePoly(id, poli, numberOfPoints, closePolygon, color);
+    return id;
+}
+
+void DrawNode::updatePoly(int id,
+                          const Vec2* poli,
+                          unsigned int numberOfPoints,
+                          bool closePolygon,
+                          const Color4B& color)
+{
+    auto vertex_count = linesVertexCount(numberOfPoints, closePolygon);
+    auto vertices     = retainVertices(id, RETAINED_LINE, vertex_count);
+    if (vertex_count)
+        tessellateLines(vertices, poli, numberOfPoints, closePolygon, color);
+}
+
+void DrawNode::removePrimitive(int id)
+{
+    AXASSERT(id >= 0 && id < static_cast<int>(_primitives.size()) && _primitives[id].buffer >= 0,
+             "invalid primitive id");
+
+    auto& primitive = _primitives[id];
+    releaseSlot(primitive);
+    primitive.buffer = -1;
+    _freePrimitives.emplace_back(id);
+}
+
+void DrawNode::removeAllPrimitives()
+{
+    for (auto& rb : _retained)
+    {
+        rb.vertices.clear();
+        rb.dirtyRanges.clear();
+        rb.freeCount = 0;
+    }
+    _primitives.clear();
+    _freePrimitives.clear();
 }
 
 const BlendFunc& DrawNode::getBlendFunc() const
@@ -372,8 +372,67 @@ public:
 
     void drawTriangle(const Vec2& p1, const Vec2& p2, const Vec2& p3, const Color4B& color);
 
-    /** Clear the geometry in the node's buffer. */
+    /** Clear the geometry in the node's buffer, the retained primitives are kept. */
     void clear();
+
+    /** @name Retained primitives
+     * Unlike the draw methods, a retained primitive stays in the node until it's removed, and can be updated
+     * individually by the id returned when it was added. Only the vertices of the primitives changed since the last
+     * frame are uploaded, so a few shapes updated per frame don't re-upload the whole geometry.
+     * The retained primitives are drawn over the geometry of the draw methods, triangles first and then lines,
+     * in the order they were added. A primitive updated with more vertices than it had is moved to the end.
+     * An id may be reused by a later add after it was removed.
+     * @{
+     */
+
+    /** Add a solid circle, with an optional border. */
+    int addSolidCircle(const Vec2& center,
+                       float radius,
+                       unsigned int segments,
+                       const Color4B& fillColor,
+                       float borderWidth          = 0.0f,
+                       const Color4B& borderColor = Color4B());
+    void updateSolidCircle(int id,
+                           const Vec2& center,
+                           float radius,
+                           unsigned int segments,
+                           const Color4B& fillColor,
+                           float borderWidth          = 0.0f,
+                           const Color4B& borderColor = Color4B());
+
+    /** Add the outline of a circle. */
+    int addCircle(const Vec2& center, float radius, unsigned int segments, const Color4B& color);
+    void updateCircle(int id, const Vec2& center, float radius, unsigned int segments, const Color4B& color);
+
+    /** Add a convex polygon, with an optional border. */
+    int addPolygon(const Vec2* verts,
+                   int count,
+                   const Color4B& fillColor,
+                   float borderWidth          = 0.0f,
+                   const Color4B& borderColor = Color4B());
+    void updatePolygon(int id,
+                       const Vec2* verts,
+                       int count,
+                       const Color4B& fillColor,
+                       float borderWidth          = 0.0f,
+                       const Color4B& borderColor = Color4B());
+
+    /** Add a thick line with round caps. */
+    int addSegment(const Vec2& from, const Vec2& to, float radius, const Color4B& color);
+    void updateSegment(int id, const Vec2& from, const Vec2& to, float radius, const Color4B& color);
+
+    /** Add an open or closed polyline. */
+    int addPoly(const Vec2* poli, unsigned int numberOfPoints, bool closePolygon, const Color4B& color);
+    void updatePoly(int id, const Vec2* poli, unsigned int numberOfPoints, bool closePolygon, const Color4B& color);
+
+    void removePrimitive(int id);
+    void removeAllPrimitives();
+
+    /** The count of the retained primitives. */
+    size_t getPrimitiveCount() const { return _primitives.size() - _freePrimitives.size(); }
+
+    /** @} */
+
     /** Get the color mixed mode.
      * @lua NA
      */
@@ -427,21 +486,79 @@ protected:
 
     void updateBlendState(CustomCommand& cmd);
     void updateUniforms(const Mat4& transform, CustomCommand& cmd);
+    void updateVertexBuffer(CustomCommand& cmd, V2F_C4B_T2F* buffer, int count, int& uploadedCount);
+    void addDrawCommand(Renderer* renderer, const Mat4& transform, CustomCommand& cmd);
+
+    /** The points of a circle, or an ellipse when scaleX != scaleY, written to the segments + 1 points of dst. */
+    void tessellateCircle(Vec2* dst,
+                          unsigned int segments,
+                          const Vec2& center,
+                          float radius,
+                          float angle,
+                          float scaleX = 1.0f,
+                          float scaleY = 1.0f);
+
+    enum RetainedBufferType : int8_t
+    {
+        RETAINED_TRIANGLE,
+        RETAINED_LINE,
+        RETAINED_COUNT,
+    };
+
+    // The vertices of the retained primitives, each primitive owns a contiguous slot
+    struct RetainedBuffer
+    {
+        std::vector<V2F_C4B_T2F> vertices;
+        std::vector<std::pair<unsigned int, unsigned int>> dirtyRanges;  // [first, last) vertices to upload
+        size_t freeCount   = 0;  // vertices of the slots released, reclaimed by compact
+        size_t gpuCapacity = 0;
+        CustomCommand command;
+    };
+
+    struct Primitive
+    {
+        int8_t buffer         = -1;  // the RetainedBufferType, -1 if the id is free
+        unsigned int first    = 0;
+        unsigned int size     = 0;  // the vertices in the slot, the tail up to capacity is degenerate
+        unsigned int capacity = 0;
+    };
+
+    int newPrimitive(RetainedBufferType type);
+    V2F_C4B_T2F* retainVertices(int id, RetainedBufferType type, unsigned int count);
+    void releaseSlot(Primitive& primitive);
+    void compactRetained(RetainedBufferType type);
+    /** Compacts the buffer when more than half of it is free, then uploads its dirty ranges. */
+    void updateRetained(RetainedBufferType type);
+    void uploadRetained(RetainedBuffer& rb);
+    static void mergeDirtyRanges(std::vector<std::pair<unsigned int, unsigned int>>& ranges);
+    void retainPolygon(int id, const Vec2* verts, int count, const Color4B& fillColor, float borderWidth,
+                       const Color4B& borderColor);
 
     int _bufferCapacityTriangle  = 0;
     int _bufferCountTriangle     = 0;
+    int _uploadedCountTriangle   = 0;  // vertices of the buffer already uploaded to the GPU
     V2F_C4B_T2F* _bufferTriangle = nullptr;
 
     int _bufferCapacityPoint  = 0;
     int _bufferCountPoint     = 0;
+    int _uploadedCountPoint   = 0;
     V2F_C4B_T2F* _bufferPoint = nullptr;
     Color4F _pointColor;
     int _pointSize = 0;
 
     int _bufferCapacityLine  = 0;
     int _bufferCountLine     = 0;
+    int _uploadedCountLine   = 0;
     V2F_C4B_T2F* _bufferLine = nullptr;
 
+    RetainedBuffer _retained[RETAINED_COUNT];
+    std::vector<Primitive> _primitives;
+    std::vector<int> _freePrimitives;
+
+    // The unit circle of the last segment count tessellated
+    std::vector<Vec2> _unitCircle;
+    unsigned int _unitCircleSegments = 0;
+
     BlendFunc _blendFunc;
 
     CustomCommand _customCommandTriangle;
@@ -38,6 +38,8 @@ THE SOFTWARE.
  */
 #include "2d/FastTMXLayer.h"
 #include <stddef.h>  // offsetof
+#include <algorithm>
+#include <limits>
 #include "base/Types.h"
 #include "2d/FastTMXTiledMap.h"
 #include "2d/Sprite.h"
@@ -119,22 +121,17 @@ FastTMXLayer::~FastTMXLayer()
     AX_SAFE_RELEASE(_tileSet);
     AX_SAFE_RELEASE(_texture);
     AX_SAFE_FREE(_tiles);
-    AX_SAFE_RELEASE(_vertexBuffer);
-    AX_SAFE_RELEASE(_indexBuffer);
-
-    for (auto&& e : _customCommands)
-    {
-        AX_SAFE_RELEASE(e.second->getPipelineDescriptor().programState);
-        delete e.second;
-    }
+    AX_SAFE_RELEASE(_tilesCommand.getPipelineDescriptor().programState);
+    AX_SAFE_RELEASE(_animTilesCommand.getPipelineDescriptor().programState);
 }
 
 void FastTMXLayer::draw(Renderer* renderer, const Mat4& transform, uint32_t flags)
 {
     updateTotalQuads();
+    updateAnimTiles();
 
     auto cam = Camera::getVisitingCamera();
-    if (flags != 0 || _dirty || _quadsDirty || !_cameraPositionDirty.fuzzyEquals(cam->getPosition(), _tileSet->_tileSize.x) ||
+    if (flags != 0 || _dirty || !_cameraPositionDirty.fuzzyEquals(cam->getPosition(), _tileSet->_tileSize.x) ||
         _cameraZoomDirty != cam->getZoom())
     {
         _cameraPositionDirty = cam->getPosition();
@@ -155,23 +152,30 @@ void FastTMXLayer::draw(Renderer* renderer, const Mat4& transform, uint32_t flag
         rect = RectApplyTransform(rect, inv);
 
         updateTiles(rect);
-        updateIndexBuffer();
-        updatePrimitives();
         _dirty = false;
     }
 
     const auto& projectionMat = _director->getMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION);
     Mat4 finalMat             = projectionMat * _modelViewTransform;
-    for (const auto& e : _customCommands)
-    {
-        if (e.second->getIndexDrawCount() > 0)
+    auto blendfunc =
+        _texture->hasPremultipliedAlpha() ? BlendFunc::ALPHA_PREMULTIPLIED : BlendFunc::ALPHA_NON_PREMULTIPLIED;
+    auto addCommand = [&](CustomCommand* command) {
+        if (command->getIndexDrawCount() > 0)
         {
-            auto mvpmatrixLocation = e.second->getPipelineDescriptor().programState->getUniformLocation("u_MVPMatrix");
-            e.second->getPipelineDescriptor().programState->setUniform(mvpmatrixLocation, finalMat.m,
-                                                                       sizeof(finalMat.m));
-            renderer->addCommand(e.second);
+            command->init(_globalZOrder, blendfunc);
+            command->getPipelineDescriptor().programState->setUniform(_mvpMatrixLocaiton, finalMat.m,
+                                                                      sizeof(finalMat.m));
+            renderer->addCommand(command);
         }
+    };
+    if (_useAutomaticVertexZ)
+    {
+        for (size_t i = 0; i < _vertexZCommandCount; ++i)
+            addCommand(&_vertexZCommands[i].command);
     }
+    else
+        addCommand(&_tilesCommand);
+    addCommand(&_animTilesCommand);
 }
 
 void FastTMXLayer::updateTiles(const Rect& culledRect)
@@ -224,13 +228,6 @@ void FastTMXLayer::updateTiles(const Rect& culledRect)
         // AXASSERT(0, "TMX invalid value");
     }
 
-    _indicesVertexZNumber.clear();
-
-    for (const auto& iter : _indicesVertexZOffsets)
-    {
-        _indicesVertexZNumber[iter.first] = iter.second;
-    }
-
     int yBegin = static_cast<int>(std::max(0.f, visibleTiles.origin.y - tilesOverY));
     int yEnd =
         static_cast<int>(std::min(_layerSize.height, visibleTiles.origin.y + visibleTiles.size.height + tilesOverY));
@@ -238,58 +235,245 @@ void FastTMXLayer::updateTiles(const Rect& culledRect)
     int xEnd =
         static_cast<int>(std::min(_layerSize.width, visibleTiles.origin.x + visibleTiles.size.width + tilesOverX));
 
-    for (int y = yBegin; y < yEnd; ++y)
+    // the chunks covering the visible tiles
+    int visibleChunks[4] = {xBegin / CHUNK_SIZE, yBegin / CHUNK_SIZE, 0, 0};
+    visibleChunks[2]     = xEnd > xBegin ? (xEnd + CHUNK_SIZE - 1) / CHUNK_SIZE : visibleChunks[0];
+    visibleChunks[3]     = yEnd > yBegin ? (yEnd + CHUNK_SIZE - 1) / CHUNK_SIZE : visibleChunks[1];
+    if (memcmp(visibleChunks, _visibleChunks, sizeof(visibleChunks)) != 0)
     {
-        for (int x = xBegin; x < xEnd; ++x)
+        memcpy(_visibleChunks, visibleChunks, sizeof(visibleChunks));
+        _indicesDirty = true;
+    }
+
+    // the slots of the visible chunks can't be taken by the other visible chunks
+    const int visibleCount = (visibleChunks[2] - visibleChunks[0]) * (visibleChunks[3] - visibleChunks[1]);
+    ++_visibleStamp;
+    for (int cy = visibleChunks[1]; cy < visibleChunks[3]; ++cy)
+        for (int cx = visibleChunks[0]; cx < visibleChunks[2]; ++cx)
+            _chunks[cx + cy * _chunksX].visibleStamp = _visibleStamp;
+
+    bool restart;
+    do
+    {
+        restart = false;
+        for (int cy = visibleChunks[1]; cy < visibleChunks[3] && !restart; ++cy)
         {
-            int tileIndex = getTileIndexByPos(x, y);
-            if (_tiles[tileIndex] == 0)
-                continue;
+            for (int cx = visibleChunks[0]; cx < visibleChunks[2]; ++cx)
+            {
+                if (!_chunks[cx + cy * _chunksX].dirty)
+                    continue;
 
-            int vertexZ = getVertexZForPos(Vec2((float)x, (float)y));
-            auto iter   = _indicesVertexZNumber.find(vertexZ);
-            int offset  = iter->second;
-            iter->second++;
+                _indicesDirty = true;
+                if (!updateChunk(cx + cy * _chunksX))
+                {
+                    // all slots are visible, the resident chunks are dropped when the buffer grows
+                    restart = reserveChunkSlots(visibleCount);
+                    if (restart)
+                        break;
+                }
+            }
+        }
+    } while (restart);
 
-            auto quadIndex = static_cast<decltype(_indices)::value_type>(_tileToQuadIndex[tileIndex]);
-            _indices[6 * offset + 0] = quadIndex * 4 + 0;
-            _indices[6 * offset + 1] = quadIndex * 4 + 1;
-            _indices[6 * offset + 2] = quadIndex * 4 + 2;
-            _indices[6 * offset + 3] = quadIndex * 4 + 3;
-            _indices[6 * offset + 4] = quadIndex * 4 + 2;
-            _indices[6 * offset + 5] = quadIndex * 4 + 1;
+    if (_indicesDirty)
+        updateIndexBuffer();
+}
+
+void FastTMXLayer::updateIndexBuffer()
+{
+    _indices.clear();
+    _vertexZQuads.clear();
+    auto appendQuad = [this](index_type vertex) {
+        _indices.insert(_indices.end(),
+                        {static_cast<index_type>(vertex + 0), static_cast<index_type>(vertex + 1),
+                         static_cast<index_type>(vertex + 2), static_cast<index_type>(vertex + 3),
+                         static_cast<index_type>(vertex + 2), static_cast<index_type>(vertex + 1)});
+    };
+
+    // append the rows of the visible chunks in the order of the map
+    for (int cy = _visibleChunks[1]; cy < _visibleChunks[3]; ++cy)
+    {
+        for (int row = 0; row < CHUNK_SIZE; ++row)
+        {
+            for (int cx = _visibleChunks[0]; cx < _visibleChunks[2]; ++cx)
+            {
+                const auto& chunk = _chunks[cx + cy * _chunksX];
+                if (chunk.dirty || chunk.slot < 0)
+                    continue;
 
-        }  // for x
-    }      // for y
+                auto base = static_cast<index_type>(chunk.slot * CHUNK_QUADS * 4);
+                for (int quad = chunk.rowQuads[row]; quad < chunk.rowQuads[row + 1]; ++quad)
+                {
+                    auto vertex = static_cast<index_type>(base + quad * 4);
+                    if (_useAutomaticVertexZ)
+                    {
+                        int x = cx * CHUNK_SIZE + _slotQuadColumns[chunk.slot * CHUNK_QUADS + quad];
+                        int y = cy * CHUNK_SIZE + row;
+                        _vertexZQuads.emplace_back(getVertexZForPos(Vec2((float)x, (float)y)), vertex);
+                    }
+                    else
+                        appendQuad(vertex);
+                }
+            }
+        }
+    }
 
-    for (const auto& iter : _indicesVertexZOffsets)
+    // the tiles of the same vertexZ keep the order of the map, each vertexZ has its command
+    _vertexZCommandCount = 0;
+    if (_useAutomaticVertexZ)
     {
-        _indicesVertexZNumber[iter.first] -= iter.second;
-        if (_indicesVertexZNumber[iter.first] == 0)
+        std::stable_sort(_vertexZQuads.begin(), _vertexZQuads.end(),
+                         [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+        VertexZCommand* current = nullptr;
+        for (auto&& [vertexZ, vertex] : _vertexZQuads)
         {
-            _indicesVertexZNumber.erase(iter.first);
+            if (!current || current->vertexZ != vertexZ)
+            {
+                if (_vertexZCommandCount == _vertexZCommands.size())
+                    _vertexZCommands.emplace_back();
+                current          = &_vertexZCommands[_vertexZCommandCount++];
+                current->vertexZ = vertexZ;
+
+                auto& command = current->command;
+                command.setVertexBuffer(_tilesCommand.getVertexBuffer());
+                command.setIndexBuffer(_tilesCommand.getIndexBuffer(), _tilesCommand.getIndexFormat());
+                command.getPipelineDescriptor().programState = _tilesCommand.getPipelineDescriptor().programState;
+                command.setIndexDrawInfo(_indices.size(), 0);
+            }
+            appendQuad(vertex);
+            current->command.setIndexDrawInfo(current->command.getIndexDrawOffset(),
+                                              _indices.size() - current->command.getIndexDrawOffset());
         }
     }
+
+    if (!_indices.empty())
+        _tilesCommand.updateIndexBuffer(_indices.data(), sizeof(_indices[0]) * _indices.size());
+    _tilesCommand.setIndexDrawInfo(0, _indices.size());
+    _indicesDirty = false;
 }
 
-void FastTMXLayer::updateVertexBuffer()
+bool FastTMXLayer::updateChunk(int chunkIndex)
 {
-    unsigned int vertexBufferSize = (unsigned int)(sizeof(V3F_C4B_T2F) * _totalQuads.size() * 4);
-    if (!_vertexBuffer)
+    auto& chunk = _chunks[chunkIndex];
+    int xBegin  = (chunkIndex % _chunksX) * CHUNK_SIZE;
+    int yBegin  = (chunkIndex / _chunksX) * CHUNK_SIZE;
+    int xEnd    = std::min(xBegin + CHUNK_SIZE, static_cast<int>(_layerSize.width));
+    int yEnd    = std::min(yBegin + CHUNK_SIZE, static_cast<int>(_layerSize.height));
+
+    uint8_t columns[CHUNK_QUADS];
+    _chunkQuads.clear();
+    for (int row = 0; row < CHUNK_SIZE; ++row)
+    {
+        chunk.rowQuads[row] = static_cast<uint16_t>(_chunkQuads.size());
+        for (int y = yBegin + row, x = xBegin; y < yEnd && x < xEnd; ++x)
+        {
+            int tileIndex = getTileIndexByPos(x, y);
+            if (_tiles[tileIndex] == 0 || _animTileQuads.find(tileIndex) != _animTileQuads.end())
+                continue;
+            columns[_chunkQuads.size()] = static_cast<uint8_t>(x - xBegin);
+            setupQuad(_chunkQuads.emplace_back(), x, y, _tiles[tileIndex]);
+        }
+    }
+    chunk.rowQuads[CHUNK_SIZE] = static_cast<uint16_t>(_chunkQuads.size());
+
+    if (_chunkQuads.empty())
     {
-        _vertexBuffer = backend::DriverBase::getInstance()->newBuffer(vertexBufferSize, backend::BufferType::VERTEX, backend::BufferUsage::STATIC);
+        // an empty chunk needs no slot
+        if (chunk.slot >= 0)
+        {
+            _slotChunks[chunk.slot] = -1;
+            _freeSlots.emplace_back(chunk.slot);
+            chunk.slot = -1;
+        }
+        chunk.dirty = false;
+        return true;
+    }
+
+    if (chunk.slot < 0)
+    {
+        chunk.slot = acquireChunkSlot();
+        if (chunk.slot < 0)
+            return false;
+        _slotChunks[chunk.slot] = chunkIndex;
     }
-    _vertexBuffer->updateData(&_totalQuads[0], vertexBufferSize);
+
+    _tilesCommand.updateVertexBuffer(_chunkQuads.data(), sizeof(V3F_C4B_T2F_Quad) * CHUNK_QUADS * chunk.slot,
+                                     sizeof(V3F_C4B_T2F_Quad) * _chunkQuads.size());
+    memcpy(&_slotQuadColumns[chunk.slot * CHUNK_QUADS], columns, _chunkQuads.size());
+    chunk.dirty = false;
+    return true;
 }
 
-void FastTMXLayer::updateIndexBuffer()
+int FastTMXLayer::acquireChunkSlot()
 {
-    auto indexBufferSize = (sizeof(decltype(_indices)::value_type) * _indices.size());
-    if (!_indexBuffer)
+    if (!_freeSlots.empty())
+    {
+        int slot = _freeSlots.back();
+        _freeSlots.pop_back();
+        return slot;
+    }
+
+    // take the slot of the chunk invisible for the longest time
+    int slot = -1;
+    for (int i = 0, count = static_cast<int>(_slotChunks.size()); i < count; ++i)
     {
-        _indexBuffer = backend::DriverBase::getInstance()->newBuffer(indexBufferSize, backend::BufferType::INDEX, backend::BufferUsage::DYNAMIC);
+        auto& chunk = _chunks[_slotChunks[i]];
+        if (chunk.visibleStamp != _visibleStamp &&
+            (slot < 0 || chunk.visibleStamp < _chunks[_slotChunks[slot]].visibleStamp))
+            slot = i;
     }
-    _indexBuffer->updateData(&_indices[0], indexBufferSize);
+    if (slot >= 0)
+    {
+        auto& chunk = _chunks[_slotChunks[slot]];
+        chunk.slot  = -1;
+        chunk.dirty = true;
+    }
+    return slot;
+}
+
+bool FastTMXLayer::reserveChunkSlots(int count)
+{
+#ifdef AX_FAST_TILEMAP_32_BIT_INDICES
+    constexpr int maxSlots = std::numeric_limits<int>::max() / (CHUNK_QUADS * 6);
+#else
+    constexpr int maxSlots = 65536 / (CHUNK_QUADS * 4);
+#endif
+    // keep some invisible chunks, so scrolling back and forth doesn't rebuild them
+    int slotCount = std::min(std::max(count + count / 2, 4), maxSlots);
+    if (slotCount <= static_cast<int>(_slotChunks.size()))
+    {
+        static bool warned = false;
+        if (!warned)
+        {
+            AXLOGW("FastTMXLayer: too many visible tiles for the 16 bits indices, some of them are not drawn");
+            warned = true;
+        }
+        return false;
+    }
+
+    for (auto chunkIndex : _slotChunks)
+    {
+        if (chunkIndex >= 0)
+        {
+            _chunks[chunkIndex].slot  = -1;
+            _chunks[chunkIndex].dirty = true;
+        }
+    }
+    _slotChunks.assign(slotCount, -1);
+    _slotQuadColumns.assign(static_cast<size_t>(slotCount) * CHUNK_QUADS, 0);
+    _freeSlots.resize(slotCount);
+    for (int i = 0; i < slotCount; ++i)
+        _freeSlots[i] = slotCount - 1 - i;
+
+    // the quads of a slot are updated seldom, and the unused part is never drawn
+    std::vector<V3F_C4B_T2F_Quad> quads(static_cast<size_t>(slotCount) * CHUNK_QUADS);
+    _tilesCommand.createVertexBuffer(sizeof(V3F_C4B_T2F), quads.size() * 4, CustomCommand::BufferUsage::STATIC);
+    _tilesCommand.updateVertexBuffer(quads.data(), sizeof(quads[0]) * quads.size());
+    _tilesCommand.createIndexBuffer(sizeof(index_type) == 4 ? CustomCommand::IndexFormat::U_INT
+                                                            : CustomCommand::IndexFormat::U_SHORT,
+                                    quads.size() * 6, CustomCommand::BufferUsage::DYNAMIC);
+    _indicesDirty = true;
+    return true;
 }
 
 // FastTMXLayer - setup Tiles
@@ -426,62 +610,35 @@ Mat4 FastTMXLayer::tileToNodeTransform()
     }
 }
 
-void FastTMXLayer::updatePrimitives()
+void FastTMXLayer::setupCommands()
 {
-    auto blendfunc =
-        _texture->hasPremultipliedAlpha() ? BlendFunc::ALPHA_PREMULTIPLIED : BlendFunc::ALPHA_NON_PREMULTIPLIED;
-    for (const auto& iter : _indicesVertexZNumber)
+    backend::ProgramState* programState;
+    if (_useAutomaticVertexZ)
     {
-        int start = _indicesVertexZOffsets.at(iter.first);
-
-        auto commandIter = _customCommands.find(iter.first);
-        if (_customCommands.end() == commandIter)
-        {
-            auto command = new CustomCommand();
-            command->setVertexBuffer(_vertexBuffer);
-  
-#ifdef AX_FAST_TILEMAP_32_BIT_INDICES
-            CustomCommand::IndexFormat indexFormat = CustomCommand::IndexFormat::U_INT;
-#else
-            CustomCommand::IndexFormat indexFormat = CustomCommand::IndexFormat::U_SHORT;
-#endif
-            command->setIndexBuffer(_indexBuffer, indexFormat);
-
-            command->setIndexDrawInfo(start * 6, iter.second * 6);
-
-            auto& pipelineDescriptor = command->getPipelineDescriptor();
+        auto* program = backend::Program::getBuiltinProgram(backend::ProgramType::POSITION_TEXTURE_COLOR_ALPHA_TEST);
+        programState  = new backend::ProgramState(program);
+        _alphaValueLocation = programState->getUniformLocation("u_alpha_value");
+        programState->setUniform(_alphaValueLocation, &_alphaFuncValue, sizeof(_alphaFuncValue));
+    }
+    else
+    {
+        auto* program = backend::Program::getBuiltinProgram(backend::ProgramType::POSITION_TEXTURE_COLOR);
+        programState  = new backend::ProgramState(program);
+    }
 
-            if (_useAutomaticVertexZ)
-            {
-                AX_SAFE_RELEASE(pipelineDescriptor.programState);
-                auto* program =
-                    backend::Program::getBuiltinProgram(backend::ProgramType::POSITION_TEXTURE_COLOR_ALPHA_TEST);
-                auto programState               = new backend::ProgramState(program);
-                pipelineDescriptor.programState = programState;
-                _alphaValueLocation             = pipelineDescriptor.programState->getUniformLocation("u_alpha_value");
-                pipelineDescriptor.programState->setUniform(_alphaValueLocation, &_alphaFuncValue,
-                                                            sizeof(_alphaFuncValue));
-            }
-            else
-            {
-                AX_SAFE_RELEASE(pipelineDescriptor.programState);
-                auto* program     = backend::Program::getBuiltinProgram(backend::ProgramType::POSITION_TEXTURE_COLOR);
-                auto programState = new backend::ProgramState(program);
-                pipelineDescriptor.programState = programState;
-            }
+    _mvpMatrixLocaiton = programState->getUniformLocation("u_MVPMatrix");
+    _textureLocation   = programState->getUniformLocation("u_tex0");
+    programState->setTexture(_textureLocation, 0, _texture->getBackendTexture());
 
-            _mvpMatrixLocaiton = pipelineDescriptor.programState->getUniformLocation("u_MVPMatrix");
-            _textureLocation   = pipelineDescriptor.programState->getUniformLocation("u_tex0");
-            pipelineDescriptor.programState->setTexture(_textureLocation, 0, _texture->getBackendTexture());
-            command->init(_globalZOrder, blendfunc);
+    // both commands draw with the same program state
+    auto& tilesPipeline = _tilesCommand.getPipelineDescriptor();
+    AX_SAFE_RELEASE(tilesPipeline.programState);
+    tilesPipeline.programState = programState;
 
-            _customCommands[iter.first] = command;
-        }
-        else
-        {
-            commandIter->second->setIndexDrawInfo(start * 6, iter.second * 6);
-        }
-    }
+    auto& animTilesPipeline = _animTilesCommand.getPipelineDescriptor();
+    AX_SAFE_RELEASE(animTilesPipeline.programState);
+    animTilesPipeline.programState = programState;
+    programState->retain();
 }
 
 void FastTMXLayer::setOpacity(uint8_t opacity)
@@ -490,151 +647,195 @@ void FastTMXLayer::setOpacity(uint8_t opacity)
     _quadsDirty = true;
 }
 
-void FastTMXLayer::updateTotalQuads()
+void FastTMXLayer::setupQuad(V3F_C4B_T2F_Quad& quad, int x, int y, uint32_t tileGID)
 {
-    if (_quadsDirty)
+    if (tileGID == 0)
     {
-        Vec2 tileSize = AX_SIZE_PIXELS_TO_POINTS(_tileSet->_tileSize);
-        Vec2 texSize  = _tileSet->_imageSize;
-        _tileToQuadIndex.clear();
-        _totalQuads.resize(int(_layerSize.width * _layerSize.height));
-        _indices.resize(6 * int(_layerSize.width * _layerSize.height));
-        _tileToQuadIndex.resize(int(_layerSize.width * _layerSize.height), -1);
-        _indicesVertexZOffsets.clear();
+        // an empty animated tile
+        memset(&quad, 0, sizeof(quad));
+        return;
+    }
 
-        auto color = Color4B::WHITE;
-        color.a    = getDisplayedOpacity();
+    Vec2 tileSize = AX_SIZE_PIXELS_TO_POINTS(_tileSet->_tileSize);
+    Vec2 texSize  = _tileSet->_imageSize;
 
-        if (_texture->hasPremultipliedAlpha())
-        {
-            auto alpha = color.a / 255.0f;
-            color.r    = static_cast<uint8_t>(color.r * alpha);
-            color.g    = static_cast<uint8_t>(color.g * alpha);
-            color.b    = static_cast<uint8_t>(color.b * alpha);
-        }
+    Vec3 nodePos(float(x), float(y), 0);
+    _tileToNodeTransform.transformPoint(&nodePos);
 
-        int quadIndex = 0;
-        for (int y = 0; y < _layerSize.height; ++y)
-        {
-            for (int x = 0; x < _layerSize.width; ++x)
-            {
-                int tileIndex = getTileIndexByPos(x, y);
-                int tileGID   = _tiles[tileIndex];
+    float left, right, top, bottom, z;
 
-                if (tileGID == 0)
-                    continue;
+    z = (float)getVertexZForPos(Vec2((float)x, (float)y));
 
-                _tileToQuadIndex[tileIndex] = quadIndex;
+    // vertices
+    if (tileGID & kTMXTileDiagonalFlag)
+    {
+        left   = nodePos.x;
+        right  = nodePos.x + tileSize.height;
+        bottom = nodePos.y + tileSize.width;
+        top    = nodePos.y;
+    }
+    else
+    {
+        left   = nodePos.x;
+        right  = nodePos.x + tileSize.width;
+        bottom = nodePos.y + tileSize.height;
+        top    = nodePos.y;
+    }
 
-                auto& quad = _totalQuads[quadIndex];
+    if (tileGID & kTMXTileVerticalFlag)
+        std::swap(top, bottom);
+    if (tileGID & kTMXTileHorizontalFlag)
+        std::swap(left, right);
 
-                Vec3 nodePos(float(x), float(y), 0);
-                _tileToNodeTransform.transformPoint(&nodePos);
+    if (tileGID & kTMXTileDiagonalFlag)
+    {
+        // FIXME: not working correctly
+        quad.bl.vertices.x = left;
+        quad.bl.vertices.y = bottom;
+        quad.bl.vertices.z = z;
+        quad.br.vertices.x = left;
+        quad.br.vertices.y = top;
+        quad.br.vertices.z = z;
+        quad.tl.vertices.x = right;
+        quad.tl.vertices.y = bottom;
+        quad.tl.vertices.z = z;
+        quad.tr.vertices.x = right;
+        quad.tr.vertices.y = top;
+        quad.tr.vertices.z = z;
+    }
+    else
+    {
+        quad.bl.vertices.x = left;
+        quad.bl.vertices.y = bottom;
+        quad.bl.vertices.z = z;
+        quad.br.vertices.x = right;
+        quad.br.vertices.y = bottom;
+        quad.br.vertices.z = z;
+        quad.tl.vertices.x = left;
+        quad.tl.vertices.y = top;
+        quad.tl.vertices.z = z;
+        quad.tr.vertices.x = right;
+        quad.tr.vertices.y = top;
+        quad.tr.vertices.z = z;
+    }
 
-                float left, right, top, bottom, z;
+    // texcoords
+    Rect tileTexture = _tileSet->getRectForGID(tileGID);
+    left             = (tileTexture.origin.x / texSize.width);
+    right            = left + (tileTexture.size.width / texSize.width);
+    bottom           = (tileTexture.origin.y / texSize.height);
+    top              = bottom + (tileTexture.size.height / texSize.height);
+
+    // issue#1085 OpenGL sub-pixel horizontal-vertical lines pixel-tolerance fix.
+    float ptx = 1.0 / (_tileSet->_imageSize.x * tileSize.x);
+    float pty = 1.0 / (_tileSet->_imageSize.y * tileSize.y);
+
+    quad.bl.texCoords.u = left + ptx;
+    quad.bl.texCoords.v = bottom + pty;
+    quad.br.texCoords.u = right - ptx;
+    quad.br.texCoords.v = bottom + pty;
+    quad.tl.texCoords.u = left + ptx;
+    quad.tl.texCoords.v = top - pty;
+    quad.tr.texCoords.u = right - ptx;
+    quad.tr.texCoords.v = top - pty;
+
+    quad.bl.colors = _quadColor;
+    quad.br.colors = _quadColor;
+    quad.tl.colors = _quadColor;
+    quad.tr.colors = _quadColor;
+}
 
-                int zPos  = getVertexZForPos(Vec2((float)x, (float)y));
-                z         = (float)zPos;
-                auto iter = _indicesVertexZOffsets.find(zPos);
-                if (iter == _indicesVertexZOffsets.end())
-                {
-                    _indicesVertexZOffsets[zPos] = 1;
-                }
-                else
-                {
-                    iter->second++;
-                }
-                // vertices
-                if (tileGID & kTMXTileDiagonalFlag)
-                {
-                    left   = nodePos.x;
-                    right  = nodePos.x + tileSize.height;
-                    bottom = nodePos.y + tileSize.width;
-                    top    = nodePos.y;
-                }
-                else
-                {
-                    left   = nodePos.x;
-                    right  = nodePos.x + tileSize.width;
-                    bottom = nodePos.y + tileSize.height;
-                    top    = nodePos.y;
-                }
+void FastTMXLayer::updateTotalQuads()
+{
+    if (_quadsDirty)
+    {
+        if (!_tilesCommand.getPipelineDescriptor().programState)
+            setupCommands();
 
-                if (tileGID & kTMXTileVerticalFlag)
-                    std::swap(top, bottom);
-                if (tileGID & kTMXTileHorizontalFlag)
-                    std::swap(left, right);
+        _quadColor   = Color4B::WHITE;
+        _quadColor.a = getDisplayedOpacity();
 
-                if (tileGID & kTMXTileDiagonalFlag)
-                {
-                    // FIXME: not working correctly
-                    quad.bl.vertices.x = left;
-                    quad.bl.vertices.y = bottom;
-                    quad.bl.vertices.z = z;
-                    quad.br.vertices.x = left;
-                    quad.br.vertices.y = top;
-                    quad.br.vertices.z = z;
-                    quad.tl.vertices.x = right;
-                    quad.tl.vertices.y = bottom;
-                    quad.tl.vertices.z = z;
-                    quad.tr.vertices.x = right;
-                    quad.tr.vertices.y = top;
-                    quad.tr.vertices.z = z;
-                }
-                else
-                {
-                    quad.bl.vertices.x = left;
-                    quad.bl.vertices.y = bottom;
-                    quad.bl.vertices.z = z;
-                    quad.br.vertices.x = right;
-                    quad.br.vertices.y = bottom;
-                    quad.br.vertices.z = z;
-                    quad.tl.vertices.x = left;
-                    quad.tl.vertices.y = top;
-                    quad.tl.vertices.z = z;
-                    quad.tr.vertices.x = right;
-                    quad.tr.vertices.y = top;
-                    quad.tr.vertices.z = z;
-                }
+        if (_texture->hasPremultipliedAlpha())
+        {
+            auto alpha   = _quadColor.a / 255.0f;
+            _quadColor.r = static_cast<uint8_t>(_quadColor.r * alpha);
+            _quadColor.g = static_cast<uint8_t>(_quadColor.g * alpha);
+            _quadColor.b = static_cast<uint8_t>(_quadColor.b * alpha);
+        }
 
-                // texcoords
-                Rect tileTexture = _tileSet->getRectForGID(tileGID);
-                left             = (tileTexture.origin.x / texSize.width);
-                right            = left + (tileTexture.size.width / texSize.width);
-                bottom           = (tileTexture.origin.y / texSize.height);
-                top              = bottom + (tileTexture.size.height / texSize.height);
-
-                // issue#1085 OpenGL sub-pixel horizontal-vertical lines pixel-tolerance fix.
-                float ptx = 1.0 / (_tileSet->_imageSize.x * tileSize.x);
-                float pty = 1.0 / (_tileSet->_imageSize.y * tileSize.y);
-
-                quad.bl.texCoords.u = left + ptx;
-                quad.bl.texCoords.v = bottom + pty;
-                quad.br.texCoords.u = right - ptx;
-                quad.br.texCoords.v = bottom + pty;
-                quad.tl.texCoords.u = left + ptx;
-                quad.tl.texCoords.v = top - pty;
-                quad.tr.texCoords.u = right - ptx;
-                quad.tr.texCoords.v = top - pty;
-
-                quad.bl.colors = color;
-                quad.br.colors = color;
-                quad.tl.colors = color;
-                quad.tr.colors = color;
-
-                ++quadIndex;
+        // the chunks are rebuilt when they're visible, into the slots they had
+        _chunksX = (static_cast<int>(_layerSize.width) + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        _chunksY = (static_cast<int>(_layerSize.height) + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        _chunks.assign(static_cast<size_t>(_chunksX) * _chunksY, TileChunk{});
+        for (size_t slot = 0; slot < _slotChunks.size(); ++slot)
+        {
+            if (_slotChunks[slot] >= 0 && _slotChunks[slot] < static_cast<int>(_chunks.size()))
+                _chunks[_slotChunks[slot]].slot = static_cast<int>(slot);
+            else if (_slotChunks[slot] >= 0)
+            {
+                _slotChunks[slot] = -1;
+                _freeSlots.emplace_back(static_cast<int>(slot));
             }
         }
 
-        int offset = 0;
-        for (auto&& vertexZOffset : _indicesVertexZOffsets)
+        // the animated tiles, the ones out of the range of the indices are left in their chunks, and all of them
+        // with the automatic vertexZ, so they're drawn in the order of their vertexZ
+#ifdef AX_FAST_TILEMAP_32_BIT_INDICES
+        constexpr size_t maxAnimQuads = std::numeric_limits<int>::max() / 6;
+#else
+        constexpr size_t maxAnimQuads = 65536 / 4;
+#endif
+        const size_t animQuadsLimit = _useAutomaticVertexZ ? 0 : maxAnimQuads;
+        _animQuads.clear();
+        _animTileQuads.clear();
+        for (auto&& anim : _animTileCoord)
         {
-            std::swap(offset, vertexZOffset.second);
-            offset += vertexZOffset.second;
+            for (auto&& tile : anim.second)
+            {
+                int x         = static_cast<int>(tile._tilePos.x);
+                int y         = static_cast<int>(tile._tilePos.y);
+                int tileIndex = getTileIndexByPos(x, y);
+                if (_animQuads.size() < animQuadsLimit &&
+                    _animTileQuads.emplace(tileIndex, static_cast<int>(_animQuads.size())).second)
+                    setupQuad(_animQuads.emplace_back(), x, y, _tiles[tileIndex]);
+            }
         }
-        updateVertexBuffer();
 
-        _quadsDirty = false;
+        if (!_animQuads.empty())
+        {
+            std::vector<index_type> indices(_animQuads.size() * 6);
+            for (size_t i = 0; i < _animQuads.size(); ++i)
+            {
+                auto vertex        = static_cast<index_type>(i * 4);
+                indices[i * 6 + 0] = vertex + 0;
+                indices[i * 6 + 1] = vertex + 1;
+                indices[i * 6 + 2] = vertex + 2;
+                indices[i * 6 + 3] = vertex + 3;
+                indices[i * 6 + 4] = vertex + 2;
+                indices[i * 6 + 5] = vertex + 1;
+            }
+            _animTilesCommand.createVertexBuffer(sizeof(V3F_C4B_T2F), _animQuads.size() * 4,
+                                                 CustomCommand::BufferUsage::DYNAMIC);
+            _animTilesCommand.createIndexBuffer(sizeof(index_type) == 4 ? CustomCommand::IndexFormat::U_INT
+                                                                        : CustomCommand::IndexFormat::U_SHORT,
+                                                indices.size(), CustomCommand::BufferUsage::STATIC);
+            _animTilesCommand.updateIndexBuffer(indices.data(), sizeof(indices[0]) * indices.size());
+        }
+        _animTilesCommand.setIndexDrawInfo(0, _animQuads.size() * 6);
+        _animQuadsDirty = !_animQuads.empty();
+
+        _indicesDirty = true;
+        _dirty        = true;
+        _quadsDirty   = false;
+    }
+}
+
+void FastTMXLayer::updateAnimTiles()
+{
+    if (_animQuadsDirty)
+    {
+        _animTilesCommand.updateVertexBuffer(_animQuads.data(), sizeof(_animQuads[0]) * _animQuads.size());
+        _animQuadsDirty = false;
     }
 }
 
@@ -777,8 +978,23 @@ void FastTMXLayer::setFlaggedTileGIDByIndex(int index, uint32_t gid)
     if (gid == _tiles[index])
         return;
     _tiles[index] = gid;
-    _quadsDirty   = true;
-    _dirty        = true;
+
+    auto it = _animTileQuads.find(index);
+    if (it != _animTileQuads.end())
+    {
+        int width = static_cast<int>(_layerSize.width);
+        setupQuad(_animQuads[it->second], index % width, index / width, gid);
+        _animQuadsDirty = true;
+        return;
+    }
+
+    // only the chunk of the tile is rebuilt
+    if (!_chunks.empty())
+    {
+        int width = static_cast<int>(_layerSize.width);
+        _chunks[(index % width) / CHUNK_SIZE + (index / width) / CHUNK_SIZE * _chunksX].dirty = true;
+    }
+    _dirty = true;
 }
 
 void FastTMXLayer::removeChild(Node* node, bool cleanup)
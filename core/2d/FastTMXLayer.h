@@ -28,6 +28,7 @@ THE SOFTWARE.
 ****************************************************************************/
 #pragma once
 
+#include <deque>
 #include <unordered_map>
 #include "2d/Node.h"
 #include "2d/TMXXMLParser.h"
@@ -53,7 +54,7 @@ class Buffer;
  */
 
 /**
- * !!! uncomment if you want reduce bandwidth of GPU, then the tiled layer size will be limited to 128x128
+ * !!! comment out if you want reduce bandwidth of GPU, then the visible tiles will be limited to 128x128
 */
 #define AX_FAST_TILEMAP_32_BIT_INDICES 1
 
@@ -318,14 +319,18 @@ protected:
     // Flip flags is packed into gid
     void setFlaggedTileGIDByIndex(int index, uint32_t gid);
 
-    //
+    // Drop the quads of all chunks and rebuild the animated tiles, when the tiles or the opacity changed
     void updateTotalQuads();
 
     int getTileIndexByPos(int x, int y) const { return x + y * (int)_layerSize.width; }
 
-    void updateVertexBuffer();
+    void setupQuad(V3F_C4B_T2F_Quad& quad, int x, int y, uint32_t gid);
+    void setupCommands();
+    bool updateChunk(int chunkIndex);
+    int acquireChunkSlot();
+    bool reserveChunkSlots(int count);
     void updateIndexBuffer();
-    void updatePrimitives();
+    void updateAnimTiles();
 
     //! name of the layer
     std::string _layerName;
@@ -369,22 +374,61 @@ protected:
     Vec2 _cameraPositionDirty = {INFINITY, INFINITY};
     float _cameraZoomDirty;
 
-    std::vector<int> _tileToQuadIndex;
-    std::vector<V3F_C4B_T2F_Quad> _totalQuads;
+    /*
+     * The tiles are drawn by chunks of CHUNK_SIZE x CHUNK_SIZE, the quads of a chunk are built when it becomes visible
+     * and kept in a slot of the vertex buffer, until the slot is taken by another chunk or a tile of the chunk changes.
+     * The indices are only rebuilt when the visible chunks change, they're appended row by row across the chunks,
+     * so the tiles are still drawn in the order of the map. With the automatic vertexZ, they're sorted by vertexZ
+     * instead, and each vertexZ is drawn by its own command like the tiles of the TMXLayer.
+     */
+    static constexpr int CHUNK_SIZE  = 16;
+    static constexpr int CHUNK_QUADS = CHUNK_SIZE * CHUNK_SIZE;
+
+    struct TileChunk
+    {
+        uint16_t rowQuads[CHUNK_SIZE + 1] = {};  // the first quad of each row in the slot, empty tiles have no quad
+        int slot                          = -1;
+        uint32_t visibleStamp             = 0;
+        bool dirty                        = true;  // the quads are not in the slot
+    };
+
 #ifdef AX_FAST_TILEMAP_32_BIT_INDICES
-    std::vector<unsigned int> _indices;
+    using index_type = unsigned int;
 #else
-    std::vector<unsigned short> _indices;
+    using index_type = unsigned short;
 #endif
-    std::map<int /*vertexZ*/, int /*offset to _indices by quads*/> _indicesVertexZOffsets;
-    std::unordered_map<int /*vertexZ*/, int /*number to quads*/> _indicesVertexZNumber;
-    bool _dirty = true;
-
-    backend::Buffer* _vertexBuffer = nullptr;
-    backend::Buffer* _indexBuffer  = nullptr;
+    std::vector<TileChunk> _chunks;
+    int _chunksX = 0;
+    int _chunksY = 0;
+    std::vector<int> _slotChunks;  // the chunk in each slot, -1 if free
+    std::vector<uint8_t> _slotQuadColumns;  // the column in its chunk of each quad of the slots
+    std::vector<int> _freeSlots;
+    std::vector<V3F_C4B_T2F_Quad> _chunkQuads;
+    std::vector<index_type> _indices;
+    int _visibleChunks[4]  = {};  // x begin, y begin, x end, y end
+    uint32_t _visibleStamp = 0;
+    bool _indicesDirty     = true;
+    bool _dirty            = true;
+    Color4B _quadColor;
+
+    // The animated tiles are updated often, they have their own small buffer instead of rebuilding their chunks
+    std::vector<V3F_C4B_T2F_Quad> _animQuads;
+    std::unordered_map<int /*tile index*/, int /*quad*/> _animTileQuads;
+    bool _animQuadsDirty = false;
 
     float _alphaFuncValue = 0.f;
-    std::unordered_map<int, CustomCommand*> _customCommands;
+    CustomCommand _tilesCommand;
+    CustomCommand _animTilesCommand;
+
+    struct VertexZCommand
+    {
+        int vertexZ = 0;
+        CustomCommand command;  // draws a range of the indices of _tilesCommand
+    };
+    // a deque, so the queued commands stay valid when a second camera needs more of them in the same frame
+    std::deque<VertexZCommand> _vertexZCommands;
+    size_t _vertexZCommandCount = 0;
+    std::vector<std::pair<int /*vertexZ*/, index_type /*first vertex*/>> _vertexZQuads;
 
     backend::UniformLocation _mvpMatrixLocaiton;
     backend::UniformLocation _textureLocation;
@@ -0,0 +1,350 @@
+/****************************************************************************
+ Copyright (c) 2019-present Axmol Engine contributors (see AUTHORS.md).
+
+ https://axmol.dev/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#include "2d/JsonSpriteSheetLoader.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "2d/AutoPolygon.h"
+#include "2d/SpriteFrameCache.h"
+#include "base/Director.h"
+#include "base/PaddedString.h"
+#include "platform/FileUtils.h"
+#include "renderer/Texture2D.h"
+#include "renderer/TextureCache.h"
+
+NS_AX_BEGIN
+
+using namespace simdjson;
+
+namespace
+{
+struct JsonFrame
+{
+    std::string_view name;
+    Rect frame;
+    Rect spriteSourceSize;
+    Vec2 sourceSize;
+    Vec2 pivot;
+    bool rotated  = false;
+    bool trimmed  = false;
+    bool hasPivot = false;
+    std::vector<int> vertices;
+    std::vector<int> verticesUV;
+    std::vector<int> triangles;
+
+    void reset()
+    {
+        name = {};
+        frame = spriteSourceSize = Rect::ZERO;
+        sourceSize = pivot = Vec2::ZERO;
+        rotated = trimmed = hasPivot = false;
+        vertices.clear();
+        verticesUV.clear();
+        triangles.clear();
+    }
+};
+
+// {"x": , "y": , "w": , "h": }, the missing values are left unchanged
+void readRect(ondemand::value value, Rect& rect)
+{
+    for (auto field : value.get_object())
+    {
+        std::string_view key = field.unescaped_key();
+        auto number          = static_cast<float>(field.value().get_double());
+        if (key == "x"sv)
+            rect.origin.x = number;
+        else if (key == "y"sv)
+            rect.origin.y = number;
+        else if (key == "w"sv)
+            rect.size.width = number;
+        else if (key == "h"sv)
+            rect.size.height = number;
+    }
+}
+
+// [[a, b], [c, d], ...] flattened
+void readIntegerLists(ondemand::value value, std::vector<int>& out)
+{
+    for (auto list : value.get_array())
+    {
+        for (auto number : list.get_array())
+            out.emplace_back(static_cast<int>(number.get_double()));
+    }
+}
+
+void readFrame(ondemand::object object, JsonFrame& frame)
+{
+    for (auto field : object)
+    {
+        std::string_view key  = field.unescaped_key();
+        ondemand::value value = field.value();
+        if (key == "frame"sv)
+            readRect(value, frame.frame);
+        else if (key == "filename"sv)
+            frame.name = value.get_string();
+        else if (key == "rotated"sv)
+            frame.rotated = value.get_bool();
+        else if (key == "trimmed"sv)
+            frame.trimmed = value.get_bool();
+        else if (key == "spriteSourceSize"sv)
+            readRect(value, frame.spriteSourceSize);
+        else if (key == "sourceSize"sv)
+        {
+            Rect size;
+            readRect(value, size);
+            frame.sourceSize.set(size.size.width, size.size.height);
+        }
+        else if (key == "pivot"sv)
+        {
+            Rect pivot;
+            readRect(value, pivot);
+            frame.pivot.set(pivot.origin.x, pivot.origin.y);
+            frame.hasPivot = true;
+        }
+        else if (key == "vertices"sv)
+            readIntegerLists(value, frame.vertices);
+        else if (key == "verticesUV"sv)
+            readIntegerLists(value, frame.verticesUV);
+        else if (key == "triangles"sv)
+            readIntegerLists(value, frame.triangles);
+    }
+}
+
+bool loadJson(std::string_view filePath, PaddedString& json)
+{
+    auto fullPath = FileUtils::getInstance()->fullPathForFilename(filePath);
+    if (fullPath.empty())
+    {
+        AXLOGW("SpriteFrameCache: can not find {}", filePath);
+        return false;
+    }
+    json = PaddedString::load(fullPath);
+    return json.size() > 0;
+}
+}  // namespace
+
+void JsonSpriteSheetLoader::load(std::string_view filePath, SpriteFrameCache& cache)
+{
+    AXASSERT(!filePath.empty(), "sprite sheet filename should not be empty");
+
+    PaddedString json;
+    if (!loadJson(filePath, json))
+        return;
+
+    addSpriteFrames(json, filePath, cache, false, [filePath](std::string_view image, std::string_view pixelFormat) {
+        return addTexture(getTexturePath(image, filePath), pixelFormat);
+    });
+}
+
+void JsonSpriteSheetLoader::load(std::string_view filePath, Texture2D* texture, SpriteFrameCache& cache)
+{
+    PaddedString json;
+    if (!loadJson(filePath, json))
+        return;
+
+    addSpriteFrames(json, filePath, cache, false, [texture](std::string_view, std::string_view) { return texture; });
+}
+
+void JsonSpriteSheetLoader::load(std::string_view filePath, std::string_view textureFileName, SpriteFrameCache& cache)
+{
+    AXASSERT(!textureFileName.empty(), "texture name should not be null");
+
+    PaddedString json;
+    if (!loadJson(filePath, json))
+        return;
+
+    addSpriteFrames(json, filePath, cache, false, [textureFileName](std::string_view, std::string_view pixelFormat) {
+        return addTexture(textureFileName, pixelFormat);
+    });
+}
+
+void JsonSpriteSheetLoader::load(const Data& content, Texture2D* texture, SpriteFrameCache& cache)
+{
+    if (content.isNull())
+    {
+        return;
+    }
+
+    PaddedString json;
+    json.resize(static_cast<size_t>(content.getSize()));
+    memcpy(json.data(), content.getBytes(), json.size());
+
+    addSpriteFrames(json, "by#addSpriteFramesWithFileContent()"sv, cache, false,
+                    [texture](std::string_view, std::string_view) { return texture; });
+}
+
+void JsonSpriteSheetLoader::reload(std::string_view filePath, SpriteFrameCache& cache)
+{
+    PaddedString json;
+    if (!loadJson(filePath, json))
+        return;
+
+    addSpriteFrames(json, filePath, cache, true, [filePath](std::string_view image, std::string_view) {
+        auto texturePath   = getTexturePath(image, filePath);
+        auto textureCache  = Director::getInstance()->getTextureCache();
+        Texture2D* texture = nullptr;
+        if (textureCache->reloadTexture(texturePath))
+        {
+            texture = textureCache->getTextureForKey(texturePath);
+        }
+        return texture;
+    });
+}
+
+void JsonSpriteSheetLoader::addSpriteFrames(const PaddedString& json,
+                                            std::string_view filePath,
+                                            SpriteFrameCache& cache,
+                                            bool reload,
+                                            const TextureResolver& resolveTexture)
+{
+    Image* image = nullptr;
+
+    try
+    {
+        ondemand::parser parser;
+        ondemand::document doc = parser.iterate(json);
+
+        // TexturePacker writes the meta object after the frames, read it first and rewind
+        std::string_view textureFileName;
+        std::string_view pixelFormatName;
+        Vec2 textureSize;
+        ondemand::object meta;
+        if (doc["meta"].get(meta) == SUCCESS)
+        {
+            for (auto field : meta)
+            {
+                std::string_view key = field.unescaped_key();
+                if (key == "image"sv)
+                    textureFileName = field.value().get_string();
+                else if (key == "format"sv)
+                    pixelFormatName = field.value().get_string();
+                else if (key == "size"sv)
+                {
+                    Rect size;
+                    readRect(field.value(), size);
+                    textureSize.set(size.size.width, size.size.height);
+                }
+            }
+        }
+        doc.rewind();
+
+        auto* texture = resolveTexture(textureFileName, pixelFormatName);
+        if (!texture)
+        {
+            AXLOGD("SpriteFrameCache: Couldn't load texture");
+            return;
+        }
+        if (textureSize.isZero())
+        {
+            const auto& size = texture->getContentSizeInPixels();
+            textureSize.set(size.width, size.height);
+        }
+
+        auto spriteSheet    = std::make_shared<SpriteSheet>();
+        spriteSheet->format = getFormat();
+        spriteSheet->path   = filePath;
+
+        // the frames are added once the whole file is read, so a truncated or invalid file adds none
+        std::vector<std::string_view> names;
+        Vector<SpriteFrame*> spriteFrames;
+
+        JsonFrame frame;
+        auto addFrame = [&](ondemand::object object, std::string_view key) {
+            frame.reset();
+            frame.name = key;
+            readFrame(object, frame);
+            if (frame.name.empty())
+                return;
+            if (!reload && cache.findFrame(frame.name))
+                return;
+
+            // untrimmed frames may omit the source sizes
+            if (frame.sourceSize.isZero())
+                frame.sourceSize.set(frame.frame.size.width, frame.frame.size.height);
+            if (frame.spriteSourceSize.size.equals(Vec2::ZERO))
+                frame.spriteSourceSize.size = frame.frame.size;
+
+            // the offset of the trimmed rect center from the source center, y up
+            const auto& trimmed = frame.spriteSourceSize;
+            Vec2 offset(trimmed.origin.x + trimmed.size.width / 2 - frame.sourceSize.x / 2,
+                        frame.sourceSize.y / 2 - trimmed.origin.y - trimmed.size.height / 2);
+
+            auto* spriteFrame =
+                SpriteFrame::createWithTexture(texture, frame.frame, frame.rotated, offset, frame.sourceSize);
+
+            if (!frame.vertices.empty() && frame.vertices.size() == frame.verticesUV.size())
+            {
+                const int vertexCount = static_cast<int>(frame.vertices.size() / 2);
+                if (frame.vertices.size() % 2 != 0 || frame.triangles.size() % 3 != 0 ||
+                    std::any_of(frame.triangles.begin(), frame.triangles.end(),
+                                [vertexCount](int index) { return index < 0 || index >= vertexCount; }))
+                    throw std::runtime_error(fmt::format("invalid polygon of frame {}", frame.name));
+
+                PolygonInfo info;
+                initializePolygonInfo(textureSize, frame.sourceSize, frame.vertices, frame.verticesUV,
+                                      frame.triangles, info);
+                spriteFrame->setPolygonInfo(info);
+            }
+            if (frame.hasPivot)
+            {
+                spriteFrame->setAnchorPoint(frame.pivot);
+            }
+
+            names.emplace_back(frame.name);
+            spriteFrames.pushBack(spriteFrame);
+        };
+
+        auto frames = doc["frames"];
+        if (frames.type() == ondemand::json_type::array)
+        {
+            for (auto value : frames.get_array())
+                addFrame(value.get_object(), {});
+        }
+        else
+        {
+            for (auto field : frames.get_object())
+                addFrame(field.value().get_object(), field.unescaped_key());
+        }
+
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            if (reload)
+                cache.eraseFrame(names[i]);
+            else
+                addNinePatchCapInset(names[i], spriteFrames.at(i), texture, image, cache);
+            cache.insertFrame(spriteSheet, names[i], spriteFrames.at(i));
+        }
+        spriteSheet->full = true;
+    }
+    catch (std::exception& ex)
+    {
+        AXLOGW("SpriteFrameCache: Load {} fail due to exception occured: {}", filePath, ex.what());
+    }
+
+    AX_SAFE_DELETE(image);
+}
+
+NS_AX_END
@@ -0,0 +1,73 @@
+/****************************************************************************
+ Copyright (c) 2019-present Axmol Engine contributors (see AUTHORS.md).
+
+ https://axmol.dev/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#pragma once
+
+#include <functional>
+#include <string>
+
+#include "2d/SpriteSheetLoader.h"
+#include "base/Data.h"
+
+NS_AX_BEGIN
+
+class PaddedString;
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/**
+ * @brief Loads TexturePacker JSON sprite sheets, in both the hash and the array layout.
+ *
+ * The document is read with the simdjson on-demand parser and the frames are created directly from it, without
+ * building an intermediate ValueMap. Trimmed frames, rotation, pivots and polygon meshes are supported.
+ */
+class AX_DLL JsonSpriteSheetLoader : public SpriteSheetLoader
+{
+public:
+    static constexpr uint32_t FORMAT = SpriteSheetFormat::JSON;
+
+    uint32_t getFormat() override { return FORMAT; }
+    void load(std::string_view filePath, SpriteFrameCache& cache) override;
+    void load(std::string_view filePath, Texture2D* texture, SpriteFrameCache& cache) override;
+    void load(std::string_view filePath, std::string_view textureFileName, SpriteFrameCache& cache) override;
+    void load(const Data& content, Texture2D* texture, SpriteFrameCache& cache) override;
+    void reload(std::string_view filePath, SpriteFrameCache& cache) override;
+
+protected:
+    /** Receives the image and the pixel format named by the meta object, returns the texture of the frames */
+    using TextureResolver = std::function<Texture2D*(std::string_view image, std::string_view pixelFormat)>;
+
+    void addSpriteFrames(const PaddedString& json,
+                         std::string_view filePath,
+                         SpriteFrameCache& cache,
+                         bool reload,
+                         const TextureResolver& resolveTexture);
+};
+
+// end of _2d group
+/// @}
+
+NS_AX_END
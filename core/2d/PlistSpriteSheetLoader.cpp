@@ -27,7 +27,6 @@
 #include "platform/FileUtils.h"
 #include "2d/AutoPolygon.h"
 #include "2d/SpriteFrameCache.h"
-#include "base/NinePatchImageParser.h"
 #include "base/NS.h"
 #include "base/Macros.h"
 #include "base/UTF8.h"
@@ -42,6 +41,15 @@ using namespace std;
 
 NS_AX_BEGIN
 
+// the texture file name in the metadata, empty if there is none
+static std::string getTextureFileName(ValueMap& dict)
+{
+    auto metaItr = dict.find("metadata"sv);
+    if (metaItr == dict.end())
+        return {};
+    return optValue(metaItr->second.asValueMap(), "textureFileName"sv).asString();
+}
+
 void PlistSpriteSheetLoader::load(std::string_view filePath, SpriteFrameCache& cache)
 {
     AXASSERT(!filePath.empty(), "plist filename should not be nullptr");
@@ -56,38 +64,7 @@ void PlistSpriteSheetLoader::load(std::string_view filePath, SpriteFrameCache& c
 
     auto dict = FileUtils::getInstance()->getValueMapFromFile(fullPath);
 
-    std::string texturePath;
-
-    if (dict.find("metadata") != dict.end())
-    {
-        auto& metadataDict = dict["metadata"].asValueMap();
-        // try to read  texture file name from meta data
-        texturePath = metadataDict["textureFileName"].asString();
-    }
-
-    if (!texturePath.empty())
-    {
-        // build texture path relative to plist file
-        texturePath = FileUtils::getInstance()->fullPathFromRelativeFile(texturePath, filePath);
-    }
-    else
-    {
-        // build texture path by replacing file extension
-        texturePath = filePath;
-
-        // remove .xxx
-        const auto startPos = texturePath.find_last_of('.');
-        if (startPos != string::npos)
-        {
-            texturePath = texturePath.erase(startPos);
-        }
-
-        // append .png
-        texturePath = texturePath.append(".png");
-
-        AXLOGD("SpriteFrameCache: Trying to use file {} as texture", texturePath);
-    }
-    addSpriteFramesWithDictionary(dict, texturePath, filePath, cache);
+    addSpriteFramesWithDictionary(dict, getTexturePath(getTextureFileName(dict), filePath), filePath, cache);
 }
 
 void PlistSpriteSheetLoader::load(std::string_view filePath, Texture2D* texture, SpriteFrameCache& cache)
@@ -125,37 +102,8 @@ void PlistSpriteSheetLoader::reload(std::string_view filePath, SpriteFrameCache&
     const auto fullPath = FileUtils::getInstance()->fullPathForFilename(filePath);
     auto dict           = FileUtils::getInstance()->getValueMapFromFile(fullPath);
 
-    std::string texturePath;
-
-    if (dict.find("metadata") != dict.end())
-    {
-        auto& metadataDict = dict["metadata"].asValueMap();
-        // try to read  texture file name from meta data
-        texturePath = metadataDict["textureFileName"].asString();
-    }
-
-    if (!texturePath.empty())
-    {
-        // build texture path relative to plist file
-        texturePath = FileUtils::getInstance()->fullPathFromRelativeFile(texturePath, filePath);
-    }
-    else
-    {
-        // build texture path by replacing file extension
-        texturePath = filePath;
-
-        // remove .xxx
-        const auto startPos = texturePath.find_last_of('.');
-        if (startPos != string::npos)
-        {
-            texturePath = texturePath.erase(startPos);
-        }
-
-        // append .png
-        texturePath = texturePath.append(".png");
-    }
-
-    Texture2D* texture = nullptr;
+    const auto texturePath = getTexturePath(getTextureFileName(dict), filePath);
+    Texture2D* texture     = nullptr;
     if (Director::getInstance()->getTextureCache()->reloadTexture(texturePath))
     {
         texture = Director::getInstance()->getTextureCache()->getTextureForKey(texturePath);
@@ -217,9 +165,7 @@ void PlistSpriteSheetLoader::addSpriteFramesWithDictionary(ValueMap& dictionary,
              "format is not supported for SpriteFrameCache addSpriteFramesWithDictionary:textureFilename:");
 
     std::vector<std::string> frameAliases;
-    auto textureFileName = Director::getInstance()->getTextureCache()->getTextureFilePath(texture);
-    Image* image         = nullptr;
-    NinePatchImageParser parser;
+    Image* image = nullptr;
     for (auto&& iter : framesDict)
     {
         auto& frameDict      = iter.second.asValueMap();
@@ -318,18 +264,7 @@ void PlistSpriteSheetLoader::addSpriteFramesWithDictionary(ValueMap& dictionary,
             }
         }
 
-        auto flag = NinePatchImageParser::isNinePatchImage(spriteFrameName);
-        if (flag)
-        {
-            if (image == nullptr)
-            {
-                image = new Image();
-                image->initWithImageFile(textureFileName);
-            }
-            parser.setSpriteFrameInfo(image, spriteFrame->getRectInPixels(), spriteFrame->isRotated());
-            // texture->addSpriteFrameCapInset(spriteFrame, parser.parseCapInset());
-            cache.addSpriteFrameCapInset(spriteFrame, parser.parseCapInset(), texture);
-        }
+        addNinePatchCapInset(spriteFrameName, spriteFrame, texture, image, cache);
 
         // add sprite frame
         cache.insertFrame(spriteSheet, spriteFrameName, spriteFrame);
@@ -359,29 +294,7 @@ void PlistSpriteSheetLoader::addSpriteFramesWithDictionary(ValueMap& dict,
         }
     }
 
-    Texture2D* texture                                                        = nullptr;
-    static std::unordered_map<std::string, backend::PixelFormat> pixelFormats = {
-        {"RGBA8888", backend::PixelFormat::RGBA8},
-        {"RGBA4444", backend::PixelFormat::RGBA4},
-        {"RGB5A1", backend::PixelFormat::RGB5A1},
-        {"RGBA5551", backend::PixelFormat::RGB5A1},
-        {"RGB565", backend::PixelFormat::RGB565},
-        {"R8", backend::PixelFormat::R8},
-        {"RG8", backend::PixelFormat::RG8},
-        //{"BGRA8888", backend::PixelFormat::BGRA8888}, no Image conversion RGBA -> BGRA
-        {"RGB888", backend::PixelFormat::RGB8}};
-
-    const auto pixelFormatIt = pixelFormats.find(pixelFormatName);
-    if (pixelFormatIt != pixelFormats.end())
-    {
-        const backend::PixelFormat pixelFormat        = (*pixelFormatIt).second;
-        texture = Director::getInstance()->getTextureCache()->addImage(texturePath, pixelFormat);
-    }
-    else
-    {
-        texture = Director::getInstance()->getTextureCache()->addImage(texturePath);
-    }
-
+    auto texture = addTexture(texturePath, pixelFormatName);
     if (texture)
     {
         addSpriteFramesWithDictionary(dict, texture, plist, cache);
@@ -48,8 +48,16 @@ THE SOFTWARE.
 #    include "navmesh/NavMesh.h"
 #endif
 
+#if defined(AX_ENABLE_3D)
+#    include "3d/CullingBVH.h"
+#endif
+
 NS_AX_BEGIN
 
+#if defined(AX_ENABLE_3D)
+CullingBVH* Scene::_visitingCullingBVH = nullptr;
+#endif
+
 Scene::Scene()
     : _event(_director->getEventDispatcher()->addCustomEventListener(
           Director::EVENT_PROJECTION_CHANGED,
@@ -71,6 +79,9 @@ Scene::~Scene()
 #endif
 #if defined(AX_ENABLE_NAVMESH)
     AX_SAFE_RELEASE(_navMesh);
+#endif
+#if defined(AX_ENABLE_3D)
+    AX_SAFE_RELEASE(_cullingBVH);
 #endif
     _director->getEventDispatcher()->removeEventListener(_event);
     AX_SAFE_RELEASE(_event);
@@ -214,8 +225,17 @@ void Scene::render(Renderer* renderer, const Mat4& eyeTransform, const Mat4* eye
         camera->apply();
         // clear background with max depth
         camera->clearBackground();
+#if defined(AX_ENABLE_3D)
+        auto visitingCullingBVH = _visitingCullingBVH;
+        _visitingCullingBVH     = _cullingBVH;
+        if (_cullingBVH)
+            _culling3DVisibleCount = _cullingBVH->cull(camera->getFrustum());
+#endif
         // visit the scene
         visit(renderer, transform, 0);
+#if defined(AX_ENABLE_3D)
+        _visitingCullingBVH = visitingCullingBVH;
+#endif
 #if defined(AX_ENABLE_NAVMESH)
         if (_navMesh && _navMeshDebugCamera == camera)
         {
@@ -325,6 +345,25 @@ void Scene::setNavMeshDebugCamera(Camera* camera)
 
 #endif
 
+#if defined(AX_ENABLE_3D)
+void Scene::setCulling3DEnabled(bool enabled)
+{
+    if (enabled == isCulling3DEnabled())
+        return;
+
+    // The meshes registered to the old one unregister on their next visit
+    if (enabled)
+    {
+        _cullingBVH = new CullingBVH();
+    }
+    else
+    {
+        AX_SAFE_RELEASE_NULL(_cullingBVH);
+        _culling3DVisibleCount = 0;
+    }
+}
+#endif
+
 #if (defined(AX_ENABLE_PHYSICS) || (defined(AX_ENABLE_3D_PHYSICS) && AX_ENABLE_BULLET_INTEGRATION))
 
 Scene* Scene::createWithPhysics()
@@ -49,6 +49,9 @@ class Physics3DWorld;
 #if defined(AX_ENABLE_NAVMESH)
 class NavMesh;
 #endif
+#if defined(AX_ENABLE_3D)
+class CullingBVH;
+#endif
 
 /**
  * @addtogroup _2d
@@ -222,6 +225,31 @@ protected:
 public:
     void stepPhysicsAndNavigation(float deltaTime);
 #endif
+
+#if defined(AX_ENABLE_3D)
+public:
+    /**
+     * Enable the bounding volume hierarchy of the scene, the 3D meshes register their world bounds to it and the
+     * meshes outside of the frustum of the visiting camera are not drawn. Useful for scenes with many static meshes.
+     */
+    void setCulling3DEnabled(bool enabled);
+    bool isCulling3DEnabled() const { return _cullingBVH != nullptr; }
+
+    /** get the bounding volume hierarchy, nullptr if disabled */
+    CullingBVH* getCullingBVH() const { return _cullingBVH; }
+
+    /** get the count of the visible meshes culled by the last visiting camera */
+    int getCulling3DVisibleCount() const { return _culling3DVisibleCount; }
+
+    /** get the bounding volume hierarchy culled for the visiting camera, nullptr if disabled by the scene */
+    static CullingBVH* getVisitingCullingBVH() { return _visitingCullingBVH; }
+
+protected:
+    CullingBVH* _cullingBVH    = nullptr;
+    int _culling3DVisibleCount = 0;
+
+    static CullingBVH* _visitingCullingBVH;
+#endif
 };
 
 // end of _2d group
@@ -36,6 +36,8 @@ THE SOFTWARE.
 #include "2d/Sprite.h"
 #include "2d/AutoPolygon.h"
 #include "2d/PlistSpriteSheetLoader.h"
+#include "2d/BinarySpriteSheetLoader.h"
+#include "2d/JsonSpriteSheetLoader.h"
 #include "platform/FileUtils.h"
 #include "base/Macros.h"
 #include "base/Director.h"
@@ -70,6 +72,8 @@ bool SpriteFrameCache::init()
     clear();
 
     registerSpriteSheetLoader(std::make_shared<PlistSpriteSheetLoader>());
+    registerSpriteSheetLoader(std::make_shared<BinarySpriteSheetLoader>());
+    registerSpriteSheetLoader(std::make_shared<JsonSpriteSheetLoader>());
 
     return true;
 }
@@ -403,6 +407,12 @@ SpriteFrame* SpriteFrameCache::findFrame(std::string_view frame)
     return _spriteFrames.at(frame);
 }
 
+const SpriteSheet* SpriteFrameCache::findSpriteSheet(std::string_view spriteSheetFileName) const
+{
+    auto it = _spriteSheets.find(spriteSheetFileName);
+    return it != _spriteSheets.end() ? it->second.get() : nullptr;
+}
+
 std::string_view SpriteFrameCache::getSpriteFrameName(SpriteFrame* frame)
 {
     for (auto& it : _spriteFrames)
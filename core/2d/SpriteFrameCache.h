@@ -248,6 +248,9 @@ public:
 
     SpriteFrame* findFrame(std::string_view frame);
 
+    /** The sprite sheet loaded from a file, or nullptr if not loaded */
+    const SpriteSheet* findSpriteSheet(std::string_view spriteSheetFileName) const;
+
     std::string_view getSpriteFrameName(SpriteFrame* frame);
 
     /**  Record SpriteFrame with plist and frame name, add frame name
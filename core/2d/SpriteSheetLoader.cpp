@@ -1,5 +1,9 @@
 #include "2d/SpriteSheetLoader.h"
+#include "2d/SpriteFrameCache.h"
 #include "base/Director.h"
+#include "base/NinePatchImageParser.h"
+#include "platform/FileUtils.h"
+#include "renderer/TextureCache.h"
 #include <vector>
 
 using namespace std;
@@ -13,13 +17,14 @@ void SpriteSheetLoader::initializePolygonInfo(const Vec2& textureSize,
                                               const std::vector<int>& triangleIndices,
                                               PolygonInfo& info)
 {
-    const auto vertexCount = vertices.size();
+    // x, y of each vertex
+    const auto vertexCount = vertices.size() / 2;
     const auto indexCount  = triangleIndices.size();
 
     const auto scaleFactor = AX_CONTENT_SCALE_FACTOR();
 
     auto* vertexData = new V3F_C4B_T2F[vertexCount];
-    for (size_t i = 0; i < vertexCount / 2; i++)
+    for (size_t i = 0; i < vertexCount; i++)
     {
         vertexData[i].colors = Color4B::WHITE;
         vertexData[i].vertices =
@@ -41,4 +46,69 @@ void SpriteSheetLoader::initializePolygonInfo(const Vec2& textureSize,
     info.setRect(Rect(0, 0, spriteSize.width, spriteSize.height));
 }
 
+std::string SpriteSheetLoader::getTexturePath(std::string_view textureFileName, std::string_view filePath)
+{
+    if (!textureFileName.empty())
+    {
+        // build texture path relative to the sprite sheet file
+        return FileUtils::getInstance()->fullPathFromRelativeFile(textureFileName, filePath);
+    }
+
+    // build texture path by replacing file extension
+    std::string texturePath{filePath};
+    const auto startPos = texturePath.find_last_of('.');
+    if (startPos != string::npos)
+    {
+        texturePath.erase(startPos);
+    }
+    texturePath.append(".png");
+
+    AXLOGD("SpriteFrameCache: Trying to use file {} as texture", texturePath);
+    return texturePath;
+}
+
+Texture2D* SpriteSheetLoader::addTexture(std::string_view texturePath, std::string_view pixelFormatName)
+{
+    static hlookup::string_map<backend::PixelFormat> pixelFormats = {
+        {"RGBA8888", backend::PixelFormat::RGBA8},
+        {"RGBA4444", backend::PixelFormat::RGBA4},
+        {"RGB5A1", backend::PixelFormat::RGB5A1},
+        {"RGBA5551", backend::PixelFormat::RGB5A1},
+        {"RGB565", backend::PixelFormat::RGB565},
+        {"R8", backend::PixelFormat::R8},
+        {"RG8", backend::PixelFormat::RG8},
+        //{"BGRA8888", backend::PixelFormat::BGRA8888}, no Image conversion RGBA -> BGRA
+        {"RGB888", backend::PixelFormat::RGB8}};
+
+    auto textureCache        = Director::getInstance()->getTextureCache();
+    const auto pixelFormatIt = pixelFormats.find(pixelFormatName);
+    if (pixelFormatIt != pixelFormats.end())
+    {
+        return textureCache->addImage(texturePath, pixelFormatIt->second);
+    }
+    return textureCache->addImage(texturePath);
+}
+
+void SpriteSheetLoader::addNinePatchCapInset(std::string_view frameName,
+                                             SpriteFrame* spriteFrame,
+                                             Texture2D* texture,
+                                             Image*& image,
+                                             SpriteFrameCache& cache)
+{
+    if (!NinePatchImageParser::isNinePatchImage(frameName))
+    {
+        return;
+    }
+
+    if (image == nullptr)
+    {
+        image = new Image();
+        image->initWithImageFile(Director::getInstance()->getTextureCache()->getTextureFilePath(texture));
+    }
+
+    NinePatchImageParser parser;
+    parser.setSpriteFrameInfo(image, spriteFrame->getRectInPixels(), spriteFrame->isRotated());
+    cache.addSpriteFrameCapInset(spriteFrame, parser.parseCapInset(), texture);
+}
+
 NS_AX_END
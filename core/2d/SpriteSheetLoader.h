@@ -45,6 +45,7 @@ class Sprite;
 class Texture2D;
 class PolygonInfo;
 class SpriteFrameCache;
+class Image;
 
 /**
  * @addtogroup _2d
@@ -56,6 +57,8 @@ struct SpriteSheetFormat
     enum : uint32_t
     {
         PLIST  = 1,
+        BINARY = 2,
+        JSON   = 3,
         CUSTOM = 1000
     };
 };
@@ -98,6 +101,20 @@ public:
     void load(std::string_view filePath, std::string_view textureFileName, SpriteFrameCache& cache) override = 0;
     void load(const Data& content, Texture2D* texture, SpriteFrameCache& cache) override                     = 0;
     void reload(std::string_view filePath, SpriteFrameCache& cache) override                                 = 0;
+
+protected:
+    /** The texture named by the sheet relative to the sheet file, or the sheet file with .png extension if not named */
+    static std::string getTexturePath(std::string_view textureFileName, std::string_view filePath);
+
+    /** Adds the texture with the pixel format named by the sheet, e.g. "RGBA4444", or the default format */
+    static Texture2D* addTexture(std::string_view texturePath, std::string_view pixelFormatName);
+
+    /** Adds the cap insets of a nine-patch frame, the texture image is loaded into image on first use */
+    static void addNinePatchCapInset(std::string_view frameName,
+                                     SpriteFrame* spriteFrame,
+                                     Texture2D* texture,
+                                     Image*& image,
+                                     SpriteFrameCache& cache);
 };
 
 // end of _2d group
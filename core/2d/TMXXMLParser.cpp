@@ -31,17 +31,94 @@ THE SOFTWARE.
 #include "2d/TMXXMLParser.h"
 #include <unordered_map>
 #include <sstream>
-#include <regex>
+#include <algorithm>
 //  #include "2d/TMXTiledMap.h"
 #include "base/ZipUtils.h"
 #include "base/Director.h"
+#include "base/JobSystem.h"
 #include "base/Utils.h"
 #include "platform/FileUtils.h"
+#include "xxhash.h"
 
 // using namespace std;
 
 NS_AX_BEGIN
 
+namespace
+{
+constexpr uint32_t TMX_CACHE_MAGIC   = 0x4d544d41;  // AMTM
+constexpr uint32_t TMX_CACHE_VERSION = 1;
+
+struct TMXCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t layerCount;
+    uint32_t reserved;
+};
+
+bool s_binaryCacheEnabled = false;
+
+// base64 with the optional compression, or csv
+bool decodeLayerTiles(std::string_view data, int attribs, const Vec2& layerSize, uint32_t*& tiles, size_t& count)
+{
+    if (attribs & TMXLayerAttribBase64)
+    {
+        auto buffer = utils::base64Decode(data);
+        if (buffer.empty())
+        {
+            AXLOGW("TiledMap: decode data error");
+            return false;
+        }
+
+        if (attribs & (TMXLayerAttribGzip | TMXLayerAttribZlib))
+        {
+            auto sizeHint = static_cast<size_t>(layerSize.width * layerSize.height) * sizeof(uint32_t);
+
+            buffer = ZipUtils::decompressGZ(std::span{buffer}, static_cast<int>(sizeHint));
+            AXASSERT(buffer.size() == sizeHint, "inflatedLen should be equal to sizeHint!");
+
+            if (buffer.empty())
+            {
+                AXLOGW("TiledMap: inflate data error");
+                return false;
+            }
+        }
+
+        count = buffer.size() / sizeof(uint32_t);
+        tiles = reinterpret_cast<uint32_t*>(buffer.release_pointer());
+        return true;
+    }
+
+    // 32-bits per gid, the whitespaces were dropped by the text handler
+    axstd::pod_vector<uint32_t> buffer;
+    buffer.reserve(static_cast<size_t>(layerSize.width * layerSize.height));
+    uint32_t gid = 0;
+    bool digits  = false;
+    for (auto c : data)
+    {
+        if (c == ',')
+        {
+            buffer.emplace_back(gid);
+            gid    = 0;
+            digits = false;
+        }
+        else if (c >= '0' && c <= '9')
+        {
+            gid    = gid * 10 + (c - '0');
+            digits = true;
+        }
+    }
+    if (digits)
+        buffer.emplace_back(gid);
+
+    count = buffer.size();
+    tiles = buffer.release_pointer();
+    return true;
+}
+}  // namespace
+
 // implementation TMXLayerInfo
 TMXLayerInfo::TMXLayerInfo() : _name(""), _tiles(nullptr), _ownTiles(true) {}
 
@@ -143,15 +220,36 @@ void TMXMapInfo::internalInit(std::string_view tmxFileName, std::string_view res
 bool TMXMapInfo::initWithXML(std::string_view tmxString, std::string_view resourcePath)
 {
     internalInit("", resourcePath);
+    if (s_binaryCacheEnabled)
+        loadBinaryCache(tmxString);
     return parseXMLString(tmxString);
 }
 
 bool TMXMapInfo::initWithTMXFile(std::string_view tmxFile)
 {
     internalInit(tmxFile, "");
+    if (s_binaryCacheEnabled)
+    {
+        // the content is the cache key, read it once for both
+        auto content = FileUtils::getInstance()->getStringFromFile(_TMXFileName);
+        if (content.empty())
+            return false;
+        loadBinaryCache(content);
+        return parseXMLString(content);
+    }
     return parseXMLFile(_TMXFileName);
 }
 
+void TMXMapInfo::setBinaryCacheEnabled(bool enabled)
+{
+    s_binaryCacheEnabled = enabled;
+}
+
+bool TMXMapInfo::isBinaryCacheEnabled()
+{
+    return s_binaryCacheEnabled;
+}
+
 TMXMapInfo::TMXMapInfo()
     : _orientation(TMXOrientationOrtho)
     , _staggerAxis(TMXStaggerAxis_Y)
@@ -188,7 +286,11 @@ bool TMXMapInfo::parseXMLString(std::string_view xmlString)
 
     parser.setDelegator(this);
 
-    return parser.parse(xmlString.data(), len, SAXParser::ParseOption::TRIM_WHITESPACE);
+    ++_parseDepth;
+    bool ret = parser.parse(xmlString.data(), len, SAXParser::ParseOption::TRIM_WHITESPACE);
+    if (--_parseDepth == 0)
+        decodeLayerData();
+    return ret;
 }
 
 bool TMXMapInfo::parseXMLFile(std::string_view xmlFilename)
@@ -202,7 +304,125 @@ bool TMXMapInfo::parseXMLFile(std::string_view xmlFilename)
 
     parser.setDelegator(this);
 
-    return parser.parse(xmlFilename, SAXParser::ParseOption::TRIM_WHITESPACE);
+    // a tsx file may be parsed while parsing the map
+    ++_parseDepth;
+    bool ret = parser.parse(xmlFilename, SAXParser::ParseOption::TRIM_WHITESPACE);
+    if (--_parseDepth == 0)
+        decodeLayerData();
+    return ret;
+}
+
+void TMXMapInfo::decodeLayerData()
+{
+    // the cached tiles were copied to the layers
+    _cacheData.clear();
+    _cachedLayers.clear();
+
+    if (_encodedLayers.empty())
+        return;
+
+    // the layers are independent, each one is decoded by one job
+    auto jobSystem = Director::getInstance()->getJobSystem();
+    std::vector<char> decoded(_encodedLayers.size(), 0);
+    jobSystem->parallelFor(_encodedLayers.size(), 1, [this, &decoded](size_t first, size_t last) {
+        for (auto i = first; i < last; ++i)
+        {
+            auto& encoded = _encodedLayers[i];
+            auto layer    = encoded.layer;
+            decoded[i]    = decodeLayerTiles(encoded.data, encoded.attribs, layer->_layerSize, layer->_tiles,
+                                             encoded.tileCount);
+            encoded.data  = std::string{};
+        }
+    });
+
+    if (s_binaryCacheEnabled && _cacheKey && !_cacheHit && std::find(decoded.begin(), decoded.end(), 0) == decoded.end())
+        saveBinaryCache();
+    _encodedLayers.clear();
+}
+
+std::string TMXMapInfo::getBinaryCachePath() const
+{
+    return fmt::format("{}tmx-cache/{:016x}.bin", FileUtils::getInstance()->getWritablePath(), _cacheKey);
+}
+
+void TMXMapInfo::loadBinaryCache(std::string_view tmxContent)
+{
+    _cacheKey = XXH3_64bits(tmxContent.data(), tmxContent.size());
+    _cachedLayers.clear();
+    _cachedLayerIndex = 0;
+    _cacheHit         = false;
+
+    auto path = getBinaryCachePath();
+    auto data = FileUtils::getInstance()->getDataFromFile(path);
+    auto size = static_cast<size_t>(data.getSize());
+    if (size < sizeof(TMXCacheHeader) + sizeof(uint64_t))
+        return;
+
+    auto bytes = data.getBytes();
+    TMXCacheHeader header;
+    memcpy(&header, bytes, sizeof(header));
+    uint64_t checksum;
+    memcpy(&checksum, bytes + size - sizeof(checksum), sizeof(checksum));
+    if (header.magic != TMX_CACHE_MAGIC || header.version != TMX_CACHE_VERSION || header.key != _cacheKey ||
+        checksum != XXH3_64bits(bytes, size - sizeof(checksum)))
+    {
+        AXLOGW("TiledMap: drop the invalid binary cache {}", path);
+        FileUtils::getInstance()->removeFile(path);
+        return;
+    }
+
+    size_t offset = sizeof(header);
+    for (uint32_t i = 0; i < header.layerCount; ++i)
+    {
+        uint32_t count;
+        if (offset + sizeof(count) > size - sizeof(checksum))
+            return;
+        memcpy(&count, bytes + offset, sizeof(count));
+        offset += sizeof(count);
+        if (offset + count * sizeof(uint32_t) > size - sizeof(checksum))
+            return;
+        _cachedLayers.emplace_back(offset, count);
+        offset += count * sizeof(uint32_t);
+    }
+
+    _cacheData = std::move(data);
+    _cacheHit  = true;
+}
+
+void TMXMapInfo::saveBinaryCache()
+{
+    size_t size = sizeof(TMXCacheHeader) + sizeof(uint64_t);
+    for (auto&& encoded : _encodedLayers)
+        size += sizeof(uint32_t) + encoded.tileCount * sizeof(uint32_t);
+
+    std::vector<uint8_t> data(size);
+    TMXCacheHeader header{TMX_CACHE_MAGIC, TMX_CACHE_VERSION, _cacheKey, static_cast<uint32_t>(_encodedLayers.size()),
+                          0};
+    memcpy(data.data(), &header, sizeof(header));
+    size_t offset = sizeof(header);
+    for (auto&& encoded : _encodedLayers)
+    {
+        auto count = static_cast<uint32_t>(encoded.tileCount);
+        memcpy(data.data() + offset, &count, sizeof(count));
+        offset += sizeof(count);
+        memcpy(data.data() + offset, encoded.layer->_tiles, count * sizeof(uint32_t));
+        offset += count * sizeof(uint32_t);
+    }
+    uint64_t checksum = XXH3_64bits(data.data(), offset);
+    memcpy(data.data() + offset, &checksum, sizeof(checksum));
+
+    // write aside then rename, so a reader never sees a partial file
+    auto fileUtils = FileUtils::getInstance();
+    auto path      = getBinaryCachePath();
+    auto dir       = path.substr(0, path.find_last_of('/') + 1);
+    if (!fileUtils->isDirectoryExist(dir))
+        fileUtils->createDirectories(dir);
+    auto tmpPath = path + ".tmp";
+    if (!FileUtils::writeBinaryToFile(data.data(), data.size(), tmpPath) || !fileUtils->renameFile(tmpPath, path))
+    {
+        AXLOGW("TiledMap: write the binary cache {} failed", path);
+        fileUtils->removeFile(tmpPath);
+    }
 }
 
 // the XML parser calls here with all the elements
@@ -475,6 +695,18 @@ void TMXMapInfo::startElement(void* /*ctx*/, const char* name, const char** atts
             tmxMapInfo->setLayerAttribs(layerAttribs | TMXLayerAttribCSV);
             tmxMapInfo->setStoringCharacters(true);
         }
+
+        if ((encoding == "base64" || encoding == "csv") && _cachedLayerIndex < _cachedLayers.size())
+        {
+            // the tiles are in the binary cache, skip the layer data
+            auto [offset, count] = _cachedLayers[_cachedLayerIndex++];
+            axstd::pod_vector<uint32_t> tiles(count);
+            memcpy(tiles.data(), _cacheData.getBytes() + offset, count * sizeof(uint32_t));
+
+            tmxMapInfo->getLayers().back()->_tiles = tiles.release_pointer();
+            tmxMapInfo->setStoringCharacters(false);
+            _layerFromCache = true;
+        }
     }
     else if (elementName == "object")
     {
@@ -689,77 +921,18 @@ void TMXMapInfo::endElement(void* /*ctx*/, const char* name)
 
     if (elementName == "data")
     {
-        if (tmxMapInfo->getLayerAttribs() & TMXLayerAttribBase64)
+        if (_layerFromCache)
         {
-            tmxMapInfo->setStoringCharacters(false);
-
-            TMXLayerInfo* layer = tmxMapInfo->getLayers().back();
-            auto currentString = tmxMapInfo->getCurrentString();
-
-            auto buffer = utils::base64Decode(currentString);
-            if (buffer.empty())
-            {
-                AXLOGW("TiledMap: decode data error");
-                return;
-            }
-
-            if (tmxMapInfo->getLayerAttribs() & (TMXLayerAttribGzip | TMXLayerAttribZlib))
-            {
-                Vec2 s                  = layer->_layerSize;
-                // int sizeHint = s.width * s.height * sizeof(uint32_t);
-                ssize_t sizeHint = s.width * s.height * sizeof(unsigned int);
-
-                buffer = ZipUtils::decompressGZ(std::span{buffer}, static_cast<int>(sizeHint));
-                AXASSERT(buffer.size() == sizeHint, "inflatedLen should be equal to sizeHint!");
-
-                if (buffer.empty())
-                {
-                    AXLOGW("TiledMap: inflate data error");
-                    return;
-                }
-
-                layer->_tiles = reinterpret_cast<uint32_t*>(buffer.release_pointer());
-            }
-            else
-            {
-                layer->_tiles = reinterpret_cast<uint32_t*>(buffer.release_pointer());
-            }
-
+            _layerFromCache = false;
             tmxMapInfo->setCurrentString("");
         }
-        else if (tmxMapInfo->getLayerAttribs() & TMXLayerAttribCSV)
+        else if (tmxMapInfo->getLayerAttribs() & (TMXLayerAttribBase64 | TMXLayerAttribCSV))
         {
-            TMXLayerInfo* layer = tmxMapInfo->getLayers().back();
-
             tmxMapInfo->setStoringCharacters(false);
-            auto currentString = tmxMapInfo->getCurrentString();
-
-            std::vector<std::string> gidTokens;
-            std::stringstream filestr;
-            filestr << currentString;
-            std::string sRow;
-            while (std::getline(filestr, sRow, '\n'))
-            {
-                std::string sGID;
-                std::istringstream rowstr(sRow);
-                while (std::getline(rowstr, sGID, ','))
-                {
-                    gidTokens.emplace_back(sGID);
-                }
-            }
-
-            // 32-bits per gid
-            axstd::pod_vector<uint32_t> buffer(gidTokens.size());
-            uint32_t* bufferPtr = buffer.data();
-            for (const auto& gidToken : gidTokens)
-            {
-                auto tileGid = (uint32_t)strtoul(gidToken.c_str(), nullptr, 10);
-                *bufferPtr   = tileGid;
-                bufferPtr++;
-            }
-
-            layer->_tiles = buffer.release_pointer();
 
+            // decoded on the job threads after the whole map parsed
+            _encodedLayers.emplace_back(
+                EncodedLayerData{tmxMapInfo->getLayers().back(), tmxMapInfo->getLayerAttribs(), std::move(_currentString), 0});
             tmxMapInfo->setCurrentString("");
         }
         else if (tmxMapInfo->getLayerAttribs() & TMXLayerAttribNone)
@@ -846,24 +1019,19 @@ void TMXMapInfo::endElement(void* /*ctx*/, const char* name)
 
 void TMXMapInfo::textHandler(void* /*ctx*/, const char* ch, size_t len)
 {
-    TMXMapInfo* tmxMapInfo = this;
-    std::string text(ch, 0, len);
+    if (!isStoringCharacters())
+        return;
 
+    // appended in place, the layer data may be megabytes received in many pieces
+    auto first = _currentString.size();
+    _currentString.append(ch, len);
+    auto begin = _currentString.begin() + first;
     if (!_currentPropertyKey.empty())
-    {
-        text = std::regex_replace(text, std::regex("[\r]"), "");
-    }
+        _currentString.erase(std::remove(begin, _currentString.end(), '\r'), _currentString.end());
     else
-    {
-        text = std::regex_replace(text, std::regex("[\n\r ]"), "");
-    }
-
-    if (tmxMapInfo->isStoringCharacters())
-    {
-        std::string currentString{tmxMapInfo->getCurrentString()};
-        currentString += text;
-        tmxMapInfo->setCurrentString(currentString);
-    }
+        _currentString.erase(
+            std::remove_if(begin, _currentString.end(), [](char c) { return c == '\n' || c == '\r' || c == ' '; }),
+            _currentString.end());
 }
 
 TMXTileAnimFrame::TMXTileAnimFrame(uint32_t tileID, float duration) : _tileID(tileID), _duration(duration) {}
@@ -38,8 +38,10 @@ THE SOFTWARE.
 #include "base/Map.h"
 #include "base/Value.h"
 #include "2d/TMXObjectGroup.h"  // needed for Vector<TMXObjectGroup*> for binding
+#include "base/Data.h"
 
 #include <string>
+#include <vector>
 
 NS_AX_BEGIN
 
@@ -285,6 +287,17 @@ public:
     /* initializes parsing of an XML string, either a tmx (Map) string or tsx (Tileset) string */
     bool parseXMLString(std::string_view xmlString);
 
+    /**
+     * Enable the binary cache of the layer tiles, disabled by default.
+     * The decoded tiles of the base64 and csv layers are written to the writable path after a map loaded,
+     * the next loads of the same map content read them back instead of decoding the layer data again.
+     */
+    static void setBinaryCacheEnabled(bool enabled);
+    static bool isBinaryCacheEnabled();
+
+    /** Whether the layer tiles were read from the binary cache */
+    bool isLoadedFromBinaryCache() const { return _cacheHit; }
+
     ValueMapIntKey& getTileProperties() { return _tileProperties; };
     void setTileProperties(const ValueMapIntKey& tileProperties) { _tileProperties = tileProperties; }
 
@@ -374,6 +387,31 @@ public:
 protected:
     void internalInit(std::string_view tmxFileName, std::string_view resourcePath);
 
+    // Decode the data of the encoded layers on the job threads, after the whole map parsed
+    void decodeLayerData();
+
+    void loadBinaryCache(std::string_view tmxContent);
+    void saveBinaryCache();
+    std::string getBinaryCachePath() const;
+
+    struct EncodedLayerData
+    {
+        TMXLayerInfo* layer;
+        int attribs;
+        std::string data;
+        size_t tileCount;
+    };
+    std::vector<EncodedLayerData> _encodedLayers;
+    int _parseDepth = 0;
+
+    // the binary cache of the map, the tiles of the encoded layers in order
+    uint64_t _cacheKey = 0;
+    Data _cacheData;
+    std::vector<std::pair<size_t /*offset*/, uint32_t /*tile count*/>> _cachedLayers;
+    size_t _cachedLayerIndex = 0;
+    bool _layerFromCache     = false;
+    bool _cacheHit           = false;
+
     /// map orientation
     int _orientation;
     /// map staggerAxis
@@ -153,6 +153,7 @@ void Animate3D::startWithTarget(Node* target)
 
     if (needReMap)
     {
+        _bones.clear();
         _boneCurves.clear();
         _nodeCurves.clear();
 
@@ -173,9 +174,9 @@ void Animate3D::startWithTarget(Node* target)
                         auto bone = skin->getBoneByName(boneName);
                         if (bone)
                         {
-                            auto curve        = _animation->getBoneCurveByName(boneName);
-                            _boneCurves[bone] = curve;
-                            hasCurve          = true;
+                            _bones.emplace_back(bone);
+                            _boneCurves.emplace_back(_animation->getBoneCurveByName(boneName));
+                            hasCurve = true;
                         }
                         else
                         {
@@ -227,6 +228,9 @@ void Animate3D::startWithTarget(Node* target)
         {
             AXLOGW("warning: no animation found for the skeleton");
         }
+
+        _boneCursors.assign(_bones.size(), Animation3D::CurveCursor());
+        _bonePoses.resize(_bones.size());
     }
 
     auto runningAction = s_runningAnimates.find(target);
@@ -335,7 +339,6 @@ void Animate3D::update(float t)
             if (_weight > 0.0f)
             {
                 float transDst[3], rotDst[4], scaleDst[3];
-                float *trans = nullptr, *rot = nullptr, *scale = nullptr;
                 if (_playReverse)
                 {
                     t        = 1 - t;
@@ -345,26 +348,14 @@ void Animate3D::update(float t)
                 t        = _start + t * _last;
                 lastTime = _start + lastTime * _last;
 
-                for (const auto& it : _boneCurves)
+                Animation3D::evaluatePose(t, _boneCurves.data(), _boneCursors.data(), _bonePoses.data(),
+                                          _bones.size(), _translateEvaluate, _roteEvaluate, _scaleEvaluate);
+                for (size_t i = 0, count = _bones.size(); i < count; ++i)
                 {
-                    auto bone  = it.first;
-                    auto curve = it.second;
-                    if (curve->translateCurve)
-                    {
-                        curve->translateCurve->evaluate(t, transDst, _translateEvaluate);
-                        trans = &transDst[0];
-                    }
-                    if (curve->rotCurve)
-                    {
-                        curve->rotCurve->evaluate(t, rotDst, _roteEvaluate);
-                        rot = &rotDst[0];
-                    }
-                    if (curve->scaleCurve)
-                    {
-                        curve->scaleCurve->evaluate(t, scaleDst, _scaleEvaluate);
-                        scale = &scaleDst[0];
-                    }
-                    bone->setAnimationValue(trans, rot, scale, this, _weight);
+                    auto& pose = _bonePoses[i];
+                    _bones[i]->setAnimationValue(pose.hasTranslate ? pose.translate : nullptr,
+                                                 pose.hasRot ? pose.rot : nullptr,
+                                                 pose.hasScale ? pose.scale : nullptr, this, _weight);
                 }
 
                 for (const auto& it : _nodeCurves)
@@ -168,7 +168,11 @@ protected:
     EvaluateType _scaleEvaluate;
     Animate3DQuality _quality;
 
-    std::unordered_map<Bone3D*, Animation3D::Curve*> _boneCurves;  // weak ref
+    // the bones animated and their curves, cursors and sampled poses, by the same index
+    std::vector<Bone3D*> _bones;
+    std::vector<Animation3D::Curve*> _boneCurves;  // weak ref
+    std::vector<Animation3D::CurveCursor> _boneCursors;
+    std::vector<Animation3D::BonePose> _bonePoses;
     std::unordered_map<Node*, Animation3D::Curve*> _nodeCurves;
 
     std::unordered_map<int, ValueMap> _keyFrameUserInfos;
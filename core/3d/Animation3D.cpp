@@ -31,6 +31,8 @@
 
 NS_AX_BEGIN
 
+bool Animation3D::_curveQuantization = false;
+
 Animation3D* Animation3D::create(std::string_view fileName, std::string_view animationName)
 {
     std::string fullPath = FileUtils::getInstance()->fullPathForFilename(fileName);
@@ -81,6 +83,51 @@ Animation3D::Curve* Animation3D::getBoneCurveByName(std::string_view name) const
     return nullptr;
 }
 
+size_t Animation3D::getCurvesMemorySize() const
+{
+    size_t size = 0;
+    for (const auto& itor : _boneCurves)
+    {
+        auto curve = itor.second;
+        if (curve->translateCurve)
+            size += curve->translateCurve->getKeysMemorySize();
+        if (curve->rotCurve)
+            size += curve->rotCurve->getKeysMemorySize();
+        if (curve->scaleCurve)
+            size += curve->scaleCurve->getKeysMemorySize();
+    }
+    return size;
+}
+
+void Animation3D::evaluatePose(float time,
+                               Curve* const* curves,
+                               CurveCursor* cursors,
+                               BonePose* poses,
+                               size_t count,
+                               EvaluateType translateType,
+                               EvaluateType rotType,
+                               EvaluateType scaleType)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto curve   = curves[i];
+        auto& pose   = poses[i];
+        auto& cursor = cursors[i];
+
+        pose.hasTranslate = curve->translateCurve != nullptr;
+        if (pose.hasTranslate)
+            curve->translateCurve->evaluate(time, pose.translate, translateType, cursor.translate);
+
+        pose.hasRot = curve->rotCurve != nullptr;
+        if (pose.hasRot)
+            curve->rotCurve->evaluate(time, pose.rot, rotType, cursor.rot);
+
+        pose.hasScale = curve->scaleCurve != nullptr;
+        if (pose.hasScale)
+            curve->scaleCurve->evaluate(time, pose.scale, scaleType, cursor.scale);
+    }
+}
+
 Animation3D::Animation3D() : _duration(0) {}
 
 Animation3D::~Animation3D()
@@ -127,7 +174,8 @@ bool Animation3D::init(const Animation3DData& data)
             axstd::resize_and_transform(iter.second.begin(), iter.second.end(), values,
                                         [](const auto& keyIter) { return keyIter._key; });
 
-            curve->translateCurve = Curve::AnimationCurveVec3::create(&keys[0], &values[0].x, (int)keys.size());
+            curve->translateCurve =
+                Curve::AnimationCurveVec3::create(&keys[0], &values[0].x, (int)keys.size(), _curveQuantization);
             if (curve->translateCurve)
                 curve->translateCurve->retain();
         }
@@ -153,7 +201,8 @@ bool Animation3D::init(const Animation3DData& data)
             axstd::resize_and_transform(iter.second.begin(), iter.second.end(), values,
                                         [](const auto& keyIter) { return keyIter._key; });
 
-            curve->rotCurve = Curve::AnimationCurveQuat::create(&keys[0], &values[0].x, (int)keys.size());
+            curve->rotCurve =
+                Curve::AnimationCurveQuat::create(&keys[0], &values[0].x, (int)keys.size(), _curveQuantization);
             if (curve->rotCurve)
                 curve->rotCurve->retain();
         }
@@ -179,7 +228,8 @@ bool Animation3D::init(const Animation3DData& data)
             axstd::resize_and_transform(iter.second.begin(), iter.second.end(), values,
                                         [](const auto& keyIter) { return keyIter._key; });
 
-            curve->scaleCurve = Curve::AnimationCurveVec3::create(&keys[0], &values[0].x, (int)keys.size());
+            curve->scaleCurve =
+                Curve::AnimationCurveVec3::create(&keys[0], &values[0].x, (int)keys.size(), _curveQuantization);
             if (curve->scaleCurve)
                 curve->scaleCurve->retain();
         }
@@ -68,6 +68,51 @@ public:
         ~Curve();
     };
 
+    /**
+     * the keys a playback sampled last from the curves of a bone, see AnimationCurve::evaluate
+     */
+    struct CurveCursor
+    {
+        int translate = -1;
+        int rot       = -1;
+        int scale     = -1;
+    };
+
+    /**
+     * the local transform of a bone sampled from its curve, a component is valid only if the curve has it
+     */
+    struct BonePose
+    {
+        float translate[3];
+        float rot[4];
+        float scale[3];
+        bool hasTranslate;
+        bool hasRot;
+        bool hasScale;
+    };
+
+    /**
+     * sample the curves of a whole skeleton at time in one call
+     * @param curves The curves of count bones
+     * @param cursors The cursors of the bones of the playback, updated by the sampling
+     * @param poses Receives the sampled transforms of the bones
+     */
+    static void evaluatePose(float time,
+                             Curve* const* curves,
+                             CurveCursor* cursors,
+                             BonePose* poses,
+                             size_t count,
+                             EvaluateType translateType,
+                             EvaluateType rotType,
+                             EvaluateType scaleType);
+
+    /**
+     * set whether the animations loaded afterwards store quantized curves, 16 bits per component instead of a float,
+     * and constant curves with one key. It cuts the key memory by about a half, at the cost of a small precision loss.
+     */
+    static void setCurveQuantization(bool enabled) { _curveQuantization = enabled; }
+    static bool isCurveQuantization() { return _curveQuantization; }
+
     /**read all animation or only the animation with given animationName? animationName == "" read the first.*/
     static Animation3D* create(std::string_view filename, std::string_view animationName = "");
 
@@ -84,6 +129,9 @@ public:
     /**get the bone Curves set*/
     const hlookup::string_map<Curve*>& getBoneCurves() const { return _boneCurves; }
 
+    /**get the bytes of the key times and values of all curves*/
+    size_t getCurvesMemorySize() const;
+
     Animation3D();
     virtual ~Animation3D();
     /**init Animation3D from bundle data*/
@@ -96,6 +144,8 @@ protected:
     hlookup::string_map<Curve*> _boneCurves;  // bone curves map, key bone name, value AnimationCurve
 
     float _duration;  // animation duration
+
+    static bool _curveQuantization;
 };
 
 /**
@@ -25,6 +25,7 @@
 #ifndef __CCANIMATIONCURVE_H__
 #define __CCANIMATIONCURVE_H__
 
+#include <algorithm>
 #include <cmath>
 #include <functional>
 
@@ -59,8 +60,12 @@ template <int componentSize>
 class AnimationCurve : public Object
 {
 public:
-    /**create animation curve*/
-    static AnimationCurve* create(float* keytime, float* value, int count);
+    /**
+     * create animation curve
+     * @param quantize store the values in 16 bits per component, relative to the value range of the curve.
+     * A curve whose keys are all equal is reduced to one key.
+     */
+    static AnimationCurve* create(float* keytime, float* value, int count, bool quantize = false);
 
     /**
      * evaluate value of time
@@ -70,6 +75,13 @@ public:
      */
     void evaluate(float time, float* dst, EvaluateType type) const;
 
+    /**
+     * evaluate value of time, starting the key search from a cursor
+     * @param cursor The key index found by the last evaluation of the playback, -1 if none. It's updated to
+     * the key index of time, so sampling the curve forward or backward frame by frame doesn't search the keys.
+     */
+    void evaluate(float time, float* dst, EvaluateType type, int& cursor) const;
+
     /**set evaluate function, allow the user use own function*/
     void setEvaluateFun(std::function<void(float time, float* dst)> fun);
 
@@ -87,12 +99,33 @@ public:
      */
     int determineIndex(float time) const;
 
+    /**
+     * Determine index by time, checking the cursor and its neighbors before the binary search.
+     */
+    int determineIndex(float time, int& cursor) const;
+
+    /**get the key count*/
+    int getKeyCount() const { return _count; }
+
+    /**whether the values are quantized*/
+    bool isQuantized() const { return _quantized != nullptr; }
+
+    /**get the bytes of the key times and values*/
+    size_t getKeysMemorySize() const;
+
 protected:
+    /** get the value of key index, decoded into scratch if the values are quantized */
+    const float* getKey(int index, float* scratch) const;
+
     float* _value;    //
     float* _keytime;  // key time(0 - 1), start time _keytime[0], end time _keytime[_count - 1]
     int _count;
     int _componentSizeByte;  // component size in byte, position and scale 3 * sizeof(float), rotation 4 * sizeof(float)
 
+    uint16_t* _quantized;  // quantized values instead of _value, component = _base + q * _step
+    float _base[componentSize];
+    float _step[componentSize];
+
     std::function<void(float time, float* dst)> _evaluateFun;  // user defined function
 };
 
@@ -4,24 +4,32 @@ NS_AX_BEGIN
 template <int componentSize>
 void AnimationCurve<componentSize>::evaluate(float time, float* dst, EvaluateType type) const
 {
+    int cursor = -1;
+    evaluate(time, dst, type, cursor);
+}
+
+template <int componentSize>
+void AnimationCurve<componentSize>::evaluate(float time, float* dst, EvaluateType type, int& cursor) const
+{
+    float fromScratch[componentSize], toScratch[componentSize];
     if (_count == 1 || time <= _keytime[0])
     {
-        memcpy(dst, _value, _componentSizeByte);
+        memcpy(dst, getKey(0, fromScratch), _componentSizeByte);
         return;
     }
     else if (time >= _keytime[_count - 1])
     {
-        memcpy(dst, &_value[(_count - 1) * componentSize], _componentSizeByte);
+        memcpy(dst, getKey(_count - 1, fromScratch), _componentSizeByte);
         return;
     }
     
-    unsigned int index = determineIndex(time);
+    unsigned int index = determineIndex(time, cursor);
     
     float scale = (_keytime[index + 1] - _keytime[index]);
     float t = (time - _keytime[index]) / scale;
     
-    float* fromValue = &_value[index * componentSize];
-    float* toValue = fromValue + componentSize;
+    const float* fromValue = getKey(index, fromScratch);
+    const float* toValue = getKey(index + 1, toScratch);
     
     switch (type) {
         case EvaluateType::INT_LINEAR:
@@ -33,7 +41,7 @@ void AnimationCurve<componentSize>::evaluate(float time, float* dst, EvaluateTyp
         break;
         case EvaluateType::INT_NEAR:
         {
-            float* src = std::abs(t) > 0.5f ? toValue : fromValue;
+            const float* src = std::abs(t) > 0.5f ? toValue : fromValue;
             memcpy(dst, src, _componentSizeByte);
         }
         break;
@@ -41,10 +49,12 @@ void AnimationCurve<componentSize>::evaluate(float time, float* dst, EvaluateTyp
         {
             // Evaluate.
             Quaternion quat;
+            Quaternion from(fromValue[0], fromValue[1], fromValue[2], fromValue[3]);
+            Quaternion to(toValue[0], toValue[1], toValue[2], toValue[3]);
             if (t >= 0)
-                Quaternion::slerp(Quaternion(fromValue), Quaternion(toValue), t, &quat);
+                Quaternion::slerp(from, to, t, &quat);
             else
-                Quaternion::slerp(Quaternion(toValue), Quaternion(fromValue), t, &quat);
+                Quaternion::slerp(to, from, t, &quat);
             
             dst[0] = quat.x;
             dst[1] = quat.y;
@@ -72,17 +82,54 @@ void AnimationCurve<componentSize>::setEvaluateFun(std::function<void(float time
 
 //create animation curve
 template <int componentSize>
-AnimationCurve<componentSize>* AnimationCurve<componentSize>::create(float* keytime, float* value, int count)
+AnimationCurve<componentSize>* AnimationCurve<componentSize>::create(float* keytime, float* value, int count, bool quantize)
 {
+    if (quantize)
+    {
+        // constant curves are common, e.g. the scale of most bones, the first key holds them
+        bool constant = true;
+        for (int i = componentSize; i < count * componentSize && constant; ++i)
+            constant = value[i] == value[i % componentSize];
+        if (constant)
+            count = 1;
+    }
+
     int floatSize = sizeof(float);
     AnimationCurve* curve = new AnimationCurve();
     curve->_keytime = new float[count];
     memcpy(curve->_keytime, keytime, count * floatSize);
     
     int compoentSizeByte = componentSize * floatSize;
-    int totalByte = count * compoentSizeByte;
-    curve->_value = new float[totalByte / floatSize];
-    memcpy(curve->_value, value, totalByte);
+    if (quantize && count > 1)
+    {
+        float minValue[componentSize], maxValue[componentSize];
+        memcpy(minValue, value, compoentSizeByte);
+        memcpy(maxValue, value, compoentSizeByte);
+        for (int i = componentSize; i < count * componentSize; ++i)
+        {
+            minValue[i % componentSize] = std::min(minValue[i % componentSize], value[i]);
+            maxValue[i % componentSize] = std::max(maxValue[i % componentSize], value[i]);
+        }
+        for (int i = 0; i < componentSize; ++i)
+        {
+            curve->_base[i] = minValue[i];
+            curve->_step[i] = (maxValue[i] - minValue[i]) / 65535.0f;
+        }
+
+        curve->_quantized = new uint16_t[count * componentSize];
+        for (int i = 0; i < count * componentSize; ++i)
+        {
+            const float step = curve->_step[i % componentSize];
+            const long q = step > 0 ? std::lround((value[i] - curve->_base[i % componentSize]) / step) : 0;
+            curve->_quantized[i] = static_cast<uint16_t>(std::clamp(q, 0L, 65535L));
+        }
+    }
+    else
+    {
+        int totalByte = count * compoentSizeByte;
+        curve->_value = new float[totalByte / floatSize];
+        memcpy(curve->_value, value, totalByte);
+    }
     
     curve->_count = count;
     curve->_componentSizeByte = compoentSizeByte;
@@ -104,12 +151,44 @@ float AnimationCurve<componentSize>::getEndTime() const
 }
 
 
+template <int componentSize>
+size_t AnimationCurve<componentSize>::getKeysMemorySize() const
+{
+    const size_t valueSize = _quantized ? sizeof(uint16_t) : sizeof(float);
+    return _count * (sizeof(float) + componentSize * valueSize);
+}
+
+template <int componentSize>
+const float* AnimationCurve<componentSize>::getKey(int index, float* scratch) const
+{
+    if (!_quantized)
+        return &_value[index * componentSize];
+
+    const uint16_t* q = &_quantized[index * componentSize];
+    for (int i = 0; i < componentSize; ++i)
+        scratch[i] = _base[i] + q[i] * _step[i];
+
+    if constexpr (componentSize == 4)
+    {
+        // rotation, restore the unit length the quantization lost
+        float length = std::sqrt(scratch[0] * scratch[0] + scratch[1] * scratch[1] + scratch[2] * scratch[2] +
+                                 scratch[3] * scratch[3]);
+        if (length > 0)
+        {
+            for (int i = 0; i < 4; ++i)
+                scratch[i] /= length;
+        }
+    }
+    return scratch;
+}
+
 template <int componentSize>
 AnimationCurve<componentSize>::AnimationCurve()
 : _value(nullptr)
 , _keytime(nullptr)
 , _count(0)
 , _componentSizeByte(0)
+, _quantized(nullptr)
 , _evaluateFun(nullptr)
 {
     
@@ -119,6 +198,7 @@ AnimationCurve<componentSize>::~AnimationCurve()
 {
     AX_SAFE_DELETE_ARRAY(_keytime);
     AX_SAFE_DELETE_ARRAY(_value);
+    AX_SAFE_DELETE_ARRAY(_quantized);
 }
 
 template <int componentSize>
@@ -144,4 +224,25 @@ int AnimationCurve<componentSize>::determineIndex(float time) const
     return -1;
 }
 
+template <int componentSize>
+int AnimationCurve<componentSize>::determineIndex(float time, int& cursor) const
+{
+    // sequential sampling stays between the same keys, or steps to the next or previous ones
+    if (cursor >= 0 && cursor < _count - 1)
+    {
+        if (time < _keytime[cursor])
+        {
+            if (cursor > 0 && time >= _keytime[cursor - 1])
+                return --cursor;
+        }
+        else if (time <= _keytime[cursor + 1])
+            return cursor;
+        else if (cursor + 2 < _count && time <= _keytime[cursor + 2])
+            return ++cursor;
+    }
+
+    cursor = determineIndex(time);
+    return cursor;
+}
+
 NS_AX_END
\ No newline at end of file
@@ -161,6 +161,7 @@ void Bundle3D::clear()
     if (_isBinary)
     {
         _binaryBuffer.clear();
+        _binaryMapping.unmap();
         AX_SAFE_DELETE_ARRAY(_references);
     }
     else
@@ -1087,18 +1088,21 @@ bool Bundle3D::loadBinary(std::string_view path)
 {
     clear();
 
-    // get file data
-    _binaryBuffer.clear();
-    _binaryBuffer = FileUtils::getInstance()->getDataFromFile(path);
-    if (_binaryBuffer.isNull())
+    // get file data, the mapping lets the vertex and index blocks be copied out of the page cache directly
+    if (!mapBinaryFile(path))
     {
-        clear();
-        AXLOGW("warning: Failed to read file: {}", path);
-        return false;
-    }
+        _binaryBuffer.clear();
+        _binaryBuffer = FileUtils::getInstance()->getDataFromFile(path);
+        if (_binaryBuffer.isNull())
+        {
+            clear();
+            AXLOGW("warning: Failed to read file: {}", path);
+            return false;
+        }
 
-    // Initialise bundle reader
-    _binaryReader.init((char*)_binaryBuffer.getBytes(), _binaryBuffer.getSize());
+        // Initialise bundle reader
+        _binaryReader.init((char*)_binaryBuffer.getBytes(), _binaryBuffer.getSize());
+    }
 
     // Read identifier info
     char identifier[] = {'C', '3', 'B', '\0'};
@@ -1149,6 +1153,34 @@ bool Bundle3D::loadBinary(std::string_view path)
     return true;
 }
 
+bool Bundle3D::mapBinaryFile(std::string_view path)
+{
+    if (!_memoryMapping)
+        return false;
+
+    auto fs = FileUtils::getInstance()->openFileStream(FileUtils::getInstance()->fullPathForFilename(path),
+                                                       IFileStream::Mode::READ);
+    // not a plain file, e.g. in the android apk
+    if (!fs || fs->nativeHandle() == (osfhnd_t)-1)
+        return false;
+
+    const int64_t size = fs->size();
+    if (size <= 0)
+        return false;
+
+    std::error_code error;
+    _binaryMapping.map(fs->nativeHandle(), 0, static_cast<size_t>(size), error);
+    if (error || !_binaryMapping.is_mapped())
+    {
+        _binaryMapping.unmap();
+        return false;
+    }
+
+    // the reader never writes the buffer
+    _binaryReader.init(const_cast<char*>(_binaryMapping.data()), static_cast<ssize_t>(_binaryMapping.size()));
+    return true;
+}
+
 bool Bundle3D::loadMeshDataJson_0_1(MeshDatas& meshdatas)
 {
     const rapidjson::Value& mesh_data_array = _jsonReader[MESH];
@@ -2312,6 +2344,8 @@ std::vector<Vec3> Bundle3D::getTrianglesList(std::string_view path)
     return trianglesList;
 }
 
+bool Bundle3D::_memoryMapping = true;
+
 Bundle3D::Bundle3D()
     : _modelPath(""), _path(""), _version(""), _referenceCount(0), _references(nullptr), _isBinary(false)
 {}
@@ -31,6 +31,7 @@
 #include "3d/Bundle3DData.h"
 #include "3d/BundleReader.h"
 #include "rapidjson/document-wrapper.h"
+#include "mio/mio.hpp"
 
 NS_AX_BEGIN
 
@@ -73,6 +74,13 @@ public:
      */
     static backend::SamplerAddressMode parseSamplerAddressMode(std::string_view str);
 
+    /**
+     * set whether .c3b files are memory mapped instead of read into a buffer, enabled by default.
+     * Files which can't be mapped, e.g. in the android apk, are always read.
+     */
+    static void setMemoryMapping(bool enabled) { _memoryMapping = enabled; }
+    static bool isMemoryMapping() { return _memoryMapping; }
+
     /**
      * load a file. You must load a file first, then call loadMeshData, loadSkinData, and so on
      * @param path File to be loaded
@@ -121,6 +129,7 @@ public:
 protected:
     bool loadJson(std::string_view path);
     bool loadBinary(std::string_view path);
+    bool mapBinaryFile(std::string_view path);
     bool loadMeshDatasJson(MeshDatas& meshdatas);
     bool loadMeshDataJson_0_1(MeshDatas& meshdatas);
     bool loadMeshDataJson_0_2(MeshDatas& meshdatas);
@@ -192,10 +201,13 @@ protected:
 
     // for binary reading
     Data _binaryBuffer;
+    mio::mmap_source _binaryMapping;  // the file mapped, used instead of _binaryBuffer
     BundleReader _binaryReader;
     unsigned int _referenceCount;
     Reference* _references;
     bool _isBinary;
+
+    static bool _memoryMapping;
 };
 
 // end of 3d group
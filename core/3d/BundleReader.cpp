@@ -47,7 +47,7 @@ void BundleReader::init(char* buffer, ssize_t length)
     _length   = length;
 }
 
-ssize_t BundleReader::read(void* ptr, ssize_t size, ssize_t count)
+ssize_t BundleReader::readOutOfRange(void* ptr, ssize_t size, ssize_t count)
 {
     if (!_buffer || eof())
     {
@@ -27,6 +27,7 @@
 #ifndef __AX_BUNDLE_READER_H__
 #define __AX_BUNDLE_READER_H__
 
+#include <string.h>
 #include <string>
 #include <vector>
 
@@ -76,7 +77,18 @@ public:
      *
      * @return The number of elements read.
      */
-    ssize_t read(void* ptr, ssize_t size, ssize_t count);
+    ssize_t read(void* ptr, ssize_t size, ssize_t count)
+    {
+        // the common case, most reads are a few bytes in range
+        const ssize_t needLength = size * count;
+        if (_buffer && _position + needLength <= _length && _position < _length)
+        {
+            memcpy(ptr, _buffer + _position, needLength);
+            _position += needLength;
+            return count;
+        }
+        return readOutOfRange(ptr, size, count);
+    }
 
     /**
      * Reads a line from the buffer.
@@ -128,6 +140,8 @@ public:
     bool readMatrix(float* m);
 
 private:
+    ssize_t readOutOfRange(void* ptr, ssize_t size, ssize_t count);
+
     ssize_t _position;
     ssize_t _length;
     char* _buffer;
@@ -0,0 +1,497 @@
+/****************************************************************************
+ Copyright (c) 2019-present Axmol Engine contributors (see AUTHORS.md).
+
+ https://axmol.dev/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#include "3d/CullingBVH.h"
+
+#include <algorithm>
+#include <float.h>
+
+#include "3d/Frustum.h"
+
+NS_AX_BEGIN
+
+namespace
+{
+// A proxy whose bounds stay unchanged for this count of culls is merged into the tree by the next rebuild
+constexpr uint32_t SETTLE_CULLS = 30;
+// The tree is rebuilt when the settled proxies in the linear list and the stale leaves reach this count,
+// or an eighth of the tree
+constexpr size_t REBUILD_MIN_PROXIES = 32;
+// Bounds of the unused slots of a node, outside of any plane
+constexpr float EMPTY_MIN = 1e30f;
+constexpr float EMPTY_MAX = -1e30f;
+
+// Interleave the bits of 10-bit coordinates
+inline uint32_t expandBits(uint32_t v)
+{
+    v = (v * 0x00010001u) & 0xFF0000FFu;
+    v = (v * 0x00000101u) & 0x0F00F00Fu;
+    v = (v * 0x00000011u) & 0xC30C30C3u;
+    v = (v * 0x00000005u) & 0x49249249u;
+    return v;
+}
+
+inline uint32_t mortonCode(uint32_t x, uint32_t y, uint32_t z)
+{
+    return (expandBits(std::min(x, 1023u)) << 2) | (expandBits(std::min(y, 1023u)) << 1) | expandBits(std::min(z, 1023u));
+}
+
+#if defined(AX_NEON_INTRINSICS)
+inline unsigned movemask(uint32x4_t mask)
+{
+    static const uint32_t bits[4] = {1, 2, 4, 8};
+    uint32x4_t v                  = vandq_u32(mask, vld1q_u32(bits));
+    uint32x2_t s                  = vorr_u32(vget_low_u32(v), vget_high_u32(v));
+    return vget_lane_u32(s, 0) | vget_lane_u32(s, 1);
+}
+#endif
+}  // namespace
+
+struct CullingBVH::Planes
+{
+    float nx[6], ny[6], nz[6], d[6];
+    int count;
+
+    /**
+     * Test 4 boxes in SoA layout (minX, minY, minZ, maxX, maxY, maxZ, 4 floats each) against the planes in the mask.
+     * Returns the lanes outside of any plane, straddle receives the planes intersected by the box of each lane.
+     */
+    unsigned classify(const float* box, unsigned planeMask, unsigned straddle[4]) const
+    {
+        unsigned outside = 0;
+        straddle[0] = straddle[1] = straddle[2] = straddle[3] = 0;
+
+        for (int i = 0; i < count; ++i)
+        {
+            if (!(planeMask & (1u << i)))
+                continue;
+
+            // The corner with the smallest distance decides whether the box is outside, the largest one whether
+            // it's fully inside, same as Frustum::isOutOfFrustum
+            const float* nearX = nx[i] < 0 ? box + 12 : box;
+            const float* nearY = ny[i] < 0 ? box + 16 : box + 4;
+            const float* nearZ = nz[i] < 0 ? box + 20 : box + 8;
+            const float* farX  = nx[i] < 0 ? box : box + 12;
+            const float* farY  = ny[i] < 0 ? box + 4 : box + 16;
+            const float* farZ  = nz[i] < 0 ? box + 8 : box + 20;
+
+            unsigned out, cross;
+#if defined(AX_SSE_INTRINSICS)
+            const __m128 vx   = _mm_set1_ps(nx[i]);
+            const __m128 vy   = _mm_set1_ps(ny[i]);
+            const __m128 vz   = _mm_set1_ps(nz[i]);
+            const __m128 vd   = _mm_set1_ps(d[i]);
+            const __m128 zero = _mm_setzero_ps();
+
+            __m128 dn = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, _mm_load_ps(nearX)), _mm_mul_ps(vy, _mm_load_ps(nearY))),
+                                   _mm_mul_ps(vz, _mm_load_ps(nearZ)));
+            __m128 df = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, _mm_load_ps(farX)), _mm_mul_ps(vy, _mm_load_ps(farY))),
+                                   _mm_mul_ps(vz, _mm_load_ps(farZ)));
+            out   = _mm_movemask_ps(_mm_cmpgt_ps(_mm_sub_ps(dn, vd), zero));
+            cross = _mm_movemask_ps(_mm_cmpgt_ps(_mm_sub_ps(df, vd), zero));
+#elif defined(AX_NEON_INTRINSICS)
+            const float32x4_t vd   = vdupq_n_f32(d[i]);
+            const float32x4_t zero = vdupq_n_f32(0.0f);
+
+            float32x4_t dn = vmlaq_n_f32(
+                vmlaq_n_f32(vmulq_n_f32(vld1q_f32(nearX), nx[i]), vld1q_f32(nearY), ny[i]), vld1q_f32(nearZ), nz[i]);
+            float32x4_t df = vmlaq_n_f32(
+                vmlaq_n_f32(vmulq_n_f32(vld1q_f32(farX), nx[i]), vld1q_f32(farY), ny[i]), vld1q_f32(farZ), nz[i]);
+            out   = movemask(vcgtq_f32(vsubq_f32(dn, vd), zero));
+            cross = movemask(vcgtq_f32(vsubq_f32(df, vd), zero));
+#else
+            out = cross = 0;
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                if (nx[i] * nearX[lane] + ny[i] * nearY[lane] + nz[i] * nearZ[lane] - d[i] > 0)
+                    out |= 1u << lane;
+                if (nx[i] * farX[lane] + ny[i] * farY[lane] + nz[i] * farZ[lane] - d[i] > 0)
+                    cross |= 1u << lane;
+            }
+#endif
+            outside |= out;
+            if (outside == 0xF)
+                break;
+
+            cross &= ~out;
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                if (cross & (1u << lane))
+                    straddle[lane] |= 1u << i;
+            }
+        }
+        return outside;
+    }
+};
+
+CullingBVH* CullingBVH::create()
+{
+    auto bvh = new CullingBVH();
+    bvh->autorelease();
+    return bvh;
+}
+
+CullingBVH::CullingBVH() {}
+
+CullingBVH::~CullingBVH() {}
+
+int CullingBVH::addBounds(const AABB& aabb)
+{
+    int proxy;
+    if (!_freeProxies.empty())
+    {
+        proxy = _freeProxies.back();
+        _freeProxies.pop_back();
+    }
+    else
+    {
+        proxy = static_cast<int>(_proxies.size());
+        _proxies.emplace_back();
+        _visibleStamps.emplace_back(0);
+    }
+
+    auto& p    = _proxies[proxy];
+    p.aabb     = aabb;
+    p.lastMove = _cullCount - SETTLE_CULLS;  // nodes are usually added at their place, merge on next rebuild
+    addDynamic(proxy);
+    _visibleStamps[proxy] = 0;
+    return proxy;
+}
+
+void CullingBVH::updateBounds(int proxy, const AABB& aabb)
+{
+    auto& p    = _proxies[proxy];
+    p.aabb     = aabb;
+    p.lastMove = _cullCount;
+    if (p.state == ProxyState::TREE)
+    {
+        // The leaf stays in the tree until the next rebuild, it's skipped by the state
+        --_treeProxyCount;
+        ++_staleLeaves;
+        addDynamic(proxy);
+    }
+}
+
+void CullingBVH::removeBounds(int proxy)
+{
+    auto& p = _proxies[proxy];
+    if (p.state == ProxyState::TREE)
+    {
+        --_treeProxyCount;
+        ++_staleLeaves;
+    }
+    else if (p.state == ProxyState::DYNAMIC)
+    {
+        removeDynamic(proxy);
+    }
+    p.state               = ProxyState::FREE;
+    _visibleStamps[proxy] = 0;
+    _freeProxies.emplace_back(proxy);
+}
+
+int CullingBVH::cull(const Frustum& frustum)
+{
+    ++_cullCount;
+    if (++_stamp == 0)
+    {
+        std::fill(_visibleStamps.begin(), _visibleStamps.end(), 0);
+        _stamp = 1;
+    }
+
+    size_t settled = 0;
+    int visible    = 0;
+    if (frustum.isInitialized())
+    {
+        Planes planes;
+        planes.count = frustum.getPlaneCount();
+        for (int i = 0; i < planes.count; ++i)
+        {
+            const auto& plane = frustum.getPlane(i);
+            planes.nx[i]      = plane.getNormal().x;
+            planes.ny[i]      = plane.getNormal().y;
+            planes.nz[i]      = plane.getNormal().z;
+            planes.d[i]       = plane.getDist();
+        }
+
+        visible = cullTree(planes) + cullDynamic(planes, settled);
+    }
+    else
+    {
+        // Nothing can be culled without the frustum
+        for (size_t i = 0, count = _proxies.size(); i < count; ++i)
+        {
+            if (_proxies[i].state != ProxyState::FREE)
+            {
+                _visibleStamps[i] = _stamp;
+                ++visible;
+            }
+        }
+    }
+
+    // The visible stamps are kept by proxy, so the result is still valid after the rebuild
+    if (settled + _staleLeaves >= std::max(REBUILD_MIN_PROXIES, _treeProxyCount / 8))
+        rebuildTree(false);
+
+    return visible;
+}
+
+void CullingBVH::rebuild()
+{
+    rebuildTree(true);
+}
+
+void CullingBVH::rebuildTree(bool all)
+{
+    _buildItems.clear();
+    AABB treeBounds;
+    treeBounds.reset();
+    for (int id = 0, count = static_cast<int>(_proxies.size()); id < count; ++id)
+    {
+        auto& p = _proxies[id];
+        // empty bounds are always visible, they stay in the linear list
+        if (p.state == ProxyState::DYNAMIC && !p.aabb.isEmpty() && (all || _cullCount - p.lastMove >= SETTLE_CULLS))
+        {
+            removeDynamic(id);
+            p.state = ProxyState::TREE;
+        }
+        if (p.state == ProxyState::TREE)
+        {
+            _buildItems.push_back({0, id});
+            treeBounds.updateMinMax(&p.aabb._min, 1);
+            treeBounds.updateMinMax(&p.aabb._max, 1);
+        }
+    }
+
+    // Sort the proxies along the Morton curve of their treeBounds, so the ranges split by count are compact
+    const Vec3 scale(1023.0f / std::max(treeBounds._max.x - treeBounds._min.x, FLT_EPSILON),
+                     1023.0f / std::max(treeBounds._max.y - treeBounds._min.y, FLT_EPSILON),
+                     1023.0f / std::max(treeBounds._max.z - treeBounds._min.z, FLT_EPSILON));
+    for (auto& item : _buildItems)
+    {
+        const auto& aabb = _proxies[item.proxy].aabb;
+        const Vec3 center((aabb._min + aabb._max) * 0.5f);
+        item.code = mortonCode(static_cast<uint32_t>((center.x - treeBounds._min.x) * scale.x),
+                               static_cast<uint32_t>((center.y - treeBounds._min.y) * scale.y),
+                               static_cast<uint32_t>((center.z - treeBounds._min.z) * scale.z));
+    }
+    std::sort(_buildItems.begin(), _buildItems.end(),
+              [](const BuildItem& a, const BuildItem& b) { return a.code < b.code; });
+
+    _treeProxyCount = _buildItems.size();
+    _staleLeaves    = 0;
+    _nodes.clear();
+    _leafProxies.clear();
+    if (!_buildItems.empty())
+    {
+        _nodes.reserve(_buildItems.size() / 2 + 1);
+        AABB bounds;
+        buildNode(0, static_cast<int>(_buildItems.size()), bounds);
+
+        _leafProxies.reserve(_buildItems.size());
+        for (const auto& item : _buildItems)
+            _leafProxies.emplace_back(item.proxy);
+    }
+}
+
+int CullingBVH::buildNode(int first, int last, AABB& bounds)
+{
+    const int node = static_cast<int>(_nodes.size());
+    _nodes.emplace_back();
+
+    AABB empty(Vec3(EMPTY_MIN, EMPTY_MIN, EMPTY_MIN), Vec3(EMPTY_MAX, EMPTY_MAX, EMPTY_MAX));
+    for (int slot = 0; slot < 4; ++slot)
+        setChild(node, slot, 0, first, 0, empty);
+
+    bounds.reset();
+    const int count = last - first;
+    if (count <= 4)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            const int proxy = _buildItems[first + i].proxy;
+            setChild(node, i, ~proxy, first + i, 1, _proxies[proxy].aabb);
+            bounds.merge(_proxies[proxy].aabb);
+        }
+        return node;
+    }
+
+    // The children take a quarter of the sorted range each
+    const int ranges[5] = {first, first + count / 4, first + count / 2, first + count * 3 / 4, last};
+    for (int slot = 0; slot < 4; ++slot)
+    {
+        const int begin = ranges[slot];
+        const int end   = ranges[slot + 1];
+        AABB childBounds;
+        int child;
+        if (end - begin == 1)
+        {
+            child       = ~_buildItems[begin].proxy;
+            childBounds = _proxies[_buildItems[begin].proxy].aabb;
+        }
+        else
+        {
+            child = buildNode(begin, end, childBounds);
+        }
+        setChild(node, slot, child, begin, end - begin, childBounds);
+        bounds.merge(childBounds);
+    }
+    return node;
+}
+
+void CullingBVH::setChild(int node, int slot, int child, int first, int count, const AABB& bounds)
+{
+    auto& n       = _nodes[node];
+    n.minX[slot]  = bounds._min.x;
+    n.minY[slot]  = bounds._min.y;
+    n.minZ[slot]  = bounds._min.z;
+    n.maxX[slot]  = bounds._max.x;
+    n.maxY[slot]  = bounds._max.y;
+    n.maxZ[slot]  = bounds._max.z;
+    n.child[slot] = child;
+    n.first[slot] = first;
+    n.count[slot] = count;
+}
+
+int CullingBVH::cullTree(const Planes& planes)
+{
+    if (_nodes.empty())
+        return 0;
+
+    struct Entry
+    {
+        int node;
+        unsigned planeMask;  // the planes intersected by the parent, the others are passed already
+    };
+    // The tree is balanced by the splits, 3 entries per level and the last 4 children
+    Entry stack[128];
+    int top      = 0;
+    stack[top++] = {0, (1u << planes.count) - 1};
+
+    int visible = 0;
+    while (top > 0)
+    {
+        const Entry entry = stack[--top];
+        const Node4& node = _nodes[entry.node];
+
+        unsigned straddle[4];
+        const unsigned outside = planes.classify(node.minX, entry.planeMask, straddle);
+        for (int slot = 0; slot < 4; ++slot)
+        {
+            if ((outside & (1u << slot)) || node.count[slot] == 0)
+                continue;
+
+            const int child = node.child[slot];
+            if (child < 0)
+            {
+                if (_proxies[~child].state == ProxyState::TREE)
+                {
+                    _visibleStamps[~child] = _stamp;
+                    ++visible;
+                }
+            }
+            else if (straddle[slot] == 0)
+            {
+                visible += acceptRange(node.first[slot], node.count[slot]);
+            }
+            else
+            {
+                stack[top++] = {child, straddle[slot]};
+            }
+        }
+    }
+    return visible;
+}
+
+int CullingBVH::cullDynamic(const Planes& planes, size_t& settled)
+{
+    const unsigned allPlanes = (1u << planes.count) - 1;
+
+    int visible = 0;
+    alignas(16) float box[24] = {};
+    for (size_t i = 0, count = _dynamic.size(); i < count; i += 4)
+    {
+        const int lanes = static_cast<int>(std::min<size_t>(4, count - i));
+        for (int lane = 0; lane < lanes; ++lane)
+        {
+            const auto& aabb = _proxies[_dynamic[i + lane]].aabb;
+            box[lane]        = aabb._min.x;
+            box[lane + 4]    = aabb._min.y;
+            box[lane + 8]    = aabb._min.z;
+            box[lane + 12]   = aabb._max.x;
+            box[lane + 16]   = aabb._max.y;
+            box[lane + 20]   = aabb._max.z;
+        }
+
+        unsigned straddle[4];
+        const unsigned outside = planes.classify(box, allPlanes, straddle);
+        for (int lane = 0; lane < lanes; ++lane)
+        {
+            const int proxy  = _dynamic[i + lane];
+            const auto& p    = _proxies[proxy];
+            const bool empty = p.aabb.isEmpty();
+            if (empty || !(outside & (1u << lane)))
+            {
+                _visibleStamps[proxy] = _stamp;
+                ++visible;
+            }
+            if (!empty && _cullCount - p.lastMove >= SETTLE_CULLS)
+                ++settled;
+        }
+    }
+    return visible;
+}
+
+int CullingBVH::acceptRange(int first, int count)
+{
+    int visible = 0;
+    for (int i = first, last = first + count; i < last; ++i)
+    {
+        const int proxy = _leafProxies[i];
+        if (_proxies[proxy].state == ProxyState::TREE)
+        {
+            _visibleStamps[proxy] = _stamp;
+            ++visible;
+        }
+    }
+    return visible;
+}
+
+void CullingBVH::addDynamic(int proxy)
+{
+    auto& p        = _proxies[proxy];
+    p.state        = ProxyState::DYNAMIC;
+    p.dynamicIndex = static_cast<int>(_dynamic.size());
+    _dynamic.emplace_back(proxy);
+}
+
+void CullingBVH::removeDynamic(int proxy)
+{
+    auto& p                     = _proxies[proxy];
+    const int last              = _dynamic.back();
+    _dynamic[p.dynamicIndex]    = last;
+    _proxies[last].dynamicIndex = p.dynamicIndex;
+    _dynamic.pop_back();
+    p.dynamicIndex = -1;
+}
+
+NS_AX_END
@@ -0,0 +1,141 @@
+/****************************************************************************
+ Copyright (c) 2019-present Axmol Engine contributors (see AUTHORS.md).
+
+ https://axmol.dev/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#pragma once
+
+#include <vector>
+
+#include "base/Object.h"
+#include "3d/AABB.h"
+
+NS_AX_BEGIN
+
+class Frustum;
+
+/**
+ * @addtogroup _3d
+ * @{
+ */
+
+/**
+ * @brief Bounding volume hierarchy which culls the world bounds of many 3D nodes against a frustum at once.
+ *
+ * The settled bounds are kept in a 4-wide tree, a subtree outside of the frustum is rejected and a subtree fully
+ * inside is accepted with a single test. Bounds updated recently are kept in a linear list until they stay unchanged
+ * for a while, then they are merged into the tree by a rebuild, so moving nodes don't degrade the tree.
+ */
+class AX_DLL CullingBVH : public Object
+{
+public:
+    static CullingBVH* create();
+
+    /** Add the world bounds of a node, returns the proxy id used by the other methods */
+    int addBounds(const AABB& aabb);
+
+    /** Update the world bounds of a proxy, it's tested linearly until it settles again */
+    void updateBounds(int proxy, const AABB& aabb);
+
+    /** Remove a proxy, the id may be returned by a later addBounds */
+    void removeBounds(int proxy);
+
+    /**
+     * Cull all proxies against the frustum, the result is kept until the next call.
+     * @return The count of the visible proxies.
+     */
+    int cull(const Frustum& frustum);
+
+    /** Whether the proxy is visible in the frustum of the last cull, empty bounds are always visible */
+    bool isVisible(int proxy) const { return _visibleStamps[proxy] == _stamp; }
+
+    /** Rebuild the tree from all proxies now, usually called after the static nodes of a level were added */
+    void rebuild();
+
+    /** The count of the proxies in the tree, and in the linear list of the recently updated proxies */
+    size_t getTreeProxyCount() const { return _treeProxyCount; }
+    size_t getDynamicProxyCount() const { return _dynamic.size(); }
+
+    CullingBVH();
+    virtual ~CullingBVH();
+
+protected:
+    struct Planes;
+
+    enum class ProxyState : uint8_t
+    {
+        FREE,
+        TREE,
+        DYNAMIC,
+    };
+
+    struct Proxy
+    {
+        AABB aabb;
+        ProxyState state  = ProxyState::FREE;
+        int dynamicIndex  = -1;
+        uint32_t lastMove = 0;  // cull count when the bounds were updated
+    };
+
+    // The bounds of 4 children in SoA layout, a child >= 0 is a node, ~proxy is a leaf
+    struct alignas(16) Node4
+    {
+        float minX[4], minY[4], minZ[4];
+        float maxX[4], maxY[4], maxZ[4];
+        int child[4];
+        int first[4];  // the range of the child in _leafProxies
+        int count[4];
+    };
+
+    struct BuildItem
+    {
+        uint32_t code;  // Morton code of the center
+        int proxy;
+    };
+
+    void rebuildTree(bool all);
+    int buildNode(int first, int last, AABB& bounds);
+    void setChild(int node, int slot, int child, int first, int count, const AABB& bounds);
+    int cullTree(const Planes& planes);
+    int cullDynamic(const Planes& planes, size_t& settled);
+    int acceptRange(int first, int count);
+    void addDynamic(int proxy);
+    void removeDynamic(int proxy);
+
+    std::vector<Proxy> _proxies;
+    std::vector<uint32_t> _visibleStamps;
+    std::vector<int> _freeProxies;
+    std::vector<int> _dynamic;
+
+    std::vector<Node4> _nodes;
+    std::vector<int> _leafProxies;  // proxies ordered by the tree, each node covers a contiguous range
+    std::vector<BuildItem> _buildItems;
+    size_t _treeProxyCount = 0;
+    size_t _staleLeaves    = 0;  // leaves of the proxies moved out of the tree or removed
+
+    uint32_t _stamp     = 1;
+    uint32_t _cullCount = 0;
+};
+
+// end of 3d group
+/// @}
+
+NS_AX_END
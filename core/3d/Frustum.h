@@ -73,6 +73,17 @@ public:
     void setClipZ(bool clipZ) { _clipZ = clipZ; }
     bool isClipZ() { return _clipZ; }
 
+    /**
+     * get the clip planes, left, right, top, bottom, and near, far if z clip is enabled
+     */
+    int getPlaneCount() const { return _clipZ ? 6 : 4; }
+    const Plane& getPlane(int index) const { return _plane[index]; }
+
+    /**
+     * whether the frustum is initialized from a camera, nothing is out of an uninitialized frustum
+     */
+    bool isInitialized() const { return _initialized; }
+
 protected:
     /**
      * create clip plane
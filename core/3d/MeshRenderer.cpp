@@ -31,12 +31,16 @@
 #include "3d/MeshMaterial.h"
 #include "3d/AttachNode.h"
 #include "3d/Mesh.h"
+#include "3d/CullingBVH.h"
 
 #include "base/Director.h"
+#include "base/EventDispatcher.h"
+#include "base/EventListenerCustom.h"
 #include "base/UTF8.h"
 #include "base/Utils.h"
 #include "2d/Light.h"
 #include "2d/Camera.h"
+#include "2d/Scene.h"
 #include "base/Macros.h"
 #include "platform/PlatformMacros.h"
 #include "platform/FileUtils.h"
@@ -50,6 +54,15 @@ NS_AX_BEGIN
 
 static MeshMaterial* getMeshRendererMaterialForAttribs(MeshVertexData* meshVertexData, bool usesLight);
 
+namespace
+{
+// The running skinned mesh renderers, their bone matrices are refreshed in one parallel batch before draw
+std::vector<MeshRenderer*> s_skinnedRenderers;
+EventListenerCustom* s_skinningListener = nullptr;
+std::vector<Skeleton3D*> s_skinningSkeletons;
+std::vector<MeshSkin*> s_skinningSkins;
+}  // namespace
+
 MeshRenderer* MeshRenderer::create()
 {
     auto mesh = new MeshRenderer();
@@ -278,6 +291,8 @@ MeshRenderer::MeshRenderer()
 
 MeshRenderer::~MeshRenderer()
 {
+    setSkinningRegistered(false);
+    setCullingBVH(nullptr);
     _meshes.clear();
     _meshVertexDatas.clear();
     AX_SAFE_RELEASE_NULL(_skeleton);
@@ -819,12 +834,14 @@ void MeshRenderer::visit(ax::Renderer* renderer, const ax::Mat4& parentTransform
     uint32_t flags = processParentFlags(parentTransform, parentFlags);
     flags |= FLAGS_RENDER_AS_3D;
 
+    bool visibleByCamera = isVisitableByVisitingCamera() && !isCulledByScene(flags);
+    if (!visibleByCamera && _children.empty())
+        return;
+
     //
     _director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
     _director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW, _modelViewTransform);
 
-    bool visibleByCamera = isVisitableByVisitingCamera();
-
     int i = 0;
 
     if (!_children.empty())
@@ -866,7 +883,13 @@ void MeshRenderer::draw(Renderer* renderer, const Mat4& transform, uint32_t flag
 #endif
 
     if (_skeleton)
-        _skeleton->updateBoneMatrix();
+    {
+        if (!_skinningUpdated)
+            _skeleton->updateBoneMatrix();
+        if (!_skinningRegistered && _running)
+            setSkinningRegistered(true);
+    }
+    _skinningUpdated = false;
 
     Color4F color(getDisplayedColor());
     color.a = getDisplayedOpacity() / 255.0f;
@@ -898,6 +921,113 @@ void MeshRenderer::draw(Renderer* renderer, const Mat4& transform, uint32_t flag
     }
 }
 
+void MeshRenderer::onExit()
+{
+    setSkinningRegistered(false);
+    setCullingBVH(nullptr);
+    Node::onExit();
+}
+
+bool MeshRenderer::isCulledByScene(uint32_t flags)
+{
+    auto bvh = Scene::getVisitingCullingBVH();
+    if (bvh != _cullingBVH)
+    {
+        setCullingBVH(bvh);
+        if (!bvh)
+            return false;
+    }
+    else if (!bvh)
+    {
+        return false;
+    }
+    else if ((flags & FLAGS_TRANSFORM_DIRTY) || _aabbDirty)
+    {
+        bvh->updateBounds(_cullingProxy, getAABB());
+    }
+    else
+    {
+        return !bvh->isVisible(_cullingProxy);
+    }
+
+    // The bounds changed after the scene culled, test them directly this time
+    const auto& aabb = getAABB();
+    return !aabb.isEmpty() && !Camera::getVisitingCamera()->isVisibleInFrustum(&aabb);
+}
+
+void MeshRenderer::setCullingBVH(CullingBVH* bvh)
+{
+    if (_cullingBVH == bvh)
+        return;
+
+    if (_cullingBVH)
+    {
+        _cullingBVH->removeBounds(_cullingProxy);
+        _cullingBVH->release();
+        _cullingProxy = -1;
+    }
+    _cullingBVH = bvh;
+    if (_cullingBVH)
+    {
+        _cullingBVH->retain();
+        _cullingProxy = _cullingBVH->addBounds(getAABB());
+    }
+}
+
+void MeshRenderer::setSkinningRegistered(bool registered)
+{
+    if (_skinningRegistered == registered)
+        return;
+
+    _skinningRegistered = registered;
+    _skinningUpdated    = false;
+
+    auto eventDispatcher = Director::getInstance()->getEventDispatcher();
+    if (registered)
+    {
+        s_skinnedRenderers.emplace_back(this);
+        if (!s_skinningListener)
+            s_skinningListener = eventDispatcher->addCustomEventListener(
+                Director::EVENT_BEFORE_DRAW, [](EventCustom*) { MeshRenderer::updateRunningSkins(); });
+    }
+    else
+    {
+        s_skinnedRenderers.erase(std::find(s_skinnedRenderers.begin(), s_skinnedRenderers.end(), this));
+        if (s_skinnedRenderers.empty() && s_skinningListener)
+        {
+            eventDispatcher->removeEventListener(s_skinningListener);
+            s_skinningListener = nullptr;
+        }
+    }
+}
+
+void MeshRenderer::updateRunningSkins()
+{
+    s_skinningSkeletons.clear();
+    s_skinningSkins.clear();
+    for (auto renderer : s_skinnedRenderers)
+    {
+        // hidden renderers are refreshed by draw if they show up again
+        renderer->_skinningUpdated = renderer->_skeleton && renderer->isVisible();
+        if (!renderer->_skinningUpdated)
+            continue;
+
+        s_skinningSkeletons.emplace_back(renderer->_skeleton);
+        const auto firstSkin = s_skinningSkins.size();
+        for (auto&& mesh : renderer->_meshes)
+        {
+            auto skin = mesh->getSkin();
+            if (skin && std::find(s_skinningSkins.begin() + firstSkin, s_skinningSkins.end(), skin) ==
+                            s_skinningSkins.end())
+                s_skinningSkins.emplace_back(skin);
+        }
+    }
+
+    // the palettes read the bone matrices, so the skeletons go first
+    Skeleton3D::updateBoneMatrices(s_skinningSkeletons.data(), s_skinningSkeletons.size());
+    MeshSkin::updateMatrixPalettes(s_skinningSkins.data(), s_skinningSkins.size());
+}
+
 bool MeshRenderer::setProgramState(backend::ProgramState* programState, bool ownPS /* = false*/)
 {
     if (Node::setProgramState(programState, ownPS))
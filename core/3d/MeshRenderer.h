@@ -51,6 +51,7 @@ class Mesh;
 class Texture2D;
 class MeshSkin;
 class AttachNode;
+class CullingBVH;
 struct NodeData;
 /** @brief MeshRenderer: A mesh can be loaded from model files, .obj, .c3t, .c3b
  *and a mesh renderer renders a list of these loaded meshes with specified materials
@@ -188,6 +189,8 @@ public:
     /** render all meshes within this mesh renderer */
     virtual void draw(Renderer* renderer, const Mat4& transform, uint32_t flags) override;
 
+    virtual void onExit() override;
+
     /** Adds a new material to this mesh renderer.
      The Material will be applied to all the meshes that belong to the mesh renderer.
      It will internally call `setMaterial(material,-1)`
@@ -306,6 +309,14 @@ protected:
     */
     void setModelTexture(std::string_view modelPath, std::string_view texPath);
 
+    /** refreshes the skeletons and matrix palettes of the running skinned mesh renderers in parallel, before draw */
+    static void updateRunningSkins();
+    void setSkinningRegistered(bool registered);
+
+    /** whether the bounds are outside of the frustum, culled by the bounding volume hierarchy of the scene */
+    bool isCulledByScene(uint32_t flags);
+    void setCullingBVH(CullingBVH* bvh);
+
     Skeleton3D* _skeleton;
 
     Vector<MeshVertexData*> _meshVertexDatas;
@@ -326,6 +337,10 @@ protected:
     bool _usingAutogeneratedGLProgram;
     bool _transparentMaterialHint; // Generate transparent materials when building from files
     unsigned short _meshTextureHint; // Whether model file has texture config
+    bool _skinningRegistered = false; // Whether in the batch of running skinned mesh renderers
+    bool _skinningUpdated    = false; // Whether the batch refreshed the skeleton this frame
+    CullingBVH* _cullingBVH  = nullptr; // The scene culling which the bounds registered to
+    int _cullingProxy        = -1;
 
     struct AsyncLoadParam
     {
@@ -26,10 +26,12 @@
 #include "3d/MeshSkin.h"
 #include "3d/Bundle3D.h"
 #include "3d/Skeleton3D.h"
+#include "base/Director.h"
+#include "base/JobSystem.h"
 
 NS_AX_BEGIN
 
-static int PALETTE_ROWS = 3;
+static const int PALETTE_ROWS = 3;
 
 MeshSkin::MeshSkin() : _rootBone(nullptr), _skeleton(nullptr) {}
 
@@ -100,18 +102,34 @@ int MeshSkin::getBoneIndex(Bone3D* bone) const
 // compute matrix palette used by gpu skin
 Vec4* MeshSkin::getMatrixPalette()
 {
-    _matrixPalette.resize(_skinBones.size() * PALETTE_ROWS);
-    int i = 0, paletteIndex = 0;
-    static Mat4 t;
-    for (auto&& it : _skinBones)
+    const size_t paletteSize = _skinBones.size() * PALETTE_ROWS;
+    const auto updateCount   = _skeleton ? _skeleton->getUpdateCount() : 0;
+    if (_matrixPalette.size() == paletteSize && _paletteUpdateCount == updateCount && updateCount != 0)
+        return _matrixPalette.data();
+
+    _matrixPalette.resize(paletteSize);
+    _paletteUpdateCount = updateCount;
+
+    // The palette rows are the rows of the 4x3 joint matrix, which are the columns of its transpose,
+    // so both steps run on the SIMD matrix kernels and the 3 columns are copied out at once.
+    Mat4 joint;
+    auto palette = _matrixPalette.data();
+    for (ssize_t i = 0, size = _skinBones.size(); i < size; ++i)
     {
-        Mat4::multiply(it->getWorldMat(), _invBindPoses[i++], &t);
-        _matrixPalette[paletteIndex++].set(t.m[0], t.m[4], t.m[8], t.m[12]);
-        _matrixPalette[paletteIndex++].set(t.m[1], t.m[5], t.m[9], t.m[13]);
-        _matrixPalette[paletteIndex++].set(t.m[2], t.m[6], t.m[10], t.m[14]);
+        Mat4::multiply(_skinBones.at(i)->getWorldMat(), _invBindPoses[i], &joint);
+        joint.transpose();
+        memcpy(palette + i * PALETTE_ROWS, joint.m, sizeof(Vec4) * PALETTE_ROWS);
     }
 
-    return _matrixPalette.data();
+    return palette;
+}
+
+void MeshSkin::updateMatrixPalettes(MeshSkin* const* skins, size_t count)
+{
+    Director::getInstance()->getJobSystem()->parallelFor(count, 4, [skins](size_t first, size_t last) {
+        for (; first < last; ++first)
+            skins[first]->getMatrixPalette();
+    });
 }
 
 ssize_t MeshSkin::getMatrixPaletteSize() const
@@ -70,9 +70,12 @@ public:
     /**get bone index*/
     int getBoneIndex(Bone3D* bone) const;
 
-    /**compute matrix palette used by gpu skin*/
+    /**compute matrix palette used by gpu skin, it's recomputed only if the skeleton updated since last call*/
     Vec4* getMatrixPalette();
 
+    /**compute the matrix palettes of many skins in parallel on the JobSystem, a skin may appear once only*/
+    static void updateMatrixPalettes(MeshSkin* const* skins, size_t count);
+
     /**getSkinBoneCount() * 3*/
     ssize_t getMatrixPaletteSize() const;
 
@@ -107,6 +110,7 @@ protected:
     // Each 4x3 row-wise matrix is represented as 3 Vec4's.
     // The number of Vec4's is (_skinBones.size() * 3).
     std::vector<Vec4> _matrixPalette;
+    unsigned int _paletteUpdateCount = 0;  // Skeleton3D::getUpdateCount() when the palette computed
 };
 
 // end of 3d group
@@ -24,6 +24,8 @@
  ****************************************************************************/
 
 #include "3d/Skeleton3D.h"
+#include "base/Director.h"
+#include "base/JobSystem.h"
 
 NS_AX_BEGIN
 
@@ -145,14 +147,12 @@ Bone3D* Bone3D::create(std::string_view id)
 
 void Bone3D::updateJointMatrix(Vec4* matrixPalette)
 {
-    {
-        static Mat4 t;
-        Mat4::multiply(_world, getInverseBindPose(), &t);
+    Mat4 t;
+    Mat4::multiply(_world, getInverseBindPose(), &t);
 
-        matrixPalette[0].set(t.m[0], t.m[4], t.m[8], t.m[12]);
-        matrixPalette[1].set(t.m[1], t.m[5], t.m[9], t.m[13]);
-        matrixPalette[2].set(t.m[2], t.m[6], t.m[10], t.m[14]);
-    }
+    matrixPalette[0].set(t.m[0], t.m[4], t.m[8], t.m[12]);
+    matrixPalette[1].set(t.m[1], t.m[5], t.m[9], t.m[13]);
+    matrixPalette[2].set(t.m[2], t.m[6], t.m[10], t.m[14]);
 }
 
 Bone3D* Bone3D::getParentBone()
@@ -170,19 +170,38 @@ Bone3D* Bone3D::getChildBoneByIndex(int index) const
 void Bone3D::addChildBone(Bone3D* bone)
 {
     if (_children.find(bone) == _children.end())
+    {
         _children.pushBack(bone);
+        setHierarchyDirty();
+    }
 }
 void Bone3D::removeChildBoneByIndex(int index)
 {
     _children.erase(index);
+    setHierarchyDirty();
 }
 void Bone3D::removeChildBone(Bone3D* bone)
 {
     _children.eraseObject(bone);
+    setHierarchyDirty();
 }
 void Bone3D::removeAllChildBone()
 {
     _children.clear();
+    setHierarchyDirty();
+}
+
+void Bone3D::setHierarchyDirty()
+{
+    // the bones added by addChildBone may not know the skeleton, it's found through the parents
+    for (auto bone = this; bone; bone = bone->_parent)
+    {
+        if (bone->_skeleton)
+        {
+            bone->_skeleton->_hierarchyDirty = true;
+            return;
+        }
+    }
 }
 
 Bone3D::Bone3D(std::string_view id) : _name(id), _parent(nullptr), _worldDirty(true) {}
@@ -315,22 +334,68 @@ int Skeleton3D::getBoneIndex(Bone3D* bone) const
 // refresh bone world matrix
 void Skeleton3D::updateBoneMatrix()
 {
-    for (const auto& it : _rootBones)
+    if (_hierarchyDirty)
+        buildHierarchy();
+
+    // the parent world matrix is always resolved before its children read it
+    for (size_t i = 0, count = _hierarchy.size(); i < count; ++i)
     {
-        it->setWorldMatDirty(true);
-        it->updateWorldMat();
+        auto bone = _hierarchy[i];
+        bone->updateLocalMat();
+
+        const int parent = _parentIndices[i];
+        if (parent >= 0)
+            Mat4::multiply(_hierarchy[parent]->_world, bone->_local, &bone->_world);
+        else
+            bone->_world = bone->_local;
+        bone->_worldDirty = false;
     }
+
+    ++_updateCount;
+}
+
+void Skeleton3D::updateBoneMatrices(Skeleton3D* const* skeletons, size_t count)
+{
+    // a skeleton of a character has tens of bones, batch a few per range to amortize the dispatch
+    Director::getInstance()->getJobSystem()->parallelFor(count, 4, [skeletons](size_t first, size_t last) {
+        for (; first < last; ++first)
+            skeletons[first]->updateBoneMatrix();
+    });
+}
+
+void Skeleton3D::buildHierarchy()
+{
+    _hierarchy.clear();
+    _parentIndices.clear();
+    for (auto&& it : _rootBones)
+        flattenBone(it, -1);
+
+    _hierarchyDirty = false;
+}
+
+void Skeleton3D::flattenBone(Bone3D* bone, int parentIndex)
+{
+    const int index = static_cast<int>(_hierarchy.size());
+    _hierarchy.emplace_back(bone);
+    _parentIndices.emplace_back(parentIndex);
+    for (auto&& it : bone->_children)
+        flattenBone(it, index);
 }
 
 void Skeleton3D::removeAllBones()
 {
+    for (auto&& it : _bones)
+        it->_skeleton = nullptr;
     _bones.clear();
     _rootBones.clear();
+    _hierarchyDirty = true;
 }
 
 void Skeleton3D::addBone(Bone3D* bone)
 {
     _bones.pushBack(bone);
+    bone->_skeleton = this;
+    _hierarchyDirty = true;
 }
 
 Bone3D* Skeleton3D::createBone3D(const NodeData& nodedata)
@@ -343,7 +408,9 @@ Bone3D* Skeleton3D::createBone3D(const NodeData& nodedata)
         child->_parent = bone;
     }
     _bones.pushBack(bone);
-    bone->_oriPose = nodedata.transform;
+    bone->_skeleton = this;
+    bone->_oriPose  = nodedata.transform;
+    _hierarchyDirty = true;
     return bone;
 }
 
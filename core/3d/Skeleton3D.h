@@ -32,6 +32,8 @@
 
 NS_AX_BEGIN
 
+class Skeleton3D;
+
 /**
  * @addtogroup _3d
  * @{
@@ -154,6 +156,9 @@ protected:
     /**set world matrix dirty flag*/
     void setWorldMatDirty(bool dirty = true);
 
+    /**mark the flattened hierarchy of the skeleton owning the bone tree dirty*/
+    void setHierarchyDirty();
+
     std::string _name;  // bone name
     /**
      * The Mat4 representation of the Joint's bind pose.
@@ -166,6 +171,8 @@ protected:
 
     Vector<Bone3D*> _children;
 
+    Skeleton3D* _skeleton = nullptr;  // owning skeleton, weak reference
+
     bool _worldDirty;
     Mat4 _world;
     Mat4 _local;
@@ -179,6 +186,8 @@ protected:
  */
 class AX_DLL Skeleton3D : public Object
 {
+    friend class Bone3D;
+
 public:
     /**
      * @lua NA
@@ -202,6 +211,15 @@ public:
     /**refresh bone world matrix*/
     void updateBoneMatrix();
 
+    /**
+     * refresh the bone world matrices of many skeletons, the skeletons are updated in parallel on the JobSystem.
+     * A bone must not be shared by two of the skeletons.
+     */
+    static void updateBoneMatrices(Skeleton3D* const* skeletons, size_t count);
+
+    /**get the number of updateBoneMatrix calls, data derived from the bone world matrices is stale if it changed*/
+    unsigned int getUpdateCount() const { return _updateCount; }
+
     Skeleton3D();
 
     ~Skeleton3D();
@@ -216,9 +234,20 @@ public:
     Bone3D* createBone3D(const NodeData& nodedata);
 
 protected:
+    /** flatten the bone trees, so that the world matrices are resolved in one pass */
+    void buildHierarchy();
+    void flattenBone(Bone3D* bone, int parentIndex);
+
     Vector<Bone3D*> _bones;  // bones
 
     Vector<Bone3D*> _rootBones;
+
+    // the bones of the trees in depth-first order, a parent always precedes its children
+    std::vector<Bone3D*> _hierarchy;
+    // index in _hierarchy of the parent of each bone, -1 for the root bones
+    std::vector<int> _parentIndices;
+    bool _hierarchyDirty      = true;
+    unsigned int _updateCount = 0;
 };
 
 // end of 3d group
@@ -29,6 +29,7 @@ THE SOFTWARE.
 USING_NS_AX;
 #include <stdlib.h>
 #include <float.h>
+#include <algorithm>
 #include <set>
 #include <stddef.h>  // offsetof
 #include "renderer/Renderer.h"
@@ -37,8 +38,8 @@ USING_NS_AX;
 #include "renderer/backend/Program.h"
 #include "renderer/backend/Buffer.h"
 #include "base/Director.h"
+#include "base/JobSystem.h"
 #include "base/Types.h"
-#include "base/axstd.h"
 #include "base/EventType.h"
 #include "2d/Camera.h"
 #include "platform/Image.h"
@@ -53,6 +54,20 @@ namespace
 static unsigned char ax_2x2_white_image[] = {
     // RGBA8888
     0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+// the height is sampled from the first channel of each pixel
+static int getHeightMapStride(backend::PixelFormat format)
+{
+    switch (format)
+    {
+    case backend::PixelFormat::BGRA8:
+        return 4;
+    case backend::PixelFormat::RGB8:
+        return 3;
+    default:
+        return 1;
+    }
+}
 }  // namespace
 
 Terrain* Terrain::create(TerrainData& parameter, CrackFixedType fixedType)
@@ -180,6 +195,7 @@ void Terrain::draw(ax::Renderer* renderer, const ax::Mat4& transform, uint32_t f
         auto m = camera->getNodeToWorldTransform();
         // set lod
         setChunksLOD(Vec3(m.m[12], m.m[13], m.m[14]));
+        updateStreaming(Vec3(m.m[12], m.m[13], m.m[14]));
     }
 
     if (_isCameraViewChanged)
@@ -212,18 +228,68 @@ bool Terrain::initHeightMap(std::string_view heightMap)
     {
         int chunk_amount_y = _imageHeight / _chunkSize.height;
         int chunk_amount_x = _imageWidth / _chunkSize.width;
-        loadVertices();
-        calculateNormal();
+
+        // keep the heights only, the chunk meshes are generated from them on the worker threads
+        auto field             = std::make_shared<HeightField>();
+        field->_width          = _imageWidth;
+        field->_height         = _imageHeight;
+        field->_mapHeight      = _terrainData._mapHeight;
+        field->_mapScale       = _terrainData._mapScale;
+        field->_chunkSize      = _chunkSize;
+        field->_crackFixedType = _crackFixedType;
+        field->_skirtHeight    = _skirtRatio * _terrainData._mapScale * 8;
+        field->_samples.resize(_imageWidth * _imageHeight);
+        int stride = getHeightMapStride(_heightMapImage->getPixelFormat());
+        for (size_t i = 0, size = field->_samples.size(); i < size; ++i)
+        {
+            field->_samples[i] = _data[i * stride];
+        }
+        auto minmax  = std::minmax_element(field->_samples.begin(), field->_samples.end());
+        _minHeight   = field->getHeight((int)(minmax.first - field->_samples.begin()) % _imageWidth,
+                                        (int)(minmax.first - field->_samples.begin()) / _imageWidth);
+        _maxHeight   = field->getHeight((int)(minmax.second - field->_samples.begin()) % _imageWidth,
+                                        (int)(minmax.second - field->_samples.begin()) / _imageWidth);
+        _heightField = field;
+
+        // the skirts are appended after the (w + 1) * (h + 1) vertices of the chunk
+        _skirtVerticesOffset[0] = (int)((_chunkSize.width + 1) * (_chunkSize.height + 1));
+        _skirtVerticesOffset[1] = _skirtVerticesOffset[0] + (int)_chunkSize.height + 1;
+        _skirtVerticesOffset[2] = _skirtVerticesOffset[1] + (int)_chunkSize.width + 1;
+        _skirtVerticesOffset[3] = _skirtVerticesOffset[2] + (int)_chunkSize.height + 1;
+
         memset(_chunkesArray, 0, sizeof(_chunkesArray));
+        _streamingToken     = std::make_shared<int>(0);
+        _streamingDistance  = _terrainData._streamingDistance;
+        _chunkCount         = chunk_amount_x * chunk_amount_y;
+        _residentChunkCount = 0;
 
         for (int m = 0; m < chunk_amount_y; m++)
         {
             for (int n = 0; n < chunk_amount_x; n++)
             {
-                _chunkesArray[m][n]        = new Chunk(this);
-                _chunkesArray[m][n]->_size = _chunkSize;
-                _chunkesArray[m][n]->generate(_imageWidth, _imageHeight, m, n, _data);
+                auto chunk   = new Chunk(this);
+                chunk->_size = _chunkSize;
+                chunk->_posY = m;
+                chunk->_posX = n;
+                chunk->calculateAABB(*field);
+                _chunkesArray[m][n] = chunk;
+            }
+        }
+
+        if (_streamingDistance <= 0)
+        {
+            std::vector<ChunkMesh> meshes(_chunkCount);
+            _director->getJobSystem()->parallelFor(meshes.size(), 1, [&](size_t first, size_t last) {
+                for (size_t i = first; i < last; ++i)
+                {
+                    Chunk::generate(*field, (int)i / chunk_amount_x, (int)i % chunk_amount_x, meshes[i]);
+                }
+            });
+            for (int i = 0; i < _chunkCount; ++i)
+            {
+                _chunkesArray[i / chunk_amount_x][i % chunk_amount_x]->setMesh(std::move(meshes[i]));
             }
+            _residentChunkCount = _chunkCount;
         }
 
         // calculate the neighbor
@@ -361,90 +427,179 @@ float Terrain::getHeight(const Vec2& pos, Vec3* normal) const
 
 float Terrain::getImageHeight(int pixel_x, int pixel_y) const
 {
-    int byte_stride = 1;
-    switch (_heightMapImage->getPixelFormat())
-    {
-    case backend::PixelFormat::BGRA8:
-        byte_stride = 4;
-        break;
-    case backend::PixelFormat::RGB8:
-        byte_stride = 3;
-        break;
-    case backend::PixelFormat::R8:
-        byte_stride = 1;
-        break;
-    default:
-        break;
-    }
+    int byte_stride = getHeightMapStride(_heightMapImage->getPixelFormat());
     return _data[(pixel_y * _imageWidth + pixel_x) * byte_stride] * 1.0 / 255 * _terrainData._mapHeight -
            0.5 * _terrainData._mapHeight;
 }
 
+float Terrain::HeightField::getHeight(int x, int y) const
+{
+    x = std::clamp(x, 0, _width - 1);
+    y = std::clamp(y, 0, _height - 1);
+    return _samples[y * _width + x] * 1.0 / 255 * _mapHeight - 0.5 * _mapHeight;
+}
+
+Vec3 Terrain::HeightField::getPosition(int x, int y) const
+{
+    x = std::clamp(x, 0, _width - 1);
+    y = std::clamp(y, 0, _height - 1);
+    return Vec3(x * _mapScale - _width / 2 * _mapScale,    // x
+                getHeight(x, y),                           // y
+                y * _mapScale - _height / 2 * _mapScale);  // z
+}
+
+Vec3 Terrain::HeightField::getNormal(int x, int y) const
+{
+    auto faceNormal = [this](int x0, int y0, int x1, int y1, int x2, int y2) {
+        auto p0 = getPosition(x0, y0);
+        Vec3 normal;
+        Vec3::cross(getPosition(x1, y1) - p0, getPosition(x2, y2) - p0, &normal);
+        normal.normalize();
+        return normal;
+    };
+
+    // sum the triangles sharing the vertex, each quad is split to (tl, bl, tr) and (tr, bl, br)
+    Vec3 normal;
+    if (y > 0 && x > 0)
+    {
+        normal += faceNormal(x, y - 1, x - 1, y, x, y);
+    }
+    if (y > 0 && x < _width - 1)
+    {
+        normal += faceNormal(x, y - 1, x, y, x + 1, y - 1);
+        normal += faceNormal(x + 1, y - 1, x, y, x + 1, y);
+    }
+    if (y < _height - 1 && x > 0)
+    {
+        normal += faceNormal(x - 1, y, x - 1, y + 1, x, y);
+        normal += faceNormal(x, y, x - 1, y + 1, x, y + 1);
+    }
+    if (y < _height - 1 && x < _width - 1)
+    {
+        normal += faceNormal(x, y, x, y + 1, x + 1, y);
+    }
+    normal.normalize();
+    return normal;
+}
+
+Terrain::TerrainVertexData Terrain::HeightField::getVertex(int x, int y) const
+{
+    x = std::clamp(x, 0, _width - 1);
+    y = std::clamp(y, 0, _height - 1);
+    TerrainVertexData v(getPosition(x, y), Tex2F(x * 1.0 / _width, y * 1.0 / _height));
+    v._normal = getNormal(x, y);
+    return v;
+}
+
 void Terrain::loadVertices()
 {
-    _maxHeight = -99999;
-    _minHeight = 99999;
+    _vertices.clear();
+    if (!_heightField)
+        return;
+
+    _vertices.reserve(static_cast<size_t>(_imageWidth) * _imageHeight);
     for (int i = 0; i < _imageHeight; ++i)
     {
         for (int j = 0; j < _imageWidth; j++)
         {
-            float height = getImageHeight(j, i);
-            TerrainVertexData v;
-            v._position = Vec3(j * _terrainData._mapScale - _imageWidth / 2 * _terrainData._mapScale,    // x
-                               height,                                                                   // y
-                               i * _terrainData._mapScale - _imageHeight / 2 * _terrainData._mapScale);  // z
-            v._texcoord = Tex2F(j * 1.0 / _imageWidth, i * 1.0 / _imageHeight);
-            _vertices.emplace_back(v);
-
-            // update the min & max height;
-            if (height > _maxHeight)
-                _maxHeight = height;
-            if (height < _minHeight)
-                _minHeight = height;
+            _vertices.emplace_back(_heightField->getPosition(j, i),
+                                   Tex2F(j * 1.0 / _imageWidth, i * 1.0 / _imageHeight));
         }
     }
 }
 
 void Terrain::calculateNormal()
 {
-    _indices.clear();
-    // we generate whole terrain indices(global indices) for correct normal calculate
-    for (int i = 0; i < _imageHeight - 1; i += 1)
+    if (!_heightField || _vertices.size() != static_cast<size_t>(_imageWidth) * _imageHeight)
+        return;
+
+    for (int i = 0; i < _imageHeight; ++i)
     {
-        for (int j = 0; j < _imageWidth - 1; j += 1)
+        for (int j = 0; j < _imageWidth; j++)
         {
+            _vertices[i * _imageWidth + j]._normal = _heightField->getNormal(j, i);
+        }
+    }
+}
 
-            int nLocIndex = i * _imageWidth + j;
-            _indices.emplace_back(nLocIndex);
-            _indices.emplace_back(nLocIndex + _imageWidth);
-            _indices.emplace_back(nLocIndex + 1);
+void Terrain::setStreamingDistance(float distance)
+{
+    _streamingDistance   = distance;
+    _isCameraViewChanged = true;
+}
 
-            _indices.emplace_back(nLocIndex + 1);
-            _indices.emplace_back(nLocIndex + _imageWidth);
-            _indices.emplace_back(nLocIndex + _imageWidth + 1);
+size_t Terrain::getResidentChunkMemory() const
+{
+    int chunk_amount_y = _imageHeight / _chunkSize.height;
+    int chunk_amount_x = _imageWidth / _chunkSize.width;
+    size_t size        = 0;
+    for (int m = 0; m < chunk_amount_y; m++)
+    {
+        for (int n = 0; n < chunk_amount_x; n++)
+        {
+            auto chunk = _chunkesArray[m][n];
+            size += chunk->_originalVertices.capacity() * sizeof(TerrainVertexData);
+            size += chunk->_currentVertices.capacity() * sizeof(TerrainVertexData);
+            size += chunk->_trianglesList.capacity() * sizeof(Triangle);
         }
     }
-    for (size_t i = 0, size = _indices.size(); i < size; i += 3)
+    return size;
+}
+
+void Terrain::updateStreaming(const Vec3& cameraPos)
+{
+    int chunk_amount_y = _imageHeight / _chunkSize.height;
+    int chunk_amount_x = _imageWidth / _chunkSize.width;
+    std::vector<std::pair<float, Chunk*>> loads;
+    for (int m = 0; m < chunk_amount_y; m++)
     {
-        unsigned int Index0 = _indices[i];
-        unsigned int Index1 = _indices[i + 1];
-        unsigned int Index2 = _indices[i + 2];
-        Vec3 v1             = _vertices[Index1]._position - _vertices[Index0]._position;
-        Vec3 v2             = _vertices[Index2]._position - _vertices[Index0]._position;
-        Vec3 Normal;
-        Vec3::cross(v1, v2, &Normal);
-        Normal.normalize();
-        _vertices[Index0]._normal += Normal;
-        _vertices[Index1]._normal += Normal;
-        _vertices[Index2]._normal += Normal;
+        for (int n = 0; n < chunk_amount_x; n++)
+        {
+            auto chunk  = _chunkesArray[m][n];
+            AABB aabb   = chunk->_parent->_worldSpaceAABB;
+            auto center = aabb.getCenter();
+            float dist  = Vec2(center.x, center.z).distance(Vec2(cameraPos.x, cameraPos.z));
+            if (_streamingDistance <= 0 || dist <= _streamingDistance)
+            {
+                if (!chunk->_resident && !chunk->_pendingMesh)
+                    loads.emplace_back(dist, chunk);
+            }
+            else if (dist > _streamingDistance * 1.25f)
+            {
+                if (chunk->_resident)
+                    --_residentChunkCount;
+                chunk->evict();
+            }
+        }
     }
 
-    for (auto&& vertex : _vertices)
+    // the nearest chunks first
+    std::sort(loads.begin(), loads.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (auto&& load : loads)
     {
-        vertex._normal.normalize();
+        loadChunk(load.second);
     }
-    // global indices no need at all
-    _indices.clear();
+}
+
+void Terrain::loadChunk(Chunk* chunk)
+{
+    auto mesh           = std::make_shared<ChunkMesh>();
+    chunk->_pendingMesh = mesh;
+
+    auto field = _heightField;
+    int m      = chunk->_posY;
+    int n      = chunk->_posX;
+    std::weak_ptr<int> token(_streamingToken);
+    _director->getJobSystem()->enqueue(
+        [field, m, n, mesh]() { Chunk::generate(*field, m, n, *mesh); },
+        [this, token, chunk, mesh]() {
+            // dropped if the chunk is evicted or destroyed meanwhile
+            if (token.expired() || chunk->_pendingMesh != mesh)
+                return;
+            chunk->_pendingMesh.reset();
+            chunk->setMesh(std::move(*mesh));
+            ++_residentChunkCount;
+        });
 }
 
 void Terrain::setDrawWire(bool bool_value)
@@ -523,9 +678,12 @@ ax::Vec3 Terrain::getIntersectionPoint(const Ray& ray) const
 
 bool Terrain::getIntersectionPoint(const Ray& ray_, Vec3& intersectionPoint) const
 {
-    // convert ray from world space to local space
+    // convert ray from world space to local space, the chunk triangles are in local space
     Ray ray(ray_);
-    getWorldToNodeTransform().transformPoint(&(ray._origin));
+    const auto worldToNode = getWorldToNodeTransform();
+    worldToNode.transformPoint(&(ray._origin));
+    worldToNode.transformVector(&(ray._direction));
+    ray._direction.normalize();
 
     std::set<Chunk*> closeList;
     Vec2 start = Vec2(ray_._origin.x, ray_._origin.z);
@@ -580,6 +738,9 @@ bool Terrain::getIntersectionPoint(const Ray& ray_, Vec3& intersectionPoint) con
         start.x += delta.x;
         start.y += delta.y;
     }
+
+    if (hasIntersect)
+        getNodeToWorldTransform().transformPoint(&intersectionPoint);
     return hasIntersect;
 }
 
@@ -614,9 +775,10 @@ ax::Vec2 Terrain::convertToTerrainSpace(const Vec2& worldSpaceXZ) const
 
 void Terrain::resetHeightMap(std::string_view heightMap)
 {
+    // the image owns _data
     _heightMapImage->release();
     _vertices.clear();
-    free(_data);
+    _streamingToken.reset();
     for (int i = 0; i < MAX_CHUNKES; ++i)
     {
         for (int j = 0; j < MAX_CHUNKES; j++)
@@ -660,7 +822,7 @@ std::vector<float> Terrain::getHeightData() const
         for (int j = 0; j < _imageWidth; j++)
         {
             int idx   = i * _imageWidth + j;
-            data[idx] = (_vertices[idx]._position.y);
+            data[idx] = _heightField->getHeight(j, i);
         }
     }
     return data;
@@ -896,7 +1058,8 @@ void Terrain::reload()
     {
         for (int n = 0; n < chunk_amount_x; n++)
         {
-            _chunkesArray[m][n]->finish();
+            if (_chunkesArray[m][n]->_resident)
+                _chunkesArray[m][n]->finish();
         }
     }
 
@@ -919,20 +1082,40 @@ void Terrain::Chunk::finish()
 
     calculateSlope();
 
+    _oldLod = -1;
     for (int i = 0; i < 4; ++i)
     {
-        int step = 1 << _currentLod;
-        // reserve the indices size, the first part is the core part of the chunk, the second part & third part is for
-        // fix crack
-        int indicesAmount = (_terrain->_chunkSize.width / step + 1) * (_terrain->_chunkSize.height / step + 1) * 6 +
-                            (_terrain->_chunkSize.height / step) * 6 + (_terrain->_chunkSize.width / step) * 6;
-        _lod[i]._indices.reserve(indicesAmount);
+        _neighborOldLOD[i] = -1;
     }
-    _oldLod = -1;
+}
+
+void Terrain::Chunk::setMesh(ChunkMesh&& mesh)
+{
+    _originalVertices = std::move(mesh._vertices);
+    _trianglesList    = std::move(mesh._triangles);
+    _resident         = true;
+    finish();
+}
+
+void Terrain::Chunk::evict()
+{
+    _pendingMesh.reset();
+    if (!_resident)
+        return;
+    std::vector<TerrainVertexData>().swap(_originalVertices);
+    std::vector<TerrainVertexData>().swap(_currentVertices);
+    std::vector<Triangle>().swap(_trianglesList);
+    _chunkIndices = ChunkIndices();
+    AX_SAFE_RELEASE_NULL(_buffer);
+    _resident = false;
 }
 
 void Terrain::Chunk::bindAndDraw()
 {
+    // not streamed in yet
+    if (!_resident)
+        return;
+
     if (_terrain->_isCameraViewChanged || _oldLod < 0)
     {
         switch (_terrain->_crackFixedType)
@@ -960,104 +1143,62 @@ void Terrain::Chunk::bindAndDraw()
     AX_INCREMENT_GL_DRAWN_BATCHES_AND_VERTICES(1, _chunkIndices._size);
 }
 
-void Terrain::Chunk::generate(int imgWidth, int imageHei, int m, int n, const unsigned char* /*data*/)
+void Terrain::Chunk::generate(const HeightField& field, int m, int n, ChunkMesh& mesh)
 {
-    _posY = m;
-    _posX = n;
-    switch (_terrain->_crackFixedType)
+    int gridX      = static_cast<int>(field._chunkSize.width);
+    int gridY      = static_cast<int>(field._chunkSize.height);
+    int x0         = gridX * n;
+    int y0         = gridY * m;
+    bool skirt     = field._crackFixedType == CrackFixedType::SKIRT;
+    auto& vertices = mesh._vertices;
+    vertices.reserve((gridX + 1) * (gridY + 1) + (skirt ? 2 * (gridX + 1) + 2 * (gridY + 1) : 0));
+    for (int i = y0; i <= y0 + gridY; ++i)
     {
-    case CrackFixedType::SKIRT:
-    {
-        for (int i = _size.height * m; i <= _size.height * (m + 1); ++i)
+        for (int j = x0; j <= x0 + gridX; j++)
         {
-            if (i >= imageHei)
-                break;
-            for (int j = _size.width * n; j <= _size.width * (n + 1); j++)
-            {
-                if (j >= imgWidth)
-                    break;
-                auto v = _terrain->_vertices[i * imgWidth + j];
-                _originalVertices.emplace_back(v);
-            }
+            vertices.emplace_back(field.getVertex(j, i));
         }
-        // add four skirts
+    }
 
-        float skirtHeight = _terrain->_skirtRatio * _terrain->_terrainData._mapScale * 8;
+    if (skirt)
+    {
+        // add four skirts, in the order of Terrain::_skirtVerticesOffset
+        auto addSkirt = [&](int x, int y) {
+            auto v = field.getVertex(x, y);
+            v._position.y -= field._skirtHeight;
+            vertices.emplace_back(v);
+        };
         //#1
-        _terrain->_skirtVerticesOffset[0] = (int)_originalVertices.size();
-        for (int i = _size.height * m; i <= _size.height * (m + 1); ++i)
-        {
-            auto v = _terrain->_vertices[i * imgWidth + _size.width * (n + 1)];
-            v._position.y -= skirtHeight;
-            _originalVertices.emplace_back(v);
-        }
-
+        for (int i = y0; i <= y0 + gridY; ++i)
+            addSkirt(x0 + gridX, i);
         //#2
-        _terrain->_skirtVerticesOffset[1] = (int)_originalVertices.size();
-        for (int j = _size.width * n; j <= _size.width * (n + 1); j++)
-        {
-            auto v = _terrain->_vertices[_size.height * (m + 1) * imgWidth + j];
-            v._position.y -= skirtHeight;
-            _originalVertices.emplace_back(v);
-        }
-
+        for (int j = x0; j <= x0 + gridX; j++)
+            addSkirt(j, y0 + gridY);
         //#3
-        _terrain->_skirtVerticesOffset[2] = (int)_originalVertices.size();
-        for (int i = _size.height * m; i <= _size.height * (m + 1); ++i)
-        {
-            auto v = _terrain->_vertices[i * imgWidth + _size.width * n];
-            v._position.y -= skirtHeight;
-            _originalVertices.emplace_back(v);
-        }
-
+        for (int i = y0; i <= y0 + gridY; ++i)
+            addSkirt(x0, i);
         //#4
-        _terrain->_skirtVerticesOffset[3] = (int)_originalVertices.size();
-        for (int j = _size.width * n; j <= _size.width * (n + 1); j++)
-        {
-            auto v = _terrain->_vertices[_size.height * m * imgWidth + j];
-            v._position.y -= skirtHeight;
-            // v.position.y = -5;
-            _originalVertices.emplace_back(v);
-        }
-    }
-    break;
-    case CrackFixedType::INCREASE_LOWER:
-    {
-        for (int i = _size.height * m; i <= _size.height * (m + 1); ++i)
-        {
-            if (i >= imageHei)
-                break;
-            for (int j = _size.width * n; j <= _size.width * (n + 1); j++)
-            {
-                if (j >= imgWidth)
-                    break;
-                auto v = _terrain->_vertices[i * imgWidth + j];
-                _originalVertices.emplace_back(v);
-            }
-        }
-    }
-    break;
+        for (int j = x0; j <= x0 + gridX; j++)
+            addSkirt(j, y0);
     }
+
     // store triangle:
-    for (int i = 0; i < _size.height; ++i)
+    auto& triangles = mesh._triangles;
+    triangles.reserve(gridX * gridY * 2);
+    for (int i = 0; i < gridY; ++i)
     {
-        for (int j = 0; j < _size.width; j++)
+        for (int j = 0; j < gridX; j++)
         {
-            int nLocIndex = i * (_size.width + 1) + j;
-            Triangle a(_originalVertices[nLocIndex]._position,
-                       _originalVertices[nLocIndex + 1 * (_size.width + 1)]._position,
-                       _originalVertices[nLocIndex + 1]._position);
-            Triangle b(_originalVertices[nLocIndex + 1]._position,
-                       _originalVertices[nLocIndex + 1 * (_size.width + 1)]._position,
-                       _originalVertices[nLocIndex + 1 * (_size.width + 1) + 1]._position);
-
-            _trianglesList.emplace_back(a);
-            _trianglesList.emplace_back(b);
+            int nLocIndex = i * (gridX + 1) + j;
+            Triangle a(vertices[nLocIndex]._position, vertices[nLocIndex + 1 * (gridX + 1)]._position,
+                       vertices[nLocIndex + 1]._position);
+            Triangle b(vertices[nLocIndex + 1]._position, vertices[nLocIndex + 1 * (gridX + 1)]._position,
+                       vertices[nLocIndex + 1 * (gridX + 1) + 1]._position);
+
+            triangles.emplace_back(a);
+            triangles.emplace_back(b);
         }
     }
-
-    calculateAABB();
-    finish();
 }
 
 Terrain::Chunk::Chunk(Terrain* terrain)
@@ -1126,14 +1267,18 @@ void Terrain::Chunk::updateIndicesLOD()
     {
         return;  // no need to update
     }
+    memcpy(_neighborOldLOD, currentNeighborLOD, sizeof(currentNeighborLOD));
+    _oldLod = _currentLod;
     bool isOk;
     _chunkIndices = _terrain->lookForIndicesLOD(currentNeighborLOD, _currentLod, &isOk);
     if (isOk)
     {
         return;
     }
-    memcpy(_neighborOldLOD, currentNeighborLOD, sizeof(currentNeighborLOD));
-    _oldLod   = _currentLod;
+
+    // the index buffers are shared by all chunks, build them in the scratch of the terrain
+    auto& indices = _terrain->_lodIndices;
+    indices.clear();
     int gridY = static_cast<int>(_size.height);
     int gridX = static_cast<int>(_size.width);
 
@@ -1143,19 +1288,18 @@ void Terrain::Chunk::updateIndicesLOD()
     // need update indices.
     {
         // t-junction inner
-        _lod[_currentLod]._indices.clear();
         for (int i = step; i < gridY - step; i += step)
         {
             for (int j = step; j < gridX - step; j += step)
             {
                 int nLocIndex = i * (gridX + 1) + j;
-                _lod[_currentLod]._indices.emplace_back(nLocIndex);
-                _lod[_currentLod]._indices.emplace_back(nLocIndex + step * (gridX + 1));
-                _lod[_currentLod]._indices.emplace_back(nLocIndex + step);
+                indices.emplace_back(nLocIndex);
+                indices.emplace_back(nLocIndex + step * (gridX + 1));
+                indices.emplace_back(nLocIndex + step);
 
-                _lod[_currentLod]._indices.emplace_back(nLocIndex + step);
-                _lod[_currentLod]._indices.emplace_back(nLocIndex + step * (gridX + 1));
-                _lod[_currentLod]._indices.emplace_back(nLocIndex + step * (gridX + 1) + step);
+                indices.emplace_back(nLocIndex + step);
+                indices.emplace_back(nLocIndex + step * (gridX + 1));
+                indices.emplace_back(nLocIndex + step * (gridX + 1) + step);
             }
         }
         // fix T-crack
@@ -1164,17 +1308,17 @@ void Terrain::Chunk::updateIndicesLOD()
         {
             for (int i = 0; i < gridY; i += next_step)
             {
-                _lod[_currentLod]._indices.emplace_back(i * (gridX + 1) + step);
-                _lod[_currentLod]._indices.emplace_back(i * (gridX + 1));
-                _lod[_currentLod]._indices.emplace_back((i + next_step) * (gridX + 1));
+                indices.emplace_back(i * (gridX + 1) + step);
+                indices.emplace_back(i * (gridX + 1));
+                indices.emplace_back((i + next_step) * (gridX + 1));
 
-                _lod[_currentLod]._indices.emplace_back(i * (gridX + 1) + step);
-                _lod[_currentLod]._indices.emplace_back((i + next_step) * (gridX + 1));
-                _lod[_currentLod]._indices.emplace_back((i + step) * (gridX + 1) + step);
+                indices.emplace_back(i * (gridX + 1) + step);
+                indices.emplace_back((i + next_step) * (gridX + 1));
+                indices.emplace_back((i + step) * (gridX + 1) + step);
 
-                _lod[_currentLod]._indices.emplace_back((i + step) * (gridX + 1) + step);
-                _lod[_currentLod]._indices.emplace_back((i + next_step) * (gridX + 1));
-                _lod[_currentLod]._indices.emplace_back((i + next_step) * (gridX + 1) + step);
+                indices.emplace_back((i + step) * (gridX + 1) + step);
+                indices.emplace_back((i + next_step) * (gridX + 1));
+                indices.emplace_back((i + next_step) * (gridX + 1) + step);
             }
         }
         else
@@ -1187,13 +1331,13 @@ void Terrain::Chunk::updateIndicesLOD()
                 start += step;
             for (int i = start; i < end; i += step)
             {
-                _lod[_currentLod]._indices.emplace_back(i * (gridX + 1) + step);
-                _lod[_currentLod]._indices.emplace_back(i * (gridX + 1));
-                _lod[_currentLod]._indices.emplace_back((i + step) * (gridX + 1));
+                indices.emplace_back(i * (gridX + 1) + step);
+                indices.emplace_back(i * (gridX + 1));
+                indices.emplace_back((i + step) * (gridX + 1));
 
-                _lod[_currentLod]._indices.emplace_back(i * (gridX + 1) + step);
-                _lod[_currentLod]._indices.emplace_back((i + step) * (gridX + 1));
-                _lod[_currentLod]._indices.emplace_back((i + step) * (gridX + 1) + step);
+                indices.emplace_back(i * (gridX + 1) + step);
+                indices.emplace_back((i + step) * (gridX + 1));
+                indices.emplace_back((i + step) * (gridX + 1) + step);
             }
         }
 
@@ -1201,17 +1345,17 @@ void Terrain::Chunk::updateIndicesLOD()
         {
             for (int i = 0; i < gridY; i += next_step)
             {
-                _lod[_currentLod]._indices.emplace_back(i * (gridX + 1) + gridX);
-                _lod[_currentLod]._indices.emplace_back(i * (gridX + 1) + gridX - step);
-                _lod[_currentLod]._indices.emplace_back((i + step) * (gridX + 1) + gridX - step);
+                indices.emplace_back(i * (gridX + 1) + gridX);
+                indices.emplace_back(i * (gridX + 1) + gridX - step);
+                indices.emplace_back((i + step) * (gridX + 1) + gridX - step);
 
-                _lod[_currentLod]._indices.emplace_back(i * (gridX + 1) + gridX);
-                _lod[_currentLod]._indices.emplace_back((i + step) * (gridX + 1) + gridX - step);
-                _lod[_currentLod]._indices.emplace_back((i + next_step) * (gridX + 1) + gridX - step);
+                indices.emplace_back(i * (gridX + 1) + gridX);
+                indices.emplace_back((i + step) * (gridX + 1) + gridX - step);
+                indices.emplace_back((i + next_step) * (gridX + 1) + gridX - step);
 
-                _lod[_currentLod]._indices.emplace_back(i * (gridX + 1) + gridX);
-                _lod[_currentLod]._indices.emplace_back((i + next_step) * (gridX + 1) + gridX - step);
-                _lod[_currentLod]._indices.emplace_back((i + next_step) * (gridX + 1) + gridX);
+                indices.emplace_back(i * (gridX + 1) + gridX);
+                indices.emplace_back((i + next_step) * (gridX + 1) + gridX - step);
+                indices.emplace_back((i + next_step) * (gridX + 1) + gridX);
             }
         }
         else
@@ -1224,108 +1368,127 @@ void Terrain::Chunk::updateIndicesLOD()
                 start += step;
             for (int i = start; i < end; i += step)
             {
-                _lod[_currentLod]._indices.emplace_back(i * (gridX + 1) + gridX);
-                _lod[_currentLod]._indices.emplace_back(i * (gridX + 1) + gridX - step);
-                _lod[_currentLod]._indices.emplace_back((i + step) * (gridX + 1) + gridX - step);
+                indices.emplace_back(i * (gridX + 1) + gridX);
+                indices.emplace_back(i * (gridX + 1) + gridX - step);
+                indices.emplace_back((i + step) * (gridX + 1) + gridX - step);
 
-                _lod[_currentLod]._indices.emplace_back(i * (gridX + 1) + gridX);
-                _lod[_currentLod]._indices.emplace_back((i + step) * (gridX + 1) + gridX - step);
-                _lod[_currentLod]._indices.emplace_back((i + step) * (gridX + 1) + gridX);
+                indices.emplace_back(i * (gridX + 1) + gridX);
+                indices.emplace_back((i + step) * (gridX + 1) + gridX - step);
+                indices.emplace_back((i + step) * (gridX + 1) + gridX);
             }
         }
         if (_front && _front->_currentLod > _currentLod)  // front
         {
             for (int i = 0; i < gridX; i += next_step)
             {
-                _lod[_currentLod]._indices.emplace_back((gridY - step) * (gridX + 1) + i);
-                _lod[_currentLod]._indices.emplace_back(gridY * (gridX + 1) + i);
-                _lod[_currentLod]._indices.emplace_back((gridY - step) * (gridX + 1) + i + step);
+                indices.emplace_back((gridY - step) * (gridX + 1) + i);
+                indices.emplace_back(gridY * (gridX + 1) + i);
+                indices.emplace_back((gridY - step) * (gridX + 1) + i + step);
 
-                _lod[_currentLod]._indices.emplace_back((gridY - step) * (gridX + 1) + i + step);
-                _lod[_currentLod]._indices.emplace_back(gridY * (gridX + 1) + i);
-                _lod[_currentLod]._indices.emplace_back(gridY * (gridX + 1) + i + next_step);
+                indices.emplace_back((gridY - step) * (gridX + 1) + i + step);
+                indices.emplace_back(gridY * (gridX + 1) + i);
+                indices.emplace_back(gridY * (gridX + 1) + i + next_step);
 
-                _lod[_currentLod]._indices.emplace_back((gridY - step) * (gridX + 1) + i + step);
-                _lod[_currentLod]._indices.emplace_back(gridY * (gridX + 1) + i + next_step);
-                _lod[_currentLod]._indices.emplace_back((gridY - step) * (gridX + 1) + i + next_step);
+                indices.emplace_back((gridY - step) * (gridX + 1) + i + step);
+                indices.emplace_back(gridY * (gridX + 1) + i + next_step);
+                indices.emplace_back((gridY - step) * (gridX + 1) + i + next_step);
             }
         }
         else
         {
             for (int i = step; i < gridX - step; i += step)
             {
-                _lod[_currentLod]._indices.emplace_back((gridY - step) * (gridX + 1) + i);
-                _lod[_currentLod]._indices.emplace_back(gridY * (gridX + 1) + i);
-                _lod[_currentLod]._indices.emplace_back((gridY - step) * (gridX + 1) + i + step);
+                indices.emplace_back((gridY - step) * (gridX + 1) + i);
+                indices.emplace_back(gridY * (gridX + 1) + i);
+                indices.emplace_back((gridY - step) * (gridX + 1) + i + step);
 
-                _lod[_currentLod]._indices.emplace_back((gridY - step) * (gridX + 1) + i + step);
-                _lod[_currentLod]._indices.emplace_back(gridY * (gridX + 1) + i);
-                _lod[_currentLod]._indices.emplace_back(gridY * (gridX + 1) + i + step);
+                indices.emplace_back((gridY - step) * (gridX + 1) + i + step);
+                indices.emplace_back(gridY * (gridX + 1) + i);
+                indices.emplace_back(gridY * (gridX + 1) + i + step);
             }
         }
         if (_back && _back->_currentLod > _currentLod)  // back
         {
             for (int i = 0; i < gridX; i += next_step)
             {
-                _lod[_currentLod]._indices.emplace_back(i);
-                _lod[_currentLod]._indices.emplace_back(step * (gridX + 1) + i);
-                _lod[_currentLod]._indices.emplace_back(step * (gridX + 1) + i + step);
+                indices.emplace_back(i);
+                indices.emplace_back(step * (gridX + 1) + i);
+                indices.emplace_back(step * (gridX + 1) + i + step);
 
-                _lod[_currentLod]._indices.emplace_back(i);
-                _lod[_currentLod]._indices.emplace_back(step * (gridX + 1) + i + step);
-                _lod[_currentLod]._indices.emplace_back(i + next_step);
+                indices.emplace_back(i);
+                indices.emplace_back(step * (gridX + 1) + i + step);
+                indices.emplace_back(i + next_step);
 
-                _lod[_currentLod]._indices.emplace_back(i + next_step);
-                _lod[_currentLod]._indices.emplace_back(step * (gridX + 1) + i + step);
-                _lod[_currentLod]._indices.emplace_back(step * (gridX + 1) + i + next_step);
+                indices.emplace_back(i + next_step);
+                indices.emplace_back(step * (gridX + 1) + i + step);
+                indices.emplace_back(step * (gridX + 1) + i + next_step);
             }
         }
         else
         {
             for (int i = step; i < gridX - step; i += step)
             {
-                _lod[_currentLod]._indices.emplace_back(i);
-                _lod[_currentLod]._indices.emplace_back(step * (gridX + 1) + i);
-                _lod[_currentLod]._indices.emplace_back(step * (gridX + 1) + i + step);
+                indices.emplace_back(i);
+                indices.emplace_back(step * (gridX + 1) + i);
+                indices.emplace_back(step * (gridX + 1) + i + step);
 
-                _lod[_currentLod]._indices.emplace_back(i);
-                _lod[_currentLod]._indices.emplace_back(step * (gridX + 1) + i + step);
-                _lod[_currentLod]._indices.emplace_back(i + step);
+                indices.emplace_back(i);
+                indices.emplace_back(step * (gridX + 1) + i + step);
+                indices.emplace_back(i + step);
             }
         }
 
-        _chunkIndices = _terrain->insertIndicesLOD(currentNeighborLOD, _currentLod, &_lod[_currentLod]._indices[0],
-                                                   (int)_lod[_currentLod]._indices.size());
+        _chunkIndices = _terrain->insertIndicesLOD(currentNeighborLOD, _currentLod, indices.data(), (int)indices.size());
     }
     else
     {
         // No lod difference, use simple method
-        _lod[_currentLod]._indices.clear();
         for (int i = 0; i < gridY; i += step)
         {
             for (int j = 0; j < gridX; j += step)
             {
 
                 int nLocIndex = i * (gridX + 1) + j;
-                _lod[_currentLod]._indices.emplace_back(nLocIndex);
-                _lod[_currentLod]._indices.emplace_back(nLocIndex + step * (gridX + 1));
-                _lod[_currentLod]._indices.emplace_back(nLocIndex + step);
+                indices.emplace_back(nLocIndex);
+                indices.emplace_back(nLocIndex + step * (gridX + 1));
+                indices.emplace_back(nLocIndex + step);
 
-                _lod[_currentLod]._indices.emplace_back(nLocIndex + step);
-                _lod[_currentLod]._indices.emplace_back(nLocIndex + step * (gridX + 1));
-                _lod[_currentLod]._indices.emplace_back(nLocIndex + step * (gridX + 1) + step);
+                indices.emplace_back(nLocIndex + step);
+                indices.emplace_back(nLocIndex + step * (gridX + 1));
+                indices.emplace_back(nLocIndex + step * (gridX + 1) + step);
             }
         }
-        _chunkIndices = _terrain->insertIndicesLOD(currentNeighborLOD, _currentLod, &_lod[_currentLod]._indices[0],
-                                                   (int)_lod[_currentLod]._indices.size());
+        _chunkIndices = _terrain->insertIndicesLOD(currentNeighborLOD, _currentLod, indices.data(), (int)indices.size());
     }
 }
 
-void Terrain::Chunk::calculateAABB()
+void Terrain::Chunk::calculateAABB(const HeightField& field)
 {
-    auto pos = axstd::pod_vector_from<Vec3>(_originalVertices.begin(), _originalVertices.end(),
-                   [](const auto& it) { return it._position; });
-    _aabb.updateMinMax(&pos[0], pos.size());
+    int x0         = static_cast<int>(_size.width) * _posX;
+    int y0         = static_cast<int>(_size.height) * _posY;
+    int x1         = x0 + static_cast<int>(_size.width);
+    int y1         = y0 + static_cast<int>(_size.height);
+    float minY     = FLT_MAX;
+    float maxY     = -FLT_MAX;
+    float edgeMinY = FLT_MAX;
+    for (int i = y0; i <= y1; ++i)
+    {
+        for (int j = x0; j <= x1; j++)
+        {
+            float height = field.getHeight(j, i);
+            minY         = std::min(minY, height);
+            maxY         = std::max(maxY, height);
+            if (i == y0 || i == y1 || j == x0 || j == x1)
+                edgeMinY = std::min(edgeMinY, height);
+        }
+    }
+    // the skirts hang below the border
+    if (field._crackFixedType == CrackFixedType::SKIRT)
+        minY = std::min(minY, edgeMinY - field._skirtHeight);
+
+    auto lo = field.getPosition(x0, y0);
+    auto hi = field.getPosition(x1, y1);
+    _aabb.set(Vec3(lo.x, minY, lo.z), Vec3(hi.x, maxY, hi.z));
 }
 
 void Terrain::Chunk::calculateSlope()
@@ -1360,8 +1523,8 @@ bool Terrain::Chunk::getIntersectPointWithRay(const Ray& ray, Vec3& intersectPoi
 
     float minDist = FLT_MAX;
     bool isFind   = false;
-    for (const auto& triangle : _trianglesList)
-    {
+
+    auto intersect = [&](const Triangle& triangle) {
         Vec3 p;
         if (triangle.getIntersectPoint(ray, p))
         {
@@ -1373,6 +1536,32 @@ bool Terrain::Chunk::getIntersectPointWithRay(const Ray& ray, Vec3& intersectPoi
             }
             isFind = true;
         }
+    };
+
+    if (!_trianglesList.empty() || !_terrain->_heightField)
+    {
+        for (const auto& triangle : _trianglesList)
+            intersect(triangle);
+        return isFind;
+    }
+
+    // the chunk isn't resident, intersect the triangles it would be generated with from the height field
+    const auto& field = *_terrain->_heightField;
+    int gridX         = static_cast<int>(field._chunkSize.width);
+    int gridY         = static_cast<int>(field._chunkSize.height);
+    int x0            = gridX * _posX;
+    int y0            = gridY * _posY;
+    for (int i = y0; i < y0 + gridY; ++i)
+    {
+        for (int j = x0; j < x0 + gridX; j++)
+        {
+            auto topLeft     = field.getPosition(j, i);
+            auto bottomLeft  = field.getPosition(j, i + 1);
+            auto topRight    = field.getPosition(j + 1, i);
+            auto bottomRight = field.getPosition(j + 1, i + 1);
+            intersect(Triangle(topLeft, bottomLeft, topRight));
+            intersect(Triangle(topRight, bottomLeft, bottomRight));
+        }
     }
 
     return isFind;
@@ -1428,6 +1617,8 @@ void Terrain::Chunk::updateIndicesLODSkirt()
     if (isOk)
         return;
 
+    auto& indices = _terrain->_lodIndices;
+    indices.clear();
     int gridY = _size.height;
     int gridX = _size.width;
     int step  = 1 << _currentLod;
@@ -1437,13 +1628,13 @@ void Terrain::Chunk::updateIndicesLODSkirt()
         for (int j = 0; j < gridX; j += step)
         {
             int nLocIndex = i * (gridX + 1) + j;
-            _lod[_currentLod]._indices.emplace_back(nLocIndex);
-            _lod[_currentLod]._indices.emplace_back(nLocIndex + step * (gridX + 1));
-            _lod[_currentLod]._indices.emplace_back(nLocIndex + step);
+            indices.emplace_back(nLocIndex);
+            indices.emplace_back(nLocIndex + step * (gridX + 1));
+            indices.emplace_back(nLocIndex + step);
 
-            _lod[_currentLod]._indices.emplace_back(nLocIndex + step);
-            _lod[_currentLod]._indices.emplace_back(nLocIndex + step * (gridX + 1));
-            _lod[_currentLod]._indices.emplace_back(nLocIndex + step * (gridX + 1) + step);
+            indices.emplace_back(nLocIndex + step);
+            indices.emplace_back(nLocIndex + step * (gridX + 1));
+            indices.emplace_back(nLocIndex + step * (gridX + 1) + step);
         }
     }
     // add skirt
@@ -1451,56 +1642,55 @@ void Terrain::Chunk::updateIndicesLODSkirt()
     for (int i = 0; i < gridY; i += step)
     {
         int nLocIndex = i * (gridX + 1) + gridX;
-        _lod[_currentLod]._indices.emplace_back(nLocIndex);
-        _lod[_currentLod]._indices.emplace_back(nLocIndex + step * (gridX + 1));
-        _lod[_currentLod]._indices.emplace_back((gridY + 1) * (gridX + 1) + i);
+        indices.emplace_back(nLocIndex);
+        indices.emplace_back(nLocIndex + step * (gridX + 1));
+        indices.emplace_back((gridY + 1) * (gridX + 1) + i);
 
-        _lod[_currentLod]._indices.emplace_back((gridY + 1) * (gridX + 1) + i);
-        _lod[_currentLod]._indices.emplace_back(nLocIndex + step * (gridX + 1));
-        _lod[_currentLod]._indices.emplace_back((gridY + 1) * (gridX + 1) + i + step);
+        indices.emplace_back((gridY + 1) * (gridX + 1) + i);
+        indices.emplace_back(nLocIndex + step * (gridX + 1));
+        indices.emplace_back((gridY + 1) * (gridX + 1) + i + step);
     }
 
     //#2
     for (int j = 0; j < gridX; j += step)
     {
         int nLocIndex = (gridY) * (gridX + 1) + j;
-        _lod[_currentLod]._indices.emplace_back(nLocIndex);
-        _lod[_currentLod]._indices.emplace_back(_terrain->_skirtVerticesOffset[1] + j);
-        _lod[_currentLod]._indices.emplace_back(nLocIndex + step);
+        indices.emplace_back(nLocIndex);
+        indices.emplace_back(_terrain->_skirtVerticesOffset[1] + j);
+        indices.emplace_back(nLocIndex + step);
 
-        _lod[_currentLod]._indices.emplace_back(nLocIndex + step);
-        _lod[_currentLod]._indices.emplace_back(_terrain->_skirtVerticesOffset[1] + j);
-        _lod[_currentLod]._indices.emplace_back(_terrain->_skirtVerticesOffset[1] + j + step);
+        indices.emplace_back(nLocIndex + step);
+        indices.emplace_back(_terrain->_skirtVerticesOffset[1] + j);
+        indices.emplace_back(_terrain->_skirtVerticesOffset[1] + j + step);
     }
 
     //#3
     for (int i = 0; i < gridY; i += step)
     {
         int nLocIndex = i * (gridX + 1);
-        _lod[_currentLod]._indices.emplace_back(nLocIndex);
-        _lod[_currentLod]._indices.emplace_back(_terrain->_skirtVerticesOffset[2] + i);
-        _lod[_currentLod]._indices.emplace_back((i + step) * (gridX + 1));
+        indices.emplace_back(nLocIndex);
+        indices.emplace_back(_terrain->_skirtVerticesOffset[2] + i);
+        indices.emplace_back((i + step) * (gridX + 1));
 
-        _lod[_currentLod]._indices.emplace_back((i + step) * (gridX + 1));
-        _lod[_currentLod]._indices.emplace_back(_terrain->_skirtVerticesOffset[2] + i);
-        _lod[_currentLod]._indices.emplace_back(_terrain->_skirtVerticesOffset[2] + i + step);
+        indices.emplace_back((i + step) * (gridX + 1));
+        indices.emplace_back(_terrain->_skirtVerticesOffset[2] + i);
+        indices.emplace_back(_terrain->_skirtVerticesOffset[2] + i + step);
     }
 
     //#4
     for (int j = 0; j < gridX; j += step)
     {
         int nLocIndex = j;
-        _lod[_currentLod]._indices.emplace_back(nLocIndex + step);
-        _lod[_currentLod]._indices.emplace_back(_terrain->_skirtVerticesOffset[3] + j);
-        _lod[_currentLod]._indices.emplace_back(nLocIndex);
+        indices.emplace_back(nLocIndex + step);
+        indices.emplace_back(_terrain->_skirtVerticesOffset[3] + j);
+        indices.emplace_back(nLocIndex);
 
-        _lod[_currentLod]._indices.emplace_back(_terrain->_skirtVerticesOffset[3] + j + step);
-        _lod[_currentLod]._indices.emplace_back(_terrain->_skirtVerticesOffset[3] + j);
-        _lod[_currentLod]._indices.emplace_back(nLocIndex + step);
+        indices.emplace_back(_terrain->_skirtVerticesOffset[3] + j + step);
+        indices.emplace_back(_terrain->_skirtVerticesOffset[3] + j);
+        indices.emplace_back(nLocIndex + step);
     }
 
-    _chunkIndices = _terrain->insertIndicesLODSkirt(_currentLod, &_lod[_currentLod]._indices[0],
-                                                    (int)_lod[_currentLod]._indices.size());
+    _chunkIndices = _terrain->insertIndicesLODSkirt(_currentLod, indices.data(), (int)indices.size());
 }
 
 Terrain::QuadTree::QuadTree(int x, int y, int w, int h, Terrain* terrain)
@@ -1541,11 +1731,6 @@ Terrain::QuadTree::QuadTree(int x, int y, int w, int h, Terrain* terrain)
         _isTerminal     = true;
         _localAABB      = _chunk->_aabb;
         _chunk->_parent = this;
-
-        for (auto&& triangle : _chunk->_trianglesList)
-        {
-            triangle.transform(_terrain->getNodeToWorldTransform());
-        }
     }
     _worldSpaceAABB = _localAABB;
     _worldSpaceAABB.transform(_terrain->getNodeToWorldTransform());
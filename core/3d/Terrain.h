@@ -25,6 +25,7 @@ THE SOFTWARE.
 ****************************************************************************/
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "2d/Node.h"
@@ -83,6 +84,10 @@ NS_AX_BEGIN
  * means only the base level is used),the maximum number of LOD levels is 4. Of course ,you can hack the value
  *individually.
  *
+ * Large terrains can stream their chunks, only the chunks within the streaming distance of the camera are generated,
+ * on the JobSystem worker threads, and the chunks moved far away are evicted. The LOD index buffers are shared by
+ * all chunks.
+ *
  * Finally, when LOD is enabled, cracks can begin to appear between terrain Chunks of
  * different LOD levels. An acceptable solution might be to simply reduce the lower LOD(high detail,smooth) chunks
  *border, And let the higher LOD(rough) chunks to seamlessly connect it.
@@ -179,6 +184,8 @@ public:
         int _detailMapAmount;
         /**the skirt height ratio, only effect when terrain use skirt to fix crack*/
         float _skirtHeightRatio;
+        /**the distance from the camera the chunks are streamed in, 0 generates all chunks on creation*/
+        float _streamingDistance = 0;
     };
 
 private:
@@ -221,6 +228,37 @@ private:
         ax::Vec3 _normal;
     };
 
+    /*
+     *the heights of the heightmap and the parameters to generate the chunks from them,
+     *shared with the chunk generation jobs
+     **/
+    struct HeightField
+    {
+        float getHeight(int x, int y) const;
+        Vec3 getPosition(int x, int y) const;
+        /**the average normal of the triangles around the vertex*/
+        Vec3 getNormal(int x, int y) const;
+        TerrainVertexData getVertex(int x, int y) const;
+
+        std::vector<uint8_t> _samples;
+        int _width;
+        int _height;
+        float _mapHeight;
+        float _mapScale;
+        Vec2 _chunkSize;
+        CrackFixedType _crackFixedType;
+        float _skirtHeight;
+    };
+
+    /*
+     *the vertices and triangles generated for a chunk
+     **/
+    struct ChunkMesh
+    {
+        std::vector<TerrainVertexData> _vertices;
+        std::vector<Triangle> _triangles;
+    };
+
     struct AX_DLL QuadTree;
     /*
      *the terminal node of quad, use to subdivision terrain mesh and LOD
@@ -233,20 +271,17 @@ private:
         ~Chunk();
         /*vertices*/
         std::vector<TerrainVertexData> _originalVertices;
-        /*LOD indices*/
-        struct LOD
-        {
-            std::vector<uint16_t> _indices;
-        };
         ChunkIndices _chunkIndices;
-        /**we now support four levels of detail*/
-        LOD _lod[4];
         /**AABB in local space*/
         AABB _aabb;
-        /**setup Chunk data*/
-        void generate(int map_width, int map_height, int m, int n, const unsigned char* data);
-        /**calculateAABB*/
-        void calculateAABB();
+        /**generate the mesh of the chunk (m, n) in local space, thread safe*/
+        static void generate(const HeightField& field, int m, int n, ChunkMesh& mesh);
+        /**take the generated mesh, and setup the GPU buffer*/
+        void setMesh(ChunkMesh&& mesh);
+        /**release the mesh and the GPU buffer*/
+        void evict();
+        /**calculate the AABB from the heights, no need of the mesh*/
+        void calculateAABB(const HeightField& field);
         /**internal use draw function*/
         void bindAndDraw();
         /**finish opengl setup*/
@@ -293,6 +328,11 @@ private:
 
         backend::Buffer* _buffer = nullptr;
         MeshCommand _command;
+
+        /**whether the mesh is generated*/
+        bool _resident = false;
+        /**the mesh being generated by the streaming job*/
+        std::shared_ptr<ChunkMesh> _pendingMesh;
     };
 
     /**
@@ -410,9 +450,9 @@ public:
     Vec3 getIntersectionPoint(const Ray& ray) const;
 
     /**
-     * Ray-Terrain intersection.
-     * @param ray to hit the terrain
-     * @param intersectionPoint hit point if hit
+     * Ray-Terrain intersection, the chunks not resident are intersected with the height map.
+     * @param ray to hit the terrain, in world space
+     * @param intersectionPoint hit point in world space if hit
      * @return true if hit, false otherwise
      */
     bool getIntersectionPoint(const Ray& ray, Vec3& intersectionPoint) const;
@@ -459,6 +499,25 @@ public:
 
     void reload();
 
+    /**
+     * Set the distance from the camera within which the chunks are generated on the worker threads,
+     * the chunks farther than 1.25 times the distance are evicted. 0 keeps all chunks resident.
+     */
+    void setStreamingDistance(float distance);
+
+    float getStreamingDistance() const { return _streamingDistance; }
+
+    /**
+     * get the amount of the chunks, and the chunks with their mesh generated
+     */
+    int getChunkCount() const { return _chunkCount; }
+    int getResidentChunkCount() const { return _residentChunkCount; }
+
+    /**
+     * get the memory of the resident chunk meshes in bytes, the vertices are also kept in a GPU buffer
+     */
+    size_t getResidentChunkMemory() const;
+
     /**
      * get the terrain's size
      */
@@ -480,15 +539,29 @@ protected:
      **/
     void setChunksLOD(const Vec3& cameraPos);
 
+    /**
+     * load the chunks near the camera on the worker threads, and evict the far chunks
+     * @param cameraPos the camera position in world space
+     **/
+    void updateStreaming(const Vec3& cameraPos);
+
+    /**
+     * generate the chunk mesh on a worker thread
+     **/
+    void loadChunk(Chunk* chunk);
+
     /**
      * load Vertices from height filed for the whole terrain.
+     * @deprecated the chunks generate their vertices from the height field, this only fills _vertices for the
+     * subclasses still reading it.
      **/
-    void loadVertices();
+    AX_DEPRECATED_ATTRIBUTE void loadVertices();
 
     /**
-     * calculate Normal Line for each Vertex
+     * calculate Normal Line for each Vertex of _vertices.
+     * @deprecated the normals are generated with the chunk vertices.
      **/
-    void calculateNormal();
+    AX_DEPRECATED_ATTRIBUTE void calculateNormal();
 
     // override
     virtual void onEnter() override;
@@ -530,8 +603,18 @@ protected:
     Vec3 _lightDir;
     QuadTree* _quadRoot;
     Chunk* _chunkesArray[MAX_CHUNKES][MAX_CHUNKES];
+    std::shared_ptr<const HeightField> _heightField;
+    /**the vertices of the whole terrain, only filled by the deprecated loadVertices()*/
     std::vector<TerrainVertexData> _vertices;
+    /**always empty, the chunks share the LOD index buffers*/
     std::vector<unsigned int> _indices;
+    /**expired when the chunks are destroyed, the streaming jobs finished later are dropped*/
+    std::shared_ptr<int> _streamingToken;
+    /**the indices being built for a LOD, before they are uploaded to the shared index buffer*/
+    std::vector<uint16_t> _lodIndices;
+    float _streamingDistance = 0;
+    int _chunkCount          = 0;
+    int _residentChunkCount  = 0;
     int _imageWidth;
     int _imageHeight;
     Vec2 _chunkSize;
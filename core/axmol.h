@@ -267,6 +267,7 @@ THE SOFTWARE.
 #include "3d/AttachNode.h"
 #include "3d/BillBoard.h"
 #include "3d/Frustum.h"
+#include "3d/CullingBVH.h"
 #include "3d/Mesh.h"
 #include "3d/MeshSkin.h"
 #include "3d/MotionStreak3D.h"
@@ -28,6 +28,7 @@
 #include "yasio/thread_name.hpp"
 
 #include <queue>
+#include <atomic>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
@@ -113,6 +114,8 @@ public:
             worker.join();
     }
 
+    size_t size() const { return workers.size(); }
+
 private:
     // need to keep track of threads so we can join them
     std::vector<std::thread> workers;
@@ -232,6 +235,47 @@ void JobSystem::enqueue(std::function<void()> task, std::function<void()> done)
         taskw(_mainThreadData);
 }
 
+void JobSystem::parallelFor(size_t count, size_t grain, const std::function<void(size_t first, size_t last)>& fn)
+{
+    grain               = (std::max)(grain, size_t{1});
+    const size_t ranges = (count + grain - 1) / grain;
+    if (ranges <= 1 || !_executor)
+    {
+        if (count > 0)
+            fn(0, count);
+        return;
+    }
+
+    struct Context
+    {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+    };
+    auto context = std::make_shared<Context>();
+
+    // the helpers started after all ranges claimed return without touching fn
+    auto run = [context, ranges, grain, count, pfn = &fn](JobThreadData*) {
+        for (size_t i; (i = context->next.fetch_add(1, std::memory_order_relaxed)) < ranges;)
+        {
+            (*pfn)(i * grain, (std::min)(count, (i + 1) * grain));
+            context->done.fetch_add(1, std::memory_order_release);
+        }
+    };
+
+    const size_t helpers = (std::min)(ranges - 1, _executor->size());
+    for (size_t i = 0; i < helpers; ++i)
+        _executor->enqueue_v(run);
+    run(_mainThreadData);
+
+    while (context->done.load(std::memory_order_acquire) < ranges)
+        std::this_thread::yield();
+}
+
+size_t JobSystem::getThreadCount() const
+{
+    return _executor ? _executor->size() : 0;
+}
+
 #pragma endregion
 
 NS_AX_END
@@ -37,6 +37,7 @@ Copyright (c) 2019-present Axmol Engine contributors (see AUTHORS.md).
 
 #include <vector>
 #include <memory>
+#include <functional>
 #include <string>
 #include <span>
 #include "base/Config.h"
@@ -101,6 +102,16 @@ public:
     void enqueue(std::function<void()> task, std::function<void()> done);
     void enqueue(std::shared_ptr<JobThreadTask> task);
 
+    /**
+     * Invoke fn over [0, count) split into ranges of grain items on the job threads, blocks until all ranges done.
+     * The calling thread claims ranges too, so it never waits for the busy job threads to start.
+     * fn must be safe to run concurrently for different ranges.
+     */
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t first, size_t last)>& fn);
+
+    /** The count of the job threads, the thread calling parallelFor is not included. */
+    size_t getThreadCount() const;
+
  protected:
     void init(const std::span<std::shared_ptr<JobThreadData>>& tdds);
 
@@ -27,6 +27,7 @@ THE SOFTWARE.
 #if defined(_WIN32)
 #    include <io.h>
 #    include <direct.h>
+#    include "ntcvt/ntcvt.hpp"
 #else
 #    include <unistd.h>
 #    include <errno.h>
@@ -35,6 +36,7 @@ THE SOFTWARE.
 #include <sys/stat.h>
 
 #include <inttypes.h>
+#include <future>
 #include <sstream>
 
 #include "openssl/aes.h"
@@ -50,9 +52,22 @@ THE SOFTWARE.
 #include "platform/FileUtils.h"
 #include "pugixml/pugixml.hpp"
 #include "base/Utils.h"
+#include "base/Director.h"
+#include "base/JobSystem.h"
+#include "xxhash.h"
 
 #define USER_DEFAULT_PLAIN_MODE 0
 
+// The log file: header(magic + reserved) + records, a record: op + key + value(set only) + XXH32 of the former
+#define UD_LOG_MAGIC        0x314C4455  // UDL1
+#define UD_LOG_HEADER_SIZE  8
+#define UD_RECORD_SET       1
+#define UD_RECORD_DELETE    2
+
+// Compact the log when its records exceed the estimated size of live values by the factor
+#define UD_COMPACT_FACTOR   2
+#define UD_COMPACT_MIN_SIZE (64 * 1024)
+
 typedef int32_t udflen_t;
 
 NS_AX_BEGIN
@@ -90,6 +105,145 @@ static void ud_write_v_s(UserDefault* ud, yasio::obstream& obs, const cxx17::str
         ud->encrypt(obs.data() + value_offset, value.length(), AES_ENCRYPT);
 }
 
+static void ud_write_record(UserDefault* ud,
+                            yasio::obstream& obs,
+                            bool encrypted,
+                            uint8_t op,
+                            cxx17::string_view key,
+                            cxx17::string_view value)
+{
+    const size_t offset = obs.length();
+    obs.write<uint8_t>(op);
+    if (encrypted)
+    {
+        ud_write_v_s(ud, obs, key);
+        if (op == UD_RECORD_SET)
+            ud_write_v_s(ud, obs, value);
+    }
+    else
+    {
+        obs.write_v(key);
+        if (op == UD_RECORD_SET)
+            obs.write_v(value);
+    }
+    obs.write<uint32_t>(XXH32(obs.data() + offset, obs.length() - offset, 0));
+}
+
+static bool ud_read_v(const char*& ptr, const char* last, cxx17::string_view& out)
+{
+    // 7bit encoded length, same as yasio::obstream::write_v
+    uint32_t len = 0;
+    for (int shift = 0;; shift += 7)
+    {
+        if (ptr >= last || shift > 28)
+            return false;
+        const auto b = static_cast<uint8_t>(*ptr++);
+        len |= static_cast<uint32_t>(b & 0x7fu) << shift;
+        if (b <= 0x7fu)
+            break;
+    }
+    if (static_cast<size_t>(last - ptr) < len)
+        return false;
+    out = cxx17::string_view{ptr, len};
+    ptr += len;
+    return true;
+}
+
+// Returns the size of record at first, 0 if the end of log reached or the record is torn
+static size_t ud_read_record(const char* first,
+                             const char* last,
+                             uint8_t& op,
+                             cxx17::string_view& key,
+                             cxx17::string_view& value)
+{
+    const char* ptr = first;
+    if (ptr >= last)
+        return 0;
+    op = static_cast<uint8_t>(*ptr++);
+    if (op != UD_RECORD_SET && op != UD_RECORD_DELETE)
+        return 0;
+    value = cxx17::string_view{};
+    if (!ud_read_v(ptr, last, key) || (op == UD_RECORD_SET && !ud_read_v(ptr, last, value)))
+        return 0;
+    if (last - ptr < static_cast<ptrdiff_t>(sizeof(uint32_t)))
+        return 0;
+    if (yasio::ibstream::sread<uint32_t>(ptr) != XXH32(first, ptr - first, 0))
+        return 0;
+    return ptr + sizeof(uint32_t) - first;
+}
+
+// Flush a file, or a directory on posix, to the storage, so renaming the compacted log over the log survives a crash
+static bool ud_sync_path(const std::string& path, bool directory)
+{
+#if defined(_WIN32)
+    if (directory)
+        return true;  // NTFS journals the rename, a directory can't be flushed
+    int fd = _wopen(ntcvt::from_chars(path).c_str(), _O_RDWR | _O_BINARY);
+    if (fd == -1)
+        return false;
+    bool ok = _commit(fd) == 0;
+    _close(fd);
+    return ok;
+#else
+    int fd = ::open(path.c_str(), directory ? O_RDONLY : O_RDWR);
+    if (fd == -1)
+        return false;
+    bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+#endif
+}
+
+// Write a log to the storage, it replaces the log by a rename once written, so a crash leaves either of them whole
+static bool ud_write_log(const std::string& path, const yasio::obstream& obs)
+{
+    FileStream fs;
+    bool ok = fs.open(path, IFileStream::Mode::WRITE) &&
+              fs.write(obs.data(), static_cast<unsigned int>(obs.length())) == static_cast<int>(obs.length());
+    fs.close();
+
+    // the content must be on the storage before the rename, or a crash may leave an empty or truncated log
+    return ok && ud_sync_path(path, false);
+}
+
+struct UserDefaultCompaction
+{
+    UserDefault* owner = nullptr;  // nullptr if the owner destroyed
+    bool stale         = false;    // the log was rewritten by flush meanwhile
+    bool succeed       = false;
+    std::string path;
+    std::string snapshot;  // the records to compact
+    int compactedSize = 0;
+    std::promise<void> written;  // set when run returns
+
+    // Runs on JobSystem, keep the last record of each live key, the encrypted keys are deterministic
+    void run()
+    {
+        hlookup::string_map<cxx17::string_view> live;
+        const char* ptr  = snapshot.data();
+        const char* last = ptr + snapshot.size();
+        uint8_t op;
+        cxx17::string_view key, value;
+        while (auto n = ud_read_record(ptr, last, op, key, value))
+        {
+            if (op == UD_RECORD_SET)
+                live[key] = cxx17::string_view{ptr, n};
+            else
+                live.erase(key);
+            ptr += n;
+        }
+
+        yasio::obstream obs(snapshot.size());
+        obs.write<uint32_t>(UD_LOG_MAGIC);
+        obs.write<uint32_t>(0);
+        for (auto&& item : live)
+            obs.write_bytes(item.second);
+        compactedSize = static_cast<int>(obs.length() - UD_LOG_HEADER_SIZE);
+        succeed       = ud_write_log(path, obs);
+        written.set_value();
+    }
+};
+
 void UserDefault::setEncryptEnabled(bool enabled, cxx17::string_view key, cxx17::string_view iv)
 {
     _encryptEnabled = enabled;
@@ -123,6 +277,8 @@ void UserDefault::encrypt(char* inout, size_t size, int enc)
 
 UserDefault::~UserDefault()
 {
+    if (_compaction)
+        _compaction->owner = nullptr;
     closeFileMapping();
 }
 
@@ -137,6 +293,148 @@ void UserDefault::closeFileMapping()
 #endif
 }
 
+bool UserDefault::openFileMapping()
+{
+    if (!_fileStream.open(_filePath, IFileStream::Mode::OVERLAPPED))
+    {
+        AXLOGW("UserDefault::init open storage file '{}' failed!", _filePath);
+        return false;
+    }
+
+    int filesize = static_cast<int>(_fileStream.size());
+    if (filesize > _curMapSize)
+        _curMapSize = filesize;
+
+    _rwmmap = std::make_shared<mio::mmap_sink>();
+    return remapFile(_curMapSize);
+}
+
+bool UserDefault::remapFile(int mapSize)
+{
+    std::error_code error;
+    _rwmmap->unmap();
+    if (_fileStream.size() < mapSize && !_fileStream.resize(mapSize))
+        AXLOGW("UserDefault::init failed to truncate '{}'.", _filePath);
+    else
+        _rwmmap->map(_fileStream.nativeHandle(), 0, mapSize, error);
+
+    if (!error && _rwmmap->is_mapped())
+    {
+        _curMapSize = mapSize;
+        return true;
+    }
+
+    // close file mapping and do a simple workaround fix to don't do persist later at this time
+    closeFileMapping();
+    ::remove(_filePath.c_str());
+    AXLOGW("UserDefault::init map file '{}' failed, we can't save data persisit this time, next time "
+           "we will retry!",
+           _filePath);
+    return false;
+}
+
+void UserDefault::appendRecord(uint8_t op, std::string_view key, std::string_view value)
+{
+    yasio::obstream obs;
+    ud_write_record(this, obs, _encryptEnabled, op, key, value);
+
+    const int required = UD_LOG_HEADER_SIZE + _realSize + static_cast<int>(obs.length());
+    if (required > _curMapSize)
+    {
+        int mapSize = _curMapSize;
+        while (mapSize < required)
+            mapSize <<= 1;  // X2
+        if (!remapFile(mapSize))
+            return;
+    }
+
+    // the record is committed by its checksum, a torn write is dropped on next load
+    ::memcpy(_rwmmap->data() + UD_LOG_HEADER_SIZE + _realSize, obs.data(), obs.length());
+    _realSize += static_cast<int>(obs.length());
+
+    if (_realSize > (std::max)(UD_COMPACT_MIN_SIZE, UD_COMPACT_FACTOR * _compactedSize))
+        scheduleCompaction();
+}
+
+void UserDefault::scheduleCompaction()
+{
+    if (_compaction)
+        return;
+
+    auto jobSystem = Director::getInstance()->getJobSystem();
+    if (!jobSystem)
+    {
+        flush();
+        return;
+    }
+
+    // not the path of flush, which may replace the log while the compaction is writing
+    auto compaction   = std::make_shared<UserDefaultCompaction>();
+    compaction->owner = this;
+    compaction->path  = _filePath + ".compacting";
+    compaction->snapshot.assign(_rwmmap->data() + UD_LOG_HEADER_SIZE, _realSize);
+    _compaction = compaction;
+
+    jobSystem->enqueue([compaction]() { compaction->run(); },
+                       [compaction]() {
+        if (!compaction->owner)
+            ::remove(compaction->path.c_str());
+        else if (compaction->owner->_compaction == compaction)  // not finished by waitForCompaction
+            compaction->owner->finishCompaction();
+    });
+}
+
+void UserDefault::waitForCompaction()
+{
+    if (_compaction)
+    {
+        _compaction->written.get_future().wait();
+        finishCompaction();
+    }
+}
+
+void UserDefault::finishCompaction()
+{
+    auto compaction = std::move(_compaction);
+    if (!compaction->succeed || compaction->stale || !_rwmmap)
+    {
+        ::remove(compaction->path.c_str());
+        return;
+    }
+
+    // the records appended while compacting
+    const int snapshotSize = static_cast<int>(compaction->snapshot.size());
+    replaceLog(compaction->path, compaction->compactedSize,
+               std::string_view{_rwmmap->data() + UD_LOG_HEADER_SIZE + snapshotSize,
+                                static_cast<size_t>(_realSize - snapshotSize)});
+}
+
+bool UserDefault::replaceLog(const std::string& path, int compactedSize, std::string_view tail)
+{
+    std::string appended(tail);  // the tail is in the mapping of the log
+    closeFileMapping();
+    if (!FileUtils::getInstance()->renameFile(path, _filePath))
+    {
+        // the log is still intact
+        ::remove(path.c_str());
+        openFileMapping();
+        return false;
+    }
+    ud_sync_path(FileUtils::getPathDirName(_filePath), true);
+
+    _realSize = _compactedSize = compactedSize;
+    _curMapSize               = 4096;
+    const int required = UD_LOG_HEADER_SIZE + _realSize + static_cast<int>(appended.size());
+    while (_curMapSize < required * 2)
+        _curMapSize <<= 1;  // X2
+    if (!openFileMapping())
+        return false;
+
+    ::memcpy(_rwmmap->data() + UD_LOG_HEADER_SIZE + _realSize, appended.data(), appended.size());
+    _realSize += static_cast<int>(appended.size());
+    return true;
+}
+
 bool UserDefault::getBoolForKey(const char* pKey)
 {
     return getBoolForKey(pKey, false);
@@ -298,33 +596,7 @@ void UserDefault::setStringForKey(const char* pKey, std::string_view value)
 
 #if !USER_DEFAULT_PLAIN_MODE
     if (_rwmmap)
-    {
-        yasio::obstream obs;
-        if (_encryptEnabled)
-        {
-            ud_write_v_s(this, obs, pKey);
-            ud_write_v_s(this, obs, value);
-        }
-        else
-        {
-            obs.write_v(pKey);
-            obs.write_v(value);
-        }
-
-        if ((_realSize + obs.length() + sizeof(udflen_t)) < _curMapSize)
-        {  // fast append entity without flush
-            // increase entities count
-            yasio::obstream::swrite(_rwmmap->data(), 1 + yasio::ibstream::sread<udflen_t>(_rwmmap->data()));
-
-            // append entity
-            ::memcpy(_rwmmap->data() + sizeof(udflen_t) + _realSize, obs.data(), obs.length());
-            _realSize += static_cast<int>(obs.length());
-        }
-        else
-        {
-            flush();
-        }
-    }
+        appendRecord(UD_RECORD_SET, pKey, value);
 #else
     flush();
 #endif
@@ -376,63 +648,96 @@ void UserDefault::lazyInit()
 #if !USER_DEFAULT_PLAIN_MODE
     _filePath = FileUtils::getInstance()->getNativeWritableAbsolutePath() + _userDefalutFileName;
 
-    // construct file mapping
-    if (!_fileStream.open(_filePath, IFileStream::Mode::OVERLAPPED))
+    // A flush or compaction interrupted before it replaced the log, the log is only missing if it was interrupted
+    // while renaming on windows
+    for (auto suffix : {".compact", ".compacting"})
     {
-        AXLOGW("UserDefault::init open storage file '{}' failed!", _filePath);
-        return;
+        auto compactPath = _filePath + suffix;
+        if (!FileUtils::getInstance()->isFileExist(compactPath))
+            continue;
+        if (!FileUtils::getInstance()->isFileExist(_filePath))
+        {
+            if (FileUtils::getInstance()->renameFile(compactPath, _filePath))
+                ud_sync_path(FileUtils::getPathDirName(_filePath), true);
+        }
+        else
+            ::remove(compactPath.c_str());
     }
 
-    int filesize = static_cast<int>(_fileStream.size());
+    // construct file mapping
+    if (!openFileMapping())
+        return;
 
-    if (filesize < _curMapSize)
-    {  // construct a empty file mapping
-        if (!_fileStream.resize(_curMapSize))
+    const char* first = _rwmmap->data();
+    const char* last  = first + _rwmmap->length();
+    if (yasio::ibstream::sread<uint32_t>(first) == UD_LOG_MAGIC)
+    {  /// replay the log to memory _values
+        const char* ptr = first + UD_LOG_HEADER_SIZE;
+        uint8_t op;
+        std::string_view key, value;
+        while (auto n = ud_read_record(ptr, last, op, key, value))
         {
-            AXLOGW("UserDefault::init failed to truncate '{}'.", _filePath);
-            return;
-        }
-        _rwmmap = std::make_shared<mio::mmap_sink>(_fileStream.nativeHandle(), 0, _curMapSize);
-    }
-    else
-    {  /// load to memory _values
-        _rwmmap = std::make_shared<mio::mmap_sink>(_fileStream.nativeHandle(), 0, mio::map_entire_file);
-        if (_rwmmap->is_mapped())
-        {  // no error
-            yasio::ibstream_view ibs(_rwmmap->data(), _rwmmap->length());
+            std::string decryptedKey;
+            if (_encryptEnabled)
+            {
+                decryptedKey.assign(key);
+                this->encrypt(decryptedKey, AES_DECRYPT);
+                key = decryptedKey;
+            }
 
-            if (ibs.length() > 0)
+            if (op == UD_RECORD_SET)
             {
-                // read count of keyvals.
-                int count = ibs.read<int>();
-                for (auto i = 0; i < count; ++i)
+                if (_encryptEnabled)
                 {
-                    if (_encryptEnabled)
-                    {
-                        std::string key(ibs.read_v());
-                        std::string value(ibs.read_v());
-                        this->encrypt(key, AES_DECRYPT);
-                        this->encrypt(value, AES_DECRYPT);
-                        updateValueForKey(key, value);
-                    }
-                    else
-                    {
-                        std::string_view key(ibs.read_v());
-                        std::string_view value(ibs.read_v());
-                        updateValueForKey(key, value);
-                    }
+                    std::string decryptedValue(value);
+                    this->encrypt(decryptedValue, AES_DECRYPT);
+                    updateValueForKey(key, decryptedValue);
                 }
-                _realSize = static_cast<int>(ibs.seek(0, SEEK_CUR) - sizeof(udflen_t));
+                else
+                    updateValueForKey(key, value);
             }
+            else
+                _values.erase(key);
+            ptr += n;
         }
-        else
+        _realSize = static_cast<int>(ptr - first - UD_LOG_HEADER_SIZE);
+
+        // drop the torn record at the tail, so the records appended later can't be mixed with it
+        auto garbage = std::find_if(ptr, last, [](char c) { return c != 0; });
+        if (garbage != last)
+        {
+            AXLOGW("UserDefault::init drop torn records of '{}' at {}.", _filePath, _realSize);
+            ::memset(_rwmmap->data() + (ptr - first), 0, last - ptr);
+        }
+
+        for (auto&& item : _values)
+            _compactedSize += static_cast<int>(item.first.size() + item.second.size());
+    }
+    else
+    {  /// load to memory _values from the legacy format: count of keyvals + keyvals
+        yasio::ibstream_view ibs(_rwmmap->data(), _rwmmap->length());
+        int count = ibs.read<int>();
+        for (auto i = 0; i < count; ++i)
         {
-            closeFileMapping();
-            ::remove(_filePath.c_str());
-            AXLOGW("UserDefault::init map file '{}' failed, we can't save data persisit this time, next time "
-                "we will retry!",
-                _filePath);
+            if (_encryptEnabled)
+            {
+                std::string key(ibs.read_v());
+                std::string value(ibs.read_v());
+                this->encrypt(key, AES_DECRYPT);
+                this->encrypt(value, AES_DECRYPT);
+                updateValueForKey(key, value);
+            }
+            else
+            {
+                std::string_view key(ibs.read_v());
+                std::string_view value(ibs.read_v());
+                updateValueForKey(key, value);
+            }
         }
+
+        // convert to log
+        _realSize = static_cast<int>(ibs.seek(0, SEEK_CUR) - UD_LOG_HEADER_SIZE);
+        flush();
     }
 #else
     pugi::xml_document doc;
@@ -465,45 +770,25 @@ void UserDefault::flush()
     if (_rwmmap)
     {
         yasio::obstream obs;
-        obs.write<int>(static_cast<int>(this->_values.size()));
+        obs.write<uint32_t>(UD_LOG_MAGIC);
+        obs.write<uint32_t>(0);
         for (auto&& item : this->_values)
-        {
-            if (_encryptEnabled)
-            {
-                ud_write_v_s(this, obs, item.first);
-                ud_write_v_s(this, obs, item.second);
-            }
-            else
-            {
-                obs.write_v(item.first);
-                obs.write_v(item.second);
-            }
-        }
+            ud_write_record(this, obs, _encryptEnabled, UD_RECORD_SET, item.first, item.second);
 
-        std::error_code error;
-        if (obs.length() > _curMapSize)
+        // the log is replaced by the compacted one, never rewritten in place, so a crash can't leave it half written
+        auto compactPath = _filePath + ".compact";
+        if (!ud_write_log(compactPath, obs))
         {
-            _rwmmap->unmap();
-            while (obs.length() > _curMapSize)
-                _curMapSize <<= 1;  // X2
-
-            if (!_fileStream.resize(_curMapSize))
-                AXLOGW("UserDefault::flush failed to truncate '{}'.", _filePath);
-
-            _rwmmap->map(_fileStream.nativeHandle(), 0, _curMapSize, error);
+            AXLOGW("UserDefault::flush failed to write '{}'.", compactPath);
+            ::remove(compactPath.c_str());
+            return;
         }
+        if (!replaceLog(compactPath, static_cast<int>(obs.length() - UD_LOG_HEADER_SIZE), {}))
+            return;
 
-        if (!error && _rwmmap->is_mapped())
-        {  // mapping status is good
-            ::memcpy(_rwmmap->data(), obs.data(), obs.length());
-            _realSize = static_cast<int>(obs.length() - sizeof(udflen_t));
-        }
-        else
-        {
-            // close file mapping and do a simple workaround fix to don't do persist later at this time
-            closeFileMapping();
-            ::remove(_filePath.c_str());
-        }
+        // the snapshot of compaction in progress is invalid now
+        if (_compaction)
+            _compaction->stale = true;
     }
 #else
     pugi::xml_document doc;
@@ -521,8 +806,17 @@ void UserDefault::flush()
 
 void UserDefault::deleteValueForKey(const char* key)
 {
+    lazyInit();
+
     if (this->_values.erase(key) > 0)
+    {
+#if !USER_DEFAULT_PLAIN_MODE
+        if (_rwmmap)
+            appendRecord(UD_RECORD_DELETE, key, {});
+#else
         flush();
+#endif
+    }
 }
 
 void UserDefault::setFileName(std::string_view nameFile)
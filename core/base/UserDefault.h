@@ -41,6 +41,8 @@ THE SOFTWARE.
  */
 NS_AX_BEGIN
 
+struct UserDefaultCompaction;
+
 /**
  * UserDefault acts as a tiny database. You can save and get base type values by it.
  * For example, setBoolForKey("played", true) will add a bool value true into the database.
@@ -51,6 +53,10 @@ NS_AX_BEGIN
  *
  * @warning: On windows, linux, use XML to store data, which means there are some limitations of
  * the key string, for example, `/` is not valid.
+ *
+ * The binary storage is an append-only log of checksummed records mapped into memory, each set or delete
+ * appends one record. When the log grows much larger than the live values, it's compacted on the JobSystem
+ * and swapped in on the axmol thread. A torn record at the tail (e.g. crash while writing) is dropped on load.
  */
 class AX_DLL UserDefault
 {
@@ -208,11 +214,19 @@ public:
 
     /**
      * Since we reimplement UserDefault with file mapping io,
-     * you don't needs call this function manually
+     * you don't needs call this function manually.
+     * It writes the compacted log to a file, syncs it to disk, then renames it over the log.
      * @js NA
      */
     virtual void flush();
 
+    /**
+     * Blocks until the compaction in progress on JobSystem is written, then replaces the log by it,
+     * instead of waiting for the axmol thread to swap it in.
+     * @js NA
+     */
+    void waitForCompaction();
+
     /**
      * delete any value by key,
      * @param key The key to delete value.
@@ -270,6 +284,21 @@ protected:
 
     void closeFileMapping();
 
+    bool openFileMapping();
+
+    bool remapFile(int mapSize);
+
+    // Append a set or delete record to the log
+    void appendRecord(uint8_t op, std::string_view key, std::string_view value);
+
+    // Compact the log on JobSystem, the records appended meanwhile are kept
+    void scheduleCompaction();
+
+    void finishCompaction();
+
+    // Rename the compacted log at path over the log and map it, then append the tail records
+    bool replaceLog(const std::string& path, int compactedSize, std::string_view tail);
+
     // The low level API of all getXXXForKey
     const std::string* getValueForKey(std::string_view key);
 
@@ -289,9 +318,12 @@ protected:
     FileStream _fileStream;  // the file handle for data persistence
     std::shared_ptr<mio::mmap_sink> _rwmmap;
     int _curMapSize   = 4096;  // init mapsize is 4K
-    int _realSize     = 0;     // real data size without key/value entities count field
+    int _realSize     = 0;     // real size of the records in log, without the log header
+    int _compactedSize = 0;    // records size after the last compaction, the estimated size of live values
     bool _initialized = false;
 
+    std::shared_ptr<UserDefaultCompaction> _compaction;  // the compaction in progress
+
     // encrpyt args
     bool _encryptEnabled = false;
     std::string _key;
@@ -22,6 +22,8 @@ This file was modified to fit the axmol project
 
 #include "math/MathUtil.h"
 #include "math/Mat4.h"
+#include "math/Vec2.h"
+#include "math/AffineTransform.h"
 #include "base/Macros.h"
 
 #if (AX_TARGET_PLATFORM == AX_PLATFORM_ANDROID)
@@ -317,4 +319,16 @@ void MathUtil::transformIndices(uint16_t* dst, const uint16_t* src, size_t count
 #endif
 }
 
+void MathUtil::transformPoints(Vec2* dst, const Vec2* src, size_t count, const AffineTransform& t)
+{
+    static_assert(sizeof(Vec2) == 8);
+#if defined(AX_SSE_INTRINSICS)
+    MathUtilSSE::transformPoints(dst, src, count, t);
+#elif defined(AX_NEON_INTRINSICS) && AX_64BITS
+    MathUtilNeon::transformPoints(dst, src, count, t);
+#else
+    MathUtilC::transformPoints(dst, src, count, t);
+#endif
+}
+
 NS_AX_MATH_END
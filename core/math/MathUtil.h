@@ -29,6 +29,7 @@
 
 NS_AX_BEGIN
     struct V3F_C4B_T2F;
+    struct AffineTransform;
 NS_AX_END
 
 /**
@@ -38,6 +39,7 @@ NS_AX_END
 
 NS_AX_MATH_BEGIN
 
+class Vec2;
 class Vec4;
 
 /**
@@ -50,6 +52,7 @@ class AX_DLL MathUtil
     friend class Mat4;
     friend class Vec3;
     friend class Renderer;
+    friend class DrawNode;
 
 public:
     /**
@@ -120,6 +123,9 @@ private:
 
     static void transformVertices(V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, size_t count, const Mat4& transform);
     static void transformIndices(uint16_t* dst, const uint16_t* src, size_t count, uint16_t offset);
+
+    // Apply a 2D affine transform to count points, dst may be src
+    static void transformPoints(Vec2* dst, const Vec2* src, size_t count, const AffineTransform& t);
 };
 
 NS_AX_MATH_END
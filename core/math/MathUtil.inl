@@ -219,6 +219,17 @@ public:
             ++src;
         }
     }
+
+    inline static void transformPoints(Vec2* dst, const Vec2* src, size_t count, const AffineTransform& t)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            float x  = src[i].x;
+            float y  = src[i].y;
+            dst[i].x = t.a * x + t.c * y + t.tx;
+            dst[i].y = t.b * x + t.d * y + t.ty;
+        }
+    }
 };
 
 NS_AX_MATH_END
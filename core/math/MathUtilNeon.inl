@@ -279,6 +279,36 @@ struct MathUtilNeon
             --count;
         }
     }
+
+    inline static void transformPoints(Vec2* dst, const Vec2* src, size_t count, const AffineTransform& t)
+    {
+        // Two points per register: [x0, y0, x1, y1]
+        const float cx[4] = {t.a, t.b, t.a, t.b};
+        const float cy[4] = {t.c, t.d, t.c, t.d};
+        const float ct[4] = {t.tx, t.ty, t.tx, t.ty};
+        float32x4_t mx    = vld1q_f32(cx);
+        float32x4_t my    = vld1q_f32(cy);
+        float32x4_t mt    = vld1q_f32(ct);
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            float32x4_t v0 = vld1q_f32(&src[i].x);
+            float32x4_t v1 = vld1q_f32(&src[i + 2].x);
+            float32x4_t r0 = vmlaq_f32(vmlaq_f32(mt, mx, vtrn1q_f32(v0, v0)), my, vtrn2q_f32(v0, v0));
+            float32x4_t r1 = vmlaq_f32(vmlaq_f32(mt, mx, vtrn1q_f32(v1, v1)), my, vtrn2q_f32(v1, v1));
+            vst1q_f32(&dst[i].x, r0);
+            vst1q_f32(&dst[i + 2].x, r1);
+        }
+
+        for (; i < count; ++i)
+        {
+            float x  = src[i].x;
+            float y  = src[i].y;
+            dst[i].x = t.a * x + t.c * y + t.tx;
+            dst[i].y = t.b * x + t.d * y + t.ty;
+        }
+    }
 #else
     inline static void transformVertices(ax::V3F_C4B_T2F* dst,
                                          const ax::V3F_C4B_T2F* src,
@@ -269,6 +269,37 @@ struct MathUtilSSE
             dst[rounded_count + i] = src[rounded_count + i] + offset;
         }
     }
+
+    static void transformPoints(Vec2* dst, const Vec2* src, size_t count, const AffineTransform& t)
+    {
+        // Two points per register: [x0, y0, x1, y1]
+        __m128 mx = _mm_setr_ps(t.a, t.b, t.a, t.b);
+        __m128 my = _mm_setr_ps(t.c, t.d, t.c, t.d);
+        __m128 mt = _mm_setr_ps(t.tx, t.ty, t.tx, t.ty);
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 v0 = _mm_loadu_ps(&src[i].x);
+            __m128 v1 = _mm_loadu_ps(&src[i + 2].x);
+            __m128 r0 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(mx, _mm_shuffle_ps(v0, v0, _MM_SHUFFLE(2, 2, 0, 0))),
+                                              _mm_mul_ps(my, _mm_shuffle_ps(v0, v0, _MM_SHUFFLE(3, 3, 1, 1)))),
+                                   mt);
+            __m128 r1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(mx, _mm_shuffle_ps(v1, v1, _MM_SHUFFLE(2, 2, 0, 0))),
+                                              _mm_mul_ps(my, _mm_shuffle_ps(v1, v1, _MM_SHUFFLE(3, 3, 1, 1)))),
+                                   mt);
+            _mm_storeu_ps(&dst[i].x, r0);
+            _mm_storeu_ps(&dst[i + 2].x, r1);
+        }
+
+        for (; i < count; ++i)
+        {
+            float x  = src[i].x;
+            float y  = src[i].y;
+            dst[i].x = t.a * x + t.c * y + t.tx;
+            dst[i].y = t.b * x + t.d * y + t.ty;
+        }
+    }
 };
 
 #endif
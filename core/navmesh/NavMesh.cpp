@@ -26,11 +26,16 @@
 #include "navmesh/NavMesh.h"
 #if defined(AX_ENABLE_NAVMESH)
 
+#    include "base/Director.h"
+#    include "base/JobSystem.h"
 #    include "platform/FileUtils.h"
 #    include "renderer/Renderer.h"
 #    include "recast/DetourCommon.h"
 #    include "recast/DetourDebugDraw.h"
+#    include <atomic>
+#    include <climits>
 #    include <sstream>
+#    include <thread>
 
 NS_AX_BEGIN
 
@@ -89,6 +94,39 @@ static unsigned char* parseRow(unsigned char* buf, unsigned char* bufEnd, char*
 static const int TILECACHESET_MAGIC   = 'T' << 24 | 'S' << 16 | 'E' << 8 | 'T';  //'TSET';
 static const int TILECACHESET_VERSION = 1;
 static const int MAX_AGENTS           = 128;
+static const int MAX_POLYS            = 256;
+static const int MAX_SMOOTH           = 2048;
+static const float POLY_EXTENTS[3]    = {2, 4, 2};
+
+struct NavMesh::PathQuery
+{
+    dtNavMeshQuery* navMeshQuery = nullptr;
+    dtQueryFilter filter;                  // referenced by the sliced pathfinding
+    std::deque<PathRequest> requests;      // the assigned requests, run in order
+    std::vector<std::vector<Vec3>> paths;  // the paths of the first finished requests
+    bool sliced        = false;            // the sliced pathfinding of the first unfinished request initialized
+    dtPolyRef startRef = 0;
+
+    bool finished() const { return paths.size() == requests.size(); }
+};
+
+struct NavMesh::PathQueryBatch
+{
+    std::vector<PathQuery*> queries;
+    int iterations;
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> done{0};
+
+    // run the queries not claimed yet, on the job threads and by joinPathQueries
+    void run()
+    {
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < queries.size();)
+        {
+            NavMesh::runPathQuery(*queries[i], iterations);
+            done.fetch_add(1, std::memory_order_release);
+        }
+    }
+};
 
 NavMesh* NavMesh::create(std::string_view navFilePath, std::string_view geomFilePath)
 {
@@ -116,6 +154,12 @@ NavMesh::NavMesh()
 
 NavMesh::~NavMesh()
 {
+    joinPathQueries();
+    for (auto&& query : _pathQueries)
+    {
+        dtFreeNavMeshQuery(query->navMeshQuery);
+        delete query;
+    }
     dtFreeTileCache(_tileCache);
     dtFreeCrowd(_crowed);
     dtFreeNavMesh(_navMesh);
@@ -478,6 +522,25 @@ void NavMesh::debugDraw(Renderer* renderer)
 
 void NavMesh::update(float dt)
 {
+    // the path queries read the navmesh, finish them before it's modified
+    joinPathQueries();
+    std::vector<std::pair<PathCallback, std::vector<Vec3>>> results;
+    for (auto&& query : _pathQueries)
+    {
+        for (auto&& path : query->paths)
+        {
+            auto& request = query->requests.front();
+            if (request.callback)
+                results.emplace_back(std::move(request.callback), std::move(path));
+            query->requests.pop_front();
+        }
+        query->paths.clear();
+    }
+    for (auto&& result : results)
+    {
+        result.first(result.second);
+    }
+
     for (auto&& iter : _agentList)
     {
         if (iter)
@@ -507,24 +570,183 @@ void NavMesh::update(float dt)
         if (iter)
             iter->postUpdate(dt);
     }
+
+    dispatchPathQueries();
+}
+
+unsigned int NavMesh::findPathAsync(const Vec3& start, const Vec3& end, PathCallback callback)
+{
+    _pathRequests.emplace_back(PathRequest{++_pathRequestId, start, end, std::move(callback)});
+    return _pathRequestId;
+}
+
+void NavMesh::cancelPathRequest(unsigned int requestId)
+{
+    auto iter = std::find_if(_pathRequests.begin(), _pathRequests.end(),
+                             [requestId](const PathRequest& request) { return request.id == requestId; });
+    if (iter != _pathRequests.end())
+    {
+        _pathRequests.erase(iter);
+        return;
+    }
+
+    // a running query only reads the positions of its requests
+    for (auto&& query : _pathQueries)
+    {
+        for (auto&& request : query->requests)
+        {
+            if (request.id == requestId)
+                request.callback = nullptr;
+        }
+    }
+}
+
+void NavMesh::setPathQueryCount(int count)
+{
+    joinPathQueries();
+    _pathQueryCount = std::max(count, 1);
+    while ((int)_pathQueries.size() > _pathQueryCount)
+    {
+        // restart the requests of the removed query not delivered yet
+        auto query = _pathQueries.back();
+        for (auto iter = query->requests.rbegin(); iter != query->requests.rend(); ++iter)
+            _pathRequests.emplace_front(std::move(*iter));
+        dtFreeNavMeshQuery(query->navMeshQuery);
+        delete query;
+        _pathQueries.pop_back();
+    }
+}
+
+void NavMesh::setPathQueryIterations(int iterations)
+{
+    _pathQueryIterations = iterations;
+}
+
+size_t NavMesh::getPendingPathRequestCount() const
+{
+    size_t count = _pathRequests.size();
+    for (auto&& query : _pathQueries)
+        count += query->requests.size();
+    return count;
+}
+
+void NavMesh::dispatchPathQueries()
+{
+    if (!_navMesh || (_pathRequests.empty() && _pathQueries.empty()))
+        return;
+
+    while ((int)_pathQueries.size() < _pathQueryCount)
+    {
+        auto query          = new PathQuery();
+        query->navMeshQuery = dtAllocNavMeshQuery();
+        query->navMeshQuery->init(_navMesh, 2048);
+        _pathQueries.emplace_back(query);
+    }
+
+    // share the pending requests between the queries, a query runs its requests one after another until its
+    // iterations are spent, so the requests finished per update aren't bound to the amount of queries
+    size_t pending = _pathRequests.size();
+    for (auto&& query : _pathQueries)
+        pending += query->requests.size() - query->paths.size();
+    const size_t share = (pending + _pathQueries.size() - 1) / _pathQueries.size();
+
+    auto batch        = std::make_shared<PathQueryBatch>();
+    batch->iterations = _pathQueryIterations > 0 ? _pathQueryIterations : INT_MAX;
+    for (auto&& query : _pathQueries)
+    {
+        while (query->requests.size() - query->paths.size() < share && !_pathRequests.empty())
+        {
+            query->requests.emplace_back(std::move(_pathRequests.front()));
+            _pathRequests.pop_front();
+        }
+        if (!query->finished())
+            batch->queries.emplace_back(query);
+    }
+    if (batch->queries.empty())
+        return;
+
+    auto jobSystem = Director::getInstance()->getJobSystem();
+    for (size_t i = 0; i < batch->queries.size(); ++i)
+    {
+        jobSystem->enqueue([batch]() { batch->run(); });
+    }
+    _pathQueryBatch = std::move(batch);
+}
+
+void NavMesh::joinPathQueries()
+{
+    if (!_pathQueryBatch)
+        return;
+
+    // run the queries the busy job threads haven't started, then wait the running ones
+    auto batch = std::move(_pathQueryBatch);
+    batch->run();
+    while (batch->done.load(std::memory_order_acquire) < batch->queries.size())
+        std::this_thread::yield();
+}
+
+void NavMesh::runPathQuery(PathQuery& query, int iterations)
+{
+    // a request costs one iteration at least, so the iterations bound the requests run per update
+    auto navMeshQuery = query.navMeshQuery;
+    while (!query.finished() && iterations > 0)
+    {
+        auto& request = query.requests[query.paths.size()];
+        if (!query.sliced)
+        {
+            dtPolyRef endRef = 0;
+            navMeshQuery->findNearestPoly(&request.start.x, POLY_EXTENTS, &query.filter, &query.startRef, 0);
+            navMeshQuery->findNearestPoly(&request.end.x, POLY_EXTENTS, &query.filter, &endRef, 0);
+            dtStatus status = navMeshQuery->initSlicedFindPath(query.startRef, endRef, &request.start.x,
+                                                               &request.end.x, &query.filter);
+            if (dtStatusFailed(status))
+            {
+                query.paths.emplace_back();
+                --iterations;
+                continue;
+            }
+            query.sliced = true;
+        }
+
+        int doneIterations = 0;
+        dtStatus status    = navMeshQuery->updateSlicedFindPath(iterations, &doneIterations);
+        iterations -= std::max(doneIterations, 1);
+        if (dtStatusInProgress(status))
+            return;  // continue in the next update
+
+        auto& pathPoints = query.paths.emplace_back();
+        if (dtStatusSucceed(status))
+        {
+            dtPolyRef polys[MAX_POLYS];
+            int npolys = 0;
+            navMeshQuery->finalizeSlicedFindPath(polys, &npolys, MAX_POLYS);
+            findSmoothPath(navMeshQuery, query.startRef, polys, npolys, request.start, request.end, pathPoints);
+        }
+        query.sliced = false;
+    }
 }
 
 void ax::NavMesh::findPath(const Vec3& start, const Vec3& end, std::vector<Vec3>& pathPoints)
 {
-    static const int MAX_POLYS  = 256;
-    static const int MAX_SMOOTH = 2048;
-    float ext[3];
-    ext[0] = 2;
-    ext[1] = 4;
-    ext[2] = 2;
     dtQueryFilter filter;
     dtPolyRef startRef, endRef;
     dtPolyRef polys[MAX_POLYS];
     int npolys = 0;
-    _navMeshQuery->findNearestPoly(&start.x, ext, &filter, &startRef, 0);
-    _navMeshQuery->findNearestPoly(&end.x, ext, &filter, &endRef, 0);
+    _navMeshQuery->findNearestPoly(&start.x, POLY_EXTENTS, &filter, &startRef, 0);
+    _navMeshQuery->findNearestPoly(&end.x, POLY_EXTENTS, &filter, &endRef, 0);
     _navMeshQuery->findPath(startRef, endRef, &start.x, &end.x, &filter, polys, &npolys, MAX_POLYS);
+    findSmoothPath(_navMeshQuery, startRef, polys, npolys, start, end, pathPoints);
+}
 
+void NavMesh::findSmoothPath(dtNavMeshQuery* navMeshQuery,
+                             dtPolyRef startRef,
+                             dtPolyRef* polys,
+                             int npolys,
+                             const Vec3& start,
+                             const Vec3& end,
+                             std::vector<Vec3>& pathPoints)
+{
+    dtQueryFilter filter;
     if (npolys)
     {
         //// Iterate over the path to find smooth path on the detail mesh surface.
@@ -533,8 +755,8 @@ void ax::NavMesh::findPath(const Vec3& start, const Vec3& end, std::vector<Vec3>
         // int npolys = npolys;
 
         float iterPos[3], targetPos[3];
-        _navMeshQuery->closestPointOnPoly(startRef, &start.x, iterPos, 0);
-        _navMeshQuery->closestPointOnPoly(polys[npolys - 1], &end.x, targetPos, 0);
+        navMeshQuery->closestPointOnPoly(startRef, &start.x, iterPos, 0);
+        navMeshQuery->closestPointOnPoly(polys[npolys - 1], &end.x, targetPos, 0);
 
         static const float STEP_SIZE = 0.5f;
         static const float SLOP      = 0.01f;
@@ -555,7 +777,7 @@ void ax::NavMesh::findPath(const Vec3& start, const Vec3& end, std::vector<Vec3>
             unsigned char steerPosFlag;
             dtPolyRef steerPosRef;
 
-            if (!getSteerTarget(_navMeshQuery, iterPos, targetPos, SLOP, polys, npolys, steerPos, steerPosFlag,
+            if (!getSteerTarget(navMeshQuery, iterPos, targetPos, SLOP, polys, npolys, steerPos, steerPosFlag,
                                 steerPosRef))
                 break;
 
@@ -578,13 +800,13 @@ void ax::NavMesh::findPath(const Vec3& start, const Vec3& end, std::vector<Vec3>
             float result[3];
             dtPolyRef visited[16];
             int nvisited = 0;
-            _navMeshQuery->moveAlongSurface(polys[0], iterPos, moveTgt, &filter, result, visited, &nvisited, 16);
+            navMeshQuery->moveAlongSurface(polys[0], iterPos, moveTgt, &filter, result, visited, &nvisited, 16);
 
             npolys = fixupCorridor(polys, npolys, MAX_POLYS, visited, nvisited);
-            npolys = fixupShortcuts(polys, npolys, _navMeshQuery);
+            npolys = fixupShortcuts(polys, npolys, navMeshQuery);
 
             float h = 0;
-            _navMeshQuery->getPolyHeight(polys[0], result, &h);
+            navMeshQuery->getPolyHeight(polys[0], result, &h);
             result[1] = h;
             dtVcopy(iterPos, result);
 
@@ -621,7 +843,7 @@ void ax::NavMesh::findPath(const Vec3& start, const Vec3& end, std::vector<Vec3>
                 npolys -= npos;
 
                 // Handle the connection.
-                dtStatus status = _navMesh->getOffMeshConnectionPolyEndPoints(prevRef, polyRef, startPos, endPos);
+                dtStatus status = navMeshQuery->getAttachedNavMesh()->getOffMeshConnectionPolyEndPoints(prevRef, polyRef, startPos, endPos);
                 if (dtStatusSucceed(status))
                 {
                     if (nsmoothPath < MAX_SMOOTH)
@@ -642,7 +864,7 @@ void ax::NavMesh::findPath(const Vec3& start, const Vec3& end, std::vector<Vec3>
                     // Move position at the other side of the off-mesh link.
                     dtVcopy(iterPos, endPos);
                     float eh = 0.0f;
-                    _navMeshQuery->getPolyHeight(polys[0], iterPos, &eh);
+                    navMeshQuery->getPolyHeight(polys[0], iterPos, &eh);
                     iterPos[1] = eh;
                 }
             }
@@ -36,6 +36,9 @@
 #    include "recast/DetourNavMeshQuery.h"
 #    include "recast/DetourCrowd.h"
 #    include "recast/DetourTileCache.h"
+#    include <deque>
+#    include <functional>
+#    include <memory>
 #    include <string>
 #    include <vector>
 
@@ -55,6 +58,9 @@ class Renderer;
 class AX_DLL NavMesh : public Object
 {
 public:
+    /** The callback of findPathAsync, pathPoints is empty if no path found */
+    typedef std::function<void(const std::vector<Vec3>& pathPoints)> PathCallback;
+
     /**
     Create navmesh
 
@@ -96,6 +102,34 @@ public:
     */
     void findPath(const Vec3& start, const Vec3& end, std::vector<Vec3>& pathPoints);
 
+    /**
+    find a path on navmesh on the job threads.
+    The queries run between two updates, so the navmesh isn't modified meanwhile,
+    the callback is invoked on axmol thread by a later update.
+
+    @param start The start search position in world coordinate system.
+    @param end The end search position in world coordinate system.
+    @param callback Receives the key points of path.
+    @return The request id to cancel the request.
+    */
+    unsigned int findPathAsync(const Vec3& start, const Vec3& end, PathCallback callback);
+
+    /** cancel a path request, its callback won't be invoked. */
+    void cancelPathRequest(unsigned int requestId);
+
+    /** Set the amount of the path queries run in parallel, each owns a dtNavMeshQuery, 4 by default. */
+    void setPathQueryCount(int count);
+
+    /**
+    Set the max Detour iterations of each path query per update. The pending requests are shared between the queries,
+    each query runs its requests one after another until the iterations are spent, a longer path is time sliced over
+    several updates. 0 by default, which finishes all the pending requests in one update.
+    */
+    void setPathQueryIterations(int iterations);
+
+    /** The amount of the path requests not delivered yet. */
+    size_t getPendingPathRequestCount() const;
+
     NavMesh();
     virtual ~NavMesh();
 
@@ -109,6 +143,20 @@ protected:
     void drawObstacles();
     void drawOffMeshConnections();
 
+    struct PathQuery;
+    struct PathQueryBatch;
+
+    static void findSmoothPath(dtNavMeshQuery* navMeshQuery,
+                               dtPolyRef startRef,
+                               dtPolyRef* polys,
+                               int npolys,
+                               const Vec3& start,
+                               const Vec3& end,
+                               std::vector<Vec3>& pathPoints);
+    static void runPathQuery(PathQuery& query, int iterations);
+    void dispatchPathQueries();
+    void joinPathQueries();
+
 protected:
     dtNavMesh* _navMesh;
     dtNavMeshQuery* _navMeshQuery;
@@ -125,6 +173,20 @@ protected:
     std::string _navFilePath;
     std::string _geomFilePath;
     bool _isDebugDrawEnabled;
+
+    struct PathRequest
+    {
+        unsigned int id;
+        Vec3 start;
+        Vec3 end;
+        PathCallback callback;
+    };
+    std::deque<PathRequest> _pathRequests;
+    std::vector<PathQuery*> _pathQueries;
+    std::shared_ptr<PathQueryBatch> _pathQueryBatch;  // the queries running on the job threads
+    unsigned int _pathRequestId = 0;
+    int _pathQueryCount         = 4;
+    int _pathQueryIterations    = 0;
 };
 
 /** @} */
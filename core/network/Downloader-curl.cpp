@@ -40,6 +40,7 @@
 #    include "network/Downloader.h"
 #    include "platform/FileStream.h"
 #    include "openssl/md5.h"
+#    include "xxhash.h"
 #    include "yasio/xxsocket.hpp"
 #    include "yasio/thread_name.hpp"
 
@@ -60,6 +61,13 @@ enum
     kCheckSumStateFailed  = 1 << 1,
 };
 
+// The segments journal stored beside the temp file of a segmented file task
+#    define AX_DL_SEGMENTS_MAGIC   0x53444841  // 'AHDS'
+#    define AX_DL_SEGMENTS_VERSION 1
+#    define AX_DL_MAX_SEGMENTS     64
+#    define AX_DL_IO_CHUNK_SIZE    (64 * 1024)
+#    define AX_DL_DIGEST_CHUNKS    4  // chunks of the file digested per loop of the download thread
+
 NS_AX_BEGIN
 
 namespace network
@@ -79,6 +87,48 @@ class DownloadTaskCURL : public IDownloadTask
 public:
     int serialId;
     DownloaderCURL& owner;
+    const DownloadTask* task = nullptr;  // the task owns this
+
+    // on-disk layout of the segments journal: SegmentsHeader followed by SegmentRecord[count]
+    struct SegmentsHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        int64_t totalBytes;  // -1: unknown
+        uint32_t count;
+        uint32_t acceptRanges;
+    };
+
+    struct SegmentRecord
+    {
+        int64_t begin;
+        int64_t end;  // inclusive, -1: until EOF
+        int64_t received;
+        uint64_t digest;  // XXH64 of the received bytes, verified before resume
+    };
+
+    struct Segment
+    {
+        Segment(DownloadTaskCURL* o, uint32_t i, const SegmentRecord& r) : owner(o), index(i), record(r)
+        {
+            hashState = XXH64_createState();
+            XXH64_reset(hashState, 0);
+        }
+        ~Segment() { XXH64_freeState(hashState); }
+
+        int64_t length() const { return record.end < 0 ? -1 : record.end - record.begin + 1; }
+        bool completed() const { return record.end >= 0 && record.received == length(); }
+
+        DownloadTaskCURL* owner;
+        uint32_t index;
+        SegmentRecord record;
+        XXH64_state_t* hashState;
+        CURL* curl          = nullptr;
+        double speed        = 0;
+        bool rangeRequested = false;
+        bool statusChecked  = false;
+        bool rangeIgnored   = false;
+    };
 
     DownloadTaskCURL(DownloaderCURL& o) : serialId(_sSerialId++), owner(o), _requestHeaders(nullptr)
 
@@ -101,6 +151,7 @@ public:
 
         _fs.reset();
         _fsMd5.reset();
+        _fsSegments.reset();
 
         if (_requestHeaders)
             curl_slist_free_all(_requestHeaders);
@@ -108,7 +159,7 @@ public:
         AXLOGD("Destruct DownloadTaskCURL {}", fmt::ptr(this));
     }
 
-    bool init(std::string_view filename, std::string_view tempSuffix)
+    bool init(std::string_view filename, std::string_view tempSuffix, bool segmented)
     {
         if (0 == filename.length())
         {
@@ -160,6 +211,12 @@ public:
                     break;
                 }
             }
+            if (segmented)
+            {
+                ret = _openSegmentedFiles();
+                break;
+            }
+
             // open file
             _fs = FileUtils::getInstance()->openFileStream(_tempFileName, IFileStream::Mode::APPEND);
             if (!_fs)
@@ -291,6 +348,9 @@ public:
                 _fsMd5->seek(0, SEEK_SET);
                 _fsMd5->write(&_md5State, sizeof(_md5State));
             }
+
+            if (_fs && owner.onTaskData)
+                owner.onTaskData(*task, _totalBytesReceived - ret, buffer, ret);
         }
 
         curl_easy_getinfo(_curl, CURLINFO_SPEED_DOWNLOAD, &_speed);
@@ -298,14 +358,276 @@ public:
         return ret;
     }
 
+    size_t writeSegmentDataProc(Segment& seg, unsigned char* buffer, size_t size, size_t count)
+    {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+        auto bytes_transferred = static_cast<int64_t>(size * count);
+
+        if (!seg.statusChecked)
+        {
+            // a server ignores the Range header replies the whole file with 200
+            long responseCode = 0;
+            curl_easy_getinfo(seg.curl, CURLINFO_RESPONSE_CODE, &responseCode);
+            if (seg.rangeRequested && responseCode != 206)
+            {
+                seg.rangeIgnored = true;
+                return 0;
+            }
+            seg.statusChecked = true;
+        }
+
+        auto length = seg.length();
+        if (length >= 0 && seg.record.received + bytes_transferred > length)
+            return 0;  // more data than requested, abort with CURLE_WRITE_ERROR
+
+        _fs->seek(seg.record.begin + seg.record.received, SEEK_SET);
+        auto ret = _fs->write(buffer, static_cast<unsigned int>(bytes_transferred));
+        if (ret <= 0)
+            return 0;
+
+        XXH64_update(seg.hashState, buffer, ret);
+        if (_digestOffset == seg.record.begin + seg.record.received)
+        {  // the bytes continue the digested ones, digest them while they're in memory
+            ::MD5_Update(&_md5State, buffer, ret);
+            _digestOffset += ret;
+        }
+        seg.record.received += ret;
+        seg.record.digest = XXH64_digest(seg.hashState);
+        _saveSegmentProc(seg);
+
+        _bytesReceived += ret;
+        _totalBytesReceived += ret;
+
+        curl_easy_getinfo(seg.curl, CURLINFO_SPEED_DOWNLOAD, &seg.speed);
+        _speed = 0;
+        for (auto&& item : _segments)
+            _speed += item->speed;
+
+        return ret;
+    }
+
+    /*
+     * Load the segments journal of an interrupted download, the received bytes of every segment are
+     * verified by the xxhash stored with them, a mismatched segment is downloaded again from its begin.
+     * retval: false if there is no valid journal
+     */
+    bool loadSegmentsProc()
+    {
+        SegmentsHeader header{};
+        _fsSegments->seek(0, SEEK_SET);
+        if (_fsSegments->read(&header, sizeof(header)) != sizeof(header) || header.magic != AX_DL_SEGMENTS_MAGIC ||
+            header.version != AX_DL_SEGMENTS_VERSION || header.count == 0 || header.count > AX_DL_MAX_SEGMENTS)
+            return false;
+
+        std::vector<SegmentRecord> records(header.count);
+        const int recordsSize = static_cast<int>(sizeof(SegmentRecord) * header.count);
+        if (_fsSegments->read(records.data(), recordsSize) != recordsSize)
+            return false;
+
+        _segments.clear();
+        _acceptRanges       = header.acceptRanges != 0;
+        _totalBytesExpected = header.totalBytes;
+        _totalBytesReceived = 0;
+
+        std::unique_ptr<uint8_t[]> buf;
+        for (uint32_t i = 0; i < header.count; ++i)
+        {
+            auto& seg = *_segments.emplace_back(std::make_unique<Segment>(this, i, records[i]));
+            if (seg.record.received > 0 && !(_acceptRanges && _rehashSegmentProc(seg, buf)))
+            {
+                AXLOGD("DownloadTaskCURL: discard segment {} of {}", i, _tempFileName);
+                XXH64_reset(seg.hashState, 0);
+                seg.record.received = 0;
+                seg.record.digest   = 0;
+                _saveSegmentProc(seg);
+                if (seg.record.end < 0)
+                    _fs->resize(seg.record.begin);  // drop the stale tail of stream
+            }
+            _totalBytesReceived += seg.record.received;
+        }
+        _transferOffset = _totalBytesReceived;
+        return true;
+    }
+
+    // Split the file into segments by the header info replied to the probe request
+    void planSegmentsProc(int64_t contentLength, uint32_t maxSegments, int64_t minSizeOfSegment)
+    {
+        uint32_t count = 1;
+        if (_acceptRanges && minSizeOfSegment > 0 && contentLength >= 2 * minSizeOfSegment)
+            count = static_cast<uint32_t>(std::min<int64_t>(
+                {static_cast<int64_t>(maxSegments), AX_DL_MAX_SEGMENTS, contentLength / minSizeOfSegment}));
+
+        _segments.clear();
+        if (contentLength > 0)
+        {
+            const int64_t step = contentLength / count;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                SegmentRecord record{i * step, i + 1 < count ? (i + 1) * step - 1 : contentLength - 1, 0, 0};
+                _segments.emplace_back(std::make_unique<Segment>(this, i, record));
+            }
+        }
+        else  // unknown size, download as one stream
+            _segments.emplace_back(std::make_unique<Segment>(this, 0, SegmentRecord{0, -1, 0, 0}));
+
+        _totalBytesExpected = contentLength > 0 ? contentLength : -1;
+        _totalBytesReceived = _transferOffset = 0;
+        _fs->resize(std::max<int64_t>(contentLength, 0));
+
+        SegmentsHeader header{AX_DL_SEGMENTS_MAGIC, AX_DL_SEGMENTS_VERSION, _totalBytesExpected,
+                              static_cast<uint32_t>(_segments.size()), _acceptRanges ? 1u : 0u};
+        _fsSegments->resize(0);
+        _fsSegments->seek(0, SEEK_SET);
+        _fsSegments->write(&header, sizeof(header));
+        for (auto&& seg : _segments)
+            _saveSegmentProc(*seg);
+    }
+
+    // retval: false if the segment is broken, the error is set
+    bool completeSegmentProc(Segment& seg, CURLcode errCode)
+    {
+        seg.curl = nullptr;
+        if (seg.rangeIgnored)
+        {
+            setErrorDesc(DownloadTask::ERROR_IMPL_INTERNAL, CURLE_RANGE_ERROR,
+                         "The server ignored the range request of segment.");
+            return false;
+        }
+        if (CURLE_OK != errCode)
+            return false;
+
+        if (seg.record.end < 0)
+        {  // the stream of unknown size reached EOF
+            if (seg.record.received > 0)
+            {
+                seg.record.end = seg.record.begin + seg.record.received - 1;
+                _saveSegmentProc(seg);
+            }
+            _totalBytesExpected = _totalBytesReceived;
+        }
+        else if (!seg.completed())
+        {
+            setErrorDesc(DownloadTask::ERROR_IMPL_INTERNAL, CURLE_PARTIAL_FILE,
+                         fmt::format("Segment {} incomplete, received: {}, required: {}", seg.index,
+                                     seg.record.received, seg.length()));
+            return false;
+        }
+        return true;
+    }
+
+    bool hasRunningSegments() const
+    {
+        for (auto&& seg : _segments)
+            if (seg->curl)
+                return true;
+        return false;
+    }
+
+    /*
+     * The md5 of segmented file is calculated in file order, the bytes received ahead of the digested ones, by the
+     * later segments or the previous session, are read back from the file at most AX_DL_DIGEST_CHUNKS chunks per
+     * call, so a large file doesn't stall the other transfers of the download thread.
+     * retval: true if all received bytes are digested, or the file can't be read and the error is set
+     */
+    bool digestStepProc()
+    {
+        if (!_digestBuf)
+            _digestBuf.reset(new uint8_t[AX_DL_IO_CHUNK_SIZE]);
+
+        for (int step = 0; step < AX_DL_DIGEST_CHUNKS; ++step)
+        {
+            auto it = std::find_if(_segments.begin(), _segments.end(), [this](auto& seg) {
+                return seg->record.begin <= _digestOffset && _digestOffset < seg->record.begin + seg->record.received;
+            });
+            if (it == _segments.end())
+                return true;
+
+            auto remain = (*it)->record.begin + (*it)->record.received - _digestOffset;
+            _fs->seek(_digestOffset, SEEK_SET);
+            auto n = _fs->read(_digestBuf.get(),
+                               static_cast<unsigned int>(std::min<int64_t>(remain, AX_DL_IO_CHUNK_SIZE)));
+            if (n <= 0)
+            {
+                setErrorDesc(DownloadTask::ERROR_IMPL_INTERNAL, 0, "Can't read file:" + _tempFileName);
+                return true;
+            }
+            ::MD5_Update(&_md5State, _digestBuf.get(), n);
+            _digestOffset += n;
+        }
+        return false;
+    }
+
+    void removeSegmentsFile()
+    {
+        if (_segmented)
+            FileUtils::getInstance()->removeFile(_segmentsFileName);
+    }
+
 private:
     friend class DownloaderCURL;
 
+    bool _openSegmentedFiles()
+    {
+        _segmented = true;
+
+        // open without truncation, segments write to the file randomly
+        _fs = FileUtils::getInstance()->openFileStream(_tempFileName, IFileStream::Mode::OVERLAPPED);
+        if (!_fs)
+        {
+            _errCode         = DownloadTask::ERROR_OPEN_FILE_FAILED;
+            _errCodeInternal = 0;
+            _errDescription  = "Can't open file:";
+            _errDescription.append(_tempFileName);
+            return false;
+        }
+
+        _segmentsFileName = _tempFileName + ".segments";
+        _fsSegments = FileUtils::getInstance()->openFileStream(_segmentsFileName, IFileStream::Mode::OVERLAPPED);
+        if (!_fsSegments)
+        {
+            _errCode         = DownloadTask::ERROR_OPEN_FILE_FAILED;
+            _errCodeInternal = 0;
+            _errDescription  = "Can't open segments file:";
+            _errDescription.append(_segmentsFileName);
+            return false;
+        }
+
+        MD5_Init(&_md5State);
+        _digestOffset = 0;
+        return true;
+    }
+
+    void _saveSegmentProc(const Segment& seg)
+    {
+        _fsSegments->seek(sizeof(SegmentsHeader) + sizeof(SegmentRecord) * seg.index, SEEK_SET);
+        _fsSegments->write(&seg.record, sizeof(SegmentRecord));
+    }
+
+    bool _rehashSegmentProc(Segment& seg, std::unique_ptr<uint8_t[]>& buf)
+    {
+        if (!buf)
+            buf.reset(new uint8_t[AX_DL_IO_CHUNK_SIZE]);
+
+        XXH64_reset(seg.hashState, 0);
+        _fs->seek(seg.record.begin, SEEK_SET);
+        int64_t remain = seg.record.received;
+        while (remain > 0)
+        {
+            auto n = _fs->read(buf.get(), static_cast<unsigned int>(std::min<int64_t>(remain, AX_DL_IO_CHUNK_SIZE)));
+            if (n <= 0)
+                return false;
+            XXH64_update(seg.hashState, buf.get(), n);
+            remain -= n;
+        }
+        return XXH64_digest(seg.hashState) == seg.record.digest;
+    }
+
     // for lock object instance
     std::recursive_mutex _mutex;
 
     // header info
-    bool _acceptRanges;
+    bool _acceptRanges = false;
     int64_t _totalBytesExpected;
 
     double _speed;
@@ -335,6 +657,15 @@ private:
     // calculate md5 in downloading time support
     std::unique_ptr<IFileStream> _fsMd5{};  // store md5 state realtime
     MD5state_st _md5State;
+    int64_t _digestOffset = 0;  // the bytes of segmented file digested by _md5State, from the begin of file
+    std::unique_ptr<uint8_t[]> _digestBuf;
+
+    // segmented download support
+    bool _segmented = false;
+    CURL* _probeCurl = nullptr;
+    std::string _segmentsFileName;
+    std::unique_ptr<IFileStream> _fsSegments{};  // store segments journal realtime
+    std::vector<std::unique_ptr<Segment>> _segments;
 
     void _initInternal()
     {
@@ -450,6 +781,35 @@ private:
         return coTask->writeDataProc((unsigned char*)buffer, size, count);
     }
 
+    static size_t _outputSegmentDataCallbackProc(void* buffer,
+                                                 size_t size,
+                                                 size_t count,
+                                                 DownloadTaskCURL::Segment* seg)
+    {
+        return seg->owner->writeSegmentDataProc(*seg, (unsigned char*)buffer, size, count);
+    }
+
+    static size_t _probeHeaderCallbackProc(char* buffer, size_t size, size_t count, DownloadTaskCURL* coTask)
+    {
+        using namespace std::string_view_literals;
+        std::string_view header{buffer, size * count};
+        if (cxx20::ic::starts_with(header, "accept-ranges:"sv) && header.find("bytes"sv) != std::string_view::npos)
+            coTask->_acceptRanges = true;
+        return size * count;
+    }
+
+    static std::string _getCurlErrorDesc(CURL* curlHandle, CURLcode errCode)
+    {
+        std::string errorMsg = curl_easy_strerror(errCode);
+        if (errCode == CURLE_HTTP_RETURNED_ERROR)
+        {
+            long responeCode = 0;
+            curl_easy_getinfo(curlHandle, CURLINFO_RESPONSE_CODE, &responeCode);
+            fmt::format_to(std::back_inserter(errorMsg), FMT_COMPILE(": {}"), responeCode);
+        }
+        return errorMsg;
+    }
+
     static int _progressCallbackProc(DownloadTask* task,
                                      curl_off_t dltotal,
                                      curl_off_t dlnow,
@@ -463,7 +823,7 @@ private:
             return -1;
         if (coTask->_cancelled)
             return 1;
-        if (coTask->_totalBytesExpected < 0 && dltotal > 0)
+        if (!coTask->_segmented && coTask->_totalBytesExpected < 0 && dltotal > 0)
             coTask->_totalBytesExpected = dltotal + coTask->_transferOffset;
         if (dlnow > 0 && task->background)
         {
@@ -510,7 +870,7 @@ private:
         curl_easy_setopt(handle, CURLOPT_HEADER, 0L);
 
         /** if server acceptRanges and local has part of file, we continue to download **/
-        if (coTask->_totalBytesReceived > 0)
+        if (!coTask->_segmented && coTask->_totalBytesReceived > 0)
         {
             char buf[128];
             snprintf(buf, sizeof(buf), "%" PRId64 "-", coTask->_totalBytesReceived);
@@ -546,6 +906,191 @@ private:
         return CURLE_OK;
     }
 
+    using TaskMap = std::unordered_map<CURL*, std::shared_ptr<DownloadTask>>;
+
+    bool _addHandleProc(CURLM* curlmHandle, CURL* curlHandle, std::shared_ptr<DownloadTask>& task, TaskMap& coTaskMap)
+    {
+        auto mcode = curl_multi_add_handle(curlmHandle, curlHandle);
+        if (CURLM_OK != mcode)
+        {
+            static_cast<DownloadTaskCURL*>(task->_coTask.get())
+                ->setErrorDesc(DownloadTask::ERROR_IMPL_INTERNAL, mcode, curl_multi_strerror(mcode));
+            curl_easy_cleanup(curlHandle);
+            return false;
+        }
+        coTaskMap[curlHandle] = task;
+        return true;
+    }
+
+    // Start a segmented file task: resume the segments from journal, or probe the file size and whether
+    // the server accepts ranges with a HEAD request first.
+    // retval: false if no more transfer is required, the task should be finished
+    bool _startSegmentedTaskProc(CURLM* curlmHandle, std::shared_ptr<DownloadTask>& task, TaskMap& coTaskMap)
+    {
+        auto coTask = static_cast<DownloadTaskCURL*>(task->_coTask.get());
+        if (coTask->loadSegmentsProc())
+            return _addSegmentHandlesProc(curlmHandle, task, coTaskMap);
+
+        CURL* curlHandle = curl_easy_init();
+        if (nullptr == curlHandle)
+        {
+            coTask->setErrorDesc(DownloadTask::ERROR_IMPL_INTERNAL, 0, "Alloc curl handle failed.");
+            return false;
+        }
+
+        _initCurlHandleProc(curlHandle, task);
+        curl_easy_setopt(curlHandle, CURLOPT_NOBODY, 1L);
+        curl_easy_setopt(curlHandle, CURLOPT_HEADERFUNCTION, _probeHeaderCallbackProc);
+        curl_easy_setopt(curlHandle, CURLOPT_HEADERDATA, coTask);
+
+        if (!_addHandleProc(curlmHandle, curlHandle, task, coTaskMap))
+            return false;
+        coTask->_probeCurl = curlHandle;
+        return true;
+    }
+
+    // retval: false if no segment handle added, all segments completed or error occurred
+    bool _addSegmentHandlesProc(CURLM* curlmHandle, std::shared_ptr<DownloadTask>& task, TaskMap& coTaskMap)
+    {
+        auto coTask = static_cast<DownloadTaskCURL*>(task->_coTask.get());
+        for (auto&& seg : coTask->_segments)
+        {
+            if (seg->completed())
+                continue;
+
+            CURL* curlHandle = curl_easy_init();
+            if (nullptr == curlHandle)
+            {
+                coTask->setErrorDesc(DownloadTask::ERROR_IMPL_INTERNAL, 0, "Alloc curl handle failed.");
+                _removeSegmentHandlesProc(curlmHandle, coTask, coTaskMap);
+                return false;
+            }
+
+            _initCurlHandleProc(curlHandle, task);
+            curl_easy_setopt(curlHandle, CURLOPT_WRITEFUNCTION, _outputSegmentDataCallbackProc);
+            curl_easy_setopt(curlHandle, CURLOPT_WRITEDATA, seg.get());
+
+            auto& record        = seg->record;
+            seg->rangeRequested = record.end >= 0 || record.received > 0;
+            seg->statusChecked  = false;
+            if (seg->rangeRequested)
+            {
+                char buf[128];
+                if (record.end >= 0)
+                    snprintf(buf, sizeof(buf), "%" PRId64 "-%" PRId64, record.begin + record.received, record.end);
+                else
+                    snprintf(buf, sizeof(buf), "%" PRId64 "-", record.begin + record.received);
+                curl_easy_setopt(curlHandle, CURLOPT_RANGE, buf);
+            }
+
+            if (!_addHandleProc(curlmHandle, curlHandle, task, coTaskMap))
+            {
+                _removeSegmentHandlesProc(curlmHandle, coTask, coTaskMap);
+                return false;
+            }
+            seg->curl = curlHandle;
+        }
+
+        return coTask->hasRunningSegments();  // or all segments downloaded by previous session
+    }
+
+    void _removeSegmentHandlesProc(CURLM* curlmHandle, DownloadTaskCURL* coTask, TaskMap& coTaskMap)
+    {
+        for (auto&& seg : coTask->_segments)
+        {
+            if (seg->curl)
+            {
+                curl_multi_remove_handle(curlmHandle, seg->curl);
+                curl_easy_cleanup(seg->curl);
+                coTaskMap.erase(seg->curl);
+                seg->curl = nullptr;
+            }
+        }
+    }
+
+    // retval: true if the task still has running transfers
+    bool _onSegmentedHandleDoneProc(CURLM* curlmHandle,
+                                    CURL* curlHandle,
+                                    CURLcode errCode,
+                                    std::shared_ptr<DownloadTask>& task,
+                                    TaskMap& coTaskMap)
+    {
+        auto coTask = static_cast<DownloadTaskCURL*>(task->_coTask.get());
+
+        if (curlHandle == coTask->_probeCurl)
+        {
+            coTask->_probeCurl = nullptr;
+            if (CURLE_OK != errCode && CURLE_HTTP_RETURNED_ERROR != errCode)
+            {
+                coTask->setErrorDesc(DownloadTask::ERROR_IMPL_INTERNAL, errCode,
+                                     _getCurlErrorDesc(curlHandle, errCode));
+                return false;
+            }
+
+            // some servers reject HEAD request, download as one stream of unknown size in the case
+            curl_off_t contentLength = -1;
+            if (CURLE_OK == errCode)
+                curl_easy_getinfo(curlHandle, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &contentLength);
+            else
+                coTask->_acceptRanges = false;
+
+            coTask->planSegmentsProc(contentLength, hints.countOfSegmentsPerTask, hints.minSizeOfSegment);
+            return _addSegmentHandlesProc(curlmHandle, task, coTaskMap);
+        }
+
+        auto it = std::find_if(coTask->_segments.begin(), coTask->_segments.end(),
+                               [curlHandle](auto& seg) { return seg->curl == curlHandle; });
+        if (it == coTask->_segments.end())
+            return coTask->hasRunningSegments();
+
+        if (CURLE_OK != errCode)
+            coTask->setErrorDesc(DownloadTask::ERROR_IMPL_INTERNAL, errCode, _getCurlErrorDesc(curlHandle, errCode));
+
+        if (!coTask->completeSegmentProc(**it, errCode))
+        {
+            // abort the sibling segments, the journal keeps what they received for next time
+            _removeSegmentHandlesProc(curlmHandle, coTask, coTaskMap);
+            return false;
+        }
+
+        return coTask->hasRunningSegments();
+    }
+
+    // Finish a segmented task whose transfers are done, or keep it to digest the rest of its file first.
+    // retval: true if the task is finished
+    bool _finishSegmentedTaskProc(std::shared_ptr<DownloadTask>& task,
+                                  std::vector<std::shared_ptr<DownloadTask>>& digestingTasks)
+    {
+        auto coTask = static_cast<DownloadTaskCURL*>(task->_coTask.get());
+        if (!task->checksum.empty() && DownloadTask::ERROR_NO_ERROR == coTask->_errCode && !coTask->digestStepProc())
+        {
+            digestingTasks.emplace_back(task);
+            return false;
+        }
+        _finishTaskProc(task);
+        return true;
+    }
+
+    void _finishTaskProc(std::shared_ptr<DownloadTask>& task)
+    {
+        // remove from _processSet
+        {
+            std::lock_guard<std::mutex> lock(_processMutex);
+            if (_processSet.end() != _processSet.find(task))
+            {
+                _processSet.erase(task);
+            }
+        }
+
+        if (task->background)
+            _owner->_onDownloadFinished(*task);
+        else
+        {
+            std::lock_guard<std::mutex> lock(_finishedMutex);
+            _finishedQueue.emplace_back(task);
+        }
+    }
+
     void _threadProc()
     {
         yasio::set_thread_name("axmol-dl");
@@ -557,8 +1102,10 @@ private:
         uint32_t countOfMaxProcessingTasks = this->hints.countOfMaxProcessingTasks;
         // init curl content
         CURLM* curlmHandle = curl_multi_init();
-        std::unordered_map<CURL*, std::shared_ptr<DownloadTask>> coTaskMap;
-        int runningHandles = 0;
+        TaskMap coTaskMap;
+        std::vector<std::shared_ptr<DownloadTask>> digestingTasks;  // segmented tasks catching up their md5
+        size_t countOfProcessingTasks = 0;  // a segmented task may run several handles
+        int runningHandles            = 0;
         CURLMcode mcode    = CURLM_OK;
         int rc             = 0;  // select return code
 
@@ -577,8 +1124,9 @@ private:
 
             if (runningHandles)
             {
-                int nret = 0;
-                rc       = curl_multi_poll(curlmHandle, nullptr, 0, AX_CURL_POLL_TIMEOUT_MS, &nret);
+                int nret      = 0;
+                int timeoutMs = digestingTasks.empty() ? AX_CURL_POLL_TIMEOUT_MS : 0;
+                rc            = curl_multi_poll(curlmHandle, nullptr, 0, timeoutMs, &nret);
                 if (rc < 0)
                 {
                     AXLOGD("    _threadProc: select return unexpect code: {}", rc);
@@ -607,23 +1155,36 @@ private:
                         CURL* curlHandle = m->easy_handle;
                         CURLcode errCode = m->data.result;
 
-                        auto task = coTaskMap[curlHandle];
+                        auto it = coTaskMap.find(curlHandle);
+                        if (it == coTaskMap.end())
+                            continue;  // segment handle aborted with its sibling
+
+                        auto task   = it->second;
+                        auto coTask = static_cast<DownloadTaskCURL*>(task->_coTask.get());
 
                         // remove from multi-handle
                         curl_multi_remove_handle(curlmHandle, curlHandle);
+
+                        if (coTask->_segmented)
+                        {
+                            bool running =
+                                _onSegmentedHandleDoneProc(curlmHandle, curlHandle, errCode, task, coTaskMap);
+                            curl_easy_cleanup(curlHandle);
+                            coTaskMap.erase(curlHandle);
+                            if (running)
+                                continue;
+
+                            if (_finishSegmentedTaskProc(task, digestingTasks))
+                                --countOfProcessingTasks;
+                            continue;
+                        }
+
                         do
                         {
-                            auto coTask = static_cast<DownloadTaskCURL*>(task->_coTask.get());
                             if (CURLE_OK != errCode)
                             {
-                                std::string errorMsg = curl_easy_strerror(errCode);
-                                if (errCode == CURLE_HTTP_RETURNED_ERROR) {
-                                    long responeCode = 0;
-                                    curl_easy_getinfo(curlHandle, CURLINFO_RESPONSE_CODE, &responeCode);
-                                    fmt::format_to(std::back_inserter(errorMsg), FMT_COMPILE(": {}"), responeCode);
-                                }
-
-                                coTask->setErrorDesc(DownloadTask::ERROR_IMPL_INTERNAL, errCode, std::move(errorMsg));
+                                coTask->setErrorDesc(DownloadTask::ERROR_IMPL_INTERNAL, errCode,
+                                                     _getCurlErrorDesc(curlHandle, errCode));
                                 break;
                             }
 
@@ -647,22 +1208,8 @@ private:
                         // remove from coTaskMap
                         coTaskMap.erase(curlHandle);
 
-                        // remove from _processSet
-                        {
-                            std::lock_guard<std::mutex> lock(_processMutex);
-                            if (_processSet.end() != _processSet.find(task))
-                            {
-                                _processSet.erase(task);
-                            }
-                        }
-
-                        if (task->background)
-                            _owner->_onDownloadFinished(*task);
-                        else
-                        {
-                            std::lock_guard<std::mutex> lock(_finishedMutex);
-                            _finishedQueue.emplace_back(task);
-                        }
+                        --countOfProcessingTasks;
+                        _finishTaskProc(task);
                     }
                 } while (m);
             }
@@ -671,7 +1218,7 @@ private:
             while (true)
             {
                 // Check for set task limit
-                if (countOfMaxProcessingTasks && coTaskMap.size() >= countOfMaxProcessingTasks)
+                if (countOfMaxProcessingTasks && countOfProcessingTasks >= countOfMaxProcessingTasks)
                     break;
 
                 // get task wrapper from request queue
@@ -692,6 +1239,19 @@ private:
                 }
 
                 auto coTask = static_cast<DownloadTaskCURL*>(task->_coTask.get());
+                if (coTask->_segmented)
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(_processMutex);
+                        _processSet.insert(task);
+                    }
+                    ++countOfProcessingTasks;
+                    if (!_startSegmentedTaskProc(curlmHandle, task, coTaskMap) &&
+                        _finishSegmentedTaskProc(task, digestingTasks))
+                        --countOfProcessingTasks;
+                    continue;
+                }
+
                 // create curl handle from task and add into curl multi handle
                 CURL* curlHandle = curl_easy_init();
 
@@ -716,10 +1276,24 @@ private:
 
                 AXLOGD("    _threadProc task create curl handle:{}", fmt::ptr(curlHandle));
                 coTaskMap[curlHandle] = task;
+                ++countOfProcessingTasks;
                 std::lock_guard<std::mutex> lock(_processMutex);
                 _processSet.insert(task);
             }
-        } while (!coTaskMap.empty());
+
+            for (auto it = digestingTasks.begin(); it != digestingTasks.end();)
+            {
+                auto task = *it;
+                if (static_cast<DownloadTaskCURL*>(task->_coTask.get())->digestStepProc())
+                {
+                    it = digestingTasks.erase(it);
+                    --countOfProcessingTasks;
+                    _finishTaskProc(task);
+                }
+                else
+                    ++it;
+            }
+        } while (!coTaskMap.empty() || !digestingTasks.empty());
 
         _tasksFinished = true;
 
@@ -779,7 +1353,8 @@ void DownloaderCURL::startTask(std::shared_ptr<DownloadTask>& task)
 {
     DownloadTaskCURL* coTask = new DownloadTaskCURL(*this);
     task->_coTask.reset(coTask);  // coTask auto managed by task
-    if (coTask->init(task->storagePath, _impl->hints.tempFileNameSuffix))
+    coTask->task = task.get();
+    if (coTask->init(task->storagePath, _impl->hints.tempFileNameSuffix, _impl->hints.countOfSegmentsPerTask > 1))
     {
         AXLOGD("DownloaderCURL: createTask: Id({})", coTask->serialId);
 
@@ -881,6 +1456,7 @@ void DownloaderCURL::_onDownloadFinished(DownloadTask& task, int checkState)
             auto pFileUtils = FileUtils::getInstance();
             coTask._fs.reset();
             coTask._fsMd5.reset();
+            coTask._fsSegments.reset();
 
             if (checkState & kCheckSumStateSucceed)  // No need download
             {
@@ -894,6 +1470,7 @@ void DownloaderCURL::_onDownloadFinished(DownloadTask& task, int checkState)
                     coTask._errDescription  = "";
 
                     pFileUtils->removeFile(coTask._tempFileName);
+                    coTask.removeSegmentsFile();
 
                     onTaskProgress(task, _transferDataToBuffer);
 
@@ -906,6 +1483,7 @@ void DownloaderCURL::_onDownloadFinished(DownloadTask& task, int checkState)
                     coTask._errDescription  = "Check file md5 succeed, but the origin file is missing!";
                     pFileUtils->removeFile(coTask._checksumFileName);
                     pFileUtils->removeFile(coTask._tempFileName);
+                    coTask.removeSegmentsFile();
                 }
 
                 break;
@@ -918,6 +1496,7 @@ void DownloaderCURL::_onDownloadFinished(DownloadTask& task, int checkState)
                     // If CURLE_RANGE_ERROR, means the server not support resume from download.
                     pFileUtils->removeFile(coTask._checksumFileName);
                     pFileUtils->removeFile(coTask._tempFileName);
+                    coTask.removeSegmentsFile();
                 }
                 break;
             }
@@ -947,6 +1526,7 @@ void DownloaderCURL::_onDownloadFinished(DownloadTask& task, int checkState)
 
                 pFileUtils->removeFile(coTask._checksumFileName);
                 pFileUtils->removeFile(coTask._tempFileName);
+                coTask.removeSegmentsFile();
                 break;
             }
 
@@ -955,6 +1535,7 @@ void DownloaderCURL::_onDownloadFinished(DownloadTask& task, int checkState)
             {
                 // success, remove storage from set
                 DownloadTaskCURL::_sStoragePathSet.erase(coTask._tempFileName);
+                coTask.removeSegmentsFile();
                 break;
             }
 
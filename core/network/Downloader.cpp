@@ -98,6 +98,13 @@ Downloader::Downloader(const DownloaderHints& hints)
         }
     };
 
+    _impl->onTaskData = [this](const DownloadTask& task, int64_t offset, const void* data, size_t size) {
+        if (onFileTaskData)
+        {
+            onFileTaskData(task, offset, data, size);
+        }
+    };
+
     _impl->onTaskFinish = [this](const DownloadTask& task, int errorCode, int errorCodeInternal,
                                  std::string_view errorStr, std::vector<unsigned char>& data) {
         if (DownloadTask::ERROR_NO_ERROR != errorCode)
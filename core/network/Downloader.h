@@ -102,6 +102,13 @@ public:
     uint32_t countOfMaxProcessingTasks;
     uint32_t timeoutInSeconds;
     std::string tempFileNameSuffix;
+
+    // Max count of HTTP Range segments a file task is split into and fetched in parallel,
+    // 1 means download each file as a single stream.
+    // Segment progress is journaled beside the temp file, so an interrupted download resumes per segment.
+    uint32_t countOfSegmentsPerTask = 1;
+    // Files smaller than twice of this size are never split.
+    int64_t minSizeOfSegment = 1024 * 1024;
 };
 
 class AX_DLL Downloader final
@@ -117,6 +124,11 @@ public:
 
     std::function<void(const DownloadTask& task)> onTaskProgress;
 
+    // Invoked on the downloader thread with the bytes of a file task in stream order as soon as they are
+    // written to the temp file. The offset is the position of data in the file, it's non-zero when a task
+    // resumes from a partial temp file. Not invoked for tasks split into segments.
+    std::function<void(const DownloadTask& task, int64_t offset, const void* data, size_t size)> onFileTaskData;
+
     std::function<void(const DownloadTask& task, int errorCode, int errorCodeInternal, std::string_view errorStr)>
         onTaskError;
 
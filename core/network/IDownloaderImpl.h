@@ -61,6 +61,8 @@ public:
                        std::vector<unsigned char>& data)>
         onTaskFinish;
 
+    std::function<void(const DownloadTask& task, int64_t offset, const void* data, size_t size)> onTaskData;
+
     virtual void startTask(std::shared_ptr<DownloadTask>& task) = 0;
 };
 
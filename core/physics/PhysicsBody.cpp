@@ -921,6 +921,36 @@ void PhysicsBody::beforeSimulation(const Mat4& parentToWorldTransform,
                                    float scaleX,
                                    float scaleY,
                                    float rotation)
+{
+    applyBeforeSimulation(computeWorldPosition(parentToWorldTransform, nodeToWorldTransform), scaleX, scaleY,
+                          rotation);
+}
+
+void PhysicsBody::afterSimulation(const Mat4& parentToWorldTransform, float parentRotation)
+{
+    Vec2 position;
+    float rotation;
+    bool positionChanged = computeNodeTransform(parentToWorldTransform, parentRotation, -1.f, position, rotation);
+    applyAfterSimulation(positionChanged, position, rotation, false);
+}
+
+Vec3 PhysicsBody::computeWorldPosition(const Mat4& parentToWorldTransform, const Mat4& nodeToWorldTransform)
+{
+    auto worldPosition = _ownerCenterOffset;
+    nodeToWorldTransform.transformVector(worldPosition.x, worldPosition.y, worldPosition.z, 1.f, &worldPosition);
+
+    if (_owner->getAnchorPoint() != Vec2::ANCHOR_MIDDLE)
+    {
+        auto positionInParent = worldPosition;
+        parentToWorldTransform.getInversed().transformVector(positionInParent.x, positionInParent.y,
+                                                             positionInParent.z, 1.f, &positionInParent);
+        _offset.x = positionInParent.x - _owner->getPositionX();
+        _offset.y = positionInParent.y - _owner->getPositionY();
+    }
+    return worldPosition;
+}
+
+void PhysicsBody::applyBeforeSimulation(const Vec3& worldPosition, float scaleX, float scaleY, float rotation)
 {
     if (_recordScaleX != scaleX || _recordScaleY != scaleY)
     {
@@ -929,6 +959,12 @@ void PhysicsBody::beforeSimulation(const Mat4& parentToWorldTransform,
         setScale(scaleX, scaleY);
     }
 
+    // the node still has the interpolated transform, the body is ahead of it
+    if (_interpolated && _owner->getPosition() == _interpolatedPosition &&
+        _owner->getRotation() == _interpolatedRotation)
+        return;
+    _interpolated = false;
+
     // set rotation
     if (_recordedRotation != rotation)
     {
@@ -936,36 +972,65 @@ void PhysicsBody::beforeSimulation(const Mat4& parentToWorldTransform,
     }
 
     // set position
-    auto worldPosition = _ownerCenterOffset;
-    nodeToWorldTransform.transformVector(worldPosition.x, worldPosition.y, worldPosition.z, 1.f, &worldPosition);
     setPosition(worldPosition.x, worldPosition.y);
 
     _recordPosX = worldPosition.x;
     _recordPosY = worldPosition.y;
 
-    if (_owner->getAnchorPoint() != Vec2::ANCHOR_MIDDLE)
+    // moved by node, don't interpolate from the old state
+    savePreviousState();
+}
+
+bool PhysicsBody::computeNodeTransform(const Mat4& parentToWorldTransform,
+                                       float parentRotation,
+                                       float alpha,
+                                       Vec2& position,
+                                       float& rotation)
+{
+    Vec2 tmp;
+    if (alpha >= 0.f && _hasPreviousState)
     {
-        parentToWorldTransform.getInversed().transformVector(worldPosition.x, worldPosition.y, worldPosition.z, 1.f,
-                                                             &worldPosition);
-        _offset.x = worldPosition.x - _owner->getPositionX();
-        _offset.y = worldPosition.y - _owner->getPositionY();
+        tmp               = _previousPosition.lerp(getPosition(), alpha);
+        const auto angle  = _previousAngle + (cpBodyGetAngle(_cpBody) - _previousAngle) * alpha;
+        rotation          = static_cast<float>(-angle * 180.0 / M_PI) - _rotationOffset - parentRotation;
     }
+    else
+    {
+        tmp      = getPosition();
+        rotation = getRotation() - parentRotation;
+        if (alpha < 0.f && _recordPosX == tmp.x && _recordPosY == tmp.y)
+            return false;
+    }
+
+    Vec3 positionInParent(tmp.x, tmp.y, 0.f);
+    parentToWorldTransform.getInversed().transformVector(positionInParent.x, positionInParent.y, positionInParent.z,
+                                                         1.f, &positionInParent);
+    position.set(positionInParent.x - _offset.x, positionInParent.y - _offset.y);
+    return true;
 }
 
-void PhysicsBody::afterSimulation(const Mat4& parentToWorldTransform, float parentRotation)
+void PhysicsBody::applyAfterSimulation(bool positionChanged, const Vec2& position, float rotation, bool interpolated)
 {
     // set Node position
-    auto tmp = getPosition();
-    Vec3 positionInParent(tmp.x, tmp.y, 0.f);
-    if (_recordPosX != positionInParent.x || _recordPosY != positionInParent.y)
+    if (positionChanged)
+        _owner->setPosition(position);
+
+    // set Node rotation
+    _owner->setRotation(rotation);
+
+    _interpolated = interpolated;
+    if (interpolated)
     {
-        parentToWorldTransform.getInversed().transformVector(positionInParent.x, positionInParent.y, positionInParent.z,
-                                                             1.f, &positionInParent);
-        _owner->setPosition(positionInParent.x - _offset.x, positionInParent.y - _offset.y);
+        _interpolatedPosition = _owner->getPosition();
+        _interpolatedRotation = _owner->getRotation();
     }
+}
 
-    // set Node rotation
-    _owner->setRotation(getRotation() - parentRotation);
+void PhysicsBody::savePreviousState()
+{
+    _previousPosition = getPosition();
+    _previousAngle    = cpBodyGetAngle(_cpBody);
+    _hasPreviousState = true;
 }
 
 void PhysicsBody::onEnter()
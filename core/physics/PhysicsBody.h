@@ -569,6 +569,21 @@ protected:
                           float rotation);
     void afterSimulation(const Mat4& parentToWorldTransform, float parentRotation);
 
+    // The parts of before/afterSimulation which only read the nodes and touch this body,
+    // PhysicsWorld runs them in parallel and applies the results serially.
+    Vec3 computeWorldPosition(const Mat4& parentToWorldTransform, const Mat4& nodeToWorldTransform);
+    void applyBeforeSimulation(const Vec3& worldPosition, float scaleX, float scaleY, float rotation);
+    // alpha is the interpolation factor between the previous and current state, negative to disable interpolation
+    bool computeNodeTransform(const Mat4& parentToWorldTransform,
+                              float parentRotation,
+                              float alpha,
+                              Vec2& position,
+                              float& rotation);
+    void applyAfterSimulation(bool positionChanged, const Vec2& position, float rotation, bool interpolated);
+
+    // Keep the state before a fixed step for interpolation
+    void savePreviousState();
+
 protected:
     std::vector<PhysicsJoint*> _joints;
     Vector<PhysicsShape*> _shapes;
@@ -615,6 +630,14 @@ protected:
     // fixed update state
     bool _fixedUpdate;
 
+    // interpolation state, the node transform written by the last interpolated afterSimulation
+    bool _interpolated     = false;
+    bool _hasPreviousState = false;
+    Vec2 _previousPosition;
+    double _previousAngle = 0.0;
+    Vec2 _interpolatedPosition;
+    float _interpolatedRotation = 0.f;
+
     friend class PhysicsWorld;
     friend class PhysicsShape;
     friend class PhysicsJoint;
@@ -39,6 +39,7 @@
 #    include "2d/DrawNode.h"
 #    include "2d/Scene.h"
 #    include "base/Director.h"
+#    include "base/JobSystem.h"
 #    include "base/EventDispatcher.h"
 #    include "base/EventCustom.h"
 
@@ -515,6 +516,201 @@ PhysicsShape* PhysicsWorld::getShape(const Vec2& point) const
     return shape == nullptr ? nullptr : static_cast<PhysicsShape*>(cpShapeGetUserData(shape));
 }
 
+// The batched queries walk the spatial indexes directly, cpSpace*Query lock and unlock the space for the post step
+// callbacks which isn't thread safe, while the bounding box trees are only read by the queries.
+namespace
+{
+// The count of queries run by a job of a batch
+constexpr size_t QUERY_BATCH_GRAIN = 64;
+
+struct BatchRayCastContext
+{
+    cpVect start;
+    cpVect end;
+    unsigned int query;
+    std::vector<PhysicsRayCastHit>* hits;
+};
+
+struct BatchQueryContext
+{
+    cpBB bb;
+    cpVect point;
+    unsigned int query;
+    std::vector<PhysicsQueryHit>* hits;
+};
+
+cpFloat batchRayCastFunc(BatchRayCastContext* context, cpShape* shape, void* /*data*/)
+{
+    cpSegmentQueryInfo info;
+    if (cpShapeSegmentQuery(shape, context->start, context->end, 0.0f, &info))
+    {
+        context->hits->push_back({context->query, static_cast<PhysicsShape*>(cpShapeGetUserData(shape)),
+                                  PhysicsHelper::cpv2vec2(info.point), PhysicsHelper::cpv2vec2(info.normal),
+                                  static_cast<float>(info.alpha)});
+    }
+    return 1.0f;
+}
+
+cpFloat batchRayCastClosestFunc(BatchRayCastContext* context, cpShape* shape, cpSegmentQueryInfo* out)
+{
+    cpSegmentQueryInfo info;
+    if (cpShapeSegmentQuery(shape, context->start, context->end, 0.0f, &info) && info.alpha < out->alpha)
+    {
+        *out = info;
+    }
+    return out->alpha;
+}
+
+cpCollisionID batchQueryRectFunc(BatchQueryContext* context, cpShape* shape, cpCollisionID id, void* /*data*/)
+{
+    if (cpBBIntersects(context->bb, cpShapeGetBB(shape)))
+    {
+        context->hits->push_back({context->query, static_cast<PhysicsShape*>(cpShapeGetUserData(shape))});
+    }
+    return id;
+}
+
+cpCollisionID batchQueryPointFunc(BatchQueryContext* context, cpShape* shape, cpCollisionID id, void* /*data*/)
+{
+    cpPointQueryInfo info;
+    cpShapePointQuery(shape, context->point, &info);
+    if (info.shape && info.distance < 0.0f)
+    {
+        context->hits->push_back({context->query, static_cast<PhysicsShape*>(cpShapeGetUserData(shape))});
+    }
+    return id;
+}
+
+// Runs query(index, hits) for each query of a batch, each range run by a job collects the hits in its own vector,
+// they are joined in order at last.
+template <typename Hit, typename Query>
+void runQueryBatch(size_t count, std::vector<std::vector<Hit>>& ranges, std::vector<Hit>& hits, const Query& query)
+{
+    hits.clear();
+    if (count <= QUERY_BATCH_GRAIN)
+    {
+        for (size_t i = 0; i < count; ++i)
+            query(i, hits);
+        return;
+    }
+
+    const size_t rangeCount = (count + QUERY_BATCH_GRAIN - 1) / QUERY_BATCH_GRAIN;
+    if (ranges.size() < rangeCount)
+        ranges.resize(rangeCount);
+
+    Director::getInstance()->getJobSystem()->parallelFor(count, QUERY_BATCH_GRAIN, [&](size_t first, size_t last) {
+        auto& rangeHits = ranges[first / QUERY_BATCH_GRAIN];
+        rangeHits.clear();
+        for (size_t i = first; i < last; ++i)
+            query(i, rangeHits);
+    });
+
+    size_t total = 0;
+    for (size_t i = 0; i < rangeCount; ++i)
+        total += ranges[i].size();
+    hits.reserve(total);
+    for (size_t i = 0; i < rangeCount; ++i)
+        hits.insert(hits.end(), ranges[i].begin(), ranges[i].end());
+}
+}  // namespace
+
+void PhysicsWorld::rayCastClosestBatch(const PhysicsRay* rays, size_t count, PhysicsRayCastHit* hits)
+{
+    AXASSERT(!cpSpaceIsLocked(_cpSpace), "Can't query the physics world during a step");
+
+    if (!_delayAddBodies.empty() || !_delayRemoveBodies.empty())
+    {
+        updateBodies();
+    }
+
+    auto staticShapes  = _cpSpace->staticShapes;
+    auto dynamicShapes = _cpSpace->dynamicShapes;
+    auto job           = [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i)
+        {
+            BatchRayCastContext context = {PhysicsHelper::vec22cpv(rays[i].start),
+                                           PhysicsHelper::vec22cpv(rays[i].end), static_cast<unsigned int>(i),
+                                           nullptr};
+            cpSegmentQueryInfo info     = {nullptr, context.end, cpvzero, 1.0f};
+            cpSpatialIndexSegmentQuery(staticShapes, &context, context.start, context.end, 1.0f,
+                                       (cpSpatialIndexSegmentQueryFunc)batchRayCastClosestFunc, &info);
+            cpSpatialIndexSegmentQuery(dynamicShapes, &context, context.start, context.end, info.alpha,
+                                       (cpSpatialIndexSegmentQueryFunc)batchRayCastClosestFunc, &info);
+
+            hits[i] = {context.query,
+                       info.shape ? static_cast<PhysicsShape*>(cpShapeGetUserData(info.shape)) : nullptr,
+                       PhysicsHelper::cpv2vec2(info.point), PhysicsHelper::cpv2vec2(info.normal),
+                       static_cast<float>(info.alpha)};
+        }
+    };
+
+    if (count <= QUERY_BATCH_GRAIN)
+        job(0, count);
+    else
+        Director::getInstance()->getJobSystem()->parallelFor(count, QUERY_BATCH_GRAIN, job);
+}
+
+void PhysicsWorld::rayCastBatch(const PhysicsRay* rays, size_t count, std::vector<PhysicsRayCastHit>& hits)
+{
+    AXASSERT(!cpSpaceIsLocked(_cpSpace), "Can't query the physics world during a step");
+
+    if (!_delayAddBodies.empty() || !_delayRemoveBodies.empty())
+    {
+        updateBodies();
+    }
+
+    auto staticShapes  = _cpSpace->staticShapes;
+    auto dynamicShapes = _cpSpace->dynamicShapes;
+    runQueryBatch(count, _rayCastHitRanges, hits, [&](size_t i, std::vector<PhysicsRayCastHit>& out) {
+        BatchRayCastContext context = {PhysicsHelper::vec22cpv(rays[i].start), PhysicsHelper::vec22cpv(rays[i].end),
+                                       static_cast<unsigned int>(i), &out};
+        cpSpatialIndexSegmentQuery(staticShapes, &context, context.start, context.end, 1.0f,
+                                   (cpSpatialIndexSegmentQueryFunc)batchRayCastFunc, nullptr);
+        cpSpatialIndexSegmentQuery(dynamicShapes, &context, context.start, context.end, 1.0f,
+                                   (cpSpatialIndexSegmentQueryFunc)batchRayCastFunc, nullptr);
+    });
+}
+
+void PhysicsWorld::queryRectBatch(const Rect* rects, size_t count, std::vector<PhysicsQueryHit>& hits)
+{
+    AXASSERT(!cpSpaceIsLocked(_cpSpace), "Can't query the physics world during a step");
+
+    if (!_delayAddBodies.empty() || !_delayRemoveBodies.empty())
+    {
+        updateBodies();
+    }
+
+    auto staticShapes  = _cpSpace->staticShapes;
+    auto dynamicShapes = _cpSpace->dynamicShapes;
+    runQueryBatch(count, _queryHitRanges, hits, [&](size_t i, std::vector<PhysicsQueryHit>& out) {
+        BatchQueryContext context = {PhysicsHelper::rect2cpbb(rects[i]), cpvzero, static_cast<unsigned int>(i), &out};
+        cpSpatialIndexQuery(dynamicShapes, &context, context.bb, (cpSpatialIndexQueryFunc)batchQueryRectFunc,
+                            nullptr);
+        cpSpatialIndexQuery(staticShapes, &context, context.bb, (cpSpatialIndexQueryFunc)batchQueryRectFunc, nullptr);
+    });
+}
+
+void PhysicsWorld::queryPointBatch(const Vec2* points, size_t count, std::vector<PhysicsQueryHit>& hits)
+{
+    AXASSERT(!cpSpaceIsLocked(_cpSpace), "Can't query the physics world during a step");
+
+    if (!_delayAddBodies.empty() || !_delayRemoveBodies.empty())
+    {
+        updateBodies();
+    }
+
+    auto staticShapes  = _cpSpace->staticShapes;
+    auto dynamicShapes = _cpSpace->dynamicShapes;
+    runQueryBatch(count, _queryHitRanges, hits, [&](size_t i, std::vector<PhysicsQueryHit>& out) {
+        const cpVect point        = PhysicsHelper::vec22cpv(points[i]);
+        BatchQueryContext context = {cpBBNewForCircle(point, 0.0f), point, static_cast<unsigned int>(i), &out};
+        cpSpatialIndexQuery(dynamicShapes, &context, context.bb, (cpSpatialIndexQueryFunc)batchQueryPointFunc,
+                            nullptr);
+        cpSpatialIndexQuery(staticShapes, &context, context.bb, (cpSpatialIndexQueryFunc)batchQueryPointFunc,
+                            nullptr);
+    });
+}
+
 bool PhysicsWorld::init()
 {
     do
@@ -905,6 +1101,33 @@ void PhysicsWorld::setSubsteps(int steps)
     }
 }
 
+void PhysicsWorld::setSolverThreads(int threads)
+{
+#    if AX_TARGET_PLATFORM == AX_PLATFORM_WIN32
+    AXLOGW("Physics Warning: The threaded solver isn't available on win32");
+#    else
+    cpHastySpaceSetThreads(_cpSpace, (std::max)(threads, 0));
+#    endif
+}
+
+int PhysicsWorld::getSolverThreads() const
+{
+#    if AX_TARGET_PLATFORM == AX_PLATFORM_WIN32
+    return 1;
+#    else
+    return static_cast<int>(cpHastySpaceGetThreads(_cpSpace));
+#    endif
+}
+
+void PhysicsWorld::stepSpace(float dt)
+{
+#    if AX_TARGET_PLATFORM == AX_PLATFORM_WIN32
+    cpSpaceStep(_cpSpace, dt);
+#    else
+    cpHastySpaceStep(_cpSpace, dt);
+#    endif
+}
+
 void PhysicsWorld::step(float delta)
 {
     if (_autoStep)
@@ -933,7 +1156,9 @@ void PhysicsWorld::update(float delta, bool userCall /* = false*/)
     }
 
     auto sceneToWorldTransform = _scene->getNodeToParentTransform();
+    _syncItems.clear();
     beforeSimulation(_scene, sceneToWorldTransform, 1.f, 1.f, 0.f);
+    syncBeforeSimulation();
 
     if (!_delayAddJoints.empty() || !_delayRemoveJoints.empty())
     {
@@ -945,13 +1170,11 @@ void PhysicsWorld::update(float delta, bool userCall /* = false*/)
         return;
     }
 
+    // interpolation factor between the last two fixed steps, negative if not interpolating
+    float alpha = -1.f;
     if (userCall)
     {
-#    if AX_TARGET_PLATFORM == AX_PLATFORM_WIN32
-        cpSpaceStep(_cpSpace, delta);
-#    else
-        cpHastySpaceStep(_cpSpace, delta);
-#    endif
+        stepSpace(delta);
     }
     else
     {
@@ -966,15 +1189,15 @@ void PhysicsWorld::update(float delta, bool userCall /* = false*/)
                 for (auto&& body : _bodies)
                 {
                     body->fixedUpdate(dt);
+                    if (_interpolationEnabled)
+                        body->savePreviousState();
                 }
                 _scene->fixedUpdate(dt);
 
-#    if AX_TARGET_PLATFORM == AX_PLATFORM_WIN32
-                cpSpaceStep(_cpSpace, dt);
-#    else
-                cpHastySpaceStep(_cpSpace, dt);
-#    endif                
+                stepSpace(dt);
             }
+            if (_interpolationEnabled)
+                alpha = _updateTime / step;
         }
         else
         {
@@ -983,11 +1206,7 @@ void PhysicsWorld::update(float delta, bool userCall /* = false*/)
                 const float dt = _updateTime * _speed / _substeps;
                 for (int i = 0; i < _substeps; ++i)
                 {
-#    if AX_TARGET_PLATFORM == AX_PLATFORM_WIN32
-                    cpSpaceStep(_cpSpace, dt);
-#    else
-                    cpHastySpaceStep(_cpSpace, dt);
-#    endif
+                    stepSpace(dt);
                 }
                 _updateRateCount = 0;
                 _updateTime      = 0.0f;
@@ -1002,7 +1221,9 @@ void PhysicsWorld::update(float delta, bool userCall /* = false*/)
 
     // Update physics position, should loop as the same sequence as node tree.
     // PhysicsWorld::afterSimulation() will depend on the sequence.
+    _syncItems.clear();
     afterSimulation(_scene, sceneToWorldTransform, 0.f);
+    syncAfterSimulation(alpha);
 
     if (_postUpdateCallback)
         _postUpdateCallback();  // fix #11154
@@ -1069,7 +1290,13 @@ void PhysicsWorld::beforeSimulation(Node* node,
     auto physicsBody = node->getPhysicsBody();
     if (physicsBody)
     {
-        physicsBody->beforeSimulation(parentToWorldTransform, nodeToWorldTransform, scaleX, scaleY, rotation);
+        auto& item                  = _syncItems.emplace_back();
+        item.body                   = physicsBody;
+        item.parentToWorldTransform = parentToWorldTransform;
+        item.nodeToWorldTransform   = nodeToWorldTransform;
+        item.scaleX                 = scaleX;
+        item.scaleY                 = scaleY;
+        item.rotation               = rotation;
     }
 
     for (auto&& child : node->getChildren())
@@ -1084,13 +1311,59 @@ void PhysicsWorld::afterSimulation(Node* node, const Mat4& parentToWorldTransfor
     auto physicsBody = node->getPhysicsBody();
     if (physicsBody)
     {
-        physicsBody->afterSimulation(parentToWorldTransform, parentRotation);
+        auto& item                  = _syncItems.emplace_back();
+        item.body                   = physicsBody;
+        item.parentToWorldTransform = parentToWorldTransform;
+        item.rotation               = parentRotation;
     }
 
     for (auto&& child : node->getChildren())
         afterSimulation(child, nodeToWorldTransform, nodeRotation);
 }
 
+void PhysicsWorld::syncBeforeSimulation()
+{
+    auto compute = [this](size_t first, size_t last) {
+        for (auto i = first; i < last; ++i)
+        {
+            auto& item         = _syncItems[i];
+            item.worldPosition = item.body->computeWorldPosition(item.parentToWorldTransform, item.nodeToWorldTransform);
+        }
+    };
+
+    const auto count = _syncItems.size();
+    if (_parallelSyncThreshold > 0 && count >= static_cast<size_t>(_parallelSyncThreshold))
+        Director::getInstance()->getJobSystem()->parallelFor(count, _parallelSyncThreshold / 4 + 1, compute);
+    else
+        compute(0, count);
+
+    // applying touches the space, e.g. wakes up the sleeping bodies
+    for (auto&& item : _syncItems)
+        item.body->applyBeforeSimulation(item.worldPosition, item.scaleX, item.scaleY, item.rotation);
+}
+
+void PhysicsWorld::syncAfterSimulation(float alpha)
+{
+    auto compute = [this, alpha](size_t first, size_t last) {
+        for (auto i = first; i < last; ++i)
+        {
+            auto& item           = _syncItems[i];
+            item.positionChanged = item.body->computeNodeTransform(item.parentToWorldTransform, item.rotation, alpha,
+                                                                   item.position, item.nodeRotation);
+        }
+    };
+
+    const auto count = _syncItems.size();
+    if (_parallelSyncThreshold > 0 && count >= static_cast<size_t>(_parallelSyncThreshold))
+        Director::getInstance()->getJobSystem()->parallelFor(count, _parallelSyncThreshold / 4 + 1, compute);
+    else
+        compute(0, count);
+
+    // applying invokes the node setters which may be overridden
+    for (auto&& item : _syncItems)
+        item.body->applyAfterSimulation(item.positionChanged, item.position, item.nodeRotation, alpha >= 0.f);
+}
+
 void PhysicsWorld::setPostUpdateCallback(const std::function<void()>& callback)
 {
     _postUpdateCallback = callback;
@@ -31,6 +31,7 @@
 #if defined(AX_ENABLE_PHYSICS)
 
 #    include <list>
+#    include <vector>
 #    include "base/Vector.h"
 #    include "math/Math.h"
 #    include "physics/PhysicsBody.h"
@@ -86,6 +87,30 @@ typedef std::function<bool(PhysicsWorld& world, const PhysicsRayCastInfo& info,
 typedef std::function<bool(PhysicsWorld&, PhysicsShape&, void*)> PhysicsQueryRectCallbackFunc;
 typedef PhysicsQueryRectCallbackFunc PhysicsQueryPointCallbackFunc;
 
+/** A ray of the batched ray casts. */
+struct PhysicsRay
+{
+    Vec2 start;
+    Vec2 end;
+};
+
+/** A shape hit by a ray of the batched ray casts. */
+struct PhysicsRayCastHit
+{
+    unsigned int query;  ///< the index of the ray in the batch
+    PhysicsShape* shape;
+    Vec2 contact;
+    Vec2 normal;
+    float fraction;
+};
+
+/** A shape found by the batched rect or point queries. */
+struct PhysicsQueryHit
+{
+    unsigned int query;  ///< the index of the rect or point in the batch
+    PhysicsShape* shape;
+};
+
 /**
  * @addtogroup physics
  * @{
@@ -211,6 +236,49 @@ public:
      */
     PhysicsShape* getShape(const Vec2& point) const;
 
+    /**
+     * Casts a batch of rays, and reports the nearest shape hit by each ray.
+     *
+     * The batch is split over JobSystem when it's large, the space is read only, so it's faster than calling
+     * rayCast() for each ray and no allocation is made per hit.
+     * @attention Don't call it during a step, e.g. in the contact listeners.
+     * @param   rays   The rays to cast.
+     * @param   count   The count of rays.
+     * @param   hits   Receives one hit per ray in the order of rays, the shape is nullptr if the ray hits nothing.
+     */
+    void rayCastClosestBatch(const PhysicsRay* rays, size_t count, PhysicsRayCastHit* hits);
+
+    /**
+     * Casts a batch of rays, and reports all shapes hit by each ray.
+     *
+     * @attention Don't call it during a step, e.g. in the contact listeners.
+     * @param   rays   The rays to cast.
+     * @param   count   The count of rays.
+     * @param   hits   Cleared first, then receives the hits grouped by ray in the order of rays. The hits of one ray
+     * aren't sorted by fraction. Reuse the vector between frames to avoid the reallocation.
+     */
+    void rayCastBatch(const PhysicsRay* rays, size_t count, std::vector<PhysicsRayCastHit>& hits);
+
+    /**
+     * Searches a batch of rects for the shapes whose bounding box overlaps them.
+     *
+     * @attention Don't call it during a step, e.g. in the contact listeners.
+     * @param   rects   The rects to query.
+     * @param   count   The count of rects.
+     * @param   hits   Cleared first, then receives the shapes grouped by rect in the order of rects.
+     */
+    void queryRectBatch(const Rect* rects, size_t count, std::vector<PhysicsQueryHit>& hits);
+
+    /**
+     * Searches a batch of points for the shapes contain them.
+     *
+     * @attention Don't call it during a step, e.g. in the contact listeners.
+     * @param   points   The points to query.
+     * @param   count   The count of points.
+     * @param   hits   Cleared first, then receives the shapes grouped by point in the order of points.
+     */
+    void queryPointBatch(const Vec2* points, size_t count, std::vector<PhysicsQueryHit>& hits);
+
     /**
      * Get all the bodies that in this physics world.
      *
@@ -341,6 +409,33 @@ public:
     /** get the number of substeps */
     int getFixedUpdateRate() const { return _fixedRate; }
 
+    /**
+     * Render the nodes at the transforms interpolated between the last two fixed steps,
+     * it smooths the motion when the fixed update rate doesn't match the frame rate.
+     * @attention Only works with setFixedUpdateRate, the bodies are ahead of their nodes by a fixed step at most.
+     * @param enabled default value is false.
+     */
+    void setInterpolationEnabled(bool enabled) { _interpolationEnabled = enabled; }
+
+    bool isInterpolationEnabled() const { return _interpolationEnabled; }
+
+    /**
+     * Set the count of threads used by the solver.
+     * @param threads 0 means the count of cpu cores, the default value.
+     * @attention The threaded solver isn't available on win32.
+     */
+    void setSolverThreads(int threads);
+
+    int getSolverThreads() const;
+
+    /**
+     * The bodies are synced with their nodes on JobSystem when the count of bodies reaches the threshold.
+     * @param threshold 0 to always sync on the axmol thread, default value is 512.
+     */
+    void setParallelSyncThreshold(int threshold) { _parallelSyncThreshold = threshold; }
+
+    int getParallelSyncThreshold() const { return _parallelSyncThreshold; }
+
     /**
      * Set the debug draw mask of this physics world.
      *
@@ -447,6 +542,29 @@ protected:
     std::function<void()> _preUpdateCallback;
     std::function<void()> _postUpdateCallback;
 
+    bool _interpolationEnabled = false;
+    int _parallelSyncThreshold = 512;
+
+    // The bodies collected in node tree order with the transforms to sync
+    struct BodySyncItem
+    {
+        PhysicsBody* body;
+        Mat4 parentToWorldTransform;
+        Mat4 nodeToWorldTransform;
+        float scaleX;
+        float scaleY;
+        float rotation;  // the world rotation of node before simulation, the parent rotation after simulation
+        Vec3 worldPosition;
+        Vec2 position;
+        float nodeRotation;
+        bool positionChanged;
+    };
+    std::vector<BodySyncItem> _syncItems;
+
+    // The hits of each range of a batched query, reused between the batches
+    std::vector<std::vector<PhysicsRayCastHit>> _rayCastHitRanges;
+    std::vector<std::vector<PhysicsQueryHit>> _queryHitRanges;
+
 protected:
     PhysicsWorld();
     virtual ~PhysicsWorld();
@@ -458,6 +576,10 @@ protected:
                           float parentRotation);
     void afterSimulation(Node* node, const Mat4& parentToWorldTransform, float parentRotation);
 
+    void syncBeforeSimulation();
+    void syncAfterSimulation(float alpha);
+    void stepSpace(float dt);
+
     friend class Node;
     friend class Sprite;
     friend class Scene;
@@ -413,20 +413,7 @@ public:
 
     Physics3DObject* getPhysicsObject(const btCollisionObject* btObj)
     {
-        for (auto&& it : _collider->getPhysicsWorld()->getPhysicsObjects())
-        {
-            if (it->getObjType() == Physics3DObject::PhysicsObjType::RIGID_BODY)
-            {
-                if (static_cast<Physics3DRigidBody*>(it)->getRigidBody() == btObj)
-                    return it;
-            }
-            else if (it->getObjType() == Physics3DObject::PhysicsObjType::COLLIDER)
-            {
-                if (static_cast<Physics3DCollider*>(it)->getGhostObject() == btObj)
-                    return it;
-            }
-        }
-        return nullptr;
+        return _collider->getPhysicsWorld()->getPhysicsObject(btObj);
     }
 
 private:
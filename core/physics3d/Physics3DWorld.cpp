@@ -26,13 +26,68 @@
 
 #include "physics3d/Physics3D.h"
 #include "renderer/Renderer.h"
+#include "base/Director.h"
 
 #if defined(AX_ENABLE_3D_PHYSICS)
 
 #    if (AX_ENABLE_BULLET_INTEGRATION)
 
+#        include "bullet/BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h"
+#        include "bullet/BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h"
+#        include "bullet/BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h"
+
 NS_AX_BEGIN
 
+// the manifolds count from which their contact points are converted on the job threads
+static const int COLLISION_INFO_GRAIN = 64;
+
+#        if BT_THREADSAFE
+namespace
+{
+// Runs the parallel loops of the bullet multithreaded world on the JobSystem
+class JobSystemTaskScheduler : public btITaskScheduler
+{
+public:
+    JobSystemTaskScheduler() : btITaskScheduler("JobSystem")
+    {
+        // the main thread is index 0, each job thread running a loop takes the next index
+        auto threads = Director::getInstance()->getJobSystem()->getThreadCount() + 1;
+        _numThreads  = static_cast<int>((std::min)(threads, static_cast<size_t>(BT_MAX_THREAD_COUNT)));
+    }
+
+    int getMaxNumThreads() const override { return BT_MAX_THREAD_COUNT; }
+    int getNumThreads() const override { return _numThreads; }
+    void setNumThreads(int /*numThreads*/) override {}  // the threads are owned by the JobSystem
+
+    void parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body) override
+    {
+        Director::getInstance()->getJobSystem()->parallelFor(
+            (std::max)(iEnd - iBegin, 0), grainSize,
+            [&](size_t first, size_t last) { body.forLoop(iBegin + int(first), iBegin + int(last)); });
+    }
+
+    btScalar parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody& body) override
+    {
+        // sum the ranges in order, so the result doesn't depend on which thread ran them
+        const int count = (std::max)(iEnd - iBegin, 0);
+        const int grain = (std::max)(grainSize, 1);
+        std::vector<btScalar> sums((count + grain - 1) / grain, btScalar(0));
+        Director::getInstance()->getJobSystem()->parallelFor(count, grain, [&](size_t first, size_t last) {
+            sums[first / grain] = body.sumLoop(iBegin + int(first), iBegin + int(last));
+        });
+        btScalar sum = 0;
+        for (auto s : sums)
+            sum += s;
+        return sum;
+    }
+
+private:
+    int _numThreads;
+};
+}  // namespace
+#        endif
+
+
 Physics3DWorld::Physics3DWorld()
     : _needCollisionChecking(false)
     , _collisionCheckingFlag(false)
@@ -55,6 +110,7 @@ Physics3DWorld::~Physics3DWorld()
     AX_SAFE_DELETE(_broadphase);
     AX_SAFE_DELETE(_ghostCallback);
     AX_SAFE_DELETE(_solver);
+    AX_SAFE_DELETE(_solverPool);
     AX_SAFE_DELETE(_btPhyiscsWorld);
     AX_SAFE_DELETE(_debugDrawer);
     for (auto&& it : _physicsComponents)
@@ -82,25 +138,49 @@ Vec3 Physics3DWorld::getGravity() const
 
 bool Physics3DWorld::init(Physics3DWorldDes* info)
 {
+#        if BT_THREADSAFE
+    _multithreaded = info->isMultithreaded;
+    if (_multithreaded && btGetTaskScheduler() == nullptr)
+    {
+        // shared by all worlds, the app may install another scheduler before creating the world
+        static JobSystemTaskScheduler scheduler;
+        btSetTaskScheduler(&scheduler);
+    }
+#        else
+    if (info->isMultithreaded)
+        AXLOGW("Physics3DWorld: bullet isn't built with BT_THREADSAFE, the world steps on a single thread");
+#        endif
+
     /// collision configuration contains default setup for memory, collision setup
     _collisionConfiguration = new btDefaultCollisionConfiguration();
     //_collisionConfiguration->setConvexConvexMultipointIterations();
 
-    /// use the default collision dispatcher. For parallel processing you can use a different dispatcher (see
-    /// Extras/BulletMultiThreaded)
-    _dispatcher = new btCollisionDispatcher(_collisionConfiguration);
-
     _broadphase = new btDbvtBroadphase();
 
-    /// the default constraint solver. For parallel processing you can use a different solver (see
-    /// Extras/BulletMultiThreaded)
-    btSequentialImpulseConstraintSolver* sol = new btSequentialImpulseConstraintSolver();
-    _solver                                  = sol;
-
     btGhostPairCallback* ghostCallback = new btGhostPairCallback();
     _ghostCallback                     = ghostCallback;
 
-    _btPhyiscsWorld = new btDiscreteDynamicsWorld(_dispatcher, _broadphase, _solver, _collisionConfiguration);
+    if (_multithreaded)
+    {
+        /// the narrowphase, the islands and the large islands are processed with btParallelFor
+        _dispatcher = new btCollisionDispatcherMt(_collisionConfiguration);
+        _solverPool = new btConstraintSolverPoolMt(btGetTaskScheduler()->getNumThreads());
+        _solver     = new btSequentialImpulseConstraintSolverMt();
+
+        _btPhyiscsWorld =
+            new btDiscreteDynamicsWorldMt(_dispatcher, _broadphase, _solverPool, _solver, _collisionConfiguration);
+    }
+    else
+    {
+        /// use the default collision dispatcher
+        _dispatcher = new btCollisionDispatcher(_collisionConfiguration);
+
+        /// the default constraint solver
+        btSequentialImpulseConstraintSolver* sol = new btSequentialImpulseConstraintSolver();
+        _solver                                  = sol;
+
+        _btPhyiscsWorld = new btDiscreteDynamicsWorld(_dispatcher, _broadphase, _solver, _collisionConfiguration);
+    }
     _btPhyiscsWorld->setGravity(convertVec3TobtVector3(info->gravity));
     if (info->isDebugDrawEnabled)
     {
@@ -132,13 +212,18 @@ void Physics3DWorld::addPhysics3DObject(Physics3DObject* physicsObj)
     {
         _objects.emplace_back(physicsObj);
         physicsObj->retain();
+        // the bullet objects are mapped back to their Physics3DObject, see getPhysicsObject
         if (physicsObj->getObjType() == Physics3DObject::PhysicsObjType::RIGID_BODY)
         {
-            _btPhyiscsWorld->addRigidBody(static_cast<Physics3DRigidBody*>(physicsObj)->getRigidBody());
+            auto body        = static_cast<Physics3DRigidBody*>(physicsObj)->getRigidBody();
+            _btObjects[body] = physicsObj;
+            _btPhyiscsWorld->addRigidBody(body);
         }
         else if (physicsObj->getObjType() == Physics3DObject::PhysicsObjType::COLLIDER)
         {
-            _btPhyiscsWorld->addCollisionObject(static_cast<Physics3DCollider*>(physicsObj)->getGhostObject());
+            auto ghost        = static_cast<Physics3DCollider*>(physicsObj)->getGhostObject();
+            _btObjects[ghost] = physicsObj;
+            _btPhyiscsWorld->addCollisionObject(ghost);
         }
         _collisionCheckingFlag         = true;
         _needGhostPairCallbackChecking = true;
@@ -152,11 +237,15 @@ void Physics3DWorld::removePhysics3DObject(Physics3DObject* physicsObj)
     {
         if (physicsObj->getObjType() == Physics3DObject::PhysicsObjType::RIGID_BODY)
         {
-            _btPhyiscsWorld->removeRigidBody(static_cast<Physics3DRigidBody*>(physicsObj)->getRigidBody());
+            auto body = static_cast<Physics3DRigidBody*>(physicsObj)->getRigidBody();
+            _btPhyiscsWorld->removeRigidBody(body);
+            _btObjects.erase(body);
         }
         else if (physicsObj->getObjType() == Physics3DObject::PhysicsObjType::COLLIDER)
         {
-            _btPhyiscsWorld->removeCollisionObject(static_cast<Physics3DCollider*>(physicsObj)->getGhostObject());
+            auto ghost = static_cast<Physics3DCollider*>(physicsObj)->getGhostObject();
+            _btPhyiscsWorld->removeCollisionObject(ghost);
+            _btObjects.erase(ghost);
         }
         physicsObj->release();
         _objects.erase(it);
@@ -171,15 +260,18 @@ void Physics3DWorld::removeAllPhysics3DObjects()
     {
         if (it->getObjType() == Physics3DObject::PhysicsObjType::RIGID_BODY)
         {
-            _btPhyiscsWorld->removeRigidBody(static_cast<Physics3DRigidBody*>(it)->getRigidBody());
+            auto body = static_cast<Physics3DRigidBody*>(it)->getRigidBody();
+            _btPhyiscsWorld->removeRigidBody(body);
         }
         else if (it->getObjType() == Physics3DObject::PhysicsObjType::COLLIDER)
         {
-            _btPhyiscsWorld->removeCollisionObject(static_cast<Physics3DCollider*>(it)->getGhostObject());
+            auto ghost = static_cast<Physics3DCollider*>(it)->getGhostObject();
+            _btPhyiscsWorld->removeCollisionObject(ghost);
         }
         it->release();
     }
     _objects.clear();
+    _btObjects.clear();
     _collisionCheckingFlag         = true;
     _needGhostPairCallbackChecking = true;
 }
@@ -327,61 +419,88 @@ bool Physics3DWorld::sweepShape(Physics3DShape* shape,
     return false;
 }
 
-Physics3DObject* Physics3DWorld::getPhysicsObject(const btCollisionObject* btObj)
+Physics3DObject* Physics3DWorld::getPhysicsObject(const btCollisionObject* btObj) const
 {
-    for (auto&& it : _objects)
+    auto it = _btObjects.find(btObj);
+    return it != _btObjects.end() ? it->second : nullptr;
+}
+
+void Physics3DWorld::collectCollisionInfo(btPersistentManifold* manifold, Physics3DCollisionInfo& ci) const
+{
+    ci.objA = nullptr;
+    ci.objB = nullptr;
+    ci.collisionPointList.clear();
+
+    int numContacts = manifold->getNumContacts();
+    if (numContacts <= 0)
+        return;
+
+    // the map isn't modified while the job threads read it
+    auto poA = getPhysicsObject(manifold->getBody0());
+    auto poB = getPhysicsObject(manifold->getBody1());
+    if (!poA || !poB || (!poA->needCollisionCallback() && !poB->needCollisionCallback()))
+        return;
+
+    ci.objA = poA;
+    ci.objB = poB;
+    for (int c = 0; c < numContacts; ++c)
     {
-        if (it->getObjType() == Physics3DObject::PhysicsObjType::RIGID_BODY)
-        {
-            if (static_cast<Physics3DRigidBody*>(it)->getRigidBody() == btObj)
-                return it;
-        }
-        else if (it->getObjType() == Physics3DObject::PhysicsObjType::COLLIDER)
-        {
-            if (static_cast<Physics3DCollider*>(it)->getGhostObject() == btObj)
-                return it;
-        }
+        btManifoldPoint& pt                       = manifold->getContactPoint(c);
+        Physics3DCollisionInfo::CollisionPoint cp = {
+            convertbtVector3ToVec3(pt.m_localPointA), convertbtVector3ToVec3(pt.m_positionWorldOnA),
+            convertbtVector3ToVec3(pt.m_localPointB), convertbtVector3ToVec3(pt.m_positionWorldOnB),
+            convertbtVector3ToVec3(pt.m_normalWorldOnB)};
+        ci.collisionPointList.emplace_back(cp);
     }
-    return nullptr;
 }
 
 void Physics3DWorld::collisionChecking()
 {
     int numManifolds = _dispatcher->getNumManifolds();
+    if (_collisionInfos.size() < static_cast<size_t>(numManifolds))
+        _collisionInfos.resize(numManifolds);
+
+    // the contact points are converted on the job threads, the callbacks are invoked in the manifolds order
+    auto collect = [this](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i)
+            collectCollisionInfo(_dispatcher->getManifoldByIndexInternal(static_cast<int>(i)), _collisionInfos[i]);
+    };
+    if (numManifolds > COLLISION_INFO_GRAIN)
+        Director::getInstance()->getJobSystem()->parallelFor(numManifolds, COLLISION_INFO_GRAIN, collect);
+    else
+        collect(0, numManifolds);
+
+    // a callback may remove the objects of the next infos from the world, keep them alive until all invoked
     for (int i = 0; i < numManifolds; ++i)
     {
-        btPersistentManifold* contactManifold = _dispatcher->getManifoldByIndexInternal(i);
-        int numContacts                       = contactManifold->getNumContacts();
-        if (0 < numContacts)
+        auto& ci = _collisionInfos[i];
+        if (ci.objA)
         {
-            const btCollisionObject* obA = static_cast<const btCollisionObject*>(contactManifold->getBody0());
-            const btCollisionObject* obB = static_cast<const btCollisionObject*>(contactManifold->getBody1());
-            Physics3DObject* poA         = getPhysicsObject(obA);
-            Physics3DObject* poB         = getPhysicsObject(obB);
-            if (poA->needCollisionCallback() || poB->needCollisionCallback())
-            {
-                Physics3DCollisionInfo ci;
-                ci.objA = poA;
-                ci.objB = poB;
-                for (int c = 0; c < numContacts; ++c)
-                {
-                    btManifoldPoint& pt                       = contactManifold->getContactPoint(c);
-                    Physics3DCollisionInfo::CollisionPoint cp = {
-                        convertbtVector3ToVec3(pt.m_localPointA), convertbtVector3ToVec3(pt.m_positionWorldOnA),
-                        convertbtVector3ToVec3(pt.m_localPointB), convertbtVector3ToVec3(pt.m_positionWorldOnB),
-                        convertbtVector3ToVec3(pt.m_normalWorldOnB)};
-                    ci.collisionPointList.emplace_back(cp);
-                }
-
-                if (poA->needCollisionCallback())
-                {
-                    poA->getCollisionCallback()(ci);
-                }
-                if (poB->needCollisionCallback())
-                {
-                    poB->getCollisionCallback()(ci);
-                }
-            }
+            ci.objA->retain();
+            ci.objB->retain();
+        }
+    }
+    for (int i = 0; i < numManifolds; ++i)
+    {
+        auto& ci = _collisionInfos[i];
+        if (!ci.objA)
+            continue;
+        if (ci.objA->needCollisionCallback())
+        {
+            ci.objA->getCollisionCallback()(ci);
+        }
+        if (ci.objB->needCollisionCallback())
+        {
+            ci.objB->getCollisionCallback()(ci);
+        }
+    }
+    for (int i = 0; i < numManifolds; ++i)
+    {
+        auto& ci = _collisionInfos[i];
+        if (ci.objA)
+        {
+            ci.objA->release();
+            ci.objB->release();
         }
     }
 }
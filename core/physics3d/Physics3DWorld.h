@@ -30,6 +30,8 @@
 #include "math/Math.h"
 #include "base/Object.h"
 #include "base/Config.h"
+#include "physics3d/Physics3DObject.h"
+#include <unordered_map>
 
 #if defined(AX_ENABLE_3D_PHYSICS)
 
@@ -40,6 +42,8 @@ class btDefaultCollisionConfiguration;
 class btCollisionDispatcher;
 struct btDbvtBroadphase;
 class btSequentialImpulseConstraintSolver;
+class btConstraintSolverPoolMt;
+class btPersistentManifold;
 class btGhostPairCallback;
 class btRigidBody;
 class btCollisionObject;
@@ -63,10 +67,12 @@ class Renderer;
 struct AX_DLL Physics3DWorldDes
 {
     bool isDebugDrawEnabled;  // using physics debug draw?, false by default
+    bool isMultithreaded;     // step the bullet multithreaded world on the job threads?, false by default
     ax::Vec3 gravity;    // gravity, (0, -9.8, 0)
     Physics3DWorldDes()
     {
         isDebugDrawEnabled = false;
+        isMultithreaded    = false;
         gravity            = ax::Vec3(0.f, -9.8f, 0.f);
     }
 };
@@ -127,6 +133,12 @@ public:
     /** Check debug drawing is enabled. */
     bool isDebugDrawEnabled() const;
 
+    /**
+     * Check the world steps on the job threads, it requires bullet built with BT_THREADSAFE.
+     * The collision callbacks are always invoked on the axmol thread.
+     */
+    bool isMultithreaded() const { return _multithreaded; }
+
     /** Internal method, the updater of debug drawing, need called each frame. */
     void debugDraw(ax::Renderer* renderer);
 
@@ -152,7 +164,11 @@ public:
 
     bool init(Physics3DWorldDes* info);
 
-    Physics3DObject* getPhysicsObject(const btCollisionObject* btObj);
+    /**
+     * Get the Physics3DObject of a bullet object added to this world, nullptr if there is none.
+     * The world keeps its own map, the user pointer and indices of the bullet objects are left to the app.
+     */
+    Physics3DObject* getPhysicsObject(const btCollisionObject* btObj) const;
 
     void collisionChecking();
     bool needCollisionChecking();
@@ -160,13 +176,17 @@ public:
 
 protected:
     void removePhysics3DConstraintFromBullet(Physics3DConstraint* constraint);
+    void collectCollisionInfo(btPersistentManifold* manifold, Physics3DCollisionInfo& ci) const;
 
     std::vector<Physics3DObject*> _objects;
+    std::unordered_map<const btCollisionObject*, Physics3DObject*> _btObjects;  // the objects by their bullet object
     std::vector<Physics3DConstraint*> _constraints;
     std::vector<Physics3DComponent*> _physicsComponents;  // physics3d components
     bool _needCollisionChecking;
     bool _collisionCheckingFlag;
     bool _needGhostPairCallbackChecking;
+    bool _multithreaded = false;
+    std::vector<Physics3DCollisionInfo> _collisionInfos;  // per manifold, reused by collisionChecking
 
 #        if (AX_ENABLE_BULLET_INTEGRATION)
     btDynamicsWorld* _btPhyiscsWorld;
@@ -174,6 +194,7 @@ protected:
     btCollisionDispatcher* _dispatcher;
     btDbvtBroadphase* _broadphase;
     btSequentialImpulseConstraintSolver* _solver;
+    btConstraintSolverPoolMt* _solverPool = nullptr;
     btGhostPairCallback* _ghostCallback;
     Physics3DDebugDrawer* _debugDrawer;
 #        endif  // AX_ENABLE_BULLET_INTEGRATION
@@ -219,6 +219,19 @@ public:
      */
     virtual bool isRetinaDisplay() const { return false; }
 
+    /**
+     * Create a context shares objects with the render context, used to compile programs in the background.
+     * Called on the axmol thread.
+     * @return nullptr if not supported.
+     */
+    virtual void* createSharedContext() { return nullptr; }
+
+    /** Make the shared context current on the calling thread, nullptr to release it from the calling thread. */
+    virtual void makeSharedContextCurrent(void* /*context*/) {}
+
+    /** Destroy a shared context released from its thread, called on the axmol thread. */
+    virtual void destroySharedContext(void* /*context*/) {}
+
 #if (AX_TARGET_PLATFORM == AX_PLATFORM_IOS)
     virtual void* getEAGLView() const { return nullptr; }
 #endif /* (AX_TARGET_PLATFORM == AX_PLATFORM_IOS) */
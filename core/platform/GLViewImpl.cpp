@@ -683,6 +683,36 @@ bool GLViewImpl::isOpenGLReady()
     return nullptr != _mainWindow;
 }
 
+#if defined(AX_USE_GL)
+void* GLViewImpl::createSharedContext()
+{
+    if (!_mainWindow)
+        return nullptr;
+
+    // a hidden window with the hints of the main window, its context shares objects with the main context
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+#    if (AX_TARGET_PLATFORM == AX_PLATFORM_WIN32)
+    glfwWindowHintPointer(GLFW_WIN32_HWND_PARENT, nullptr);
+#    endif
+    auto window = glfwCreateWindow(1, 1, "", nullptr, _mainWindow);
+    glfwWindowHint(GLFW_VISIBLE, _glContextAttrs.visible);
+#    if (AX_TARGET_PLATFORM == AX_PLATFORM_WIN32)
+    glfwWindowHintPointer(GLFW_WIN32_HWND_PARENT, _glContextAttrs.viewParent);
+#    endif
+    return window;
+}
+
+void GLViewImpl::makeSharedContextCurrent(void* context)
+{
+    glfwMakeContextCurrent(static_cast<GLFWwindow*>(context));
+}
+
+void GLViewImpl::destroySharedContext(void* context)
+{
+    glfwDestroyWindow(static_cast<GLFWwindow*>(context));
+}
+#endif
+
 void GLViewImpl::end()
 {
     if (_mainWindow)
@@ -108,6 +108,12 @@ public:
     virtual void setFrameSize(float width, float height) override;
     virtual void setIMEKeyboardState(bool bOpen) override;
 
+#if defined(AX_USE_GL)
+    void* createSharedContext() override;
+    void makeSharedContextCurrent(void* context) override;
+    void destroySharedContext(void* context) override;
+#endif
+
 #if AX_ICON_SET_SUPPORT
     virtual void setIcon(std::string_view filename) const override;
     virtual void setIcon(const std::vector<std::string_view>& filelist) const override;
@@ -0,0 +1,707 @@
+/****************************************************************************
+ Copyright (c) 2019-present Axmol Engine contributors (see AUTHORS.md).
+
+ https://axmol.dev/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#include "renderer/RenderCapture.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string.h>
+
+#include "renderer/CustomCommand.h"
+#include "renderer/Renderer.h"
+#include "renderer/TrianglesCommand.h"
+#include "renderer/backend/Buffer.h"
+#include "renderer/backend/CommandBuffer.h"
+#include "renderer/backend/ProgramManager.h"
+#include "renderer/backend/ProgramState.h"
+#include "renderer/backend/RenderTarget.h"
+#include "renderer/backend/Texture.h"
+#include "platform/FileUtils.h"
+
+NS_AX_BEGIN
+
+namespace
+{
+constexpr uint32_t CAPTURE_MAGIC   = 0x43525841;  // "AXRC"
+constexpr uint32_t CAPTURE_VERSION = 1;
+
+enum RecordTag : uint8_t
+{
+    TAG_STATE,
+    TAG_TEXTURE,
+    TAG_PROGRAM_STATE,
+    TAG_TRIANGLES,
+    TAG_CUSTOM,
+    TAG_CALLBACK,
+};
+
+// Reads the recorded values, any read past the end fails the whole parse
+class CaptureReader
+{
+public:
+    CaptureReader(const char* data, size_t size) : _ptr(data), _last(data + size) {}
+
+    template <typename T>
+    T read()
+    {
+        T value{};
+        read(&value, sizeof(value));
+        return value;
+    }
+
+    void read(void* data, size_t size)
+    {
+        auto from = _ptr;
+        skip(size);
+        if (!_failed)
+            memcpy(data, from, size);
+    }
+
+    void skip(size_t size)
+    {
+        if (static_cast<size_t>(_last - _ptr) < size)
+        {
+            _failed = true;
+            _ptr    = _last;
+            return;
+        }
+        _ptr += size;
+    }
+
+    bool eof() const { return _ptr == _last; }
+    bool failed() const { return _failed; }
+
+private:
+    const char* _ptr;
+    const char* _last;
+    bool _failed = false;
+};
+
+bool isSameBlend(const backend::BlendDescriptor& lhs, const backend::BlendDescriptor& rhs)
+{
+    return lhs.writeMask == rhs.writeMask && lhs.blendEnabled == rhs.blendEnabled &&
+           lhs.rgbBlendOperation == rhs.rgbBlendOperation && lhs.alphaBlendOperation == rhs.alphaBlendOperation &&
+           lhs.sourceRGBBlendFactor == rhs.sourceRGBBlendFactor &&
+           lhs.destinationRGBBlendFactor == rhs.destinationRGBBlendFactor &&
+           lhs.sourceAlphaBlendFactor == rhs.sourceAlphaBlendFactor &&
+           lhs.destinationAlphaBlendFactor == rhs.destinationAlphaBlendFactor;
+}
+}  // namespace
+
+//
+// RenderCapture
+//
+RenderCapture::RenderCapture()
+{
+    write(CAPTURE_MAGIC);
+    write(CAPTURE_VERSION);
+    write(static_cast<uint32_t>(sizeof(V3F_C4B_T2F)));
+}
+
+void RenderCapture::write(const void* data, size_t size)
+{
+    _data.append(static_cast<const char*>(data), size);
+}
+
+void RenderCapture::recordState(const Renderer& renderer)
+{
+    std::string state;
+    auto append = [&state](uint32_t value) { state.append(reinterpret_cast<const char*>(&value), sizeof(value)); };
+
+    // field by field, the padding of the descriptors isn't initialized
+    auto& ds = renderer.getDepthStencilDesc();
+    append(static_cast<uint32_t>(ds.flags));
+    append(static_cast<uint32_t>(ds.depthCompareFunction));
+    for (auto& face : {ds.backFaceStencil, ds.frontFaceStencil})
+    {
+        append(static_cast<uint32_t>(face.stencilFailureOperation));
+        append(static_cast<uint32_t>(face.depthFailureOperation));
+        append(static_cast<uint32_t>(face.depthStencilPassOperation));
+        append(static_cast<uint32_t>(face.stencilCompareFunction));
+        append(face.readMask);
+        append(face.writeMask);
+    }
+    append(renderer.getStencilReferenceValue());
+    append(static_cast<uint32_t>(renderer.getCullMode()));
+    append(static_cast<uint32_t>(renderer.getWinding()));
+    append(renderer.getScissorTest() ? 1 : 0);
+    for (auto& rect : {renderer.getScissorRect(), renderer.getViewport()})
+    {
+        append(rect.x);
+        append(rect.y);
+        append(rect.width);
+        append(rect.height);
+    }
+
+    if (state != _state)
+    {
+        write(TAG_STATE);
+        write(state.data(), state.size());
+        _state = std::move(state);
+    }
+}
+
+uint32_t RenderCapture::recordTexture(backend::TextureBackend* texture)
+{
+    auto it = _textures.find(texture);
+    if (it != _textures.end())
+        return it->second;
+
+    auto index = static_cast<uint32_t>(_textures.size());
+    _textures.emplace(texture, index);
+
+    write(TAG_TEXTURE);
+    write(index);
+    write(static_cast<int32_t>(texture ? texture->getWidth() : 0));
+    write(static_cast<int32_t>(texture ? texture->getHeight() : 0));
+    write(static_cast<uint32_t>(texture ? texture->getTextureFormat() : backend::PixelFormat::NONE));
+    return index;
+}
+
+uint32_t RenderCapture::recordProgramState(backend::ProgramState* programState)
+{
+    auto it = _programStates.find(programState);
+    if (it != _programStates.end())
+        return it->second;
+
+    auto index = static_cast<uint32_t>(_programStates.size());
+    _programStates.emplace(programState, index);
+
+    write(TAG_PROGRAM_STATE);
+    write(index);
+    write(programState ? programState->getProgram()->getProgramId() : int64_t(-1));
+    write(programState ? programState->getBatchId() : uint64_t(-1));
+
+    size_t vertexSize = 0, fragmentSize = 0;
+    auto vertexData   = programState ? programState->getVertexUniformBuffer(vertexSize) : nullptr;
+    auto fragmentData = programState ? programState->getFragmentUniformBuffer(fragmentSize) : nullptr;
+    write(static_cast<uint32_t>(vertexSize + fragmentSize));
+    if (vertexSize)
+        write(vertexData, vertexSize);
+    if (fragmentSize)
+        write(fragmentData, fragmentSize);
+    return index;
+}
+
+void RenderCapture::record(RenderCommand* command, const Renderer& renderer)
+{
+    switch (command->getType())
+    {
+    case RenderCommand::Type::TRIANGLES_COMMAND:
+    {
+        auto cmd       = static_cast<TrianglesCommand*>(command);
+        auto& triangle = cmd->getTriangles();
+        auto texture   = recordTexture(cmd->getTexture());
+        auto program   = recordProgramState(cmd->getPipelineDescriptor().programState);
+        recordState(renderer);
+
+        write(TAG_TRIANGLES);
+        write(texture);
+        write(program);
+        write(static_cast<uint32_t>(cmd->getBlendType().src));
+        write(static_cast<uint32_t>(cmd->getBlendType().dst));
+        write(static_cast<uint8_t>(cmd->isSkipBatching()));
+        write(cmd->getModelView().m, sizeof(cmd->getModelView().m));
+        write(triangle.vertCount);
+        write(triangle.indexCount);
+        write(triangle.verts, triangle.vertCount * sizeof(triangle.verts[0]));
+        write(triangle.indices, triangle.indexCount * sizeof(triangle.indices[0]));
+        break;
+    }
+    case RenderCommand::Type::CUSTOM_COMMAND:
+    case RenderCommand::Type::MESH_COMMAND:
+    {
+        auto cmd        = static_cast<CustomCommand*>(command);
+        auto& pipeline  = cmd->getPipelineDescriptor();
+        auto program    = recordProgramState(pipeline.programState);
+        auto& blend     = pipeline.blendDescriptor;
+        auto bufferSize = [](backend::Buffer* buffer) { return static_cast<uint32_t>(buffer ? buffer->getSize() : 0); };
+        recordState(renderer);
+
+        write(TAG_CUSTOM);
+        write(static_cast<uint8_t>(command->getType()));
+        write(program);
+        write(static_cast<uint32_t>(blend.writeMask));
+        write(static_cast<uint8_t>(blend.blendEnabled));
+        write(static_cast<uint32_t>(blend.rgbBlendOperation));
+        write(static_cast<uint32_t>(blend.alphaBlendOperation));
+        write(static_cast<uint32_t>(blend.sourceRGBBlendFactor));
+        write(static_cast<uint32_t>(blend.destinationRGBBlendFactor));
+        write(static_cast<uint32_t>(blend.sourceAlphaBlendFactor));
+        write(static_cast<uint32_t>(blend.destinationAlphaBlendFactor));
+        write(static_cast<uint8_t>(cmd->getDrawType()));
+        write(static_cast<uint8_t>(cmd->getPrimitiveType()));
+        write(static_cast<uint8_t>(cmd->getIndexFormat()));
+        write(static_cast<uint8_t>(cmd->isWireframe()));
+        write(static_cast<uint32_t>(cmd->getVertexDrawStart()));
+        write(static_cast<uint32_t>(cmd->getVertexDrawCount()));
+        write(static_cast<uint32_t>(cmd->getIndexDrawOffset()));
+        write(static_cast<uint32_t>(cmd->getIndexDrawCount()));
+        write(static_cast<int32_t>(cmd->getInstanceCount()));
+        write(bufferSize(cmd->getVertexBuffer()));
+        write(bufferSize(cmd->getIndexBuffer()));
+        break;
+    }
+    case RenderCommand::Type::CALLBACK_COMMAND:
+        recordState(renderer);
+        write(TAG_CALLBACK);
+        break;
+    default:
+        return;
+    }
+    ++_commandCount;
+}
+
+bool RenderCapture::save(std::string_view path) const
+{
+    return FileUtils::writeBinaryToFile(_data.data(), _data.size(), path);
+}
+
+//
+// RenderCaptureReplay
+//
+struct RenderCaptureReplay::BackendStats
+{
+    Stats counts;
+    std::unordered_map<const backend::ProgramState*, size_t> uniformSizes;
+    const backend::ProgramState* programState = nullptr;
+    backend::BlendDescriptor blend;
+    bool hasBlend = false;
+
+    void reset()
+    {
+        counts       = {};
+        programState = nullptr;
+        hasBlend     = false;
+    }
+};
+
+struct RenderCaptureReplay::Item
+{
+    std::unique_ptr<TrianglesCommand> triangles;
+    std::unique_ptr<CustomCommand> custom;
+    std::function<void()> callback;  // for the items without a command
+    bool stateChange = false;        // a recorded render state, not a recorded command
+    std::vector<V3F_C4B_T2F> vertices;
+    std::vector<unsigned short> indices;
+    backend::Buffer* instanceBuffer = nullptr;
+
+    ~Item() { AX_SAFE_RELEASE(instanceBuffer); }
+
+    RenderCommand* getCommand() const
+    {
+        return triangles ? static_cast<RenderCommand*>(triangles.get()) : custom.get();
+    }
+};
+
+namespace
+{
+// Counts the draws and state changes instead of issuing them
+class RecordingCommandBuffer : public backend::CommandBuffer
+{
+public:
+    explicit RecordingCommandBuffer(RenderCaptureReplay::BackendStats* stats) : _stats(stats) {}
+
+    void setDepthStencilState(backend::DepthStencilState*) override {}
+    void setRenderPipeline(backend::RenderPipeline*) override {}
+    bool beginFrame() override { return true; }
+    void beginRenderPass(const backend::RenderTarget*, const backend::RenderPassDescriptor&) override
+    {
+        ++_stats->counts.renderPasses;
+    }
+    void updateDepthStencilState(const backend::DepthStencilDescriptor&) override {}
+    void updatePipelineState(const backend::RenderTarget*, const PipelineDescriptor& descriptor) override
+    {
+        ++_stats->counts.pipelineUpdates;
+        if (!_stats->hasBlend || !isSameBlend(_stats->blend, descriptor.blendDescriptor))
+        {
+            ++_stats->counts.blendChanges;
+            _stats->blend    = descriptor.blendDescriptor;
+            _stats->hasBlend = true;
+        }
+    }
+    void setViewport(int, int, unsigned int, unsigned int) override {}
+    void setCullMode(backend::CullMode) override {}
+    void setWinding(backend::Winding) override {}
+    void setVertexBuffer(backend::Buffer*) override {}
+    void setProgramState(backend::ProgramState* programState) override
+    {
+        if (programState != _stats->programState)
+        {
+            ++_stats->counts.programChanges;
+            _stats->programState = programState;
+        }
+        auto it = _stats->uniformSizes.find(programState);
+        if (it != _stats->uniformSizes.end())
+            _stats->counts.uniformBytes += it->second;
+    }
+    void setIndexBuffer(backend::Buffer*) override {}
+    void setInstanceBuffer(backend::Buffer*) override {}
+    void drawArrays(backend::PrimitiveType, std::size_t, std::size_t count, bool) override
+    {
+        ++_stats->counts.draws;
+        _stats->counts.drawnVertices += count;
+    }
+    void drawElements(backend::PrimitiveType, backend::IndexFormat, std::size_t count, std::size_t, bool) override
+    {
+        ++_stats->counts.draws;
+        _stats->counts.drawnVertices += count;
+    }
+    void drawElementsInstanced(backend::PrimitiveType,
+                               backend::IndexFormat,
+                               std::size_t count,
+                               std::size_t,
+                               int instanceCount,
+                               bool) override
+    {
+        ++_stats->counts.draws;
+        _stats->counts.drawnVertices += count * instanceCount;
+    }
+    void endRenderPass() override {}
+    void endFrame() override {}
+    void setScissorRect(bool, float, float, float, float) override {}
+    void readPixels(backend::RenderTarget*, std::function<void(const backend::PixelBufferDescriptor&)>) override {}
+
+private:
+    RenderCaptureReplay::BackendStats* _stats;
+};
+
+class RecordingBuffer : public backend::Buffer
+{
+public:
+    RecordingBuffer(std::size_t size, backend::BufferType type, RenderCaptureReplay::BackendStats* stats)
+        : backend::Buffer(size, type, backend::BufferUsage::DYNAMIC), _stats(stats)
+    {}
+
+    void updateData(const void*, std::size_t size) override { _stats->counts.uploadedBytes += size; }
+    void updateSubData(const void*, std::size_t, std::size_t size) override { _stats->counts.uploadedBytes += size; }
+    void usingDefaultStoredData(bool) override {}
+
+private:
+    RenderCaptureReplay::BackendStats* _stats;
+};
+
+// Stands for a recorded texture, only its identity is used to batch the commands
+class PlaceholderTexture : public backend::TextureBackend
+{
+public:
+    PlaceholderTexture(int width, int height, backend::PixelFormat format)
+    {
+        _width         = width;
+        _height        = height;
+        _textureFormat = format;
+    }
+
+    void updateSamplerDescriptor(const backend::SamplerDescriptor&) override {}
+    void generateMipmaps() override {}
+};
+}  // namespace
+
+RenderCaptureReplay::RenderCaptureReplay() : _backendStats(std::make_unique<BackendStats>())
+{
+    auto stats = _backendStats.get();
+
+    _renderer                 = new Renderer();
+    _renderer->_commandBuffer = new RecordingCommandBuffer(stats);
+    _renderer->_defaultRT     = new backend::RenderTarget(true);
+    _renderer->_currentRT     = _renderer->_defaultRT;
+    // every batch buffer records, including the ones of frames larger than VBO_SIZE
+    _renderer->_triangleCommandBufferManager.init([stats](std::size_t size, backend::BufferType type) {
+        return static_cast<backend::Buffer*>(new RecordingBuffer(size, type, stats));
+    });
+    _renderer->_vertexBuffer = _renderer->_triangleCommandBufferManager.getVertexBuffer();
+    _renderer->_indexBuffer  = _renderer->_triangleCommandBufferManager.getIndexBuffer();
+}
+
+RenderCaptureReplay::~RenderCaptureReplay()
+{
+    clear();
+    delete _renderer;
+}
+
+void RenderCaptureReplay::clear()
+{
+    _items.clear();
+    for (auto texture : _textures)
+        texture->release();
+    _textures.clear();
+    for (auto& item : _batchStates)
+        item.second->release();
+    _batchStates.clear();
+    _programStates.clear();
+    _backendStats->uniformSizes.clear();
+    _stats = {};
+}
+
+bool RenderCaptureReplay::load(std::string_view path)
+{
+    clear();
+
+    auto data = FileUtils::getInstance()->getDataFromFile(path);
+    if (data.isNull() || !parse(reinterpret_cast<const char*>(data.getBytes()), data.getSize()))
+    {
+        AXLOGW("RenderCaptureReplay: can't load the frame capture {}", path);
+        clear();
+        return false;
+    }
+    return true;
+}
+
+bool RenderCaptureReplay::parse(const char* data, size_t size)
+{
+    CaptureReader reader(data, size);
+    if (reader.read<uint32_t>() != CAPTURE_MAGIC || reader.read<uint32_t>() != CAPTURE_VERSION ||
+        reader.read<uint32_t>() != sizeof(V3F_C4B_T2F))
+        return false;
+
+    auto program =
+        backend::ProgramManager::getInstance()->getBuiltinProgram(backend::ProgramType::POSITION_TEXTURE_COLOR);
+    if (!program)
+        return false;
+
+    // The program states of the same recorded batch id share a state, the ones of different ids get different
+    // uniforms so their batch ids differ too
+    auto stateOfBatch = [this, program](uint64_t batchId) {
+        auto& state = _batchStates[batchId];
+        if (!state)
+        {
+            state = new backend::ProgramState(program);
+            Mat4 tag;
+            tag.m[15] = static_cast<float>(_batchStates.size());
+            state->setUniform(state->getUniformLocation(backend::Uniform::MVP_MATRIX), tag.m, sizeof(tag.m));
+            state->updateBatchId();
+        }
+        return state;
+    };
+    auto programState = [this](uint32_t index) {
+        return index < _programStates.size() ? _programStates[index] : nullptr;
+    };
+
+    while (!reader.eof() && !reader.failed())
+    {
+        switch (reader.read<uint8_t>())
+        {
+        case TAG_STATE:
+        {
+            backend::DepthStencilDescriptor ds;
+            ds.flags                = static_cast<backend::DepthStencilFlags>(reader.read<uint32_t>());
+            ds.depthCompareFunction = static_cast<backend::CompareFunction>(reader.read<uint32_t>());
+            for (auto face : {&ds.backFaceStencil, &ds.frontFaceStencil})
+            {
+                face->stencilFailureOperation   = static_cast<backend::StencilOperation>(reader.read<uint32_t>());
+                face->depthFailureOperation     = static_cast<backend::StencilOperation>(reader.read<uint32_t>());
+                face->depthStencilPassOperation = static_cast<backend::StencilOperation>(reader.read<uint32_t>());
+                face->stencilCompareFunction    = static_cast<backend::CompareFunction>(reader.read<uint32_t>());
+                face->readMask                  = reader.read<uint32_t>();
+                face->writeMask                 = reader.read<uint32_t>();
+            }
+            auto stencilRef = reader.read<uint32_t>();
+            auto cullMode   = static_cast<backend::CullMode>(reader.read<uint32_t>());
+            auto winding    = static_cast<backend::Winding>(reader.read<uint32_t>());
+            bool scissor    = reader.read<uint32_t>() != 0;
+            ScissorRect rects[2];
+            for (auto& rect : rects)
+            {
+                rect.x      = reader.read<int32_t>();
+                rect.y      = reader.read<int32_t>();
+                rect.width  = reader.read<int32_t>();
+                rect.height = reader.read<int32_t>();
+            }
+
+            // Applied by a callback like the one of the captured frame which changed it, so it flushes the batch
+            auto item         = std::make_unique<Item>();
+            auto renderer     = _renderer;
+            item->stateChange = true;
+            item->callback    = [=]() {
+                renderer->setDepthStencilDesc(ds);
+                renderer->_stencilRef = stencilRef;
+                renderer->setCullMode(cullMode);
+                renderer->setWinding(winding);
+                renderer->setScissorTest(scissor);
+                renderer->setScissorRect(rects[0].x, rects[0].y, rects[0].width, rects[0].height);
+                renderer->setViewPort(rects[1].x, rects[1].y, rects[1].width, rects[1].height);
+            };
+            _items.emplace_back(std::move(item));
+            break;
+        }
+        case TAG_TEXTURE:
+        {
+            auto index  = reader.read<uint32_t>();
+            auto width  = reader.read<int32_t>();
+            auto height = reader.read<int32_t>();
+            auto format = static_cast<backend::PixelFormat>(reader.read<uint32_t>());
+            if (index != _textures.size())
+                return false;
+            _textures.emplace_back(new PlaceholderTexture(width, height, format));
+            break;
+        }
+        case TAG_PROGRAM_STATE:
+        {
+            auto index = reader.read<uint32_t>();
+            reader.read<int64_t>();  // the program id, a part of the batch id already
+            auto batchId     = reader.read<uint64_t>();
+            auto uniformSize = reader.read<uint32_t>();
+            reader.skip(uniformSize);  // only the size is replayed
+            if (index != _programStates.size())
+                return false;
+
+            auto state = stateOfBatch(batchId);
+            _programStates.emplace_back(state);
+            _backendStats->uniformSizes[state] = uniformSize;
+            break;
+        }
+        case TAG_TRIANGLES:
+        {
+            auto texture    = reader.read<uint32_t>();
+            auto state      = programState(reader.read<uint32_t>());
+            BlendFunc blend = {static_cast<backend::BlendFactor>(reader.read<uint32_t>()),
+                               static_cast<backend::BlendFactor>(reader.read<uint32_t>())};
+            bool skipBatching = reader.read<uint8_t>() != 0;
+            Mat4 mv;
+            reader.read(mv.m, sizeof(mv.m));
+            auto vertCount  = reader.read<uint32_t>();
+            auto indexCount = reader.read<uint32_t>();
+            if (texture >= _textures.size() || !state || vertCount > Renderer::VBO_SIZE ||
+                indexCount > Renderer::INDEX_VBO_SIZE)
+                return false;
+
+            auto item = std::make_unique<Item>();
+            item->vertices.resize(vertCount);
+            item->indices.resize(indexCount);
+            reader.read(item->vertices.data(), vertCount * sizeof(V3F_C4B_T2F));
+            reader.read(item->indices.data(), indexCount * sizeof(unsigned short));
+
+            auto cmd                                  = new TrianglesCommand();
+            cmd->getPipelineDescriptor().programState = state;
+            TrianglesCommand::Triangles triangles(item->vertices.data(), item->indices.data(), vertCount, indexCount);
+            cmd->init(0, _textures[texture], blend, triangles, mv, 0);
+            if (skipBatching)
+                cmd->setSkipBatching(true);
+            item->triangles.reset(cmd);
+            _items.emplace_back(std::move(item));
+            break;
+        }
+        case TAG_CUSTOM:
+        {
+            reader.read<uint8_t>();  // the command type, mesh commands are replayed as custom commands
+            auto state = programState(reader.read<uint32_t>());
+            backend::BlendDescriptor blend;
+            blend.writeMask                   = static_cast<backend::ColorWriteMask>(reader.read<uint32_t>());
+            blend.blendEnabled                = reader.read<uint8_t>() != 0;
+            blend.rgbBlendOperation           = static_cast<backend::BlendOperation>(reader.read<uint32_t>());
+            blend.alphaBlendOperation         = static_cast<backend::BlendOperation>(reader.read<uint32_t>());
+            blend.sourceRGBBlendFactor        = static_cast<backend::BlendFactor>(reader.read<uint32_t>());
+            blend.destinationRGBBlendFactor   = static_cast<backend::BlendFactor>(reader.read<uint32_t>());
+            blend.sourceAlphaBlendFactor      = static_cast<backend::BlendFactor>(reader.read<uint32_t>());
+            blend.destinationAlphaBlendFactor = static_cast<backend::BlendFactor>(reader.read<uint32_t>());
+            auto drawType      = static_cast<CustomCommand::DrawType>(reader.read<uint8_t>());
+            auto primitiveType = static_cast<backend::PrimitiveType>(reader.read<uint8_t>());
+            auto indexFormat   = static_cast<backend::IndexFormat>(reader.read<uint8_t>());
+            bool wireframe     = reader.read<uint8_t>() != 0;
+            auto vertexStart   = reader.read<uint32_t>();
+            auto vertexCount   = reader.read<uint32_t>();
+            auto indexOffset   = reader.read<uint32_t>();
+            auto indexCount    = reader.read<uint32_t>();
+            auto instanceCount = reader.read<int32_t>();
+            auto vertexSize    = reader.read<uint32_t>();
+            auto indexSize     = reader.read<uint32_t>();
+            if (!state)
+                return false;
+
+            auto stats = _backendStats.get();
+            auto item  = std::make_unique<Item>();
+            auto cmd   = new CustomCommand();
+            cmd->init(0);
+            cmd->getPipelineDescriptor().programState    = state;
+            cmd->getPipelineDescriptor().blendDescriptor = blend;
+            cmd->setDrawType(drawType);
+            cmd->setPrimitiveType(primitiveType);
+            cmd->setWireframe(wireframe);
+
+            auto vertexBuffer = new RecordingBuffer(vertexSize, backend::BufferType::VERTEX, stats);
+            cmd->setVertexBuffer(vertexBuffer);
+            vertexBuffer->release();
+            cmd->setVertexDrawInfo(vertexStart, vertexCount);
+            if (drawType != CustomCommand::DrawType::ARRAY)
+            {
+                auto indexBuffer = new RecordingBuffer(indexSize, backend::BufferType::INDEX, stats);
+                cmd->setIndexBuffer(indexBuffer, indexFormat);
+                indexBuffer->release();
+                cmd->setIndexDrawInfo(indexOffset / (indexFormat == backend::IndexFormat::U_SHORT ? 2 : 4), indexCount);
+            }
+            if (drawType == CustomCommand::DrawType::ELEMENT_INSTANCE)
+            {
+                item->instanceBuffer = new RecordingBuffer(0, backend::BufferType::VERTEX, stats);
+                cmd->setInstanceBuffer(item->instanceBuffer, instanceCount);
+            }
+            item->custom.reset(cmd);
+            _items.emplace_back(std::move(item));
+            break;
+        }
+        case TAG_CALLBACK:
+        {
+            auto item      = std::make_unique<Item>();
+            item->callback = []() {};
+            _items.emplace_back(std::move(item));
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    return !reader.failed();
+}
+
+const RenderCaptureReplay::Stats& RenderCaptureReplay::replay(int frames)
+{
+    using namespace std::chrono;
+
+    double totalTime = 0;
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        _backendStats->reset();
+        _renderer->clearDrawStats();
+        _renderer->beginFrame();
+
+        for (auto& item : _items)
+        {
+            if (auto command = item->getCommand())
+                _renderer->addCommand(command);
+            else
+                _renderer->addCallbackCommand(item->callback);
+        }
+
+        auto start = steady_clock::now();
+        _renderer->render();
+        totalTime += duration<double, std::milli>(steady_clock::now() - start).count();
+
+        _renderer->endFrame();
+    }
+
+    _stats            = _backendStats->counts;
+    _stats.commands   = std::count_if(_items.begin(), _items.end(), [](auto& item) { return !item->stateChange; });
+    _stats.renderTime = frames > 0 ? totalTime / frames : 0;
+    return _stats;
+}
+
+NS_AX_END
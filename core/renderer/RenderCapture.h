@@ -0,0 +1,160 @@
+/****************************************************************************
+ Copyright (c) 2019-present Axmol Engine contributors (see AUTHORS.md).
+
+ https://axmol.dev/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "renderer/RenderCommand.h"
+
+/**
+ * @addtogroup renderer
+ * @{
+ */
+
+NS_AX_BEGIN
+
+class Renderer;
+
+namespace backend
+{
+class ProgramState;
+class TextureBackend;
+}  // namespace backend
+
+/**
+ * @brief Records the commands a Renderer processed in a frame, see Renderer::captureNextFrame().
+ *
+ * The commands are recorded in the order they're drawn, after the render queues were sorted and the group commands
+ * expanded, with the render states they're drawn with. The triangles are recorded with their vertices, indices and
+ * model view, the custom and mesh commands with their draw ranges and buffer sizes, the program states with their
+ * program id, batch id and uniform data, the textures with their size and format. Callback commands can't be
+ * recorded, they're kept as the points the batches are flushed.
+ *
+ * The file is written in the byte order of the device, it's meant to be replayed by RenderCaptureReplay on the same
+ * platform.
+ */
+class AX_DLL RenderCapture
+{
+public:
+    RenderCapture();
+
+    /** Record a command processed by the renderer, group commands are skipped */
+    void record(RenderCommand* command, const Renderer& renderer);
+
+    bool save(std::string_view path) const;
+
+    size_t getCommandCount() const { return _commandCount; }
+
+protected:
+    template <typename T>
+    void write(const T& value)
+    {
+        write(&value, sizeof(value));
+    }
+    void write(const void* data, size_t size);
+
+    uint32_t recordTexture(backend::TextureBackend* texture);
+    uint32_t recordProgramState(backend::ProgramState* programState);
+    void recordState(const Renderer& renderer);
+
+    std::string _data;
+    std::unordered_map<const void*, uint32_t> _textures;
+    std::unordered_map<const void*, uint32_t> _programStates;
+    std::string _state;  // the render state recorded last
+    size_t _commandCount = 0;
+};
+
+/**
+ * @brief Replays a frame recorded by RenderCapture, without the GPU.
+ *
+ * The recorded commands are rebuilt once and fed to a Renderer of its own each frame. The renderer runs its sorting,
+ * batching and vertex processing as usual, but draws with a command buffer that counts the draws and state changes
+ * instead of issuing them, so the timings and counts only depend on the recorded frame and the renderer code.
+ *
+ * The textures are replaced by placeholders with the recorded size, and the program states by states of a builtin
+ * program which keep the recorded batch ids apart, so the commands batch as they did in the captured frame. The
+ * program states still need the programs of the running backend, so replay in a running application, e.g. a test.
+ * Mesh commands are replayed as custom commands, they aren't merged into instanced draws.
+ */
+class AX_DLL RenderCaptureReplay
+{
+public:
+    struct Stats
+    {
+        size_t commands        = 0;  // commands replayed per frame
+        size_t draws           = 0;
+        size_t drawnVertices   = 0;  // indices, or vertices of the non-indexed draws
+        size_t renderPasses    = 0;
+        size_t pipelineUpdates = 0;
+        size_t programChanges  = 0;  // draws with a program state different from the previous draw
+        size_t blendChanges    = 0;  // draws with a blend state different from the previous draw
+        size_t uploadedBytes   = 0;  // vertex and index data uploaded
+        size_t uniformBytes    = 0;  // uniform data the draws would upload, as recorded
+        double renderTime      = 0;  // average milliseconds of Renderer::render()
+    };
+
+    RenderCaptureReplay();
+    ~RenderCaptureReplay();
+
+    bool load(std::string_view path);
+
+    /**
+     * Replay the loaded frame a number of times.
+     * @return The counts of the last frame and the average render time.
+     */
+    const Stats& replay(int frames = 1);
+
+    const Stats& getStats() const { return _stats; }
+
+    /** The renderer the frames are replayed by, e.g. to toggle the batching options */
+    Renderer* getRenderer() const { return _renderer; }
+
+    /** Statistics of the recording backend, counted by its command buffer and buffers */
+    struct BackendStats;
+
+protected:
+    struct Item;
+
+    void clear();
+    bool parse(const char* data, size_t size);
+
+    Renderer* _renderer = nullptr;
+    std::unique_ptr<BackendStats> _backendStats;
+    std::vector<std::unique_ptr<Item>> _items;
+    std::vector<backend::TextureBackend*> _textures;
+    std::vector<backend::ProgramState*> _programStates;
+    std::unordered_map<uint64_t, backend::ProgramState*> _batchStates;  // by the recorded batch id
+    Stats _stats;
+};
+
+NS_AX_END
+
+/**
+ end of support group
+ @}
+ */
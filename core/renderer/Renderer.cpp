@@ -36,6 +36,7 @@
 #include "renderer/Technique.h"
 #include "renderer/Pass.h"
 #include "renderer/Texture2D.h"
+#include "renderer/RenderCapture.h"
 
 #include "base/Configuration.h"
 #include "base/Director.h"
@@ -62,6 +63,60 @@ static bool compare3DCommand(RenderCommand* a, RenderCommand* b)
     return a->getDepth() > b->getDepth();
 }
 
+// the range of the MVP matrix in the uniform buffer, it's set per instance by the instanced draws
+static std::pair<std::size_t, std::size_t> getMVPRange(const backend::ProgramState* programState, std::size_t size)
+{
+    auto offset = programState->getUniformBufferOffset(programState->getUniformLocation(backend::Uniform::MVP_MATRIX));
+    if (offset < 0)
+        return {size, size};
+    return {static_cast<std::size_t>(offset), std::min(size, static_cast<std::size_t>(offset) + sizeof(Mat4))};
+}
+
+static uint64_t hashInstanceUniforms(const backend::ProgramState* programState)
+{
+    std::size_t vertexSize = 0, fragmentSize = 0;
+    auto buffer = programState->getVertexUniformBuffer(vertexSize);
+    programState->getFragmentUniformBuffer(fragmentSize);
+
+    const auto size       = vertexSize + fragmentSize;
+    const auto [mvp, end] = getMVPRange(programState, size);
+    return XXH64(buffer + end, size - end, XXH64(buffer, mvp, 0));
+}
+
+static bool isSameTextures(const std::unordered_map<int, backend::TextureInfo>& lhs,
+                           const std::unordered_map<int, backend::TextureInfo>& rhs)
+{
+    if (lhs.size() != rhs.size())
+        return false;
+    for (auto&& entry : lhs)
+    {
+        auto it = rhs.find(entry.first);
+        if (it == rhs.end() || it->second.slots != entry.second.slots || it->second.textures != entry.second.textures)
+            return false;
+    }
+    return true;
+}
+
+// whether the program states of the same program draw the same but for the MVP matrix
+static bool isSameInstanceData(const backend::ProgramState* lhs, const backend::ProgramState* rhs)
+{
+    if (lhs == rhs)
+        return true;
+    if (lhs->getProgram() != rhs->getProgram())
+        return false;
+
+    std::size_t vertexSize = 0, fragmentSize = 0;
+    auto lhsBuffer = lhs->getVertexUniformBuffer(vertexSize);
+    auto rhsBuffer = rhs->getVertexUniformBuffer(vertexSize);
+    lhs->getFragmentUniformBuffer(fragmentSize);
+
+    const auto size       = vertexSize + fragmentSize;
+    const auto [mvp, end] = getMVPRange(lhs, size);
+    return memcmp(lhsBuffer, rhsBuffer, mvp) == 0 && memcmp(lhsBuffer + end, rhsBuffer + end, size - end) == 0 &&
+           isSameTextures(lhs->getVertexTextureInfos(), rhs->getVertexTextureInfos()) &&
+           isSameTextures(lhs->getFragmentTextureInfos(), rhs->getFragmentTextureInfos());
+}
+
 // queue
 RenderQueue::RenderQueue() {}
 
@@ -188,6 +243,14 @@ Renderer::~Renderer()
 
     free(_triBatchesToDraw);
 
+    for (auto&& buffer : _instanceBufferPool)
+        buffer->release();
+    _instanceBufferPool.clear();
+
+    for (auto&& programState : _instanceProgramStatePool)
+        programState->release();
+    _instanceProgramStatePool.clear();
+
     AX_SAFE_RELEASE(_depthStencilState);
     AX_SAFE_RELEASE(_commandBuffer);
     AX_SAFE_RELEASE(_renderPipeline);
@@ -288,6 +351,8 @@ void Renderer::processGroupCommand(GroupCommand* command)
 void Renderer::processRenderCommand(RenderCommand* command)
 {
     auto commandType = command->getType();
+    if (_capture && commandType != RenderCommand::Type::GROUP_COMMAND)
+        _capture->record(command, *this);
     switch (commandType)
     {
     case RenderCommand::Type::TRIANGLES_COMMAND:
@@ -327,9 +392,24 @@ void Renderer::processRenderCommand(RenderCommand* command)
     }
     break;
     case RenderCommand::Type::MESH_COMMAND:
+    {
         flush2D();
-        drawMeshCommand(command);
-        break;
+
+        auto cmd     = static_cast<MeshCommand*>(command);
+        auto program = getInstancedProgram(cmd);
+        QueuedMeshCommand queued;
+        if (!program || !resolveInstancing(cmd, program, queued))
+        {
+            // keep the order of the queued commands with the ones drawn directly
+            flush3D();
+            drawMeshCommand(command);
+        }
+        else if (_autoInstancing)
+            _queuedMeshCommands.emplace_back(queued);
+        else
+            drawInstancedMeshCommands(&queued, 1);
+    }
+    break;
     case RenderCommand::Type::GROUP_COMMAND:
         processGroupCommand(static_cast<GroupCommand*>(command));
         _groupCommandPool.emplace_back(static_cast<GroupCommand*>(command));
@@ -413,7 +493,18 @@ void Renderer::render()
         {
             renderqueue.sort();
         }
+        if (!_capturePath.empty())
+            _capture = std::make_unique<RenderCapture>();
+
         visitRenderQueue(_renderGroups[0]);
+
+        if (_capture)
+        {
+            if (!_capture->save(_capturePath))
+                AXLOGW("Renderer: can't save the frame capture to {}", _capturePath);
+            _capture.reset();
+            _capturePath.clear();
+        }
     }
     clean();
     _isRendering = false;
@@ -421,6 +512,8 @@ void Renderer::render()
 
 bool Renderer::beginFrame()
 {
+    _instanceBufferIndex       = 0;
+    _instanceProgramStateIndex = 0;
     return _commandBuffer->beginFrame();
 }
 
@@ -454,6 +547,22 @@ void Renderer::clean()
     _queuedTriangleCommands.clear();
 }
 
+uint32_t Renderer::getUniformUploads() const
+{
+    return _commandBuffer->getUniformUploadStats().uploaded;
+}
+
+uint32_t Renderer::getSkippedUniformUploads() const
+{
+    return _commandBuffer->getUniformUploadStats().skipped;
+}
+
+void Renderer::clearDrawStats()
+{
+    _drawnBatches = _drawnVertices = _drawnInstancedBatches = _drawnInstances = _reorderedTriangleCommands = 0;
+    _commandBuffer->resetUniformUploadStats();
+}
+
 void Renderer::setDepthTest(bool value)
 {
     if (value)
@@ -587,22 +696,47 @@ void Renderer::setViewPort(int x, int y, unsigned int w, unsigned int h)
     _viewport.height = h;
 }
 
-void Renderer::fillVerticesAndIndices(const TrianglesCommand* cmd, unsigned int vertexBufferOffset)
+int Renderer::findTriBatch(const TrianglesCommand* cmd, int commandIndex, int batchesTotal) const
 {
-    auto destVertices = &_verts[_filledVertex];
-    auto srcVertices = cmd->getVertices();
-    auto vertexCount = cmd->getVertexCount();
-    auto&& modelView = cmd->getModelView();
-    MathUtil::transformVertices(destVertices, srcVertices, vertexCount, modelView);
+    if (batchesTotal == 0 || cmd->isSkipBatching())
+        return -1;
 
-    auto destIndices = &_indices[_filledIndex];
-    auto srcIndices = cmd->getIndices();
-    auto indexCount = cmd->getIndexCount();
-    auto offset = vertexBufferOffset + _filledVertex;
-    MathUtil::transformIndices(destIndices, srcIndices, indexCount, int(offset));
+    auto materialID = cmd->getMaterialID();
+    auto& last      = _triBatchesToDraw[batchesTotal - 1];
+    if (last.batchable && last.cmd->getMaterialID() == materialID)
+        return batchesTotal - 1;
 
-    _filledVertex += vertexCount;
-    _filledIndex += indexCount;
+    auto& placement = _triCommandPlacements[commandIndex];
+    if (!_batchReordering || !placement.planar)
+        return -1;
+
+    // the latest batch of the material, the earlier ones can't be joined if this one can't
+    int batch = batchesTotal - 2;
+    for (; batch >= 0; --batch)
+    {
+        if (_triBatchesToDraw[batch].batchable && _triBatchesToDraw[batch].cmd->getMaterialID() == materialID)
+            break;
+    }
+    if (batch < 0)
+        return -1;
+
+    // the commands of the later batches are drawn after the command, none of them may overlap it
+    int first = _triBatchesToDraw[batch + 1].firstCommand;
+    if (commandIndex - first > BATCH_REORDER_WINDOW)
+        return -1;
+
+    for (int i = first; i < commandIndex; ++i)
+    {
+        auto& other = _triCommandPlacements[i];
+        if (other.batch <= batch)
+            continue;
+        if (!other.planar || other.z != placement.z)
+            return -1;
+        if (other.minX < placement.maxX && placement.minX < other.maxX && other.minY < placement.maxY &&
+            placement.minY < other.maxY)
+            return -1;
+    }
+    return batch;
 }
 
 void Renderer::drawBatchedTriangles()
@@ -619,62 +753,87 @@ void Renderer::drawBatchedTriangles()
     unsigned int indexBufferFillOffset  = 0;
 #endif
 
-    _triBatchesToDraw[0].offset        = indexBufferFillOffset;
-    _triBatchesToDraw[0].indicesToDraw = 0;
-    _triBatchesToDraw[0].cmd           = nullptr;
-
-    int batchesTotal        = 0;
-    uint32_t prevMaterialID = 0;
-    bool firstCommand       = true;
+    int batchesTotal = 0;
 
     _filledVertex = 0;
     _filledIndex  = 0;
 
-    for (const auto& cmd : _queuedTriangleCommands)
+    // Transform the vertices in the queued order and assign each command a batch
+    const int commandCount = static_cast<int>(_queuedTriangleCommands.size());
+    _triCommandPlacements.resize(commandCount);
+    for (int i = 0; i < commandCount; ++i)
     {
-        auto currentMaterialID = cmd->getMaterialID();
-        const bool batchable   = !cmd->isSkipBatching();
-
-        fillVerticesAndIndices(cmd, vertexBufferFillOffset);
-
-        // in the same batch ?
-        if (batchable && (prevMaterialID == currentMaterialID || firstCommand))
+        auto cmd         = _queuedTriangleCommands[i];
+        auto vertexCount = cmd->getVertexCount();
+        auto vertices    = &_verts[_filledVertex];
+        MathUtil::transformVertices(vertices, cmd->getVertices(), vertexCount, cmd->getModelView());
+
+        auto& placement        = _triCommandPlacements[i];
+        placement.vertexOffset = _filledVertex;
+        placement.planar       = false;
+        if (_batchReordering && vertexCount > 0)
         {
-            AX_ASSERT((firstCommand || _triBatchesToDraw[batchesTotal].cmd->getMaterialID() == cmd->getMaterialID()) &&
-                      "argh... error in logic");
-            _triBatchesToDraw[batchesTotal].indicesToDraw += cmd->getIndexCount();
-            _triBatchesToDraw[batchesTotal].cmd = cmd;
+            auto& p0         = vertices[0].vertices;
+            placement.minX   = placement.maxX = p0.x;
+            placement.minY   = placement.maxY = p0.y;
+            placement.z      = p0.z;
+            placement.planar = true;
+            for (unsigned int v = 1; v < vertexCount; ++v)
+            {
+                auto& p          = vertices[v].vertices;
+                placement.minX   = std::min(placement.minX, p.x);
+                placement.maxX   = std::max(placement.maxX, p.x);
+                placement.minY   = std::min(placement.minY, p.y);
+                placement.maxY   = std::max(placement.maxY, p.y);
+                placement.planar = placement.planar && p.z == placement.z;
+            }
         }
-        else
+        _filledVertex += vertexCount;
+
+        int batch = findTriBatch(cmd, i, batchesTotal);
+        if (batch < 0)
         {
-            // is this the first one?
-            if (!firstCommand)
+            // capacity full ?
+            if (batchesTotal >= _triBatchesToDrawCapacity)
             {
-                batchesTotal++;
-                _triBatchesToDraw[batchesTotal].offset =
-                    _triBatchesToDraw[batchesTotal - 1].offset + _triBatchesToDraw[batchesTotal - 1].indicesToDraw;
+                _triBatchesToDrawCapacity *= 1.4;
+                _triBatchesToDraw =
+                    (TriBatchToDraw*)realloc(_triBatchesToDraw, sizeof(_triBatchesToDraw[0]) * _triBatchesToDrawCapacity);
             }
 
-            _triBatchesToDraw[batchesTotal].cmd           = cmd;
-            _triBatchesToDraw[batchesTotal].indicesToDraw = (int)cmd->getIndexCount();
-
-            // is this a single batch ? Prevent creating a batch group then
-            if (!batchable)
-                currentMaterialID = 0;
+            batch                                  = batchesTotal++;
+            _triBatchesToDraw[batch].indicesToDraw = 0;
+            _triBatchesToDraw[batch].firstCommand  = i;
+            _triBatchesToDraw[batch].batchable     = !cmd->isSkipBatching();
         }
+        else if (batch != batchesTotal - 1)
+            ++_reorderedTriangleCommands;
 
-        // capacity full ?
-        if (batchesTotal + 1 >= _triBatchesToDrawCapacity)
-        {
-            _triBatchesToDrawCapacity *= 1.4;
-            _triBatchesToDraw =
-                (TriBatchToDraw*)realloc(_triBatchesToDraw, sizeof(_triBatchesToDraw[0]) * _triBatchesToDrawCapacity);
-        }
+        // the last command of the batch provides the pipeline states
+        _triBatchesToDraw[batch].cmd = cmd;
+        _triBatchesToDraw[batch].indicesToDraw += cmd->getIndexCount();
+        placement.batch = batch;
+    }
 
-        prevMaterialID = currentMaterialID;
-        firstCommand   = false;
+    // Write the indices of each batch contiguously, the commands of a batch keep their queued order
+    unsigned int offset = indexBufferFillOffset;
+    for (int i = 0; i < batchesTotal; ++i)
+    {
+        _triBatchesToDraw[i].offset      = offset;
+        _triBatchesToDraw[i].filledIndex = offset - indexBufferFillOffset;
+        offset += _triBatchesToDraw[i].indicesToDraw;
+    }
+    for (int i = 0; i < commandCount; ++i)
+    {
+        auto cmd        = _queuedTriangleCommands[i];
+        auto& placement = _triCommandPlacements[i];
+        auto& batch     = _triBatchesToDraw[placement.batch];
+        MathUtil::transformIndices(&_indices[batch.filledIndex], cmd->getIndices(), cmd->getIndexCount(),
+                                   int(vertexBufferFillOffset + placement.vertexOffset));
+        batch.filledIndex += cmd->getIndexCount();
     }
-    batchesTotal++;
+    _filledIndex = offset - indexBufferFillOffset;
+
 #ifdef AX_USE_METAL
     _vertexBuffer->updateSubData(_verts, vertexBufferFillOffset * sizeof(_verts[0]), _filledVertex * sizeof(_verts[0]));
     _indexBuffer->updateSubData(_indices, indexBufferFillOffset * sizeof(_indices[0]),
@@ -775,8 +934,243 @@ void Renderer::flush2D()
 
 void Renderer::flush3D()
 {
-    // TODO 3d instanced rendering
-    // https://learnopengl.com/Advanced-OpenGL/Instancing
+    if (_queuedMeshCommands.empty())
+        return;
+
+    // the queued commands are opaque and depth tested, so the order between the groups doesn't matter
+    std::stable_sort(_queuedMeshCommands.begin(), _queuedMeshCommands.end(),
+                     [](const auto& lhs, const auto& rhs) { return lhs.key < rhs.key; });
+
+    const auto begin = _queuedMeshCommands.begin();
+    for (size_t first = 0, count = _queuedMeshCommands.size(); first < count;)
+    {
+        size_t last = first + 1;
+        while (last < count && _queuedMeshCommands[last].key == _queuedMeshCommands[first].key)
+            ++last;
+
+        // the keys only hash the uniforms and textures, the commands of a key are told apart by comparing them
+        while (first < last)
+        {
+            auto programState = _queuedMeshCommands[first].command->getPipelineDescriptor().programState;
+            auto split = std::stable_partition(begin + first, begin + last, [programState](const auto& queued) {
+                return isSameInstanceData(programState, queued.command->getPipelineDescriptor().programState);
+            });
+            const auto drawn = static_cast<size_t>(split - begin);
+            drawInstancedMeshCommands(_queuedMeshCommands.data() + first, drawn - first);
+            first = drawn;
+        }
+    }
+    _queuedMeshCommands.clear();
+}
+
+backend::Program* Renderer::getInstancedProgram(MeshCommand* command) const
+{
+    if (command->getDrawType() != CustomCommand::DrawType::ELEMENT || !command->is3D() || command->isTransparent() ||
+        command->isSkipBatching())
+        return nullptr;
+
+    auto programState = command->getPipelineDescriptor().programState;
+    if (!programState)
+        return nullptr;
+
+    // the program takes the instance transforms, or the builtin unlit programs are drawn by their instanced variant
+    auto program = programState->getProgram();
+    if (program->getAttributeLocation(backend::Attribute::INSTANCE) != -1)
+        return program;
+    if (!_autoInstancing)
+        return nullptr;
+
+    switch (program->getProgramType())
+    {
+    case backend::ProgramType::POSITION_TEXTURE_3D:
+        return backend::Program::getBuiltinProgram(backend::ProgramType::POSITION_TEXTURE_3D_INSTANCE);
+    case backend::ProgramType::POSITION_3D:
+        return backend::Program::getBuiltinProgram(backend::ProgramType::POSITION_3D_INSTANCE);
+    default:
+        return nullptr;
+    }
+}
+
+bool Renderer::resolveInstancing(MeshCommand* command, backend::Program* program, QueuedMeshCommand& queued)
+{
+    // Bind the pass of the command to resolve its render states, they're kept in the key and applied by the
+    // instanced draw, which doesn't bind the pass again.
+    if (command->getBeforeCallback())
+        command->getBeforeCallback()();
+
+    // only the opaque, depth tested and depth writing commands can be drawn out of order
+    const bool instanceable = getDepthTest() && getDepthWrite();
+    if (instanceable)
+    {
+        auto programState = command->getPipelineDescriptor().programState;
+        const auto& blend = command->getPipelineDescriptor().blendDescriptor;
+
+        auto& key                       = queued.key;
+        key                             = {};
+        key.vertexBuffer                = command->getVertexBuffer();
+        key.indexBuffer                 = command->getIndexBuffer();
+        key.program                     = program;
+        key.uniforms                    = hashInstanceUniforms(programState);
+        key.indexDrawOffset             = command->getIndexDrawOffset();
+        key.indexDrawCount              = command->getIndexDrawCount();
+        key.writeMask                   = blend.writeMask;
+        key.rgbBlendOperation           = blend.rgbBlendOperation;
+        key.alphaBlendOperation         = blend.alphaBlendOperation;
+        key.sourceRGBBlendFactor        = blend.sourceRGBBlendFactor;
+        key.destinationRGBBlendFactor   = blend.destinationRGBBlendFactor;
+        key.sourceAlphaBlendFactor      = blend.sourceAlphaBlendFactor;
+        key.destinationAlphaBlendFactor = blend.destinationAlphaBlendFactor;
+        key.depthFunc                   = getDepthCompareFunction();
+        key.primitiveType               = command->getPrimitiveType();
+        key.indexFormat                 = command->getIndexFormat();
+        key.cullMode                    = _cullMode;
+        key.winding                     = _winding;
+        key.blendEnabled                = blend.blendEnabled;
+        key.wireframe                   = command->isWireframe();
+        key.depthTest                   = getDepthTest();
+        key.depthWrite                  = getDepthWrite();
+
+        // the texture maps may iterate in different orders, combine the hash of each entry regardless of the order
+        for (auto textureInfos : {&programState->getVertexTextureInfos(), &programState->getFragmentTextureInfos()})
+        {
+            for (auto&& entry : *textureInfos)
+            {
+                auto hash = XXH64(entry.second.textures.data(),
+                                  entry.second.textures.size() * sizeof(entry.second.textures[0]), entry.first);
+                key.textures += XXH64(entry.second.slots.data(), entry.second.slots.size() * sizeof(int), hash);
+            }
+        }
+        queued.command = command;
+    }
+
+    if (command->getAfterCallback())
+        command->getAfterCallback()();
+
+    return instanceable;
+}
+
+void Renderer::drawInstancedMeshCommands(const QueuedMeshCommand* commands, size_t count)
+{
+    auto cmd        = commands[0].command;
+    const auto& key = commands[0].key;
+
+    _instanceTransforms.clear();
+    for (size_t i = 0; i < count; ++i)
+        _instanceTransforms.emplace_back(commands[i].command->getMV());
+
+    const auto transformsSize = _instanceTransforms.size() * sizeof(Mat4);
+    auto instanceBuffer       = getNextInstanceBuffer(transformsSize);
+    instanceBuffer->updateSubData(_instanceTransforms.data(), 0, transformsSize);
+
+    // apply the render states resolved when the command was queued
+    const bool depthTest  = getDepthTest();
+    const bool depthWrite = getDepthWrite();
+    const auto depthFunc  = getDepthCompareFunction();
+    const auto cullMode   = _cullMode;
+    const auto winding    = _winding;
+    setDepthTest(key.depthTest);
+    setDepthWrite(key.depthWrite);
+    setDepthCompareFunction(key.depthFunc);
+    setCullMode(key.cullMode);
+    setWinding(key.winding);
+
+    auto pipelineDescriptor = cmd->getPipelineDescriptor();
+    auto programState       = pipelineDescriptor.programState;
+    if (programState->getProgram() != key.program)
+        programState = pipelineDescriptor.programState = getNextInstanceProgramState(programState, key.program);
+
+    const auto& projection = Director::getInstance()->getMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION);
+    programState->setUniform(programState->getUniformLocation(backend::Uniform::MVP_MATRIX), projection.m,
+                             sizeof(projection.m));
+
+    beginRenderPass();
+    _commandBuffer->setVertexBuffer(cmd->getVertexBuffer());
+    _commandBuffer->updatePipelineState(_currentRT, pipelineDescriptor);
+    _commandBuffer->setProgramState(programState);
+    _commandBuffer->setIndexBuffer(cmd->getIndexBuffer());
+    _commandBuffer->setInstanceBuffer(instanceBuffer);
+    _commandBuffer->drawElementsInstanced(cmd->getPrimitiveType(), cmd->getIndexFormat(), cmd->getIndexDrawCount(),
+                                          cmd->getIndexDrawOffset(), static_cast<int>(count), cmd->isWireframe());
+    _drawnVertices += cmd->getIndexDrawCount() * count;
+    _drawnBatches++;
+    _drawnInstancedBatches++;
+    _drawnInstances += count;
+    endRenderPass();
+
+    setDepthTest(depthTest);
+    setDepthWrite(depthWrite);
+    setDepthCompareFunction(depthFunc);
+    setCullMode(cullMode);
+    setWinding(winding);
+}
+
+backend::Buffer* Renderer::getNextInstanceBuffer(size_t size)
+{
+    // each instanced draw of a frame takes its own buffer, so the transforms of a pending draw aren't overwritten
+    if (_instanceBufferIndex < _instanceBufferPool.size() && _instanceBufferPool[_instanceBufferIndex]->getSize() < size)
+    {
+        _instanceBufferPool[_instanceBufferIndex]->release();
+        _instanceBufferPool.erase(_instanceBufferPool.begin() + _instanceBufferIndex);
+    }
+
+    if (_instanceBufferIndex >= _instanceBufferPool.size())
+    {
+        // grow by power of two, so the buffer is not recreated when the instance count changes slightly
+        size_t capacity = 64 * sizeof(Mat4);
+        while (capacity < size)
+            capacity *= 2;
+        auto buffer = backend::DriverBase::getInstance()->newBuffer(capacity, backend::BufferType::VERTEX,
+                                                                    backend::BufferUsage::DYNAMIC);
+        _instanceBufferPool.insert(_instanceBufferPool.begin() + _instanceBufferIndex, buffer);
+    }
+
+    return _instanceBufferPool[_instanceBufferIndex++];
+}
+
+backend::ProgramState* Renderer::getNextInstanceProgramState(backend::ProgramState* programState,
+                                                             backend::Program* program)
+{
+    // like the transform buffers, each instanced draw of a frame takes its own program state
+    auto& pool = _instanceProgramStatePool;
+    if (_instanceProgramStateIndex < pool.size() && pool[_instanceProgramStateIndex]->getProgram() != program)
+    {
+        pool[_instanceProgramStateIndex]->release();
+        pool.erase(pool.begin() + _instanceProgramStateIndex);
+    }
+    if (_instanceProgramStateIndex >= pool.size())
+        pool.insert(pool.begin() + _instanceProgramStateIndex, new backend::ProgramState(program));
+    auto instanceState = pool[_instanceProgramStateIndex++];
+
+    // the instanced variant shares the fragment shader and the vertex layout of the program, copy the uniforms and
+    // textures by name
+    std::size_t size = 0;
+    auto uniforms    = programState->getVertexUniformBuffer(size);
+    for (auto stage : {backend::ShaderStage::VERTEX, backend::ShaderStage::FRAGMENT})
+    {
+        for (auto&& uniform : program->getAllActiveUniformInfo(stage))
+        {
+            auto from = programState->getUniformLocation(uniform.first);
+            auto to   = instanceState->getUniformLocation(uniform.first);
+            if (!from || !to)
+                continue;
+
+            auto offset = programState->getUniformBufferOffset(from);
+            if (offset >= 0)
+            {
+                const auto uniformSize = uniform.second.size * std::max(uniform.second.count, 1);
+                instanceState->setUniform(to, uniforms + offset, uniformSize);
+                continue;
+            }
+
+            auto& textureInfos = from.vertStage ? programState->getVertexTextureInfos()
+                                                : programState->getFragmentTextureInfos();
+            auto it = textureInfos.find(from.vertStage ? from.vertStage.location : from.fragStage.location);
+            if (it != textureInfos.end())
+                instanceState->setTextureArray(to, it->second.slots, it->second.textures);
+        }
+    }
+    instanceState->setSharedVertexLayout(programState->getMutableVertexLayout());
+    return instanceState;
 }
 
 void Renderer::flushTriangles()
@@ -962,6 +1356,12 @@ void Renderer::TriangleCommandBufferManager::init()
     createBuffer();
 }
 
+void Renderer::TriangleCommandBufferManager::init(BufferFactory factory)
+{
+    _bufferFactory = std::move(factory);
+    createBuffer();
+}
+
 void Renderer::TriangleCommandBufferManager::putbackAllBuffers()
 {
     _currentBufferIndex = 0;
@@ -991,19 +1391,21 @@ backend::Buffer* Renderer::TriangleCommandBufferManager::getIndexBuffer() const
 
 void Renderer::TriangleCommandBufferManager::createBuffer()
 {
-    auto driver = backend::DriverBase::getInstance();
+    auto newBuffer = [this](std::size_t size, backend::BufferType type) {
+        if (_bufferFactory)
+            return _bufferFactory(size, type);
+        return backend::DriverBase::getInstance()->newBuffer(size, type, backend::BufferUsage::DYNAMIC);
+    };
 
     // Not initializing the buffer before passing it to updateData for Android/OpenGL ES.
     // This change does fix the Android/OpenGL ES performance problem
     // If for some reason we get reports of performance issues on OpenGL implementations,
     // then we can just add pre-processor checks for OpenGL and have the updateData() allocate the full size after buffer creation.
-    auto vertexBuffer = driver->newBuffer(Renderer::VBO_SIZE * sizeof(_verts[0]), backend::BufferType::VERTEX,
-                                          backend::BufferUsage::DYNAMIC);
+    auto vertexBuffer = newBuffer(Renderer::VBO_SIZE * sizeof(_verts[0]), backend::BufferType::VERTEX);
     if (!vertexBuffer)
         return;
 
-    auto indexBuffer = driver->newBuffer(Renderer::INDEX_VBO_SIZE * sizeof(_indices[0]), backend::BufferType::INDEX,
-                                         backend::BufferUsage::DYNAMIC);
+    auto indexBuffer = newBuffer(Renderer::INDEX_VBO_SIZE * sizeof(_indices[0]), backend::BufferType::INDEX);
     if (!indexBuffer)
     {
         vertexBuffer->release();
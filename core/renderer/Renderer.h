@@ -30,6 +30,9 @@
 #include <array>
 #include <deque>
 #include <optional>
+#include <memory>
+#include <functional>
+#include <compare>
 
 #include "platform/PlatformMacros.h"
 #include "renderer/RenderCommand.h"
@@ -64,6 +67,7 @@ class GroupCommand;
 class CallbackCommand;
 struct PipelineDescriptor;
 class Texture2D;
+class RenderCapture;
 
 /** Class that knows how to sort `RenderCommand` objects.
  Since the commands that have `z == 0` are "pushed back" in
@@ -140,6 +144,8 @@ public:
     static const int BATCH_TRIAGCOMMAND_RESERVED_SIZE = 64;
     /**Reserved for material id, which means that the command could not be batched.*/
     static const int MATERIAL_ID_DO_NOT_BATCH = 0;
+    /**The max number of the queued TrianglesCommands a command is moved over to join an earlier batch.*/
+    static const int BATCH_REORDER_WINDOW = 128;
     /**Constructor.*/
     Renderer();
     /**Destructor.*/
@@ -182,8 +188,55 @@ public:
     ssize_t getDrawnVertices() const { return _drawnVertices; }
     /* RenderCommands (except) TrianglesCommand should update this value */
     void addDrawnVertices(ssize_t number) { _drawnVertices += number; };
+    /* returns the number of instanced draws merged from MeshCommands in the last frame, part of drawn batches */
+    ssize_t getDrawnInstancedBatches() const { return _drawnInstancedBatches; }
+    /* returns the number of MeshCommands drawn by the instanced draws in the last frame */
+    ssize_t getDrawnInstances() const { return _drawnInstances; }
+    /* returns the number of TrianglesCommands moved to an earlier batch in the last frame */
+    ssize_t getReorderedTriangleCommands() const { return _reorderedTriangleCommands; }
+    /* returns the number of uniform blocks uploaded in the last frame */
+    uint32_t getUniformUploads() const;
+    /* returns the number of uniform block uploads skipped in the last frame, the data was unchanged */
+    uint32_t getSkippedUniformUploads() const;
     /* clear draw stats */
-    void clearDrawStats() { _drawnBatches = _drawnVertices = 0; }
+    void clearDrawStats();
+
+    /**
+     * Enable/disable merging the MeshCommands into instanced draws, enabled by default.
+     *
+     * The MeshCommands of the default unlit mesh materials are drawn by the instanced variants of their programs,
+     * the ones whose program takes the instance transform attribute, e.g. MeshMaterial::MaterialType::UNLIT_INSTANCE,
+     * by their own program. The lit mesh programs have no instanced variant, their commands are drawn one by one.
+     *
+     * The opaque 3D MeshCommands with depth test and depth write enabled are queued, any other MeshCommand flushes
+     * the queue before it's drawn. Their render states are resolved once, when they're queued. When the queue
+     * flushes, the commands sharing the buffers, program, uniforms, textures and render states are drawn with one
+     * instanced draw, their model view transforms are uploaded to a transform buffer per draw. When disabled, the
+     * default materials are drawn one by one, and the programs taking the instance transform by an instanced draw
+     * each.
+     */
+    void setAutoInstancing(bool enabled) { _autoInstancing = enabled; }
+    bool isAutoInstancing() const { return _autoInstancing; }
+
+    /**
+     * Enable/disable joining the TrianglesCommands to an earlier batch of the same material, enabled by default.
+     *
+     * Without it only the consecutive TrianglesCommands are batched, so a panel of widgets whose backgrounds and
+     * titles interleave is drawn by a draw per command. When enabled, a command whose vertices lie on one plane
+     * z = const is moved to the latest batch of its material if it doesn't overlap any command drawn between them,
+     * the commands of such a panel are drawn by a draw per atlas. The overlap is tested with the bounds of the
+     * transformed vertices, over at most BATCH_REORDER_WINDOW commands.
+     */
+    void setBatchReordering(bool enabled) { _batchReordering = enabled; }
+    bool isBatchReordering() const { return _batchReordering; }
+
+    /**
+     * Record the commands the next frame renders to a file, which RenderCaptureReplay replays without the GPU.
+     *
+     * Used to compare the batching of a scene before and after a change to the renderer, the counts of the replay
+     * only depend on the recorded frame.
+     */
+    void captureNextFrame(std::string_view path) { _capturePath = path; }
 
     /**
      Set render targets. If not set, will use default render targets. It will effect all commands.
@@ -422,6 +475,7 @@ public:
 protected:
     friend class Director;
     friend class GroupCommand;
+    friend class RenderCaptureReplay;
 
     /**
      * Create and reuse vertex and index buffer for triangleCommand.
@@ -438,6 +492,11 @@ protected:
          */
         void init();
 
+        using BufferFactory = std::function<backend::Buffer*(std::size_t size, backend::BufferType type)>;
+
+        /** Create all the buffers with the factory, e.g. buffers which don't belong to the backend. */
+        void init(BufferFactory factory);
+
         /**
          * Reset avalable buffer index to zero.
          * That means when get vertex buffer or index buffer, the earliest created buffer object in the cache will be
@@ -458,6 +517,7 @@ protected:
         void createBuffer();
 
         int _currentBufferIndex = 0;
+        BufferFactory _bufferFactory;
         std::vector<backend::Buffer*> _vertexBufferPool;
         std::vector<backend::Buffer*> _indexBufferPool;
     };
@@ -467,6 +527,46 @@ protected:
     void drawCustomCommand(RenderCommand* command);
     void drawMeshCommand(RenderCommand* command);
 
+    // the state an instanced draw merges the MeshCommands by, resolved once when the command is queued
+    struct InstancingKey
+    {
+        backend::Buffer* vertexBuffer = nullptr;
+        backend::Buffer* indexBuffer  = nullptr;
+        backend::Program* program     = nullptr;  // the program of the instanced draw
+        uint64_t uniforms             = 0;        // hash of the uniforms but the MVP matrix
+        uint64_t textures             = 0;
+        std::size_t indexDrawOffset   = 0;
+        std::size_t indexDrawCount    = 0;
+        backend::ColorWriteMask writeMask{};
+        backend::BlendOperation rgbBlendOperation{};
+        backend::BlendOperation alphaBlendOperation{};
+        backend::BlendFactor sourceRGBBlendFactor{};
+        backend::BlendFactor destinationRGBBlendFactor{};
+        backend::BlendFactor sourceAlphaBlendFactor{};
+        backend::BlendFactor destinationAlphaBlendFactor{};
+        backend::CompareFunction depthFunc{};
+        backend::PrimitiveType primitiveType{};
+        backend::IndexFormat indexFormat{};
+        CullMode cullMode{};
+        Winding winding{};
+        bool blendEnabled = false;
+        bool wireframe    = false;
+        bool depthTest    = false;
+        bool depthWrite   = false;
+
+        auto operator<=>(const InstancingKey&) const = default;
+    };
+    struct QueuedMeshCommand
+    {
+        InstancingKey key;
+        MeshCommand* command = nullptr;
+    };
+    backend::Program* getInstancedProgram(MeshCommand* command) const;
+    bool resolveInstancing(MeshCommand* command, backend::Program* program, QueuedMeshCommand& queued);
+    void drawInstancedMeshCommands(const QueuedMeshCommand* commands, size_t count);
+    backend::Buffer* getNextInstanceBuffer(size_t size);
+    backend::ProgramState* getNextInstanceProgramState(backend::ProgramState* programState, backend::Program* program);
+
     bool beginFrame();  /// Indicate the begining of a frame
     void endFrame();    /// Finish a frame.
 
@@ -484,7 +584,7 @@ protected:
     void visitRenderQueue(RenderQueue& queue);
     void doVisitRenderQueue(const std::vector<RenderCommand*>&);
 
-    void fillVerticesAndIndices(const TrianglesCommand* cmd, unsigned int vertexBufferOffset);
+    int findTriBatch(const TrianglesCommand* cmd, int commandIndex, int batchesTotal) const;
 
     void pushStateBlock();
 
@@ -502,6 +602,15 @@ protected:
 
     std::vector<TrianglesCommand*> _queuedTriangleCommands;
 
+    // for the automatic instancing of MeshCommand
+    bool _autoInstancing = true;
+    std::vector<QueuedMeshCommand> _queuedMeshCommands;
+    std::vector<Mat4> _instanceTransforms;
+    std::vector<backend::Buffer*> _instanceBufferPool;
+    size_t _instanceBufferIndex = 0;
+    std::vector<backend::ProgramState*> _instanceProgramStatePool;  // of the instanced variants of the programs
+    size_t _instanceProgramStateIndex = 0;
+
     // the pool for callback commands
     std::vector<CallbackCommand*> _callbackCommandsPool;
 
@@ -526,7 +635,24 @@ protected:
         TrianglesCommand* cmd      = nullptr;  // needed for the Material
         unsigned int indicesToDraw = 0;
         unsigned int offset        = 0;
+        unsigned int filledIndex   = 0;  // where the indices of the next command of the batch are written
+        int firstCommand           = 0;  // the queued command which started the batch
+        bool batchable             = true;
     };
+    // The placement of a queued TrianglesCommand, the bounds are valid only if batch reordering is enabled
+    struct TriCommandPlacement
+    {
+        unsigned int vertexOffset;
+        int batch;
+        float minX, minY, maxX, maxY;
+        float z;
+        bool planar;  // all vertices have the same z
+    };
+    std::vector<TriCommandPlacement> _triCommandPlacements;
+    bool _batchReordering = true;
+
+    std::string _capturePath;
+    std::unique_ptr<RenderCapture> _capture;
     // capacity of the array of TriBatches
     int _triBatchesToDrawCapacity = 500;
     // the TriBatches
@@ -540,8 +666,11 @@ protected:
     unsigned int _filledVertex           = 0;
 
     // stats
-    size_t _drawnBatches  = 0;
-    size_t _drawnVertices = 0;
+    size_t _drawnBatches              = 0;
+    size_t _drawnVertices             = 0;
+    size_t _drawnInstancedBatches     = 0;
+    size_t _drawnInstances            = 0;
+    size_t _reorderedTriangleCommands = 0;
     // the flag for checking whether renderer is rendering
     bool _isRendering      = false;
     bool _isDepthTestFor2D = false;
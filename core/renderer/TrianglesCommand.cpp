@@ -42,6 +42,16 @@ void TrianglesCommand::init(float globalOrder,
                             const Triangles& triangles,
                             const Mat4& mv,
                             uint32_t flags)
+{
+    init(globalOrder, texture->getBackendTexture(), blendType, triangles, mv, flags);
+}
+
+void TrianglesCommand::init(float globalOrder,
+                            backend::TextureBackend* texture,
+                            const BlendFunc& blendType,
+                            const Triangles& triangles,
+                            const Mat4& mv,
+                            uint32_t flags)
 {
     RenderCommand::init(globalOrder, mv, flags);
 
@@ -55,10 +65,10 @@ void TrianglesCommand::init(float globalOrder,
     _mv = mv;
 
     auto batchId = _pipelineDescriptor.programState->getBatchId();
-    if (_batchId != batchId || _texture != texture->getBackendTexture() || _blendType != blendType)
+    if (_batchId != batchId || _texture != texture || _blendType != blendType)
     {
         _batchId   = batchId;
-        _texture   = texture->getBackendTexture();
+        _texture   = texture;
         _blendType = blendType;
 
         // TODO: minggo set it in Node?
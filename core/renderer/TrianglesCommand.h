@@ -88,6 +88,13 @@ public:
               const Triangles& triangles,
               const Mat4& mv,
               uint32_t flags);
+    /** Initializes the command with a backend texture, e.g. one which doesn't belong to a Texture2D. */
+    void init(float globalOrder,
+              backend::TextureBackend* texture,
+              const BlendFunc& blendType,
+              const Triangles& triangles,
+              const Mat4& mv,
+              uint32_t flags);
     /**Get the material id of command.*/
     uint32_t getMaterialID() const { return _materialID; }
     /**Get a const reference of triangles.*/
@@ -102,6 +109,10 @@ public:
     const unsigned short* getIndices() const { return _triangles.indices; }
     /**Get the model view matrix.*/
     const Mat4& getModelView() const { return _mv; }
+    /**Get the texture the triangles are drawn with.*/
+    backend::TextureBackend* getTexture() const { return _texture; }
+    /**Get the blend function the triangles are drawn with.*/
+    const BlendFunc& getBlendType() const { return _blendType; }
 
     /** update material ID */
     void updateMaterialID();
@@ -233,9 +233,18 @@ public:
      */
     void setStencilReferenceValue(unsigned int frontRef, unsigned int backRef);
 
+    /**
+     * Get the uniform uploads since the last reset, the backends without the upload tracking report nothing.
+     */
+    const UniformUploadStats& getUniformUploadStats() const { return _uniformUploadStats; }
+
+    void resetUniformUploadStats() { _uniformUploadStats = {}; }
+
 protected:
     virtual ~CommandBuffer() = default;
 
+    mutable UniformUploadStats _uniformUploadStats;
+
     unsigned int _stencilReferenceValueFront = 0;  ///< front stencil reference value.
     unsigned int _stencilReferenceValueBack  = 0;  ///< back stencil reference value.
 };
@@ -185,6 +185,16 @@ public:
      */
     virtual bool checkForFeatureSupported(FeatureType feature) = 0;
 
+    /**
+     * Compile and link a program into the program binary cache, without creating the program.
+     * Called on a thread with a context shares objects with the render context, see ProgramManager::warmupPrograms.
+     * @return false if the driver has no program binary cache or the program failed to link.
+     */
+    virtual bool cacheProgramBinary(std::string_view /*vertexShader*/, std::string_view /*fragmentShader*/)
+    {
+        return false;
+    }
+
     /**
      * Get maximum texture size.
      * @return Maximum texture size.
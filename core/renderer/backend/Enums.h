@@ -367,6 +367,7 @@ struct ProgramType
         POSITION_TEXTURE_3D,                  // positionTexture3D_vert,          colorTexture_frag
         POSITION_TEXTURE_3D_INSTANCE,         // positionTextureInstance_vert,    colorTexture_frag
         POSITION_3D,                          // positionTexture_vert,            color_frag
+        POSITION_3D_INSTANCE,                 // positionInstance_vert,           color_frag
         POSITION_BUMPEDNORMAL_TEXTURE_3D,     // positionNormalTexture_vert,      colorNormalTexture_frag
         SKINPOSITION_BUMPEDNORMAL_TEXTURE_3D, // skinPositionNormalTexture_vert,  colorNormalTexture_frag
         PARTICLE_TEXTURE_3D,                  // particle_vert,                   particleTexture_frag
@@ -0,0 +1,151 @@
+/****************************************************************************
+ Copyright (c) 2019-present Axmol Engine contributors (see AUTHORS.md).
+
+ https://axmol.dev/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#include "ProgramBinaryCache.h"
+#include "platform/FileUtils.h"
+#include "base/Logging.h"
+
+#include "xxhash.h"
+#include <string.h>
+#include <thread>
+
+NS_AX_BACKEND_BEGIN
+
+namespace
+{
+constexpr uint32_t BINARY_MAGIC   = 0x42505841;  // 'AXPB'
+constexpr uint32_t BINARY_VERSION = 1;
+
+struct BinaryHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t driverHash;
+    uint64_t key;
+    uint64_t checksum;  // of the binary
+    uint32_t format;
+    uint32_t size;
+};
+}  // namespace
+
+ProgramBinaryCache::ProgramBinaryCache(std::string_view cacheDir, std::string_view driverId)
+    : _cacheDir(cacheDir), _driverHash(XXH3_64bits(driverId.data(), driverId.length()))
+{
+    if (!_cacheDir.empty() && _cacheDir.back() != '/')
+        _cacheDir.push_back('/');
+}
+
+uint64_t ProgramBinaryCache::computeKey(std::string_view vertexShader, std::string_view fragmentShader)
+{
+    // chained, so moving text from one source to another changes the key
+    auto vertexHash = XXH3_64bits_withSeed(vertexShader.data(), vertexShader.length(), vertexShader.length());
+    return XXH3_64bits_withSeed(fragmentShader.data(), fragmentShader.length(), vertexHash);
+}
+
+std::string ProgramBinaryCache::getEntryPath(uint64_t key) const
+{
+    return fmt::format("{}{:016x}.bin", _cacheDir, key);
+}
+
+bool ProgramBinaryCache::load(uint64_t key, uint32_t& format, std::vector<uint8_t>& binary)
+{
+    auto fileUtils = FileUtils::getInstance();
+    auto path      = getEntryPath(key);
+
+    std::vector<uint8_t> data;
+    if (fileUtils->getContents(path, &data) != FileUtils::Status::OK)
+    {
+        ++_misses;
+        return false;
+    }
+
+    BinaryHeader header;
+    bool valid = data.size() >= sizeof(header);
+    if (valid)
+    {
+        memcpy(&header, data.data(), sizeof(header));
+        valid = header.magic == BINARY_MAGIC && header.version == BINARY_VERSION &&
+                header.driverHash == _driverHash && header.key == key &&
+                header.size == data.size() - sizeof(header) &&
+                header.checksum == XXH3_64bits(data.data() + sizeof(header), header.size);
+    }
+    if (!valid)
+    {
+        // stale after a driver update, or a torn write
+        AXLOGD("ProgramBinaryCache: removing the invalid entry {}", path);
+        invalidate(key);
+        ++_misses;
+        return false;
+    }
+
+    format = header.format;
+    binary.assign(data.begin() + sizeof(header), data.end());
+    ++_hits;
+    return true;
+}
+
+bool ProgramBinaryCache::contains(uint64_t key) const
+{
+    return FileUtils::getInstance()->isFileExist(getEntryPath(key));
+}
+
+bool ProgramBinaryCache::save(uint64_t key, uint32_t format, const void* binary, size_t size)
+{
+    BinaryHeader header{BINARY_MAGIC, BINARY_VERSION, _driverHash, key,
+                        XXH3_64bits(binary, size),
+                        format, static_cast<uint32_t>(size)};
+    std::vector<uint8_t> data(sizeof(header) + size);
+    memcpy(data.data(), &header, sizeof(header));
+    memcpy(data.data() + sizeof(header), binary, size);
+
+    auto fileUtils = FileUtils::getInstance();
+    if (!fileUtils->isDirectoryExist(_cacheDir))
+        fileUtils->createDirectories(_cacheDir);
+
+    // write aside then rename, so a reader or a crash never sees a partial entry
+    auto path    = getEntryPath(key);
+    auto tmpPath = fmt::format("{}.{:x}.tmp", path, std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    if (!FileUtils::writeBinaryToFile(data.data(), data.size(), tmpPath))
+        return false;
+    if (!fileUtils->renameFile(tmpPath, path))
+    {
+        fileUtils->removeFile(tmpPath);
+        return false;
+    }
+    return true;
+}
+
+void ProgramBinaryCache::invalidate(uint64_t key)
+{
+    if (FileUtils::getInstance()->removeFile(getEntryPath(key)))
+        ++_invalidated;
+}
+
+void ProgramBinaryCache::clear()
+{
+    auto fileUtils = FileUtils::getInstance();
+    if (fileUtils->isDirectoryExist(_cacheDir))
+        fileUtils->removeDirectory(_cacheDir);
+}
+
+NS_AX_BACKEND_END
@@ -0,0 +1,97 @@
+/****************************************************************************
+ Copyright (c) 2019-present Axmol Engine contributors (see AUTHORS.md).
+
+ https://axmol.dev/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#pragma once
+
+#include "Macros.h"
+#include "platform/PlatformMacros.h"
+
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <vector>
+
+NS_AX_BACKEND_BEGIN
+/**
+ * @addtogroup _backend
+ * @{
+ */
+
+/**
+ * Persist the linked program binaries of the driver, so the next launches skip compiling and linking the shaders.
+ *
+ * An entry is keyed by the hash of the shader sources, and records the hash of the driver id and a checksum of the
+ * binary. Entries of another driver or with a bad checksum are removed on load, the caller should also invalidate
+ * an entry the driver rejects. It only touches files, load and save can be called from any thread.
+ */
+class AX_DLL ProgramBinaryCache
+{
+public:
+    /**
+     * @param cacheDir The directory of the cache files, created on the first save.
+     * @param driverId Identifies the driver and its version, binaries are only valid for the same driver.
+     */
+    ProgramBinaryCache(std::string_view cacheDir, std::string_view driverId);
+
+    /** The key of a program, a hash of its vertex and fragment shader sources */
+    static uint64_t computeKey(std::string_view vertexShader, std::string_view fragmentShader);
+
+    /**
+     * Load the binary of a program.
+     * @return true if hit, false if no entry or the entry is invalid, an invalid entry is removed.
+     */
+    bool load(uint64_t key, uint32_t& format, std::vector<uint8_t>& binary);
+
+    /** Whether a valid entry of the current driver may exist, without reading the binary */
+    bool contains(uint64_t key) const;
+
+    /** Save the binary of a program, replaces the old entry */
+    bool save(uint64_t key, uint32_t format, const void* binary, size_t size);
+
+    /** Remove an entry, e.g. the driver failed to link its binary */
+    void invalidate(uint64_t key);
+
+    /** Remove all entries */
+    void clear();
+
+    const std::string& getCacheDir() const { return _cacheDir; }
+    uint64_t getDriverHash() const { return _driverHash; }
+
+    int getHitCount() const { return _hits; }
+    int getMissCount() const { return _misses; }
+    int getInvalidatedCount() const { return _invalidated; }
+
+protected:
+    std::string getEntryPath(uint64_t key) const;
+
+    std::string _cacheDir;
+    uint64_t _driverHash;
+
+    std::atomic<int> _hits{0};
+    std::atomic<int> _misses{0};
+    std::atomic<int> _invalidated{0};
+};
+
+// end of _backend group
+/// @}
+NS_AX_BACKEND_END
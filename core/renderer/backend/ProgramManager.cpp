@@ -29,6 +29,8 @@
 #include "renderer/Shaders.h"
 #include "base/Macros.h"
 #include "base/Configuration.h"
+#include "base/Director.h"
+#include "platform/GLView.h"
 
 #include "xxhash.h"
 #include <inttypes.h>
@@ -133,6 +135,7 @@ bool ProgramManager::init()
     registerProgram(ProgramType::POSITION_TEXTURE_3D_INSTANCE, positionTextureInstance_vert, colorTexture_frag,
                     VertexLayoutType::Unspec);
     registerProgram(ProgramType::POSITION_3D, position_vert, color_frag, VertexLayoutType::Unspec);
+    registerProgram(ProgramType::POSITION_3D_INSTANCE, positionInstance_vert, color_frag, VertexLayoutType::Unspec);
     registerProgram(ProgramType::POSITION_NORMAL_3D, positionNormalTexture_vert, colorNormal_frag,
                     VertexLayoutType::Unspec);
     registerProgram(ProgramType::POSITION_BUMPEDNORMAL_TEXTURE_3D, positionNormalTexture_vert_1,
@@ -222,6 +225,61 @@ Program* ProgramManager::loadProgram(std::string_view vsName,
     return program;
 }
 
+void ProgramManager::warmupPrograms(std::vector<uint64_t> progIds, std::function<void()> callback)
+{
+    // resolve the paths here, the job only reads the files
+    auto fileUtils = FileUtils::getInstance();
+    std::vector<std::pair<std::string, std::string>> files;
+    for (auto progId : progIds)
+    {
+        if (_cachedPrograms.find(progId) != _cachedPrograms.end())
+            continue;
+
+        const BuiltinRegInfo* info = nullptr;
+        if (progId < ProgramType::BUILTIN_COUNT)
+            info = &_builtinRegistry[progId];
+        else if (auto it = _customRegistry.find(progId); it != _customRegistry.end())
+            info = &it->second;
+        if (info && !info->vsName.empty())
+            files.emplace_back(fileUtils->fullPathForFilename(info->vsName), fileUtils->fullPathForFilename(info->fsName));
+    }
+
+    auto finish = [progIds = std::move(progIds), callback = std::move(callback)] {
+        // the binaries are cached now, loading only links them
+        if (_sharedProgramManager)
+        {
+            for (auto progId : progIds)
+                _sharedProgramManager->loadProgram(progId);
+        }
+        if (callback)
+            callback();
+    };
+
+    auto director = Director::getInstance();
+    auto glView   = director->getGLView();
+    auto context  = (!files.empty() && glView) ? glView->createSharedContext() : nullptr;
+    if (!context)
+    {
+        finish();
+        return;
+    }
+
+    director->getJobSystem()->enqueue(
+        [glView, context, files = std::move(files)] {
+            glView->makeSharedContextCurrent(context);
+            auto fileUtils = FileUtils::getInstance();
+            auto driver    = DriverBase::getInstance();
+            for (auto& [vertFile, fragFile] : files)
+                driver->cacheProgramBinary(fileUtils->getStringFromFile(vertFile),
+                                           fileUtils->getStringFromFile(fragFile));
+            glView->makeSharedContextCurrent(nullptr);
+        },
+        [glView, context, finish = std::move(finish)] {
+            glView->destroySharedContext(context);
+            finish();
+        });
+}
+
 uint64_t ProgramManager::registerCustomProgram(std::string_view vsName,
                                                std::string_view fsName,
                                                VertexLayoutType vlt,
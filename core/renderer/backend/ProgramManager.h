@@ -30,9 +30,11 @@
 #include "platform/PlatformMacros.h"
 #include "Program.h"
 
+#include <functional>
 #include <string>
 #include <unordered_map>
 #include <string_view>
+#include <vector>
 #include "ProgramStateRegistry.h"
 
 struct XXH64_state_s;
@@ -88,6 +90,15 @@ public:
                                std::string_view fsName,
                                VertexLayoutType vlt = VertexLayoutType::Unspec);
 
+    /**
+     * Warm up programs before they are used, e.g. while the loading scene is shown.
+     * With the program binary cache of the driver and a shared context of the view, the programs missed in the
+     * cache are compiled on a job thread, then all are loaded from the cache, otherwise they are loaded directly.
+     * @param progIds The builtin program types or the ids returned by registerCustomProgram.
+     * @param callback Invoked on the axmol thread when all programs loaded.
+     */
+    void warmupPrograms(std::vector<uint64_t> progIds, std::function<void()> callback = nullptr);
+
      /**
      * Unload a program object from cache.
      * @param program Specifies the program object to move.
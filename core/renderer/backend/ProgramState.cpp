@@ -165,7 +165,8 @@ bool ProgramState::init(Program* program)
     _fragmentUniformBufferSize = _program->getUniformBufferSize(ShaderStage::FRAGMENT);
 #endif
 
-    _uniformBuffers.resize((std::max)(_vertexUniformBufferSize + _fragmentUniformBufferSize, (size_t)1), 0);
+    _uniformBuffer = std::make_shared<UniformBuffer>();
+    _uniformBuffer->data.resize((std::max)(_vertexUniformBufferSize + _fragmentUniformBufferSize, (size_t)1), 0);
 
 #if AX_ENABLE_CACHE_TEXTURE_DATA
     _backToForegroundListener =
@@ -182,7 +183,55 @@ bool ProgramState::init(Program* program)
 
 void ProgramState::updateBatchId()
 {
-    _batchId = XXH64(_uniformBuffers.data(), _uniformBuffers.size(), _program->getProgramId());
+    auto& data = _uniformBuffer->data;
+    _batchId   = XXH64(data.data(), data.size(), _program->getProgramId());
+}
+
+uint64_t ProgramState::getUniformHash() const
+{
+    auto& ub = *_uniformBuffer;
+    if (ub.hashDirty)
+    {
+        ub.hash      = XXH3_64bits(ub.data.data(), ub.data.size());
+        ub.hashDirty = false;
+    }
+    return ub.hash;
+}
+
+std::ptrdiff_t ProgramState::getUniformBufferOffset(const backend::UniformLocation& uniformLocation) const
+{
+    // the same offsets setVertexUniform and setFragmentUniform write at
+    if (uniformLocation.vertStage)
+    {
+        if (uniformLocation.vertStage.offset < 0)
+            return -1;
+#if AX_GLES_PROFILE != 200
+        return uniformLocation.vertStage.location + uniformLocation.vertStage.offset;
+#else
+        return uniformLocation.vertStage.offset;
+#endif
+    }
+#ifdef AX_USE_METAL
+    if (uniformLocation.fragStage && uniformLocation.fragStage.offset >= 0)
+        return _vertexUniformBufferSize + uniformLocation.fragStage.location + uniformLocation.fragStage.offset;
+#endif
+    return -1;
+}
+
+void ProgramState::writeUniformBuffer(std::size_t offset, const void* data, std::size_t size)
+{
+    auto dst = _uniformBuffer->data.data() + offset;
+    if (memcmp(dst, data, size) == 0)
+        return;
+
+    // copy on write, the clones keep the old content
+    if (_uniformBuffer.use_count() > 1)
+    {
+        _uniformBuffer = std::make_shared<UniformBuffer>(*_uniformBuffer);
+        dst            = _uniformBuffer->data.data() + offset;
+    }
+    memcpy(dst, data, size);
+    _uniformBuffer->hashDirty = true;
 }
 
 void ProgramState::resetUniforms()
@@ -223,7 +272,7 @@ ProgramState* ProgramState::clone() const
     ProgramState* cp          = new ProgramState(_program);
     cp->_vertexTextureInfos   = _vertexTextureInfos;
     cp->_fragmentTextureInfos = _fragmentTextureInfos;
-    cp->_uniformBuffers       = _uniformBuffers;
+    cp->_uniformBuffer        = _uniformBuffer;
 
     cp->_ownVertexLayout = _ownVertexLayout;
     cp->_vertexLayout    = !_ownVertexLayout ? _vertexLayout : new VertexLayout(*_vertexLayout);
@@ -263,10 +312,10 @@ void ProgramState::setVertexUniform(int location, const void* data, std::size_t
         return;
 #if AX_GLES_PROFILE != 200
     assert(location + offset + size <= _vertexUniformBufferSize);
-    memcpy(_uniformBuffers.data() + location + offset, data, size);
+    writeUniformBuffer(location + offset, data, size);
 #else
     assert(offset + size <= _vertexUniformBufferSize);
-    memcpy(_uniformBuffers.data() + offset, data, size);
+    writeUniformBuffer(offset, data, size);
 #endif
 }
 
@@ -276,7 +325,7 @@ void ProgramState::setFragmentUniform(int location, const void* data, std::size_
     if (location < 0)
         return;
 
-    memcpy(_uniformBuffers.data() + _vertexUniformBufferSize + location + offset, data, size);
+    writeUniformBuffer(_vertexUniformBufferSize + location + offset, data, size);
 }
 #endif
 
@@ -431,13 +480,13 @@ ProgramState::AutoBindingResolver::~AutoBindingResolver()
 const char* ProgramState::getVertexUniformBuffer(std::size_t& size) const
 {
     size = _vertexUniformBufferSize;
-    return _uniformBuffers.data();
+    return _uniformBuffer->data.data();
 }
 
 const char* ProgramState::getFragmentUniformBuffer(std::size_t& size) const
 {
     size = _fragmentUniformBufferSize;
-    return _uniformBuffers.data() + _vertexUniformBufferSize;
+    return _uniformBuffer->data.data() + _vertexUniformBufferSize;
 }
 
 NS_AX_BACKEND_END
@@ -30,6 +30,7 @@
 #include <unordered_map>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include "platform/PlatformMacros.h"
 #include "base/Object.h"
 #include "base/EventListenerCustom.h"
@@ -227,6 +228,19 @@ public:
      */
     const char* getFragmentUniformBuffer(std::size_t& size) const;
 
+    /**
+     * Get the hash of the uniform buffer content, it's computed once and kept until a uniform changes.
+     * The clones share the uniform buffer and its hash, until one of them sets a different value.
+     */
+    uint64_t getUniformHash() const;
+
+    /**
+     * Get the offset of a uniform in the uniform buffer, where setUniform writes it. The fragment uniforms follow the
+     * vertex ones, so the offset is relative to the vertex uniform buffer.
+     * @return The offset in bytes, or -1 if the location isn't in the uniform buffer, e.g. the one of a sampler.
+     */
+    std::ptrdiff_t getUniformBufferOffset(const backend::UniformLocation& uniformLocation) const;
+
     /**
      * An abstract base class that can be extended to support custom material auto bindings.
      *
@@ -384,9 +398,19 @@ protected:
      */
     void applyAutoBinding(std::string_view, std::string_view);
 
+    /// Write the uniform data at the offset of the uniform buffer, the buffer is copied if shared and changed.
+    void writeUniformBuffer(std::size_t offset, const void* data, std::size_t size);
+
+    struct UniformBuffer
+    {
+        yasio::sbyte_buffer data;
+        mutable uint64_t hash  = 0;
+        mutable bool hashDirty = true;
+    };
+
     backend::Program* _program = nullptr;
     std::unordered_map<UniformLocation, UniformCallback, UniformLocation> _callbackUniforms;
-    yasio::sbyte_buffer _uniformBuffers;
+    std::shared_ptr<UniformBuffer> _uniformBuffer;  // immutable while shared with the clones
     std::size_t _vertexUniformBufferSize   = 0;
     std::size_t _fragmentUniformBufferSize = 0;
 
@@ -95,6 +95,15 @@ struct UniformLocation
     std::size_t operator()(const UniformLocation& uniform) const; // used as a hash function
 };
 
+/**
+ * @brief the uniform uploads of the draws, a block or uniform unchanged since the last upload of its program is skipped
+ */
+struct UniformUploadStats
+{
+    uint32_t uploaded = 0;
+    uint32_t skipped  = 0;
+};
+
 struct AttributeBindInfo
 {
     int location = -1;
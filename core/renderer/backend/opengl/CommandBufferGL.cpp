@@ -387,7 +387,7 @@ void CommandBufferGL::bindUniforms(ProgramGL* program) const
 
         std::size_t bufferSize = 0;
         auto buffer            = _programState->getVertexUniformBuffer(bufferSize);
-        program->bindUniformBuffers(buffer, bufferSize);
+        program->bindUniformBuffers(buffer, bufferSize, _programState->getUniformHash(), _uniformUploadStats);
 
         const auto& textureInfo = _programState->getVertexTextureInfos();
         for (const auto& iter : textureInfo)
@@ -35,6 +35,8 @@
 #include "RenderTargetGL.h"
 #include "MacrosGL.h"
 #include "renderer/backend/ProgramManager.h"
+#include "renderer/backend/ProgramBinaryCache.h"
+#include "platform/FileUtils.h"
 #if !defined(__APPLE__) && AX_TARGET_PLATFORM != AX_PLATFORM_WINRT
 #    include "CommandBufferGLES2.h"
 #endif
@@ -169,6 +171,18 @@ DriverGL::DriverGL()
 
     glGetIntegerv(GL_FRAMEBUFFER_BINDING, &_defaultFBO);
 
+#if AX_GL_PROGRAM_BINARY
+    // core since GL 4.1 and GLES 3.0, the binaries are only valid for the same driver
+    GLint numBinaryFormats = 0;
+    if (_verInfo.es || _verInfo.major > 4 || (_verInfo.major == 4 && _verInfo.minor >= 1) ||
+        hasExtension("GL_ARB_get_program_binary"sv))
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numBinaryFormats);
+    if (numBinaryFormats > 0)
+        _programBinaryCache = std::make_shared<ProgramBinaryCache>(
+            FileUtils::getInstance()->getNativeWritableAbsolutePath() + "axslc-cache/",
+            fmt::format("{}|{}|{}|{}", _vendor, _renderer, _version, _shaderVer));
+#endif
+
 #if AX_GLES_PROFILE != 200
     glGenVertexArrays(1, &_defaultVAO);
     glBindVertexArray(_defaultVAO);
@@ -252,6 +266,11 @@ Program* DriverGL::newProgram(std::string_view vertexShader, std::string_view fr
     return new ProgramGL(vertexShader, fragmentShader);
 }
 
+bool DriverGL::cacheProgramBinary(std::string_view vertexShader, std::string_view fragmentShader)
+{
+    return _programBinaryCache && ProgramGL::cacheProgramBinary(_programBinaryCache.get(), vertexShader, fragmentShader);
+}
+
 void DriverGL::resetState()
 {
     OpenGLState::reset();
@@ -29,7 +29,12 @@
 #include "OpenGLState.h"
 #include "base/hlookup.h"
 
+#include <memory>
+
 NS_AX_BACKEND_BEGIN
+
+class ProgramBinaryCache;
+
 /**
  * @addtogroup _opengl
  * @{
@@ -138,6 +143,14 @@ public:
      */
     bool checkForFeatureSupported(FeatureType feature) override;
 
+    bool cacheProgramBinary(std::string_view vertexShader, std::string_view fragmentShader) override;
+
+    /**
+     * The cache of the linked program binaries in the writable path.
+     * @return nullptr if the driver can't retrieve the program binaries.
+     */
+    const std::shared_ptr<ProgramBinaryCache>& getProgramBinaryCache() const { return _programBinaryCache; }
+
     /*
     * Check does the device only support GLES2.0
     */
@@ -172,6 +185,8 @@ private:
 
     bool _textureCompressionAstc = false;
     bool _textureCompressionEtc2 = false;
+
+    std::shared_ptr<ProgramBinaryCache> _programBinaryCache;
 };
 // end of _opengl group
 /// @}
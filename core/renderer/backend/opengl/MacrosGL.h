@@ -26,6 +26,13 @@
 
 #include "base/Macros.h"
 
+// GLES2 and WebGL can't retrieve the program binaries
+#if AX_GLES_PROFILE != 200 && AX_TARGET_PLATFORM != AX_PLATFORM_WASM
+#    define AX_GL_PROGRAM_BINARY 1
+#else
+#    define AX_GL_PROGRAM_BINARY 0
+#endif
+
 #if !defined(_AX_DEBUG) || _AX_DEBUG == 0
 #    define CHECK_GL_ERROR_DEBUG()
 #else
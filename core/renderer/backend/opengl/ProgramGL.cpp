@@ -33,6 +33,8 @@
 #include "base/axstd.h"
 #include "yasio/byte_buffer.hpp"
 #include "renderer/backend/opengl/UtilsGL.h"
+#include "renderer/backend/opengl/DriverGL.h"
+#include "renderer/backend/ProgramBinaryCache.h"
 #include "OpenGLState.h"
 
 NS_AX_BACKEND_BEGIN
@@ -118,14 +120,111 @@ static void setUniform(bool isArray, GLuint location, unsigned int size, GLenum
 }
 #endif
 
+static GLuint linkProgram(GLuint vertShader, GLuint fragShader, bool retrievable)
+{
+    GLuint program = glCreateProgram();
+    if (!program)
+        return 0;
+
+    glAttachShader(program, vertShader);
+    glAttachShader(program, fragShader);
+#if AX_GL_PROGRAM_BINARY
+    if (retrievable)
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+#endif
+
+    glLinkProgram(program);
+
+    GLint status = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (GL_FALSE == status)
+    {
+        GLint errorInfoLen = 0;
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &errorInfoLen);
+        if (errorInfoLen > 1)
+        {
+            auto errorInfo = axstd::make_unique_for_overwrite<char[]>(static_cast<size_t>(errorInfoLen));
+            glGetProgramInfoLog(program, errorInfoLen, NULL, errorInfo.get());
+            AXLOGE("axmol:ERROR: {}: failed to link program: {} ", __FUNCTION__, errorInfo.get());
+        }
+        else
+            AXLOGE("axmol:ERROR: {}: failed to link program ", __FUNCTION__);
+        glDeleteProgram(program);
+        program = 0;
+    }
+    return program;
+}
+
+#if AX_GL_PROGRAM_BINARY
+static GLuint loadProgramBinary(ProgramBinaryCache* cache, uint64_t key)
+{
+    uint32_t format = 0;
+    std::vector<uint8_t> binary;
+    if (!cache->load(key, format, binary))
+        return 0;
+
+    GLuint program = glCreateProgram();
+    if (!program)
+        return 0;
+    glProgramBinary(program, format, binary.data(), static_cast<GLsizei>(binary.size()));
+
+    GLint status = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (GL_FALSE == status)
+    {
+        // the driver may reject a binary even for the same version, e.g. the GPU changed
+        AXLOGW("axmol: the cached program binary {:016x} was rejected, compiling from source", key);
+        glDeleteProgram(program);
+        cache->invalidate(key);
+        return 0;
+    }
+    return program;
+}
+
+static std::vector<uint8_t> getProgramBinary(GLuint program, GLenum& format)
+{
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return {};
+
+    std::vector<uint8_t> binary(length);
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+    binary.resize((std::max)(length, 0));
+    return binary;
+}
+#endif
+
+bool ProgramGL::cacheProgramBinary(ProgramBinaryCache* cache,
+                                   std::string_view vertexShader,
+                                   std::string_view fragmentShader)
+{
+#if AX_GL_PROGRAM_BINARY
+    auto key = ProgramBinaryCache::computeKey(vertexShader, fragmentShader);
+    if (cache->contains(key))
+        return true;
+
+    ShaderModuleGL vertexShaderModule(ShaderStage::VERTEX, vertexShader);
+    ShaderModuleGL fragmentShaderModule(ShaderStage::FRAGMENT, fragmentShader);
+    if (!vertexShaderModule.getShader() || !fragmentShaderModule.getShader())
+        return false;
+
+    auto program = linkProgram(vertexShaderModule.getShader(), fragmentShaderModule.getShader(), true);
+    if (!program)
+        return false;
+
+    GLenum format = 0;
+    auto binary   = getProgramBinary(program, format);
+    glDeleteProgram(program);
+    return !binary.empty() && cache->save(key, format, binary.data(), binary.size());
+#else
+    return false;
+#endif
+}
+
 ProgramGL::ProgramGL(std::string_view vertexShader, std::string_view fragmentShader)
     : Program(vertexShader, fragmentShader)
 {
-    _vertexShaderModule   = static_cast<ShaderModuleGL*>(ShaderCache::getInstance()->newVertexShaderModule(_vertexShader));
-    _fragmentShaderModule = static_cast<ShaderModuleGL*>(ShaderCache::getInstance()->newFragmentShaderModule(_fragmentShader));
-
-    AX_SAFE_RETAIN(_vertexShaderModule);
-    AX_SAFE_RETAIN(_fragmentShaderModule);
     compileProgram();
     computeUniformInfos();
 #if AX_ENABLE_CACHE_TEXTURE_DATA
@@ -165,8 +264,13 @@ void ProgramGL::reloadProgram()
     _activeUniformInfos.clear();
     _mapToCurrentActiveLocation.clear();
     _mapToOriginalLocation.clear();
-    static_cast<ShaderModuleGL*>(_vertexShaderModule)->compileShader(backend::ShaderStage::VERTEX, _vertexShader);
-    static_cast<ShaderModuleGL*>(_fragmentShaderModule)->compileShader(backend::ShaderStage::FRAGMENT, _fragmentShader);
+    // the context was lost, the old objects are gone with it
+    _program = 0;
+    if (_vertexShaderModule && _fragmentShaderModule)
+    {
+        _vertexShaderModule->compileShader(backend::ShaderStage::VERTEX, _vertexShader);
+        _fragmentShaderModule->compileShader(backend::ShaderStage::FRAGMENT, _fragmentShader);
+    }
     compileProgram();
     computeUniformInfos();
 
@@ -181,6 +285,23 @@ void ProgramGL::reloadProgram()
 
 void ProgramGL::compileProgram()
 {
+#if AX_GL_PROGRAM_BINARY
+    auto& cache  = static_cast<DriverGL*>(DriverBase::getInstance())->getProgramBinaryCache();
+    uint64_t key = cache ? ProgramBinaryCache::computeKey(_vertexShader, _fragmentShader) : 0;
+    if (cache && (_program = loadProgramBinary(cache.get(), key)) != 0)
+        return;
+#endif
+
+    // the shaders are only compiled when the binary missed
+    if (_vertexShaderModule == nullptr)
+    {
+        _vertexShaderModule =
+            static_cast<ShaderModuleGL*>(ShaderCache::getInstance()->newVertexShaderModule(_vertexShader));
+        _fragmentShaderModule =
+            static_cast<ShaderModuleGL*>(ShaderCache::getInstance()->newFragmentShaderModule(_fragmentShader));
+        AX_SAFE_RETAIN(_vertexShaderModule);
+        AX_SAFE_RETAIN(_fragmentShaderModule);
+    }
     if (_vertexShaderModule == nullptr || _fragmentShaderModule == nullptr)
         return;
 
@@ -191,32 +312,20 @@ void ProgramGL::compileProgram()
     if (vertShader == 0 || fragShader == 0)
         return;
 
-    _program = glCreateProgram();
-    if (!_program)
-        return;
-
-    glAttachShader(_program, vertShader);
-    glAttachShader(_program, fragShader);
-
-    glLinkProgram(_program);
-
-    GLint status = 0;
-    glGetProgramiv(_program, GL_LINK_STATUS, &status);
-    if (GL_FALSE == status)
+#if AX_GL_PROGRAM_BINARY
+    _program = linkProgram(vertShader, fragShader, cache != nullptr);
+    if (_program && cache)
     {
-        GLint errorInfoLen = 0;
-        glGetProgramiv(_program, GL_INFO_LOG_LENGTH, &errorInfoLen);
-        if (errorInfoLen > 1)
-        {
-            auto errorInfo = axstd::make_unique_for_overwrite<char[]>(static_cast<size_t>(errorInfoLen));
-            glGetProgramInfoLog(_program, errorInfoLen, NULL, errorInfo.get());
-            AXLOGE("axmol:ERROR: {}: failed to link program: {} ", __FUNCTION__, errorInfo.get());
-        }
-        else
-            AXLOGE("axmol:ERROR: {}: failed to link program ", __FUNCTION__);
-        glDeleteProgram(_program);
-        _program = 0;
+        // write the file on a job thread, the job holds the cache in case the driver is destroyed first
+        GLenum format = 0;
+        auto binary   = getProgramBinary(_program, format);
+        if (!binary.empty())
+            Director::getInstance()->getJobSystem()->enqueue(
+                [cache, key, format, binary = std::move(binary)] { cache->save(key, format, binary.data(), binary.size()); });
     }
+#else
+    _program = linkProgram(vertShader, fragShader, false);
+#endif
 }
 
 void ProgramGL::setBuiltinLocations()
@@ -411,15 +520,33 @@ void ProgramGL::computeUniformInfos()
 
         _maxLocation = _maxLocation <= uniform.location ? (uniform.location + 1) : _maxLocation;
     }
+
+    // new buffers or uniforms, nothing uploaded yet
+    _uploadedUniforms.resize(_totalBufferSize);
+    _uniformsUploaded = false;
 }
 
-void ProgramGL::bindUniformBuffers(const char* buffer, size_t bufferSize)
+void ProgramGL::bindUniformBuffers(const char* buffer, size_t bufferSize, uint64_t hash, UniformUploadStats& stats)
 {
+    assert(bufferSize >= _totalBufferSize);
+
+    // The program keeps the uploaded data, the uniform buffers and the GLES2 uniforms, until the next upload,
+    // so a block unchanged since the last draw with this program doesn't need to be uploaded again.
+    const bool unchanged = _uniformsUploaded && _uploadedHash == hash;
+    auto uploaded        = _uploadedUniforms.data();
 #if AX_GLES_PROFILE != 200
     for (GLuint blockIdx = 0; blockIdx < static_cast<GLuint>(_uniformBuffers.size()); ++blockIdx)
     {
         auto& desc = _uniformBuffers[blockIdx];
-        desc._ubo->updateData(buffer + desc._location, desc._size);
+        if (!unchanged &&
+            (!_uniformsUploaded || memcmp(uploaded + desc._location, buffer + desc._location, desc._size) != 0))
+        {
+            // whole block respecified, let the driver orphan the buffer instead of waiting the draws using it
+            desc._ubo->updateData(buffer + desc._location, desc._size);
+            ++stats.uploaded;
+        }
+        else
+            ++stats.skipped;
         __gl->bindUniformBufferBase(blockIdx, desc._ubo->getHandler());
     }
 #else
@@ -429,12 +556,27 @@ void ProgramGL::bindUniformBuffers(const char* buffer, size_t bufferSize)
         if (uniformInfo.size <= 0)
             continue;
 
+        auto data = buffer + uniformInfo.bufferOffset;
+        if (unchanged || (_uniformsUploaded && memcmp(uploaded + uniformInfo.bufferOffset, data,
+                                                      uniformInfo.size * uniformInfo.count) == 0))
+        {
+            ++stats.skipped;
+            continue;
+        }
+
         int elementCount = uniformInfo.count;
-        setUniform(uniformInfo.count > 1, uniformInfo.location, elementCount, uniformInfo.type,
-                   (void*)(buffer + uniformInfo.bufferOffset));
+        setUniform(uniformInfo.count > 1, uniformInfo.location, elementCount, uniformInfo.type, (void*)data);
+        ++stats.uploaded;
     }
 #endif
 
+    if (!unchanged)
+    {
+        memcpy(uploaded, buffer, _totalBufferSize);
+        _uploadedHash     = hash;
+        _uniformsUploaded = true;
+    }
+
     CHECK_GL_ERROR_DEBUG();
 }
 
@@ -39,10 +39,12 @@
 #include <unordered_map>
 
 #include "base/axstd.h"
+#include "yasio/byte_buffer.hpp"
 
 NS_AX_BACKEND_BEGIN
 
 class ShaderModuleGL;
+class ProgramBinaryCache;
 
 /**
  * Store attribute information.
@@ -161,7 +163,17 @@ public:
      */
     virtual const hlookup::string_map<UniformInfo>& getAllActiveUniformInfo(ShaderStage stage) const override;
 
-    void bindUniformBuffers(const char* buffer, size_t bufferSize);
+    /**
+     * Upload the uniform buffer of a program state, the blocks or uniforms unchanged since the last upload are skipped.
+     * @param hash The hash of the buffer content, the whole upload is skipped if it matches the last one.
+     */
+    void bindUniformBuffers(const char* buffer, size_t bufferSize, uint64_t hash, UniformUploadStats& stats);
+
+    /**
+     * Compile and link a program into the binary cache, without creating a ProgramGL.
+     * It can be called on a thread with a context shares objects with the render context.
+     */
+    static bool cacheProgramBinary(ProgramBinaryCache* cache, std::string_view vertexShader, std::string_view fragmentShader);
 
 private:
     void compileProgram();
@@ -186,6 +198,11 @@ private:
 
     axstd::pod_vector<UniformBlockDescriptor> _uniformBuffers;
 
+    // the uniform buffer content of the last upload
+    yasio::sbyte_buffer _uploadedUniforms;
+    uint64_t _uploadedHash  = 0;
+    bool _uniformsUploaded = false;
+
     std::vector<AttributeInfo> _attributeInfos;
     hlookup::string_map<UniformInfo> _activeUniformInfos;
     mutable hlookup::string_map<AttributeBindInfo> _activeAttribs;
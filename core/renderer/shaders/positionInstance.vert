@@ -0,0 +1,25 @@
+#version 310 es
+
+layout (location = POSITION) in vec4 a_position;
+#if !defined(METAL)
+layout (location = TEXCOORD1) in mat4 a_instance;
+#endif
+
+layout(std140, binding = 0) uniform vs_ub {
+    mat4 u_MVPMatrix;
+};
+
+#if defined(METAL)
+layout(std140, binding = 1) buffer vs_inst {
+    mat4 u_instance[];
+};
+#endif
+
+void main(void)
+{
+#if defined(METAL)
+    gl_Position = u_MVPMatrix * u_instance[gl_InstanceIndex] * a_position;
+#else
+    gl_Position = u_MVPMatrix * a_instance * a_position;
+#endif
+}
@@ -31,6 +31,7 @@ THE SOFTWARE.
 #include "base/Director.h"
 #include "renderer/Renderer.h"
 #include "ui/UILayoutManager.h"
+#include "ui/UIScrollView.h"
 #include "2d/DrawNode.h"
 #include "2d/Layer.h"
 #include "2d/Sprite.h"
@@ -74,6 +75,7 @@ Layout::Layout()
     , _clippingRectDirty(true)
     , _stencilStateManager(new StencilStateManager())
     , _doLayoutDirty(true)
+    , _layoutManager(nullptr)
     , _isInterceptTouch(false)
     , _loopFocus(false)
     , _passFocusToChild(true)
@@ -85,6 +87,7 @@ Layout::Layout()
 Layout::~Layout()
 {
     AX_SAFE_RELEASE(_clippingStencil);
+    AX_SAFE_RELEASE(_layoutManager);
     AX_SAFE_DELETE(_stencilStateManager);
 }
 
@@ -880,6 +883,10 @@ const Vec2& Layout::getBackGroundImageTextureSize() const
 
 void Layout::setLayoutType(Type type)
 {
+    if (_layoutType != type)
+    {
+        AX_SAFE_RELEASE_NULL(_layoutManager);
+    }
     _layoutType = type;
 
     for (auto&& child : _children)
@@ -909,6 +916,46 @@ void Layout::requestDoLayout()
     _doLayoutDirty = true;
 }
 
+void Layout::onChildLayoutChanged()
+{
+    if (_layoutType == Type::ABSOLUTE)
+    {
+        return;
+    }
+    requestDoLayout();
+
+    // The inner container of a scroll view is sized by the scroll view, e.g. a list view sums the sizes of its items
+    auto scrollView = dynamic_cast<ScrollView*>(_parent);
+    if (scrollView && scrollView->getInnerContainer() == this)
+    {
+        scrollView->requestDoLayout();
+    }
+}
+
+static struct
+{
+    unsigned int frame;
+    Layout::LayoutStats current;
+    Layout::LayoutStats last;
+} s_layoutStats;
+
+static void updateLayoutStatsFrame()
+{
+    unsigned int frame = Director::getInstance()->getTotalFrames();
+    if (frame != s_layoutStats.frame)
+    {
+        s_layoutStats.last    = frame == s_layoutStats.frame + 1 ? s_layoutStats.current : Layout::LayoutStats{};
+        s_layoutStats.current = Layout::LayoutStats{};
+        s_layoutStats.frame   = frame;
+    }
+}
+
+Layout::LayoutStats Layout::getLastFrameLayoutStats()
+{
+    updateLayoutStatsFrame();
+    return s_layoutStats.last;
+}
+
 Vec2 Layout::getLayoutContentSize() const
 {
     return this->getContentSize();
@@ -955,11 +1002,19 @@ void Layout::doLayout()
 
     sortAllChildren();
 
-    LayoutManager* executant = this->createLayoutManager();
+    if (!_layoutManager)
+    {
+        _layoutManager = this->createLayoutManager();
+        AX_SAFE_RETAIN(_layoutManager);
+    }
 
-    if (executant)
+    if (_layoutManager)
     {
-        executant->doLayout(this);
+        _layoutManager->doLayout(this);
+
+        updateLayoutStatsFrame();
+        s_layoutStats.current.passes++;
+        s_layoutStats.current.arrangedChildren += static_cast<unsigned int>(_children.size());
     }
 
     _doLayoutDirty = false;
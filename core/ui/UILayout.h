@@ -404,6 +404,26 @@ public:
      */
     virtual void requestDoLayout();
 
+    /**
+     * Called by a child widget when its size or layout parameter changed, the layout is refreshed if its layout
+     * manager places the child. A layout doesn't resize itself to the children, so the change doesn't go further up.
+     */
+    void onChildLayoutChanged();
+
+    /**
+     * The layout passes run by all layouts in a frame, and the children arranged by them.
+     */
+    struct LayoutStats
+    {
+        unsigned int passes;
+        unsigned int arrangedChildren;
+    };
+
+    /**
+     * Get the layout passes run in the last frame.
+     */
+    static LayoutStats getLastFrameLayoutStats();
+
     /**
      * @lua NA
      */
@@ -647,6 +667,7 @@ protected:
     //CallbackCommand _afterVisitCmdScissor;
 
     bool _doLayoutDirty;
+    LayoutManager* _layoutManager;  // kept until the layout type changes
     bool _isInterceptTouch;
 
     // whether enable loop focus or not
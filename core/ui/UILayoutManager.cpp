@@ -42,7 +42,7 @@ LinearHorizontalLayoutManager* LinearHorizontalLayoutManager::create()
 void LinearHorizontalLayoutManager::doLayout(LayoutProtocol* layout)
 {
     Vec2 layoutSize         = layout->getLayoutContentSize();
-    Vector<Node*> container = layout->getLayoutElements();
+    const auto& container   = layout->getLayoutElements();
     float leftBoundary      = 0.0f;
     for (auto&& subWidget : container)
     {
@@ -92,7 +92,7 @@ LinearVerticalLayoutManager* LinearVerticalLayoutManager::create()
 void LinearVerticalLayoutManager::doLayout(LayoutProtocol* layout)
 {
     Vec2 layoutSize         = layout->getLayoutContentSize();
-    Vector<Node*> container = layout->getLayoutElements();
+    const auto& container   = layout->getLayoutElements();
     float topBoundary       = layoutSize.height;
 
     for (auto&& subWidget : container)
@@ -284,7 +284,7 @@ RelativeLayoutManager* RelativeLayoutManager::create()
 
 Vector<Widget*> RelativeLayoutManager::getAllWidgets(ax::ui::LayoutProtocol* layout)
 {
-    Vector<Node*> container = layout->getLayoutElements();
+    const auto& container = layout->getLayoutElements();
     Vector<Widget*> widgetChildren;
     for (auto&& subWidget : container)
     {
@@ -648,11 +648,14 @@ void RelativeLayoutManager::calculateFinalPositionWithRelativeAlign()
 
 void RelativeLayoutManager::doLayout(LayoutProtocol* layout)
 {
+    _unlayoutChildCount = 0;
+    _widgetChildren     = this->getAllWidgets(layout);
 
-    _widgetChildren = this->getAllWidgets(layout);
-
-    while (_unlayoutChildCount > 0)
+    // Each round places the children whose relative widgets are placed, a round placing nothing ends the loop
+    bool placed = true;
+    while (_unlayoutChildCount > 0 && placed)
     {
+        placed = false;
         for (auto&& subWidget : _widgetChildren)
         {
             _widget = static_cast<Widget*>(subWidget);
@@ -678,9 +681,10 @@ void RelativeLayoutManager::doLayout(LayoutProtocol* layout)
                 _widget->setPosition(Vec2(_finalPositionX, _finalPositionY));
 
                 layoutParameter->_put = true;
+                _unlayoutChildCount--;
+                placed = true;
             }
         }
-        _unlayoutChildCount--;
     }
     _widgetChildren.clear();
 }
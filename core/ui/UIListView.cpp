@@ -47,6 +47,8 @@ ListView::ListView()
     , _curSelectedIndex(-1)
     , _innerContainerDoLayoutDirty(true)
     , _eventCallback(nullptr)
+    , _virtualItemCount(0)
+    , _virtualFirstIndex(0)
 {
     this->setTouchEnabled(true);
 }
@@ -54,6 +56,7 @@ ListView::ListView()
 ListView::~ListView()
 {
     _items.clear();
+    _virtualPool.clear();
     AX_SAFE_RELEASE(_model);
 }
 
@@ -108,6 +111,24 @@ void ListView::onItemListChanged()
 
 void ListView::updateInnerContainerSize()
 {
+    if (_virtualRenderer)
+    {
+        float length = 0.0f;
+        if (_virtualItemCount > 0)
+        {
+            ssize_t last = _virtualItemCount - 1;
+            Size size    = getVirtualItemSize(last);
+            length       = getVirtualItemOffset(last) + (_direction == Direction::HORIZONTAL
+                                                              ? size.width + _leftPadding + _rightPadding
+                                                              : size.height + _topPadding + _bottomPadding);
+        }
+        if (_direction == Direction::HORIZONTAL)
+            setInnerContainerSize(Vec2(length, _contentSize.height));
+        else
+            setInnerContainerSize(Vec2(_contentSize.width, length));
+        return;
+    }
+
     switch (_direction)
     {
     case Direction::VERTICAL:
@@ -242,6 +263,7 @@ void ListView::remedyLayoutParameter(Widget* item)
 
 void ListView::pushBackDefaultItem()
 {
+    AXASSERT(!_virtualRenderer, "The items of a virtual list are set by setVirtualItemCount");
     if (nullptr == _model)
     {
         return;
@@ -254,6 +276,7 @@ void ListView::pushBackDefaultItem()
 
 void ListView::insertDefaultItem(ssize_t index)
 {
+    AXASSERT(!_virtualRenderer, "The items of a virtual list are set by setVirtualItemCount");
     if (nullptr == _model)
     {
         return;
@@ -263,6 +286,7 @@ void ListView::insertDefaultItem(ssize_t index)
 
 void ListView::pushBackCustomItem(Widget* item)
 {
+    AXASSERT(!_virtualRenderer, "The items of a virtual list are set by setVirtualItemCount");
     remedyLayoutParameter(item);
     addChild(item);
     requestDoLayout();
@@ -342,6 +366,7 @@ void ListView::removeAllChildrenWithCleanup(bool cleanup)
 
 void ListView::insertCustomItem(Widget* item, ssize_t index)
 {
+    AXASSERT(!_virtualRenderer, "The items of a virtual list are set by setVirtualItemCount");
     if (-1 != _curSelectedIndex)
     {
         if (_curSelectedIndex >= index)
@@ -360,6 +385,7 @@ void ListView::insertCustomItem(Widget* item, ssize_t index)
 
 void ListView::removeItem(ssize_t index)
 {
+    AXASSERT(!_virtualRenderer, "The items of a virtual list are set by setVirtualItemCount");
     Widget* item = getItem(index);
     if (nullptr == item)
     {
@@ -375,11 +401,20 @@ void ListView::removeLastItem()
 
 void ListView::removeAllItems()
 {
+    if (_virtualRenderer)
+    {
+        setVirtualItemCount(0);
+        return;
+    }
     removeAllChildren();
 }
 
 Widget* ListView::getItem(ssize_t index) const
 {
+    if (_virtualRenderer)
+    {
+        index -= _virtualFirstIndex;
+    }
     if (index < 0 || index >= _items.size())
     {
         return nullptr;
@@ -398,7 +433,256 @@ ssize_t ListView::getIndex(Widget* item) const
     {
         return -1;
     }
-    return _items.getIndex(item);
+    ssize_t index = _items.getIndex(item);
+    if (_virtualRenderer && index >= 0)
+    {
+        index += _virtualFirstIndex;
+    }
+    return index;
+}
+
+ssize_t ListView::getItemCount() const
+{
+    return _virtualRenderer ? _virtualItemCount : _items.size();
+}
+
+void ListView::setVirtual(const ccListViewItemRenderer& renderer, const ccListViewItemCreator& creator)
+{
+    ScrollView::removeAllChildrenWithCleanup(true);
+    _items.clear();
+    _virtualPool.clear();
+    _curSelectedIndex  = -1;
+    _virtualRenderer   = renderer;
+    _virtualCreator    = creator;
+    _virtualFirstIndex = 0;
+    _virtualItemSize   = Size::ZERO;
+    onItemListChanged();
+
+    // The virtual items are placed by the list itself, the inner container doesn't lay them out
+    if (_direction == Direction::VERTICAL || _direction == Direction::HORIZONTAL)
+    {
+        setLayoutType(renderer ? Type::ABSOLUTE
+                               : (_direction == Direction::HORIZONTAL ? Type::HORIZONTAL : Type::VERTICAL));
+    }
+    requestDoLayout();
+}
+
+void ListView::setVirtualItemCount(ssize_t count)
+{
+    AXASSERT(count >= 0, "Invalid item count");
+    _virtualItemCount = count;
+    if (_curSelectedIndex >= count)
+    {
+        _curSelectedIndex = -1;
+    }
+    onItemListChanged();
+    requestDoLayout();
+}
+
+void ListView::setVirtualItemSizer(const ccListViewItemSizer& sizer)
+{
+    _virtualSizer = sizer;
+    requestDoLayout();
+}
+
+void ListView::refreshVirtualItems()
+{
+    if (!_virtualRenderer)
+    {
+        return;
+    }
+    for (ssize_t i = 0, count = _items.size(); i < count; ++i)
+    {
+        _virtualRenderer(_items.at(i), _virtualFirstIndex + i);
+    }
+}
+
+Widget* ListView::createVirtualItem()
+{
+    Widget* item = _virtualCreator ? _virtualCreator() : (_model ? _model->clone() : nullptr);
+    AXASSERT(item, "Set an item creator or an item model to a virtual list");
+    return item;
+}
+
+Size ListView::getVirtualItemSize(ssize_t itemIndex) const
+{
+    return _virtualSizer ? _virtualSizer(itemIndex) : _virtualItemSize;
+}
+
+float ListView::getVirtualItemOffset(ssize_t itemIndex) const
+{
+    if (_virtualSizer)
+    {
+        return _virtualOffsets[itemIndex];
+    }
+    float length = _direction == Direction::HORIZONTAL ? _virtualItemSize.width : _virtualItemSize.height;
+    return itemIndex * (length + _itemsMargin);
+}
+
+ssize_t ListView::getVirtualItemIndexAtOffset(float offset) const
+{
+    ssize_t index = 0;
+    if (_virtualSizer)
+    {
+        auto first = _virtualOffsets.begin();
+        index      = std::upper_bound(first, first + _virtualItemCount, offset) - first - 1;
+    }
+    else
+    {
+        float length = _direction == Direction::HORIZONTAL ? _virtualItemSize.width : _virtualItemSize.height;
+        if (length + _itemsMargin > 0.0f)
+        {
+            index = static_cast<ssize_t>(std::floor(offset / (length + _itemsMargin)));
+        }
+    }
+    return std::clamp<ssize_t>(index, 0, _virtualItemCount - 1);
+}
+
+void ListView::updateVirtualOffsets()
+{
+    _virtualOffsets.clear();
+    if (!_virtualSizer)
+    {
+        return;
+    }
+    _virtualOffsets.resize(_virtualItemCount);
+    float offset = 0.0f;
+    for (ssize_t i = 0; i < _virtualItemCount; ++i)
+    {
+        _virtualOffsets[i] = offset;
+        Vec2 size          = _virtualSizer(i);
+        offset += (_direction == Direction::HORIZONTAL ? size.x : size.y) + _itemsMargin;
+    }
+}
+
+Rect ListView::getVirtualItemBoundingBox(ssize_t itemIndex, const Size& size) const
+{
+    // Same as the linear layout of a normal list
+    const Size& layoutSize = _innerContainer->getContentSize();
+    float offset           = getVirtualItemOffset(itemIndex);
+    Vec2 origin;
+    if (_direction == Direction::HORIZONTAL)
+    {
+        switch (_gravity)
+        {
+        case Gravity::BOTTOM:
+            origin.y = 0.0f;
+            break;
+        case Gravity::CENTER_VERTICAL:
+            origin.y = (layoutSize.height - size.height) / 2.0f;
+            break;
+        default:
+            origin.y = layoutSize.height - size.height;
+            break;
+        }
+        origin.x = _leftPadding + offset;
+        origin.y -= _topPadding;
+    }
+    else
+    {
+        switch (_gravity)
+        {
+        case Gravity::RIGHT:
+            origin.x = layoutSize.width - size.width;
+            break;
+        case Gravity::CENTER_HORIZONTAL:
+            origin.x = (layoutSize.width - size.width) / 2.0f;
+            break;
+        default:
+            origin.x = 0.0f;
+            break;
+        }
+        origin.x += _leftPadding;
+        origin.y = layoutSize.height - _topPadding - offset - size.height;
+    }
+    return Rect(origin, size);
+}
+
+void ListView::updateVirtualItems(bool rerender)
+{
+    if (!_virtualRenderer || _innerContainerDoLayoutDirty)
+    {
+        return;
+    }
+
+    // The items in the view, and one more on both sides
+    ssize_t first = 0, last = -1;
+    if (_virtualItemCount > 0)
+    {
+        Vec2 viewOrigin = -_innerContainer->getPosition();
+        float start, end;
+        if (_direction == Direction::HORIZONTAL)
+        {
+            start = viewOrigin.x - _leftPadding;
+            end   = start + _contentSize.width;
+        }
+        else
+        {
+            start = _innerContainer->getContentSize().height - _topPadding - viewOrigin.y - _contentSize.height;
+            end   = start + _contentSize.height;
+        }
+        first = std::max<ssize_t>(getVirtualItemIndexAtOffset(start) - 1, 0);
+        last  = std::min<ssize_t>(getVirtualItemIndexAtOffset(end) + 1, _virtualItemCount - 1);
+    }
+
+    ssize_t count = _items.size();
+    if (!rerender && first == _virtualFirstIndex && last == _virtualFirstIndex + count - 1)
+    {
+        return;
+    }
+
+    // Keep the items still in the range, and recycle the others
+    std::vector<Widget*> items(std::max<ssize_t>(last - first + 1, 0), nullptr);
+    for (ssize_t i = 0; i < count; ++i)
+    {
+        Widget* item  = _items.at(i);
+        ssize_t index = _virtualFirstIndex + i;
+        if (index >= first && index <= last)
+        {
+            items[index - first] = item;
+        }
+        else
+        {
+            _virtualPool.pushBack(item);
+            ScrollView::removeChild(item, false);
+        }
+    }
+    _items.clear();
+    _virtualFirstIndex = first;
+
+    for (ssize_t i = 0, size = items.size(); i < size; ++i)
+    {
+        Widget* item = items[i];
+        if (item == nullptr)
+        {
+            if (!_virtualPool.empty())
+            {
+                item = _virtualPool.back();
+                ScrollView::addChild(item);
+                _virtualPool.popBack();
+            }
+            else if ((item = createVirtualItem()) != nullptr)
+            {
+                ScrollView::addChild(item);
+            }
+            else
+            {
+                break;
+            }
+        }
+        else if (!rerender)
+        {
+            _items.pushBack(item);
+            continue;
+        }
+        _items.pushBack(item);
+
+        ssize_t index = first + i;
+        _virtualRenderer(item, index);
+        Rect box       = getVirtualItemBoundingBox(index, item->getBoundingBox().size);
+        const Vec2& ap = item->getAnchorPoint();
+        item->setPosition(Vec2(box.origin.x + ap.x * box.size.width, box.origin.y + ap.y * box.size.height));
+    }
 }
 
 void ListView::setGravity(Gravity gravity)
@@ -529,10 +813,10 @@ void ListView::setDirection(Direction dir)
     case Direction::BOTH:
         break;
     case Direction::VERTICAL:
-        setLayoutType(Type::VERTICAL);
+        setLayoutType(_virtualRenderer ? Type::ABSOLUTE : Type::VERTICAL);
         break;
     case Direction::HORIZONTAL:
-        setLayoutType(Type::HORIZONTAL);
+        setLayoutType(_virtualRenderer ? Type::ABSOLUTE : Type::HORIZONTAL);
         break;
     default:
         return;
@@ -548,6 +832,32 @@ void ListView::requestDoLayout()
 
 void ListView::doLayout()
 {
+    if (_virtualRenderer)
+    {
+        if (_innerContainerDoLayoutDirty)
+        {
+            // All items have the size of the first item created, unless they are sized by the sizer
+            if (!_virtualSizer && _virtualItemSize.equals(Size::ZERO) && _virtualItemCount > 0)
+            {
+                if (Widget* item = createVirtualItem())
+                {
+                    _virtualRenderer(item, 0);
+                    _virtualItemSize = item->getBoundingBox().size;
+                    _virtualPool.pushBack(item);
+                }
+            }
+            updateVirtualOffsets();
+            updateInnerContainerSize();
+            _innerContainerDoLayoutDirty = false;
+            updateVirtualItems(true);
+        }
+        else
+        {
+            updateVirtualItems(false);
+        }
+        return;
+    }
+
     if (!_innerContainerDoLayoutDirty)
     {
         return;
@@ -674,6 +984,10 @@ static Widget* findClosestItem(const Vec2& targetPosition,
 
 Widget* ListView::getClosestItemToPosition(const Vec2& targetPosition, const Vec2& itemAnchorPoint) const
 {
+    if (_virtualRenderer)
+    {
+        return getItem(getClosestItemIndex(targetPosition, itemAnchorPoint));
+    }
     if (_items.empty())
     {
         return nullptr;
@@ -692,6 +1006,58 @@ Widget* ListView::getClosestItemToPosition(const Vec2& targetPosition, const Vec
                            distanceFromLast);
 }
 
+ssize_t ListView::getClosestItemIndex(const Vec2& targetPosition, const Vec2& itemAnchorPoint) const
+{
+    if (!_virtualRenderer)
+    {
+        return getIndex(getClosestItemToPosition(targetPosition, itemAnchorPoint));
+    }
+    if (_virtualItemCount == 0)
+    {
+        return -1;
+    }
+
+    // The item at the offset of the target, or one of its neighbors when the items differ in size
+    float offset          = _direction == Direction::HORIZONTAL
+                                ? targetPosition.x - _leftPadding
+                                : _innerContainer->getContentSize().height - _topPadding - targetPosition.y;
+    ssize_t index         = getVirtualItemIndexAtOffset(offset);
+    ssize_t last          = std::min(index + 1, _virtualItemCount - 1);
+    ssize_t closestIndex  = index;
+    float closestDistance = FLT_MAX;
+    for (ssize_t i = std::max<ssize_t>(index - 1, 0); i <= last; ++i)
+    {
+        float distance = (targetPosition - getItemPositionWithAnchor(i, itemAnchorPoint)).length();
+        if (distance < closestDistance)
+        {
+            closestIndex    = i;
+            closestDistance = distance;
+        }
+    }
+    return closestIndex;
+}
+
+Vec2 ListView::getItemPositionWithAnchor(ssize_t itemIndex, const Vec2& itemAnchorPoint) const
+{
+    if (!_virtualRenderer)
+    {
+        return calculateItemPositionWithAnchor(_items.at(itemIndex), itemAnchorPoint);
+    }
+    Rect box = getVirtualItemBoundingBox(itemIndex, getVirtualItemSize(itemIndex));
+    return Vec2(box.origin.x + box.size.width * itemAnchorPoint.x, box.origin.y + box.size.height * itemAnchorPoint.y);
+}
+
+Vec2 ListView::getItemDestination(ssize_t itemIndex, const Vec2& positionRatioInView, const Vec2& itemAnchorPoint) const
+{
+    Vec2 positionInView(_contentSize.width * positionRatioInView.x, _contentSize.height * positionRatioInView.y);
+    return -(getItemPositionWithAnchor(itemIndex, itemAnchorPoint) - positionInView);
+}
+
+Vec2 ListView::getItemContentSize(ssize_t itemIndex) const
+{
+    return _virtualRenderer ? getVirtualItemSize(itemIndex) : _items.at(itemIndex)->getContentSize();
+}
+
 Widget* ListView::getClosestItemToPositionInCurrentView(const Vec2& positionRatioInView,
                                                         const Vec2& itemAnchorPoint) const
 {
@@ -812,14 +1178,13 @@ void ListView::jumpToPercentBothDirection(const Vec2& percent)
 
 void ListView::jumpToItem(ssize_t itemIndex, const Vec2& positionRatioInView, const Vec2& itemAnchorPoint)
 {
-    Widget* item = getItem(itemIndex);
-    if (item == nullptr)
+    if (itemIndex < 0 || itemIndex >= getItemCount())
     {
         return;
     }
     doLayout();
 
-    Vec2 destination = calculateItemDestination(positionRatioInView, item, itemAnchorPoint);
+    Vec2 destination = getItemDestination(itemIndex, positionRatioInView, itemAnchorPoint);
     if (!_bounceEnabled)
     {
         Vec2 delta         = destination - getInnerContainerPosition();
@@ -839,12 +1204,12 @@ void ListView::scrollToItem(ssize_t itemIndex,
                             const Vec2& itemAnchorPoint,
                             float timeInSec)
 {
-    Widget* item = getItem(itemIndex);
-    if (item == nullptr)
+    if (itemIndex < 0 || itemIndex >= getItemCount())
     {
         return;
     }
-    ScrollView::scrollToItem(item, positionRatioInView, itemAnchorPoint, timeInSec);
+    startAutoScrollToDestination(getItemDestination(itemIndex, positionRatioInView, itemAnchorPoint), timeInSec,
+                                 true);
 }
 
 ssize_t ListView::getCurSelectedIndex() const
@@ -881,6 +1246,10 @@ Widget* ListView::createCloneInstance()
 
 void ListView::copyClonedWidgetChildren(Widget* model)
 {
+    if (_virtualRenderer)
+    {
+        return;
+    }
     auto& arrayItems = static_cast<ListView*>(model)->getItems();
     for (auto&& item : arrayItems)
     {
@@ -898,12 +1267,18 @@ void ListView::copySpecialProperties(Widget* model)
         setItemsMargin(listViewEx->_itemsMargin);
         setGravity(listViewEx->_gravity);
         _eventCallback = listViewEx->_eventCallback;
+        if (listViewEx->_virtualRenderer)
+        {
+            setVirtual(listViewEx->_virtualRenderer, listViewEx->_virtualCreator);
+            setVirtualItemSizer(listViewEx->_virtualSizer);
+            setVirtualItemCount(listViewEx->_virtualItemCount);
+        }
     }
 }
 
 Vec2 ListView::getHowMuchOutOfBoundary(const Vec2& addition)
 {
-    if (!_magneticAllowedOutOfBoundary || _items.empty())
+    if (!_magneticAllowedOutOfBoundary || getItemCount() == 0)
     {
         return ScrollView::getHowMuchOutOfBoundary(addition);
     }
@@ -922,29 +1297,29 @@ Vec2 ListView::getHowMuchOutOfBoundary(const Vec2& addition)
     float topBoundary    = _topBoundary;
     float bottomBoundary = _bottomBoundary;
     {
-        ssize_t lastItemIndex = _items.size() - 1;
+        ssize_t lastItemIndex = getItemCount() - 1;
         Vec2 contentSize      = getContentSize();
         Vec2 firstItemAdjustment, lastItemAdjustment;
         if (_magneticType == MagneticType::CENTER)
         {
-            firstItemAdjustment = (contentSize - _items.at(0)->getContentSize()) / 2;
-            lastItemAdjustment  = (contentSize - _items.at(lastItemIndex)->getContentSize()) / 2;
+            firstItemAdjustment = (contentSize - getItemContentSize(0)) / 2;
+            lastItemAdjustment  = (contentSize - getItemContentSize(lastItemIndex)) / 2;
         }
         else if (_magneticType == MagneticType::LEFT)
         {
-            lastItemAdjustment = contentSize - _items.at(lastItemIndex)->getContentSize();
+            lastItemAdjustment = contentSize - getItemContentSize(lastItemIndex);
         }
         else if (_magneticType == MagneticType::RIGHT)
         {
-            firstItemAdjustment = contentSize - _items.at(0)->getContentSize();
+            firstItemAdjustment = contentSize - getItemContentSize(0);
         }
         else if (_magneticType == MagneticType::TOP)
         {
-            lastItemAdjustment = contentSize - _items.at(lastItemIndex)->getContentSize();
+            lastItemAdjustment = contentSize - getItemContentSize(lastItemIndex);
         }
         else if (_magneticType == MagneticType::BOTTOM)
         {
-            firstItemAdjustment = contentSize - _items.at(0)->getContentSize();
+            firstItemAdjustment = contentSize - getItemContentSize(0);
         }
         leftBoundary += firstItemAdjustment.x;
         rightBoundary -= lastItemAdjustment.x;
@@ -1006,7 +1381,7 @@ void ListView::startAttenuatingAutoScroll(const Vec2& deltaMove, const Vec2& ini
 {
     Vec2 adjustedDeltaMove = deltaMove;
 
-    if (!_items.empty() && _magneticType != MagneticType::NONE)
+    if (getItemCount() > 0 && _magneticType != MagneticType::NONE)
     {
         adjustedDeltaMove = flattenVectorByDirection(adjustedDeltaMove);
 
@@ -1032,8 +1407,8 @@ void ListView::startAttenuatingAutoScroll(const Vec2& deltaMove, const Vec2& ini
             magneticPosition.x += getContentSize().width * magneticAnchorPoint.x;
             magneticPosition.y += getContentSize().height * magneticAnchorPoint.y;
 
-            Widget* pTargetItem = getClosestItemToPosition(magneticPosition - adjustedDeltaMove, magneticAnchorPoint);
-            Vec2 itemPosition   = calculateItemPositionWithAnchor(pTargetItem, magneticAnchorPoint);
+            ssize_t targetIndex = getClosestItemIndex(magneticPosition - adjustedDeltaMove, magneticAnchorPoint);
+            Vec2 itemPosition   = getItemPositionWithAnchor(targetIndex, magneticAnchorPoint);
             adjustedDeltaMove   = magneticPosition - itemPosition;
         }
     }
@@ -1042,7 +1417,7 @@ void ListView::startAttenuatingAutoScroll(const Vec2& deltaMove, const Vec2& ini
 
 void ListView::startMagneticScroll()
 {
-    if (_items.empty() || _magneticType == MagneticType::NONE)
+    if (getItemCount() == 0 || _magneticType == MagneticType::NONE)
     {
         return;
     }
@@ -1053,8 +1428,13 @@ void ListView::startMagneticScroll()
     magneticPosition.x += getContentSize().width * magneticAnchorPoint.x;
     magneticPosition.y += getContentSize().height * magneticAnchorPoint.y;
 
-    Widget* pTargetItem = getClosestItemToPosition(magneticPosition, magneticAnchorPoint);
-    scrollToItem(getIndex(pTargetItem), magneticAnchorPoint, magneticAnchorPoint);
+    scrollToItem(getClosestItemIndex(magneticPosition, magneticAnchorPoint), magneticAnchorPoint, magneticAnchorPoint);
+}
+
+void ListView::moveInnerContainer(const Vec2& deltaMove, bool canStartBounceBack)
+{
+    ScrollView::moveInnerContainer(deltaMove, canStartBounceBack);
+    updateVirtualItems(false);
 }
 
 }  // namespace ui
@@ -42,9 +42,8 @@ namespace ui
 /**
  *@brief ListView is a view group that displays a list of scrollable items.
  *The list items are inserted to the list by using `addChild` or  `insertDefaultItem`.
- * @warning The list item in ListView doesn't support cell reuse at the moment, if you have a large amount of data need
- *to be displayed, use  `TableView` instead. ListView is a subclass of  `ScrollView`, so it shares many features of
- *ScrollView.
+ *A large amount of data should be displayed by a virtual list, see `setVirtual`, which creates only the items visible
+ *and reuses them while scrolling. ListView is a subclass of  `ScrollView`, so it shares many features of ScrollView.
  */
 class AX_GUI_DLL ListView : public ScrollView
 {
@@ -95,6 +94,13 @@ public:
      */
     typedef std::function<void(Object*, EventType)> ccListViewCallback;
 
+    /**
+     * Callbacks of a virtual list, see `setVirtual`.
+     */
+    typedef std::function<void(Widget* item, ssize_t index)> ccListViewItemRenderer;
+    typedef std::function<Widget*()> ccListViewItemCreator;
+    typedef std::function<Vec2(ssize_t index)> ccListViewItemSizer;
+
     /**
      * Default constructor
      * @js ctor
@@ -190,6 +196,46 @@ public:
      */
     ssize_t getIndex(Widget* item) const;
 
+    /**
+     * Return the count of items, which is the virtual item count of a virtual list.
+     */
+    ssize_t getItemCount() const;
+
+    /**
+     * @brief Turn the list into a virtual list, which only creates the items visible and a few around them.
+     *
+     * The items scrolled out of the view are reused for the items scrolled in, the renderer fills an item with the
+     * data at an index. The items of a virtual list are not added by `pushBackCustomItem` and alike, the count is set
+     * by `setVirtualItemCount`. `getItems` returns the items created, and `getItem` returns nullptr for an index
+     * not created. Magnetic scroll, `jumpToItem` and `scrollToItem` work with all indices.
+     *
+     * @param renderer Fill an item with the data at an index, nullptr turns the list back into a normal list.
+     * @param creator Create an item, the item model is cloned if it's nullptr.
+     */
+    void setVirtual(const ccListViewItemRenderer& renderer, const ccListViewItemCreator& creator = nullptr);
+
+    /**
+     * Whether the list is a virtual list.
+     */
+    bool isVirtual() const { return _virtualRenderer != nullptr; }
+
+    /**
+     * Set the count of items of a virtual list, the items created are rendered again.
+     */
+    void setVirtualItemCount(ssize_t count);
+    ssize_t getVirtualItemCount() const { return _virtualItemCount; }
+
+    /**
+     * Set the size of each item of a virtual list when they differ, the renderer should resize an item to it.
+     * By default all items have the size of the first item created.
+     */
+    void setVirtualItemSizer(const ccListViewItemSizer& sizer);
+
+    /**
+     * Render the items created of a virtual list again, after the data changed.
+     */
+    void refreshVirtualItems();
+
     /**
      * Set the gravity of ListView.
      * @see `ListViewGravity`
@@ -443,6 +489,22 @@ protected:
 
     void startMagneticScroll();
 
+    void moveInnerContainer(const Vec2& deltaMove, bool canStartBounceBack) override;
+
+    // Work with the indices of a virtual list too, the items of them may not be created
+    ssize_t getClosestItemIndex(const Vec2& targetPosition, const Vec2& itemAnchorPoint) const;
+    Vec2 getItemPositionWithAnchor(ssize_t itemIndex, const Vec2& itemAnchorPoint) const;
+    Vec2 getItemDestination(ssize_t itemIndex, const Vec2& positionRatioInView, const Vec2& itemAnchorPoint) const;
+    Vec2 getItemContentSize(ssize_t itemIndex) const;
+
+    void updateVirtualItems(bool rerender);
+    void updateVirtualOffsets();
+    Vec2 getVirtualItemSize(ssize_t itemIndex) const;
+    float getVirtualItemOffset(ssize_t itemIndex) const;
+    ssize_t getVirtualItemIndexAtOffset(float offset) const;
+    Rect getVirtualItemBoundingBox(ssize_t itemIndex, const Size& size) const;
+    Widget* createVirtualItem();
+
 protected:
     Widget* _model;
 
@@ -464,6 +526,16 @@ protected:
 
     bool _innerContainerDoLayoutDirty;
     ccListViewCallback _eventCallback;
+
+    // virtual list, _items are the items created for the indices from _virtualFirstIndex
+    ccListViewItemRenderer _virtualRenderer;
+    ccListViewItemCreator _virtualCreator;
+    ccListViewItemSizer _virtualSizer;
+    ssize_t _virtualItemCount;
+    ssize_t _virtualFirstIndex;
+    Size _virtualItemSize;               // size of all items when there is no sizer
+    std::vector<float> _virtualOffsets;  // offsets of the items along the direction from the sizer
+    Vector<Widget*> _virtualPool;
 };
 
 }  // namespace ui
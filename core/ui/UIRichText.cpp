@@ -30,6 +30,7 @@
 #include <vector>
 #include <locale>
 #include <algorithm>
+#include <chrono>
 
 #include "platform/FileUtils.h"
 #include "platform/Application.h"
@@ -1241,7 +1242,14 @@ const std::string RichText::KEY_ANCHOR_TEXT_SHADOW_BLUR_RADIUS("KEY_ANCHOR_TEXT_
 const std::string RichText::KEY_ANCHOR_TEXT_GLOW_COLOR("KEY_ANCHOR_TEXT_GLOW_COLOR");
 const std::string RichText::KEY_ID("KEY_ID");
 
-RichText::RichText() : _formatTextDirty(true), _leftSpaceWidth(0.0f)
+RichText::RichText()
+    : _formatTextDirty(true)
+    , _formattedElementCount(0)
+    , _formattedWidth(0.0f)
+    , _leftSpaceWidth(0.0f)
+    , _joinableLabel(nullptr)
+    , _joinableElement(nullptr)
+    , _formatStats()
 {
     _defaults[KEY_VERTICAL_SPACE]           = 0.0f;
     _defaults[KEY_WRAP_MODE]                = static_cast<int>(WrapMode::WRAP_PER_WORD);
@@ -1331,6 +1339,25 @@ bool RichText::setString(std::string_view text)
     return true;
 }
 
+bool RichText::appendString(std::string_view text)
+{
+    if (text.empty())
+    {
+        return true;
+    }
+    _text.append(text);
+
+    // The elements parsed are pushed back, so only they are formatted
+    _xmlText.clear();
+    fmt::format_to(std::back_inserter(_xmlText), FMT_COMPILE(R"(<font face="{}" size="{}" color="{}">{}</font>)"),
+                   this->getFontFace(), this->getFontSize(), this->getFontColor(), text);
+
+    MyXMLVisitor visitor(this);
+    SAXParser parser;
+    parser.setDelegator(&visitor);
+    return parser.parseIntrusive(&_xmlText.front(), _xmlText.length(), SAXParser::ParseOption::HTML);
+}
+
 void RichText::initRenderer() {}
 
 void RichText::insertElement(RichElement* element, int index)
@@ -1342,7 +1369,6 @@ void RichText::insertElement(RichElement* element, int index)
 void RichText::pushBackElement(RichElement* element)
 {
     _richElements.pushBack(element);
-    _formatTextDirty = true;
 }
 
 void RichText::removeElement(int index)
@@ -1605,7 +1631,7 @@ void RichText::setDefaults(const ValueMap& defaults)
 {
     if (defaults.find(KEY_VERTICAL_SPACE) != defaults.end())
     {
-        _defaults[KEY_VERTICAL_SPACE] = defaults.at(KEY_VERTICAL_SPACE).asFloat();
+        setVerticalSpace(defaults.at(KEY_VERTICAL_SPACE).asFloat());
     }
     if (defaults.find(KEY_WRAP_MODE) != defaults.end())
     {
@@ -1763,168 +1789,229 @@ void RichText::setOpenUrlHandler(const OpenUrlHandler& handleOpenUrl)
     _handleOpenUrl = handleOpenUrl;
 }
 
+bool RichText::canFormatAppendedElements() const
+{
+    // The rows formatted are kept, the appended elements only change the rows after them and the height
+    return !_ignoreSize && _formattedWidth == _customSize.width &&
+           static_cast<HorizontalAlignment>(_defaults.at(KEY_HORIZONTAL_ALIGNMENT).asInt()) ==
+               HorizontalAlignment::LEFT;
+}
+
+bool RichText::isSameTextStyle(const RichElementText* a, const RichElementText* b)
+{
+    return a->_id.empty() && b->_id.empty() && a->_fontName == b->_fontName && a->_fontSize == b->_fontSize &&
+           a->_color == b->_color && a->_opacity == b->_opacity && a->_flags == b->_flags && a->_url == b->_url &&
+           a->_outlineColor == b->_outlineColor && a->_outlineSize == b->_outlineSize &&
+           a->_shadowColor == b->_shadowColor && a->_shadowOffset == b->_shadowOffset &&
+           a->_shadowBlurRadius == b->_shadowBlurRadius && a->_glowColor == b->_glowColor;
+}
+
 void RichText::formatText(bool force)
 {
     _formatTextDirty |= force;
+    ssize_t first = static_cast<ssize_t>(_formattedElementCount);
+    if (!_formatTextDirty)
+    {
+        if (first >= _richElements.size())
+        {
+            return;
+        }
+        _formatTextDirty = !canFormatAppendedElements();
+    }
+
+    auto start      = std::chrono::steady_clock::now();
+    size_t firstRow = _elementRenders.empty() ? 0 : _elementRenders.size() - 1;
     if (_formatTextDirty)
     {
         this->removeAllProtectedChildren();
         _elementRenders.clear();
         _lineHeights.clear();
-        if (_ignoreSize)
+        _joinableLabel   = nullptr;
+        _joinableElement = nullptr;
+        first            = 0;
+        firstRow         = 0;
+        addNewLine();
+    }
+    if (_ignoreSize)
+    {
+        for (ssize_t i = first, size = _richElements.size(); i < size; ++i)
         {
-            addNewLine();
-            for (ssize_t i = 0, size = _richElements.size(); i < size; ++i)
+            RichElement* element  = _richElements.at(i);
+            Node* elementRenderer = nullptr;
+            switch (element->_type)
             {
-                RichElement* element  = _richElements.at(i);
-                Node* elementRenderer = nullptr;
-                switch (element->_type)
-                {
-                case RichElement::Type::TEXT:
+            case RichElement::Type::TEXT:
+            {
+                RichElementText* elmtText = static_cast<RichElementText*>(element);
+                Label* label;
+                if (FileUtils::getInstance()->isFileExist(elmtText->_fontName))
                 {
-                    RichElementText* elmtText = static_cast<RichElementText*>(element);
-                    Label* label;
-                    if (FileUtils::getInstance()->isFileExist(elmtText->_fontName))
-                    {
-                        label = Label::createWithTTF(elmtText->_text, elmtText->_fontName, elmtText->_fontSize);
-                    }
-                    else
-                    {
-                        label = Label::createWithSystemFont(elmtText->_text, elmtText->_fontName, elmtText->_fontSize);
-                    }
-                    if (elmtText->_flags & RichElementText::ITALICS_FLAG)
-                        label->enableItalics();
-                    if (elmtText->_flags & RichElementText::BOLD_FLAG)
-                        label->enableBold();
-                    if (elmtText->_flags & RichElementText::UNDERLINE_FLAG)
-                        label->enableUnderline();
-                    if (elmtText->_flags & RichElementText::STRIKETHROUGH_FLAG)
-                        label->enableStrikethrough();
-                    if (elmtText->_flags & RichElementText::URL_FLAG)
-                        label->addComponent(UrlTouchListenerComponent::create(
-                            label, elmtText->_url, [this](std::string_view url) { openUrl(url); }));
-                    if (elmtText->_flags & RichElementText::OUTLINE_FLAG)
-                    {
-                        label->enableOutline(Color4B(elmtText->_outlineColor), elmtText->_outlineSize);
-                    }
-                    if (elmtText->_flags & RichElementText::SHADOW_FLAG)
-                    {
-                        label->enableShadow(Color4B(elmtText->_shadowColor), elmtText->_shadowOffset,
-                                            elmtText->_shadowBlurRadius);
-                    }
-                    if (elmtText->_flags & RichElementText::GLOW_FLAG)
-                    {
-                        label->enableGlow(Color4B(elmtText->_glowColor));
-                    }
-                    label->setTextColor(Color4B(elmtText->_color));
-
-                    label->setName(elmtText->_id);
-
-                    elementRenderer = label;
-                    break;
+                    label = Label::createWithTTF(elmtText->_text, elmtText->_fontName, elmtText->_fontSize);
                 }
-                case RichElement::Type::IMAGE:
+                else
                 {
-                    RichElementImage* elmtImage = static_cast<RichElementImage*>(element);
-                    if (elmtImage->_textureType == Widget::TextureResType::LOCAL)
-                        elementRenderer = Sprite::create(elmtImage->_filePath);
-                    else
-                        elementRenderer = Sprite::createWithSpriteFrameName(elmtImage->_filePath);
-
-                    if (elementRenderer && (elmtImage->_height != -1 || elmtImage->_width != -1))
-                    {
-                        auto currentSize = elementRenderer->getContentSize();
-                        if (elmtImage->_width != -1)
-                            elementRenderer->setScaleX((elmtImage->_width / currentSize.width) * elmtImage->_scaleX);
-                        else
-                            elementRenderer->setScaleX(elmtImage->_scaleX);
-
-                        if (elmtImage->_height != -1)
-                            elementRenderer->setScaleY((elmtImage->_height / currentSize.height) * elmtImage->_scaleY);
-                        else
-                            elementRenderer->setScaleY(elmtImage->_scaleY);
-
-                        elementRenderer->setContentSize(Vec2(currentSize.width * elementRenderer->getScaleX(),
-                                                             currentSize.height * elementRenderer->getScaleY()));
-                        elementRenderer->addComponent(
-                            UrlTouchListenerComponent::create(elementRenderer, elmtImage->_url,
-                                                      std::bind(&RichText::openUrl, this, std::placeholders::_1)));
-                        elementRenderer->setColor(element->_color);
-                        elementRenderer->setName(elmtImage->_id);
-                    }
-                    break;
+                    label = Label::createWithSystemFont(elmtText->_text, elmtText->_fontName, elmtText->_fontSize);
                 }
-                case RichElement::Type::CUSTOM:
+                if (elmtText->_flags & RichElementText::ITALICS_FLAG)
+                    label->enableItalics();
+                if (elmtText->_flags & RichElementText::BOLD_FLAG)
+                    label->enableBold();
+                if (elmtText->_flags & RichElementText::UNDERLINE_FLAG)
+                    label->enableUnderline();
+                if (elmtText->_flags & RichElementText::STRIKETHROUGH_FLAG)
+                    label->enableStrikethrough();
+                if (elmtText->_flags & RichElementText::URL_FLAG)
+                    label->addComponent(UrlTouchListenerComponent::create(
+                        label, elmtText->_url, [this](std::string_view url) { openUrl(url); }));
+                if (elmtText->_flags & RichElementText::OUTLINE_FLAG)
                 {
-                    RichElementCustomNode* elmtCustom = static_cast<RichElementCustomNode*>(element);
-                    elementRenderer                   = elmtCustom->_customNode;
-                    elementRenderer->setColor(element->_color);
-                    break;
+                    label->enableOutline(Color4B(elmtText->_outlineColor), elmtText->_outlineSize);
                 }
-                case RichElement::Type::NEWLINE:
+                if (elmtText->_flags & RichElementText::SHADOW_FLAG)
                 {
-                    auto* newLineMulti = static_cast<RichElementNewLine*>(element);
-
-                    addNewLine(newLineMulti->_quantity);
-                    break;
+                    label->enableShadow(Color4B(elmtText->_shadowColor), elmtText->_shadowOffset,
+                                        elmtText->_shadowBlurRadius);
                 }
-                default:
-                    break;
+                if (elmtText->_flags & RichElementText::GLOW_FLAG)
+                {
+                    label->enableGlow(Color4B(elmtText->_glowColor));
                 }
+                label->setTextColor(Color4B(elmtText->_color));
+
+                label->setName(elmtText->_id);
+
+                elementRenderer = label;
+                break;
+            }
+            case RichElement::Type::IMAGE:
+            {
+                RichElementImage* elmtImage = static_cast<RichElementImage*>(element);
+                if (elmtImage->_textureType == Widget::TextureResType::LOCAL)
+                    elementRenderer = Sprite::create(elmtImage->_filePath);
+                else
+                    elementRenderer = Sprite::createWithSpriteFrameName(elmtImage->_filePath);
 
-                if (elementRenderer)
+                if (elementRenderer && (elmtImage->_height != -1 || elmtImage->_width != -1))
                 {
-                    elementRenderer->setOpacity(element->_opacity);
-                    pushToContainer(elementRenderer);
+                    auto currentSize = elementRenderer->getContentSize();
+                    if (elmtImage->_width != -1)
+                        elementRenderer->setScaleX((elmtImage->_width / currentSize.width) * elmtImage->_scaleX);
+                    else
+                        elementRenderer->setScaleX(elmtImage->_scaleX);
+
+                    if (elmtImage->_height != -1)
+                        elementRenderer->setScaleY((elmtImage->_height / currentSize.height) * elmtImage->_scaleY);
+                    else
+                        elementRenderer->setScaleY(elmtImage->_scaleY);
+
+                    elementRenderer->setContentSize(Vec2(currentSize.width * elementRenderer->getScaleX(),
+                                                         currentSize.height * elementRenderer->getScaleY()));
+                    elementRenderer->addComponent(
+                        UrlTouchListenerComponent::create(elementRenderer, elmtImage->_url,
+                                                  std::bind(&RichText::openUrl, this, std::placeholders::_1)));
+                    elementRenderer->setColor(element->_color);
+                    elementRenderer->setName(elmtImage->_id);
                 }
+                break;
+            }
+            case RichElement::Type::CUSTOM:
+            {
+                RichElementCustomNode* elmtCustom = static_cast<RichElementCustomNode*>(element);
+                elementRenderer                   = elmtCustom->_customNode;
+                elementRenderer->setColor(element->_color);
+                break;
+            }
+            case RichElement::Type::NEWLINE:
+            {
+                auto* newLineMulti = static_cast<RichElementNewLine*>(element);
+
+                addNewLine(newLineMulti->_quantity);
+                break;
+            }
+            default:
+                break;
+            }
+
+            if (elementRenderer)
+            {
+                elementRenderer->setOpacity(element->_opacity);
+                pushToContainer(elementRenderer);
             }
         }
-        else
+    }
+    else
+    {
+        for (ssize_t i = first, size = _richElements.size(); i < size; ++i)
         {
-            addNewLine();
-            for (ssize_t i = 0, size = _richElements.size(); i < size; ++i)
+            RichElement* element = _richElements.at(i);
+            switch (element->_type)
             {
-                RichElement* element = _richElements.at(i);
-                switch (element->_type)
-                {
-                case RichElement::Type::TEXT:
-                {
-                    RichElementText* elmtText = static_cast<RichElementText*>(element);
-                    handleTextRenderer(elmtText->_text, elmtText->_fontName, elmtText->_fontSize, elmtText->_color,
-                                       elmtText->_opacity, elmtText->_flags, elmtText->_url, elmtText->_outlineColor,
-                                       elmtText->_outlineSize, elmtText->_shadowColor, elmtText->_shadowOffset,
-                                       elmtText->_shadowBlurRadius, elmtText->_glowColor, elmtText->_id);
-                    break;
-                }
-                case RichElement::Type::IMAGE:
-                {
-                    RichElementImage* elmtImage = static_cast<RichElementImage*>(element);
-                    handleImageRenderer(elmtImage->_filePath, elmtImage->_textureType, elmtImage->_color,
-                                        elmtImage->_opacity, elmtImage->_width, elmtImage->_height, elmtImage->_url,
-                                        elmtImage->_scaleX, elmtImage->_scaleY, elmtImage->_id);
-                    break;
-                }
-                case RichElement::Type::CUSTOM:
+            case RichElement::Type::TEXT:
+            {
+                RichElementText* elmtText = static_cast<RichElementText*>(element);
+                std::string_view text     = elmtText->_text;
+
+                // Join the text to the label ending the last row if they have the same style, so the spans of
+                // a style share labels
+                std::string joinedText;
+                if (_joinableLabel && isSameTextStyle(_joinableElement, elmtText))
                 {
-                    RichElementCustomNode* elmtCustom = static_cast<RichElementCustomNode*>(element);
-                    handleCustomRenderer(elmtCustom->_customNode, elmtCustom->_id);
-                    break;
+                    AXASSERT(_elementRenders.back().back() == _joinableLabel, "Invalid joinable label");
+                    joinedText = _joinableLabel->getString();
+                    joinedText.append(text);
+                    text = joinedText;
+                    _leftSpaceWidth += _joinableLabel->getContentSize().width;
+                    if (_joinableLabel->getParent())
+                    {
+                        removeProtectedChild(_joinableLabel);
+                    }
+                    _elementRenders.back().popBack();
                 }
-                case RichElement::Type::NEWLINE:
-                {
-                    auto* newLineMulti = static_cast<RichElementNewLine*>(element);
+                handleTextRenderer(text, elmtText->_fontName, elmtText->_fontSize, elmtText->_color,
+                                   elmtText->_opacity, elmtText->_flags, elmtText->_url, elmtText->_outlineColor,
+                                   elmtText->_outlineSize, elmtText->_shadowColor, elmtText->_shadowOffset,
+                                   elmtText->_shadowBlurRadius, elmtText->_glowColor, elmtText->_id);
+                _joinableElement = _joinableLabel ? elmtText : nullptr;
+                break;
+            }
+            case RichElement::Type::IMAGE:
+            {
+                RichElementImage* elmtImage = static_cast<RichElementImage*>(element);
+                handleImageRenderer(elmtImage->_filePath, elmtImage->_textureType, elmtImage->_color,
+                                    elmtImage->_opacity, elmtImage->_width, elmtImage->_height, elmtImage->_url,
+                                    elmtImage->_scaleX, elmtImage->_scaleY, elmtImage->_id);
+                break;
+            }
+            case RichElement::Type::CUSTOM:
+            {
+                RichElementCustomNode* elmtCustom = static_cast<RichElementCustomNode*>(element);
+                handleCustomRenderer(elmtCustom->_customNode, elmtCustom->_id);
+                break;
+            }
+            case RichElement::Type::NEWLINE:
+            {
+                auto* newLineMulti = static_cast<RichElementNewLine*>(element);
 
-                    addNewLine(newLineMulti->_quantity);
-                    break;
-                }
-                default:
-                    break;
-                }
+                addNewLine(newLineMulti->_quantity);
+                break;
+            }
+            default:
+                break;
             }
         }
-        formatRenderers();
-        _formatTextDirty = false;
     }
+    formatRenderers(firstRow);
+
+    auto time = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    _formatStats.lastFormatTime        = time;
+    _formatStats.lastFormattedElements = _richElements.size() - first;
+    _formatStats.lastFormattedRows     = _elementRenders.size() - firstRow;
+    _formatStats.formatCount++;
+    _formatStats.totalFormatTime += time;
+
+    _formattedElementCount = _richElements.size();
+    _formattedWidth        = _customSize.width;
+    _formatTextDirty       = false;
 }
 
 namespace
@@ -2096,6 +2183,7 @@ void RichText::handleTextRenderer(std::string_view text,
 {
     bool fileExist              = FileUtils::getInstance()->isFileExist(fontName);
     RichText::WrapMode wrapMode = static_cast<RichText::WrapMode>(_defaults.at(KEY_WRAP_MODE).asInt());
+    _joinableLabel              = nullptr;
 
     // split text by \n
     std::stringstream ss;
@@ -2162,6 +2250,7 @@ void RichText::handleTextRenderer(std::string_view text,
             {
                 _leftSpaceWidth -= textRendererWidth;
                 pushToContainer(textRenderer);
+                _joinableLabel = textRenderer;
                 break;
             }
 
@@ -2254,7 +2343,8 @@ void RichText::handleImageRenderer(std::string_view filePath,
 
 void RichText::handleCustomRenderer(ax::Node* renderer, std::string_view id)
 {
-    Vec2 imgSize = renderer->getContentSize();
+    Vec2 imgSize   = renderer->getContentSize();
+    _joinableLabel = nullptr;
 
     if (!id.empty())
     {
@@ -2276,6 +2366,7 @@ void RichText::handleCustomRenderer(ax::Node* renderer, std::string_view id)
 
 void RichText::addNewLine(int quantity)
 {
+    _joinableLabel = nullptr;
     do
     {
         _leftSpaceWidth = _customSize.width;
@@ -2285,7 +2376,7 @@ void RichText::addNewLine(int quantity)
     while (--quantity > 0);
 }
 
-void RichText::formatRenderers()
+void RichText::formatRenderers(size_t firstRow)
 {
     float verticalSpace = _defaults[KEY_VERTICAL_SPACE].asFloat();
     float fontSize      = _defaults[KEY_FONT_SIZE].asFloat();
@@ -2322,7 +2413,10 @@ void RichText::formatRenderers()
                     iter->setPosition(nextPosX, nextPosY);
                 }
 
-                this->addProtectedChild(iter, 1);
+                if (!iter->getParent())
+                {
+                    this->addProtectedChild(iter, 1);
+                }
                 newContentSizeWidth += iSize.width;
                 nextPosX += iSize.width;
                 maxY = std::max(maxY, iSize.height);
@@ -2336,11 +2430,15 @@ void RichText::formatRenderers()
     }
     else
     {
-        // calculate real height
-        float newContentSizeHeight = 0.0f;
-        std::vector<float> maxHeights(_elementRenders.size());
+        // calculate real height, the rows before firstRow are laid out already and keep their heights
+        const size_t rowCount = _elementRenders.size();
+        firstRow              = std::min(firstRow, std::min(_rowBottoms.size(), rowCount));
+        const float oldHeight = firstRow != 0 ? _rowBottoms.back() : 0.0f;
+        _rowBottoms.resize(rowCount);
+        std::vector<float> maxHeights(rowCount);
 
-        for (size_t i = 0, size = _elementRenders.size(); i < size; i++)
+        float newContentSizeHeight = firstRow != 0 ? _rowBottoms[firstRow - 1] : 0.0f;
+        for (size_t i = firstRow; i < rowCount; i++)
         {
             Vector<Node*>& row = _elementRenders[i];
             float maxHeight    = 0.0f;
@@ -2358,19 +2456,32 @@ void RichText::formatRenderers()
 
             // vertical space except for first line
             newContentSizeHeight += (i != 0 ? maxHeight + verticalSpace : maxHeight);
+            _rowBottoms[i] = newContentSizeHeight;
         }
         _customSize.height = newContentSizeHeight;
 
+        // the rows laid out before only move up by the height added below them
+        const float offsetY = newContentSizeHeight - oldHeight;
+        if (offsetY != 0.0f)
+        {
+            for (size_t i = 0; i < firstRow; i++)
+            {
+                for (auto&& iter : _elementRenders[i])
+                {
+                    iter->setPositionY(iter->getPositionY() + offsetY);
+                }
+            }
+        }
+
         const auto verticalAlignment = static_cast<VerticalAlignment>(_defaults.at(KEY_VERTICAL_ALIGNMENT).asInt());
 
         // align renders
-        float nextPosY = _customSize.height;
-        for (size_t i = 0, size = _elementRenders.size(); i < size; i++)
+        for (size_t i = firstRow; i < rowCount; i++)
         {
             Vector<Node*>& row    = _elementRenders[i];
             float nextPosX        = 0.0f;
             const auto lineHeight = maxHeights[i];
-            nextPosY -= (i != 0 ? lineHeight + verticalSpace : lineHeight);
+            const float nextPosY  = _customSize.height - _rowBottoms[i];
             for (auto&& iter : row)
             {
                 if (verticalAlignment == VerticalAlignment::CENTER)
@@ -2388,7 +2499,11 @@ void RichText::formatRenderers()
                     iter->setAnchorPoint(Vec2::ANCHOR_BOTTOM_LEFT);
                     iter->setPosition(nextPosX, nextPosY);
                 }
-                this->addProtectedChild(iter, 1);
+                // The renderers of the rows formatted before are only moved
+                if (!iter->getParent())
+                {
+                    this->addProtectedChild(iter, 1);
+                }
                 nextPosX += iter->getContentSize().width;
             }
 
@@ -2396,9 +2511,6 @@ void RichText::formatRenderers()
         }
     }
 
-    _elementRenders.clear();
-    _lineHeights.clear();
-
     if (_ignoreSize)
     {
         Vec2 s = getVirtualRendererSize();
@@ -2491,7 +2603,11 @@ void RichText::pushToContainer(ax::Node* renderer)
 
 void RichText::setVerticalSpace(float space)
 {
-    _defaults[KEY_VERTICAL_SPACE] = space;
+    if (_defaults.at(KEY_VERTICAL_SPACE).asFloat() != space)
+    {
+        _defaults[KEY_VERTICAL_SPACE] = space;
+        _formatTextDirty              = true;
+    }
 }
 
 void RichText::ignoreContentAdaptWithSize(bool ignore)
@@ -492,6 +492,8 @@ public:
 
     /**
      * @brief Add a RichElement at the end of RichText.
+     * Only the elements added are formatted next time when the text is fixed size and left aligned, the rows
+     * formatted before are kept.
      *
      * @param element A RichElement instance.
      */
@@ -614,6 +616,26 @@ public:
 
     bool setString(std::string_view text);
 
+    /**
+     * @brief Append an XML text, only the appended text is parsed and formatted, e.g. a new message of a chat window.
+     * The text should be well-formed by itself, it's parsed with the default font like the text of `setString`.
+     */
+    bool appendString(std::string_view text);
+
+    /**
+     * The cost of formatting the text.
+     */
+    struct FormatStats
+    {
+        float lastFormatTime;          /*!< milliseconds of the last formatting */
+        size_t lastFormattedElements;  /*!< elements formatted last time, only the appended ones if the rows are kept */
+        size_t lastFormattedRows;      /*!< rows laid out last time, the rows before them are only moved */
+        size_t formatCount;            /*!< count of formatting */
+        float totalFormatTime;         /*!< milliseconds of all formatting */
+    };
+
+    const FormatStats& getFormatStats() const { return _formatStats; }
+
 protected:
     void adaptRenderers() override;
 
@@ -644,17 +666,28 @@ protected:
                              float scaleY        = 1.f,
                              std::string_view id = ""sv);
     void handleCustomRenderer(Node* renderer, std::string_view id = ""sv);
-    void formatRenderers();
+    void formatRenderers(size_t firstRow = 0);
     void addNewLine(int quantity = 1);
     void doHorizontalAlignment(const Vector<Node*>& row, float rowWidth);
     float stripTrailingWhitespace(const Vector<Node*>& row);
+    bool canFormatAppendedElements() const;
+    static bool isSameTextStyle(const RichElementText* a, const RichElementText* b);
 
     bool _formatTextDirty;
+    size_t _formattedElementCount;  // the elements laid out in _elementRenders, the ones after them are appended
+    float _formattedWidth;
     Vector<RichElement*> _richElements;
     std::vector<Vector<Node*>> _elementRenders;
     std::vector<float> _lineHeights;
+    std::vector<float> _rowBottoms;  // the distance from the top to the bottom of each row laid out
     float _leftSpaceWidth;
 
+    // the label which ends the last row, text of the same style is joined to it
+    Label* _joinableLabel;
+    RichElementText* _joinableElement;
+
+    FormatStats _formatStats;
+
     ValueMap _defaults;            /*!< default values */
     OpenUrlHandler _handleOpenUrl; /*!< the callback for open URL */
 
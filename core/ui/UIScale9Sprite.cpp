@@ -324,7 +324,9 @@ void Scale9Sprite::setSpriteFrame(SpriteFrame* spriteFrame, const Rect& capInset
 
 void Scale9Sprite::setPreferredSize(const Vec2& preferredSize)
 {
-    setContentSize(preferredSize);
+    // The widgets set it whenever they adapt their renderers, don't regenerate the slices for the same size
+    if (!preferredSize.equals(_contentSize))
+        setContentSize(preferredSize);
 }
 
 void Scale9Sprite::setInsetLeft(float insetLeft)
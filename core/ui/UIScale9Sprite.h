@@ -416,7 +416,7 @@ public:
     Vec2 getOriginalSize() const;
 
     /**
-     * @brief Change the preferred size of Scale9Sprite.
+     * @brief Change the preferred size of Scale9Sprite, the slices are regenerated only if the size changed.
      *
      * @param size A delimitation zone.
      */
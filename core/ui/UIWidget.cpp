@@ -521,6 +521,12 @@ void Widget::onSizeChanged()
             }
         }
     }
+
+    // The siblings may be placed by the size of this widget
+    if (auto layout = dynamic_cast<Layout*>(_parent))
+    {
+        layout->onChildLayoutChanged();
+    }
 }
 
 Vec2 Widget::getVirtualRendererSize() const
@@ -1102,6 +1108,10 @@ void Widget::setLayoutParameter(LayoutParameter* parameter)
     }
     _layoutParameterDictionary.insert((int)parameter->getLayoutType(), parameter);
     _layoutParameterType = parameter->getLayoutType();
+    if (auto layout = dynamic_cast<Layout*>(_parent))
+    {
+        layout->onChildLayoutChanged();
+    }
 }
 
 LayoutParameter* Widget::getLayoutParameter() const
@@ -23,6 +23,7 @@
  THE SOFTWARE.
  ****************************************************************************/
 #include "AssetsManagerEx.h"
+#include "AssetsPatchStream.h"
 #include "EventListenerAssetsManagerEx.h"
 #include "base/UTF8.h"
 #include "base/Director.h"
@@ -174,6 +175,7 @@ AssetsManagerEx::AssetsManagerEx(std::string_view manifestUrl, std::string_view
     std::string pointer = fmt::format("{}", fmt::ptr(this));
     _eventName          = EventListenerAssetsManagerEx::LISTENER_ID + pointer;
     _fileUtils          = FileUtils::getInstance();
+    _streamingToken     = std::make_shared<int>(0);
 
     network::DownloaderHints hints = {static_cast<uint32_t>(_maxConcurrentTask), DEFAULT_CONNECTION_TIMEOUT, ".tmp"};
     _downloader                    = std::shared_ptr<network::Downloader>(new network::Downloader(hints));
@@ -186,6 +188,18 @@ AssetsManagerEx::AssetsManagerEx(std::string_view manifestUrl, std::string_view
     _downloader->onFileTaskSuccess = [this](const network::DownloadTask& task) {
         this->onSuccess(task.requestURL, task.storagePath, task.identifier);
     };
+    _downloader->onFileTaskData = [this](const network::DownloadTask& task, int64_t offset, const void* data,
+                                         size_t size) {
+        std::shared_ptr<AssetPatchStream> stream;
+        {
+            std::lock_guard<std::mutex> lock(_patchStreamsMutex);
+            auto it = _patchStreams.find(task.identifier);
+            if (it == _patchStreams.end())
+                return;
+            stream = it->second;
+        }
+        stream->feed(offset, data, size);
+    };
     setStoragePath(storagePath);
     _tempVersionPath   = _tempStoragePath + VERSION_FILENAME;
     _cacheManifestPath = _storagePath + MANIFEST_FILENAME;
@@ -196,9 +210,16 @@ AssetsManagerEx::AssetsManagerEx(std::string_view manifestUrl, std::string_view
 
 AssetsManagerEx::~AssetsManagerEx()
 {
-    _downloader->onTaskError       = (nullptr);
-    _downloader->onFileTaskSuccess = (nullptr);
-    _downloader->onTaskProgress    = (nullptr);
+    _streamingToken.reset();
+
+    // Cancels the tasks and joins the downloader thread, no callback is invoked after it
+    _downloader.reset();
+    {
+        std::lock_guard<std::mutex> lock(_patchStreamsMutex);
+        for (auto& item : _patchStreams)
+            item.second->cancel();
+        _patchStreams.clear();
+    }
     AX_SAFE_RELEASE(_localManifest);
     // _tempManifest could share a ptr with _remoteManifest or _localManifest
     if (_tempManifest != _localManifest && _tempManifest != _remoteManifest)
@@ -1108,6 +1129,15 @@ void AssetsManagerEx::onError(const network::DownloadTask& task,
     }
     else
     {
+        {
+            std::lock_guard<std::mutex> lock(_patchStreamsMutex);
+            auto it = _patchStreams.find(task.identifier);
+            if (it != _patchStreams.end())
+            {
+                it->second->cancel();
+                _patchStreams.erase(it);
+            }
+        }
         fileError(task.identifier, errorStr, errorCode, errorCodeInternal);
     }
 }
@@ -1183,35 +1213,142 @@ void AssetsManagerEx::onSuccess(std::string_view /*srcUrl*/, std::string_view st
     }
     else
     {
-        bool ok      = true;
-        auto& assets = _remoteManifest->getAssets();
-        auto assetIt = assets.find(customId);
-        if (assetIt != assets.end())
+        std::shared_ptr<AssetPatchStream> stream;
         {
-            Manifest::Asset asset = assetIt->second;
-            if (_verifyCallback != nullptr)
+            std::lock_guard<std::mutex> lock(_patchStreamsMutex);
+            auto it = _patchStreams.find(customId);
+            if (it != _patchStreams.end())
             {
-                ok = _verifyCallback(storagePath, asset);
+                stream = std::move(it->second);
+                _patchStreams.erase(it);
             }
         }
 
-        if (ok)
+        auto& assets = _remoteManifest->getAssets();
+        auto assetIt = assets.find(customId);
+        if (assetIt == assets.end())
         {
-            bool compressed = assetIt != assets.end() ? assetIt->second.compressed : false;
-            if (compressed)
-            {
-                decompressDownloadedZip(customId, storagePath);
-            }
-            else
+            if (stream)
+                stream->cancel();
+            completeDownloadedAsset(customId, storagePath, nullptr, nullptr);
+        }
+        else if (stream)
+        {
+            std::weak_ptr<int> token(_streamingToken);
+            stream->finish([this, token, stream, customId = std::string{customId},
+                            storagePath = std::string{storagePath},
+                            asset       = assetIt->second](const AssetPatchStream::Result& result) {
+                if (token.expired())
+                    return;
+                if (!result.streamed || !result.verified)
+                    stream->discard();
+
+                if (result.digest.empty())
+                    digestDownloadedAsset(customId, storagePath, asset);
+                else if (!result.verified)
+                    fileError(customId, "Asset file digest mismatch after downloaded");
+                else
+                    completeDownloadedAsset(customId, storagePath, &asset, result.streamed ? stream : nullptr);
+            });
+        }
+        else
+        {
+            digestDownloadedAsset(customId, storagePath, assetIt->second);
+        }
+    }
+}
+
+void AssetsManagerEx::digestDownloadedAsset(std::string_view customId,
+                                            std::string_view storagePath,
+                                            const Manifest::Asset& asset)
+{
+    if (asset.xxhash.empty())
+    {
+        completeDownloadedAsset(customId, storagePath, &asset, nullptr);
+        return;
+    }
+
+    struct AsyncData
+    {
+        std::string customId;
+        std::string storagePath;
+        Manifest::Asset asset;
+        std::string digest;
+    };
+    auto asyncData = std::make_shared<AsyncData>(AsyncData{std::string{customId}, std::string{storagePath}, asset});
+
+    std::weak_ptr<int> token(_streamingToken);
+    Director::getInstance()->getJobSystem()->enqueue(
+        [asyncData]() { asyncData->digest = AssetPatchStream::digestFile(asyncData->storagePath); },
+        [this, token, asyncData]() {
+        if (token.expired())
+            return;
+        if (asyncData->digest != asyncData->asset.xxhash)
+            fileError(asyncData->customId, "Asset file digest mismatch after downloaded");
+        else
+            completeDownloadedAsset(asyncData->customId, asyncData->storagePath, &asyncData->asset, nullptr);
+    });
+}
+
+void AssetsManagerEx::completeDownloadedAsset(std::string_view customId,
+                                              std::string_view storagePath,
+                                              const Manifest::Asset* asset,
+                                              std::shared_ptr<AssetPatchStream> stagedStream)
+{
+    bool ok = true;
+    if (asset && _verifyCallback != nullptr)
+    {
+        ok = _verifyCallback(storagePath, *asset);
+    }
+
+    if (ok)
+    {
+        bool compressed = asset ? asset->compressed : false;
+        if (compressed && stagedStream)
+        {
+            // Entries already extracted while downloading, move them into place now the archive passed the
+            // verification, same as decompressDownloadedZip the archive is removed
+            struct AsyncData
             {
-                fileSuccess(customId, storagePath);
-            }
+                std::string customId;
+                std::string zipFile;
+                bool succeed;
+            };
+            auto asyncData = std::make_shared<AsyncData>(AsyncData{std::string{customId}, std::string{storagePath}});
+            std::weak_ptr<int> token(_streamingToken);
+            Director::getInstance()->getJobSystem()->enqueue(
+                [asyncData, stagedStream]() {
+                asyncData->succeed = stagedStream->commit();
+                FileUtils::getInstance()->removeFile(asyncData->zipFile);
+            },
+                [this, token, asyncData]() {
+                if (token.expired())
+                    return;
+                if (asyncData->succeed)
+                    fileSuccess(asyncData->customId, asyncData->zipFile);
+                else
+                {
+                    std::string errorMsg = "Unable to decompress file " + asyncData->zipFile;
+                    dispatchUpdateEvent(EventAssetsManagerEx::EventCode::ERROR_DECOMPRESS, "", errorMsg);
+                    fileError(asyncData->customId, errorMsg);
+                }
+            });
+        }
+        else if (compressed)
+        {
+            decompressDownloadedZip(customId, storagePath);
         }
         else
         {
-            fileError(customId, "Asset file verification failed after downloaded");
+            fileSuccess(customId, storagePath);
         }
     }
+    else
+    {
+        if (stagedStream)
+            stagedStream->discard();
+        fileError(customId, "Asset file verification failed after downloaded");
+    }
 }
 
 void AssetsManagerEx::destroyDownloadedVersion()
@@ -1259,6 +1396,19 @@ void AssetsManagerEx::queueDowload()
         _currConcurrentTask++;
         DownloadUnit& unit = _downloadUnits[key];
         _fileUtils->createDirectory(basename(unit.storagePath));
+
+        if (_streamingEnabled)
+        {
+            auto& assets = _remoteManifest->getAssets();
+            auto assetIt = assets.find(key);
+            if (assetIt != assets.end() && (assetIt->second.compressed || !assetIt->second.xxhash.empty()))
+            {
+                auto stream = std::make_shared<AssetPatchStream>(unit.storagePath, assetIt->second.compressed,
+                                                                 assetIt->second.xxhash);
+                std::lock_guard<std::mutex> lock(_patchStreamsMutex);
+                _patchStreams[key] = std::move(stream);
+            }
+        }
         _downloader->createDownloadFileTask(unit.srcUrl, unit.storagePath, unit.customId);
 
         _tempManifest->setAssetDownloadState(key, Manifest::DownloadState::DOWNLOADING);
@@ -27,6 +27,7 @@
 #define __AssetsManagerEx__
 
 #include <string>
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 
@@ -45,6 +46,8 @@ struct zlib_filefunc_def_s;
 
 NS_AX_EXT_BEGIN
 
+class AssetPatchStream;
+
 /**
  * @brief   This class is used to auto update resources, such as pictures or scripts.
  */
@@ -134,6 +137,14 @@ public:
         _verifyCallback = callback;
     };
 
+    /** @brief Enable or disable streaming of the downloaded assets, enabled by default.
+     * When enabled, the assets are hashed and compressed assets are extracted while they are downloading,
+     * assets which can't be streamed (e.g. resumed from partial files) are processed after downloaded as before.
+     */
+    void setStreamingEnabled(bool enabled) { _streamingEnabled = enabled; }
+
+    bool isStreamingEnabled() const { return _streamingEnabled; }
+
     AssetsManagerEx(std::string_view manifestUrl, std::string_view storagePath);
 
     virtual ~AssetsManagerEx();
@@ -167,6 +178,11 @@ protected:
     void updateSucceed();
     bool decompress(std::string_view filename);
     void decompressDownloadedZip(std::string_view customId, std::string_view storagePath);
+    void digestDownloadedAsset(std::string_view customId, std::string_view storagePath, const Manifest::Asset& asset);
+    void completeDownloadedAsset(std::string_view customId,
+                                 std::string_view storagePath,
+                                 const Manifest::Asset* asset,
+                                 std::shared_ptr<AssetPatchStream> stagedStream);
 
     /** @brief Update a list of assets under the current AssetsManagerEx context
      */
@@ -334,6 +350,16 @@ private:
 
     //! Marker for whether the assets manager is inited
     bool _inited = false;
+
+    //! Whether the downloaded assets are hashed and extracted while downloading
+    bool _streamingEnabled = true;
+
+    //! The streams of the downloading assets, accessed by the downloader thread too
+    hlookup::string_map<std::shared_ptr<AssetPatchStream>> _patchStreams;
+    std::mutex _patchStreamsMutex;
+
+    //! Expires with the manager, the continuations of the streams and jobs hold a weak reference to it
+    std::shared_ptr<int> _streamingToken;
 };
 
 NS_AX_EXT_END
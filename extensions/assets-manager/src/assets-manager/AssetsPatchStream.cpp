@@ -0,0 +1,460 @@
+/****************************************************************************
+ Copyright (c) 2019-present Axmol Engine contributors (see AUTHORS.md).
+
+ https://axmol.dev/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#include "AssetsPatchStream.h"
+#include "base/Director.h"
+#include "base/Scheduler.h"
+#include "base/JobSystem.h"
+#include "xxhash.h"
+#include "fmt/format.h"
+
+NS_AX_EXT_BEGIN
+
+#define ZIP_LOCAL_HEADER_SIG     0x04034b50
+#define ZIP_CENTRAL_HEADER_SIG   0x02014b50
+#define ZIP_END_OF_CENTRAL_SIG   0x06054b50
+#define ZIP_DATA_DESCRIPTOR_SIG  0x08074b50
+#define ZIP_LOCAL_HEADER_SIZE    30
+
+#define ZIP_FLAG_ENCRYPTED       0x1
+#define ZIP_FLAG_DATA_DESCRIPTOR 0x8
+
+#define ZIP_METHOD_STORED        0
+#define ZIP_METHOD_DEFLATED      8
+
+#define STREAM_BUFFER_SIZE       (64 * 1024)
+
+static uint16_t readU16(const uint8_t* p)
+{
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+static uint32_t readU32(const uint8_t* p)
+{
+    return static_cast<uint32_t>(p[0] | (p[1] << 8) | (p[2] << 16)) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// ZipStreamInflater
+ZipStreamInflater::ZipStreamInflater(std::string_view rootPath, std::string_view stagingPath)
+    : _rootPath(rootPath), _stagingPath(stagingPath)
+{}
+
+ZipStreamInflater::~ZipStreamInflater()
+{
+    if (_zsInited)
+        inflateEnd(&_zs);
+    discard();
+}
+
+bool ZipStreamInflater::commit()
+{
+    auto fileUtils = FileUtils::getInstance();
+    bool ok        = true;
+    for (auto& name : _entries)
+    {
+        auto fullPath    = _rootPath + name;
+        bool isDirectory = fullPath.back() == '/';
+        auto dir         = isDirectory ? fullPath : FileUtils::getPathDirName(fullPath);
+        if (!fileUtils->isDirectoryExist(dir) && !fileUtils->createDirectory(dir))
+            ok = false;
+        else if (!isDirectory && !fileUtils->renameFile(_stagingPath + name, fullPath))
+            ok = false;
+    }
+    discard();
+    return ok;
+}
+
+void ZipStreamInflater::discard()
+{
+    _fs.reset();
+    _entries.clear();
+    auto fileUtils = FileUtils::getInstance();
+    if (fileUtils->isDirectoryExist(_stagingPath))
+        fileUtils->removeDirectory(_stagingPath);
+}
+
+bool ZipStreamInflater::write(const uint8_t* data, size_t size)
+{
+    while (size > 0 && _state != State::END && _state != State::FAILED)
+    {
+        size_t used = 0;
+        switch (_state)
+        {
+        case State::LOCAL_HEADER:
+            used = parseLocalHeader(data, size);
+            break;
+        case State::ENTRY_DATA:
+            used = parseEntryData(data, size);
+            break;
+        case State::DATA_DESCRIPTOR:
+            used = parseDataDescriptor(data, size);
+            break;
+        default:
+            break;
+        }
+        data += used;
+        size -= used;
+    }
+    return _state != State::FAILED;
+}
+
+size_t ZipStreamInflater::fill(size_t need, const uint8_t* data, size_t size)
+{
+    if (_buf.size() >= need)
+        return 0;
+    size_t n = std::min(need - _buf.size(), size);
+    _buf.insert(_buf.end(), data, data + n);
+    return n;
+}
+
+size_t ZipStreamInflater::parseLocalHeader(const uint8_t* data, size_t size)
+{
+    size_t used = fill(4, data, size);
+    if (_buf.size() < 4)
+        return used;
+
+    const auto sig = readU32(_buf.data());
+    if (sig == ZIP_CENTRAL_HEADER_SIG || sig == ZIP_END_OF_CENTRAL_SIG)
+    {
+        // all entries passed, the central directory isn't needed
+        _state = State::END;
+        return used;
+    }
+    if (sig != ZIP_LOCAL_HEADER_SIG)
+        return fail();
+
+    used += fill(ZIP_LOCAL_HEADER_SIZE, data + used, size - used);
+    if (_buf.size() < ZIP_LOCAL_HEADER_SIZE)
+        return used;
+
+    const size_t headerSize = ZIP_LOCAL_HEADER_SIZE + readU16(&_buf[26]) + readU16(&_buf[28]);
+    used += fill(headerSize, data + used, size - used);
+    if (_buf.size() < headerSize)
+        return used;
+
+    if (!beginEntry())
+        return fail();
+    return used;
+}
+
+bool ZipStreamInflater::beginEntry()
+{
+    const uint8_t* h = _buf.data();
+    _flags           = readU16(h + 6);
+    _method          = readU16(h + 8);
+    _crc             = readU32(h + 14);
+    _compressedSize  = readU32(h + 18);
+    _size            = readU32(h + 22);
+    const auto nameLength = readU16(h + 26);
+    std::string_view fileName{reinterpret_cast<const char*>(h + ZIP_LOCAL_HEADER_SIZE), nameLength};
+
+    if ((_flags & ZIP_FLAG_ENCRYPTED) || _compressedSize == 0xFFFFFFFF || _size == 0xFFFFFFFF)
+        return false;
+    if (_method != ZIP_METHOD_STORED && _method != ZIP_METHOD_DEFLATED)
+        return false;
+    if (_method == ZIP_METHOD_STORED && (_flags & ZIP_FLAG_DATA_DESCRIPTOR))
+        return false;
+    if (fileName.empty() || fileName.find("..") != std::string_view::npos)
+        return false;
+
+    auto fileUtils       = FileUtils::getInstance();
+    std::string fullPath = _stagingPath;
+    fullPath += fileName;
+    _entries.emplace_back(fileName);
+    _buf.clear();
+
+    if (fullPath.back() == '/')
+    {
+        _state = State::LOCAL_HEADER;
+        return fileUtils->createDirectory(fullPath);
+    }
+
+    auto dir = FileUtils::getPathDirName(fullPath);
+    if (!fileUtils->isDirectoryExist(dir) && !fileUtils->createDirectory(dir))
+        return false;
+
+    _fs = fileUtils->openFileStream(fullPath, IFileStream::Mode::WRITE);
+    if (!_fs)
+        return false;
+
+    _crcOut  = static_cast<uint32_t>(crc32(0L, Z_NULL, 0));
+    _sizeOut = 0;
+    _remain  = _compressedSize;
+
+    if (_method == ZIP_METHOD_DEFLATED)
+    {
+        if (!_zsInited)
+        {
+            if (inflateInit2(&_zs, -MAX_WBITS) != Z_OK)
+                return false;
+            _zsInited = true;
+            _outBuf.reset(new uint8_t[STREAM_BUFFER_SIZE]);
+        }
+        else
+            inflateReset(&_zs);
+    }
+
+    _state = State::ENTRY_DATA;
+    if (_method == ZIP_METHOD_STORED && _remain == 0)
+        return endEntry();
+    return true;
+}
+
+size_t ZipStreamInflater::parseEntryData(const uint8_t* data, size_t size)
+{
+    const bool hasDescriptor = _flags & ZIP_FLAG_DATA_DESCRIPTOR;
+    size_t avail             = hasDescriptor ? size : std::min<size_t>(size, _remain);
+
+    if (_method == ZIP_METHOD_STORED)
+    {
+        if (!output(data, avail))
+            return fail();
+        _remain -= static_cast<uint32_t>(avail);
+        if (_remain == 0 && !endEntry())
+            return fail();
+        return avail;
+    }
+
+    _zs.next_in  = const_cast<Bytef*>(data);
+    _zs.avail_in = static_cast<uInt>(avail);
+    int ret;
+    do
+    {
+        _zs.next_out  = _outBuf.get();
+        _zs.avail_out = STREAM_BUFFER_SIZE;
+        ret           = inflate(&_zs, Z_NO_FLUSH);
+        if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR)
+            return fail();
+        if (!output(_outBuf.get(), STREAM_BUFFER_SIZE - _zs.avail_out))
+            return fail();
+    } while (ret == Z_OK && _zs.avail_out == 0);
+
+    const size_t consumed = avail - _zs.avail_in;
+    if (!hasDescriptor)
+        _remain -= static_cast<uint32_t>(consumed);
+
+    if (ret == Z_STREAM_END)
+    {
+        if (!endEntry())
+            return fail();
+    }
+    else if (!hasDescriptor && _remain == 0)
+        return fail();  // deflate stream is truncated
+    return consumed;
+}
+
+size_t ZipStreamInflater::parseDataDescriptor(const uint8_t* data, size_t size)
+{
+    // the signature of data descriptor is optional
+    size_t used = fill(4, data, size);
+    if (_buf.size() < 4)
+        return used;
+
+    const size_t descriptorSize = readU32(_buf.data()) == ZIP_DATA_DESCRIPTOR_SIG ? 16 : 12;
+    used += fill(descriptorSize, data + used, size - used);
+    if (_buf.size() < descriptorSize)
+        return used;
+
+    const uint8_t* d = _buf.data() + (descriptorSize - 12);
+    if (readU32(d) != _crcOut || readU32(d + 8) != _sizeOut)
+        return fail();
+
+    _buf.clear();
+    _state = State::LOCAL_HEADER;
+    return used;
+}
+
+bool ZipStreamInflater::endEntry()
+{
+    _fs.reset();
+    if (_flags & ZIP_FLAG_DATA_DESCRIPTOR)
+    {
+        _state = State::DATA_DESCRIPTOR;
+        return true;
+    }
+
+    _state = State::LOCAL_HEADER;
+    return _crcOut == _crc && _sizeOut == _size;
+}
+
+bool ZipStreamInflater::output(const uint8_t* data, size_t size)
+{
+    if (size == 0)
+        return true;
+    _crcOut = static_cast<uint32_t>(crc32(_crcOut, data, static_cast<uInt>(size)));
+    _sizeOut += static_cast<uint32_t>(size);
+    return _fs->write(data, static_cast<unsigned int>(size)) == static_cast<int>(size);
+}
+
+size_t ZipStreamInflater::fail()
+{
+    _fs.reset();
+    _state = State::FAILED;
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// AssetPatchStream
+AssetPatchStream::AssetPatchStream(std::string_view storagePath, bool compressed, std::string_view requiredDigest)
+    : _requiredDigest(requiredDigest)
+{
+    _hashState = XXH64_createState();
+    XXH64_reset(_hashState, 0);
+
+    if (compressed)
+    {
+        // same as AssetsManagerEx::decompress, the entries are extracted beside the archive, staged in a
+        // directory of the stream until committed
+        auto pos = storagePath.find_last_of("/\\");
+        _inflater.reset(new ZipStreamInflater(pos != std::string_view::npos ? storagePath.substr(0, pos + 1) : "",
+                                              fmt::format("{}.{}.staging/", storagePath, fmt::ptr(this))));
+    }
+}
+
+AssetPatchStream::~AssetPatchStream()
+{
+    XXH64_freeState(_hashState);
+}
+
+void AssetPatchStream::feed(int64_t offset, const void* data, size_t size)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_broken)
+        return;
+
+    if (offset != _fed)
+    {
+        // the task resumed from a partial temp file, the bytes before offset never pass the pipeline
+        _broken = true;
+        _pending.clear();
+        return;
+    }
+
+    _fed += size;
+    auto bytes = static_cast<const uint8_t*>(data);
+    _pending.emplace_back(bytes, bytes + size);
+    scheduleLocked();
+}
+
+void AssetPatchStream::finish(std::function<void(const Result&)> callback)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _finishCallback = std::move(callback);
+    scheduleLocked();
+}
+
+void AssetPatchStream::cancel()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _broken = true;
+    _pending.clear();
+    _finishCallback = nullptr;
+}
+
+bool AssetPatchStream::commit()
+{
+    return !_inflater || _inflater->commit();
+}
+
+void AssetPatchStream::discard()
+{
+    if (_inflater)
+        _inflater->discard();
+}
+
+void AssetPatchStream::scheduleLocked()
+{
+    if (_draining)
+        return;
+    _draining = true;
+    Director::getInstance()->getJobSystem()->enqueue([self = shared_from_this()]() { self->drain(); });
+}
+
+void AssetPatchStream::drain()
+{
+    for (;;)
+    {
+        std::vector<uint8_t> chunk;
+        std::function<void(const Result&)> callback;
+        bool broken;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            broken = _broken;
+            if (_pending.empty())
+            {
+                _draining = false;
+                if (!_finishCallback)
+                    return;
+                callback = std::move(_finishCallback);
+                _finishCallback = nullptr;
+            }
+            else
+            {
+                chunk = std::move(_pending.front());
+                _pending.pop_front();
+            }
+        }
+
+        if (callback)
+        {
+            Result result;
+            result.streamed = !broken && (!_inflater || (!_failed && _inflater->finished()));
+            if (!broken)
+                result.digest = fmt::format("{:016x}", XXH64_digest(_hashState));
+            result.verified = _requiredDigest.empty() || _requiredDigest == result.digest;
+            Director::getInstance()->getScheduler()->runOnAxmolThread(
+                [callback = std::move(callback), result = std::move(result)]() { callback(result); });
+            return;
+        }
+
+        if (!broken)
+            process(chunk);
+    }
+}
+
+void AssetPatchStream::process(const std::vector<uint8_t>& chunk)
+{
+    XXH64_update(_hashState, chunk.data(), chunk.size());
+    if (_inflater && !_failed && !_inflater->write(chunk.data(), chunk.size()))
+        _failed = true;
+}
+
+std::string AssetPatchStream::digestFile(std::string_view path)
+{
+    auto fs = FileUtils::getInstance()->openFileStream(path, IFileStream::Mode::READ);
+    if (!fs)
+        return std::string{};
+
+    auto state = XXH64_createState();
+    XXH64_reset(state, 0);
+    std::unique_ptr<uint8_t[]> buf(new uint8_t[STREAM_BUFFER_SIZE]);
+    int n;
+    while ((n = fs->read(buf.get(), STREAM_BUFFER_SIZE)) > 0)
+        XXH64_update(state, buf.get(), n);
+    auto digest = fmt::format("{:016x}", XXH64_digest(state));
+    XXH64_freeState(state);
+    return digest;
+}
+
+NS_AX_EXT_END
@@ -0,0 +1,172 @@
+/****************************************************************************
+ Copyright (c) 2019-present Axmol Engine contributors (see AUTHORS.md).
+
+ https://axmol.dev/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "platform/FileUtils.h"
+#include "extensions/ExtensionMacros.h"
+#include "zlib.h"
+
+struct XXH64_state_s;
+
+NS_AX_EXT_BEGIN
+
+/**
+ * @brief Extracts a zip archive from a byte stream while it is still downloading.
+ *
+ * The entries are parsed from their local file headers and inflated into a staging directory, the central
+ * directory is ignored. They're moved into the directory of the archive by commit(), once the archive was
+ * verified, so a corrupt or tampered archive never overwrites the extracted assets. Encrypted, zip64 entries and stored entries with data descriptor can't be
+ * delimited without the central directory, the inflater fails on them and the caller should fall back
+ * to extract the archive file after it downloaded.
+ */
+class ZipStreamInflater
+{
+public:
+    ZipStreamInflater(std::string_view rootPath, std::string_view stagingPath);
+    ~ZipStreamInflater();
+
+    /** @brief Consume the next bytes of the archive.
+     * @return false if the archive is malformed or unsupported
+     */
+    bool write(const uint8_t* data, size_t size);
+
+    /** @brief Whether all entries extracted, the central directory reached */
+    bool finished() const { return _state == State::END; }
+
+    bool failed() const { return _state == State::FAILED; }
+
+    /** @brief Move the staged entries into the root directory, the staging directory is removed */
+    bool commit();
+
+    /** @brief Remove the staged entries */
+    void discard();
+
+private:
+    enum class State
+    {
+        LOCAL_HEADER,
+        ENTRY_DATA,
+        DATA_DESCRIPTOR,
+        END,
+        FAILED
+    };
+
+    size_t fill(size_t need, const uint8_t* data, size_t size);
+    size_t parseLocalHeader(const uint8_t* data, size_t size);
+    size_t parseEntryData(const uint8_t* data, size_t size);
+    size_t parseDataDescriptor(const uint8_t* data, size_t size);
+
+    bool beginEntry();
+    bool endEntry();
+    bool output(const uint8_t* data, size_t size);
+    size_t fail();
+
+    std::string _rootPath;
+    std::string _stagingPath;
+    std::vector<std::string> _entries;  // the names of the staged entries, directories end with '/'
+    State _state = State::LOCAL_HEADER;
+    std::vector<uint8_t> _buf;
+
+    // current entry
+    uint16_t _flags          = 0;
+    uint16_t _method         = 0;
+    uint32_t _crc            = 0;
+    uint32_t _compressedSize = 0;
+    uint32_t _size           = 0;
+    uint32_t _remain         = 0;  // compressed bytes remain, when no data descriptor
+    uint32_t _crcOut         = 0;
+    uint32_t _sizeOut        = 0;
+    std::unique_ptr<IFileStream> _fs;
+
+    z_stream _zs{};
+    bool _zsInited = false;
+    std::unique_ptr<uint8_t[]> _outBuf;
+};
+
+/**
+ * @brief The patch pipeline of one asset.
+ *
+ * The downloader thread feeds the received bytes, they are hashed and optionally inflated on the JobSystem
+ * in stream order, so download, verification and extraction of the assets overlap. The entries are extracted into
+ * a staging directory until the caller verified the asset and commits them, the ones neither committed nor
+ * discarded are removed with the stream.
+ */
+class AssetPatchStream : public std::enable_shared_from_this<AssetPatchStream>
+{
+public:
+    struct Result
+    {
+        bool streamed;       // all bytes went through the pipeline, and the asset is staged if compressed
+        bool verified;       // no required digest or the digest matched
+        std::string digest;  // empty if some bytes were skipped, e.g. the download resumed from a partial file
+    };
+
+    AssetPatchStream(std::string_view storagePath, bool compressed, std::string_view requiredDigest);
+    ~AssetPatchStream();
+
+    /** @brief Feed the bytes downloaded, called on the downloader thread */
+    void feed(int64_t offset, const void* data, size_t size);
+
+    /** @brief Wait all fed bytes processed, then invoke the callback on axmol thread */
+    void finish(std::function<void(const Result&)> callback);
+
+    /** @brief Stop processing, the finish callback won't be invoked */
+    void cancel();
+
+    /** @brief Move the staged entries of a streamed archive into place, blocking, call it on the JobSystem */
+    bool commit();
+
+    /** @brief Remove the staged entries, e.g. the asset failed the verification */
+    void discard();
+
+    /** @brief Digest a file with the hash algorithm used by the pipeline, in lowercase hex */
+    static std::string digestFile(std::string_view path);
+
+private:
+    void scheduleLocked();
+    void drain();
+    void process(const std::vector<uint8_t>& chunk);
+
+    std::mutex _mutex;
+    std::deque<std::vector<uint8_t>> _pending;
+    int64_t _fed   = 0;
+    bool _draining = false;
+    bool _broken   = false;  // bytes skipped or cancelled, the pipeline can't produce the result
+    std::function<void(const Result&)> _finishCallback;
+
+    // accessed by the drain job only
+    bool _failed = false;
+    XXH64_state_s* _hashState;
+    std::string _requiredDigest;
+    std::unique_ptr<ZipStreamInflater> _inflater;
+};
+
+NS_AX_EXT_END
@@ -28,6 +28,7 @@
 #include "rapidjson/stringbuffer.h"
 
 #include <fstream>
+#include <algorithm>
 #include <stdio.h>
 
 #define KEY_VERSION "version"
@@ -42,6 +43,7 @@
 
 #define KEY_PATH "path"
 #define KEY_MD5 "md5"
+#define KEY_XXHASH "xxhash"
 #define KEY_GROUP "group"
 #define KEY_COMPRESSED "compressed"
 #define KEY_SIZE "size"
@@ -425,6 +427,12 @@ Manifest::Asset Manifest::parseAsset(std::string_view path, const rapidjson::Val
     else
         asset.md5 = "";
 
+    if (json.HasMember(KEY_XXHASH) && json[KEY_XXHASH].IsString())
+    {
+        asset.xxhash = json[KEY_XXHASH].GetString();
+        std::transform(asset.xxhash.begin(), asset.xxhash.end(), asset.xxhash.begin(), ::tolower);
+    }
+
     if (json.HasMember(KEY_PATH) && json[KEY_PATH].IsString())
     {
         asset.path = json[KEY_PATH].GetString();
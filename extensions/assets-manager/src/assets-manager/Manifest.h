@@ -50,6 +50,7 @@ struct DownloadUnit
 struct ManifestAsset
 {
     std::string md5;
+    std::string xxhash;  // optional XXH64 of the downloaded file in hex, verified while the file is downloading
     std::string path;
     bool compressed;
     float size;
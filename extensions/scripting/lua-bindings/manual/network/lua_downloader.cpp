@@ -126,6 +126,8 @@ static int lua_downloader_new(lua_State* L)
         hints.countOfMaxProcessingTasks = get_field_int(L, "countOfMaxProcessingTasks", 6);
         hints.timeoutInSeconds          = get_field_int(L, "timeoutInSeconds", 45);
         hints.tempFileNameSuffix        = get_field_string(L, "tempFileNameSuffix", ".tmp");
+        hints.countOfSegmentsPerTask    = get_field_int(L, "countOfSegmentsPerTask", 1);
+        hints.minSizeOfSegment          = get_field_int(L, "minSizeOfSegment", 1024 * 1024);
 
         auto ptr   = lua_newuserdata(L, sizeof(Downloader));
         downloader = new (ptr) Downloader(hints);
@@ -25,6 +25,7 @@
 #include "DrawPrimitivesTest.h"
 #include "renderer/Renderer.h"
 #include "renderer/CustomCommand.h"
+#include <chrono>
 
 USING_NS_AX;
 
@@ -38,6 +39,7 @@ DrawPrimitivesTests::DrawPrimitivesTests()
     ADD_TEST_CASE(DrawNodeTestNewFeature1);
     ADD_TEST_CASE(Issue829Test);
     ADD_TEST_CASE(Issue1319Test);
+    ADD_TEST_CASE(DrawNodeRetainedBenchmark);
 }
 
 string DrawPrimitivesBaseTest::title() const
@@ -652,3 +654,158 @@ string Issue1319Test::subtitle() const
 {
     return "Draw complex FILLED polygons";
 }
+
+//
+// DrawNodeRetainedBenchmark
+//
+static constexpr int kBenchmarkShapes  = 100000;
+static constexpr int kBenchmarkUpdates = 100;
+
+DrawNodeRetainedBenchmark::DrawNodeRetainedBenchmark()
+{
+    auto s = Director::getInstance()->getWinSize();
+
+    _shapes.resize(kBenchmarkShapes);
+    for (auto& shape : _shapes)
+    {
+        shape.kind  = RandomHelper::random_int(0, 2);
+        shape.pos   = Vec2(AXRANDOM_0_1() * s.width, AXRANDOM_0_1() * s.height);
+        shape.size  = 2.0f + AXRANDOM_0_1() * 4.0f;
+        shape.color = Color4B(RandomHelper::random_int(64, 255), RandomHelper::random_int(64, 255),
+                              RandomHelper::random_int(64, 255), 255);
+    }
+
+    _drawNode = DrawNode::create();
+    addChild(_drawNode);
+
+    _ids.assign(kBenchmarkShapes, -1);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kBenchmarkShapes; ++i)
+        retainShape(i);
+    auto addTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    AXLOGD("DrawNodeRetainedBenchmark: added {} primitives in {:.1f} ms", kBenchmarkShapes, addTime);
+
+    _label = Label::createWithTTF("", "fonts/arial.ttf", 16);
+    _label->setPosition(s.width / 2, s.height * 0.2f);
+    addChild(_label, 1);
+
+    MenuItemFont::setFontSize(18);
+    auto toggle = MenuItemFont::create("Toggle retained / immediate",
+                                       AX_CALLBACK_1(DrawNodeRetainedBenchmark::toggleMode, this));
+    auto menu   = Menu::create(toggle, nullptr);
+    menu->setPosition(s.width / 2, s.height * 0.3f);
+    addChild(menu, 1);
+
+    scheduleUpdate();
+}
+
+void DrawNodeRetainedBenchmark::drawShape(const Shape& shape)
+{
+    switch (shape.kind)
+    {
+    case 0:
+        _drawNode->drawSolidCircle(shape.pos, shape.size, 0.0f, 8, shape.color);
+        break;
+    case 1:
+        _drawNode->drawSegment(shape.pos, shape.pos + Vec2(shape.size * 3, shape.size), 1.0f, shape.color);
+        break;
+    default:
+    {
+        Vec2 quad[] = {shape.pos, shape.pos + Vec2(shape.size, 0), shape.pos + Vec2(shape.size, shape.size),
+                       shape.pos + Vec2(0, shape.size)};
+        _drawNode->drawPolygon(quad, 4, shape.color, 0.0f, Color4B());
+        break;
+    }
+    }
+}
+
+void DrawNodeRetainedBenchmark::retainShape(int index)
+{
+    auto& shape = _shapes[index];
+    bool added  = _ids[index] < 0;
+    Vec2 to     = shape.pos + Vec2(shape.size * 3, shape.size);
+    switch (shape.kind)
+    {
+    case 0:
+        if (added)
+            _ids[index] = _drawNode->addSolidCircle(shape.pos, shape.size, 8, shape.color);
+        else
+            _drawNode->updateSolidCircle(_ids[index], shape.pos, shape.size, 8, shape.color);
+        break;
+    case 1:
+        if (added)
+            _ids[index] = _drawNode->addSegment(shape.pos, to, 1.0f, shape.color);
+        else
+            _drawNode->updateSegment(_ids[index], shape.pos, to, 1.0f, shape.color);
+        break;
+    default:
+    {
+        Vec2 quad[] = {shape.pos, shape.pos + Vec2(shape.size, 0), shape.pos + Vec2(shape.size, shape.size),
+                       shape.pos + Vec2(0, shape.size)};
+        if (added)
+            _ids[index] = _drawNode->addPolygon(quad, 4, shape.color);
+        else
+            _drawNode->updatePolygon(_ids[index], quad, 4, shape.color);
+        break;
+    }
+    }
+}
+
+void DrawNodeRetainedBenchmark::toggleMode(ax::Object* sender)
+{
+    _retained = !_retained;
+    _drawNode->clear();
+    _drawNode->removeAllPrimitives();
+    if (_retained)
+    {
+        std::fill(_ids.begin(), _ids.end(), -1);
+        for (int i = 0; i < kBenchmarkShapes; ++i)
+            retainShape(i);
+    }
+    _frames     = 0;
+    _elapsed    = 0;
+    _updateTime = 0;
+}
+
+void DrawNodeRetainedBenchmark::update(float dt)
+{
+    // move a few shapes per frame, like a debug overlay
+    auto s     = Director::getInstance()->getWinSize();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kBenchmarkUpdates; ++i)
+    {
+        int index          = RandomHelper::random_int(0, kBenchmarkShapes - 1);
+        _shapes[index].pos = Vec2(AXRANDOM_0_1() * s.width, AXRANDOM_0_1() * s.height);
+        if (_retained)
+            retainShape(index);
+    }
+    if (!_retained)
+    {
+        _drawNode->clear();
+        for (auto& shape : _shapes)
+            drawShape(shape);
+    }
+    _updateTime += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    ++_frames;
+    _elapsed += dt;
+    if (_elapsed >= 1.0f)
+    {
+        _label->setString(fmt::format("{}: {} of {} shapes moved per frame\nupdate: {:.2f} ms, frame: {:.2f} ms",
+                                      _retained ? "retained" : "immediate", kBenchmarkUpdates, kBenchmarkShapes,
+                                      _updateTime / _frames, _elapsed * 1000 / _frames));
+        _frames     = 0;
+        _elapsed    = 0;
+        _updateTime = 0;
+    }
+}
+
+string DrawNodeRetainedBenchmark::title() const
+{
+    return "DrawNode retained primitives";
+}
+
+string DrawNodeRetainedBenchmark::subtitle() const
+{
+    return "100k circles, segments and quads, 100 moved per frame";
+}
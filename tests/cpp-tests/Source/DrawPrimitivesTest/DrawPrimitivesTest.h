@@ -105,6 +105,40 @@ public:
     virtual std::string subtitle() const override;
 };
 
+class DrawNodeRetainedBenchmark : public DrawPrimitivesBaseTest
+{
+public:
+    CREATE_FUNC(DrawNodeRetainedBenchmark);
+
+    DrawNodeRetainedBenchmark();
+
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    void update(float dt) override;
+
+private:
+    struct Shape
+    {
+        int kind;
+        ax::Vec2 pos;
+        float size;
+        ax::Color4B color;
+    };
+
+    void drawShape(const Shape& shape);
+    void retainShape(int index);
+    void toggleMode(ax::Object* sender);
+
+    std::vector<Shape> _shapes;
+    std::vector<int> _ids;
+    ax::DrawNode* _drawNode = nullptr;
+    ax::Label* _label       = nullptr;
+    bool _retained          = true;
+    int _frames             = 0;
+    float _elapsed          = 0;
+    float _updateTime       = 0;
+};
+
 class DrawNodeTestNewFeature1 : public DrawPrimitivesBaseTest
 {
 public:
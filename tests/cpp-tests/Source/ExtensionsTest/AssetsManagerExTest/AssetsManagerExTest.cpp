@@ -26,6 +26,11 @@
 #include "../../testResource.h"
 #include "axmol.h"
 
+#include <thread>
+#include "yasio/xxsocket.hpp"
+#include "xxhash.h"
+#include "zlib.h"
+
 USING_NS_AX;
 USING_NS_AX_EXT;
 
@@ -41,6 +46,7 @@ AssetsManagerExTests::AssetsManagerExTests()
     addTestCase("AssetsManager Test1", []() { return AssetsManagerExLoaderScene::create(0); });
     addTestCase("AssetsManager Test2", []() { return AssetsManagerExLoaderScene::create(1); });
     addTestCase("AssetsManager Test3", []() { return AssetsManagerExLoaderScene::create(2); });
+    ADD_TEST_CASE(AssetsManagerExStreamingBenchmark);
 }
 
 AssetsManagerExLoaderScene* AssetsManagerExLoaderScene::create(int testIndex)
@@ -221,3 +227,311 @@ std::string AssetsManagerExLoaderScene::title() const
 {
     return "AssetsManagerExTest";
 }
+
+//------------------------------------------------------------------
+//
+// AssetsManagerExStreamingBenchmark
+//
+//------------------------------------------------------------------
+#define BENCHMARK_PLAIN_ASSETS   1900
+#define BENCHMARK_ZIP_ASSETS     100
+#define BENCHMARK_ZIP_ENTRIES    10
+#define BENCHMARK_PLAIN_SIZE     (4 * 1024)
+#define BENCHMARK_ZIP_ENTRY_SIZE (16 * 1024)
+
+// A minimal loopback HTTP/1.1 server which serves the generated package from memory
+class AssetsPatchServer
+{
+public:
+    AssetsPatchServer()
+    {
+        _listener.pserve("127.0.0.1", 0);
+        _port   = _listener.local_endpoint().port();
+        _thread = std::thread([this] { acceptLoop(); });
+    }
+
+    ~AssetsPatchServer()
+    {
+        _stopped = true;
+        _listener.close();
+        if (_thread.joinable())
+            _thread.join();
+    }
+
+    std::string url() const { return fmt::format("http://127.0.0.1:{}/", _port); }
+
+    // Must be called before any request
+    void addFile(std::string_view path, std::string data) { _files.emplace(path, std::move(data)); }
+
+private:
+    void acceptLoop()
+    {
+        while (!_stopped)
+        {
+            yasio::xxsocket client = _listener.accept();
+            if (client.is_open())
+                serve(client);
+        }
+    }
+
+    void serve(yasio::xxsocket& client)
+    {
+        std::string request;
+        char buf[1024];
+        while (request.find("\r\n\r\n") == std::string::npos)
+        {
+            int n = client.recv(buf, sizeof(buf));
+            if (n <= 0)
+                return;
+            request.append(buf, n);
+        }
+
+        // GET /path HTTP/1.1
+        auto first = request.find('/');
+        auto last  = request.find(' ', first);
+        auto it    = _files.find(request.substr(first + 1, last - first - 1));
+        std::string_view body = it != _files.end() ? std::string_view{it->second} : std::string_view{};
+
+        std::string header = it != _files.end() ? "HTTP/1.1 200 OK\r\n" : "HTTP/1.1 404 Not Found\r\n";
+        header += fmt::format("Content-Length: {}\r\nConnection: close\r\n\r\n", body.size());
+        sendAll(client, header);
+        sendAll(client, body);
+        client.close();
+    }
+
+    static void sendAll(yasio::xxsocket& client, std::string_view data)
+    {
+        while (!data.empty())
+        {
+            int n = client.send(data.data(), static_cast<int>(std::min<size_t>(data.size(), 64 * 1024)));
+            if (n <= 0)
+                return;
+            data.remove_prefix(n);
+        }
+    }
+
+    hlookup::string_map<std::string> _files;
+    yasio::xxsocket _listener;
+    u_short _port = 0;
+    std::atomic_bool _stopped{false};
+    std::thread _thread;
+};
+
+static std::string makeBenchmarkData(size_t size, uint32_t seed, bool compressible)
+{
+    std::string data(size, '\0');
+    for (size_t i = 0; i < size; ++i)
+    {
+        seed    = seed * 1664525u + 1013904223u;
+        data[i] = compressible ? static_cast<char>('a' + (seed >> 24) % 8) : static_cast<char>(seed >> 24);
+    }
+    return data;
+}
+
+static void appendU16(std::string& out, uint32_t v)
+{
+    out.push_back(static_cast<char>(v & 0xff));
+    out.push_back(static_cast<char>((v >> 8) & 0xff));
+}
+
+static void appendU32(std::string& out, uint32_t v)
+{
+    appendU16(out, v & 0xffff);
+    appendU16(out, v >> 16);
+}
+
+// Build a zip archive with deflated entries
+static std::string makeBenchmarkZip(const std::vector<std::pair<std::string, std::string>>& entries)
+{
+    std::string zip, central;
+    for (auto& [name, data] : entries)
+    {
+        std::string deflated(deflateBound(nullptr, static_cast<uLong>(data.size())) + 64, '\0');
+        z_stream zs{};
+        deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+        zs.next_in   = (Bytef*)data.data();
+        zs.avail_in  = static_cast<uInt>(data.size());
+        zs.next_out  = (Bytef*)deflated.data();
+        zs.avail_out = static_cast<uInt>(deflated.size());
+        deflate(&zs, Z_FINISH);
+        deflated.resize(zs.total_out);
+        deflateEnd(&zs);
+
+        const auto crc    = static_cast<uint32_t>(crc32(0L, (const Bytef*)data.data(), static_cast<uInt>(data.size())));
+        const auto offset = static_cast<uint32_t>(zip.size());
+
+        appendU32(zip, 0x04034b50);
+        appendU16(zip, 20);  // version needed
+        appendU16(zip, 0);   // flags
+        appendU16(zip, Z_DEFLATED);
+        appendU32(zip, 0);  // time & date
+        appendU32(zip, crc);
+        appendU32(zip, static_cast<uint32_t>(deflated.size()));
+        appendU32(zip, static_cast<uint32_t>(data.size()));
+        appendU16(zip, static_cast<uint32_t>(name.size()));
+        appendU16(zip, 0);  // extra
+        zip += name;
+        zip += deflated;
+
+        appendU32(central, 0x02014b50);
+        appendU16(central, 20);  // version made by
+        appendU16(central, 20);  // version needed
+        appendU16(central, 0);   // flags
+        appendU16(central, Z_DEFLATED);
+        appendU32(central, 0);  // time & date
+        appendU32(central, crc);
+        appendU32(central, static_cast<uint32_t>(deflated.size()));
+        appendU32(central, static_cast<uint32_t>(data.size()));
+        appendU16(central, static_cast<uint32_t>(name.size()));
+        appendU32(central, 0);  // extra & comment
+        appendU32(central, 0);  // disk & internal attributes
+        appendU32(central, 0);  // external attributes
+        appendU32(central, offset);
+        central += name;
+    }
+
+    const auto centralOffset = static_cast<uint32_t>(zip.size());
+    zip += central;
+    appendU32(zip, 0x06054b50);
+    appendU32(zip, 0);  // disks
+    appendU16(zip, static_cast<uint32_t>(entries.size()));
+    appendU16(zip, static_cast<uint32_t>(entries.size()));
+    appendU32(zip, static_cast<uint32_t>(central.size()));
+    appendU32(zip, centralOffset);
+    appendU16(zip, 0);  // comment
+    return zip;
+}
+
+AssetsManagerExStreamingBenchmark::AssetsManagerExStreamingBenchmark() {}
+
+AssetsManagerExStreamingBenchmark::~AssetsManagerExStreamingBenchmark() {}
+
+bool AssetsManagerExStreamingBenchmark::init()
+{
+    if (!TestCase::init())
+        return false;
+
+    auto fileUtils = FileUtils::getInstance();
+    _server.reset(new AssetsPatchServer());
+    _storagePath  = fileUtils->getWritablePath() + "CppTests/AssetsManagerExTest/benchmark/";
+    _manifestPath = fileUtils->getWritablePath() + "CppTests/AssetsManagerExTest/benchmark.manifest";
+
+    auto addAsset = [this](std::string& assets, std::string_view key, std::string data, bool compressed) {
+        auto digest = fmt::format("{:016x}", XXH64(data.data(), data.size(), 0));
+        if (!assets.empty())
+            assets += ',';
+        assets += fmt::format(R"("{}":{{"md5":"{}","xxhash":"{}","compressed":{},"size":{}}})", key, digest, digest,
+                              compressed, data.size());
+        _server->addFile(key, std::move(data));
+    };
+
+    std::string assets;
+    for (int i = 0; i < BENCHMARK_PLAIN_ASSETS; ++i)
+        addAsset(assets, fmt::format("plain/{}.bin", i), makeBenchmarkData(BENCHMARK_PLAIN_SIZE, i, false), false);
+    for (int i = 0; i < BENCHMARK_ZIP_ASSETS; ++i)
+    {
+        std::vector<std::pair<std::string, std::string>> entries;
+        for (int k = 0; k < BENCHMARK_ZIP_ENTRIES; ++k)
+            entries.emplace_back(fmt::format("pack{}/{}.txt", i, k),
+                                 makeBenchmarkData(BENCHMARK_ZIP_ENTRY_SIZE, i * BENCHMARK_ZIP_ENTRIES + k, true));
+        addAsset(assets, fmt::format("zip/pack{}.zip", i), makeBenchmarkZip(entries), true);
+    }
+
+    constexpr std::string_view manifestFormat =
+        R"({{"packageUrl":"{0}","remoteManifestUrl":"{0}project.manifest","version":"{1}","assets":{{{2}}}}})";
+    _server->addFile("project.manifest", fmt::format(manifestFormat, _server->url(), "2.0.0", assets));
+    fileUtils->createDirectory(_storagePath);
+    fileUtils->writeStringToFile(fmt::format(manifestFormat, _server->url(), "1.0.0", ""), _manifestPath);
+
+    auto streamingItem = MenuItemFont::create("Update with streaming", [this](Object*) { runUpdate(true); });
+    auto batchItem     = MenuItemFont::create("Update after downloaded", [this](Object*) { runUpdate(false); });
+    auto menu          = Menu::create(streamingItem, batchItem, nullptr);
+    menu->alignItemsVerticallyWithPadding(10);
+    menu->setPosition(Vec2(VisibleRect::center().x, VisibleRect::center().y + 40));
+    addChild(menu);
+
+    _result = Label::createWithTTF("", "fonts/arial.ttf", 16);
+    _result->setPosition(Vec2(VisibleRect::center().x, VisibleRect::center().y - 60));
+    addChild(_result);
+
+    return true;
+}
+
+void AssetsManagerExStreamingBenchmark::runUpdate(bool streaming)
+{
+    if (_am)
+        return;
+
+    // Start from the local manifest each time
+    auto fileUtils = FileUtils::getInstance();
+    fileUtils->removeDirectory(_storagePath);
+    fileUtils->removeDirectory(_storagePath.substr(0, _storagePath.size() - 1) + "_temp/");
+
+    _streaming = streaming;
+    _am        = AssetsManagerEx::create(_manifestPath, _storagePath);
+    _am->retain();
+    _am->setStreamingEnabled(streaming);
+
+    _amListener = EventListenerAssetsManagerEx::create(_am, [this](EventAssetsManagerEx* event) {
+        switch (event->getEventCode())
+        {
+        case EventAssetsManagerEx::EventCode::UPDATE_FINISHED:
+            onUpdateEnd(true);
+            break;
+        case EventAssetsManagerEx::EventCode::UPDATE_FAILED:
+        case EventAssetsManagerEx::EventCode::ERROR_DOWNLOAD_MANIFEST:
+        case EventAssetsManagerEx::EventCode::ERROR_PARSE_MANIFEST:
+        case EventAssetsManagerEx::EventCode::ERROR_NO_LOCAL_MANIFEST:
+            onUpdateEnd(false);
+            break;
+        default:
+            break;
+        }
+    });
+    _eventDispatcher->addEventListenerWithFixedPriority(_amListener, 1);
+
+    _result->setString("Updating...");
+    _startTime = std::chrono::steady_clock::now();
+    _am->update();
+}
+
+void AssetsManagerExStreamingBenchmark::onUpdateEnd(bool succeed)
+{
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - _startTime).count();
+    auto result  = fmt::format("{}: {} in {:.3f}s", _streaming ? "Streaming" : "After downloaded",
+                               succeed ? "updated" : "failed", elapsed);
+    AXLOGD("AssetsManagerExStreamingBenchmark {}", result);
+    _result->setString(result);
+
+    // The listener can't be released while dispatching
+    auto am       = _am;
+    auto listener = _amListener;
+    _am           = nullptr;
+    _amListener   = nullptr;
+    Director::getInstance()->getScheduler()->runOnAxmolThread([dispatcher = _eventDispatcher, am, listener]() {
+        dispatcher->removeEventListener(listener);
+        am->release();
+    });
+}
+
+void AssetsManagerExStreamingBenchmark::onExit()
+{
+    if (_am)
+    {
+        _eventDispatcher->removeEventListener(_amListener);
+        AX_SAFE_RELEASE_NULL(_am);
+        _amListener = nullptr;
+    }
+    TestCase::onExit();
+}
+
+std::string AssetsManagerExStreamingBenchmark::title() const
+{
+    return "AssetsManagerEx Streaming Benchmark";
+}
+
+std::string AssetsManagerExStreamingBenchmark::subtitle() const
+{
+    return fmt::format("{} plain assets and {} zip assets from loopback server", BENCHMARK_PLAIN_ASSETS,
+                       BENCHMARK_ZIP_ASSETS);
+}
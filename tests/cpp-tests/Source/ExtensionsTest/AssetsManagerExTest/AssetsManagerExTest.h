@@ -56,4 +56,36 @@ private:
     void onLoadEnd();
 };
 
+class AssetsPatchServer;
+
+// Updates a generated package of 2000 assets from a loopback server, with streaming enabled and disabled
+class AssetsManagerExStreamingBenchmark : public TestCase
+{
+public:
+    CREATE_FUNC(AssetsManagerExStreamingBenchmark);
+
+    AssetsManagerExStreamingBenchmark();
+    ~AssetsManagerExStreamingBenchmark() override;
+
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+    virtual bool init() override;
+    virtual void onExit() override;
+
+private:
+    void runUpdate(bool streaming);
+    void onUpdateEnd(bool succeed);
+
+    std::unique_ptr<AssetsPatchServer> _server;
+    std::string _manifestPath;
+    std::string _storagePath;
+
+    ax::extension::AssetsManagerEx* _am = nullptr;
+    ax::extension::EventListenerAssetsManagerEx* _amListener = nullptr;
+    ax::Label* _result = nullptr;
+    std::chrono::steady_clock::time_point _startTime;
+    bool _streaming = false;
+};
+
 #endif /* defined(__AssetsManagerEx_Test_H__) */
@@ -29,10 +29,13 @@
 #include "2d/CameraBackgroundBrush.h"
 #include "3d/MeshMaterial.h"
 #include "3d/MotionStreak3D.h"
+#include "3d/Bundle3D.h"
 
 #include "Particle3D/PU/PUParticleSystem3D.h"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include "../testResource.h"
 
 USING_NS_AX;
@@ -44,6 +47,7 @@ MeshRendererTests::MeshRendererTests()
     ADD_TEST_CASE(MeshRendererDynamicInstancingBasicTest);
     ADD_TEST_CASE(MeshRendererPreallocatedInstancingBufferTest);
     ADD_TEST_CASE(MeshRendererInstancingStressTest);
+    ADD_TEST_CASE(MeshRendererAutoInstancingTest);
     ADD_TEST_CASE(MeshRendererHitTest);
     ADD_TEST_CASE(AsyncLoadMeshRendererTest);
     //    // 3DEffect use custom shader which is not supported on WP8/WinRT yet.
@@ -55,6 +59,9 @@ MeshRendererTests::MeshRendererTests()
     ADD_TEST_CASE(MeshRendererWithSkinTest);
     ADD_TEST_CASE(MeshRendererWithSkinOutlineTest);
     ADD_TEST_CASE(Animate3DTest);
+    ADD_TEST_CASE(Animate3DCurveBenchmarkTest);
+    ADD_TEST_CASE(Bundle3DLoadBenchmarkTest);
+    ADD_TEST_CASE(SceneCullingBenchmarkTest);
     ADD_TEST_CASE(AttachmentTest);
     ADD_TEST_CASE(MeshRendererReskinTest);
     ADD_TEST_CASE(MeshRendererWithOBBPerformanceTest);
@@ -400,6 +407,69 @@ std::string MeshRendererInstancingStressTest::subtitle() const
     return "10000 instances of the same mesh";
 }
 
+//------------------------------------------------------------------
+//
+// MeshRendererAutoInstancingTest
+//
+//------------------------------------------------------------------
+
+MeshRendererAutoInstancingTest::MeshRendererAutoInstancingTest()
+{
+    auto& s = Director::getInstance()->getWinSize();
+
+    // separate mesh renderers of the default material, the renderer merges their commands into instanced draws
+    FastRNG r{};
+    for (int i = 0; i < 400; i++)
+    {
+        auto mesh = MeshRenderer::create("MeshRendererTest/boss1.obj");
+        mesh->setTexture("MeshRendererTest/boss.png");
+        mesh->setScale(1.5f);
+        mesh->setPosition(s.width * (i % 20 + 0.5f) / 20, s.height * (i / 20 + 0.5f) / 20);
+        mesh->runAction(RepeatForever::create(RotateBy::create(r.rangef(0.5, 2), Vec3(0, 0, 360))));
+        addChild(mesh);
+    }
+
+    MenuItemFont::setFontName("fonts/arial.ttf");
+    MenuItemFont::setFontSize(15);
+    auto toggle = MenuItemFont::create("Toggle auto instancing", [](Object*) {
+        auto renderer = Director::getInstance()->getRenderer();
+        renderer->setAutoInstancing(!renderer->isAutoInstancing());
+    });
+    auto menu = Menu::create(toggle, nullptr);
+    menu->setPosition(Vec2(s.width / 2, s.height - 70));
+    addChild(menu, 1);
+
+    _stats = Label::createWithTTF("", "fonts/arial.ttf", 14);
+    _stats->setPosition(Vec2(s.width / 2, s.height - 90));
+    addChild(_stats, 1);
+
+    schedule(AX_SCHEDULE_SELECTOR(MeshRendererAutoInstancingTest::updateStats));
+}
+
+MeshRendererAutoInstancingTest::~MeshRendererAutoInstancingTest()
+{
+    Director::getInstance()->getRenderer()->setAutoInstancing(true);
+}
+
+void MeshRendererAutoInstancingTest::updateStats(float /*dt*/)
+{
+    auto renderer  = Director::getInstance()->getRenderer();
+    auto instanced = renderer->getDrawnInstancedBatches();
+    _stats->setString(fmt::format("auto instancing: {}, instanced draws: {} ({} meshes), other draws: {}",
+                                  renderer->isAutoInstancing() ? "on" : "off", instanced,
+                                  renderer->getDrawnInstances(), renderer->getDrawnBatches() - instanced));
+}
+
+std::string MeshRendererAutoInstancingTest::title() const
+{
+    return "Testing Auto Instancing";
+}
+
+std::string MeshRendererAutoInstancingTest::subtitle() const
+{
+    return "400 mesh renderers of the default material drawn with instanced draws";
+}
+
 //------------------------------------------------------------------
 //
 // MeshRendererUVAnimationTest
@@ -1376,6 +1446,261 @@ void Animate3DTest::onTouchesEnded(const std::vector<Touch*>& touches, Event* ev
     }
 }
 
+//------------------------------------------------------------------
+//
+// Animate3DCurveBenchmarkTest
+//
+//------------------------------------------------------------------
+
+static std::string benchmarkAnimationCurves(std::string_view path)
+{
+    auto bundle = Bundle3D::createBundle();
+    Animation3DData data;
+    bool loaded = bundle->load(FileUtils::getInstance()->fullPathForFilename(path)) &&
+                  bundle->loadAnimationData("", &data);
+    Bundle3D::destroyBundle(bundle);
+    if (!loaded)
+        return fmt::format("{}: no animation\n", path);
+
+    const bool quantization = Animation3D::isCurveQuantization();
+    Animation3D::setCurveQuantization(false);
+    auto animation = new Animation3D();
+    animation->init(data);
+    Animation3D::setCurveQuantization(true);
+    auto quantized = new Animation3D();
+    quantized->init(data);
+    Animation3D::setCurveQuantization(quantization);
+
+    // sample the clip frame by frame, as a playback does
+    constexpr int frames = 2000;
+    using clock          = std::chrono::steady_clock;
+    volatile float sink  = 0;  // keeps the samples alive
+    auto sampleAll       = [&](Animation3D* anim, bool cursor) {
+        std::vector<Animation3D::Curve*> curves;
+        for (auto&& it : anim->getBoneCurves())
+            curves.emplace_back(it.second);
+        std::vector<Animation3D::CurveCursor> cursors(curves.size());
+        std::vector<Animation3D::BonePose> poses(curves.size());
+
+        auto start = clock::now();
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            const float t = static_cast<float>(frame) / frames;
+            if (cursor)
+            {
+                Animation3D::evaluatePose(t, curves.data(), cursors.data(), poses.data(), curves.size(),
+                                          EvaluateType::INT_LINEAR, EvaluateType::INT_QUAT_SLERP,
+                                          EvaluateType::INT_LINEAR);
+                continue;
+            }
+            for (size_t i = 0; i < curves.size(); ++i)
+            {
+                auto& pose = poses[i];
+                if (curves[i]->translateCurve)
+                    curves[i]->translateCurve->evaluate(t, pose.translate, EvaluateType::INT_LINEAR);
+                if (curves[i]->rotCurve)
+                    curves[i]->rotCurve->evaluate(t, pose.rot, EvaluateType::INT_QUAT_SLERP);
+                if (curves[i]->scaleCurve)
+                    curves[i]->scaleCurve->evaluate(t, pose.scale, EvaluateType::INT_LINEAR);
+            }
+        }
+        for (auto&& pose : poses)
+            sink = sink + pose.rot[3];
+        return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    };
+
+    const double searchMs    = sampleAll(animation, false);
+    const double cursorMs    = sampleAll(animation, true);
+    const double quantizedMs = sampleAll(quantized, true);
+
+    auto report = fmt::format(
+        "{}: {} curves, keys {:.1f} KB, quantized {:.1f} KB\n"
+        "{} frames: binary search {:.2f} ms, cursors {:.2f} ms, quantized {:.2f} ms\n",
+        path, animation->getBoneCurves().size(), animation->getCurvesMemorySize() / 1024.0,
+        quantized->getCurvesMemorySize() / 1024.0, frames, searchMs, cursorMs, quantizedMs);
+
+    animation->release();
+    quantized->release();
+    return report;
+}
+
+Animate3DCurveBenchmarkTest::Animate3DCurveBenchmarkTest()
+{
+    auto& s = Director::getInstance()->getWinSize();
+
+    std::string report;
+    for (auto path : {"MeshRendererTest/orc.c3b", "MeshRendererTest/girl.c3b", "MeshRendererTest/ReskinGirl.c3b",
+                      "MeshRendererTest/tortoise.c3b"})
+        report += benchmarkAnimationCurves(path);
+
+    auto label = Label::createWithTTF(report, "fonts/arial.ttf", 14);
+    label->setPosition(Vec2(s.width / 2, s.height / 2));
+    addChild(label);
+}
+
+std::string Animate3DCurveBenchmarkTest::title() const
+{
+    return "Animate3D Curve Sampling";
+}
+
+std::string Animate3DCurveBenchmarkTest::subtitle() const
+{
+    return "Key memory and sampling time of the clips";
+}
+
+//------------------------------------------------------------------
+//
+// Bundle3DLoadBenchmarkTest
+//
+//------------------------------------------------------------------
+
+Bundle3DLoadBenchmarkTest::Bundle3DLoadBenchmarkTest()
+{
+    auto& s = Director::getInstance()->getWinSize();
+
+    MenuItemFont::setFontName("fonts/arial.ttf");
+    MenuItemFont::setFontSize(15);
+    auto run  = MenuItemFont::create("Run again", [this](Object*) { runBenchmark(); });
+    auto menu = Menu::create(run, nullptr);
+    menu->setPosition(Vec2(s.width / 2, s.height - 70));
+    addChild(menu, 1);
+
+    _report = Label::createWithTTF("", "fonts/arial.ttf", 14);
+    _report->setPosition(Vec2(s.width / 2, s.height / 2));
+    addChild(_report);
+
+    runBenchmark();
+}
+
+Bundle3DLoadBenchmarkTest::~Bundle3DLoadBenchmarkTest()
+{
+    Bundle3D::setMemoryMapping(true);
+}
+
+void Bundle3DLoadBenchmarkTest::runBenchmark()
+{
+    // a level load, hundreds of models parsed as MeshRenderer does
+    std::vector<std::string> paths;
+    for (int i = 0; i < 60; ++i)
+    {
+        for (auto path : {"MeshRendererTest/orc.c3b", "MeshRendererTest/girl.c3b", "MeshRendererTest/ReskinGirl.c3b",
+                          "MeshRendererTest/tortoise.c3b", "MeshRendererTest/LightMapScene.c3b"})
+            paths.emplace_back(FileUtils::getInstance()->fullPathForFilename(path));
+    }
+
+    std::atomic<int> failures{0};
+    auto parse = [&](size_t first, size_t last) {
+        for (; first < last; ++first)
+        {
+            MeshDatas meshdatas;
+            MaterialDatas materialdatas;
+            NodeDatas nodedatas;
+            auto bundle = Bundle3D::createBundle();
+            if (!bundle->load(paths[first]) || !bundle->loadMeshDatas(meshdatas) ||
+                !bundle->loadMaterials(materialdatas) || !bundle->loadNodes(nodedatas))
+                ++failures;
+            Bundle3D::destroyBundle(bundle);
+        }
+    };
+
+    using clock  = std::chrono::steady_clock;
+    auto measure = [](const std::function<void()>& fn) {
+        auto start = clock::now();
+        fn();
+        return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    };
+
+    Bundle3D::setMemoryMapping(false);
+    const double readMs = measure([&] { parse(0, paths.size()); });
+    Bundle3D::setMemoryMapping(true);
+    const double mappedMs   = measure([&] { parse(0, paths.size()); });
+    const double parallelMs = measure(
+        [&] { Director::getInstance()->getJobSystem()->parallelFor(paths.size(), 1, parse); });
+
+    _report->setString(fmt::format("{} models: read {:.1f} ms, mapped {:.1f} ms, mapped on job threads {:.1f} ms{}",
+                                   paths.size(), readMs, mappedMs, parallelMs,
+                                   failures ? fmt::format("\n{} loads failed", failures.load()) : ""));
+}
+
+std::string Bundle3DLoadBenchmarkTest::title() const
+{
+    return "Bundle3D Load Benchmark";
+}
+
+std::string Bundle3DLoadBenchmarkTest::subtitle() const
+{
+    return "Parse .c3b models read into memory, mapped, and mapped in parallel";
+}
+
+//------------------------------------------------------------------
+//
+// SceneCullingBenchmarkTest
+//
+//------------------------------------------------------------------
+
+SceneCullingBenchmarkTest::SceneCullingBenchmarkTest()
+{
+    auto& s = Director::getInstance()->getWinSize();
+
+    // a field of static props around a turning camera
+    const int rows = 100;
+    for (int i = 0; i < rows; ++i)
+    {
+        for (int j = 0; j < rows; ++j)
+        {
+            auto prop = MeshRenderer::create("MeshRendererTest/cylinder.c3b");
+            prop->setPosition3D(Vec3((i - rows / 2) * 12.0f, -10.0f, (j - rows / 2) * 12.0f));
+            prop->setScale(0.5f);
+            addChild(prop);
+            ++_propCount;
+        }
+    }
+
+    _camera = Camera::createPerspective(60, s.width / s.height, 1.0f, 400.0f);
+    _camera->setCameraFlag(CameraFlag::USER1);
+    addChild(_camera);
+    setCameraMask(2);
+
+    setCulling3DEnabled(true);
+
+    MenuItemFont::setFontName("fonts/arial.ttf");
+    MenuItemFont::setFontSize(15);
+    auto toggle = MenuItemToggle::createWithCallback(
+        [this](Object*) { setCulling3DEnabled(!isCulling3DEnabled()); }, MenuItemFont::create("Culling: On"),
+        MenuItemFont::create("Culling: Off"), nullptr);
+    auto menu = Menu::create(toggle, nullptr);
+    menu->setPosition(Vec2(s.width / 2, s.height - 70));
+    addChild(menu, 1);
+
+    _report = Label::createWithTTF("", "fonts/arial.ttf", 14);
+    _report->setPosition(Vec2(s.width / 2, s.height - 95));
+    addChild(_report, 1);
+
+    scheduleUpdate();
+}
+
+void SceneCullingBenchmarkTest::update(float dt)
+{
+    _angle += dt * 0.3f;
+    _camera->setPosition3D(Vec3(0.0f, 20.0f, 0.0f));
+    _camera->lookAt(Vec3(100.0f * std::cos(_angle), 0.0f, 100.0f * std::sin(_angle)));
+
+    if (isCulling3DEnabled())
+        _report->setString(fmt::format("{} props, {} in the frustum", _propCount, getCulling3DVisibleCount()));
+    else
+        _report->setString(fmt::format("{} props, all visited", _propCount));
+}
+
+std::string SceneCullingBenchmarkTest::title() const
+{
+    return "Scene Culling Benchmark";
+}
+
+std::string SceneCullingBenchmarkTest::subtitle() const
+{
+    return "Static meshes culled by the scene bounding volume hierarchy";
+}
+
 AttachmentTest::AttachmentTest() : _hasWeapon(false), _mesh(nullptr)
 {
     auto s = Director::getInstance()->getWinSize();
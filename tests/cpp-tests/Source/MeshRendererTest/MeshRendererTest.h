@@ -115,6 +115,21 @@ public:
     virtual std::string subtitle() const override;
 };
 
+class MeshRendererAutoInstancingTest : public MeshRendererTestDemo
+{
+public:
+    CREATE_FUNC(MeshRendererAutoInstancingTest);
+    MeshRendererAutoInstancingTest();
+    virtual ~MeshRendererAutoInstancingTest();
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+protected:
+    void updateStats(float dt);
+
+    ax::Label* _stats = nullptr;
+};
+
 class MeshRendererUVAnimationTest : public MeshRendererTestDemo
 {
 public:
@@ -333,6 +348,46 @@ protected:
     ax::MoveTo* _moveAction;
 };
 
+class Animate3DCurveBenchmarkTest : public MeshRendererTestDemo
+{
+public:
+    CREATE_FUNC(Animate3DCurveBenchmarkTest);
+    Animate3DCurveBenchmarkTest();
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+};
+
+class Bundle3DLoadBenchmarkTest : public MeshRendererTestDemo
+{
+public:
+    CREATE_FUNC(Bundle3DLoadBenchmarkTest);
+    Bundle3DLoadBenchmarkTest();
+    virtual ~Bundle3DLoadBenchmarkTest();
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+protected:
+    void runBenchmark();
+
+    ax::Label* _report = nullptr;
+};
+
+class SceneCullingBenchmarkTest : public MeshRendererTestDemo
+{
+public:
+    CREATE_FUNC(SceneCullingBenchmarkTest);
+    SceneCullingBenchmarkTest();
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual void update(float dt) override;
+
+protected:
+    ax::Camera* _camera = nullptr;
+    ax::Label* _report  = nullptr;
+    float _angle        = 0.0f;
+    int _propCount      = 0;
+};
+
 class AttachmentTest : public MeshRendererTestDemo
 {
 public:
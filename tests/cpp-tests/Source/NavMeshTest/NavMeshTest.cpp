@@ -46,6 +46,7 @@ NavMeshTests::NavMeshTests()
 #else
     ADD_TEST_CASE(NavMeshBasicTestDemo);
     ADD_TEST_CASE(NavMeshAdvanceTestDemo);
+    ADD_TEST_CASE(NavMeshPathQueryTestDemo);
 #endif
 };
 
@@ -436,4 +437,113 @@ void NavMeshAdvanceTestDemo::touchesEnded(const std::vector<ax::Touch*>& touches
     }
 }
 
+bool NavMeshPathQueryTestDemo::init()
+{
+    if (!NavMeshBaseTestDemo::init())
+        return false;
+
+    getNavMesh()->setDebugDrawEnable(false);
+    getNavMesh()->setPathQueryIterations(256);
+
+    TTFConfig ttfConfig("fonts/arial.ttf", 15);
+    auto modeItem = MenuItemToggle::createWithCallback([=](Object*) { _async = !_async; },
+                                                       MenuItemLabel::create(Label::createWithTTF(ttfConfig, "Async")),
+                                                       MenuItemLabel::create(Label::createWithTTF(ttfConfig, "Sync")),
+                                                       nullptr);
+    modeItem->setAnchorPoint(Vec2::ANCHOR_TOP_LEFT);
+    modeItem->setPosition(Vec2(VisibleRect::left().x, VisibleRect::top().y - 50));
+
+    auto agentItem = MenuItemLabel::create(Label::createWithTTF(ttfConfig, "More Agents"), [=](Object*) {
+        _agentCount = _agentCount >= 1600 ? 200 : _agentCount * 2;
+    });
+    agentItem->setAnchorPoint(Vec2::ANCHOR_TOP_LEFT);
+    agentItem->setPosition(Vec2(VisibleRect::left().x, VisibleRect::top().y - 100));
+
+    auto menu = Menu::create(modeItem, agentItem, nullptr);
+    menu->setPosition(Vec2::ZERO);
+    addChild(menu);
+
+    _report = Label::createWithTTF(ttfConfig, "");
+    _report->setAnchorPoint(Vec2::ANCHOR_TOP_LEFT);
+    _report->setPosition(Vec2(VisibleRect::left().x, VisibleRect::top().y - 150));
+    addChild(_report);
+
+    return true;
+}
+
+void NavMeshPathQueryTestDemo::onEnter()
+{
+    NavMeshBaseTestDemo::onEnter();
+
+    // the walkable points the agents repath between
+    for (int i = -10; i <= 10; ++i)
+    {
+        for (int j = -10; j <= 10; ++j)
+        {
+            Physics3DWorld::HitResult result;
+            if (getPhysics3DWorld()->rayCast(Vec3(i * 5.0f, 50.0f, j * 5.0f), Vec3(i * 5.0f, -50.0f, j * 5.0f),
+                                             &result))
+                _groundPoints.emplace_back(result.hitPosition);
+        }
+    }
+}
+
+void NavMeshPathQueryTestDemo::update(float delta)
+{
+    NavMeshBaseTestDemo::update(delta);
+    if (_groundPoints.empty())
+        return;
+
+    // each simulated agent repaths once per second
+    while ((int)_repathTimers.size() < _agentCount)
+        _repathTimers.emplace_back(AXRANDOM_0_1());
+
+    auto start = std::chrono::steady_clock::now();
+    int last   = (int)_groundPoints.size() - 1;
+    for (int i = 0; i < _agentCount; ++i)
+    {
+        _repathTimers[i] -= delta;
+        if (_repathTimers[i] > 0.0f)
+            continue;
+        _repathTimers[i] += 1.0f;
+
+        auto& from = _groundPoints[ax::random(0, last)];
+        auto& to   = _groundPoints[ax::random(0, last)];
+        if (_async)
+        {
+            getNavMesh()->findPathAsync(from, to, [this](const std::vector<Vec3>&) { ++_pathCount; });
+        }
+        else
+        {
+            std::vector<Vec3> pathPoints;
+            getNavMesh()->findPath(from, to, pathPoints);
+            ++_pathCount;
+        }
+    }
+    _requestTime += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    ++_frames;
+    _elapsed += delta;
+    if (_elapsed >= 1.0f)
+    {
+        _report->setString(fmt::format("{} agents, {} paths/s, {:.2f} ms/frame to request, {} pending", _agentCount,
+                                       (int)(_pathCount / _elapsed), _requestTime / _frames,
+                                       getNavMesh()->getPendingPathRequestCount()));
+        _pathCount   = 0;
+        _frames      = 0;
+        _elapsed     = 0.0f;
+        _requestTime = 0.0f;
+    }
+}
+
+std::string NavMeshPathQueryTestDemo::title() const
+{
+    return "Navigation Mesh Test";
+}
+
+std::string NavMeshPathQueryTestDemo::subtitle() const
+{
+    return "Path queries on the job threads";
+}
+
 #endif
@@ -121,6 +121,31 @@ protected:
     ax::Label* _debugLabel;
 };
 
+class NavMeshPathQueryTestDemo : public NavMeshBaseTestDemo
+{
+public:
+    CREATE_FUNC(NavMeshPathQueryTestDemo);
+
+    // overrides
+    virtual bool init() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual void update(float delta) override;
+
+    virtual void onEnter() override;
+
+protected:
+    std::vector<ax::Vec3> _groundPoints;
+    std::vector<float> _repathTimers;
+    ax::Label* _report = nullptr;
+    bool _async        = true;
+    int _agentCount    = 200;
+    int _pathCount     = 0;
+    int _frames        = 0;
+    float _elapsed     = 0.0f;
+    float _requestTime = 0.0f;  // ms spent by the main thread to request the paths
+};
+
 #endif
 
 #endif
@@ -28,6 +28,7 @@
 #include <chrono>
 #include <sstream>
 #include "renderer/backend/DriverBase.h"
+#include "renderer/RenderCapture.h"
 
 namespace
 {
@@ -89,6 +90,7 @@ NewRendererTests::NewRendererTests()
     ADD_TEST_CASE(CaptureNodeTest);
     ADD_TEST_CASE(BugAutoCulling);
     ADD_TEST_CASE(RendererBatchQuadTri);
+    ADD_TEST_CASE(RendererCaptureReplay);
     ADD_TEST_CASE(RendererUniformBatch);
     ADD_TEST_CASE(RendererUniformBatch2);
     ADD_TEST_CASE(SpriteCreation);
@@ -814,6 +816,80 @@ std::string RendererBatchQuadTri::subtitle() const
     return "QuadCommand and TriangleCommands are batched together";
 }
 
+//
+// RendererCaptureReplay
+//
+
+RendererCaptureReplay::RendererCaptureReplay()
+{
+    Size s = Director::getInstance()->getWinSize();
+
+    // rows of sprites and labels which interleave two textures
+    for (int i = 0; i < 60; i++)
+    {
+        Vec2 pos(s.width * (i % 6 + 0.5f) / 6, s.height * (0.3f + i / 6 * 0.06f));
+
+        auto sprite = Sprite::create("Images/grossini_dance_01.png");
+        sprite->setScale(0.3f);
+        sprite->setPosition(pos);
+        addChild(sprite);
+
+        auto label = LabelAtlas::create(std::to_string(i), "fonts/tuffy_bold_italic-charmap.plist");
+        label->setScale(0.4f);
+        label->setPosition(pos + Vec2(-15, 0));
+        addChild(label);
+    }
+
+    auto item = MenuItemFont::create("Capture and replay", AX_CALLBACK_1(RendererCaptureReplay::onCapture, this));
+    auto menu = Menu::create(item, nullptr);
+    menu->setPosition(s.width / 2, s.height * 0.2f);
+    addChild(menu);
+
+    _statsLabel = Label::createWithTTF("", "fonts/arial.ttf", 12);
+    _statsLabel->setPosition(s.width / 2, s.height * 0.12f);
+    addChild(_statsLabel);
+
+    _filename = FileUtils::getInstance()->getWritablePath() + "RendererCaptureReplay.bin";
+}
+
+void RendererCaptureReplay::onCapture(Object*)
+{
+    // the frame is recorded when it renders, it's replayed on the next one
+    Director::getInstance()->getRenderer()->captureNextFrame(_filename);
+    scheduleOnce([this](float) { replayCapture(); }, 0, "replay");
+}
+
+void RendererCaptureReplay::replayCapture()
+{
+    ax::RenderCaptureReplay replay;
+    if (!replay.load(_filename))
+    {
+        _statsLabel->setString("Capture failed");
+        return;
+    }
+
+    std::string text;
+    for (bool reordering : {false, true})
+    {
+        replay.getRenderer()->setBatchReordering(reordering);
+        auto& stats = replay.replay(20);
+        text += fmt::format("reordering {}: {} commands, {} draws, {} vertices, {} uploaded bytes, {:.3f} ms\n",
+                            reordering ? "on" : "off", stats.commands, stats.draws, stats.drawnVertices,
+                            stats.uploadedBytes, stats.renderTime);
+    }
+    _statsLabel->setString(text);
+}
+
+std::string RendererCaptureReplay::title() const
+{
+    return "RendererCaptureReplay";
+}
+
+std::string RendererCaptureReplay::subtitle() const
+{
+    return "Capture a frame, replay it without the GPU";
+}
+
 //
 //
 // RendererUniformBatch
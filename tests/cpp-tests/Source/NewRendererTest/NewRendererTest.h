@@ -214,6 +214,23 @@ protected:
     RendererBatchQuadTri();
 };
 
+class RendererCaptureReplay : public MultiSceneTest
+{
+public:
+    CREATE_FUNC(RendererCaptureReplay);
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+protected:
+    RendererCaptureReplay();
+
+    void onCapture(ax::Object*);
+    void replayCapture();
+
+    std::string _filename;
+    ax::Label* _statsLabel = nullptr;
+};
+
 class RendererUniformBatch : public MultiSceneTest
 {
 public:
@@ -54,6 +54,8 @@ PhysicsTests::PhysicsTests()
     ADD_TEST_CASE(PhysicsIssue9959);
     ADD_TEST_CASE(PhysicsIssue15932);
     ADD_TEST_CASE(PhysicsDemoPyramidStackFixedUpdate);
+    ADD_TEST_CASE(PhysicsDemoBodies10k);
+    ADD_TEST_CASE(PhysicsDemoBatchRayCast);
 }
 
 namespace
@@ -2022,4 +2024,201 @@ void PhysicsDemoPyramidStackFixedUpdate::fixedUpdate(float delta)
     }
 }
 
+void PhysicsDemoBodies10k::onEnter()
+{
+    PhysicsDemo::onEnter();
+
+    auto wall = Node::create();
+    wall->addComponent(PhysicsBody::createEdgeBox(VisibleRect::getVisibleRect().size, PhysicsMaterial(0.1f, 0.5f, 0.5f)));
+    wall->setPosition(VisibleRect::center());
+    addChild(wall);
+
+    // 100 x 100 small balls, dropped as a block so most of them stay awake and collide
+    const int columns   = 100;
+    const float radius  = 1.5f;
+    const float spacing = (VisibleRect::getVisibleRect().size.width - 20) / columns;
+    const Vec2 origin   = VisibleRect::leftBottom() + Vec2(10 + spacing / 2, 10 + spacing / 2);
+    for (int i = 0; i < 10000; ++i)
+    {
+        auto ball = makeBall(origin + Vec2((i % columns) * spacing, (i / columns) * spacing), radius);
+        ball->getPhysicsBody()->setTag(DRAG_BODYS_TAG);
+        addChild(ball);
+    }
+
+    _physicsWorld->setFixedUpdateRate(60);
+    _physicsWorld->setInterpolationEnabled(true);
+    _physicsWorld->setParallelSyncThreshold(_parallelSyncThreshold);
+
+    _physicsWorld->setPreUpdateCallback([this]() { _updateStart = std::chrono::steady_clock::now(); });
+    _physicsWorld->setPostUpdateCallback([this]() {
+        _updateTimeSum +=
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _updateStart).count();
+        if (++_updateCount >= 60)
+            updateInfo();
+    });
+
+    MenuItemFont::setFontSize(18);
+    auto parallelItem = MenuItemFont::create("Toggle parallel sync", AX_CALLBACK_1(PhysicsDemoBodies10k::toggleParallelSync, this));
+    auto interpolationItem =
+        MenuItemFont::create("Toggle interpolation", AX_CALLBACK_1(PhysicsDemoBodies10k::toggleInterpolation, this));
+    auto menu = Menu::create(parallelItem, interpolationItem, nullptr);
+    menu->alignItemsVertically();
+    menu->setPosition(Vec2(VisibleRect::left().x + 100, VisibleRect::top().y - 60));
+    addChild(menu);
+
+    _info = Label::createWithTTF("", "fonts/arial.ttf", 14);
+    _info->setAnchorPoint(Vec2::ANCHOR_TOP_RIGHT);
+    _info->setPosition(VisibleRect::rightTop() + Vec2(-10.0f, -50.0f));
+    addChild(_info, 1);
+    updateInfo();
+}
+
+void PhysicsDemoBodies10k::onExit()
+{
+    _physicsWorld->setPreUpdateCallback(nullptr);
+    _physicsWorld->setPostUpdateCallback(nullptr);
+    PhysicsDemo::onExit();
+}
+
+void PhysicsDemoBodies10k::toggleParallelSync(Object* sender)
+{
+    _parallelSyncThreshold = _parallelSyncThreshold ? 0 : 512;
+    _physicsWorld->setParallelSyncThreshold(_parallelSyncThreshold);
+    updateInfo();
+}
+
+void PhysicsDemoBodies10k::toggleInterpolation(Object* sender)
+{
+    _physicsWorld->setInterpolationEnabled(!_physicsWorld->isInterpolationEnabled());
+    updateInfo();
+}
+
+void PhysicsDemoBodies10k::updateInfo()
+{
+    const double average = _updateCount ? _updateTimeSum / _updateCount : 0.0;
+    _info->setString(fmt::format("parallel sync: {}\ninterpolation: {}\nsolver threads: {}\nphysics update: {:.2f} ms",
+                                 _parallelSyncThreshold ? "on" : "off",
+                                 _physicsWorld->isInterpolationEnabled() ? "on" : "off",
+                                 _physicsWorld->getSolverThreads(), average));
+    _updateTimeSum = 0;
+    _updateCount   = 0;
+}
+
+std::string PhysicsDemoBodies10k::title() const
+{
+    return "10k Bodies";
+}
+
+std::string PhysicsDemoBodies10k::subtitle() const
+{
+    return "Average physics update time of 60 frames";
+}
+
+void PhysicsDemoBatchRayCast::onEnter()
+{
+    PhysicsDemo::onEnter();
+
+    auto wall = Node::create();
+    wall->addComponent(PhysicsBody::createEdgeBox(VisibleRect::getVisibleRect().size, PhysicsMaterial(0.1f, 1.0f, 0.0f)));
+    wall->setPosition(VisibleRect::center());
+    addChild(wall);
+
+    for (int i = 0; i < 200; ++i)
+    {
+        auto ball = makeBall(VisibleRect::center() + Vec2(AXRANDOM_MINUS1_1() * 200, AXRANDOM_MINUS1_1() * 120), 4);
+        ball->getPhysicsBody()->setVelocity(Vec2(AXRANDOM_MINUS1_1() * 100, AXRANDOM_MINUS1_1() * 100));
+        ball->getPhysicsBody()->setTag(DRAG_BODYS_TAG);
+        addChild(ball);
+    }
+    _physicsWorld->setGravity(Vec2::ZERO);
+
+    _rays.resize(4096);
+    _node = DrawNode::create();
+    addChild(_node);
+
+    MenuItemFont::setFontSize(18);
+    auto item = MenuItemFont::create("Toggle batch", AX_CALLBACK_1(PhysicsDemoBatchRayCast::toggleBatchCallback, this));
+    auto menu = Menu::create(item, nullptr);
+    menu->setPosition(Vec2(VisibleRect::left().x + 100, VisibleRect::top().y - 60));
+    addChild(menu);
+
+    _info = Label::createWithTTF("", "fonts/arial.ttf", 14);
+    _info->setAnchorPoint(Vec2::ANCHOR_TOP_RIGHT);
+    _info->setPosition(VisibleRect::rightTop() + Vec2(-10.0f, -50.0f));
+    addChild(_info, 1);
+
+    scheduleUpdate();
+}
+
+void PhysicsDemoBatchRayCast::update(float delta)
+{
+    // rays fan out from the center, like the line of sight checks of many agents
+    _angle += delta;
+    const Vec2 center = VisibleRect::center();
+    const int count   = static_cast<int>(_rays.size());
+    for (int i = 0; i < count; ++i)
+    {
+        const float angle = _angle + i * 2 * M_PI / count;
+        _rays[i]          = {center, center + Vec2(cosf(angle), sinf(angle)) * 400};
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    if (_batch)
+    {
+        _hits.resize(_rays.size());
+        _physicsWorld->rayCastClosestBatch(_rays.data(), _rays.size(), _hits.data());
+    }
+    else
+    {
+        _hits.clear();
+        for (unsigned int i = 0; i < _rays.size(); ++i)
+        {
+            PhysicsRayCastHit hit = {i, nullptr, _rays[i].end, Vec2::ZERO, 1.0f};
+            _physicsWorld->rayCast(
+                [&hit](PhysicsWorld&, const PhysicsRayCastInfo& info, void*) -> bool {
+                    if (info.fraction < hit.fraction)
+                        hit = {hit.query, info.shape, info.contact, info.normal, info.fraction};
+                    return true;
+                },
+                _rays[i].start, _rays[i].end, nullptr);
+            _hits.push_back(hit);
+        }
+    }
+    _queryTimeSum += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    _node->clear();
+    for (size_t i = 0; i < _hits.size(); i += 32)
+    {
+        const auto& hit = _hits[i];
+        _node->drawSegment(center, hit.shape ? hit.contact : _rays[i].end, 0.5f, STATIC_COLOR);
+        if (hit.shape)
+            _node->drawDot(hit.contact, 2, Color4F(1.0f, 1.0f, 1.0f, 1.0f));
+    }
+
+    if (++_queryCount >= 60)
+    {
+        _info->setString(fmt::format("{}: {} rays in {:.2f} ms", _batch ? "batch" : "one by one", _rays.size(),
+                                     _queryTimeSum / _queryCount));
+        _queryTimeSum = 0;
+        _queryCount   = 0;
+    }
+}
+
+void PhysicsDemoBatchRayCast::toggleBatchCallback(Object* sender)
+{
+    _batch        = !_batch;
+    _queryTimeSum = 0;
+    _queryCount   = 0;
+}
+
+std::string PhysicsDemoBatchRayCast::title() const
+{
+    return "Batch Ray Cast";
+}
+
+std::string PhysicsDemoBatchRayCast::subtitle() const
+{
+    return "Closest hits of 4096 rays per frame";
+}
+
 #endif
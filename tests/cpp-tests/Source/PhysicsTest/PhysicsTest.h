@@ -25,6 +25,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <map>
 
 #include "../BaseTest.h"
@@ -324,4 +325,50 @@ private:
     float _delayTime;
 };
 
+class PhysicsDemoBodies10k : public PhysicsDemo
+{
+public:
+    CREATE_FUNC(PhysicsDemoBodies10k);
+
+    void onEnter() override;
+    void onExit() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+    void toggleParallelSync(ax::Object* sender);
+    void toggleInterpolation(ax::Object* sender);
+
+private:
+    void updateInfo();
+
+    ax::Label* _info = nullptr;
+    std::chrono::steady_clock::time_point _updateStart;
+    double _updateTimeSum      = 0;
+    int _updateCount           = 0;
+    int _parallelSyncThreshold = 512;
+};
+
+class PhysicsDemoBatchRayCast : public PhysicsDemo
+{
+public:
+    CREATE_FUNC(PhysicsDemoBatchRayCast);
+
+    void onEnter() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    void update(float delta) override;
+
+    void toggleBatchCallback(ax::Object* sender);
+
+private:
+    ax::DrawNode* _node  = nullptr;
+    ax::Label* _info     = nullptr;
+    bool _batch          = true;
+    float _angle         = 0;
+    double _queryTimeSum = 0;
+    int _queryCount      = 0;
+    std::vector<ax::PhysicsRay> _rays;
+    std::vector<ax::PhysicsRayCastHit> _hits;
+};
+
 #endif  // #if defined(AX_ENABLE_PHYSICS)
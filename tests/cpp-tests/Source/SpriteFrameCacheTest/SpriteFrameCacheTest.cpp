@@ -30,6 +30,7 @@
 #include <cassert>
 
 #include "NinePatchImageParser.h"
+#include "2d/BinarySpriteSheetLoader.h"
 
 USING_NS_AX;
 
@@ -39,6 +40,7 @@ SpriteFrameCacheTests::SpriteFrameCacheTests()
     ADD_TEST_CASE(SpriteFrameCacheLoadMultipleTimes);
     ADD_TEST_CASE(SpriteFrameCacheFullCheck);
     ADD_TEST_CASE(SpriteFrameCacheJsonAtlasTest);
+    ADD_TEST_CASE(SpriteFrameCacheLoadBenchmark);
 }
 
 SpriteFrameCachePixelFormatTest::SpriteFrameCachePixelFormatTest()
@@ -500,3 +502,96 @@ void SpriteFrameCacheJsonAtlasTest::loadSpriteFrames(std::string_view file,
     SpriteFrameCache::getInstance()->removeSpriteFramesFromFile(file);
     Director::getInstance()->getTextureCache()->removeTexture(texture);
 }
+
+SpriteFrameCacheLoadBenchmark::SpriteFrameCacheLoadBenchmark()
+{
+    constexpr int sheetCount = 200;
+    constexpr int frameCount = 150;
+
+    auto fileUtils = FileUtils::getInstance();
+    auto cache     = SpriteFrameCache::getInstance();
+    auto texture   = Director::getInstance()->getTextureCache()->addImage("Images/grossini_dance_atlas.png");
+    auto dir       = fileUtils->getWritablePath() + "sprite-sheet-benchmark/";
+    fileUtils->createDirectory(dir);
+
+    // generate the same sheets in the plist and the TexturePacker JSON formats
+    std::vector<std::string> plists, jsons, binaries;
+    for (int sheet = 0; sheet < sheetCount; ++sheet)
+    {
+        std::string plist = R"(<?xml version="1.0" encoding="UTF-8"?>
+<!DOCTYPE plist PUBLIC "-//Apple//DTD PLIST 1.0//EN" "http://www.apple.com/DTDs/PropertyList-1.0.dtd">
+<plist version="1.0"><dict><key>frames</key><dict>
+)";
+        std::string json = R"({"frames": {)";
+        for (int i = 0; i < frameCount; ++i)
+        {
+            int x = (i % 10) * 85, y = (i / 10) * 121, w = 85, h = 121;
+            bool rotated = i % 3 == 0;
+            plist += fmt::format(
+                "<key>sheet{}_frame{}.png</key><dict><key>frame</key><string>{{{{{},{}}},{{{},{}}}}}</string>"
+                "<key>offset</key><string>{{0,0}}</string><key>rotated</key><{}/><key>sourceColorRect</key>"
+                "<string>{{{{0,0}},{{{},{}}}}}</string><key>sourceSize</key><string>{{{},{}}}</string></dict>\n",
+                sheet, i, x, y, w, h, rotated ? "true" : "false", w, h, w, h);
+            json += fmt::format(
+                R"({}"sheet{}_frame{}.png": {{"frame": {{"x": {}, "y": {}, "w": {}, "h": {}}}, "rotated": {}, )"
+                R"("trimmed": false, "spriteSourceSize": {{"x": 0, "y": 0, "w": {}, "h": {}}}, )"
+                R"("sourceSize": {{"w": {}, "h": {}}}}})",
+                i ? ",\n" : "\n", sheet, i, x, y, w, h, rotated, w, h, w, h);
+        }
+        plist += R"(</dict><key>metadata</key><dict><key>format</key><integer>2</integer>
+<key>textureFileName</key><string>grossini_dance_atlas.png</string></dict></dict></plist>)";
+        json += R"(}, "meta": {"image": "grossini_dance_atlas.png", "format": "RGBA8888", "size": {"w": 1024, "h": 1024}}})";
+
+        plists.emplace_back(fmt::format("{}sheet{}.plist", dir, sheet));
+        jsons.emplace_back(fmt::format("{}sheet{}.json", dir, sheet));
+        binaries.emplace_back(fmt::format("{}sheet{}.axss", dir, sheet));
+        fileUtils->writeStringToFile(plist, plists.back());
+        fileUtils->writeStringToFile(json, jsons.back());
+    }
+
+    auto plistTime = loadSheets(plists, SpriteSheetFormat::PLIST, texture);
+
+    // convert the plist sheets, and compare a frame of each format
+    for (int sheet = 0; sheet < sheetCount; ++sheet)
+    {
+        cache->addSpriteFramesWithFile(plists[sheet], texture);
+        BinarySpriteSheetLoader::save(plists[sheet], binaries[sheet], *cache);
+    }
+    auto expected = cache->getSpriteFrameByName("sheet7_frame42.png")->getRectInPixels();
+    for (auto& plist : plists)
+        cache->removeSpriteFramesFromFile(plist);
+
+    auto jsonTime   = loadSheets(jsons, SpriteSheetFormat::JSON, texture);
+    auto binaryTime = loadSheets(binaries, SpriteSheetFormat::BINARY, texture);
+
+    cache->addSpriteFramesWithFile(binaries[7], texture, SpriteSheetFormat::BINARY);
+    cache->addSpriteFramesWithFile(jsons[8], texture, SpriteSheetFormat::JSON);
+    auto binaryMatch = cache->getSpriteFrameByName("sheet7_frame42.png")->getRectInPixels().equals(expected);
+    auto jsonMatch   = cache->getSpriteFrameByName("sheet8_frame42.png")->getRectInPixels().equals(expected);
+    cache->removeSpriteFramesFromFile(binaries[7]);
+    cache->removeSpriteFramesFromFile(jsons[8]);
+    fileUtils->removeDirectory(dir);
+
+    auto report = fmt::format("plist: {:.1f} ms\nJSON: {:.1f} ms, frames match: {}\nbinary: {:.1f} ms, frames match: {}",
+                              plistTime, jsonTime, jsonMatch, binaryTime, binaryMatch);
+    const Size screenSize = Director::getInstance()->getWinSize();
+    auto label            = Label::createWithTTF(report, "fonts/arial.ttf", 20);
+    label->setPosition(screenSize.width * 0.5f, screenSize.height * 0.5f);
+    addChild(label);
+}
+
+float SpriteFrameCacheLoadBenchmark::loadSheets(const std::vector<std::string>& files,
+                                                uint32_t format,
+                                                Texture2D* texture)
+{
+    auto cache = SpriteFrameCache::getInstance();
+    auto start = std::chrono::steady_clock::now();
+    for (auto& file : files)
+        cache->addSpriteFramesWithFile(file, texture, format);
+    auto time = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // only drop the benchmark sheets, the frames of the other tests stay cached
+    for (auto& file : files)
+        cache->removeSpriteFramesFromFile(file);
+    return time;
+}
@@ -91,3 +91,17 @@ private:
 
     ax::Label* infoLabel;
 };
+
+class SpriteFrameCacheLoadBenchmark : public TestCase
+{
+public:
+    CREATE_FUNC(SpriteFrameCacheLoadBenchmark);
+
+    virtual std::string title() const override { return "Sprite sheet loaders benchmark"; }
+    virtual std::string subtitle() const override { return "200 sheets, 30000 frames as plist, JSON and binary"; }
+
+    SpriteFrameCacheLoadBenchmark();
+
+private:
+    float loadSheets(const std::vector<std::string>& files, uint32_t format, ax::Texture2D* texture);
+};
@@ -44,6 +44,7 @@ SpritePolygonTest::SpritePolygonTest()
     ADD_TEST_CASE(SpritePolygonTestAutoPolyIsland);
     ADD_TEST_CASE(SpritePolygonTestFrameAnim);
     ADD_TEST_CASE(Issue14017Test);
+    ADD_TEST_CASE(SpritePolygonBatchBenchmark);
     ADD_TEST_CASE(SpritePolygonTestPerformance);   
 }
 
@@ -817,6 +818,78 @@ void SpritePolygonTestFrameAnim::initSprites()
     updateDrawNode();
 }
 
+//
+// SpritePolygonBatchBenchmark
+//
+SpritePolygonBatchBenchmark::SpritePolygonBatchBenchmark()
+{
+    _title    = "SpritePolygon";
+    _subtitle = "AutoPolygon: 256 frames, one by one, batched and cached";
+}
+
+void SpritePolygonBatchBenchmark::initSprites()
+{
+    auto s        = Director::getInstance()->getWinSize();
+    auto filename = "Images/grossini_dance_atlas.png";
+
+    // cut the atlas into a 16x16 grid of frames, in points
+    Image image;
+    image.initWithImageFile(filename);
+    const float scale = Director::getInstance()->getContentScaleFactor();
+    const float w     = image.getWidth() / scale / 16;
+    const float h     = image.getHeight() / scale / 16;
+    std::vector<Rect> rects;
+    for (int i = 0; i < 256; ++i)
+        rects.emplace_back(Rect((i % 16) * w, (i / 16) * h, w, h));
+
+    auto measure = [](const std::function<void()>& func) {
+        auto start = std::chrono::steady_clock::now();
+        func();
+        return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    auto cacheDir = FileUtils::getInstance()->getWritablePath() + "polygon-cache/";
+    FileUtils::getInstance()->removeDirectory(cacheDir);
+
+    std::vector<PolygonInfo> infos;
+    auto serialTime = measure([&] {
+        AutoPolygon ap(filename);
+        for (auto& rect : rects)
+            ap.generateTriangles(rect);
+    });
+    auto batchTime = measure([&] { infos = AutoPolygon::generatePolygons(filename, rects); });
+
+    AutoPolygon::setCacheEnabled(true);
+    auto coldTime = measure([&] { AutoPolygon::generatePolygons(filename, rects); });
+    auto warmTime = measure([&] { infos = AutoPolygon::generatePolygons(filename, rects); });
+    AutoPolygon::setCacheEnabled(false);
+    FileUtils::getInstance()->removeDirectory(cacheDir);
+
+    auto threads = Director::getInstance()->getJobSystem()->getThreadCount();
+    auto report  = fmt::format("one by one: {:.1f} ms\nbatch, {} job threads: {:.1f} ms\n", serialTime, threads,
+                               batchTime);
+    report += fmt::format("cache write: {:.1f} ms\ncache read: {:.1f} ms", coldTime, warmTime);
+    auto label = Label::createWithTTF(report, "fonts/arial.ttf", 16);
+    label->setPosition(s.width / 2, s.height * 0.3f);
+    addChild(label);
+
+    // show a few of the cached polygons
+    for (int i = 0; i < 4; ++i)
+    {
+        auto sprite = Sprite::create(infos[16 * 3 + i * 3]);
+        sprite->setPosition(s.width * (i + 1) / 5, s.height * 0.65f);
+        addChild(sprite);
+
+        auto spDrawNode = DrawNode::create();
+        spDrawNode->setTag(sprite->getTag());
+        spDrawNode->clear();
+        sprite->addChild(spDrawNode);
+        _drawNodes.pushBack(spDrawNode);
+    }
+
+    updateDrawNode();
+}
+
 //
 // Issue14017Test
 //
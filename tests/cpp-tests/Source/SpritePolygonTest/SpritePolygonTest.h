@@ -223,6 +223,14 @@ public:
     virtual void initSprites() override;
 };
 
+class SpritePolygonBatchBenchmark : public SpritePolygonTestDemo
+{
+public:
+    CREATE_FUNC(SpritePolygonBatchBenchmark);
+    SpritePolygonBatchBenchmark();
+    virtual void initSprites() override;
+};
+
 class SpritePolygonTestPerformance : public SpritePolygonTestDemo
 {
 public:
@@ -31,6 +31,7 @@ TerrainTests::TerrainTests()
     ADD_TEST_CASE(TerrainSimple);
     ADD_TEST_CASE(TerrainWalkThru);
     ADD_TEST_CASE(TerrainWithLightMap);
+    ADD_TEST_CASE(TerrainStreamingTest);
 }
 
 Vec3 camera_offset(0, 45, 60);
@@ -393,3 +394,74 @@ void TerrainWithLightMap::onTouchesMoved(const std::vector<ax::Touch*>& touches,
     cameraPos += cameraRightDir * newPos.x * 0.5 * delta;
     _camera->setPosition3D(cameraPos);
 }
+
+TerrainStreamingTest::TerrainStreamingTest()
+{
+    Size visibleSize = Director::getInstance()->getVisibleSize();
+
+    _camera = Camera::createPerspective(60, visibleSize.width / visibleSize.height, 0.1f, 800);
+    _camera->setCameraFlag(CameraFlag::USER1);
+    addChild(_camera);
+
+    createTerrain(true);
+
+    MenuItemFont::setFontName("fonts/arial.ttf");
+    MenuItemFont::setFontSize(15);
+    auto toggle = MenuItemToggle::createWithCallback(
+        [this](Object* sender) { createTerrain(static_cast<MenuItemToggle*>(sender)->getSelectedIndex() == 0); },
+        MenuItemFont::create("Streaming: On"), MenuItemFont::create("Streaming: Off"), nullptr);
+    auto menu = Menu::create(toggle, nullptr);
+    menu->setPosition(Vec2(visibleSize.width / 2, visibleSize.height - 70));
+    addChild(menu, 1);
+
+    _report = Label::createWithTTF("", "fonts/arial.ttf", 14);
+    _report->setPosition(Vec2(visibleSize.width / 2, visibleSize.height - 95));
+    addChild(_report, 1);
+
+    scheduleUpdate();
+}
+
+void TerrainStreamingTest::createTerrain(bool streaming)
+{
+    if (_terrain)
+        _terrain->removeFromParent();
+
+    Terrain::DetailMap r("TerrainTest/dirt.jpg"), g("TerrainTest/Grass2.jpg", 10), b("TerrainTest/road.jpg"),
+        a("TerrainTest/GreenSkin.jpg", 20);
+    Terrain::TerrainData data("TerrainTest/heightmap16.jpg", "TerrainTest/alphamap.png", r, g, b, a, Size(16, 16),
+                              40.0f, 2);
+    data._streamingDistance = streaming ? 160.0f : 0.0f;
+
+    auto start = std::chrono::steady_clock::now();
+    _terrain   = Terrain::create(data, Terrain::CrackFixedType::SKIRT);
+    _loadTime  = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    _terrain->setMaxDetailMapAmount(4);
+    _terrain->setLODDistance(64, 128, 192);
+    _terrain->setCameraMask(2);
+    addChild(_terrain);
+}
+
+void TerrainStreamingTest::update(float dt)
+{
+    // fly around to stream the chunks in and out
+    _angle += dt * 0.2f;
+    Vec3 pos(300.0f * std::cos(_angle), 0.0f, 300.0f * std::sin(_angle));
+    pos.y = _terrain->getHeight(pos.x, pos.z) + 40.0f;
+    _camera->setPosition3D(pos);
+    _camera->lookAt(pos + Vec3(-std::sin(_angle), -0.3f, std::cos(_angle)));
+
+    _report->setString(fmt::format("load {:.1f} ms, {}/{} chunks resident, {} KB", _loadTime,
+                                   _terrain->getResidentChunkCount(), _terrain->getChunkCount(),
+                                   _terrain->getResidentChunkMemory() / 1024));
+}
+
+std::string TerrainStreamingTest::title() const
+{
+    return "Terrain chunk streaming";
+}
+
+std::string TerrainStreamingTest::subtitle() const
+{
+    return "Chunks near the camera are generated on the worker threads";
+}
@@ -112,4 +112,23 @@ protected:
     ax::Camera* _camera;
 };
 
+class TerrainStreamingTest : public TerrainTestDemo
+{
+public:
+    CREATE_FUNC(TerrainStreamingTest);
+    TerrainStreamingTest();
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual void update(float dt) override;
+
+protected:
+    void createTerrain(bool streaming);
+
+    ax::Terrain* _terrain = nullptr;
+    ax::Camera* _camera   = nullptr;
+    ax::Label* _report    = nullptr;
+    float _loadTime       = 0.0f;
+    float _angle          = 0.0f;
+};
+
 #endif  // !TERRAIN_TESH_H
@@ -27,6 +27,8 @@
 
 #include "2d/FastTMXLayer.h"
 #include "2d/FastTMXTiledMap.h"
+#include "2d/TMXXMLParser.h"
+#include "base/ZipUtils.h"
 
 USING_NS_AX;
 
@@ -68,6 +70,7 @@ FastTileMapTests::FastTileMapTests()
     ADD_TEST_CASE(TMXGIDObjectsTestNew);
     ADD_TEST_CASE(TileAnimTestNew);
     ADD_TEST_CASE(TileAnimTestNew2);
+    ADD_TEST_CASE(TMXLoadBenchmarkNew);
 }
 
 TileDemoNew::TileDemoNew()
@@ -1431,3 +1434,71 @@ void TileAnimTestNew2::onTouchBegan(const std::vector<ax::Touch*>& touches, ax::
     _animStarted = !_animStarted;
     map->setTileAnimEnabled(_animStarted);
 }
+
+//------------------------------------------------------------------
+//
+// TMXLoadBenchmarkNew
+//
+//------------------------------------------------------------------
+TMXLoadBenchmarkNew::TMXLoadBenchmarkNew()
+{
+    // a big map generated in memory: 40 gzip compressed layers of 256x256 tiles
+    constexpr int layerCount = 40;
+    constexpr int layerSize  = 256;
+
+    std::string xml = fmt::format(R"(<?xml version="1.0" encoding="UTF-8"?>
+<map version="1.0" orientation="orthogonal" width="{0}" height="{0}" tilewidth="32" tileheight="32">
+<tileset firstgid="1" name="tiles" tilewidth="32" tileheight="32"><image source="tiles.png" width="320" height="160"/></tileset>
+)",
+                                  layerSize);
+    std::vector<uint32_t> tiles(layerSize * layerSize);
+    for (int layer = 0; layer < layerCount; ++layer)
+    {
+        for (size_t i = 0; i < tiles.size(); ++i)
+            tiles[i] = static_cast<uint32_t>((i * 7 + layer) % 50);
+        auto compressed = ZipUtils::compressGZ(std::span{tiles});
+        xml += fmt::format(R"(<layer name="layer{0}" width="{1}" height="{1}"><data encoding="base64" compression="gzip">
+{2}
+</data></layer>)",
+                           layer, layerSize, utils::base64Encode(std::span{compressed}));
+    }
+    xml += "</map>";
+
+    auto cacheDir = FileUtils::getInstance()->getWritablePath() + "tmx-cache/";
+    FileUtils::getInstance()->removeDirectory(cacheDir);
+
+    auto uncached = measureLoad(xml, false);
+    auto cold     = measureLoad(xml, true);
+    auto warm     = measureLoad(xml, true);
+
+    FileUtils::getInstance()->removeDirectory(cacheDir);
+
+    auto s     = Director::getInstance()->getVisibleSize();
+    auto label = Label::createWithTTF(fmt::format("parse & decode: {:.1f} ms\ncache write: {:.1f} ms\ncache read: {:.1f} ms",
+                                                  uncached, cold, warm),
+                                      "fonts/arial.ttf", 20);
+    label->setPosition(Vec2(s.width / 2, s.height / 2));
+    addChild(label);
+}
+
+float TMXLoadBenchmarkNew::measureLoad(std::string_view xml, bool cached)
+{
+    TMXMapInfo::setBinaryCacheEnabled(cached);
+    auto start = std::chrono::steady_clock::now();
+    auto info  = TMXMapInfo::createWithXML(xml, "");
+    auto time  = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    TMXMapInfo::setBinaryCacheEnabled(false);
+
+    AXLOGD("TMX load: {:.1f} ms, cached: {}, from cache: {}", time, cached, info && info->isLoadedFromBinaryCache());
+    return time;
+}
+
+std::string TMXLoadBenchmarkNew::title() const
+{
+    return "TMX load benchmark";
+}
+
+std::string TMXLoadBenchmarkNew::subtitle() const
+{
+    return "40 layers of 256x256 tiles, layers decoded on the worker threads";
+}
@@ -363,4 +363,16 @@ public:
     void onTouchBegan(const std::vector<ax::Touch*>& touches, ax::Event* event);
 };
 
+class TMXLoadBenchmarkNew : public TileDemoNew
+{
+public:
+    CREATE_FUNC(TMXLoadBenchmarkNew);
+    TMXLoadBenchmarkNew();
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+protected:
+    float measureLoad(std::string_view xml, bool cached);
+};
+
 #endif
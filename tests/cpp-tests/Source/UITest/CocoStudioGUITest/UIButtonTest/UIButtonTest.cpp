@@ -48,6 +48,7 @@ UIButtonTests::UIButtonTests()
     ADD_TEST_CASE(Issue17116);
     ADD_TEST_CASE(UIButtonWithPolygonInfo);
     ADD_TEST_CASE(UIButtonScale9ChangeSpriteFrame);
+    ADD_TEST_CASE(UIButtonBatchedPanelTest);
 }
 
 // UIButtonTest
@@ -1141,3 +1142,74 @@ bool UIButtonScale9ChangeSpriteFrame::init()
     }
     return false;
 }
+
+// UIButtonBatchedPanelTest
+
+UIButtonBatchedPanelTest::~UIButtonBatchedPanelTest()
+{
+    Director::getInstance()->getRenderer()->setBatchReordering(true);
+}
+
+bool UIButtonBatchedPanelTest::init()
+{
+    if (!UIScene::init())
+        return false;
+
+    Size widgetSize = _widget->getContentSize();
+
+    // A HUD panel, the backgrounds, titles and bars of the cells interleave in the render queue
+    const int columns = 8, rows = 6;
+    const Size cellSize(widgetSize.width / (columns + 1), widgetSize.height * 0.6f / rows);
+    const Vec2 origin((widgetSize.width - cellSize.width * columns) / 2, widgetSize.height * 0.15f);
+    for (int row = 0; row < rows; ++row)
+    {
+        for (int column = 0; column < columns; ++column)
+        {
+            Vec2 center = origin + Vec2((column + 0.5f) * cellSize.width, (row + 0.5f) * cellSize.height);
+
+            Button* button = Button::create("cocosui/button.png", "cocosui/buttonHighlighted.png");
+            button->setScale9Enabled(true);
+            button->setContentSize(Size(cellSize.width - 6, cellSize.height - 14));
+            button->setTitleText(fmt::format("{}-{}", row, column));
+            button->setPosition(center + Vec2(0, 4));
+            _uiLayer->addChild(button);
+
+            LoadingBar* bar = LoadingBar::create("cocosui/sliderProgress.png");
+            bar->setScale9Enabled(true);
+            bar->setContentSize(Size(cellSize.width - 10, 6));
+            bar->setPosition(center - Vec2(0, cellSize.height / 2 - 6));
+            _uiLayer->addChild(bar);
+            _bars.emplace_back(bar);
+        }
+    }
+
+    auto toggle = Button::create("cocosui/animationbuttonnormal.png", "cocosui/animationbuttonpressed.png");
+    toggle->setTitleText("reorder: on");
+    toggle->setPosition(Vec2(widgetSize.width / 2, widgetSize.height * 0.85f));
+    toggle->addClickEventListener([toggle](Object*) {
+        auto renderer = Director::getInstance()->getRenderer();
+        renderer->setBatchReordering(!renderer->isBatchReordering());
+        toggle->setTitleText(renderer->isBatchReordering() ? "reorder: on" : "reorder: off");
+    });
+    _uiLayer->addChild(toggle);
+
+    _statsLabel = Text::create(" ", "fonts/Marker Felt.ttf", 16);
+    _statsLabel->setPosition(Vec2(widgetSize.width / 2, widgetSize.height * 0.1f));
+    _uiLayer->addChild(_statsLabel);
+
+    scheduleUpdate();
+
+    return true;
+}
+
+void UIButtonBatchedPanelTest::update(float dt)
+{
+    // Only the bars change, the slices of the buttons are kept
+    _elapsed += dt;
+    for (size_t i = 0; i < _bars.size(); ++i)
+        _bars[i]->setPercent(50 + 50 * std::sin(_elapsed + i * 0.3f));
+
+    auto renderer = Director::getInstance()->getRenderer();
+    _statsLabel->setString(fmt::format("{} draws, {} commands joined an earlier batch", renderer->getDrawnBatches(),
+                                       renderer->getReorderedTriangleCommands()));
+}
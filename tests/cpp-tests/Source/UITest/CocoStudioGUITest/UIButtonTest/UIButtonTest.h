@@ -294,4 +294,20 @@ public:
     virtual bool init() override;
 };
 
+class UIButtonBatchedPanelTest : public UIScene
+{
+public:
+    CREATE_FUNC(UIButtonBatchedPanelTest);
+
+    ~UIButtonBatchedPanelTest() override;
+
+    bool init() override;
+    void update(float dt) override;
+
+protected:
+    ax::ui::Text* _statsLabel = nullptr;
+    std::vector<ax::ui::LoadingBar*> _bars;
+    float _elapsed = 0;
+};
+
 #endif /* defined(__TestCpp__UIButtonTest__) */
@@ -46,6 +46,7 @@ UILayoutTests::UILayoutTests()
     ADD_TEST_CASE(UILayoutComponent_Berth_Stretch_Test);
     ADD_TEST_CASE(UILayoutTest_Issue19890);
     ADD_TEST_CASE(UILayout_Clipping_Test);
+    ADD_TEST_CASE(UILayoutTest_NestedBenchmark);
 }
 
 // UILayoutTest
@@ -1136,3 +1137,88 @@ bool UILayout_Clipping_Test::init()
     }
     return false;
 }
+
+// UILayoutTest_NestedBenchmark
+
+bool UILayoutTest_NestedBenchmark::init()
+{
+    if (!UIScene::init())
+    {
+        return false;
+    }
+
+    Size widgetSize = _widget->getContentSize();
+
+    auto title = Text::create("Nested layouts, one text changed per frame", "fonts/Marker Felt.ttf", 20);
+    title->setPosition(Vec2(widgetSize.width / 2.0f, widgetSize.height - title->getContentSize().height * 2.5f));
+    _uiLayer->addChild(title);
+
+    _statsLabel = Text::create(" ", "fonts/Marker Felt.ttf", 14);
+    _statsLabel->setPosition(Vec2(widgetSize.width / 2.0f, widgetSize.height - title->getContentSize().height * 3.5f));
+    _uiLayer->addChild(_statsLabel);
+
+    // 6 levels of alternate HBox and VBox with 3 children each, 729 texts in 364 boxes
+    auto root = VBox::create();
+    root->setContentSize(Size(widgetSize.width * 0.8f, widgetSize.height * 0.6f));
+    root->setAnchorPoint(Vec2::ANCHOR_MIDDLE);
+    root->setPosition(Vec2(widgetSize.width / 2.0f, widgetSize.height / 2.0f - 20.0f));
+    root->setBackGroundColorType(Layout::BackGroundColorType::SOLID);
+    root->setBackGroundColor(Color3B(64, 64, 96));
+    _uiLayer->addChild(root);
+    _boxes.push_back(root);
+    createBoxes(root, root->getContentSize(), 6);
+
+    auto button = Button::create("cocosui/button.png", "cocosui/buttonHighlighted.png");
+    button->setScale9Enabled(true);
+    button->setContentSize(Size(220, 30));
+    button->setTitleText("Mode: incremental");
+    button->setPosition(Vec2(widgetSize.width / 2.0f, 40.0f));
+    button->addClickEventListener([this, button](Object*) {
+        _fullRelayout = !_fullRelayout;
+        button->setTitleText(_fullRelayout ? "Mode: relayout all" : "Mode: incremental");
+    });
+    _uiLayer->addChild(button);
+
+    scheduleUpdate();
+    return true;
+}
+
+void UILayoutTest_NestedBenchmark::createBoxes(Layout* parent, const Size& size, int depth)
+{
+    // The children of a VBox are HBoxes stacked vertically, and vice versa
+    bool horizontal = parent->getLayoutType() == Layout::Type::VERTICAL;
+    Size childSize  = horizontal ? Size(size.width, size.height / 3.0f) : Size(size.width / 3.0f, size.height);
+    for (int i = 0; i < 3; ++i)
+    {
+        if (depth == 1)
+        {
+            auto text = Text::create("0", "fonts/arial.ttf", 8);
+            parent->addChild(text);
+            _leaves.push_back(text);
+            continue;
+        }
+        Layout* box = horizontal ? static_cast<Layout*>(HBox::create()) : static_cast<Layout*>(VBox::create());
+        box->setContentSize(childSize);
+        parent->addChild(box);
+        _boxes.push_back(box);
+        createBoxes(box, childSize, depth - 1);
+    }
+}
+
+void UILayoutTest_NestedBenchmark::update(float dt)
+{
+    // The text width changes, so its siblings are moved
+    ++_counter;
+    _leaves[(_counter * 7919) % _leaves.size()]->setString(std::to_string(_counter % 1000));
+    if (_fullRelayout)
+    {
+        for (auto box : _boxes)
+        {
+            box->requestDoLayout();
+        }
+    }
+
+    auto stats = Layout::getLastFrameLayoutStats();
+    _statsLabel->setString(fmt::format("{} layout passes, {} children arranged per frame, frame {:.2f} ms",
+                                       stats.passes, stats.arrangedChildren, dt * 1000));
+}
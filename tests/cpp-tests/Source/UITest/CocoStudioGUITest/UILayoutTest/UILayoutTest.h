@@ -200,4 +200,23 @@ public:
     CREATE_FUNC(UILayout_Clipping_Test);
 };
 
+// Benchmark of changing one text in deeply nested linear layouts
+class UILayoutTest_NestedBenchmark : public UIScene
+{
+public:
+    virtual bool init() override;
+    virtual void update(float dt) override;
+
+    CREATE_FUNC(UILayoutTest_NestedBenchmark);
+
+protected:
+    void createBoxes(ax::ui::Layout* parent, const ax::Size& size, int depth);
+
+    std::vector<ax::ui::Text*> _leaves;
+    std::vector<ax::ui::Layout*> _boxes;
+    ax::ui::Text* _statsLabel = nullptr;
+    bool _fullRelayout        = false;
+    unsigned int _counter     = 0;
+};
+
 #endif /* defined(__TestCpp__UILayoutTest__) */
@@ -23,6 +23,7 @@
  ****************************************************************************/
 
 #include "UIListViewTest.h"
+#include <chrono>
 
 USING_NS_AX;
 using namespace ax::ui;
@@ -39,6 +40,7 @@ UIListViewTests::UIListViewTests()
     ADD_TEST_CASE(UIListViewTest_MagneticHorizontal);
     ADD_TEST_CASE(UIListViewTest_PaddingVertical);
     ADD_TEST_CASE(UIListViewTest_PaddingHorizontal);
+    ADD_TEST_CASE(UIListViewTest_Virtual);
     ADD_TEST_CASE(Issue12692);
     ADD_TEST_CASE(Issue8316);
 }
@@ -1058,3 +1060,73 @@ void UIListViewTest_Padding::sliderEvent(Object* pSender, Slider::EventType type
         }
     }
 }
+
+// UIListViewTest_Virtual
+bool UIListViewTest_Virtual::init()
+{
+    if (!UIScene::init())
+    {
+        return false;
+    }
+
+    Size layerSize = _uiLayer->getContentSize();
+
+    auto titleLabel = Text::create("Virtual list of 100000 items", "fonts/Marker Felt.ttf", 32);
+    titleLabel->setAnchorPoint(Vec2::ANCHOR_MIDDLE);
+    titleLabel->setPosition(Vec2(layerSize / 2) + Vec2(0.0f, titleLabel->getContentSize().height * 3.15f));
+    _uiLayer->addChild(titleLabel, 3);
+
+    _statsLabel = Text::create(" ", "fonts/Marker Felt.ttf", 14);
+    _statsLabel->setAnchorPoint(Vec2::ANCHOR_MIDDLE_TOP);
+    _statsLabel->setPosition(Vec2(layerSize.width / 2, layerSize.height / 4 - 10));
+    _uiLayer->addChild(_statsLabel, 3);
+
+    _listView = ListView::create();
+    _listView->setDirection(ScrollView::Direction::VERTICAL);
+    _listView->setBounceEnabled(true);
+    _listView->setBackGroundImage("cocosui/green_edit.png");
+    _listView->setBackGroundImageScale9Enabled(true);
+    _listView->setContentSize(layerSize / 2);
+    _listView->setItemsMargin(2.0f);
+    _listView->setGravity(ListView::Gravity::CENTER_HORIZONTAL);
+    _listView->setMagneticType(ListView::MagneticType::CENTER);
+    _listView->setAnchorPoint(Vec2::ANCHOR_MIDDLE);
+    _listView->setPosition(layerSize / 2);
+    _uiLayer->addChild(_listView);
+
+    // Only the items in the view are created, the scrolled out ones are reused
+    _listView->setVirtual(
+        [this](Widget* item, ssize_t index) {
+            static_cast<Button*>(item)->setTitleText(fmt::format("Button-{}", index));
+            ++_renderCount;
+        },
+        []() -> Widget* {
+            auto button = Button::create("cocosui/button.png", "cocosui/buttonHighlighted.png");
+            button->setScale9Enabled(true);
+            button->setContentSize(Size(160, 40));
+            return button;
+        });
+    _listView->setVirtualItemCount(100000);
+
+    scheduleUpdate();
+    return true;
+}
+
+void UIListViewTest_Virtual::update(float dt)
+{
+    // Scroll through the list by 50 items per frame
+    auto start = std::chrono::steady_clock::now();
+    _listView->jumpToItem(_scrollIndex, Vec2::ANCHOR_MIDDLE_TOP, Vec2::ANCHOR_MIDDLE_TOP);
+    _totalMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    _scrollIndex = (_scrollIndex + 50) % _listView->getVirtualItemCount();
+
+    if (++_frames == 60)
+    {
+        _statsLabel->setString(fmt::format("scroll {:.3f} ms, {} items created, {} renders per frame, frame {:.2f} ms",
+                                           _totalMs / _frames, _listView->getItems().size(), _renderCount / _frames,
+                                           dt * 1000));
+        _frames      = 0;
+        _totalMs     = 0.0;
+        _renderCount = 0;
+    }
+}
@@ -219,4 +219,22 @@ public:
     }
 };
 
+// Benchmark of scrolling through a virtual list of 100k items
+class UIListViewTest_Virtual : public UIScene
+{
+public:
+    CREATE_FUNC(UIListViewTest_Virtual);
+
+    virtual bool init() override;
+    virtual void update(float dt) override;
+
+protected:
+    ax::ui::ListView* _listView;
+    ax::ui::Text* _statsLabel;
+    ssize_t _scrollIndex = 0;
+    int _frames          = 0;
+    double _totalMs      = 0.0;
+    ssize_t _renderCount = 0;
+};
+
 #endif /* defined(__TestCpp__UIListViewTest__) */
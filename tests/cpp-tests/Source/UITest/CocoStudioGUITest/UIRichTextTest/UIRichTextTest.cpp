@@ -54,6 +54,7 @@ UIRichTextTests::UIRichTextTests()
     ADD_TEST_CASE(UIRichTextHeaders);
     ADD_TEST_CASE(UIRichTextParagraph);
     ADD_TEST_CASE(UIRichTextScrollTo);
+    ADD_TEST_CASE(UIRichTextChatBenchmark);
 }
 
 //
@@ -1181,3 +1182,86 @@ void UIRichTextScrollTo::updateScrollViewSize()
     _scrollView->setInnerContainerSize(Size(_scrollView->getInnerContainerSize().width, newHeight));
     _scrollView->scrollToTop(0.f, false);
 }
+
+//
+// UIRichTextChatBenchmark
+//
+bool UIRichTextChatBenchmark::init()
+{
+    if (!UIRichTextTestBase::init())
+        return false;
+
+    auto& widgetSize = _widget->getContentSize();
+
+    Text* alert = Text::create("Chat log, a message appended per frame", "fonts/Marker Felt.ttf", 24);
+    alert->setColor(Color3B(159, 168, 176));
+    alert->setPosition(
+        Vec2(widgetSize.width / 2.0f, widgetSize.height / 2.0f - alert->getContentSize().height * 4.0f));
+    _widget->addChild(alert);
+
+    Button* button = Button::create("cocosui/animationbuttonnormal.png", "cocosui/animationbuttonpressed.png");
+    button->setTitleText("append");
+    button->addTouchEventListener(AX_CALLBACK_2(UIRichTextChatBenchmark::switchAppendMode, this));
+    button->setPosition(Vec2(widgetSize.width / 2, widgetSize.height / 2 + button->getContentSize().height * 3.0f));
+    _widget->addChild(button, 10);
+
+    _statsLabel = Text::create(" ", "fonts/Marker Felt.ttf", 14);
+    _statsLabel->setPosition(
+        Vec2(widgetSize.width / 2, widgetSize.height / 2 + button->getContentSize().height * 2.0f));
+    _widget->addChild(_statsLabel);
+
+    // The log grows downwards, clip it to the window
+    auto window = Layout::create();
+    window->setContentSize(Size(300, 160));
+    window->setClippingEnabled(true);
+    window->setAnchorPoint(Vec2::ANCHOR_MIDDLE_TOP);
+    window->setPosition(Vec2(widgetSize.width / 2, widgetSize.height / 2 + button->getContentSize().height));
+    _widget->addChild(window);
+
+    _richText = RichText::create();
+    _richText->ignoreContentAdaptWithSize(false);
+    _richText->setContentSize(window->getContentSize());
+    _richText->setAnchorPoint(Vec2::ANCHOR_TOP_LEFT);
+    _richText->setPosition(Vec2(0, window->getContentSize().height));
+    window->addChild(_richText);
+
+    scheduleUpdate();
+
+    return true;
+}
+
+void UIRichTextChatBenchmark::update(float dt)
+{
+    auto message = fmt::format("<font color=\"#ffcc00\">player{}:</font> hello, this is chat message {}<br/>",
+                               _messageCount % 8, _messageCount);
+    ++_messageCount;
+
+    // Keep the log bounded, a real chat window would drop the oldest lines the same way
+    if (_messageCount % 200 == 0)
+    {
+        _chatText.clear();
+        _richText->setString("");
+    }
+
+    _chatText += message;
+    if (_appendMode)
+        _richText->appendString(message);
+    else
+        _richText->setString(_chatText);
+    _richText->formatText();
+
+    auto& stats = _richText->getFormatStats();
+    _statsLabel->setString(fmt::format("{}: format {:.3f} ms, {} elements, average {:.3f} ms",
+                                       _appendMode ? "append" : "setString", stats.lastFormatTime,
+                                       stats.lastFormattedElements,
+                                       stats.formatCount ? stats.totalFormatTime / stats.formatCount : 0.f));
+}
+
+void UIRichTextChatBenchmark::switchAppendMode(ax::Object* sender, Widget::TouchEventType type)
+{
+    if (type == Widget::TouchEventType::ENDED)
+    {
+        _appendMode = !_appendMode;
+        static_cast<Button*>(sender)->setTitleText(_appendMode ? "append" : "setString");
+    }
+}
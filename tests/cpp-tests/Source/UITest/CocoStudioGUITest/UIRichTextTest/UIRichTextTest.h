@@ -233,4 +233,21 @@ protected:
     ax::ui::ScrollView* _scrollView;
 };
 
+class UIRichTextChatBenchmark : public UIRichTextTestBase
+{
+public:
+    CREATE_FUNC(UIRichTextChatBenchmark);
+
+    bool init() override;
+    void update(float dt) override;
+
+protected:
+    void switchAppendMode(ax::Object* sender, ax::ui::Widget::TouchEventType type);
+
+    ax::ui::Text* _statsLabel{};
+    std::string _chatText;
+    int _messageCount = 0;
+    bool _appendMode  = true;
+};
+
 #endif /* defined(__TestCpp__UIRichTextTest__) */
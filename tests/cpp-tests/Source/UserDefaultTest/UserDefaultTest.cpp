@@ -37,6 +37,7 @@ USING_NS_AX;
 UserDefaultTests::UserDefaultTests()
 {
     ADD_TEST_CASE(UserDefaultTest);
+    ADD_TEST_CASE(UserDefaultWriteBenchmark);
 }
 
 UserDefaultTest::UserDefaultTest()
@@ -203,3 +204,62 @@ void UserDefaultTest::printValue()
 }
 
 UserDefaultTest::~UserDefaultTest() {}
+
+//------------------------------------------------------------------
+//
+// UserDefaultWriteBenchmark
+//
+//------------------------------------------------------------------
+#define BENCHMARK_KEYS   32
+#define BENCHMARK_WRITES 100000
+
+bool UserDefaultWriteBenchmark::init()
+{
+    if (!TestCase::init())
+        return false;
+
+    auto s = Director::getInstance()->getWinSize();
+    _label = Label::createWithTTF("", "fonts/arial.ttf", 16);
+    _label->setPosition(Vec2(s.width / 2, s.height / 2));
+    addChild(_label);
+
+    auto item = MenuItemFont::create("Run", [this](Object*) { runBenchmark(); });
+    auto menu = Menu::create(item, nullptr);
+    menu->setPosition(Vec2(s.width / 2, s.height / 2 - 60));
+    addChild(menu);
+
+    runBenchmark();
+    return true;
+}
+
+void UserDefaultWriteBenchmark::runBenchmark()
+{
+    auto userDefault = UserDefault::getInstance();
+
+    std::vector<std::string> keys;
+    for (int i = 0; i < BENCHMARK_KEYS; ++i)
+        keys.emplace_back(fmt::format("benchmark_counter_{}", i));
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCHMARK_WRITES; ++i)
+        userDefault->setIntegerForKey(keys[i % BENCHMARK_KEYS].c_str(), i);
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (auto& key : keys)
+        userDefault->deleteValueForKey(key.c_str());
+
+    auto result = fmt::format("{} writes in {:.3f}ms, {:.0f} writes/s", BENCHMARK_WRITES, elapsed * 1000,
+                              BENCHMARK_WRITES / elapsed);
+    AXLOGD("UserDefaultWriteBenchmark: {}", result);
+    _label->setString(result);
+}
+
+std::string UserDefaultWriteBenchmark::title() const
+{
+    return "UserDefault Write Benchmark";
+}
+
+std::string UserDefaultWriteBenchmark::subtitle() const
+{
+    return fmt::format("Update {} keys {} times", BENCHMARK_KEYS, BENCHMARK_WRITES);
+}
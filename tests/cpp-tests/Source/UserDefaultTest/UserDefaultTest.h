@@ -44,4 +44,20 @@ private:
     ax::Label* _label;
 };
 
+// Measures the write throughput of frequently updated keys, e.g. progress counters
+class UserDefaultWriteBenchmark : public TestCase
+{
+public:
+    CREATE_FUNC(UserDefaultWriteBenchmark);
+
+    virtual bool init() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+private:
+    void runBenchmark();
+
+    ax::Label* _label = nullptr;
+};
+
 #endif  // _USERDEFAULT_TEST_H_
@@ -0,0 +1,157 @@
+/****************************************************************************
+ Copyright (c) 2019-present Axmol Engine contributors (see AUTHORS.md).
+
+ https://axmol.dev/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include <doctest.h>
+#include "TestUtils.h"
+#include "2d/AutoPolygon.h"
+#include "fmt/format.h"
+#include "platform/FileUtils.h"
+#include "xxhash.h"
+
+USING_NS_AX;
+
+
+namespace {
+    // Four opaque discs on a transparent 256x256 image, one in each quarter
+    std::string writeDiscsImage() {
+        constexpr int size = 256;
+        std::vector<uint8_t> pixels(size * size * 4, 0);
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                float dx = float(x % 128) - 64.0f;
+                float dy = float(y % 128) - 64.0f;
+                if (dx * dx + dy * dy < 40.0f * 40.0f)
+                    pixels[(y * size + x) * 4 + 3] = 255;
+            }
+        }
+
+        auto path = FileUtils::getInstance()->getWritablePath() + "unit-tests-AutoPolygon.png";
+        Image image;
+        image.initWithRawData(pixels.data(), pixels.size(), size, size, 8);
+        image.saveToFile(path, false);
+        return path;
+    }
+
+    std::vector<Rect> quarters() {
+        return {Rect(0, 0, 128, 128), Rect(128, 0, 128, 128), Rect(0, 128, 128, 128), Rect(128, 128, 128, 128)};
+    }
+
+    /// Exposes the cache entries to check what is stored on disk
+    struct PolygonCache : AutoPolygon {
+        using AutoPolygon::computeCacheKey;
+        using AutoPolygon::loadCachedPolygon;
+        using AutoPolygon::saveCachedPolygon;
+
+        static uint64_t key(std::string_view path, const Rect& rect) {
+            auto data = FileUtils::getInstance()->getDataFromFile(path);
+            return computeCacheKey(XXH3_64bits(data.getBytes(), data.getSize()), rect, 2.0f, 0.05f);
+        }
+    };
+
+    size_t countFiles(std::string_view dir) {
+        size_t count = 0;
+        for (auto&& file : FileUtils::getInstance()->listFiles(dir)) {
+            if (file.ends_with(".bin"))
+                ++count;
+        }
+        return count;
+    }
+
+    void checkSame(const PolygonInfo& a, const PolygonInfo& b) {
+        REQUIRE_EQ(a.triangles.vertCount, b.triangles.vertCount);
+        REQUIRE_EQ(a.triangles.indexCount, b.triangles.indexCount);
+        CHECK(a.getRect().equals(b.getRect()));
+        CHECK(memcmp(a.triangles.verts, b.triangles.verts, a.triangles.vertCount * sizeof(V3F_C4B_T2F)) == 0);
+        CHECK(memcmp(a.triangles.indices, b.triangles.indices, a.triangles.indexCount * sizeof(unsigned short)) == 0);
+    }
+}
+
+
+TEST_SUITE("2d/AutoPolygon") {
+    TEST_CASE("batch_matches_single") {
+        auto path = writeDiscsImage();
+        auto rects = quarters();
+
+        AutoPolygon ap(path);
+        auto infos = ap.generateTriangles(rects);
+        REQUIRE_EQ(rects.size(), infos.size());
+        for (size_t i = 0; i < rects.size(); ++i) {
+            auto info = ap.generateTriangles(rects[i]);
+            CHECK(info.triangles.indexCount > 0);
+            checkSame(info, infos[i]);
+        }
+
+        FileUtils::getInstance()->removeFile(path);
+    }
+
+
+    TEST_CASE("cache") {
+        auto path = writeDiscsImage();
+        auto rects = quarters();
+        auto cacheDir = FileUtils::getInstance()->getWritablePath() + "polygon-cache/";
+        FileUtils::getInstance()->removeDirectory(cacheDir);
+
+        auto expected = AutoPolygon::generatePolygons(path, rects);
+
+        AutoPolygon::setCacheEnabled(true);
+        auto generated = AutoPolygon::generatePolygons(path, rects);
+        REQUIRE_EQ(rects.size(), countFiles(cacheDir));
+        std::vector<uint64_t> keys;
+        for (size_t i = 0; i < rects.size(); ++i) {
+            checkSame(expected[i], generated[i]);
+            keys.emplace_back(PolygonCache::key(path, rects[i]));
+            PolygonInfo entry;
+            REQUIRE(PolygonCache::loadCachedPolygon(keys[i], entry));
+            checkSame(expected[i], entry);
+        }
+
+        // the entries are served from disk, a planted entry is returned as is
+        PolygonCache::saveCachedPolygon(keys[1], expected[0]);
+        auto cached = AutoPolygon::generatePolygons(path, rects);
+        checkSame(expected[0], cached[1]);
+        for (size_t i : {0, 2, 3}) {
+            checkSame(expected[i], cached[i]);
+            CHECK(cached[i].getFilename() == path);
+        }
+        checkSame(expected[0], AutoPolygon::generatePolygon(path, rects[1]));
+
+        // a corrupted entry is removed, then generated and saved again
+        auto corrupted = fmt::format("{}{:016x}.bin", cacheDir, keys[3]);
+        REQUIRE(FileUtils::getInstance()->isFileExist(corrupted));
+        FileUtils::getInstance()->writeStringToFile("not a polygon", corrupted);
+        PolygonInfo entry;
+        CHECK_FALSE(PolygonCache::loadCachedPolygon(keys[3], entry));
+        CHECK_FALSE(FileUtils::getInstance()->isFileExist(corrupted));
+
+        FileUtils::getInstance()->writeStringToFile("not a polygon", corrupted);
+        checkSame(expected[3], AutoPolygon::generatePolygons(path, rects)[3]);
+        CHECK_EQ(rects.size(), countFiles(cacheDir));
+        REQUIRE(PolygonCache::loadCachedPolygon(keys[3], entry));
+        checkSame(expected[3], entry);
+        AutoPolygon::setCacheEnabled(false);
+
+        FileUtils::getInstance()->removeDirectory(cacheDir);
+        FileUtils::getInstance()->removeFile(path);
+    }
+}
@@ -0,0 +1,239 @@
+/****************************************************************************
+ Copyright (c) 2019-present Axmol Engine contributors (see AUTHORS.md).
+
+ https://axmol.dev/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include <doctest.h>
+#include "TestUtils.h"
+#include "2d/DrawNode.h"
+
+USING_NS_AX;
+
+
+namespace {
+    /// Exposes the retained buffers of the primitives
+    struct RetainedDrawNode : DrawNode {
+        using DrawNode::mergeDirtyRanges;
+        using DrawNode::RETAINED_TRIANGLE;
+
+        static RetainedDrawNode* create() {
+            auto node = new RetainedDrawNode();
+            node->init();
+            return node;
+        }
+
+        const std::vector<V2F_C4B_T2F>& vertices() const { return _retained[RETAINED_TRIANGLE].vertices; }
+        const std::vector<std::pair<unsigned int, unsigned int>>& dirtyRanges() const {
+            return _retained[RETAINED_TRIANGLE].dirtyRanges;
+        }
+        size_t freeCount() const { return _retained[RETAINED_TRIANGLE].freeCount; }
+        const Primitive& primitive(int id) const { return _primitives[id]; }
+        void update() { updateRetained(RETAINED_TRIANGLE); }
+    };
+
+    std::vector<Vec2> polygon(int count, float x) {
+        std::vector<Vec2> points;
+        for (int i = 0; i < count; ++i)
+            points.emplace_back(x + std::cos(i * 6.2831853f / count), std::sin(i * 6.2831853f / count));
+        return points;
+    }
+
+    int addPolygon(DrawNode* node, int count, const Color4B& color) {
+        auto points = polygon(count, 0.0f);
+        return node->addPolygon(points.data(), count, color);
+    }
+
+    /// The vertices of the slot are the fan of the polygon, then the degenerate tail
+    void checkSlot(RetainedDrawNode* node, int id, int count, const Color4B& color, float x = 0.0f) {
+        auto& primitive = node->primitive(id);
+        auto points     = polygon(count, x);
+        auto vertices   = node->vertices().data() + primitive.first;
+        REQUIRE(primitive.first + primitive.capacity <= node->vertices().size());
+        REQUIRE_EQ(3 * (count - 2), primitive.size);
+        for (int i = 0; i < count - 2; ++i) {
+            CHECK_EQ(points[0], vertices[i * 3].vertices);
+            CHECK_EQ(points[i + 1], vertices[i * 3 + 1].vertices);
+            CHECK_EQ(points[i + 2], vertices[i * 3 + 2].vertices);
+            for (int j = 0; j < 3; ++j)
+                CHECK_EQ(color, vertices[i * 3 + j].colors);
+        }
+        for (unsigned int i = primitive.size; i < primitive.capacity; ++i) {
+            CHECK_EQ(Vec2::ZERO, vertices[i].vertices);
+            CHECK_EQ(0, vertices[i].colors.a);
+        }
+    }
+}
+
+
+TEST_SUITE("2d/DrawNode") {
+    TEST_CASE("update_in_slot_or_at_end") {
+        auto node = RetainedDrawNode::create();
+        int a = addPolygon(node, 4, Color4B::RED);
+        int b = addPolygon(node, 4, Color4B::GREEN);
+        REQUIRE_EQ(12, node->vertices().size());
+        CHECK_EQ(0, node->primitive(a).first);
+        CHECK_EQ(6, node->primitive(b).first);
+        checkSlot(node, a, 4, Color4B::RED);
+        checkSlot(node, b, 4, Color4B::GREEN);
+        node->update();
+        CHECK(node->dirtyRanges().empty());
+
+        SUBCASE("fewer") {
+            // stays in its slot, the tail becomes degenerate
+            auto points = polygon(3, 0.0f);
+            node->updatePolygon(a, points.data(), 3, Color4B::BLUE);
+            CHECK_EQ(0, node->primitive(a).first);
+            CHECK_EQ(6, node->primitive(a).capacity);
+            CHECK_EQ(12, node->vertices().size());
+            checkSlot(node, a, 3, Color4B::BLUE);
+            checkSlot(node, b, 4, Color4B::GREEN);
+            REQUIRE_EQ(1, node->dirtyRanges().size());
+            CHECK_EQ(std::pair{0u, 6u}, node->dirtyRanges()[0]);
+
+            // grows back into the capacity of the slot
+            points = polygon(4, 1.0f);
+            node->updatePolygon(a, points.data(), 4, Color4B::RED);
+            CHECK_EQ(0, node->primitive(a).first);
+            checkSlot(node, a, 4, Color4B::RED, 1.0f);
+        }
+
+        SUBCASE("equal") {
+            auto points = polygon(4, 2.0f);
+            node->updatePolygon(a, points.data(), 4, Color4B::BLUE);
+            CHECK_EQ(0, node->primitive(a).first);
+            CHECK_EQ(12, node->vertices().size());
+            CHECK_EQ(0, node->freeCount());
+            checkSlot(node, a, 4, Color4B::BLUE, 2.0f);
+            checkSlot(node, b, 4, Color4B::GREEN);
+            REQUIRE_EQ(1, node->dirtyRanges().size());
+            CHECK_EQ(std::pair{0u, 6u}, node->dirtyRanges()[0]);
+        }
+
+        SUBCASE("more") {
+            // moves to the end, its old slot is cleared and free
+            auto points = polygon(5, 0.0f);
+            node->updatePolygon(a, points.data(), 5, Color4B::BLUE);
+            CHECK_EQ(12, node->primitive(a).first);
+            CHECK_EQ(21, node->vertices().size());
+            CHECK_EQ(6, node->freeCount());
+            for (int i = 0; i < 6; ++i)
+                CHECK_EQ(0, node->vertices()[i].colors.a);
+            checkSlot(node, a, 5, Color4B::BLUE);
+            checkSlot(node, b, 4, Color4B::GREEN);
+
+            // the last slot grows in place
+            points = polygon(6, 0.0f);
+            node->updatePolygon(a, points.data(), 6, Color4B::RED);
+            CHECK_EQ(12, node->primitive(a).first);
+            CHECK_EQ(24, node->vertices().size());
+            CHECK_EQ(6, node->freeCount());
+            checkSlot(node, a, 6, Color4B::RED);
+        }
+
+        node->update();
+        CHECK(node->dirtyRanges().empty());
+        node->release();
+    }
+
+
+    TEST_CASE("remove_and_compact") {
+        auto node = RetainedDrawNode::create();
+        constexpr int count = 400;
+        std::vector<int> ids;
+        for (int i = 0; i < count; ++i)
+            ids.push_back(addPolygon(node, 4, Color4B(i % 256, i / 256, 0, 255)));
+        REQUIRE_EQ(count * 6, node->vertices().size());
+
+        // the last slot is dropped, the others are cleared
+        node->removePrimitive(ids.back());
+        CHECK_EQ((count - 1) * 6, node->vertices().size());
+        CHECK_EQ(0, node->freeCount());
+        node->removePrimitive(ids[0]);
+        CHECK_EQ((count - 1) * 6, node->vertices().size());
+        CHECK_EQ(6, node->freeCount());
+        for (int i = 0; i < 6; ++i)
+            CHECK_EQ(0, node->vertices()[i].colors.a);
+        CHECK_EQ(count - 2, node->getPrimitiveCount());
+
+        // more than 1024 free vertices, but less than half of the buffer
+        for (int i = 1; i < 171; ++i)
+            node->removePrimitive(ids[i]);
+        CHECK_EQ(171 * 6, node->freeCount());
+        node->update();
+        CHECK_EQ(171 * 6, node->freeCount());
+        CHECK_EQ((count - 1) * 6, node->vertices().size());
+        checkSlot(node, ids[171], 4, Color4B(171, 0, 0, 255));
+        CHECK_EQ(171 * 6, node->primitive(ids[171]).first);
+
+        // more than half of the buffer, the slots are moved in their order
+        for (int i = 171; i < 200; ++i)
+            node->removePrimitive(ids[i]);
+        node->update();
+        CHECK_EQ(0, node->freeCount());
+        CHECK(node->dirtyRanges().empty());
+        for (int i = 200; i < count - 1; ++i) {
+            CHECK_EQ((i - 200) * 6, node->primitive(ids[i]).first);
+            CHECK_EQ(6, node->primitive(ids[i]).capacity);
+            checkSlot(node, ids[i], 4, Color4B(i % 256, i / 256, 0, 255));
+        }
+        CHECK_EQ((count - 201) * 6, node->vertices().size());
+        CHECK_EQ(count - 201, node->getPrimitiveCount());
+
+        // the ids are reused, the new slots are appended
+        CHECK_EQ(ids[199], addPolygon(node, 4, Color4B::RED));
+        CHECK_EQ((count - 201) * 6, node->primitive(ids[199]).first);
+        checkSlot(node, ids[199], 4, Color4B::RED);
+        node->release();
+    }
+
+
+    TEST_CASE("merge_dirty_ranges") {
+        std::vector<std::pair<unsigned int, unsigned int>> ranges = {
+            {1000, 1010}, {0, 10}, {200, 300}, {5, 20}, {600, 700}, {1266, 1270}};
+        RetainedDrawNode::mergeDirtyRanges(ranges);
+        std::vector<std::pair<unsigned int, unsigned int>> merged = {{0, 300}, {600, 700}, {1000, 1270}};
+        CHECK_EQ(merged, ranges);
+
+        // the updated slots within 256 vertices are uploaded at once
+        auto node = RetainedDrawNode::create();
+        std::vector<int> ids;
+        for (int i = 0; i < 100; ++i)
+            ids.push_back(addPolygon(node, 4, Color4B::RED));
+        node->update();
+
+        auto points = polygon(4, 1.0f);
+        for (int i : {50, 2, 10, 99})
+            node->updatePolygon(ids[i], points.data(), 4, Color4B::BLUE);
+        ranges = node->dirtyRanges();
+        RetainedDrawNode::mergeDirtyRanges(ranges);
+        merged = {{12, 306}, {594, 600}};
+        CHECK_EQ(merged, ranges);
+        for (int i : {2, 10, 50, 99})
+            checkSlot(node, ids[i], 4, Color4B::BLUE, 1.0f);
+        checkSlot(node, ids[3], 4, Color4B::RED);
+
+        node->update();
+        CHECK(node->dirtyRanges().empty());
+        node->release();
+    }
+}
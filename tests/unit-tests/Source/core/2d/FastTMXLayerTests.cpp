@@ -0,0 +1,157 @@
+/****************************************************************************
+ Copyright (c) 2019-present Axmol Engine contributors (see AUTHORS.md).
+
+ https://axmol.dev/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include <doctest.h>
+#include "TestUtils.h"
+#include "2d/FastTMXLayer.h"
+#include "2d/TMXXMLParser.h"
+#include "fmt/format.h"
+#include "platform/FileUtils.h"
+#include "platform/Image.h"
+
+USING_NS_AX;
+
+
+namespace {
+    // Two tiles of 32x32
+    void writeTilesImage() {
+        std::vector<uint8_t> pixels(64 * 32 * 4, 255);
+        Image image;
+        image.initWithRawData(pixels.data(), pixels.size(), 64, 32, 8);
+        image.saveToFile(FileUtils::getInstance()->getWritablePath() + "unit-tests-FastTMXLayer.png", false);
+    }
+
+    std::string mapXml(std::string_view orientation, int size, std::string_view properties = "") {
+        std::string data;
+        for (int i = 0; i < size * size; ++i)
+            data += fmt::format("{}{}", 1 + i % 2, i + 1 < size * size ? "," : "");
+        return fmt::format(R"(<?xml version="1.0" encoding="UTF-8"?>
+<map version="1.0" orientation="{0}" width="{1}" height="{1}" tilewidth="32" tileheight="{2}">
+<tileset firstgid="1" name="tiles" tilewidth="32" tileheight="32">
+<image source="unit-tests-FastTMXLayer.png" width="64" height="32"/></tileset>
+<layer name="tiles" width="{1}" height="{1}">{3}<data encoding="csv">{4}</data></layer>
+</map>)", orientation, size, orientation == "isometric" ? 16 : 32, properties, data);
+    }
+
+    /// Builds the chunks of the layer like a draw of the whole layer
+    struct ChunkedLayer : FastTMXLayer {
+        using FastTMXLayer::TileChunk;
+        using FastTMXLayer::CHUNK_SIZE;
+
+        static ChunkedLayer* create(std::string_view xml) {
+            writeTilesImage();
+            auto info = TMXMapInfo::createWithXML(xml, FileUtils::getInstance()->getWritablePath());
+            if (!info)
+                return nullptr;
+            auto layerInfo = info->getLayers().at(0);
+            auto layer = new ChunkedLayer();
+            layer->initWithTilesetInfo(info->getTilesets().at(0), layerInfo, info);
+            layerInfo->_ownTiles = false;
+            layer->setupTiles();
+            return layer;
+        }
+
+        void build() {
+            updateTotalQuads();
+            auto size = getContentSize();
+            updateTiles(Rect(-size.width, -size.height, size.width * 3, size.height * 3));
+        }
+
+        const std::vector<TileChunk>& chunks() const { return _chunks; }
+        size_t indexCount() const { return _indices.size(); }
+        size_t vertexZCommandCount() const { return _vertexZCommandCount; }
+        const VertexZCommand& vertexZCommand(size_t i) const { return _vertexZCommands[i]; }
+
+        int rowQuads(int chunk, int row) const {
+            return _chunks[chunk].rowQuads[row + 1] - _chunks[chunk].rowQuads[row];
+        }
+    };
+}
+
+
+TEST_SUITE("2d/FastTMXLayer") {
+    TEST_CASE("set_tile_rebuilds_its_chunk") {
+        constexpr int size = 48;
+        auto layer = ChunkedLayer::create(mapXml("orthogonal", size));
+        REQUIRE(layer);
+        layer->build();
+
+        auto& chunks = layer->chunks();
+        REQUIRE_EQ(9, chunks.size());
+        std::vector<int> slots;
+        for (auto&& chunk : chunks) {
+            CHECK_FALSE(chunk.dirty);
+            CHECK(chunk.slot >= 0);
+            slots.push_back(chunk.slot);
+        }
+        CHECK_EQ(size * size * 6, layer->indexCount());
+
+        // the tile (20, 5) is in the second chunk of the first row of chunks
+        layer->setTileGID(0, Vec2(20, 5));
+        for (size_t i = 0; i < chunks.size(); ++i)
+            CHECK_EQ(i == 1, chunks[i].dirty);
+
+        layer->build();
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            CHECK_FALSE(chunks[i].dirty);
+            CHECK_EQ(slots[i], chunks[i].slot);
+        }
+        CHECK_EQ(ChunkedLayer::CHUNK_SIZE - 1, layer->rowQuads(1, 5));
+        CHECK_EQ(ChunkedLayer::CHUNK_SIZE, layer->rowQuads(1, 4));
+        CHECK_EQ(ChunkedLayer::CHUNK_SIZE, layer->rowQuads(0, 5));
+        CHECK_EQ((size * size - 1) * 6, layer->indexCount());
+        CHECK_EQ(0, layer->vertexZCommandCount());
+        layer->release();
+    }
+
+
+    TEST_CASE("automatic_vertexz_draws_by_vertexz") {
+        constexpr int size = 20;
+        auto properties = R"(<properties><property name="cc_vertexz" value="automatic"/></properties>)";
+        auto layer = ChunkedLayer::create(mapXml("isometric", size, properties));
+        REQUIRE(layer);
+        layer->build();
+
+        // the iso vertexZ is -(2 * size - (x + y)), one command per diagonal of the map, in the order of the vertexZ
+        REQUIRE_EQ(size * 2 - 1, layer->vertexZCommandCount());
+        size_t offset = 0;
+        for (int i = 0; i < size * 2 - 1; ++i) {
+            auto& vertexZCommand = layer->vertexZCommand(i);
+            int tiles = std::min(i, size * 2 - 2 - i) + 1;
+            CHECK_EQ(i - size * 2, vertexZCommand.vertexZ);
+            CHECK_EQ(offset, vertexZCommand.command.getIndexDrawOffset());
+            CHECK_EQ(tiles * 6, vertexZCommand.command.getIndexDrawCount());
+            offset += tiles * 6;
+        }
+        CHECK_EQ(offset, layer->indexCount());
+
+        // the emptied tile leaves its diagonal
+        layer->setTileGID(0, Vec2(3, 4));
+        layer->build();
+        REQUIRE_EQ(size * 2 - 1, layer->vertexZCommandCount());
+        CHECK_EQ(7 * 6, layer->vertexZCommand(7).command.getIndexDrawCount());
+        layer->release();
+    }
+}
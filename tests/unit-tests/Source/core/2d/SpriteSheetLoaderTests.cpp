@@ -0,0 +1,255 @@
+/****************************************************************************
+ Copyright (c) 2019-present Axmol Engine contributors (see AUTHORS.md).
+
+ https://axmol.dev/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include <doctest.h>
+#include "TestUtils.h"
+#include "2d/BinarySpriteSheetLoader.h"
+#include "2d/SpriteFrameCache.h"
+#include "base/Director.h"
+#include "fmt/format.h"
+#include "platform/FileUtils.h"
+#include "platform/Image.h"
+#include "renderer/TextureCache.h"
+
+USING_NS_AX;
+
+
+namespace {
+    std::string writablePath(std::string_view name) {
+        return fmt::format("{}unit-tests-SpriteSheet{}", FileUtils::getInstance()->getWritablePath(), name);
+    }
+
+    Texture2D* writeTexture() {
+        std::vector<uint8_t> pixels(64 * 64 * 4, 255);
+        Image image;
+        image.initWithRawData(pixels.data(), pixels.size(), 64, 64, 8);
+        image.saveToFile(writablePath(".png"), false);
+        return Director::getInstance()->getTextureCache()->addImage(writablePath(".png"));
+    }
+
+    constexpr std::string_view FRAME_A = R"("frame": {"x": 0, "y": 0, "w": 32, "h": 32}, "rotated": false,
+"trimmed": false, "spriteSourceSize": {"x": 0, "y": 0, "w": 32, "h": 32}, "sourceSize": {"w": 32, "h": 32})";
+
+    // a trimmed and rotated frame, with a pivot and a polygon
+    std::string frameB(std::string_view triangles = "[[0, 1, 2], [0, 2, 3]]") {
+        return fmt::format(R"("frame": {{"x": 32, "y": 0, "w": 16, "h": 32}}, "rotated": true, "trimmed": true,
+"spriteSourceSize": {{"x": 0, "y": 0, "w": 16, "h": 32}}, "sourceSize": {{"w": 20, "h": 40}},
+"pivot": {{"x": 0.25, "y": 0.75}}, "vertices": [[0, 0], [16, 0], [16, 32], [0, 32]],
+"verticesUV": [[32, 0], [48, 0], [48, 32], [32, 32]], "triangles": {})", triangles);
+    }
+
+    constexpr std::string_view META = R"("meta": {"image": "unit-tests-SpriteSheet.png", "format": "RGBA8888",
+"size": {"w": 64, "h": 64}})";
+
+    std::string objectFramesJson(std::string_view triangles = "[[0, 1, 2], [0, 2, 3]]") {
+        return fmt::format(R"({{"frames": {{"a.png": {{{}}}, "b.png": {{{}}}}}, {}}})", FRAME_A, frameB(triangles),
+                           META);
+    }
+
+    std::string arrayFramesJson() {
+        return fmt::format(R"({{"frames": [{{"filename": "a.png", {}}}, {{"filename": "b.png", {}}}], {}}})", FRAME_A,
+                           frameB(), META);
+    }
+
+    void checkFrames(SpriteFrameCache* cache) {
+        auto a = cache->findFrame("a.png");
+        REQUIRE(a);
+        CHECK(a->getRect().equals(Rect(0, 0, 32, 32)));
+        CHECK_FALSE(a->isRotated());
+        CHECK_EQ(Vec2::ZERO, a->getOffsetInPixels());
+        CHECK_EQ(Vec2(32, 32), a->getOriginalSizeInPixels());
+        CHECK_FALSE(a->hasAnchorPoint());
+        CHECK_FALSE(a->hasPolygonInfo());
+
+        auto b = cache->findFrame("b.png");
+        REQUIRE(b);
+        CHECK(b->getRect().equals(Rect(32, 0, 16, 32)));
+        CHECK(b->isRotated());
+        CHECK_EQ(Vec2(-2, 4), b->getOffsetInPixels());
+        CHECK_EQ(Vec2(20, 40), b->getOriginalSizeInPixels());
+        CHECK(b->hasAnchorPoint());
+        CHECK_EQ(Vec2(0.25f, 0.75f), b->getAnchorPoint());
+        REQUIRE(b->hasPolygonInfo());
+        auto& triangles = b->getPolygonInfo().triangles;
+        REQUIRE_EQ(4, triangles.vertCount);
+        REQUIRE_EQ(6, triangles.indexCount);
+        const unsigned short indices[] = {0, 1, 2, 0, 2, 3};
+        CHECK(memcmp(indices, triangles.indices, sizeof(indices)) == 0);
+        CHECK_EQ(Vec3(0, 40, 0), triangles.verts[0].vertices);
+        CHECK_EQ(Vec3(16, 8, 0), triangles.verts[2].vertices);
+        CHECK_EQ(0.5f, triangles.verts[0].texCoords.u);
+        CHECK_EQ(0.75f, triangles.verts[2].texCoords.u);
+        CHECK_EQ(0.5f, triangles.verts[2].texCoords.v);
+    }
+
+    /// Writes the sheet of the json in the binary format, and returns its bytes
+    std::string saveBinarySheet(SpriteFrameCache* cache) {
+        FileUtils::getInstance()->writeStringToFile(objectFramesJson(), writablePath(".json"));
+        cache->addSpriteFramesWithFile(writablePath(".json"), SpriteSheetFormat::JSON);
+        bool saved = BinarySpriteSheetLoader::save(writablePath(".json"), writablePath(".axss"), *cache);
+        cache->removeSpriteFramesFromFile(writablePath(".json"));
+        REQUIRE(saved);
+        return FileUtils::getInstance()->getStringFromFile(writablePath(".axss"));
+    }
+
+    // The layout of the binary sheet: a header of 11 uint32, the frames of 19 values, the names of 3 uint32
+    constexpr size_t HEADER_SIZE = 11 * 4;
+    constexpr size_t FRAME_SIZE  = 19 * 4;
+    constexpr size_t NAME_SIZE   = 3 * 4;
+
+    uint32_t& field(std::string& data, size_t offset) {
+        return *reinterpret_cast<uint32_t*>(data.data() + offset);
+    }
+
+    bool loadsBinary(SpriteFrameCache* cache, Texture2D* texture, const std::string& data) {
+        Data content;
+        content.copy(reinterpret_cast<const uint8_t*>(data.data()), static_cast<ssize_t>(data.size()));
+        cache->addSpriteFramesWithFileContent(content, texture, SpriteSheetFormat::BINARY);
+        bool loaded = cache->findFrame("a.png") || cache->findFrame("b.png");
+        cache->removeSpriteFrameByName("a.png");
+        cache->removeSpriteFrameByName("b.png");
+        return loaded;
+    }
+}
+
+
+TEST_SUITE("2d/SpriteSheetLoader") {
+    TEST_CASE("json_object_frames") {
+        auto cache = SpriteFrameCache::getInstance();
+        writeTexture();
+        FileUtils::getInstance()->writeStringToFile(objectFramesJson(), writablePath(".json"));
+        cache->addSpriteFramesWithFile(writablePath(".json"), SpriteSheetFormat::JSON);
+        CHECK(cache->isSpriteFramesWithFileLoaded(writablePath(".json")));
+        checkFrames(cache);
+        cache->removeSpriteFramesFromFile(writablePath(".json"));
+        CHECK_FALSE(cache->findFrame("a.png"));
+    }
+
+
+    TEST_CASE("json_array_frames") {
+        auto cache = SpriteFrameCache::getInstance();
+        writeTexture();
+        FileUtils::getInstance()->writeStringToFile(arrayFramesJson(), writablePath(".json"));
+        cache->addSpriteFramesWithFile(writablePath(".json"), SpriteSheetFormat::JSON);
+        checkFrames(cache);
+        cache->removeSpriteFramesFromFile(writablePath(".json"));
+    }
+
+
+    TEST_CASE("json_rejects_invalid_files") {
+        auto cache   = SpriteFrameCache::getInstance();
+        auto texture = writeTexture();
+
+        auto load = [&](const std::string& json) {
+            Data content;
+            content.copy(reinterpret_cast<const uint8_t*>(json.data()), static_cast<ssize_t>(json.size()));
+            cache->addSpriteFramesWithFileContent(content, texture, SpriteSheetFormat::JSON);
+            bool loaded = cache->findFrame("a.png") || cache->findFrame("b.png");
+            cache->removeSpriteFrameByName("a.png");
+            cache->removeSpriteFrameByName("b.png");
+            return loaded;
+        };
+        CHECK(load(objectFramesJson()));
+
+        // none of the frames is added, even the ones read before the error
+        auto json = objectFramesJson();
+        CHECK_FALSE(load(json.substr(0, json.find("b.png") + 20)));
+        CHECK_FALSE(load(objectFramesJson("[[0, 1, 2], [0, 2, 4]]")));
+        CHECK_FALSE(load(objectFramesJson("[[0, 1, 2], [0, -1, 3]]")));
+        CHECK_FALSE(load(objectFramesJson("[[0, 1, 2], [0, 2]]")));
+    }
+
+
+    TEST_CASE("binary_round_trip") {
+        auto cache = SpriteFrameCache::getInstance();
+        writeTexture();
+        auto data = saveBinarySheet(cache);
+        REQUIRE_EQ(0, memcmp(data.data(), "AXSS", 4));
+        CHECK_EQ(2, field(data, 8));   // frames
+        CHECK_EQ(2, field(data, 12));  // names
+        CHECK_EQ(4, field(data, 16));  // vertices
+        CHECK_EQ(6, field(data, 20));  // indices
+
+        cache->addSpriteFramesWithFile(writablePath(".axss"), SpriteSheetFormat::BINARY);
+        CHECK(cache->isSpriteFramesWithFileLoaded(writablePath(".axss")));
+        checkFrames(cache);
+        cache->removeSpriteFramesFromFile(writablePath(".axss"));
+    }
+
+
+    TEST_CASE("binary_rejects_invalid_files") {
+        auto cache   = SpriteFrameCache::getInstance();
+        auto texture = writeTexture();
+        const auto valid = saveBinarySheet(cache);
+        REQUIRE(loadsBinary(cache, texture, valid));
+
+        // the frames are sorted by name, the polygon is the one of b.png
+        const size_t frameB = HEADER_SIZE + FRAME_SIZE;
+        const size_t names  = HEADER_SIZE + 2 * FRAME_SIZE;
+
+        auto corrupt = [&](size_t offset, uint32_t value) {
+            auto data           = valid;
+            field(data, offset) = value;
+            return loadsBinary(cache, texture, data);
+        };
+
+        SUBCASE("truncated") {
+            CHECK_FALSE(loadsBinary(cache, texture, valid.substr(0, valid.size() - 1)));
+            CHECK_FALSE(loadsBinary(cache, texture, valid.substr(0, HEADER_SIZE - 1)));
+            CHECK_FALSE(loadsBinary(cache, texture, valid.substr(0, names)));
+        }
+
+        SUBCASE("header") {
+            auto stringsSize = *reinterpret_cast<const uint32_t*>(valid.data() + 24);
+            CHECK_FALSE(corrupt(0, 0));                // magic
+            CHECK_FALSE(corrupt(4, 2));                // version
+            CHECK_FALSE(corrupt(8, 0xFFFFFFFF));       // frames, the offsets can't wrap around
+            CHECK_FALSE(corrupt(16, 0x40000000));      // vertices
+            CHECK_FALSE(corrupt(24, stringsSize + 1)); // strings
+            CHECK_FALSE(corrupt(28, 0xFFFFFFF0));      // texture name
+            CHECK_FALSE(corrupt(40, 1000));            // pixel format name
+        }
+
+        SUBCASE("polygon") {
+            CHECK_FALSE(corrupt(frameB + 60, 1));    // first vertex
+            CHECK_FALSE(corrupt(frameB + 64, 5));    // vertex count
+            CHECK_FALSE(corrupt(frameB + 68, 1));    // first index
+            CHECK_FALSE(corrupt(frameB + 72, 7));    // index count
+            CHECK(corrupt(frameB + 64, 4));          // unchanged
+
+            // an index out of the vertices of its frame
+            auto data = valid;
+            size_t indices = names + 2 * NAME_SIZE + 4 * 4 * sizeof(float);
+            *reinterpret_cast<uint16_t*>(data.data() + indices + 2 * 5) = 4;
+            CHECK_FALSE(loadsBinary(cache, texture, data));
+        }
+
+        SUBCASE("names") {
+            CHECK_FALSE(corrupt(names + 8, 2));                 // frame
+            CHECK_FALSE(corrupt(names + NAME_SIZE, 1000));      // name offset
+            CHECK_FALSE(corrupt(names + NAME_SIZE + 4, 1000));  // name length
+        }
+    }
+}
@@ -0,0 +1,125 @@
+/****************************************************************************
+ Copyright (c) 2019-present Axmol Engine contributors (see AUTHORS.md).
+
+ https://axmol.dev/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include <doctest.h>
+#include "TestUtils.h"
+#include "2d/TMXXMLParser.h"
+#include "base/Utils.h"
+#include "base/ZipUtils.h"
+#include "platform/FileUtils.h"
+#include "fmt/format.h"
+
+USING_NS_AX;
+
+
+namespace {
+    constexpr int LAYER_SIZE = 64;
+
+    std::vector<uint32_t> layerTiles(int layer) {
+        std::vector<uint32_t> tiles(LAYER_SIZE * LAYER_SIZE);
+        for (size_t i = 0; i < tiles.size(); ++i)
+            tiles[i] = static_cast<uint32_t>((i * 7 + layer) % 50);
+        return tiles;
+    }
+
+    std::string layerXml(int layer, std::string_view encoding) {
+        auto tiles = layerTiles(layer);
+        std::string data;
+        std::string attribs;
+        if (encoding == "csv") {
+            attribs = R"(encoding="csv")";
+            for (size_t i = 0; i < tiles.size(); ++i)
+                data += fmt::format("{}{}", tiles[i], (i + 1) % LAYER_SIZE ? "," : ",\n");
+            data.pop_back();
+            data.pop_back();
+        } else if (encoding == "gzip") {
+            attribs = R"(encoding="base64" compression="gzip")";
+            auto compressed = ZipUtils::compressGZ(tiles.data(), tiles.size() * sizeof(uint32_t));
+            data = utils::base64Encode(std::span{compressed});
+        } else {
+            attribs = R"(encoding="base64")";
+            data = utils::base64Encode(tiles.data(), tiles.size() * sizeof(uint32_t));
+        }
+        return fmt::format(R"(<layer name="layer{0}" width="{1}" height="{1}"><data {2}>
+{3}
+</data></layer>)", layer, LAYER_SIZE, attribs, data);
+    }
+
+    std::string mapXml() {
+        std::string xml = fmt::format(R"(<?xml version="1.0" encoding="UTF-8"?>
+<map version="1.0" orientation="orthogonal" width="{0}" height="{0}" tilewidth="32" tileheight="32">
+<tileset firstgid="1" name="tiles" tilewidth="32" tileheight="32"><image source="tiles.png" width="320" height="160"/></tileset>
+)", LAYER_SIZE);
+        const char* encodings[] = {"csv", "base64", "gzip"};
+        for (int i = 0; i < 9; ++i)
+            xml += layerXml(i, encodings[i % 3]);
+        return xml + "</map>";
+    }
+
+    void checkLayers(TMXMapInfo* info) {
+        auto& layers = info->getLayers();
+        REQUIRE_EQ(9, layers.size());
+        for (int i = 0; i < 9; ++i) {
+            auto tiles = layerTiles(i);
+            REQUIRE(layers.at(i)->_tiles);
+            CHECK(memcmp(tiles.data(), layers.at(i)->_tiles, tiles.size() * sizeof(uint32_t)) == 0);
+        }
+    }
+}
+
+
+TEST_SUITE("2d/TMXMapInfo") {
+    TEST_CASE("decode_layers") {
+        auto info = TMXMapInfo::createWithXML(mapXml(), "");
+        REQUIRE(info);
+        checkLayers(info);
+        CHECK_FALSE(info->isLoadedFromBinaryCache());
+    }
+
+
+    TEST_CASE("binary_cache") {
+        auto cacheDir = FileUtils::getInstance()->getWritablePath() + "tmx-cache/";
+        FileUtils::getInstance()->removeDirectory(cacheDir);
+        TMXMapInfo::setBinaryCacheEnabled(true);
+
+        auto xml = mapXml();
+        auto first = TMXMapInfo::createWithXML(xml, "");
+        REQUIRE(first);
+        CHECK_FALSE(first->isLoadedFromBinaryCache());
+        checkLayers(first);
+
+        auto second = TMXMapInfo::createWithXML(xml, "");
+        REQUIRE(second);
+        CHECK(second->isLoadedFromBinaryCache());
+        checkLayers(second);
+
+        // Another content doesn't hit the cache of the map
+        auto other = TMXMapInfo::createWithXML(xml + " ", "");
+        REQUIRE(other);
+        CHECK_FALSE(other->isLoadedFromBinaryCache());
+
+        TMXMapInfo::setBinaryCacheEnabled(false);
+        FileUtils::getInstance()->removeDirectory(cacheDir);
+    }
+}
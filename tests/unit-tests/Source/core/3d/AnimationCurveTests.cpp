@@ -0,0 +1,146 @@
+/****************************************************************************
+ Copyright (c) 2019-present Axmol Engine contributors (see AUTHORS.md).
+
+ https://axmol.dev/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include <doctest.h>
+#include "TestUtils.h"
+#include "3d/AnimationCurve.h"
+
+USING_NS_AX;
+
+
+namespace {
+    constexpr int KEY_COUNT = 50;
+
+    /// Keys at uneven times, the values trace a helix
+    std::vector<float> makeTimes() {
+        std::vector<float> times;
+        for (int i = 0; i < KEY_COUNT; ++i)
+            times.emplace_back(static_cast<float>(i * i) / ((KEY_COUNT - 1) * (KEY_COUNT - 1)));
+        return times;
+    }
+
+    std::vector<float> makeValues() {
+        std::vector<float> values;
+        for (int i = 0; i < KEY_COUNT; ++i) {
+            values.emplace_back(std::cos(0.3f * i) * 10);
+            values.emplace_back(std::sin(0.3f * i) * 10);
+            values.emplace_back(0.5f * i);
+        }
+        return values;
+    }
+
+    std::vector<float> makeRotations() {
+        std::vector<float> values;
+        for (int i = 0; i < KEY_COUNT; ++i) {
+            Quaternion q(Vec3(1.0f, 2.0f, 3.0f).getNormalized(), 0.1f * i);
+            values.insert(values.end(), {q.x, q.y, q.z, q.w});
+        }
+        return values;
+    }
+}
+
+
+TEST_SUITE("3d/AnimationCurve") {
+    TEST_CASE("cursor_matches_search") {
+        auto times = makeTimes();
+        auto values = makeValues();
+        auto curve = AnimationCurve<3>::create(times.data(), values.data(), KEY_COUNT);
+
+        std::vector<float> samples;
+        for (int i = 0; i <= 500; ++i)
+            samples.emplace_back(i / 500.0f);  // forward
+        for (int i = 500; i >= 0; --i)
+            samples.emplace_back(i / 500.0f);  // backward
+        for (int i = 0; i < 100; ++i)
+            samples.emplace_back(std::fmod(i * 0.618f, 1.0f));  // jumps
+
+        int cursor = -1;
+        for (auto time : samples) {
+            float expected[3], actual[3];
+            curve->evaluate(time, expected, EvaluateType::INT_LINEAR);
+            curve->evaluate(time, actual, EvaluateType::INT_LINEAR, cursor);
+            for (int c = 0; c < 3; ++c)
+                CHECK(actual[c] == doctest::Approx(expected[c]));
+            if (time > times[0] && time < times[KEY_COUNT - 1]) {
+                REQUIRE(cursor >= 0);
+                CHECK(time >= times[cursor]);
+                CHECK(time <= times[cursor + 1]);
+            }
+        }
+    }
+
+
+    TEST_CASE("quantized_values") {
+        auto times = makeTimes();
+        auto values = makeValues();
+        auto curve = AnimationCurve<3>::create(times.data(), values.data(), KEY_COUNT);
+        auto quantized = AnimationCurve<3>::create(times.data(), values.data(), KEY_COUNT, true);
+        CHECK(quantized->isQuantized());
+        CHECK_LT(quantized->getKeysMemorySize(), curve->getKeysMemorySize());
+
+        for (int i = 0; i <= 200; ++i) {
+            float expected[3], actual[3];
+            curve->evaluate(i / 200.0f, expected, EvaluateType::INT_LINEAR);
+            quantized->evaluate(i / 200.0f, actual, EvaluateType::INT_LINEAR);
+            for (int c = 0; c < 3; ++c)
+                CHECK(actual[c] == doctest::Approx(expected[c]).epsilon(0.001));
+        }
+    }
+
+
+    TEST_CASE("quantized_rotations") {
+        auto times = makeTimes();
+        auto values = makeRotations();
+        auto curve = AnimationCurve<4>::create(times.data(), values.data(), KEY_COUNT);
+        auto quantized = AnimationCurve<4>::create(times.data(), values.data(), KEY_COUNT, true);
+
+        for (int i = 0; i <= 200; ++i) {
+            float expected[4], actual[4];
+            curve->evaluate(i / 200.0f, expected, EvaluateType::INT_QUAT_SLERP);
+            quantized->evaluate(i / 200.0f, actual, EvaluateType::INT_QUAT_SLERP);
+            float length = std::sqrt(actual[0] * actual[0] + actual[1] * actual[1] + actual[2] * actual[2] +
+                                     actual[3] * actual[3]);
+            CHECK(length == doctest::Approx(1.0f));
+            for (int c = 0; c < 4; ++c)
+                CHECK(std::abs(actual[c] - expected[c]) < 1e-3f);
+        }
+    }
+
+
+    TEST_CASE("constant_curve_is_one_key") {
+        auto times = makeTimes();
+        std::vector<float> values;
+        for (int i = 0; i < KEY_COUNT; ++i)
+            values.insert(values.end(), {1.0f, 2.0f, 3.0f});
+
+        auto curve = AnimationCurve<3>::create(times.data(), values.data(), KEY_COUNT, true);
+        CHECK_EQ(1, curve->getKeyCount());
+        CHECK_FALSE(curve->isQuantized());
+
+        float value[3];
+        curve->evaluate(0.5f, value, EvaluateType::INT_LINEAR);
+        CHECK_EQ(2.0f, value[1]);
+    }
+}
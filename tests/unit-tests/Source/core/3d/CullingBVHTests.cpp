@@ -0,0 +1,132 @@
+/****************************************************************************
+ Copyright (c) 2019-present Axmol Engine contributors (see AUTHORS.md).
+
+ https://axmol.dev/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include <doctest.h>
+#include <random>
+#include "TestUtils.h"
+#include "2d/Camera.h"
+#include "3d/CullingBVH.h"
+#include "3d/Frustum.h"
+
+USING_NS_AX;
+
+
+namespace {
+    std::vector<AABB> randomBoxes(int count, std::mt19937& rng) {
+        std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+        std::uniform_real_distribution<float> size(0.5f, 20.0f);
+        std::vector<AABB> boxes;
+        for (int i = 0; i < count; ++i) {
+            Vec3 min(position(rng), position(rng), position(rng));
+            boxes.emplace_back(min, min + Vec3(size(rng), size(rng), size(rng)));
+        }
+        return boxes;
+    }
+
+    Camera* createCamera(float angle) {
+        auto camera = Camera::createPerspective(60.0f, 1.5f, 1.0f, 400.0f);
+        camera->setPosition3D(Vec3(30.0f * std::cos(angle), 10.0f, 30.0f * std::sin(angle)));
+        camera->lookAt(Vec3(300.0f * std::cos(angle * 3), 50.0f * std::sin(angle), 300.0f * std::sin(angle * 3)));
+        return camera;
+    }
+
+    /// Compares the result of the last cull with the brute force frustum tests, returns the visible count
+    int checkCulled(CullingBVH* bvh, const std::vector<AABB>& boxes, const std::vector<int>& proxies,
+                    const Frustum& frustum) {
+        int visible = 0, mismatches = 0;
+        for (size_t i = 0; i < boxes.size(); ++i) {
+            if (proxies[i] < 0)
+                continue;
+            const bool expected = !frustum.isOutOfFrustum(boxes[i]);
+            visible += expected;
+            mismatches += expected != bvh->isVisible(proxies[i]);
+        }
+        CHECK_EQ(0, mismatches);
+        return visible;
+    }
+}
+
+
+TEST_SUITE("3d/CullingBVH") {
+    TEST_CASE("matches_frustum_tests") {
+        std::mt19937 rng(12345);
+        auto boxes = randomBoxes(5000, rng);
+
+        auto bvh = CullingBVH::create();
+        std::vector<int> proxies;
+        for (auto& box : boxes)
+            proxies.emplace_back(bvh->addBounds(box));
+        bvh->rebuild();
+        CHECK_EQ(boxes.size(), bvh->getTreeProxyCount());
+        CHECK_EQ(0, bvh->getDynamicProxyCount());
+
+        for (int i = 0; i < 16; ++i) {
+            auto camera = createCamera(i * 0.4f);
+            const auto& frustum = camera->getFrustum();
+            const int visible = bvh->cull(frustum);
+            CHECK_EQ(checkCulled(bvh, boxes, proxies, frustum), visible);
+            CHECK_GT(visible, 0);
+            CHECK_LT(visible, static_cast<int>(boxes.size()));
+        }
+    }
+
+
+    TEST_CASE("moved_and_removed_bounds") {
+        std::mt19937 rng(54321);
+        auto boxes = randomBoxes(2000, rng);
+
+        auto bvh = CullingBVH::create();
+        std::vector<int> proxies;
+        for (auto& box : boxes)
+            proxies.emplace_back(bvh->addBounds(box));
+        bvh->rebuild();
+
+        // Move a quarter of the boxes and remove some others
+        for (size_t i = 0; i < boxes.size(); i += 4) {
+            boxes[i]._min += Vec3(40.0f, 0.0f, -40.0f);
+            boxes[i]._max += Vec3(40.0f, 0.0f, -40.0f);
+            bvh->updateBounds(proxies[i], boxes[i]);
+        }
+        for (size_t i = 1; i < boxes.size(); i += 10) {
+            bvh->removeBounds(proxies[i]);
+            proxies[i] = -1;
+        }
+        CHECK_EQ(500, bvh->getDynamicProxyCount());
+
+        auto camera = createCamera(0.3f);
+        const auto& frustum = camera->getFrustum();
+        CHECK_EQ(checkCulled(bvh, boxes, proxies, frustum), bvh->cull(frustum));
+
+        // The moved bounds settle and are merged into the tree
+        for (int i = 0; i < 40; ++i)
+            bvh->cull(frustum);
+        CHECK_EQ(0, bvh->getDynamicProxyCount());
+        CHECK_EQ(1800, bvh->getTreeProxyCount());
+        CHECK_EQ(checkCulled(bvh, boxes, proxies, frustum), bvh->cull(frustum));
+
+        // The removed ids are reused
+        auto proxy = bvh->addBounds(boxes[1]);
+        CHECK_EQ(1, proxy % 10);
+    }
+}
@@ -0,0 +1,204 @@
+/****************************************************************************
+ Copyright (c) 2019-present Axmol Engine contributors (see AUTHORS.md).
+
+ https://axmol.dev/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include <doctest.h>
+#include <chrono>
+#include <unordered_map>
+#include "TestUtils.h"
+#include "3d/Bundle3DData.h"
+#include "3d/MeshSkin.h"
+#include "3d/Skeleton3D.h"
+#include "fmt/format.h"
+
+USING_NS_AX;
+
+
+namespace {
+    /// A complete binary tree of bones, bone i is the parent of bones 2i+1 and 2i+2
+    Skeleton3D* createSkeleton(int boneCount) {
+        std::vector<NodeData*> nodes(boneCount);
+        for (int i = 0; i < boneCount; ++i) {
+            nodes[i] = new NodeData();
+            nodes[i]->id = fmt::format("bone{}", i);
+            Mat4::createTranslation(Vec3(1.0f, 0.5f * i, 0.0f), &nodes[i]->transform);
+            nodes[i]->transform.rotateZ(0.1f * i);
+            if (i > 0)
+                nodes[(i - 1) / 2]->children.emplace_back(nodes[i]);
+        }
+
+        auto skeleton = Skeleton3D::create({nodes[0]});
+        delete nodes[0];
+        return skeleton;
+    }
+
+    /// Animates every other bone, returns the local matrices expected
+    std::unordered_map<Bone3D*, Mat4> animate(Skeleton3D* skeleton, float time) {
+        std::unordered_map<Bone3D*, Mat4> locals;
+        skeleton->getRootBone(0)->resetPose();
+        for (ssize_t i = 0; i < skeleton->getBoneCount(); ++i) {
+            auto bone = skeleton->getBoneByName(fmt::format("bone{}", i));
+            Vec3 translate(0.1f * i, time, -0.2f * i);
+            Quaternion rot(Vec3::UNIT_Y, time + 0.3f * i);
+            Vec3 scale(1.0f + 0.01f * i, 1.0f, 0.5f);
+
+            Mat4 local;
+            if (i % 2 == 0) {
+                bone->setAnimationValue(&translate.x, &rot.x, &scale.x);
+                Mat4::createTranslation(translate, &local);
+                local.rotate(rot);
+                local.scale(scale);
+            }
+            else {
+                Mat4::createTranslation(Vec3(1.0f, 0.5f * i, 0.0f), &local);
+                local.rotateZ(0.1f * i);
+            }
+            locals[bone] = local;
+        }
+        return locals;
+    }
+
+    Mat4 expectedWorld(Bone3D* bone, const std::unordered_map<Bone3D*, Mat4>& locals) {
+        auto parent = bone->getParentBone();
+        return parent ? expectedWorld(parent, locals) * locals.at(bone) : locals.at(bone);
+    }
+
+    bool approxEqual(const Mat4& a, const Mat4& b) {
+        for (int i = 0; i < 16; ++i) {
+            if (std::abs(a.m[i] - b.m[i]) > 1e-3f)
+                return false;
+        }
+        return true;
+    }
+}
+
+
+TEST_SUITE("3d/Skeleton3D") {
+    TEST_CASE("world_matrices") {
+        auto skeleton = createSkeleton(31);
+        auto locals = animate(skeleton, 0.5f);
+        skeleton->updateBoneMatrix();
+
+        for (ssize_t i = 0; i < skeleton->getBoneCount(); ++i) {
+            auto bone = skeleton->getBoneByIndex(static_cast<unsigned int>(i));
+            CHECK(approxEqual(expectedWorld(bone, locals), bone->getWorldMat()));
+        }
+    }
+
+
+    TEST_CASE("reparent_bone") {
+        auto skeleton = createSkeleton(7);
+        animate(skeleton, 0.5f);
+        skeleton->updateBoneMatrix();
+
+        // move the leaf bone6 from bone2 to the root, the flattened hierarchy follows the bone mutators
+        auto root = skeleton->getRootBone(0);
+        auto leaf = skeleton->getBoneByName("bone6");
+        skeleton->getBoneByName("bone2")->removeChildBone(leaf);
+        root->addChildBone(leaf);
+
+        auto locals = animate(skeleton, 1.0f);
+        skeleton->updateBoneMatrix();
+        CHECK(approxEqual(root->getWorldMat() * locals.at(leaf), leaf->getWorldMat()));
+
+        // a removed bone is no longer updated
+        root->removeChildBone(leaf);
+        const Mat4 world = leaf->getWorldMat();
+        animate(skeleton, 2.0f);
+        skeleton->updateBoneMatrix();
+        CHECK(memcmp(world.m, leaf->getWorldMat().m, sizeof(Mat4::m)) == 0);
+    }
+
+
+    TEST_CASE("matrix_palette") {
+        auto skeleton = createSkeleton(15);
+        std::vector<std::string> names;
+        std::vector<Mat4> invBindPoses;
+        for (int i = 14; i >= 0; i -= 2) {
+            names.emplace_back(fmt::format("bone{}", i));
+            Mat4 invBindPose;
+            Mat4::createScale(Vec3(1.0f, 2.0f, 3.0f), &invBindPose);
+            invBindPose.translate(Vec3(-1.0f * i, 0.0f, 0.5f));
+            invBindPoses.emplace_back(invBindPose);
+        }
+        auto skin = MeshSkin::create(skeleton, names, invBindPoses);
+
+        for (float time : {0.0f, 1.0f}) {
+            animate(skeleton, time);
+            skeleton->updateBoneMatrix();
+
+            auto palette = skin->getMatrixPalette();
+            REQUIRE_EQ(static_cast<ssize_t>(names.size() * 3), skin->getMatrixPaletteSize());
+            for (size_t i = 0; i < names.size(); ++i) {
+                auto joint = skeleton->getBoneByName(names[i])->getWorldMat() * invBindPoses[i];
+                for (int row = 0; row < 3; ++row) {
+                    const auto& v = palette[i * 3 + row];
+                    CHECK(v.x == doctest::Approx(joint.m[row]).epsilon(1e-4));
+                    CHECK(v.y == doctest::Approx(joint.m[row + 4]).epsilon(1e-4));
+                    CHECK(v.z == doctest::Approx(joint.m[row + 8]).epsilon(1e-4));
+                    CHECK(v.w == doctest::Approx(joint.m[row + 12]).epsilon(1e-4));
+                }
+            }
+        }
+    }
+
+
+    TEST_CASE("parallel_crowd") {
+        constexpr int crowd = 300;
+        std::vector<Skeleton3D*> skeletons;
+        for (int i = 0; i < crowd; ++i)
+            skeletons.emplace_back(createSkeleton(63));
+
+        using clock = std::chrono::steady_clock;
+        auto elapsed = [](clock::time_point start) {
+            return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+        };
+
+        std::vector<Mat4> serial;
+        for (int i = 0; i < crowd; ++i)
+            animate(skeletons[i], 0.01f * i);
+        auto start = clock::now();
+        for (auto skeleton : skeletons)
+            skeleton->updateBoneMatrix();
+        const double serialMs = elapsed(start);
+        for (auto skeleton : skeletons) {
+            for (ssize_t i = 0; i < skeleton->getBoneCount(); ++i)
+                serial.emplace_back(skeleton->getBoneByIndex(static_cast<unsigned int>(i))->getWorldMat());
+        }
+
+        for (int i = 0; i < crowd; ++i)
+            animate(skeletons[i], 0.01f * i);
+        start = clock::now();
+        Skeleton3D::updateBoneMatrices(skeletons.data(), skeletons.size());
+        const double parallelMs = elapsed(start);
+
+        size_t index = 0;
+        for (auto skeleton : skeletons) {
+            for (ssize_t i = 0; i < skeleton->getBoneCount(); ++i)
+                CHECK(memcmp(serial[index++].m, skeleton->getBoneByIndex(static_cast<unsigned int>(i))->getWorldMat().m,
+                             sizeof(Mat4::m)) == 0);
+        }
+        MESSAGE(fmt::format("{} skeletons: serial {:.3f} ms, parallel {:.3f} ms", crowd, serialMs, parallelMs));
+    }
+}
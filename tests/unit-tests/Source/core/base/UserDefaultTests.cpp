@@ -0,0 +1,194 @@
+/****************************************************************************
+ Copyright (c) 2019-present Axmol Engine contributors (see AUTHORS.md).
+
+ https://axmol.dev/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include <doctest.h>
+#include "TestUtils.h"
+#include "base/UserDefault.h"
+#include "base/Director.h"
+#include "base/Scheduler.h"
+#include "platform/FileUtils.h"
+#include "yasio/obstream.hpp"
+
+USING_NS_AX;
+
+
+namespace {
+    std::string storagePath() {
+        return FileUtils::getInstance()->getNativeWritableAbsolutePath() + "unit-tests-UserDefault.bin";
+    }
+
+    void reopen() {
+        UserDefault::destroyInstance();
+        UserDefault::setFileName("unit-tests-");
+    }
+
+    /// The bytes of the log in use, the mapped file is padded with zeros
+    size_t usedSize() {
+        auto data = FileUtils::getInstance()->getStringFromFile(storagePath());
+        auto last = data.find_last_not_of('\0');
+        return last == std::string::npos ? 0 : last + 1;
+    }
+
+    void resetStorage() {
+        reopen();
+        FileUtils::getInstance()->removeFile(storagePath());
+        FileUtils::getInstance()->removeFile(storagePath() + ".compact");
+        FileUtils::getInstance()->removeFile(storagePath() + ".compacting");
+    }
+}
+
+
+TEST_SUITE("base/UserDefault") {
+#define ud UserDefault::getInstance()
+
+    TEST_CASE("persist_and_reload") {
+        resetStorage();
+        ud->setIntegerForKey("integer", 42);
+        ud->setStringForKey("string", "hello");
+        ud->setStringForKey("string", "world");
+        ud->setBoolForKey("deleted", true);
+        ud->deleteValueForKey("deleted");
+
+        reopen();
+        CHECK_EQ(42, ud->getIntegerForKey("integer"));
+        CHECK(ud->getStringForKey("string") == "world");
+        CHECK_FALSE(ud->getBoolForKey("deleted"));
+        CHECK(ud->getStringForKey("deleted", "none") == "none");
+
+        resetStorage();
+        UserDefault::setFileName();
+    }
+
+
+    TEST_CASE("torn_tail_is_dropped") {
+        resetStorage();
+        ud->setIntegerForKey("a", 1);
+        ud->setIntegerForKey("b", 2);
+        reopen();
+
+        // Corrupt the checksum of the last record, as if the app crashed while writing it
+        auto data = FileUtils::getInstance()->getStringFromFile(storagePath());
+        auto last = data.find_last_not_of('\0');
+        REQUIRE(last != std::string::npos);
+        data[last] = ~data[last];
+        FileUtils::getInstance()->writeStringToFile(data, storagePath());
+
+        CHECK_EQ(1, ud->getIntegerForKey("a"));
+        CHECK_EQ(-1, ud->getIntegerForKey("b", -1));
+
+        // The records appended after recovery are intact
+        ud->setIntegerForKey("c", 3);
+        reopen();
+        CHECK_EQ(1, ud->getIntegerForKey("a"));
+        CHECK_EQ(3, ud->getIntegerForKey("c"));
+
+        resetStorage();
+        UserDefault::setFileName();
+    }
+
+
+    TEST_CASE("legacy_format_is_converted") {
+        resetStorage();
+
+        yasio::obstream obs;
+        obs.write<int>(2);
+        obs.write_v("k1");
+        obs.write_v("v1");
+        obs.write_v("k2");
+        obs.write_v("v2");
+        std::string data(obs.data(), obs.length());
+        data.resize(4096);
+        FileUtils::getInstance()->writeStringToFile(data, storagePath());
+
+        CHECK(ud->getStringForKey("k1") == "v1");
+        ud->setStringForKey("k2", "v3");
+
+        reopen();
+        CHECK(ud->getStringForKey("k1") == "v1");
+        CHECK(ud->getStringForKey("k2") == "v3");
+
+        resetStorage();
+        UserDefault::setFileName();
+    }
+
+
+    TEST_CASE("flush_replaces_log") {
+        resetStorage();
+        for (int i = 0; i < 100; ++i)
+            ud->setIntegerForKey("counter", i);
+        ud->setStringForKey("name", "axmol");
+        auto sizeBefore = usedSize();
+
+        ud->flush();
+        CHECK_FALSE(FileUtils::getInstance()->isFileExist(storagePath() + ".compact"));
+        CHECK_LT(usedSize(), sizeBefore);
+
+        // the records appended after the flush go to the new log
+        ud->setIntegerForKey("counter", 100);
+        reopen();
+        CHECK_EQ(100, ud->getIntegerForKey("counter"));
+        CHECK(ud->getStringForKey("name") == "axmol");
+
+        // a flush interrupted while renaming on windows, the compacted log is the only one left
+        auto data = FileUtils::getInstance()->getStringFromFile(storagePath());
+        UserDefault::destroyInstance();
+        FileUtils::getInstance()->removeFile(storagePath());
+        FileUtils::getInstance()->writeStringToFile(data, storagePath() + ".compact");
+        UserDefault::setFileName("unit-tests-");
+        CHECK_EQ(100, ud->getIntegerForKey("counter"));
+        CHECK_FALSE(FileUtils::getInstance()->isFileExist(storagePath() + ".compact"));
+
+        resetStorage();
+        UserDefault::setFileName();
+    }
+
+
+    TEST_CASE("compaction_keeps_values") {
+        resetStorage();
+        ud->setStringForKey("name", "axmol");
+        for (int i = 0; i < 20000; ++i)
+            ud->setIntegerForKey("counter", i);
+
+        auto sizeBefore = usedSize();
+
+        // The compaction on the JobSystem replaces the log by the compacted one
+        ud->waitForCompaction();
+        CHECK_FALSE(FileUtils::getInstance()->isFileExist(storagePath() + ".compacting"));
+        CHECK_LT(usedSize(), sizeBefore);
+
+        // and its done callback, run by the scheduler later, has nothing left to do
+        Director::getInstance()->getScheduler()->update(0);
+        CHECK_EQ(19999, ud->getIntegerForKey("counter"));
+
+        for (int i = 20000; i < 20100; ++i)
+            ud->setIntegerForKey("counter", i);
+
+        reopen();
+        CHECK_EQ(20099, ud->getIntegerForKey("counter"));
+        CHECK(ud->getStringForKey("name") == "axmol");
+
+        resetStorage();
+        UserDefault::setFileName();
+    }
+}
@@ -0,0 +1,165 @@
+/****************************************************************************
+ Copyright (c) 2019-present Axmol Engine contributors (see AUTHORS.md).
+
+ https://axmol.dev/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include <doctest.h>
+#include "TestUtils.h"
+#include "navmesh/NavMesh.h"
+
+#if defined(AX_ENABLE_NAVMESH)
+
+#include "fmt/format.h"
+#include "math/FastRNG.h"
+#include "recast/DetourNavMeshBuilder.h"
+
+USING_NS_AX;
+
+
+namespace {
+    constexpr int GRID_SIZE = 32;
+
+    /// A flat navmesh of GRID_SIZE x GRID_SIZE square polygons of 1 unit, built without the nav files
+    class GridNavMesh : public NavMesh {
+    public:
+        bool initGrid() {
+            constexpr unsigned short NONE = 0xffff;
+            constexpr int NVP = 4;
+            auto vertex = [](int x, int z) { return static_cast<unsigned short>(z * (GRID_SIZE + 1) + x); };
+            auto poly = [](int x, int z) {
+                bool inside = x >= 0 && z >= 0 && x < GRID_SIZE && z < GRID_SIZE;
+                return inside ? static_cast<unsigned short>(z * GRID_SIZE + x) : NONE;
+            };
+
+            std::vector<unsigned short> verts;
+            for (int z = 0; z <= GRID_SIZE; ++z) {
+                for (int x = 0; x <= GRID_SIZE; ++x)
+                    verts.insert(verts.end(), {static_cast<unsigned short>(x), 0, static_cast<unsigned short>(z)});
+            }
+
+            // the vertices of a polygon, then the neighbor polygon of each edge
+            std::vector<unsigned short> polys;
+            for (int z = 0; z < GRID_SIZE; ++z) {
+                for (int x = 0; x < GRID_SIZE; ++x) {
+                    polys.insert(polys.end(), {vertex(x, z), vertex(x, z + 1), vertex(x + 1, z + 1), vertex(x + 1, z)});
+                    polys.insert(polys.end(), {poly(x - 1, z), poly(x, z + 1), poly(x + 1, z), poly(x, z - 1)});
+                }
+            }
+            std::vector<unsigned short> flags(GRID_SIZE * GRID_SIZE, 1);
+            std::vector<unsigned char> areas(GRID_SIZE * GRID_SIZE, 0);
+
+            dtNavMeshCreateParams params;
+            memset(&params, 0, sizeof(params));
+            params.verts          = verts.data();
+            params.vertCount      = static_cast<int>(verts.size() / 3);
+            params.polys          = polys.data();
+            params.polyFlags      = flags.data();
+            params.polyAreas      = areas.data();
+            params.polyCount      = GRID_SIZE * GRID_SIZE;
+            params.nvp            = NVP;
+            params.bmax[0]        = GRID_SIZE;
+            params.bmax[1]        = 1.0f;
+            params.bmax[2]        = GRID_SIZE;
+            params.walkableHeight = 2.0f;
+            params.walkableRadius = 0.5f;
+            params.walkableClimb  = 0.5f;
+            params.cs             = 1.0f;
+            params.ch             = 1.0f;
+            params.buildBvTree    = true;
+
+            unsigned char* data = nullptr;
+            int dataSize = 0;
+            if (!dtCreateNavMeshData(&params, &data, &dataSize))
+                return false;
+
+            _navMesh = dtAllocNavMesh();
+            if (dtStatusFailed(_navMesh->init(data, dataSize, DT_TILE_FREE_DATA))) {
+                dtFree(data);
+                return false;
+            }
+            return true;
+        }
+    };
+
+    Vec3 randomPoint(FastRNG& rng) {
+        return Vec3(rng.rangef(0.5f, GRID_SIZE - 0.5f), 0.0f, rng.rangef(0.5f, GRID_SIZE - 0.5f));
+    }
+
+    /// Updates the navmesh until the path requests are delivered, returns the amount of updates
+    int drain(NavMesh* navMesh, int maxUpdates) {
+        int updates = 0;
+        while (navMesh->getPendingPathRequestCount() > 0 && updates < maxUpdates) {
+            navMesh->update(1.0f / 60);
+            ++updates;
+        }
+        return updates;
+    }
+}
+
+
+TEST_SUITE("navmesh/NavMesh") {
+    TEST_CASE("path_queue_drains") {
+        auto navMesh = new GridNavMesh();
+        REQUIRE(navMesh->initGrid());
+        navMesh->setPathQueryCount(4);
+
+        // 1600 agents repathing at once, far more requests than queries
+        constexpr int agents = 1600;
+        FastRNG rng;
+        int delivered = 0, empty = 0;
+        auto callback = [&](const std::vector<Vec3>& path) {
+            ++delivered;
+            if (path.empty())
+                ++empty;
+        };
+
+        SUBCASE("unbounded_iterations") {
+            for (int i = 0; i < agents; ++i)
+                navMesh->findPathAsync(randomPoint(rng), randomPoint(rng), callback);
+
+            // dispatched by the first update, delivered by the second
+            CHECK_EQ(2, drain(navMesh, 10));
+        }
+
+        SUBCASE("sliced_iterations") {
+            navMesh->setPathQueryIterations(256);
+            for (int i = 0; i < agents; ++i) {
+                auto start = randomPoint(rng);
+                auto end   = start + Vec3(rng.rangef(-4.0f, 4.0f), 0.0f, rng.rangef(-4.0f, 4.0f));
+                end.clamp(Vec3(0.5f, 0.0f, 0.5f), Vec3(GRID_SIZE - 0.5f, 0.0f, GRID_SIZE - 0.5f));
+                navMesh->findPathAsync(start, end, callback);
+            }
+
+            // a query runs several short requests per update, not one
+            const int updates = drain(navMesh, agents);
+            MESSAGE(fmt::format("{} requests delivered in {} updates", agents, updates));
+            CHECK(updates < agents / 4);
+        }
+
+        CHECK_EQ(0, navMesh->getPendingPathRequestCount());
+        CHECK_EQ(agents, delivered);
+        CHECK_EQ(0, empty);
+        navMesh->release();
+    }
+}
+
+#endif
@@ -0,0 +1,230 @@
+/****************************************************************************
+ Copyright (c) 2019-present Axmol Engine contributors (see AUTHORS.md).
+
+ https://axmol.dev/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include <doctest.h>
+#include <atomic>
+#include <thread>
+#include "TestUtils.h"
+#include "network/Downloader.h"
+#include "platform/FileUtils.h"
+#include "base/Utils.h"
+#include "yasio/xxsocket.hpp"
+#include "fmt/format.h"
+
+USING_NS_AX;
+using namespace ax::network;
+
+
+namespace {
+    /// A minimal loopback HTTP/1.1 server which serves one in-memory file and supports byte ranges.
+    class RangeServer {
+    public:
+        explicit RangeServer(std::string body) : _body(std::move(body)) {
+            _listener.pserve("127.0.0.1", 0);
+            _port = _listener.local_endpoint().port();
+            _thread = std::thread([this] { acceptLoop(); });
+        }
+
+        ~RangeServer() {
+            _stopped = true;
+            _listener.close();
+            if (_thread.joinable())
+                _thread.join();
+            for (auto& t : _sessions)
+                t.join();
+        }
+
+        std::string url() const { return fmt::format("http://127.0.0.1:{}/file.bin", _port); }
+
+        // Close each GET connection after half of the requested bytes were sent
+        std::atomic_bool dropHalf{false};
+        std::atomic<int64_t> bytesServed{0};
+        std::atomic<int> rangeRequests{0};
+
+    private:
+        void acceptLoop() {
+            while (!_stopped) {
+                yasio::xxsocket client = _listener.accept();
+                if (!client.is_open())
+                    continue;
+                _sessions.emplace_back([this, client = std::move(client)]() mutable { serve(client); });
+            }
+        }
+
+        void serve(yasio::xxsocket& client) {
+            std::string request;
+            char buf[1024];
+            while (request.find("\r\n\r\n") == std::string::npos) {
+                int n = client.recv(buf, sizeof(buf));
+                if (n <= 0)
+                    return;
+                request.append(buf, n);
+            }
+
+            const bool head = request.starts_with("HEAD");
+            int64_t first = 0, last = static_cast<int64_t>(_body.size()) - 1;
+            bool ranged = false;
+            auto pos = request.find("Range: bytes=");
+            if (pos != std::string::npos) {
+                ranged = true;
+                ++rangeRequests;
+                first = std::strtoll(request.c_str() + pos + 13, nullptr, 10);
+                auto dash = request.find('-', pos + 13);
+                if (isdigit(request[dash + 1]))
+                    last = std::strtoll(request.c_str() + dash + 1, nullptr, 10);
+            }
+
+            const int64_t length = last - first + 1;
+            std::string header = ranged ? "HTTP/1.1 206 Partial Content\r\n" : "HTTP/1.1 200 OK\r\n";
+            header += fmt::format("Content-Length: {}\r\nAccept-Ranges: bytes\r\nConnection: close\r\n", length);
+            if (ranged)
+                header += fmt::format("Content-Range: bytes {}-{}/{}\r\n", first, last, _body.size());
+            header += "\r\n";
+            sendAll(client, header.data(), static_cast<int64_t>(header.size()));
+
+            if (!head) {
+                const int64_t toSend = dropHalf ? length / 2 : length;
+                sendAll(client, _body.data() + first, toSend);
+                bytesServed += toSend;
+            }
+            client.close();
+        }
+
+        static void sendAll(yasio::xxsocket& client, const char* data, int64_t size) {
+            while (size > 0) {
+                int n = client.send(data, static_cast<int>(std::min<int64_t>(size, 16 * 1024)));
+                if (n <= 0)
+                    return;
+                data += n;
+                size -= n;
+            }
+        }
+
+        std::string _body;
+        yasio::xxsocket _listener;
+        u_short _port = 0;
+        std::atomic_bool _stopped{false};
+        std::thread _thread;
+        std::vector<std::thread> _sessions;
+    };
+
+
+    std::string makeBody(size_t size) {
+        std::string body(size, '\0');
+        uint32_t seed = 0x12345678;
+        for (auto& c : body) {
+            seed = seed * 1664525u + 1013904223u;
+            c = static_cast<char>(seed >> 24);
+        }
+        return body;
+    }
+
+
+    /// Returns the error code, DownloadTask::ERROR_NO_ERROR if succeed
+    int download(Downloader& downloader, std::string_view url, std::string_view path, std::string_view checksum) {
+        auto run = AsyncRunner<int>();
+        downloader.onFileTaskSuccess = [&](const DownloadTask&) { run.finish(DownloadTask::ERROR_NO_ERROR); };
+        downloader.onTaskError = [&](const DownloadTask&, int errorCode, int, std::string_view) {
+            run.finish(errorCode);
+        };
+        downloader.createDownloadFileTask(url, path, "", checksum);
+        return run();
+    }
+}
+
+
+TEST_SUITE("network/Downloader") {
+#define fu FileUtils::getInstance()
+
+    TEST_CASE("segmented_download") {
+        auto body = makeBody(1024 * 1024 + 123);
+        RangeServer server(body);
+
+        auto path = fu->getWritablePath() + "unit-tests/Downloader/segmented.bin";
+        fu->removeFile(path);
+
+        DownloaderHints hints{6, 45, ".tmp", 4, 64 * 1024};
+        Downloader downloader(hints);
+        CHECK_EQ(DownloadTask::ERROR_NO_ERROR, download(downloader, server.url(), path, utils::getStringMD5Hash(body)));
+
+        CHECK_EQ(4, server.rangeRequests.load());
+        CHECK_EQ(static_cast<int64_t>(body.size()), server.bytesServed.load());
+        CHECK(fu->getStringFromFile(path) == body);
+        CHECK_FALSE(fu->isFileExist(path + ".tmp.segments"));
+
+        fu->removeFile(path);
+    }
+
+
+    TEST_CASE("small_file_is_not_split") {
+        auto body = makeBody(1000);
+        RangeServer server(body);
+
+        auto path = fu->getWritablePath() + "unit-tests/Downloader/small.bin";
+        fu->removeFile(path);
+
+        DownloaderHints hints{6, 45, ".tmp", 4, 64 * 1024};
+        Downloader downloader(hints);
+        CHECK_EQ(DownloadTask::ERROR_NO_ERROR, download(downloader, server.url(), path, ""));
+
+        CHECK_EQ(1, server.rangeRequests.load());
+        CHECK(fu->getStringFromFile(path) == body);
+
+        fu->removeFile(path);
+    }
+
+
+    TEST_CASE("resume_interrupted_segments") {
+        auto body = makeBody(512 * 1024);
+        RangeServer server(body);
+
+        auto path = fu->getWritablePath() + "unit-tests/Downloader/resume.bin";
+        fu->removeFile(path);
+        fu->removeFile(path + ".tmp");
+        fu->removeFile(path + ".tmp.segments");
+
+        DownloaderHints hints{6, 45, ".tmp", 4, 64 * 1024};
+        auto checksum = utils::getStringMD5Hash(body);
+
+        server.dropHalf = true;
+        {
+            Downloader downloader(hints);
+            CHECK_NE(DownloadTask::ERROR_NO_ERROR, download(downloader, server.url(), path, checksum));
+        }
+        CHECK(fu->isFileExist(path + ".tmp.segments"));
+
+        server.dropHalf = false;
+        server.bytesServed = 0;
+        {
+            Downloader downloader(hints);
+            CHECK_EQ(DownloadTask::ERROR_NO_ERROR, download(downloader, server.url(), path, checksum));
+        }
+
+        // Only the missing parts of the segments were requested again
+        CHECK_LT(server.bytesServed.load(), static_cast<int64_t>(body.size()));
+        CHECK(fu->getStringFromFile(path) == body);
+
+        fu->removeFile(path);
+    }
+}
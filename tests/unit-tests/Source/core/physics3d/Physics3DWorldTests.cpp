@@ -0,0 +1,128 @@
+/****************************************************************************
+ Copyright (c) 2019-present Axmol Engine contributors (see AUTHORS.md).
+
+ https://axmol.dev/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include <doctest.h>
+#include <chrono>
+#include "TestUtils.h"
+#include "physics3d/Physics3D.h"
+
+#if defined(AX_ENABLE_3D_PHYSICS) && AX_ENABLE_BULLET_INTEGRATION
+
+USING_NS_AX;
+
+
+namespace {
+    struct Pile {
+        Physics3DWorld* world = nullptr;
+        Physics3DRigidBody* ground = nullptr;
+        std::vector<Physics3DRigidBody*> boxes;
+        int groundContacts = 0;
+    };
+
+    /// A static ground with 5000 boxes dropped on it in a 25x25x8 grid
+    void createPile(Pile& pile, bool multithreaded) {
+        Physics3DWorldDes worldDes;
+        worldDes.isMultithreaded = multithreaded;
+        pile.world = Physics3DWorld::create(&worldDes);
+
+        Physics3DRigidBodyDes groundDes;
+        groundDes.shape = Physics3DShape::createBox(Vec3(200.0f, 2.0f, 200.0f));
+        Mat4::createTranslation(0.0f, -1.0f, 0.0f, &groundDes.originalTransform);
+        pile.ground = Physics3DRigidBody::create(&groundDes);
+        pile.ground->setCollisionCallback([&pile](const Physics3DCollisionInfo& ci) {
+            pile.groundContacts += static_cast<int>(ci.collisionPointList.size());
+        });
+        pile.world->addPhysics3DObject(pile.ground);
+
+        Physics3DRigidBodyDes boxDes;
+        boxDes.mass = 1.0f;
+        boxDes.shape = Physics3DShape::createBox(Vec3::ONE);
+        for (int y = 0; y < 8; ++y) {
+            for (int x = 0; x < 25; ++x) {
+                for (int z = 0; z < 25; ++z) {
+                    Mat4::createTranslation(x * 1.5f - 18.0f, y * 1.5f + 1.0f, z * 1.5f - 18.0f, &boxDes.originalTransform);
+                    auto box = Physics3DRigidBody::create(&boxDes);
+                    pile.world->addPhysics3DObject(box);
+                    pile.boxes.emplace_back(box);
+                }
+            }
+        }
+    }
+
+    double stepPile(Pile& pile, int frames) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < frames; ++i)
+            pile.world->stepSimulate(1.0f / 60.0f);
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+    }
+
+    int countFallen(const Pile& pile) {
+        int fallen = 0;
+        for (auto box : pile.boxes)
+            fallen += box->getRigidBody()->getWorldTransform().getOrigin().getY() < 0.0f;
+        return fallen;
+    }
+}
+
+
+TEST_SUITE("physics3d/Physics3DWorld") {
+    TEST_CASE("collision_objects_are_mapped") {
+        Physics3DWorldDes worldDes;
+        auto world = Physics3DWorld::create(&worldDes);
+        Physics3DRigidBodyDes des;
+        des.mass = 1.0f;
+        des.shape = Physics3DShape::createSphere(1.0f);
+        auto body = Physics3DRigidBody::create(&des);
+
+        // the user pointer belongs to the app, the world doesn't touch it
+        int userData = 0;
+        body->getRigidBody()->setUserPointer(&userData);
+        world->addPhysics3DObject(body);
+        CHECK_EQ(body, world->getPhysicsObject(body->getRigidBody()));
+        CHECK_EQ(&userData, body->getRigidBody()->getUserPointer());
+        world->removePhysics3DObject(body);
+        CHECK_EQ(nullptr, world->getPhysicsObject(body->getRigidBody()));
+        CHECK_EQ(&userData, body->getRigidBody()->getUserPointer());
+    }
+
+
+    TEST_CASE("pile_of_5000_boxes") {
+        for (bool multithreaded : {false, true}) {
+            Pile pile;
+            createPile(pile, multithreaded);
+#if BT_THREADSAFE
+            CHECK_EQ(multithreaded, pile.world->isMultithreaded());
+#endif
+            const double ms = stepPile(pile, 120);
+            MESSAGE((multithreaded ? "multithreaded: " : "single threaded: ") << ms << " ms/step");
+
+            // The boxes settle on the ground, and the contacts are reported to its callback
+            CHECK_EQ(0, countFallen(pile));
+            CHECK_GT(pile.groundContacts, 0);
+            pile.world->removeAllPhysics3DObjects();
+        }
+    }
+}
+
+#endif
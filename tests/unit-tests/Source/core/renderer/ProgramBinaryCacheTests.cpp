@@ -0,0 +1,135 @@
+/****************************************************************************
+ Copyright (c) 2019-present Axmol Engine contributors (see AUTHORS.md).
+
+ https://axmol.dev/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include <doctest.h>
+#include "TestUtils.h"
+#include "platform/FileUtils.h"
+#include "renderer/backend/ProgramBinaryCache.h"
+
+USING_NS_AX;
+using namespace ax::backend;
+
+
+namespace {
+    std::string cacheDir() {
+        return FileUtils::getInstance()->getNativeWritableAbsolutePath() + "unit-tests-program-cache/";
+    }
+
+    std::vector<uint8_t> fakeBinary(uint8_t seed) {
+        std::vector<uint8_t> binary(1000);
+        for (size_t i = 0; i < binary.size(); ++i)
+            binary[i] = static_cast<uint8_t>(seed + i * 7);
+        return binary;
+    }
+}
+
+
+TEST_SUITE("renderer/ProgramBinaryCache") {
+    TEST_CASE("key_depends_on_both_sources") {
+        auto key = ProgramBinaryCache::computeKey("void main() {}", "precision mediump float;");
+        CHECK_EQ(key, ProgramBinaryCache::computeKey("void main() {}", "precision mediump float;"));
+        CHECK_NE(key, ProgramBinaryCache::computeKey("void main() {} ", "precision mediump float;"));
+        CHECK_NE(key, ProgramBinaryCache::computeKey("void main() {}precision", " mediump float;"));
+    }
+
+
+    TEST_CASE("hit_and_miss") {
+        ProgramBinaryCache cache(cacheDir(), "vendor|renderer|1.0");
+        cache.clear();
+
+        uint32_t format = 0;
+        std::vector<uint8_t> binary;
+        CHECK_FALSE(cache.load(1, format, binary));
+        CHECK_EQ(1, cache.getMissCount());
+
+        auto saved = fakeBinary(3);
+        REQUIRE(cache.save(1, 0x8741, saved.data(), saved.size()));
+        CHECK(cache.contains(1));
+        CHECK_FALSE(cache.contains(2));
+
+        // A new cache instance reads the entry of the previous launch
+        ProgramBinaryCache relaunched(cacheDir(), "vendor|renderer|1.0");
+        CHECK(relaunched.load(1, format, binary));
+        CHECK_EQ(0x8741, format);
+        CHECK(binary == saved);
+        CHECK_EQ(1, relaunched.getHitCount());
+
+        cache.clear();
+    }
+
+
+    TEST_CASE("driver_update_invalidates") {
+        ProgramBinaryCache cache(cacheDir(), "vendor|renderer|1.0");
+        cache.clear();
+        auto saved = fakeBinary(5);
+        REQUIRE(cache.save(7, 1, saved.data(), saved.size()));
+
+        ProgramBinaryCache updated(cacheDir(), "vendor|renderer|1.1");
+        uint32_t format = 0;
+        std::vector<uint8_t> binary;
+        CHECK_FALSE(updated.load(7, format, binary));
+        CHECK_EQ(1, updated.getInvalidatedCount());
+        CHECK_FALSE(updated.contains(7));
+
+        // The entry compiled by the new driver replaces it
+        REQUIRE(updated.save(7, 2, saved.data(), saved.size()));
+        CHECK(updated.load(7, format, binary));
+        CHECK_EQ(2, format);
+
+        cache.clear();
+    }
+
+
+    TEST_CASE("corrupted_entry_invalidates") {
+        ProgramBinaryCache cache(cacheDir(), "driver");
+        cache.clear();
+        auto saved = fakeBinary(9);
+        REQUIRE(cache.save(11, 1, saved.data(), saved.size()));
+
+        auto fileUtils = FileUtils::getInstance();
+        auto files     = fileUtils->listFiles(cacheDir());
+        REQUIRE_EQ(1, files.size());
+        auto data = fileUtils->getStringFromFile(files[0]);
+        data[data.size() / 2] = ~data[data.size() / 2];
+        fileUtils->writeStringToFile(data, files[0]);
+
+        uint32_t format = 0;
+        std::vector<uint8_t> binary;
+        CHECK_FALSE(cache.load(11, format, binary));
+        CHECK_EQ(1, cache.getInvalidatedCount());
+
+        // A truncated entry, as if the app was killed while writing it
+        REQUIRE(cache.save(11, 1, saved.data(), saved.size()));
+        data = fileUtils->getStringFromFile(files[0]);
+        fileUtils->writeStringToFile(data.substr(0, data.size() - 10), files[0]);
+        CHECK_FALSE(cache.load(11, format, binary));
+
+        // An entry rejected by the driver
+        REQUIRE(cache.save(11, 1, saved.data(), saved.size()));
+        cache.invalidate(11);
+        CHECK_FALSE(cache.contains(11));
+
+        cache.clear();
+    }
+}
@@ -0,0 +1,72 @@
+/****************************************************************************
+ Copyright (c) 2019-present Axmol Engine contributors (see AUTHORS.md).
+
+ https://axmol.dev/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include <doctest.h>
+#include "TestUtils.h"
+#include "math/Mat4.h"
+#include "renderer/backend/ProgramManager.h"
+#include "renderer/backend/ProgramState.h"
+
+USING_NS_AX;
+using namespace ax::backend;
+
+
+TEST_SUITE("renderer/ProgramState") {
+    TEST_CASE("clones_share_uniforms_until_changed") {
+        auto program = ProgramManager::getInstance()->getBuiltinProgram(ProgramType::POSITION_TEXTURE_COLOR);
+        REQUIRE(program);
+        auto state = new ProgramState(program);
+        auto mvp   = state->getUniformLocation(Uniform::MVP_MATRIX);
+        REQUIRE(mvp);
+
+        Mat4 matrix;
+        Mat4::createTranslation(1, 2, 3, &matrix);
+        state->setUniform(mvp, matrix.m, sizeof(matrix.m));
+        auto hash = state->getUniformHash();
+
+        size_t size = 0;
+        auto clone  = state->clone();
+        CHECK_EQ(state->getVertexUniformBuffer(size), clone->getVertexUniformBuffer(size));
+        CHECK_EQ(hash, clone->getUniformHash());
+
+        // The same value doesn't unshare the buffer
+        clone->setUniform(mvp, matrix.m, sizeof(matrix.m));
+        CHECK_EQ(state->getVertexUniformBuffer(size), clone->getVertexUniformBuffer(size));
+
+        // A different value is written to a copy, the original keeps its content and hash
+        Mat4::createTranslation(4, 5, 6, &matrix);
+        clone->setUniform(mvp, matrix.m, sizeof(matrix.m));
+        CHECK_NE(state->getVertexUniformBuffer(size), clone->getVertexUniformBuffer(size));
+        CHECK_NE(hash, clone->getUniformHash());
+        CHECK_EQ(hash, state->getUniformHash());
+
+        // Setting the original value back restores the hash
+        Mat4::createTranslation(1, 2, 3, &matrix);
+        clone->setUniform(mvp, matrix.m, sizeof(matrix.m));
+        CHECK_EQ(hash, clone->getUniformHash());
+
+        clone->release();
+        state->release();
+    }
+}
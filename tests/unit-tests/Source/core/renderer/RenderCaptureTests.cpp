@@ -0,0 +1,111 @@
+/****************************************************************************
+ Copyright (c) 2019-present Axmol Engine contributors (see AUTHORS.md).
+
+ https://axmol.dev/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include <doctest.h>
+#include "TestUtils.h"
+#include "base/Director.h"
+#include "platform/FileUtils.h"
+#include "renderer/RenderCapture.h"
+#include "renderer/Renderer.h"
+#include "renderer/Texture2D.h"
+#include "renderer/TrianglesCommand.h"
+#include "renderer/backend/ProgramManager.h"
+#include "renderer/backend/ProgramState.h"
+
+USING_NS_AX;
+using namespace ax::backend;
+
+
+namespace {
+    std::string capturePath() {
+        return FileUtils::getInstance()->getNativeWritableAbsolutePath() + "unit-tests-RenderCapture.bin";
+    }
+
+    Texture2D* createTexture() {
+        uint8_t pixels[2 * 2 * 4] = {};
+        auto texture = new Texture2D();
+        texture->initWithData(pixels, sizeof(pixels), PixelFormat::RGBA8, 2, 2);
+        return texture;
+    }
+
+    struct Quad {
+        V3F_C4B_T2F verts[4];
+        unsigned short indices[6] = {0, 1, 2, 2, 1, 3};
+        TrianglesCommand command;
+
+        void init(ProgramState* state, Texture2D* texture, float x) {
+            verts[0].vertices = Vec3(x, 0, 0);
+            verts[1].vertices = Vec3(x + 10, 0, 0);
+            verts[2].vertices = Vec3(x, 10, 0);
+            verts[3].vertices = Vec3(x + 10, 10, 0);
+            command.getPipelineDescriptor().programState = state;
+            command.init(0, texture, BlendFunc::ALPHA_PREMULTIPLIED, {verts, indices, 4, 6}, Mat4::IDENTITY, 0);
+        }
+    };
+}
+
+
+TEST_SUITE("renderer/RenderCapture") {
+    TEST_CASE("replay_counts_batches") {
+        auto program = ProgramManager::getInstance()->getBuiltinProgram(ProgramType::POSITION_TEXTURE_COLOR);
+        REQUIRE(program);
+        auto state = new ProgramState(program);
+        state->updateBatchId();
+        Texture2D* textures[] = {createTexture(), createTexture()};
+
+        // Interleaved quads of two textures side by side, as the backgrounds and labels of a panel
+        Quad quads[8];
+        RenderCapture capture;
+        for (int i = 0; i < 8; ++i) {
+            quads[i].init(state, textures[i % 2], i * 20.0f);
+            capture.record(&quads[i].command, *Director::getInstance()->getRenderer());
+        }
+        CHECK_EQ(8, capture.getCommandCount());
+        REQUIRE(capture.save(capturePath()));
+
+        RenderCaptureReplay replay;
+        REQUIRE(replay.load(capturePath()));
+
+        replay.getRenderer()->setBatchReordering(true);
+        auto& stats = replay.replay();
+        CHECK_EQ(8, stats.commands);
+        CHECK_EQ(2, stats.draws);
+        CHECK_EQ(48, stats.drawnVertices);
+
+        // Replays are deterministic, the counts only depend on the capture and the renderer options
+        replay.getRenderer()->setBatchReordering(false);
+        CHECK_EQ(8, replay.replay(3).draws);
+        CHECK_EQ(48, replay.getStats().drawnVertices);
+
+        // A truncated capture is rejected
+        auto data = FileUtils::getInstance()->getDataFromFile(capturePath());
+        FileUtils::getInstance()->writeBinaryToFile(data.getBytes(), data.getSize() - 1, capturePath());
+        CHECK_FALSE(replay.load(capturePath()));
+
+        FileUtils::getInstance()->removeFile(capturePath());
+        for (auto texture : textures)
+            texture->release();
+        state->release();
+    }
+}
@@ -0,0 +1,114 @@
+/****************************************************************************
+ Copyright (c) 2019-present Axmol Engine contributors (see AUTHORS.md).
+
+ https://axmol.dev/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include <doctest.h>
+#include "TestUtils.h"
+#include "3d/Mesh.h"
+#include "3d/MeshRenderer.h"
+#include "base/Director.h"
+#include "renderer/Renderer.h"
+#include "renderer/Texture2D.h"
+
+USING_NS_AX;
+using namespace ax::backend;
+
+
+namespace {
+    constexpr int QUADS = 16;
+
+    /// Mesh renderers of the default material, sharing the buffers of a quad
+    Vector<MeshRenderer*> createQuads(Texture2D* texture) {
+        std::vector<float> positions = {0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 1, 0};
+        std::vector<float> texs;
+        if (texture)
+            texs = {0, 0, 1, 0, 0, 1, 1, 1};
+        auto quad = Mesh::create(positions, {}, texs, IndexArray(std::initializer_list<uint16_t>{0, 1, 2, 2, 1, 3}));
+
+        Vector<MeshRenderer*> renderers;
+        for (int i = 0; i < QUADS; ++i) {
+            auto renderer = MeshRenderer::create();
+            renderer->addMesh(Mesh::create("", quad->getMeshIndexData()));
+            renderer->genMaterial();
+            if (texture)
+                renderer->getMesh()->setTexture(texture);
+            renderers.pushBack(renderer);
+        }
+        return renderers;
+    }
+
+    void drawFrame(Renderer* renderer, const Vector<MeshRenderer*>& quads) {
+        renderer->clearDrawStats();
+        for (int i = 0; i < quads.size(); ++i) {
+            Mat4 transform;
+            Mat4::createTranslation(i * 2.0f, 0, -10, &transform);
+            quads.at(i)->draw(renderer, transform, 0);
+        }
+        renderer->render();
+    }
+}
+
+
+TEST_SUITE("renderer/Renderer") {
+    TEST_CASE("auto_instancing_default_material") {
+        auto renderer = Director::getInstance()->getRenderer();
+        REQUIRE(renderer->isAutoInstancing());
+
+        uint8_t pixels[2 * 2 * 4] = {};
+        auto texture = new Texture2D();
+        texture->initWithData(pixels, sizeof(pixels), PixelFormat::RGBA8, 2, 2);
+
+        for (auto quadTexture : {static_cast<Texture2D*>(nullptr), texture}) {
+            CAPTURE(quadTexture != nullptr);
+            auto quads   = createQuads(quadTexture);
+            auto program = quads.at(0)->getMesh()->getProgramState()->getProgram();
+            CHECK_EQ(quadTexture ? ProgramType::POSITION_TEXTURE_3D : ProgramType::POSITION_3D,
+                     program->getProgramType());
+
+            // The identical quads are drawn by one instanced draw
+            drawFrame(renderer, quads);
+            CHECK_EQ(1, renderer->getDrawnBatches());
+            CHECK_EQ(1, renderer->getDrawnInstancedBatches());
+            CHECK_EQ(QUADS, renderer->getDrawnInstances());
+            CHECK_EQ(6 * QUADS, renderer->getDrawnVertices());
+
+            // The draw doesn't change the program state of the quads
+            CHECK_EQ(program, quads.at(0)->getMesh()->getProgramState()->getProgram());
+
+            // A different color splits the draw
+            quads.at(0)->setColor(Color3B::RED);
+            drawFrame(renderer, quads);
+            CHECK_EQ(2, renderer->getDrawnBatches());
+            CHECK_EQ(QUADS, renderer->getDrawnInstances());
+
+            // Without auto instancing, each quad is drawn by its own draw
+            renderer->setAutoInstancing(false);
+            drawFrame(renderer, quads);
+            CHECK_EQ(QUADS, renderer->getDrawnBatches());
+            CHECK_EQ(0, renderer->getDrawnInstancedBatches());
+            renderer->setAutoInstancing(true);
+        }
+        texture->release();
+    }
+}
@@ -0,0 +1,164 @@
+/****************************************************************************
+ Copyright (c) 2019-present Axmol Engine contributors (see AUTHORS.md).
+
+ https://axmol.dev/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include <doctest.h>
+#include "TestUtils.h"
+#include "2d/Label.h"
+#include "ui/UIRichText.h"
+
+USING_NS_AX;
+using ax::ui::RichText;
+using ax::ui::RichElementCustomNode;
+using ax::ui::RichElementNewLine;
+using ax::ui::RichElementText;
+
+
+namespace {
+    /// A fixed width RichText exposing its rows
+    struct RowsRichText : RichText {
+        static RowsRichText* create() {
+            auto richText = new RowsRichText();
+            richText->init();
+            richText->ignoreContentAdaptWithSize(false);
+            richText->setContentSize(Size(100, 0));
+            return richText;
+        }
+
+        size_t rowCount() const { return _elementRenders.size(); }
+        const Vector<Node*>& row(size_t i) const { return _elementRenders[i]; }
+    };
+
+    void pushBoxes(RichText* richText, int count) {
+        for (int i = 0; i < count; ++i) {
+            auto box = Node::create();
+            box->setContentSize(Size(40, 20));
+            richText->pushBackElement(RichElementCustomNode::create(0, Color3B::WHITE, 255, box));
+        }
+    }
+
+    /// Two rows of boxes, a row with a label, and the empty row after it
+    void pushFirstMessage(RichText* richText) {
+        pushBoxes(richText, 4);
+        richText->pushBackElement(RichElementNewLine::create(0, Color3B::WHITE, 255));
+        richText->pushBackElement(RichElementText::create(0, Color3B::WHITE, 255, "hi", "Arial", 20));
+        richText->pushBackElement(RichElementNewLine::create(0, Color3B::WHITE, 255));
+    }
+
+    std::vector<Vec2> positions(RowsRichText* richText) {
+        std::vector<Vec2> result;
+        for (size_t i = 0; i < richText->rowCount(); ++i)
+            for (auto&& node : richText->row(i))
+                result.push_back(node->getPosition());
+        return result;
+    }
+}
+
+
+TEST_SUITE("ui/RichText") {
+    TEST_CASE("append_formats_only_new_rows") {
+        auto richText = RowsRichText::create();
+        pushFirstMessage(richText);
+        richText->formatText();
+
+        auto& stats = richText->getFormatStats();
+        CHECK(stats.formatCount == 1);
+        CHECK(stats.lastFormattedElements == 7);
+        REQUIRE(richText->rowCount() == 4);
+        CHECK(stats.lastFormattedRows == 4);
+
+        auto label = dynamic_cast<Label*>(richText->row(2).at(0));
+        REQUIRE(label != nullptr);
+        const auto height = richText->getContentSize().height;
+        const auto before = positions(richText);
+        CHECK(before[0] == Vec2(0, height - 20));
+        CHECK(before[1] == Vec2(40, height - 20));
+        CHECK(before[2] == Vec2(0, height - 40));
+
+        // The boxes fill the empty last row and wrap to a new one
+        pushBoxes(richText, 3);
+        richText->formatText();
+
+        CHECK(stats.formatCount == 2);
+        CHECK(stats.lastFormattedElements == 3);
+        REQUIRE(richText->rowCount() == 5);
+        CHECK(stats.lastFormattedRows == 2);
+
+        const auto offsetY = richText->getContentSize().height - height;
+        CHECK(offsetY > 0);
+        auto after = positions(richText);
+        REQUIRE(after.size() == before.size() + 3);
+        for (size_t i = 0; i < before.size(); ++i) {
+            CHECK(after[i].x == doctest::Approx(before[i].x));
+            CHECK(after[i].y == doctest::Approx(before[i].y + offsetY));
+        }
+        CHECK(richText->row(2).at(0) == label);
+        CHECK(label->getAnchorPoint() == Vec2::ANCHOR_BOTTOM_LEFT);
+        CHECK(after[before.size()] == Vec2(0, 20));
+        CHECK(after[before.size() + 1] == Vec2(40, 20));
+        CHECK(after[before.size() + 2] == Vec2(0, 0));
+
+        // The layout matches formatting all the elements at once
+        auto whole = RowsRichText::create();
+        pushFirstMessage(whole);
+        pushBoxes(whole, 3);
+        whole->formatText();
+        CHECK(whole->getFormatStats().lastFormattedRows == 5);
+        CHECK(whole->getContentSize().height == doctest::Approx(richText->getContentSize().height));
+        auto expected = positions(whole);
+        REQUIRE(expected.size() == after.size());
+        for (size_t i = 0; i < after.size(); ++i) {
+            CHECK(after[i].x == doctest::Approx(expected[i].x));
+            CHECK(after[i].y == doctest::Approx(expected[i].y));
+        }
+
+        whole->release();
+        richText->release();
+    }
+
+
+    TEST_CASE("append_to_the_last_row_keeps_the_rows_above") {
+        auto richText = RowsRichText::create();
+        pushBoxes(richText, 3);
+        richText->formatText();
+        const auto before = positions(richText);
+
+        // The box fits in the last row, the height doesn't change
+        pushBoxes(richText, 1);
+        richText->formatText();
+
+        auto& stats = richText->getFormatStats();
+        CHECK(stats.lastFormattedElements == 1);
+        CHECK(stats.lastFormattedRows == 1);
+        CHECK(richText->getContentSize().height == 40);
+        auto after = positions(richText);
+        REQUIRE(after.size() == 4);
+        CHECK(after[0] == before[0]);
+        CHECK(after[1] == before[1]);
+        CHECK(after[2] == before[2]);
+        CHECK(after[3] == Vec2(40, 0));
+
+        richText->release();
+    }
+}